@@ -0,0 +1,120 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "t760_engine/core/Engine.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Decode throughput with 1, 2, 4 and 8 callers, each on a conversation of its
+// own calling generate() in a loop, on a synthetic model of Gemma3 270M's
+// layer shape. Aggregate tokens/s should grow with callers as their decode
+// steps share batches; the per-token latency shows what each caller pays.
+
+using namespace t760;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+constexpr int CALLER_COUNTS[] = {1, 2, 4, 8};
+constexpr size_t PROMPT_TOKENS = 32;
+constexpr int DECODE_TOKENS = 64;
+
+struct CallerResult {
+    std::vector<double> token_ms;
+};
+
+// Callers prefill, then decode together once every prompt is in.
+struct StartGate {
+    std::atomic<int> ready{0};
+    std::atomic<bool> open{false};
+};
+
+void run_caller(Engine& engine, int caller, StartGate& gate, CallerResult& result) {
+    ConversationOptions conversation;
+    conversation.seed = 1 + static_cast<uint64_t>(caller);
+    const ConversationHandle handle = engine.start_new_conversation(conversation);
+    std::vector<int> prompt(PROMPT_TOKENS);
+    for (size_t i = 0; i < prompt.size(); ++i) {
+        prompt[i] = static_cast<int>((i * 131 + static_cast<size_t>(caller) * 17) % 8192);
+    }
+    OutputOptions options;
+    StepOutput output;
+    engine.generate(handle, prompt.data(), prompt.size(), output, options);
+    result.token_ms.reserve(DECODE_TOKENS);
+    ++gate.ready;
+    while (!gate.open) {
+        std::this_thread::yield();
+    }
+    for (int i = 0; i < DECODE_TOKENS; ++i) {
+        const int32_t token = output.next_token;
+        const auto t0 = clock_type::now();
+        engine.generate(handle, &token, 1, output, options);
+        result.token_ms.push_back(std::chrono::duration<double, std::milli>(clock_type::now() - t0).count());
+    }
+    engine.end_conversation(handle);
+}
+
+double percentile(std::vector<double> values, double p) {
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(p * static_cast<double>(values.size())));
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(index), values.end());
+    return values[index];
+}
+
+}
+
+int main() {
+    test::SyntheticModelSpec spec;
+    spec.layers = 6;
+    spec.vocab_size = 8192;
+    spec.hidden_size = 640;
+    spec.intermediate_size = 2048;
+    spec.heads = 4;
+    spec.head_size = 256;
+    spec.kv_heads = 1;
+    spec.seq_len = 1024;
+    const std::string model_path = test::temp_path("t760_bench_concurrency.t760");
+    test::write_synthetic_model(model_path, spec);
+
+    Engine engine;
+    EngineConfig config;
+    config.devices = {{DeviceType::CPU, 0, true}};
+    engine.initialize(config);
+    if (!engine.load_model(model_path)) {
+        std::fprintf(stderr, "Failed to load %s\n", model_path.c_str());
+        return 1;
+    }
+
+    std::printf("%8s %12s %14s %14s\n", "callers", "tokens/s", "p50 token ms", "p99 token ms");
+    for (int callers : CALLER_COUNTS) {
+        std::vector<CallerResult> results(static_cast<size_t>(callers));
+        std::vector<std::thread> threads;
+        StartGate gate;
+        for (int caller = 0; caller < callers; ++caller) {
+            threads.emplace_back(run_caller, std::ref(engine), caller, std::ref(gate),
+                                 std::ref(results[static_cast<size_t>(caller)]));
+        }
+        while (gate.ready < callers) {
+            std::this_thread::yield();
+        }
+        const auto start = clock_type::now();
+        gate.open = true;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        const double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+        std::vector<double> token_ms;
+        for (const CallerResult& result : results) {
+            token_ms.insert(token_ms.end(), result.token_ms.begin(), result.token_ms.end());
+        }
+        std::printf("%8d %12.1f %14.2f %14.2f\n", callers, static_cast<double>(token_ms.size()) / seconds,
+                    percentile(token_ms, 0.5), percentile(token_ms, 0.99));
+    }
+
+    engine.shutdown();
+    std::remove(model_path.c_str());
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "t760_engine/core/ThreadPool.h"
+#include "t760_engine/kernels/DecoderLayer.h"
+#include "t760_engine/kernels/HalfMatmul.h"
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Latency of one Gemma3 270M sliding-window layer: decoder_layer_forward
+// against the same layer run op by op on the same host kernels (one pass per
+// norm, projection, rotation and activation, as DecoderLayer.h draws it), for
+// a decode step and a prefill chunk against a half-full window. Both run
+// single-threaded; the fused path is also timed on a pool of every online CPU.
+// The last column is how far apart the two paths' outputs land.
+
+using namespace t760;
+using namespace t760::kernels;
+
+namespace {
+
+constexpr int64_t SLIDING_WINDOW = 512;
+constexpr int64_t CONTEXT = 256; // Positions already in the cache
+constexpr int64_t ROW_COUNTS[] = {1, 64};
+
+const char* type_name(DataType data_type) {
+    switch (data_type) {
+    case DataType::FP16: return "fp16";
+    case DataType::QINT8: return "q8";
+    case DataType::QINT4: return "q4";
+    default: return "?";
+    }
+}
+
+void linear(const CpuKernelContext& ctx, const LinearWeight& w, const float* a, int64_t count, float* out) {
+    if (is_group_quantized(w.data_type)) {
+        if (count == 1) {
+            gemv_quantized(*ctx.quantized, a, w.quantized, out);
+        } else {
+            gemm_quantized(*ctx.quantized, a, count, w.quantized, out);
+        }
+    } else if (count == 1) {
+        gemv_half(*ctx.half, a, w.half, out);
+    } else {
+        gemm_half(*ctx.half, a, count, w.half, out);
+    }
+}
+
+// The layer one operation at a time, each over every row.
+class Unfused {
+public:
+    Unfused(const test::SyntheticLayer& layer, int64_t count) : layer_(layer), count_(count) {
+        const DecoderLayerParams& p = layer.params;
+        const int64_t q_width = p.attention.num_heads * p.attention.head_dim;
+        const int64_t kv_width = p.attention.num_kv_heads * p.attention.head_dim;
+        normed_.resize(static_cast<size_t>(count * p.hidden_size));
+        proj_.resize(normed_.size());
+        q_.resize(static_cast<size_t>(count * q_width));
+        attn_.resize(q_.size());
+        k_.resize(static_cast<size_t>(count * kv_width));
+        v_.resize(k_.size());
+        gate_.resize(static_cast<size_t>(count * p.intermediate_size));
+        up_.resize(gate_.size());
+    }
+
+    void run(const CpuKernelContext& ctx, float* x, int64_t first_pos, const KvCacheBuffer& cache) {
+        const DecoderLayerParams& p = layer_.params;
+        const DecoderLayerWeights& w = layer_.weights;
+        const AttentionParams& ap = p.attention;
+        const int64_t hidden = p.hidden_size;
+        AttentionParams unrotated = ap;
+        unrotated.rope = nullptr;
+
+        rms_norm(x, count_, hidden, w.input_norm.data(), p.rms_norm_eps, normed_.data());
+        linear(ctx, w.q_proj, normed_.data(), count_, q_.data());
+        linear(ctx, w.k_proj, normed_.data(), count_, k_.data());
+        linear(ctx, w.v_proj, normed_.data(), count_, v_.data());
+        rms_norm(q_.data(), count_ * ap.num_heads, ap.head_dim, w.q_norm.data(), p.rms_norm_eps, q_.data());
+        rms_norm(k_.data(), count_ * ap.num_kv_heads, ap.head_dim, w.k_norm.data(), p.rms_norm_eps, k_.data());
+        for (int64_t i = 0; i < count_; ++i) {
+            layer_.rope.apply(q_.data() + i * ap.num_heads * ap.head_dim, ap.num_heads, first_pos + i);
+            layer_.rope.apply(k_.data() + i * ap.num_kv_heads * ap.head_dim, ap.num_kv_heads, first_pos + i);
+        }
+        kv_cache_append(unrotated, ctx, k_.data(), v_.data(), count_, first_pos, cache);
+        flash_attention(unrotated, ctx, q_.data(), count_, first_pos, cache.view(first_pos + count_), attn_.data());
+        linear(ctx, w.o_proj, attn_.data(), count_, proj_.data());
+        rms_norm(proj_.data(), count_, hidden, w.post_attention_norm.data(), p.rms_norm_eps, proj_.data());
+        for (size_t i = 0; i < proj_.size(); ++i) {
+            x[i] += proj_[i];
+        }
+
+        rms_norm(x, count_, hidden, w.pre_feedforward_norm.data(), p.rms_norm_eps, normed_.data());
+        linear(ctx, w.gate_proj, normed_.data(), count_, gate_.data());
+        linear(ctx, w.up_proj, normed_.data(), count_, up_.data());
+        gelu_tanh_multiply(gate_.data(), up_.data(), static_cast<int64_t>(gate_.size()), gate_.data());
+        linear(ctx, w.down_proj, gate_.data(), count_, proj_.data());
+        rms_norm(proj_.data(), count_, hidden, w.post_feedforward_norm.data(), p.rms_norm_eps, proj_.data());
+        for (size_t i = 0; i < proj_.size(); ++i) {
+            x[i] += proj_[i];
+        }
+    }
+
+private:
+    const test::SyntheticLayer& layer_;
+    int64_t count_;
+    std::vector<float> normed_, proj_, q_, k_, v_, attn_, gate_, up_;
+};
+
+}
+
+int main() {
+    std::mt19937 rng(33);
+    ThreadPool pool(test::host_thread_count(), ~0ull);
+    const CpuKernelContext single = test::host_kernel_context(nullptr);
+    const CpuKernelContext pooled = test::host_kernel_context(&pool);
+    std::printf("%-5s %5s %12s %12s %8s %12s %10s (%u threads)\n", "type", "rows", "unfused us", "fused us",
+                "speedup", "fused pool", "max diff", pool.get_num_threads());
+    for (DataType data_type : {DataType::QINT8, DataType::QINT4, DataType::FP16}) {
+        test::SyntheticModelSpec spec;
+        spec.hidden_size = 640;
+        spec.intermediate_size = 2048;
+        spec.heads = 4;
+        spec.head_size = 256;
+        spec.kv_heads = 1;
+        spec.seq_len = 1024;
+        spec.projection_type = data_type;
+        const auto layer = test::make_synthetic_layer(spec, SLIDING_WINDOW);
+        const int64_t hidden = layer->params.hidden_size;
+        const int64_t kv_width = layer->params.attention.num_kv_heads * layer->params.attention.head_dim;
+        std::vector<uint16_t> keys(static_cast<size_t>(spec.seq_len * kv_width));
+        std::vector<uint16_t> values(keys.size());
+        const KvCacheBuffer cache{keys.data(), values.data(), DataType::FP16, spec.seq_len};
+
+        std::vector<float> context(static_cast<size_t>(CONTEXT * hidden));
+        test::fill_normal(context, rng);
+        decoder_layer_forward(layer->params, layer->weights, pooled, context.data(), CONTEXT, 0, cache);
+
+        for (int64_t count : ROW_COUNTS) {
+            std::vector<float> input(static_cast<size_t>(count * hidden));
+            test::fill_normal(input, rng);
+            std::vector<float> x(input.size());
+            Unfused unfused(*layer, count);
+            x = input;
+            unfused.run(single, x.data(), CONTEXT, cache);
+            const std::vector<float> unfused_out = x;
+            x = input;
+            decoder_layer_forward(layer->params, layer->weights, single, x.data(), count, CONTEXT, cache);
+            const float diff = test::max_abs_diff(x, unfused_out);
+
+            // Every call starts from the same rows and overwrites the same
+            // cache positions.
+            const double unfused_ms = test::time_ms([&] {
+                x = input;
+                unfused.run(single, x.data(), CONTEXT, cache);
+            });
+            const double fused_ms = test::time_ms([&] {
+                x = input;
+                decoder_layer_forward(layer->params, layer->weights, single, x.data(), count, CONTEXT, cache);
+            });
+            const double pooled_ms = test::time_ms([&] {
+                x = input;
+                decoder_layer_forward(layer->params, layer->weights, pooled, x.data(), count, CONTEXT, cache);
+            });
+            std::printf("%-5s %5lld %12.1f %12.1f %7.2fx %12.1f %10.2g\n", type_name(data_type),
+                        static_cast<long long>(count), unfused_ms * 1e3, fused_ms * 1e3, unfused_ms / fused_ms,
+                        pooled_ms * 1e3, diff);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "support/TestSupport.h"
+#include "t760_engine/core/ThreadPool.h"
+#include "t760_engine/kernels/Gemm.h"
+#include <Eigen/Dense>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// The packed FP32 GEMM against Eigen's product at K = 640 (Gemma3 270M's
+// hidden size) and N up to 2048, single-threaded and on a pool of every
+// online CPU, in GFLOP/s.
+
+using namespace t760;
+using namespace t760::kernels;
+
+namespace {
+
+using RowMajor = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+constexpr int64_t K = 640;
+constexpr int64_t ROWS[] = {1, 16, 64, 128, 256, 512};
+constexpr int64_t COLUMNS[] = {256, 640, 1024, 2048};
+
+}
+
+int main() {
+    std::mt19937 rng(29);
+    ThreadPool pool(test::host_thread_count(), ~0ull);
+    const CpuKernelContext single = test::host_kernel_context(nullptr);
+    const CpuKernelContext pooled = test::host_kernel_context(&pool);
+    const GemmKernelSet& ks = *single.gemm;
+    std::printf("%5s %5s %12s %12s %12s (%u threads)\n", "M", "N", "Eigen GF/s", "gemm 1t", "gemm pool",
+                pool.get_num_threads());
+    for (int64_t m : ROWS) {
+        for (int64_t n : COLUMNS) {
+            std::vector<float> a(static_cast<size_t>(m * K));
+            std::vector<float> b(static_cast<size_t>(K * n));
+            std::vector<float> c(static_cast<size_t>(m * n));
+            test::fill_normal(a, rng);
+            test::fill_normal(b, rng);
+            Eigen::Map<const RowMajor> a_map(a.data(), m, K);
+            Eigen::Map<const RowMajor> b_map(b.data(), K, n);
+            Eigen::Map<RowMajor> c_map(c.data(), m, n);
+
+            const double eigen_ms = test::time_ms([&] { c_map.noalias() = a_map * b_map; });
+            const double single_ms =
+                test::time_ms([&] { gemm_f32(ks, single, m, n, K, a.data(), b.data(), c.data()); });
+            const double pooled_ms =
+                test::time_ms([&] { gemm_f32(ks, pooled, m, n, K, a.data(), b.data(), c.data()); });
+            const double mflop = 2.0 * static_cast<double>(m * n * K) / 1e6;
+            std::printf("%5lld %5lld %12.1f %12.1f %12.1f\n", static_cast<long long>(m), static_cast<long long>(n),
+                        mflop / eigen_ms, mflop / single_ms, mflop / pooled_ms);
+        }
+    }
+    return 0;
+}
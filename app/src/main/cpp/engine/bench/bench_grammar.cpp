@@ -0,0 +1,106 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "support/TestTokenizer.h"
+#include "t760_engine/grammar/Grammar.h"
+#include "t760_engine/grammar/TokenGrammar.h"
+#include "t760_engine/kernels/Sampling.h"
+#include "t760_engine/tokenizer/Tokenizer.h"
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Per-token cost of grammar-constrained decoding: a GrammarCursor's
+// allowed() and advance() over the tokens of a schema-conforming tool call,
+// with the masks built as the call reaches new states (cold, what the first
+// call on a schema pays) and cached (warm), plus lowering a logits row to
+// the mask. Runs on the test tokenizer unless given a .t760tok, e.g. the
+// model's 262144-token one: bench_grammar path/to/tokenizer.t760tok
+
+using namespace t760;
+using namespace t760::kernels;
+
+namespace {
+
+constexpr const char* SCHEMA = R"({
+  "type": "object",
+  "properties": {
+    "city": {"type": "string", "maxLength": 32},
+    "days": {"type": "integer"},
+    "unit": {"enum": ["celsius", "fahrenheit"]},
+    "hourly": {"type": "boolean"}
+  },
+  "required": ["city", "days"]
+})";
+constexpr const char* DOCUMENT = R"({"city": "Paris", "days": 14, "unit": "celsius", "hourly": false})";
+
+// Walks tokens through a cursor; returns how many were allowed.
+size_t run(const std::shared_ptr<const TokenGrammar>& grammar, const std::vector<int>& tokens, int32_t eos) {
+    GrammarCursor cursor(grammar, {eos});
+    size_t allowed = 0;
+    for (int token : tokens) {
+        allowed += cursor.allowed().allows(token) ? 1 : 0;
+        cursor.advance(token);
+    }
+    return allowed + (cursor.allowed().allows(eos) ? 1 : 0);
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string path;
+    if (argc > 1) {
+        path = argv[1];
+    } else {
+        path = test::temp_path("t760_bench_grammar.t760tok");
+        test::write_test_tokenizer(path);
+    }
+    auto tokenizer = std::make_shared<const Tokenizer>(path);
+    auto grammar = std::make_shared<const Grammar>(SCHEMA, GrammarSyntax::JSON_SCHEMA);
+    std::vector<int> tokens;
+    tokenizer->encode(DOCUMENT, false, tokens);
+    const int32_t eos = tokenizer->eos_id();
+
+    auto warm = std::make_shared<const TokenGrammar>(grammar, tokenizer);
+    if (run(warm, tokens, eos) != tokens.size() + 1) {
+        std::fprintf(stderr, "The grammar rejects its own document\n");
+        return 1;
+    }
+    const double cold_ms = test::time_ms([&] {
+        run(std::make_shared<const TokenGrammar>(grammar, tokenizer), tokens, eos);
+    });
+    const double warm_ms = test::time_ms([&] { run(warm, tokens, eos); });
+
+    // The mask of the state after `{"city": "`, where most of the vocab stays allowed.
+    GrammarCursor cursor(warm, {eos});
+    std::vector<int> prefix;
+    tokenizer->encode(R"({"city": ")", false, prefix);
+    for (int token : prefix) {
+        cursor.advance(token);
+    }
+    const TokenMask mask = cursor.allowed();
+    const SamplingKernelSet& ks = select_sampling_kernel_set(test::host_capabilities());
+    std::vector<float> row(tokenizer->vocab_size());
+    std::mt19937 rng(49);
+    test::fill_normal(row, rng, 3.0f);
+    const std::vector<float> logits = row;
+    const double mask_ms = test::time_ms([&] {
+        row = logits;
+        mask_logits(ks, row.data(), static_cast<int64_t>(row.size()), 0, mask);
+    });
+    const double copy_ms = test::time_ms([&] { row = logits; });
+
+    const double steps = static_cast<double>(tokens.size() + 1);
+    std::printf("vocab %zu, %zu grammar states, %zu document tokens\n", tokenizer->vocab_size(), grammar->state_count(),
+                tokens.size());
+    std::printf("%-28s %12s\n", "", "us/token");
+    std::printf("%-28s %12.2f\n", "cursor, masks built", cold_ms * 1000.0 / steps);
+    std::printf("%-28s %12.2f\n", "cursor, masks cached", warm_ms * 1000.0 / steps);
+    std::printf("%-28s %12.2f\n", "mask_logits over the vocab", (mask_ms - copy_ms) * 1000.0);
+
+    if (argc <= 1) {
+        std::remove(path.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "t760_engine/core/Engine.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Inter-token latency of conversations that are decoding while another one
+// prefills a long prompt, on a synthetic model of Gemma3 270M's layer
+// shape, with prompts chunked (the default) and prefilled in one step.
+// Chunking should keep ITL p99 near p50, where the unchunked prompt stalls
+// every decoder for its whole prefill; the prompt's TTFT is what chunking
+// costs it. Percentiles are the engine's own (get_latency_stats).
+
+using namespace t760;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+constexpr int DECODERS = 3;
+constexpr size_t PROMPT_TOKENS = 16;
+constexpr size_t LONG_PROMPT_TOKENS = 768;
+constexpr int MIN_DECODE_TOKENS = 32; // Each decoder keeps going until the prefill is done and it has these
+
+struct Load {
+    std::atomic<int> ready{0};
+    std::atomic<bool> open{false};
+    std::atomic<int> decoded{0};
+    std::atomic<bool> prefill_done{false};
+};
+
+std::vector<int> make_prompt(size_t length, int salt) {
+    std::vector<int> prompt(length);
+    for (size_t i = 0; i < prompt.size(); ++i) {
+        prompt[i] = static_cast<int>((i * 131 + static_cast<size_t>(salt) * 17) % 8192);
+    }
+    return prompt;
+}
+
+void run_decoder(Engine& engine, int caller, Load& load) {
+    ConversationOptions conversation;
+    conversation.seed = 1 + static_cast<uint64_t>(caller);
+    const ConversationHandle handle = engine.start_new_conversation(conversation);
+    const std::vector<int> prompt = make_prompt(PROMPT_TOKENS, caller);
+    OutputOptions options;
+    StepOutput output;
+    engine.generate(handle, prompt.data(), prompt.size(), output, options);
+    ++load.ready;
+    while (!load.open) {
+        std::this_thread::yield();
+    }
+    for (int i = 0; (i < MIN_DECODE_TOKENS || !load.prefill_done) && engine.remaining_context(handle) > 0; ++i) {
+        const int32_t token = output.next_token;
+        engine.generate(handle, &token, 1, output, options);
+        ++load.decoded;
+    }
+    engine.end_conversation(handle);
+}
+
+// Starts once the decoders are under way.
+void run_prefill(Engine& engine, Load& load, double& ttft_ms) {
+    while (load.decoded < DECODERS * 4) {
+        std::this_thread::yield();
+    }
+    const ConversationHandle handle = engine.start_new_conversation();
+    const std::vector<int> prompt = make_prompt(LONG_PROMPT_TOKENS, DECODERS);
+    OutputOptions options;
+    StepOutput output;
+    const auto t0 = clock_type::now();
+    engine.generate(handle, prompt.data(), prompt.size(), output, options);
+    ttft_ms = std::chrono::duration<double, std::milli>(clock_type::now() - t0).count();
+    load.prefill_done = true;
+    engine.end_conversation(handle);
+}
+
+}
+
+int main() {
+    test::SyntheticModelSpec spec;
+    spec.layers = 6;
+    spec.vocab_size = 8192;
+    spec.hidden_size = 640;
+    spec.intermediate_size = 2048;
+    spec.heads = 4;
+    spec.head_size = 256;
+    spec.kv_heads = 1;
+    spec.seq_len = 2048;
+    const std::string model_path = test::temp_path("t760_bench_mixed_load.t760");
+    test::write_synthetic_model(model_path, spec);
+
+    std::printf("%d decoders, one %zu-token prompt\n", DECODERS, LONG_PROMPT_TOKENS);
+    std::printf("%-10s %12s %12s %12s %14s\n", "prefill", "ITL p50 ms", "ITL p99 ms", "ITL max ms", "prompt TTFT ms");
+    for (bool chunked : {true, false}) {
+        EngineConfig config;
+        config.devices = {{DeviceType::CPU, 0, true}};
+        if (!chunked) {
+            config.prefill_chunk_tokens = static_cast<uint32_t>(LONG_PROMPT_TOKENS);
+            config.step_token_budget = static_cast<uint32_t>(LONG_PROMPT_TOKENS + DECODERS);
+        }
+        Engine engine;
+        engine.initialize(config);
+        if (!engine.load_model(model_path)) {
+            std::fprintf(stderr, "Failed to load %s\n", model_path.c_str());
+            return 1;
+        }
+        Load load;
+        double ttft_ms = 0.0;
+        std::vector<std::thread> threads;
+        for (int caller = 0; caller < DECODERS; ++caller) {
+            threads.emplace_back(run_decoder, std::ref(engine), caller, std::ref(load));
+        }
+        while (load.ready < DECODERS) {
+            std::this_thread::yield();
+        }
+        load.open = true;
+        threads.emplace_back(run_prefill, std::ref(engine), std::ref(load), std::ref(ttft_ms));
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        const LatencyStats stats = engine.get_latency_stats();
+        std::printf("%-10s %12.2f %12.2f %12.2f %14.1f\n", chunked ? "chunked" : "one step", stats.itl_p50_ms,
+                    stats.itl_p99_ms, stats.itl_max_ms, ttft_ms);
+        engine.shutdown();
+    }
+
+    std::remove(model_path.c_str());
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include "support/TestSupport.h"
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Single-threaded quantized matmul throughput per ISA tier, on the Gemma3
+// 270M projection shapes: decode GEMV as weight bandwidth, and prefill GEMM
+// (FP32 activations and W8A8) as GFLOP/s.
+
+using namespace t760;
+using namespace t760::kernels;
+
+namespace {
+
+struct Shape {
+    const char* name;
+    int64_t n;
+    int64_t k;
+};
+
+constexpr Shape SHAPES[] = {{"q_proj", 1024, 640}, {"gate_proj", 2048, 640}, {"down_proj", 640, 2048}};
+constexpr int64_t PREFILL_ROWS = 64;
+
+}
+
+int main() {
+    std::mt19937 rng(26);
+    std::printf("%-12s %-5s %-10s %10s %9s %12s %12s\n", "tier", "type", "shape", "gemv us", "GB/s", "gemm GF/s",
+                "w8a8 GF/s");
+    for (IsaLevel isa : test::host_isa_levels()) {
+        const QuantizedKernelSet* ks = get_quantized_kernel_set(isa);
+        if (!ks) {
+            continue;
+        }
+        for (DataType data_type : {DataType::QINT8, DataType::QINT4}) {
+            for (const Shape& shape : SHAPES) {
+                const test::QuantizedMatrix w = test::make_quantized_matrix(data_type, shape.n, shape.k, rng);
+                std::vector<float> a(static_cast<size_t>(PREFILL_ROWS * shape.k));
+                test::fill_normal(a, rng);
+                std::vector<float> c(static_cast<size_t>(PREFILL_ROWS * shape.n));
+                std::vector<int8_t> aq(a.size());
+                std::vector<float> as(static_cast<size_t>(PREFILL_ROWS * shape.k / constants::QUANT_GROUP_SIZE));
+                quantize_rows_q8(a.data(), PREFILL_ROWS, shape.k, aq.data(), as.data());
+
+                const double gemv_ms = test::time_ms([&] { gemv_quantized(*ks, a.data(), w.view, c.data()); });
+                const double gemm_ms =
+                    test::time_ms([&] { gemm_quantized(*ks, a.data(), PREFILL_ROWS, w.view, c.data()); });
+                const double int8_ms = test::time_ms([&] {
+                    gemm_quantized_rows_int8(*ks, aq.data(), as.data(), PREFILL_ROWS, w.view, 0, shape.n, c.data(),
+                                             shape.n);
+                });
+                const double flops = 2.0 * PREFILL_ROWS * shape.n * shape.k;
+                std::printf("%-12s %-5s %-10s %10.1f %9.2f %12.1f %12.1f\n", to_string(isa),
+                            data_type == DataType::QINT8 ? "Q8" : "Q4", shape.name, gemv_ms * 1e3,
+                            static_cast<double>(w.buffer.size()) / (gemv_ms * 1e6), flops / (gemm_ms * 1e6),
+                            flops / (int8_ms * 1e6));
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "support/TestSupport.h"
+#include "t760_engine/kernels/HalfMatmul.h"
+#include "t760_engine/kernels/Sampling.h"
+#include "t760_engine/pipeline/Sampler.h"
+#include "t760_engine/tensor/Float16.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Per-token cost of sampling from a materialized row of Gemma3's 262144
+// logits, per ISA tier: top_k_logits alone, sample_from_logits with the
+// default top_k / top_p, with repetition and frequency penalties over a
+// 500-token history, from an FP16 row, and with top_k = vocab (the
+// quickselect path). A full sort of the row is the baseline.
+
+using namespace t760;
+using namespace t760::kernels;
+
+namespace {
+
+constexpr int64_t VOCAB = 262144;
+constexpr size_t HISTORY_TOKENS = 500;
+
+}
+
+int main() {
+    std::mt19937 rng(44);
+    std::vector<float> row(static_cast<size_t>(VOCAB));
+    test::fill_normal(row, rng, 3.0f);
+    std::vector<uint16_t> half_row(row.size());
+    for (size_t i = 0; i < row.size(); ++i) {
+        half_row[i] = fp32_to_fp16(row[i]);
+    }
+    const HalfKernelSet& half = select_half_kernel_set(test::host_capabilities());
+
+    // Repeats of the row's best tokens, so the penalties reorder the top.
+    std::vector<TokenCandidate> sorted(row.size());
+    for (int64_t i = 0; i < VOCAB; ++i) {
+        sorted[static_cast<size_t>(i)] = TokenCandidate{static_cast<int32_t>(i), row[static_cast<size_t>(i)]};
+    }
+    std::partial_sort(sorted.begin(), sorted.begin() + 300, sorted.end(), ranks_before);
+    std::vector<int> history_tokens(HISTORY_TOKENS);
+    for (size_t i = 0; i < history_tokens.size(); ++i) {
+        history_tokens[i] = sorted[i % 300].token_id;
+    }
+    TokenHistory history;
+    history.add(history_tokens.data(), history_tokens.size());
+
+    const SamplingParams defaults;
+    SamplingParams penalized = defaults;
+    penalized.repetition_penalty = 1.1f;
+    penalized.frequency_penalty = 0.2f;
+    SamplingParams nucleus = defaults;
+    nucleus.top_k = static_cast<uint32_t>(VOCAB);
+
+    std::vector<TokenCandidate> candidates;
+    const double sort_ms = test::time_ms([&] {
+        std::vector<TokenCandidate> all(row.size());
+        for (int64_t i = 0; i < VOCAB; ++i) {
+            all[static_cast<size_t>(i)] = TokenCandidate{static_cast<int32_t>(i), row[static_cast<size_t>(i)]};
+        }
+        std::sort(all.begin(), all.end(), ranks_before);
+        all.resize(defaults.top_k);
+        sample_from_candidates(all, defaults, rng);
+    });
+    std::printf("vocab %lld, full sort + sample of the top %u: %.3f ms/token\n", static_cast<long long>(VOCAB),
+                defaults.top_k, sort_ms);
+    std::printf("%-8s %10s %10s %10s %10s %12s\n", "tier", "top_k", "sample", "penalties", "fp16 row",
+                "top_k=vocab");
+    for (IsaLevel isa : test::host_isa_levels()) {
+        const SamplingKernelSet* ks = get_sampling_kernel_set(isa);
+        if (!ks) {
+            continue;
+        }
+        const double top_k_ms =
+            test::time_ms([&] { top_k_logits(*ks, row.data(), VOCAB, defaults.top_k, candidates); });
+        const double sample_ms =
+            test::time_ms([&] { sample_from_logits(*ks, row.data(), VOCAB, defaults, nullptr, rng, candidates); });
+        const double penalties_ms =
+            test::time_ms([&] { sample_from_logits(*ks, row.data(), VOCAB, penalized, &history, rng, candidates); });
+        const double half_ms = test::time_ms([&] {
+            sample_from_logits_f16(*ks, half, half_row.data(), VOCAB, defaults, nullptr, rng, candidates);
+        });
+        const double nucleus_ms =
+            test::time_ms([&] { sample_from_logits(*ks, row.data(), VOCAB, nucleus, nullptr, rng, candidates); });
+        std::printf("%-8s %10.3f %10.3f %10.3f %10.3f %12.3f  ms/token\n", to_string(isa), top_k_ms, sample_ms,
+                    penalties_ms, half_ms, nucleus_ms);
+    }
+    return 0;
+}
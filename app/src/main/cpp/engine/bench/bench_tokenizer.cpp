@@ -0,0 +1,59 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "support/TestTokenizer.h"
+#include "t760_engine/tokenizer/Tokenizer.h"
+#include <cstdio>
+#include <string>
+
+// Encode and decode throughput (measure_tokenizer_throughput) over 64 KB of
+// chat text, tool-call JSON and non-ASCII, plus the time to open and
+// validate the file. Runs on the test tokenizer unless given a .t760tok,
+// e.g. the model's 262144-token one: bench_tokenizer path/to/tokenizer.t760tok
+
+using namespace t760;
+
+namespace {
+
+constexpr size_t SAMPLE_BYTES = 64 * 1024;
+constexpr uint32_t ITERATIONS = 20;
+
+std::string make_sample() {
+    const std::string paragraph =
+        "<start_of_turn>user\nWhat will the weather be in Paris over the next three days?<end_of_turn>\n"
+        "<start_of_turn>model\n{\"city\": \"Paris\", \"days\": 3, \"unit\": \"celsius\"}<end_of_turn>\n"
+        "The quick brown fox jumps over the lazy dog, then naps in the sun until the evening.\n"
+        "Caf\xC3\xA9 cr\xC3\xA8me, na\xC3\xAFve r\xC3\xA9sum\xC3\xA9, \xE6\x9D\xB1\xE4\xBA\xAC \xF0\x9F\x99\x82\n";
+    std::string sample;
+    while (sample.size() < SAMPLE_BYTES) {
+        sample += paragraph;
+    }
+    return sample;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string path;
+    if (argc > 1) {
+        path = argv[1];
+    } else {
+        path = test::temp_path("t760_bench_tokenizer.t760tok");
+        test::write_test_tokenizer(path);
+    }
+    const double open_ms = test::time_ms([&] { Tokenizer tokenizer(path); });
+    const Tokenizer tokenizer(path);
+    const std::string sample = make_sample();
+    const TokenizerThroughput throughput = measure_tokenizer_throughput(tokenizer, sample, ITERATIONS);
+
+    std::printf("vocab %u, %zu sample bytes, %zu tokens (%.2f bytes/token)\n", tokenizer.vocab_size(),
+                throughput.bytes, throughput.tokens,
+                static_cast<double>(throughput.bytes) / static_cast<double>(throughput.tokens));
+    std::printf("%-8s %12.3f ms\n", "open", open_ms);
+    std::printf("%-8s %12.1f MB/s\n", "encode", throughput.encode_mb_per_s);
+    std::printf("%-8s %12.1f MB/s\n", "decode", throughput.decode_mb_per_s);
+
+    if (argc <= 1) {
+        std::remove(path.c_str());
+    }
+    return 0;
+}
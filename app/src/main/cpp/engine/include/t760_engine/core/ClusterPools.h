@@ -0,0 +1,38 @@
+#ifndef T760_CLUSTER_POOLS_H
+#define T760_CLUSTER_POOLS_H
+
+#include "t760_engine/core/ThreadPool.h"
+#include "t760_engine/core/Types.h"
+#include "t760_engine/device/DeviceCapabilities.h"
+#include <memory>
+
+namespace t760 {
+
+enum class CoreCluster : uint8_t {
+    BIG,   // A76: decoder kernels and interactive requests
+    LITTLE // A55: background work, at a lower priority
+};
+
+const char* to_string(CoreCluster cluster);
+
+// The engine's worker threads: one pool per cluster, each pinned to its
+// cluster's affinity mask. Kernels receive the big pool through their
+// CpuKernelContext; nothing else in the engine spawns threads.
+class ClusterPools {
+public:
+    ClusterPools(const ThreadingConfig& config, const CpuCapabilities& caps);
+
+    ClusterPools(const ClusterPools&) = delete;
+    ClusterPools& operator=(const ClusterPools&) = delete;
+
+    ThreadPool& get(CoreCluster cluster) { return cluster == CoreCluster::BIG ? *big_ : *little_; }
+
+private:
+    std::unique_ptr<ThreadPool> big_;
+    // One thread (the caller alone) when the host has no efficiency cores.
+    std::unique_ptr<ThreadPool> little_;
+};
+
+}
+
+#endif // T760_CLUSTER_POOLS_H
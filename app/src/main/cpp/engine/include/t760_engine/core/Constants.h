@@ -22,12 +22,33 @@ constexpr uint32_t T760_DEFAULT_MEMORY_ALIGNMENT_BYTES = 128;
 constexpr uint32_t T760_A76_AFFINITY_MASK = 0xF0; // Cores 4, 5, 6, 7
 constexpr uint32_t T760_A55_AFFINITY_MASK = 0x0F; // Cores 0, 1, 2, 3
 constexpr uint32_t T760_DEFAULT_THREAD_COUNT = 4; // Target A76 cores by default
+constexpr int T760_LITTLE_THREAD_NICE = 10; // Background pool on the A55 cores
+constexpr uint32_t T760_POOL_SPIN_US = 50; // Idle pool workers spin this long before parking
 constexpr uint32_t T760_GPU_OPTIMAL_WORKGROUP_SIZE = 128;
 constexpr uint32_t T760_NPU_OPTIMAL_BATCH_SIZE = 1;
 
 // Engine Behavior Configuration
 constexpr uint32_t MAX_SUPPORTED_SEQ_LEN = 4096;
 constexpr uint32_t MAX_CONCURRENT_CONVERSATIONS = 8;
+constexpr uint32_t DEFAULT_PREFILL_CHUNK_TOKENS = 32; // Prompt tokens one conversation adds to a step
+constexpr uint32_t DEFAULT_STEP_TOKEN_BUDGET = 64; // Decode plus prompt tokens per step
+constexpr uint32_t DEFAULT_MAX_NEW_TOKENS = 256; // Per generate_async call
+constexpr uint32_t DEFAULT_DRAFT_TOKENS = 4; // Proposed per speculative step
+
+// Sampling defaults (generation_config.json)
+constexpr uint32_t DEFAULT_SAMPLING_TOP_K = 64;
+constexpr float DEFAULT_SAMPLING_TOP_P = 0.95f;
+
+// Gemma3 architecture (config.json); the T760 header only carries rope_theta.
+constexpr uint32_t GEMMA3_SLIDING_WINDOW = 512;
+constexpr uint32_t GEMMA3_SLIDING_WINDOW_PATTERN = 6; // Every 6th layer attends globally
+constexpr float GEMMA3_ROPE_THETA = 1000000.0f;
+constexpr float GEMMA3_ROPE_LOCAL_BASE_FREQ = 10000.0f;
+constexpr float GEMMA3_QUERY_PRE_ATTN_SCALAR = 256.0f;
+constexpr float GEMMA3_RMS_NORM_EPS = 1e-6f;
+
+// Weight Quantization
+constexpr uint32_t QUANT_GROUP_SIZE = 64; // Elements sharing one scale along the input dimension
 
 } // namespace t760::constants
 
@@ -2,12 +2,22 @@
 #define T760_ENGINE_H
 
 #include "t760_engine/core/Types.h"
+#include "t760_engine/core/Generation.h"
+#include "t760_engine/grammar/TokenGrammar.h"
+#include "t760_engine/pipeline/PipelineTypes.h"
+#include "t760_engine/tokenizer/Tokenizer.h"
+#include <atomic>
+#include <condition_variable>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace t760 {
 
+class ClusterPools;
 class IPlatformBackend;
 class DeviceManager;
 class ModelLoader;
@@ -15,6 +25,18 @@ class TensorManager;
 class InferencePipeline;
 class Tensor;
 
+// Thread safety: generate(), start_new_conversation() and end_conversation()
+// may be called from any number of threads. Calls on different conversations
+// run in parallel (and batch together, see InferencePipeline); calls on one
+// conversation run one at a time. Lifecycle transitions (initialize,
+// load_model, unload_model, shutdown) wait for the calls in flight to finish
+// and hold back new ones until they are done; a waiting transition also
+// holds back new calls, so a steady stream of them cannot starve it. Ending a conversation while a call
+// on it is running lets that call finish; later calls on it throw.
+// Unloading the model or shutting down cancels running generate_async tasks.
+// Loading or unloading a draft model is a transition too, but lets them run.
+// The tokenizer is independent of the model and the lifecycle: it can be
+// loaded at any time, and a reload does not disturb calls using the old one.
 class Engine {
 public:
     Engine();
@@ -27,19 +49,124 @@ public:
     void shutdown();
     bool load_model(const std::string& model_path);
     void unload_model();
-    ConversationHandle start_new_conversation();
+    // Loads a smaller .t760 model of the same vocab as the draft for
+    // speculative decoding (see InferencePipeline::attach_draft), replacing
+    // any loaded one. Conversations started from here on speculate; it is
+    // unloaded with the model. False when the file cannot be loaded; throws
+    // when no model is loaded or the draft does not fit it.
+    bool load_draft_model(const std::string& model_path);
+    void unload_draft_model();
+    ConversationHandle start_new_conversation(const ConversationOptions& options = {});
     void end_conversation(ConversationHandle handle);
-    std::unique_ptr<Tensor> generate(ConversationHandle handle, const std::vector<int>& input_token_ids);
+    // Tokens the conversation can still take before it reaches the model's
+    // sequence length; no generation on it delivers more.
+    size_t remaining_context(ConversationHandle handle);
+    StepOutput generate(ConversationHandle handle, const std::vector<int>& input_token_ids,
+                        const OutputOptions& options = {});
+    // As above, into a caller-owned output: reusing output (and passing
+    // OutputOptions::logits_out for the full row) keeps a decode step free of
+    // heap allocation.
+    void generate(ConversationHandle handle, const int* input_token_ids, size_t count, StepOutput& output,
+                  const OutputOptions& options = {});
+    // generate() with the draft model proposing tokens ahead (see
+    // InferencePipeline::execute_speculative): output.tokens holds every
+    // token the step produced, the last of which has not been fed.
+    void generate_speculative(ConversationHandle handle, const int* input_token_ids, size_t count,
+                              const OutputOptions& options, const SpeculationOptions& speculation,
+                              SpeculativeOutput& output);
+    // Runs the prompt's prefill and the decode loop on a generation thread:
+    // each sampled token goes to on_token and is fed back, until a stop
+    // token, max_new_tokens, cancel() or a failure; on_done follows the last
+    // token. Other calls on the conversation must wait for the task to end.
+    // On a conversation with a draft, steps speculate (see
+    // GenerationParams::draft_tokens) and deliver the same checks per token.
+    std::shared_ptr<GenerationTask> generate_async(ConversationHandle handle, std::vector<int> prompt,
+                                                   const GenerationParams& params, TokenCallback on_token,
+                                                   GenerationDoneCallback on_done = {});
+    // Generates a completion for each prompt, as generate_async would on a
+    // conversation of its own, and returns them in prompt order. Up to
+    // max_active prompts run at once: their prefills share steps and their
+    // decode steps run as one batch, and a finished prompt's conversation is
+    // reset for the next one instead of being ended and recreated. Failures
+    // land in the completions; unloading the model fails the prompts left.
+    // Batches do not speculate: their decode steps already share one sweep
+    // of the weights.
+    std::vector<BatchCompletion> generate_batch(const std::vector<BatchPrompt>& prompts,
+                                                const BatchOptions& options = {});
+    // Runs the prompts one conversation at a time, then through
+    // generate_batch, and reports both rates.
+    BatchThroughput benchmark_batch(const std::vector<BatchPrompt>& prompts, const BatchOptions& options = {});
+    // Pools the final hidden states of token_ids into one embedding_size()
+    // vector. Only the decoder stack runs: no lm_head, no sampling, and no
+    // conversation or cache is kept.
+    std::vector<float> embed(const std::vector<int>& token_ids, const EmbeddingOptions& options = {});
+    // One vector per input, in input order; the inputs share steps.
+    std::vector<std::vector<float>> embed_batch(const std::vector<std::vector<int>>& inputs,
+                                                const EmbeddingOptions& options = {});
+    // Floats per embedding: the model's hidden size.
+    size_t embedding_size() const;
+    // ITL and TTFT percentiles of recent generate() calls in one priority class.
+    LatencyStats get_latency_stats(RequestPriority priority = RequestPriority::INTERACTIVE) const;
+    // Acceptance and effective token rate of the draft model's steps.
+    SpeculationStats get_speculation_stats() const;
+    // Maps a .t760tok file (see tools/convert_tokenizer.cpp), replacing any
+    // loaded tokenizer; false when the file cannot be used.
+    bool load_tokenizer(const std::string& path);
+    // These throw when no tokenizer is loaded.
+    std::vector<int> encode(std::string_view text, bool add_bos = true) const;
+    std::string decode(const std::vector<int>& token_ids, bool skip_special = true) const;
+    // Appends to out, whose capacity a streaming caller can reuse.
+    void decode(const int* token_ids, size_t count, bool skip_special, std::string& out) const;
+    // Id of a vocab piece such as "<end_of_turn>", or -1.
+    int32_t token_id(std::string_view piece) const;
+    TokenizerThroughput benchmark_tokenizer(std::string_view sample, uint32_t iterations) const;
+    // A regex or JSON schema (see Grammar) over the loaded tokenizer's
+    // vocab, for GenerationParams::grammar. Compile once and share: token
+    // masks are built as generations reach each state and kept. Throws on
+    // an invalid grammar or when no tokenizer is loaded.
+    std::shared_ptr<const TokenGrammar> compile_grammar(std::string_view source, GrammarSyntax syntax) const;
     EngineState get_state() const;
     bool is_model_loaded() const;
 
 private:
-    EngineState state_ = EngineState::UNINITIALIZED;
+    // Scopes a call that uses the loaded model, or a lifecycle transition
+    // that must run alone.
+    class CallScope;
+    class TransitionScope;
+
+    void shutdown_locked();
+    void unload_model_locked();
+    void unload_draft_model_locked();
+    void run_generation(GenerationTask& task, ConversationHandle handle, const std::vector<int>& prompt,
+                        const GenerationParams& params, const TokenCallback& on_token);
+    // Cancels every generation and joins their threads; must not be called
+    // inside a TransitionScope, which their steps would wait behind.
+    void stop_generations();
+    std::shared_ptr<const Tokenizer> tokenizer() const;
+
+    // Never INFERENCE_ACTIVE; get_state() derives that from active_calls_.
+    std::atomic<EngineState> state_{EngineState::UNINITIALIZED};
+    mutable std::mutex lifecycle_mutex_;
+    mutable std::condition_variable lifecycle_cv_;
+    mutable std::atomic<uint32_t> active_calls_{0};
+    bool transition_ = false; // A transition is waiting or running
     std::unique_ptr<DeviceManager> device_manager_;
+    std::unique_ptr<ClusterPools> thread_pools_;
     std::unique_ptr<IPlatformBackend> platform_backend_;
     std::unique_ptr<TensorManager> tensor_manager_;
     std::unique_ptr<ModelLoader> model_loader_;
+    std::unique_ptr<ModelLoader> draft_loader_;
     std::unique_ptr<InferencePipeline> inference_pipeline_;
+
+    struct Generation {
+        std::shared_ptr<GenerationTask> task;
+        std::thread thread;
+    };
+    std::mutex generations_mutex_;
+    std::vector<Generation> generations_; // Finished ones are joined lazily
+
+    mutable std::mutex tokenizer_mutex_;
+    std::shared_ptr<const Tokenizer> tokenizer_; // Held by each call using it
 };
 }
 
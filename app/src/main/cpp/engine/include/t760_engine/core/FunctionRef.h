@@ -0,0 +1,41 @@
+#ifndef T760_FUNCTION_REF_H
+#define T760_FUNCTION_REF_H
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace t760 {
+
+template <typename Signature>
+class FunctionRef;
+
+// Non-owning reference to a callable, for parameters that are called before
+// the function returns (ThreadPool::parallel_for and the kernels' task
+// loops). Unlike std::function it never allocates: a kernel lambda capturing
+// more than two references would otherwise cost a heap allocation on every
+// launch, dozens per decode step. The callable must outlive the reference.
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+public:
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, FunctionRef> &&
+                                                      std::is_invocable_r_v<R, F&, Args...>>>
+    FunctionRef(F&& f) noexcept
+        : object_(const_cast<void*>(static_cast<const void*>(std::addressof(f)))),
+          call_(&invoke<std::remove_reference_t<F>>) {}
+
+    R operator()(Args... args) const { return call_(object_, std::forward<Args>(args)...); }
+
+private:
+    template <typename F>
+    static R invoke(void* object, Args... args) {
+        return (*static_cast<F*>(object))(std::forward<Args>(args)...);
+    }
+
+    void* object_;
+    R (*call_)(void*, Args...);
+};
+
+}
+
+#endif // T760_FUNCTION_REF_H
@@ -0,0 +1,146 @@
+#ifndef T760_GENERATION_H
+#define T760_GENERATION_H
+
+#include "t760_engine/core/Constants.h"
+#include "t760_engine/core/Types.h"
+#include "t760_engine/pipeline/Sampler.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace t760 {
+
+class TokenGrammar;
+
+// Settings of one Engine::generate_async call.
+struct GenerationParams {
+    SamplingParams sampling;
+    uint32_t max_new_tokens = constants::DEFAULT_MAX_NEW_TOKENS;
+    // Sampling one of these ends generation; the stop token is not delivered.
+    std::vector<int32_t> stop_tokens;
+    // Restricts every sampled token to those that keep the output a prefix
+    // of the grammar's language (see Engine::compile_grammar). Stop tokens
+    // are allowed once the output is complete; generation ends by itself,
+    // STOPPED, when nothing can extend it.
+    std::shared_ptr<const TokenGrammar> grammar;
+    // Tokens a loaded draft model (see Engine::load_draft_model) proposes
+    // per step; 0 decodes one token per step. Generations with a grammar or
+    // penalties always do.
+    uint32_t draft_tokens = constants::DEFAULT_DRAFT_TOKENS;
+};
+
+enum class GenerationStatus : uint8_t {
+    RUNNING,
+    STOPPED,   // Sampled a stop token
+    LENGTH,    // Delivered max_new_tokens
+    CANCELLED, // cancel(), or the engine unloaded the model or shut down
+    FAILED     // See GenerationTask::get_error()
+};
+
+// One prompt of an Engine::generate_batch call.
+struct BatchPrompt {
+    std::vector<int> tokens;
+    GenerationParams params;
+};
+
+// Settings of one Engine::generate_batch call.
+struct BatchOptions {
+    // Offline jobs default to the little cluster, out of the way of chat.
+    RequestPriority priority = RequestPriority::BACKGROUND;
+    // Prompts in flight at once, each on a conversation whose caches are
+    // reused by the prompts after it; 0 for the pipeline's decode batch size.
+    uint32_t max_active = 0;
+    // Prompt i samples as a conversation seeded with seed + i would; 0
+    // draws random seeds.
+    uint64_t seed = 0;
+};
+
+// The tokens generate_batch produced for one prompt.
+struct BatchCompletion {
+    std::vector<int32_t> tokens; // Without the stop token
+    GenerationStatus status = GenerationStatus::RUNNING; // Never RUNNING once returned
+    std::string error;
+};
+
+// Generated tokens per second over the same prompts run one conversation at
+// a time through generate() and all together through generate_batch.
+struct BatchThroughput {
+    double sequential_tokens_per_s = 0.0;
+    double batched_tokens_per_s = 0.0;
+    size_t prompts = 0;
+    size_t prompt_tokens = 0;
+    size_t generated_tokens = 0; // By the batched pass
+};
+
+// Called on the generation thread with each token as it is sampled, so it
+// should hand the token off rather than do work.
+using TokenCallback = std::function<void(int32_t token)>;
+// Called on the generation thread once, after the last token.
+using GenerationDoneCallback = std::function<void(GenerationStatus status)>;
+
+// Progress and control of one generate_async call.
+class GenerationTask {
+public:
+    // Generation stops before the next token is delivered; a prompt whose
+    // prefill is running finishes it first.
+    void cancel() { cancelled_ = true; }
+    bool is_cancelled() const { return cancelled_; }
+
+    // Blocks until generation has ended and returns how.
+    GenerationStatus wait() const;
+    GenerationStatus get_status() const;
+    std::string get_error() const;
+    uint32_t get_token_count() const { return token_count_; }
+
+private:
+    friend class Engine;
+    void finish(GenerationStatus status, std::string error = {});
+
+    std::atomic<bool> cancelled_{false};
+    std::atomic<uint32_t> token_count_{0};
+    mutable std::mutex mutex_;
+    mutable std::condition_variable done_cv_;
+    GenerationStatus status_ = GenerationStatus::RUNNING;
+    std::string error_;
+};
+
+// A single-producer, single-consumer token queue between a generation's
+// TokenCallback and one reader that drains it in batches. push() never
+// blocks or allocates; the reader parks only while the ring is empty.
+class TokenStream {
+public:
+    // Holds at least capacity tokens.
+    explicit TokenStream(size_t capacity);
+
+    // Producer side. Returns false when the ring is full.
+    bool push(int32_t token);
+    // No more pushes follow; wakes the reader.
+    void close();
+
+    // Consumer side. Copies up to max_tokens, waiting up to timeout for the
+    // first. Returns the count (0 on timeout), or -1 once the stream is
+    // closed and drained.
+    int64_t read(int32_t* out, size_t max_tokens, std::chrono::milliseconds timeout);
+
+private:
+    void wake_reader();
+
+    std::unique_ptr<int32_t[]> ring_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0}; // Next slot to write
+    alignas(64) std::atomic<size_t> tail_{0}; // Next slot to read
+    std::atomic<bool> closed_{false};
+    std::atomic<bool> reader_waiting_{false};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+}
+
+#endif // T760_GENERATION_H
@@ -0,0 +1,130 @@
+#ifndef T760_THREAD_POOL_H
+#define T760_THREAD_POOL_H
+
+#include "t760_engine/core/Constants.h"
+#include "t760_engine/core/FunctionRef.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace t760 {
+
+class TaskGraph;
+
+// A fixed pool of worker threads pinned to a CPU affinity mask (by default the
+// A76 cluster). The calling thread participates in every dispatch, so a pool
+// of N threads spawns N - 1 workers.
+//
+// parallel_for() splits the task range evenly over the threads; a thread that
+// drains its share steals half of the largest remaining one, so uneven tasks
+// balance without every index going through one shared counter. run() executes
+// a TaskGraph the same way, with ready nodes pushed to per-thread deques.
+//
+// Between dispatches workers spin for spin_us before parking on a condition
+// variable, so back-to-back kernels of one layer start in a few microseconds
+// instead of paying a futex wake each; inside run(), a thread waiting for a
+// node to become ready does the same. Spinning is disabled when the pool has
+// more threads than CPUs it may run on.
+class ThreadPool {
+public:
+    // nice is applied to the workers (Linux per-thread priority); the little
+    // cluster's pool runs background work at a positive value.
+    ThreadPool(uint32_t num_threads, uint64_t affinity_mask, int nice = 0,
+               uint32_t spin_us = constants::T760_POOL_SPIN_US);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Runs fn(task) for every task in [0, num_tasks) and returns once all have
+    // finished. Calls made from inside a task run inline on the caller. The
+    // first exception thrown by a task is rethrown here and the remaining
+    // tasks are skipped.
+    void parallel_for(size_t num_tasks, FunctionRef<void(size_t)> fn);
+
+    // Runs every node of graph once its predecessors have finished and returns
+    // when all have. Exceptions behave as in parallel_for; nodes left
+    // unstarted after a failure are skipped.
+    void run(const TaskGraph& graph);
+
+    uint32_t get_num_threads() const { return num_threads_; }
+    uint64_t get_affinity_mask() const { return affinity_mask_; }
+    int get_nice() const { return nice_; }
+
+private:
+    // A contiguous share of task indices, [begin, end) packed into one word so
+    // the owner's pop and a thief's split are single compare-and-swaps.
+    struct alignas(64) TaskRange {
+        std::atomic<uint64_t> bounds{0};
+    };
+
+    void worker_loop(uint32_t slot);
+    // Runs the current job on behalf of thread `slot` (0 is the caller).
+    void dispatch(FunctionRef<void(uint32_t)> work);
+    bool pop_or_steal(uint32_t slot, size_t& task);
+    void record_error();
+
+    uint32_t num_threads_;
+    uint64_t affinity_mask_;
+    int nice_;
+    uint32_t spin_us_;
+    std::vector<std::thread> workers_;
+    std::unique_ptr<TaskRange[]> ranges_;
+
+    std::mutex submit_mutex_; // Serializes concurrent dispatching callers.
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::atomic<uint64_t> generation_{0};
+    std::atomic<bool> stopping_{false};
+
+    const FunctionRef<void(uint32_t)>* work_ = nullptr;
+    std::atomic<uint32_t> active_workers_{0};
+    std::atomic<bool> failed_{false};
+    std::exception_ptr error_;
+};
+
+// A DAG of kernels for ThreadPool::run. Each node runs fn(task) for task in
+// [0, num_tasks), so one node can be a whole parallel loop; its successors
+// become ready when its last task finishes. Nodes are identified by the
+// order in which they were added and may only depend on earlier nodes, which
+// keeps every graph acyclic by construction.
+class TaskGraph {
+public:
+    using NodeId = size_t;
+
+    NodeId add(std::function<void(size_t)> fn, size_t num_tasks = 1, std::initializer_list<NodeId> after = {});
+    // `node` may not start before `before` has finished.
+    void add_dependency(NodeId node, NodeId before);
+
+    size_t size() const { return nodes_.size(); }
+    void clear() { nodes_.clear(); }
+
+private:
+    friend class ThreadPool;
+    struct Node {
+        std::function<void(size_t)> fn;
+        size_t num_tasks = 1;
+        uint32_t num_predecessors = 0;
+        std::vector<NodeId> successors;
+    };
+    std::vector<Node> nodes_;
+};
+
+// Pins the calling thread to the CPUs in mask. Returns false when the platform
+// refuses or none of the CPUs are online.
+bool pin_current_thread(uint64_t affinity_mask);
+
+// Sets the calling thread's nice value. Returns false where unsupported.
+bool set_current_thread_nice(int nice);
+
+}
+
+#endif // T760_THREAD_POOL_H
@@ -42,15 +42,86 @@ struct ConversationHandle {
     bool is_valid() const { return id != 0; }
 };
 
+// Scheduling class of a conversation (see InferencePipeline).
+enum class RequestPriority : uint8_t {
+    INTERACTIVE, // User-facing chat: big cluster
+    BACKGROUND   // Summarization, indexing: little cluster, yields to interactive steps
+};
+
+struct ConversationOptions {
+    RequestPriority priority = RequestPriority::INTERACTIVE;
+    // Each generate() call should return within this many milliseconds, or
+    // 0 for no deadline. Calls with earlier deadlines are scheduled first, and
+    // a background call past its deadline stops yielding to interactive work.
+    uint32_t deadline_ms = 0;
+    // Seeds the conversation's sampling RNG, so the same seed, prompt and
+    // sampling settings give the same tokens; 0 draws a random seed.
+    uint64_t seed = 0;
+};
+
+// One entry of a next-token candidate list.
+struct TokenCandidate {
+    int32_t token_id;
+    float logit;
+};
+
+// Tokens an output stage may choose: token t < size is allowed when bit
+// t % 64 of words[t / 64] is set. A mask without words allows every token.
+struct TokenMask {
+    const uint64_t* words = nullptr;
+    int64_t size = 0;
+
+    bool is_set() const { return words != nullptr; }
+    bool allows(int32_t token) const {
+        return !words || (token >= 0 && token < size && ((words[token >> 6] >> (token & 63)) & 1) != 0);
+    }
+};
+
 struct DeviceConfig {
     DeviceType type;
     uint64_t memory_budget_mb = 0;
     bool enabled = true;
 };
 
+// How the loader stores floating point weight matrices (see
+// model/WeightPrecision.h).
+enum class WeightPrecision : uint8_t {
+    AUTO,      // Per tensor, a 16-bit format the CPU kernels stream directly
+    AS_STORED, // The checkpoint's data type
+    FP32       // Widened, for reference runs
+};
+
+// Activations of prefill into group-quantized projections (see
+// kernels/DecoderLayer.h).
+enum class PrefillActivations : uint8_t {
+    AUTO, // INT8 where the CPU has an integer dot product path, else FP32
+    FP32, // FP32 rows against dequantized weight panels
+    INT8  // W8A8: per-token int8 rows, guarded per projection input
+};
+
+// Worker pools of the two CPU clusters (see core/ClusterPools.h). Thread
+// counts are capped by the cores the hardware prober reports per cluster.
+struct ThreadingConfig {
+    uint32_t big_threads = constants::T760_DEFAULT_THREAD_COUNT;
+    uint64_t big_affinity_mask = constants::T760_A76_AFFINITY_MASK;
+    uint32_t little_threads = constants::T760_CPU_A55_CORES;
+    uint64_t little_affinity_mask = constants::T760_A55_AFFINITY_MASK;
+    int little_nice = constants::T760_LITTLE_THREAD_NICE;
+    uint32_t spin_us = constants::T760_POOL_SPIN_US;
+};
+
 struct EngineConfig {
     std::vector<DeviceConfig> devices;
+    WeightPrecision weight_precision = WeightPrecision::AUTO;
+    PrefillActivations prefill_activations = PrefillActivations::AUTO;
+    ThreadingConfig threading;
     uint32_t max_concurrent_conversations = constants::MAX_CONCURRENT_CONVERSATIONS;
+    // Prompts are prefilled in chunks of prefill_chunk_tokens, interleaved
+    // with other conversations' decode steps; no step runs more than
+    // step_token_budget tokens, which bounds the inter-token latency of
+    // conversations that are decoding.
+    uint32_t prefill_chunk_tokens = constants::DEFAULT_PREFILL_CHUNK_TOKENS;
+    uint32_t step_token_budget = constants::DEFAULT_STEP_TOKEN_BUDGET;
     bool enable_profiling = false;
 };
 
@@ -20,6 +20,24 @@ struct CpuCapabilities : public DeviceCapabilities {
     bool has_neon_support = false;
     std::string architecture_name;
 
+    // Instruction set extensions detected at runtime (HWCAP on ARM, cpuid on x86).
+    bool has_fp16_arithmetic = false; // asimdhp
+    bool has_dotprod = false;         // asimddp (sdot/udot)
+    bool has_i8mm = false;            // smmla/usdot
+    bool has_bf16 = false;            // bfdot/bfmmla
+    bool has_sse41 = false;
+    bool has_avx2 = false;
+    bool has_fma = false;
+    bool has_f16c = false;
+    bool has_avx512 = false;          // F + BW + VL, with OS support for ZMM state
+    bool has_avx512_vnni = false;
+    bool has_avx512_bf16 = false;
+    bool has_avx_vnni = false;
+
+    // Data cache sizes of one performance core, used to size GEMM blocking.
+    uint32_t l1_cache_kb = constants::T760_L1_CACHE_SIZE_KB;
+    uint32_t l2_cache_kb = constants::T760_L2_CACHE_SIZE_KB;
+
     DeviceType get_type() const override { return DeviceType::CPU; }
 };
 
@@ -0,0 +1,59 @@
+#ifndef T760_GRAMMAR_H
+#define T760_GRAMMAR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace t760 {
+
+enum class GrammarSyntax : uint8_t {
+    REGEX,      // See Grammar
+    JSON_SCHEMA // See json_schema_to_regex
+};
+
+// A regular language over UTF-8 bytes, compiled to a minimal DFA whose states
+// can all still reach an accepting one: a byte that would leave the language
+// has no transition, so a prefix is viable exactly when it reaches a state.
+//
+// The regex syntax covers what structured output needs: literals, '.',
+// classes ([a-z], [^"\\], \d \w \s and their negations), groups ((...) and
+// (?:...)), '|', and the quantifiers * + ? {n} {n,} {n,m}. The whole output
+// must match, so ^ and $ are accepted and ignored. '.' and negated classes
+// match any UTF-8 character outside the set; class ranges must be ASCII.
+//
+// Immutable after construction.
+class Grammar {
+public:
+    // Throws std::runtime_error on a syntax error, an unsupported construct,
+    // an empty language or an automaton past MAX_STATES.
+    Grammar(std::string_view source, GrammarSyntax syntax);
+
+    static constexpr size_t MAX_STATES = 1 << 16;
+
+    int32_t start_state() const { return 0; }
+    // The state after byte, or -1 when it leaves the language.
+    int32_t next_state(int32_t state, uint8_t byte) const { return transitions_[static_cast<size_t>(state) * 256 + byte]; }
+    // The bytes up to state form a complete match.
+    bool is_accepting(int32_t state) const { return accepting_[static_cast<size_t>(state)] != 0; }
+    size_t state_count() const { return accepting_.size(); }
+
+private:
+    std::vector<int32_t> transitions_; // [state_count, 256]
+    std::vector<uint8_t> accepting_;
+};
+
+// The regex of the JSON texts a schema describes, for the subset tool calls
+// use: "type" string (with minLength, maxLength, pattern), integer, number,
+// boolean, null, array (items, minItems, maxItems) and object (properties,
+// required), lists of types, "enum", "const", "anyOf" and "oneOf". Objects
+// list their properties in schema order, optional ones possibly left out,
+// and allow no others; a single optional space may follow ':' and ','.
+// Throws std::runtime_error on invalid JSON or anything outside the subset.
+std::string json_schema_to_regex(std::string_view schema);
+
+}
+
+#endif // T760_GRAMMAR_H
@@ -0,0 +1,86 @@
+#ifndef T760_TOKEN_GRAMMAR_H
+#define T760_TOKEN_GRAMMAR_H
+
+#include "t760_engine/core/Types.h"
+#include "t760_engine/grammar/Grammar.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace t760 {
+
+class Tokenizer;
+
+// A Grammar over a tokenizer's vocab: for each grammar state, the bitset of
+// tokens whose text keeps the output in the language. A state's mask is
+// built the first time a generation reaches it and kept, so a JSON tool
+// call pays for the few dozen states it visits; building walks the vocab in
+// sorted order, sharing the automaton steps of common prefixes and skipping
+// every token below a prefix that has left the language.
+//
+// CONTROL tokens are never in a mask (see GrammarCursor for stop tokens).
+// Thread-safe; any number of generations may share one.
+class TokenGrammar {
+public:
+    TokenGrammar(std::shared_ptr<const Grammar> grammar, std::shared_ptr<const Tokenizer> tokenizer);
+
+    int32_t start_state() const { return grammar_->start_state(); }
+    bool is_accepting(int32_t state) const { return grammar_->is_accepting(state); }
+    // The state after token's text, or -1 when it leaves the language.
+    int32_t next_state(int32_t state, int32_t token) const;
+    // Tokens allowed in state, over vocab_size() tokens; valid as long as
+    // the TokenGrammar.
+    TokenMask allowed(int32_t state) const;
+    // Whether any token is allowed in state.
+    bool can_continue(int32_t state) const;
+    // Builds every state's mask now rather than on first use.
+    void precompute() const;
+
+    size_t vocab_size() const { return vocab_size_; }
+    size_t state_count() const { return grammar_->state_count(); }
+
+private:
+    const std::vector<uint64_t>& mask_for(int32_t state) const;
+    std::vector<uint64_t> build_mask(int32_t state) const;
+
+    std::shared_ptr<const Grammar> grammar_;
+    std::shared_ptr<const Tokenizer> tokenizer_;
+    size_t vocab_size_ = 0;
+    std::string text_;               // Every token's text, back to back
+    std::vector<uint32_t> offsets_;  // Token t is text_[offsets_[t], offsets_[t + 1])
+    std::vector<int32_t> sorted_;    // Tokens with text, by text
+    std::vector<uint32_t> shared_;   // Leading bytes sorted_[i] shares with sorted_[i - 1]
+
+    mutable std::mutex mutex_;
+    mutable std::vector<std::vector<uint64_t>> masks_; // Empty until built
+    mutable std::vector<uint8_t> built_;
+    mutable std::vector<uint8_t> continues_;
+};
+
+// One generation's position in a TokenGrammar. Once the output is a complete
+// match, the stop tokens join the mask, so the model can end it there.
+class GrammarCursor {
+public:
+    GrammarCursor(std::shared_ptr<const TokenGrammar> grammar, std::vector<int32_t> stop_tokens);
+
+    // Tokens the next step may pick; valid until the next call.
+    TokenMask allowed();
+    // Moves past a token: false when it leaves the language.
+    bool advance(int32_t token);
+    // The output is a complete match that no token can extend, so
+    // generation should end.
+    bool is_finished() const;
+
+private:
+    std::shared_ptr<const TokenGrammar> grammar_;
+    std::vector<int32_t> stop_tokens_;
+    int32_t state_;
+    std::vector<uint64_t> with_stops_; // The accepting state's mask plus stop tokens
+    int32_t with_stops_state_ = -1;
+};
+
+}
+
+#endif // T760_TOKEN_GRAMMAR_H
@@ -0,0 +1,74 @@
+#ifndef T760_ATTENTION_H
+#define T760_ATTENTION_H
+
+#include "t760_engine/core/Types.h"
+#include "t760_engine/kernels/KernelRegistry.h"
+#include "t760_engine/kernels/Rope.h"
+#include <cstdint>
+
+namespace t760::kernels {
+
+// Fused scaled-dot-product attention over a KV cache with an online softmax,
+// so no [queries x keys] score matrix is ever materialized. Keys and values
+// are packed in cache-sized blocks, and Q * K^T and P * V for a block run on
+// the dense GEMM micro-kernels of ctx.gemm. Every query head of a GQA group is
+// processed against the same block, so each KV head is read once per query
+// block.
+//
+// With params.rope set, positions are encoded inside the kernels: queries are
+// rotated while they are scaled and packed, and keys once when
+// kv_cache_append stores them, so the cache always holds rotated keys.
+
+struct AttentionParams {
+    int64_t num_heads = 0;      // Query heads
+    int64_t num_kv_heads = 0;   // Must divide num_heads
+    int64_t head_dim = 0;
+    float scale = 1.0f;         // Gemma: query_pre_attn_scalar^-0.5
+    int64_t sliding_window = 0; // 0 for global attention
+    const RopeTable* rope = nullptr; // Rotary table for this layer, or none
+};
+
+// The KV cache of one layer, laid out [positions, num_kv_heads, head_dim].
+struct KvCacheView {
+    const void* keys = nullptr;
+    const void* values = nullptr;
+    DataType data_type = DataType::FP32; // FP32 or FP16
+    int64_t length = 0;                  // Valid positions, starting at 0
+};
+
+// Writable storage behind a KvCacheView, same layout.
+struct KvCacheBuffer {
+    void* keys = nullptr;
+    void* values = nullptr;
+    DataType data_type = DataType::FP32;
+    int64_t capacity = 0; // Positions
+
+    KvCacheView view(int64_t length) const { return KvCacheView{keys, values, data_type, length}; }
+};
+
+// True when the query at position query_pos may attend to the key at key_pos.
+inline bool attention_visible(int64_t query_pos, int64_t key_pos, int64_t sliding_window) {
+    return key_pos <= query_pos && (sliding_window <= 0 || query_pos - key_pos < sliding_window);
+}
+
+// q and out are [num_queries, num_heads, head_dim] FP32. Query i sits at
+// absolute position first_pos + i and sees keys through the causal and
+// optional sliding-window mask; kv.length must cover the last query.
+// A single query takes the decode path, which splits the visible keys across
+// the pool; longer runs split over KV heads and query blocks.
+void flash_attention(const AttentionParams& params, const CpuKernelContext& ctx, const float* q,
+                     int64_t num_queries, int64_t first_pos, const KvCacheView& kv, float* out);
+
+// Stores k and v, both [count, num_kv_heads, head_dim] FP32, at positions
+// [first_pos, first_pos + count), rotating the keys with params.rope and
+// narrowing to the cache's data type.
+void kv_cache_append(const AttentionParams& params, const CpuKernelContext& ctx, const float* k, const float* v,
+                     int64_t count, int64_t first_pos, const KvCacheBuffer& cache);
+
+// Materializes the full score matrix; the correctness baseline.
+void attention_reference(const AttentionParams& params, const float* q, int64_t num_queries,
+                         int64_t first_pos, const KvCacheView& kv, float* out);
+
+} // namespace t760::kernels
+
+#endif // T760_ATTENTION_H
@@ -0,0 +1,130 @@
+#ifndef T760_DECODER_LAYER_H
+#define T760_DECODER_LAYER_H
+
+#include "t760_engine/kernels/Attention.h"
+#include "t760_engine/kernels/HalfMatmul.h"
+#include "t760_engine/kernels/KernelRegistry.h"
+#include "t760_engine/kernels/ShapeSpecialized.h"
+#include "t760_engine/tensor/QuantizedLayout.h"
+#include <cstdint>
+#include <vector>
+
+namespace t760 {
+class Tensor;
+}
+
+namespace t760::kernels {
+
+// CPU forward pass of one Gemma3 decoder layer:
+//
+//   h = x + post_attention_norm(o_proj(attention(rope(q_norm(q_proj(n))), ...)))   n = input_norm(x)
+//   x = h + post_feedforward_norm(down_proj(gelu_tanh(gate_proj(m)) * up_proj(m)))  m = pre_feedforward_norm(h)
+//
+// Run op by op, every arrow above is another pass over the activations. The
+// fused kernels instead:
+// - normalize straight into the packed projection input: during decode that
+//   is the int8 row the quantized GEMV consumes, quantized once and shared by
+//   q/k/v (and by gate/up), with all of their rows in a single pool dispatch
+//   (with int8_prefill, prefill rows are quantized the same way);
+// - rotate queries while attention packs them and keys as they are appended
+//   to the KV cache, from tables precomputed per RoPE base;
+// - compute gate and up rows in 64-row chunks and apply GELU-tanh and the
+//   product while both are in L1; during decode into a quantized down
+//   projection each chunk is also quantized in place as one group of its input.
+// Post-norms are folded into the residual add.
+
+// A projection, [out, in] as checkpoints store it in every data type:
+// group-quantized (see QuantizedLayout.h), FP16 / BF16 (see HalfMatmul.h) or
+// FP32 rows. Each type is split over the pool by output rows.
+struct LinearWeight {
+    DataType data_type = DataType::FP32;
+    int64_t in_features = 0;
+    int64_t out_features = 0;
+    const float* dense = nullptr; // FP32
+    HalfMatrixView half;          // FP16 / BF16
+    QuantizedMatrixView quantized;
+};
+
+LinearWeight make_linear_weight(const Tensor& weight);
+
+// Gemma's RMSNorm multiplies by (1 + weight); the gain holds that sum in FP32
+// whatever the checkpoint's data type.
+std::vector<float> make_norm_gain(const Tensor& weight);
+
+struct DecoderLayerWeights {
+    std::vector<float> input_norm;            // [hidden]
+    std::vector<float> post_attention_norm;   // [hidden]
+    std::vector<float> pre_feedforward_norm;  // [hidden]
+    std::vector<float> post_feedforward_norm; // [hidden]
+    std::vector<float> q_norm;                // [head_dim], per head
+    std::vector<float> k_norm;                // [head_dim], per head
+    LinearWeight q_proj;
+    LinearWeight k_proj;
+    LinearWeight v_proj;
+    LinearWeight o_proj;
+    LinearWeight gate_proj;
+    LinearWeight up_proj;
+    LinearWeight down_proj;
+};
+
+struct DecoderLayerParams {
+    int64_t hidden_size = 0;
+    int64_t intermediate_size = 0;
+    AttentionParams attention; // Carries this layer's window and RoPE table
+    float rms_norm_eps = 1e-6f;
+    // Fixed-size kernels for this shape (find_shape_kernel_set), or nullptr
+    // for the generic loops.
+    const ShapeKernelSet* fixed = nullptr;
+    // W8A8 prefill: multi-row inputs of quantized projections are quantized
+    // per token like the decode row and run on the integer GEMM. The guard
+    // keeps FP32 activations for any input whose worst row error
+    // (quantize_rows_q8) exceeds int8_prefill_max_error.
+    bool int8_prefill = false;
+    float int8_prefill_max_error = 0.015f;
+};
+
+// Throws when the weight shapes do not match params.
+void validate_decoder_layer(const DecoderLayerParams& params, const DecoderLayerWeights& weights);
+
+// x is the [count, hidden] residual stream of positions [first_pos,
+// first_pos + count) and is updated in place. The layer's keys and values for
+// those positions are appended to cache first.
+void decoder_layer_forward(const DecoderLayerParams& params, const DecoderLayerWeights& weights,
+                           const CpuKernelContext& ctx, float* x, int64_t count, int64_t first_pos,
+                           const KvCacheBuffer& cache);
+
+// One sequence of a batched layer call: its next count rows of x sit at
+// positions [first_pos, first_pos + count) of its own cache.
+struct DecoderSequence {
+    int64_t count = 1;
+    int64_t first_pos = 0;
+    KvCacheBuffer cache;
+};
+
+// Runs several sequences through the layer at once, their rows stacked in x
+// in sequence order. Norms, projections and the MLP see one [total rows,
+// hidden] batch, so each weight matrix is streamed once per call rather than
+// once per sequence; only the KV append and attention run per sequence. When
+// every sequence contributes a single row (a batch of decode steps) each row
+// is quantized per token as a lone decode row is, and the projections run on
+// the integer GEMM, which matches the GEMV bit for bit.
+void decoder_layer_forward_batch(const DecoderLayerParams& params, const DecoderLayerWeights& weights,
+                                 const CpuKernelContext& ctx, float* x, const DecoderSequence* sequences,
+                                 size_t num_sequences);
+
+// The same layer op by op on the scalar reference kernels, one pass per
+// operation; the correctness baseline for the fused path.
+void decoder_layer_reference(const DecoderLayerParams& params, const DecoderLayerWeights& weights, float* x,
+                             int64_t count, int64_t first_pos, const KvCacheBuffer& cache);
+
+// out[i, :] = x[i, :] * rsqrt(mean(x[i, :]^2) + eps) * gain for count rows of n.
+// out may alias x.
+void rms_norm(const float* x, int64_t count, int64_t n, const float* gain, float eps, float* out);
+
+// out[i] = gelu_tanh(gate[i]) * up[i], with a polynomial exp so the loop
+// vectorizes; within 1e-6 of the std::tanh formula.
+void gelu_tanh_multiply(const float* gate, const float* up, int64_t n, float* out);
+
+} // namespace t760::kernels
+
+#endif // T760_DECODER_LAYER_H
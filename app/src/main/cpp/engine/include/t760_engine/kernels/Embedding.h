@@ -0,0 +1,25 @@
+#ifndef T760_EMBEDDING_H
+#define T760_EMBEDDING_H
+
+#include "t760_engine/kernels/KernelRegistry.h"
+#include "t760_engine/kernels/VocabTable.h"
+#include <cstdint>
+
+namespace t760::kernels {
+
+// Token embedding gather: out[i, :] = table[token_ids[i], :] * scale in FP32.
+// Group-quantized rows are dequantized straight into out, so the table stays
+// resident in its stored precision and no FP32 copy of it ever exists. Rows a
+// few tokens ahead are prefetched while the current one is expanded, hiding
+// the latency of the random row accesses. Long batches (prefill) are split
+// across ctx.pool. Gemma passes scale = sqrt(hidden_size).
+void embedding_lookup(const VocabTableView& table, const CpuKernelContext& ctx, const int32_t* token_ids,
+                      int64_t count, float scale, float* out);
+
+// Element-by-element gather; the correctness baseline.
+void embedding_lookup_reference(const VocabTableView& table, const int32_t* token_ids, int64_t count, float scale,
+                                float* out);
+
+} // namespace t760::kernels
+
+#endif // T760_EMBEDDING_H
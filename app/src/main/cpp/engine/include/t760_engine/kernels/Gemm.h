@@ -0,0 +1,98 @@
+#ifndef T760_GEMM_H
+#define T760_GEMM_H
+
+#include "t760_engine/kernels/KernelRegistry.h"
+#include <cstdint>
+
+namespace t760::kernels {
+
+// Packed, cache-blocked GEMM for dense weights: c[M, N] = a[M, K] * b[K, N],
+// all row-major. a and c are FP32; b is FP32 or FP16.
+//
+// The loop nest follows the usual Goto/BLIS structure. A kc x nc block of b
+// is packed into nr-wide micro-panels sized for L1, an mc x kc block of a is
+// packed into mr-tall micro-panels sized for L2, and an ISA micro-kernel
+// keeps an mr x nr tile of c in registers. (mc, nc) blocks of c are
+// independent tasks spread over the thread pool.
+
+namespace isa {
+// c[0:mr, 0:nr] (+)= a_panel^T * b_panel over kc steps. a_panel holds mr
+// values per step, b_panel holds nr values per step. When accumulate is false
+// the tile is overwritten.
+using GemmMicroF32Fn = void (*)(int64_t kc, const float* a_panel, const float* b_panel,
+                                float* c, int64_t ldc, bool accumulate);
+// As above with FP16 panels. Products are accumulated in FP16 registers for
+// one kc block and widened into the FP32 tile of c.
+using GemmMicroF16Fn = void (*)(int64_t kc, const uint16_t* a_panel, const uint16_t* b_panel,
+                                float* c, int64_t ldc, bool accumulate);
+using ConvertF16ToF32Fn = void (*)(const uint16_t* src, float* dst, int64_t n);
+using ConvertF32ToF16Fn = void (*)(const float* src, uint16_t* dst, int64_t n);
+}
+
+struct GemmKernelSet {
+    int64_t mr;
+    int64_t nr;
+    isa::GemmMicroF32Fn micro_f32;
+    // Widens FP16 weights while packing them for micro_f32.
+    isa::ConvertF16ToF32Fn f16_to_f32;
+
+    // Optional native FP16 path (nullptr when the tier has none).
+    int64_t mr_f16;
+    int64_t nr_f16;
+    isa::GemmMicroF16Fn micro_f16;
+    isa::ConvertF32ToF16Fn f32_to_f16;
+};
+
+// Kernel set for an ISA tier, or nullptr when none is compiled in for it.
+const GemmKernelSet* get_gemm_kernel_set(IsaLevel isa);
+
+// The fastest FP32 kernel set a host with caps can run.
+const GemmKernelSet& select_gemm_kernel_set(const CpuCapabilities& caps);
+
+struct GemmBlocking {
+    int64_t mc;
+    int64_t kc;
+    int64_t nc;
+};
+
+// Derives block sizes for an mr x nr micro-kernel: the kc x (mr + nr) working
+// set of one micro-kernel call takes half of L1, the packed a block a quarter
+// of L2 and the packed b block half of L2.
+GemmBlocking make_gemm_blocking(uint32_t l1_cache_kb, uint32_t l2_cache_kb, int64_t mr, int64_t nr,
+                                int64_t element_bytes);
+
+// Blocking is derived from ctx's cache sizes; ctx.pool may be nullptr to run
+// on the calling thread.
+void gemm_f32(const GemmKernelSet& ks, const CpuKernelContext& ctx,
+              int64_t m, int64_t n, int64_t k, const float* a, const float* b, float* c);
+
+// b is IEEE binary16. Uses the native FP16 micro-kernel when the set has one,
+// otherwise widens b to FP32 during packing.
+void gemm_f16(const GemmKernelSet& ks, const CpuKernelContext& ctx,
+              int64_t m, int64_t n, int64_t k, const float* a, const uint16_t* b, float* c);
+
+// Straightforward scalar implementation used as the correctness baseline.
+void gemm_f32_reference(int64_t m, int64_t n, int64_t k, const float* a, const float* b, float* c);
+
+// --- ISA-specific building blocks ---
+// These are only safe to call once the matching CPU feature has been confirmed.
+namespace isa {
+
+#if defined(__aarch64__)
+void gemm_micro_f32_neon(int64_t kc, const float* a_panel, const float* b_panel, float* c, int64_t ldc, bool accumulate);
+void convert_f16_to_f32_neon(const uint16_t* src, float* dst, int64_t n);
+void gemm_micro_f16_neon_fp16(int64_t kc, const uint16_t* a_panel, const uint16_t* b_panel, float* c, int64_t ldc, bool accumulate);
+void convert_f32_to_f16_neon(const float* src, uint16_t* dst, int64_t n);
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+void gemm_micro_f32_sse41(int64_t kc, const float* a_panel, const float* b_panel, float* c, int64_t ldc, bool accumulate);
+void gemm_micro_f32_avx2(int64_t kc, const float* a_panel, const float* b_panel, float* c, int64_t ldc, bool accumulate);
+void convert_f16_to_f32_f16c(const uint16_t* src, float* dst, int64_t n);
+#endif
+
+} // namespace isa
+
+} // namespace t760::kernels
+
+#endif // T760_GEMM_H
@@ -0,0 +1,100 @@
+#ifndef T760_HALF_MATMUL_H
+#define T760_HALF_MATMUL_H
+
+#include "t760_engine/kernels/KernelRegistry.h"
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include <cstdint>
+
+namespace t760 {
+class Tensor;
+}
+
+namespace t760::kernels {
+
+// Matmul kernels over 16-bit floating point weights W of shape [N, K] (the
+// PyTorch Linear layout), FP16 or BF16, that never store an FP32 copy.
+//
+// Decode (GEMV) is bound by weight bandwidth, so each tier streams the 16-bit
+// rows and widens them in registers (F16C vcvtph2ps, NEON fcvtl, or a 16-bit
+// shift for BF16) ahead of an FP32 FMA. Tiers with a BF16 dot product
+// (AVX512-BF16 vdpbf16ps, NEON bfdot) instead round the activation row to
+// BF16 once and accumulate pairwise products in FP32, as BF16 inference on
+// other runtimes does; all other tiers match the reference to FP32 rounding.
+// Prefill (GEMM) widens panels of four weight rows once per call and reuses
+// the quantized kernels' FP32 panel micro-kernel; a handful of rows (a batch
+// of decode steps) instead runs the GEMV per row over L1-sized weight blocks.
+
+struct HalfMatrixView {
+    DataType data_type = DataType::FP16; // FP16 or BF16
+    int64_t rows = 0;                    // N
+    int64_t cols = 0;                    // K
+    const uint16_t* data = nullptr;      // [rows, cols]
+};
+
+HalfMatrixView make_half_matrix_view(const Tensor& weight);
+
+namespace isa {
+// y[r] = dot(W row r, x) for `rows` consecutive rows of length k.
+using GemvHalfFn = void (*)(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y);
+using ConvertHalfToF32Fn = void (*)(const uint16_t* src, float* dst, int64_t n);
+}
+
+// The ISA-specific building blocks one tier provides.
+struct HalfKernelSet {
+    isa::GemvHalfFn gemv_f16;
+    isa::GemvHalfFn gemv_bf16;
+    isa::ConvertHalfToF32Fn f16_to_f32;
+    isa::ConvertHalfToF32Fn bf16_to_f32;
+    isa::GemmPanelF32Fn gemm_panel;
+};
+
+// Kernel set for an ISA tier, or nullptr when none is compiled in for it.
+// Callers are responsible for checking that the host supports the tier.
+const HalfKernelSet* get_half_kernel_set(IsaLevel isa);
+
+// The fastest kernel set a host with caps can run.
+const HalfKernelSet& select_half_kernel_set(const CpuCapabilities& caps);
+
+// y[N] = W * x[K]
+void gemv_half(const HalfKernelSet& ks, const float* x, const HalfMatrixView& w, float* y);
+
+// c[M, N] = a[M, K] * W^T, with a and c row-major and densely packed.
+void gemm_half(const HalfKernelSet& ks, const float* a, int64_t m, const HalfMatrixView& w, float* c);
+
+// Output rows [row_begin, row_end) only, written from y[0] / c[0]; c has
+// leading dimension ldc. gemm_half_rows on up to eight rows runs the GEMV per
+// row, bit-identical to gemv_half_rows; otherwise cols must be a multiple of
+// QUANT_GROUP_SIZE, as the panel kernels assume.
+void gemv_half_rows(const HalfKernelSet& ks, const float* x, const HalfMatrixView& w, int64_t row_begin,
+                    int64_t row_end, float* y);
+void gemm_half_rows(const HalfKernelSet& ks, const float* a, int64_t m, const HalfMatrixView& w, int64_t row_begin,
+                    int64_t row_end, float* c, int64_t ldc);
+
+// Widens every weight with the portable conversions and accumulates in FP32;
+// the correctness baseline.
+void gemm_half_reference(const float* a, int64_t m, const HalfMatrixView& w, float* c);
+
+// --- ISA-specific building blocks ---
+// These are only safe to call once the matching CPU feature has been confirmed.
+namespace isa {
+
+#if defined(__aarch64__)
+void gemv_f16_neon(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y);
+void gemv_bf16_neon(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y);
+void convert_bf16_to_f32_neon(const uint16_t* src, float* dst, int64_t n);
+void gemv_bf16_neon_bf16(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y);
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+void gemv_f16_avx2(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y);
+void gemv_bf16_avx2(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y);
+void convert_bf16_to_f32_avx2(const uint16_t* src, float* dst, int64_t n);
+void gemv_f16_avx512(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y);
+void gemv_bf16_avx512_bf16(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y);
+#endif
+
+} // namespace isa
+
+} // namespace t760::kernels
+
+#endif // T760_HALF_MATMUL_H
@@ -0,0 +1,115 @@
+#ifndef T760_KERNEL_REGISTRY_H
+#define T760_KERNEL_REGISTRY_H
+
+#include "t760_engine/core/Types.h"
+#include "t760_engine/device/DeviceCapabilities.h"
+#include "t760_engine/tensor/Tensor.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace t760 {
+
+enum class KernelOp : uint8_t {
+    MATMUL = 0
+};
+
+// Instruction set tiers, ordered from slowest to fastest within each
+// architecture. Only tiers of the host architecture are ever registered, so a
+// higher value always means "preferred" when two kernels share a key.
+enum class IsaLevel : uint8_t {
+    SCALAR = 0,
+    NEON = 10,
+    NEON_FP16 = 11,
+    NEON_DOTPROD = 12,
+    NEON_I8MM = 13,
+    NEON_BF16 = 14,
+    SSE41 = 20,
+    AVX2 = 21,
+    AVX512 = 22,
+    AVX512_VNNI = 23,
+    AVX512_BF16 = 24
+};
+
+const char* to_string(KernelOp op);
+const char* to_string(IsaLevel isa);
+bool is_isa_supported(IsaLevel isa, const CpuCapabilities& caps);
+
+class ThreadPool;
+namespace kernels { struct GemmKernelSet; struct HalfKernelSet; struct QuantizedKernelSet; struct SamplingKernelSet; }
+
+// Per-executor resources a kernel may use.
+struct CpuKernelContext {
+    ThreadPool* pool = nullptr; // nullptr runs single-threaded
+    uint32_t l1_cache_kb = constants::T760_L1_CACHE_SIZE_KB;
+    uint32_t l2_cache_kb = constants::T760_L2_CACHE_SIZE_KB;
+    // Best dense micro-kernels the host supports, for kernels that tile their
+    // own loops (attention); nullptr falls back to the scalar set.
+    const kernels::GemmKernelSet* gemm = nullptr;
+    // Likewise for kernels that stream group-quantized rows (lm_head).
+    const kernels::QuantizedKernelSet* quantized = nullptr;
+    // And for FP16 / BF16 weight rows (decoder projections, lm_head).
+    const kernels::HalfKernelSet* half = nullptr;
+    // And for scans over logit rows (sampling).
+    const kernels::SamplingKernelSet* sampling = nullptr;
+};
+
+using CpuKernelFn = void (*)(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs,
+                             const CpuKernelContext& ctx);
+
+struct KernelKey {
+    KernelOp op;
+    DataType data_type;
+    TensorLayout layout;
+
+    bool operator==(const KernelKey& other) const {
+        return op == other.op && data_type == other.data_type && layout == other.layout;
+    }
+};
+
+struct KernelKeyHash {
+    size_t operator()(const KernelKey& key) const {
+        return (static_cast<size_t>(key.op) << 40) ^ (static_cast<size_t>(key.data_type) << 8) ^
+               static_cast<size_t>(key.layout);
+    }
+};
+
+struct KernelEntry {
+    KernelKey key;
+    IsaLevel isa;
+    const char* name;
+    CpuKernelFn fn;
+};
+
+// Maps (op, dtype, layout) to the fastest kernel the host CPU can run. Kernels
+// for ISA levels the CPU lacks are dropped at registration time, so resolve()
+// never hands out code that would fault.
+class KernelRegistry {
+public:
+    explicit KernelRegistry(const CpuCapabilities& caps);
+
+    KernelRegistry(const KernelRegistry&) = delete;
+    KernelRegistry& operator=(const KernelRegistry&) = delete;
+
+    void register_kernel(KernelOp op, DataType dtype, TensorLayout layout, IsaLevel isa,
+                         const char* name, CpuKernelFn fn);
+
+    // Returns nullptr when no kernel is registered for the key.
+    const KernelEntry* resolve(KernelOp op, DataType dtype, TensorLayout layout) const;
+
+    const CpuCapabilities& get_capabilities() const { return caps_; }
+
+private:
+    CpuCapabilities caps_;
+    std::unordered_map<KernelKey, KernelEntry, KernelKeyHash> best_;
+};
+
+// Registers every CPU kernel compiled into the engine.
+void register_builtin_cpu_kernels(KernelRegistry& registry);
+
+// A context using the cache sizes of caps and the best kernel sets it supports.
+CpuKernelContext make_cpu_kernel_context(const CpuCapabilities& caps, ThreadPool* pool);
+
+}
+
+#endif // T760_KERNEL_REGISTRY_H
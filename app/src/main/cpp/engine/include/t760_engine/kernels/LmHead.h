@@ -0,0 +1,41 @@
+#ifndef T760_LM_HEAD_H
+#define T760_LM_HEAD_H
+
+#include "t760_engine/core/Types.h"
+#include "t760_engine/kernels/KernelRegistry.h"
+#include "t760_engine/kernels/VocabTable.h"
+#include <cstdint>
+#include <vector>
+
+namespace t760::kernels {
+
+// Fused output stage: the lm_head projection is streamed over vocab tiles and
+// each tile's logits are folded into a running top-k selection while still in
+// L1, so the [vocab] logits row is never written to memory unless requested.
+// Tiles are independent tasks on ctx.pool; each keeps its own top-k and the
+// partial lists are merged once at the end.
+
+// Writes the top_k (token, logit) pairs of hidden[hidden_size] * W^T to
+// candidates, best first; equal logits are ordered by token id. When logits is
+// non-null the full [vocab_size] row is stored there as well.
+//
+// With a mask, excluded tokens get -inf logits (in the stored row too) and
+// never become candidates, so fewer than top_k may come back. Tiles the mask
+// excludes entirely are not projected at all.
+void lm_head_top_k(const VocabTableView& w, const CpuKernelContext& ctx, const float* hidden, int64_t top_k,
+                   std::vector<TokenCandidate>& candidates, float* logits = nullptr, const TokenMask& mask = {});
+
+// lm_head_top_k for m hidden rows ([m, hidden_size]) in one sweep of the
+// table: each tile is projected for every row while it is in cache, so a
+// batch of decode steps streams the vocab table once. candidates[i] receives
+// row i's list, as lm_head_top_k would produce it; masks, when non-null,
+// holds a mask per row.
+void lm_head_top_k_batch(const VocabTableView& w, const CpuKernelContext& ctx, const float* hidden, int64_t m,
+                         int64_t top_k, std::vector<TokenCandidate>* candidates, const TokenMask* masks = nullptr);
+
+// Full logits with scalar dot products; the correctness baseline.
+void lm_head_reference(const VocabTableView& w, const float* hidden, float* logits);
+
+} // namespace t760::kernels
+
+#endif // T760_LM_HEAD_H
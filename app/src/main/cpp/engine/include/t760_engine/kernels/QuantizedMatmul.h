@@ -0,0 +1,128 @@
+#ifndef T760_QUANTIZED_MATMUL_H
+#define T760_QUANTIZED_MATMUL_H
+
+#include "t760_engine/kernels/KernelRegistry.h"
+#include "t760_engine/tensor/QuantizedLayout.h"
+#include <cstdint>
+
+namespace t760::kernels {
+
+// Weight-only matmul kernels over group-quantized QINT8 and QINT4 weights W of
+// shape [N, K] (see QuantizedLayout.h for the packing).
+//
+// Decode (GEMV) quantizes the activation row per group to int8 and runs an
+// integer dot product per group, so every ISA variant produces results that
+// are bit-exact with the scalar reference. Prefill (GEMM) keeps FP32
+// activations and dequantizes panels of weight rows once per call, amortizing
+// the conversion over all M rows. The W8A8 prefill variant instead quantizes
+// every activation row as decode does and runs the integer group sums over
+// blocks of rows, so each output row is bit-exact with the GEMV of its token
+// and prefill runs on the integer dot product units (sdot on the A76).
+
+namespace isa {
+using GemvQ8IsumsFn = void (*)(const int8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums);
+using GemvQ4IsumsFn = void (*)(const uint8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums);
+using GemmQ8IsumsFn = void (*)(const int8_t* w, int64_t rows, int64_t k, const int8_t* xq, int64_t m,
+                               int32_t* isums);
+using GemmQ4IsumsFn = void (*)(const uint8_t* w, int64_t rows, int64_t k, const int8_t* xq, int64_t m,
+                               int32_t* isums);
+using GemmPanelF32Fn = void (*)(const float* a, int64_t m, int64_t k, const float* panel,
+                                float* c, int64_t ldc, int64_t nr);
+}
+
+// The ISA-specific building blocks one tier provides.
+struct QuantizedKernelSet {
+    isa::GemvQ8IsumsFn gemv_q8_isums;
+    isa::GemvQ4IsumsFn gemv_q4_isums;
+    isa::GemmQ8IsumsFn gemm_q8_isums;
+    isa::GemmQ4IsumsFn gemm_q4_isums;
+    isa::GemmPanelF32Fn gemm_panel;
+};
+
+// Kernel set for an ISA tier, or nullptr when none is compiled in for it.
+// Callers are responsible for checking that the host supports the tier.
+const QuantizedKernelSet* get_quantized_kernel_set(IsaLevel isa);
+
+// The fastest kernel set a host with caps can run.
+const QuantizedKernelSet& select_quantized_kernel_set(const CpuCapabilities& caps);
+
+// y[N] = W * x[K]
+void gemv_quantized(const QuantizedKernelSet& ks, const float* x, const QuantizedMatrixView& w, float* y);
+
+// c[M, N] = a[M, K] * W^T, with a and c row-major and densely packed.
+void gemm_quantized(const QuantizedKernelSet& ks, const float* a, int64_t m, const QuantizedMatrixView& w, float* c);
+
+// Output rows [row_begin, row_end) only, written from y[0] / c[0]; c has
+// leading dimension ldc. Callers use these to split one weight over the pool
+// and to reuse one quantized activation (see quantize_row_q8) across several
+// weights that read the same input.
+void gemv_quantized_rows(const QuantizedKernelSet& ks, const int8_t* xq, const float* xs, const QuantizedMatrixView& w,
+                         int64_t row_begin, int64_t row_end, float* y);
+void gemm_quantized_rows(const QuantizedKernelSet& ks, const float* a, int64_t m, const QuantizedMatrixView& w,
+                         int64_t row_begin, int64_t row_end, float* c, int64_t ldc);
+
+// W8A8 GEMM over m activation rows quantized by quantize_rows_q8: aq is
+// [m, K] and as holds each row's group scales, [m, K / QUANT_GROUP_SIZE].
+// Row i of c equals gemv_quantized_rows on row i.
+void gemm_quantized_rows_int8(const QuantizedKernelSet& ks, const int8_t* aq, const float* as, int64_t m,
+                              const QuantizedMatrixView& w, int64_t row_begin, int64_t row_end, float* c,
+                              int64_t ldc);
+
+// Straightforward scalar implementations used as the correctness baseline.
+void gemv_quantized_reference(const float* x, const QuantizedMatrixView& w, float* y);
+void gemm_quantized_reference(const float* a, int64_t m, const QuantizedMatrixView& w, float* c);
+
+// Quantizes k activations (k a multiple of QUANT_GROUP_SIZE) to int8 in
+// [-127, 127] with one symmetric scale per group.
+void quantize_row_q8(const float* x, int64_t k, int8_t* quants, float* scales);
+
+// quantize_row_q8 over m rows of k, packed [m, k] and [m, k / QUANT_GROUP_SIZE].
+// Returns the worst relative RMS quantization error of any row,
+// ||x - q * scale|| / ||x||, which bounds the relative error it adds to a
+// dot product: under 1% for Gaussian-like rows, around 2% for heavy-tailed
+// rows or rows with an outlier hundreds of times their RMS.
+float quantize_rows_q8(const float* a, int64_t m, int64_t k, int8_t* quants, float* scales);
+
+// --- ISA-specific building blocks ---
+// These are only safe to call once the matching CPU feature has been confirmed.
+namespace isa {
+
+// gemv_*_isums: for each of `rows` consecutive weight rows of length k, writes
+// one int32 dot product per quantization group against the quantized
+// activation row xq. isums is laid out [rows, k / QUANT_GROUP_SIZE]. The
+// weight pointer is int8 quants for Q8 and packed nibbles for Q4.
+//
+// gemm_*_isums: the same sums for m activation rows xq ([m, k]), laid out
+// [m, rows, k / QUANT_GROUP_SIZE]; each weight group is loaded once for a block
+// of activation rows. Tiers without one run the GEMV per row.
+//
+// gemm_panel_f32_*: c[i, j] = dot(a row i, panel row j) for i < m, j < nr. The
+// panel holds four dequantized weight rows of length k, zero-padded when fewer
+// remain.
+
+#if defined(__aarch64__)
+void gemv_q8_isums_neon(const int8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums);
+void gemv_q8_isums_dotprod(const int8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums);
+void gemv_q4_isums_neon(const uint8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums);
+void gemv_q4_isums_dotprod(const uint8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums);
+void gemm_q8_isums_dotprod(const int8_t* w, int64_t rows, int64_t k, const int8_t* xq, int64_t m, int32_t* isums);
+void gemm_q4_isums_dotprod(const uint8_t* w, int64_t rows, int64_t k, const int8_t* xq, int64_t m, int32_t* isums);
+void gemm_panel_f32_neon(const float* a, int64_t m, int64_t k, const float* panel, float* c, int64_t ldc, int64_t nr);
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+void gemv_q8_isums_sse41(const int8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums);
+void gemv_q8_isums_avx2(const int8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums);
+void gemv_q4_isums_sse41(const uint8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums);
+void gemv_q4_isums_avx2(const uint8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums);
+void gemm_q8_isums_avx2(const int8_t* w, int64_t rows, int64_t k, const int8_t* xq, int64_t m, int32_t* isums);
+void gemm_q4_isums_avx2(const uint8_t* w, int64_t rows, int64_t k, const int8_t* xq, int64_t m, int32_t* isums);
+void gemm_panel_f32_sse41(const float* a, int64_t m, int64_t k, const float* panel, float* c, int64_t ldc, int64_t nr);
+void gemm_panel_f32_avx2(const float* a, int64_t m, int64_t k, const float* panel, float* c, int64_t ldc, int64_t nr);
+#endif
+
+} // namespace isa
+
+} // namespace t760::kernels
+
+#endif // T760_QUANTIZED_MATMUL_H
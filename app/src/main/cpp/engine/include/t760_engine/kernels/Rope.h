@@ -0,0 +1,45 @@
+#ifndef T760_ROPE_H
+#define T760_ROPE_H
+
+#include <cstdint>
+#include <vector>
+
+namespace t760::kernels {
+
+// Rotary position embedding in the "rotate half" convention of the HF Llama
+// and Gemma models: element i of a head is paired with element i + head_dim/2
+// and rotated by pos * base^(-2i / head_dim).
+//
+// The angles only depend on (pos, i), so cos and sin are tabulated once per
+// base at prepare time and rotation is a multiply-add per element. Gemma3
+// keeps two tables: rope_theta for its global layers and
+// rope_local_base_freq for the sliding-window ones.
+class RopeTable {
+public:
+    RopeTable() = default;
+    RopeTable(int64_t head_dim, int64_t max_positions, float base);
+
+    int64_t head_dim() const { return head_dim_; }
+    int64_t max_positions() const { return max_positions_; }
+    float base() const { return base_; }
+    // [head_dim / 2] factors for position pos.
+    const float* cos_row(int64_t pos) const { return cos_.data() + pos * (head_dim_ / 2); }
+    const float* sin_row(int64_t pos) const { return sin_.data() + pos * (head_dim_ / 2); }
+
+    // Rotates `heads` consecutive head vectors at position pos in place.
+    void apply(float* x, int64_t heads, int64_t pos) const;
+
+private:
+    int64_t head_dim_ = 0;
+    int64_t max_positions_ = 0;
+    float base_ = 0.0f;
+    std::vector<float> cos_; // [max_positions, head_dim / 2]
+    std::vector<float> sin_;
+};
+
+// Computes the angles on the fly in double precision; the correctness baseline.
+void rope_reference(float* x, int64_t heads, int64_t head_dim, int64_t pos, float base);
+
+} // namespace t760::kernels
+
+#endif // T760_ROPE_H
@@ -0,0 +1,123 @@
+#ifndef T760_SAMPLING_H
+#define T760_SAMPLING_H
+
+#include "t760_engine/core/Types.h"
+#include "t760_engine/kernels/KernelRegistry.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace t760::kernels {
+
+struct HalfKernelSet;
+
+// Selection and softmax over a row of vocabulary logits, for sampling from a
+// materialized row (262144 entries for Gemma3) rather than the fused lm_head's
+// candidate list.
+//
+// Top-k keeps a heap of the best k and scans the row with a vector compare
+// against the heap's worst logit, so only the few entries that beat it leave
+// the SIMD loop; once the heap has warmed up that is a handful per tile.
+// FP16 rows are widened a block at a time with the half kernels.
+
+// Strict "ranks before": higher logit, then lower token id, so a selection
+// does not depend on how the vocab was split into tiles.
+inline bool ranks_before(const TokenCandidate& a, const TokenCandidate& b) {
+    return a.logit > b.logit || (a.logit == b.logit && a.token_id < b.token_id);
+}
+
+// Bounded selection over a caller-owned slice of `capacity` entries, kept as
+// a heap whose front is the worst candidate retained so far.
+class TopKHeap {
+public:
+    TopKHeap(TokenCandidate* storage, int64_t capacity) : data_(storage), capacity_(capacity) {}
+
+    void push(int32_t token_id, float logit) {
+        const TokenCandidate candidate{token_id, logit};
+        if (size_ < capacity_) {
+            data_[size_++] = candidate;
+            std::push_heap(data_, data_ + size_, ranks_before);
+        } else if (ranks_before(candidate, data_[0])) {
+            std::pop_heap(data_, data_ + size_, ranks_before);
+            data_[size_ - 1] = candidate;
+            std::push_heap(data_, data_ + size_, ranks_before);
+        }
+    }
+
+    // Logits at or below this can never enter a full heap.
+    float threshold() const { return size_ < capacity_ ? -std::numeric_limits<float>::infinity() : data_[0].logit; }
+    int64_t size() const { return size_; }
+
+private:
+    TokenCandidate* data_;
+    int64_t capacity_;
+    int64_t size_ = 0;
+};
+
+namespace isa {
+using MaxF32Fn = float (*)(const float* x, int64_t n);
+// x[i] = -inf where bit i of bits (64 per word) is clear.
+using MaskF32Fn = void (*)(float* x, int64_t n, const uint64_t* bits);
+// Index of the first x[i] >= threshold, or n.
+using FindAtLeastF32Fn = int64_t (*)(const float* x, int64_t n, float threshold);
+// out[i] = exp((x[i] - shift) * scale); returns the sum. out may be x.
+using ExpSumF32Fn = float (*)(const float* x, int64_t n, float shift, float scale, float* out);
+}
+
+// The ISA-specific building blocks one tier provides.
+struct SamplingKernelSet {
+    isa::MaxF32Fn max;
+    isa::FindAtLeastF32Fn find_at_least;
+    isa::ExpSumF32Fn exp_sum;
+    isa::MaskF32Fn mask;
+};
+
+// Kernel set for an ISA tier, or nullptr when none is compiled in for it.
+// Callers are responsible for checking that the host supports the tier.
+const SamplingKernelSet* get_sampling_kernel_set(IsaLevel isa);
+
+// The fastest kernel set a host with caps can run.
+const SamplingKernelSet& select_sampling_kernel_set(const CpuCapabilities& caps);
+
+// Offers logits[0, n), as tokens first_token onward, to heap; only entries
+// that reach its threshold are pushed.
+void top_k_scan(const SamplingKernelSet& ks, const float* logits, int64_t n, int64_t first_token, TopKHeap& heap);
+
+// Lowers the logits of the tokens mask excludes to -inf. logits[0, n) are
+// tokens first_token onward; first_token must be a multiple of 64.
+void mask_logits(const SamplingKernelSet& ks, float* logits, int64_t n, int64_t first_token, const TokenMask& mask);
+
+// Whether mask allows any token in [first_token, first_token + n).
+bool mask_allows_any(const TokenMask& mask, int64_t first_token, int64_t n);
+
+// Writes the top_k (token, logit) pairs of logits[n] to candidates, best
+// first, as lm_head_top_k orders them.
+void top_k_logits(const SamplingKernelSet& ks, const float* logits, int64_t n, int64_t top_k,
+                  std::vector<TokenCandidate>& candidates);
+void top_k_logits_f16(const SamplingKernelSet& ks, const HalfKernelSet& half, const uint16_t* logits, int64_t n,
+                      int64_t top_k, std::vector<TokenCandidate>& candidates);
+
+// --- ISA-specific building blocks ---
+// These are only safe to call once the matching CPU feature has been confirmed.
+namespace isa {
+
+#if defined(__aarch64__)
+float max_f32_neon(const float* x, int64_t n);
+int64_t find_at_least_f32_neon(const float* x, int64_t n, float threshold);
+float exp_sum_f32_neon(const float* x, int64_t n, float shift, float scale, float* out);
+void mask_f32_neon(float* x, int64_t n, const uint64_t* bits);
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+float max_f32_avx2(const float* x, int64_t n);
+int64_t find_at_least_f32_avx2(const float* x, int64_t n, float threshold);
+float exp_sum_f32_avx2(const float* x, int64_t n, float shift, float scale, float* out);
+void mask_f32_avx2(float* x, int64_t n, const uint64_t* bits);
+#endif
+
+} // namespace isa
+
+} // namespace t760::kernels
+
+#endif // T760_SAMPLING_H
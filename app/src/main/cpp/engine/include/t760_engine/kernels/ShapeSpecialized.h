@@ -0,0 +1,57 @@
+#ifndef T760_SHAPE_SPECIALIZED_H
+#define T760_SHAPE_SPECIALIZED_H
+
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include <cstdint>
+
+namespace t760::kernels {
+
+// Fixed-size variants of the decoder layer's decode-step (single row) loops,
+// instantiated at build time for every shape in T760_DECODER_SHAPES (see
+// ShapeSpecialized.cpp). With all trip counts constexpr the norms and
+// quantization unroll and vectorize without remainder handling, and the GEMV
+// drivers keep their group sums on the stack. InferencePipeline::prepare looks
+// the model's shape up here; any other shape runs the generic kernels.
+
+struct DecoderShape {
+    int64_t hidden_size = 0;
+    int64_t head_dim = 0;
+    int64_t num_heads = 0;
+    int64_t num_kv_heads = 0;
+    int64_t intermediate_size = 0;
+
+    bool operator==(const DecoderShape& other) const {
+        return hidden_size == other.hidden_size && head_dim == other.head_dim && num_heads == other.num_heads &&
+               num_kv_heads == other.num_kv_heads && intermediate_size == other.intermediate_size;
+    }
+};
+
+// gemv_quantized_rows with k fixed by the instantiation; the caller has
+// validated w (bit-exact with the generic driver).
+using FixedGemvFn = void (*)(const QuantizedKernelSet& ks, const int8_t* xq, const float* xs,
+                             const QuantizedMatrixView& w, int64_t row_begin, int64_t row_end, float* y);
+
+struct ShapeKernelSet {
+    DecoderShape shape;
+    // rms_norm of one [hidden] row fused with quantize_row_q8.
+    void (*rms_norm_quantize)(const float* x, const float* gain, float eps, int8_t* xq, float* xs);
+    // x[hidden] += rms_norm(y[hidden]) * gain.
+    void (*add_rms_norm)(float* x, const float* y, const float* gain, float eps);
+    // In-place rms_norm of `heads` consecutive [head_dim] vectors.
+    void (*head_rms_norm)(float* x, int64_t heads, const float* gain, float eps);
+    // quantize_row_q8 of one [num_heads * head_dim] attention output row.
+    void (*quantize_attention)(const float* x, int8_t* xq, float* xs);
+    FixedGemvFn gemv_hidden;       // k = hidden_size: q/k/v and gate/up
+    FixedGemvFn gemv_attention;    // k = num_heads * head_dim: o
+    FixedGemvFn gemv_intermediate; // k = intermediate_size: down
+
+    // The GEMV variant whose k matches, or nullptr.
+    FixedGemvFn gemv_for(int64_t k) const;
+};
+
+// The set compiled for shape, or nullptr when the build has none.
+const ShapeKernelSet* find_shape_kernel_set(const DecoderShape& shape);
+
+} // namespace t760::kernels
+
+#endif // T760_SHAPE_SPECIALIZED_H
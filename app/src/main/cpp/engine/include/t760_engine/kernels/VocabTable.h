@@ -0,0 +1,32 @@
+#ifndef T760_VOCAB_TABLE_H
+#define T760_VOCAB_TABLE_H
+
+#include "t760_engine/core/Types.h"
+#include "t760_engine/tensor/QuantizedLayout.h"
+#include <cstdint>
+
+namespace t760::kernels {
+
+// A [vocab_size, hidden_size] row table: the token embedding, which Gemma
+// also uses as the (tied) lm_head. Both the embedding gather and the fused
+// output stage read the same resident copy through this view.
+//
+// Rows are FP32, FP16, BF16, QINT8 or QINT4. hidden_size must be a multiple of
+// QUANT_GROUP_SIZE for every data type, so dense rows can reuse the quantized
+// GEMM panel kernels.
+struct VocabTableView {
+    DataType data_type = DataType::FP32;
+    int64_t vocab_size = 0;
+    int64_t hidden_size = 0;
+    const void* dense = nullptr;   // FP32 / FP16 / BF16 rows
+    QuantizedMatrixView quantized; // QINT8 / QINT4
+};
+
+VocabTableView make_vocab_table_view(const Tensor& table);
+
+// Throws when the view's type or shape is unsupported.
+void validate_vocab_table(const VocabTableView& table);
+
+} // namespace t760::kernels
+
+#endif // T760_VOCAB_TABLE_H
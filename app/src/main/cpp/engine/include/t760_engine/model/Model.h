@@ -23,7 +23,10 @@ public:
     Tensor* get_tensor(const std::string& name);
 
     // This method will be called by the ModelLoader to populate the model with tensors.
-    void assign_tensors(std::vector<std::unique_ptr<Tensor>> tensors);
+    // aliases maps extra tensor names onto one of the assigned tensors, for
+    // table entries that share the same stored data (e.g. a tied lm_head).
+    void assign_tensors(std::vector<std::unique_ptr<Tensor>> tensors,
+                        const std::unordered_map<std::string, std::string>& aliases = {});
 
 private:
     std::unique_ptr<ModelConfig> config_;
@@ -2,6 +2,7 @@
 #define T760_MODEL_LOADER_H
 
 #include "t760_engine/model/Model.h"
+#include "t760_engine/model/WeightPrecision.h"
 #include "t760_engine/tensor/TensorManager.h"
 #include <string>
 #include <memory>
@@ -10,7 +11,8 @@ namespace t760 {
 
 class ModelLoader {
 public:
-    explicit ModelLoader(TensorManager& tensor_manager);
+    // precision decides the data type CPU weight matrices are kept in.
+    explicit ModelLoader(TensorManager& tensor_manager, const WeightPrecisionPolicy& precision = {});
     ~ModelLoader();
 
     ModelLoader(const ModelLoader&) = delete;
@@ -24,6 +26,7 @@ public:
 
 private:
     TensorManager& tensor_manager_;
+    WeightPrecisionPolicy precision_;
     std::unique_ptr<Model> loaded_model_;
 };
 
@@ -0,0 +1,44 @@
+#ifndef T760_WEIGHT_PRECISION_H
+#define T760_WEIGHT_PRECISION_H
+
+#include "t760_engine/core/Types.h"
+#include "t760_engine/device/DeviceCapabilities.h"
+#include "t760_engine/tensor/Tensor.h"
+#include <cstdint>
+
+namespace t760 {
+
+// Load-time choice of the data type each CPU weight matrix is kept in. The
+// decoder's projections and the vocab table read FP16 and BF16 rows directly
+// (kernels/HalfMatmul.h), so under AUTO:
+// - FP32 matrices are narrowed to FP16, halving the bytes every decode step
+//   streams, or to BF16 when some value overflows the FP16 range;
+// - BF16 matrices stay BF16 on hosts with a BF16 dot product. Elsewhere
+//   (the T760's A76 / A55) they become FP16 when every value converts
+//   exactly, the format the FP16 GEMM and the GPU path also consume;
+// - FP16 matrices, vectors (norm gains) and quantized tensors are kept.
+struct WeightPrecisionPolicy {
+    WeightPrecision mode = WeightPrecision::AS_STORED;
+    bool has_bf16_dot = false; // bfdot / vdpbf16ps
+};
+
+WeightPrecisionPolicy make_weight_precision_policy(WeightPrecision mode, const CpuCapabilities& caps);
+
+// False when the policy keeps such a tensor as stored whatever its values, so
+// the loader can read it in place.
+bool may_convert_weight(const WeightPrecisionPolicy& policy, DataType stored, const TensorShape& shape);
+
+// The data type a tensor stored as `stored` with `shape` is loaded in; data
+// holds its stored elements.
+DataType choose_weight_precision(const WeightPrecisionPolicy& policy, DataType stored, const TensorShape& shape,
+                                 const void* data);
+
+// Converts count elements between FP32, FP16 and BF16, rounding to nearest
+// even when narrowing.
+void convert_weights(DataType from, const void* src, DataType to, void* dst, int64_t count);
+
+const char* to_string(WeightPrecision mode);
+
+}
+
+#endif // T760_WEIGHT_PRECISION_H
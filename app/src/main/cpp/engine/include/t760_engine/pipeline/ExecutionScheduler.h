@@ -4,26 +4,181 @@
 #include "t760_engine/model/Model.h"
 #include "t760_engine/pipeline/LayerExecutor.h"
 #include "t760_engine/device/DeviceManager.h"
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <initializer_list>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace t760 {
 
+// One layer invocation: the plan entry that selects its device and the
+// tensors handed to that device's executor.
+struct LayerTask {
+    size_t layer_index = 0;
+    std::vector<Tensor*> inputs;
+    std::vector<Tensor*> outputs;
+};
+
+// A DAG of layer invocations for ExecutionScheduler::submit. Nodes are
+// identified by the order in which they were added and may only depend on
+// earlier nodes, so every graph is acyclic and id order is a valid execution
+// order. Independent chains (e.g. the layers of two conversations) share no
+// edges and may overlap on different devices.
+class ExecutionGraph {
+public:
+    using NodeId = size_t;
+
+    NodeId add(LayerTask task, std::initializer_list<NodeId> after = {});
+    // `node` may not start before `before` has finished.
+    void add_dependency(NodeId node, NodeId before);
+    // Adds tasks as a chain, each depending on the one before it, the first
+    // on `after`; returns the id of the last one. This is the dataflow of one
+    // sequence through the model's execution plan.
+    NodeId add_chain(std::vector<LayerTask> tasks, std::initializer_list<NodeId> after = {});
+
+    size_t size() const { return nodes_.size(); }
+    void clear() { nodes_.clear(); }
+
+private:
+    friend class ExecutionScheduler;
+    struct Node {
+        LayerTask task;
+        std::vector<NodeId> predecessors;
+    };
+    std::vector<Node> nodes_;
+};
+
+// The device whose range of the model's execution plan holds tensor table
+// entry index; an entry outside every range keeps its processor_id.
+DeviceType plan_device(const ModelConfig& config, size_t index);
+
+// Derives ExecutionGraphs from the model's execution plan. The plan's layers
+// are the 2-D weight matrices of its tensor table, in table order, each on
+// the device whose plan range holds it. A layer multiplies the activations
+// the one before it wrote, so consecutive layers are the graph's edges and
+// one sequence through the plan is a chain; consecutive widths must agree.
+class PlanGraphBuilder {
+public:
+    struct Layer {
+        size_t index = 0; // Into the tensor table; the LayerTask's layer_index
+        Tensor* weights = nullptr;
+        DeviceType device = DeviceType::CPU;
+        int64_t in_features = 0;
+        int64_t out_features = 0;
+    };
+
+    // excluded holds matrices another stage runs, such as the embedding.
+    // Throws when the widths of two consecutive layers do not chain.
+    explicit PlanGraphBuilder(Model& model, const std::vector<const Tensor*>& excluded = {});
+
+    const std::vector<Layer>& layers() const { return layers_; }
+    bool empty() const { return layers_.empty(); }
+    int64_t in_features() const { return layers_.empty() ? 0 : layers_.front().in_features; }
+    int64_t out_features() const { return layers_.empty() ? 0 : layers_.back().out_features; }
+
+    // Adds one sequence's pass through the plan to graph, its first node
+    // after `after`, and returns the id of its last node. Layer i reads
+    // activations[i] and writes activations[i + 1], FP32 [rows, width]
+    // tensors of the sequence's rows, layers().size() + 1 of them.
+    ExecutionGraph::NodeId add_sequence(ExecutionGraph& graph, const std::vector<Tensor*>& activations,
+                                        std::initializer_list<ExecutionGraph::NodeId> after = {}) const;
+
+private:
+    std::vector<Layer> layers_;
+};
+
+// Busy time of one device queue since the scheduler started or the last
+// reset_utilization().
+struct DeviceUtilization {
+    DeviceType device = DeviceType::CPU;
+    uint64_t layers = 0;         // Layers executed
+    double busy_ms = 0.0;        // Inside the executor
+    double queue_wait_ms = 0.0;  // Runnable but behind other work on the device
+    double utilization = 0.0;    // busy_ms over the elapsed wall time
+};
+
+// Completion of one submitted graph.
+class ExecutionHandle {
+public:
+    // Blocks until every node of the graph has finished or been skipped, then
+    // rethrows the first exception raised by one of them.
+    void wait();
+    bool is_done() const;
+
+private:
+    friend class ExecutionScheduler;
+    struct State {
+        mutable std::mutex mutex;
+        std::condition_variable done_cv;
+        size_t remaining = 0;
+        std::exception_ptr error;
+    };
+    std::shared_ptr<State> state_;
+};
+
 // Responsible for interpreting the model's execution plan and dispatching
 // layers to the correct hardware-specific LayerExecutor.
+//
+// Every device with an executor gets its own in-order queue, drained by a
+// dedicated thread the way a GPU queue or an NNAPI execution stream is.
+// submit() returns at once; each node goes to the queue of the device its
+// plan entry names. Edges between nodes on the same device need no
+// synchronization because the queue runs in order, so a node is queued right
+// behind its same-device predecessors. A node whose predecessor runs on
+// another device is queued only when that predecessor's completion (the
+// edge's fence) signals. Queues never block on each other, so independent
+// work overlaps: the NPU can run one conversation's MLP while the CPU runs
+// another's attention.
 class ExecutionScheduler {
 public:
-    ExecutionScheduler(const Model& model, const DeviceManager& device_manager);
+    // CPU layers run on cpu_pool (see CpuLayerExecutor).
+    ExecutionScheduler(const Model& model, const DeviceManager& device_manager, ThreadPool* cpu_pool = nullptr);
     ~ExecutionScheduler();
 
+    ExecutionScheduler(const ExecutionScheduler&) = delete;
+    ExecutionScheduler& operator=(const ExecutionScheduler&) = delete;
+
+    // Queues every node of graph. The tensors the nodes reference must stay
+    // alive until the handle reports completion. After a node fails, nodes
+    // of the same graph that have not started are skipped.
+    ExecutionHandle submit(const ExecutionGraph& graph);
+
+    // Runs one layer on its device and waits for it.
     void execute_layer(size_t layer_index, const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs);
 
+    // Whether layers planned on device can run: it is active and this build
+    // has an executor for it.
+    bool has_executor(DeviceType device) const;
+
+    // The device the plan assigns to layer_index (see plan_device).
+    DeviceType get_layer_device(size_t layer_index) const;
+
+    std::vector<DeviceUtilization> get_utilization() const;
+    void reset_utilization();
+    void log_utilization() const;
+
 private:
+    struct GraphRun;
+    struct QueueItem;
+    class DeviceQueue;
+
+    DeviceQueue& queue_for(DeviceType device);
+
     const Model& model_;
     const DeviceManager& device_manager_;
     std::unordered_map<DeviceType, std::unique_ptr<ILayerExecutor>> executors_;
+    // Declared after the executors so the queue threads stop before the
+    // executors they call are destroyed.
+    std::unordered_map<DeviceType, std::unique_ptr<DeviceQueue>> queues_;
+    // Graphs that may still be running, drained by the destructor.
+    std::mutex runs_mutex_;
+    std::vector<std::weak_ptr<ExecutionHandle::State>> runs_;
 };
 
 }
 
-#endif // T760_EXECUTION_SCHEDULER_H
\ No newline at end of file
+#endif // T760_EXECUTION_SCHEDULER_H
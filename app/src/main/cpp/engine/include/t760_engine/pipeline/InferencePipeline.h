@@ -2,21 +2,69 @@
 #define T760_INFERENCE_PIPELINE_H
 
 #include "t760_engine/core/Types.h"
+#include "t760_engine/kernels/KernelRegistry.h"
+#include "t760_engine/kernels/DecoderLayer.h"
+#include "t760_engine/kernels/Embedding.h"
+#include "t760_engine/kernels/LmHead.h"
+#include "t760_engine/kernels/Rope.h"
 #include "t760_engine/model/Model.h"
 #include "t760_engine/pipeline/PipelineTypes.h"
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <thread>
 
 namespace t760 {
 
+class ClusterPools;
 class DeviceManager;
+class ExecutionScheduler;
+class PlanGraphBuilder;
 class TensorManager;
 class Tensor;
 
+// Every execute() call with a decoder queues its tokens on the lane of its
+// conversation's priority class and waits. Each lane has a thread that runs
+// its steps on one cluster: interactive conversations on the big pool,
+// background ones on the little pool, pinned and niced like that pool's
+// workers. A step batches the lane's queued decode steps of different
+// conversations (up to max_decode_batch) with chunks of queued prompts
+// (prefill_chunk_tokens each) until it holds step_token_budget tokens,
+// earliest deadline first. The decoder layers and the lm_head stream their
+// weights once per step for the whole batch, and a long prompt advances a
+// chunk per step instead of stalling every other conversation's next token
+// for its whole prefill.
+//
+// Interactive work preempts background work at layer boundaries: a
+// background step pauses before its next layer while the interactive lane
+// has work, since both clusters stream weights over the same DRAM bus. A
+// background step holding a call past its deadline no longer pauses.
+//
+// A model the fused decoder cannot run goes through its execution plan
+// instead: the plan's layers run on the devices the plan assigns them, via
+// an ExecutionScheduler, and execute_many() submits every conversation's
+// pass as one graph, so that one conversation's NPU layers overlap another's
+// CPU layers.
+//
+// With a draft model attached, execute_speculative() lets it propose the next
+// few tokens of a conversation and checks them all in one step, so a step
+// that streams the weights once can yield several tokens.
+//
+// execute(), embed(), create_new_context() and destroy_context() are thread-safe.
+// Calls on one conversation run one at a time, in the order they take its
+// lock. A call holds a reference to its conversation, so destroy_context()
+// does not free the state under a running call; later calls fail. prepare()
+// release(), attach_draft() and detach_draft() must not overlap any other call
+// (Engine guarantees this).
 class InferencePipeline {
 public:
-    InferencePipeline(DeviceManager& device_manager, TensorManager& tensor_manager);
+    // Kernels run on the big pool of thread_pools, which must outlive the pipeline.
+    InferencePipeline(DeviceManager& device_manager, TensorManager& tensor_manager, ClusterPools& thread_pools,
+                      const PipelineOptions& options = {});
     ~InferencePipeline();
 
     InferencePipeline(const InferencePipeline&) = delete;
@@ -24,18 +72,232 @@ public:
 
     void prepare(Model& model);
     void release();
-    ConversationHandle create_new_context();
+    ConversationHandle create_new_context(const ConversationOptions& options = {});
     void destroy_context(ConversationHandle handle);
-    std::unique_ptr<Tensor> execute(ConversationHandle handle, const std::vector<int>& input_token_ids);
+    StepOutput execute(ConversationHandle handle, const std::vector<int>& input_token_ids,
+                       const OutputOptions& options = {});
+    // As above, into a caller-owned output (see StepOutput).
+    void execute(ConversationHandle handle, const int* input_token_ids, size_t count, const OutputOptions& options,
+                 StepOutput& output);
+    // Runs the calls, on distinct conversations, as if each were an
+    // execute() of its own but queued together, so their prompts share
+    // steps from the first one. A call's failure lands in its error; throws
+    // only when the pipeline is not prepared or a conversation repeats.
+    void execute_many(StepCall* calls, size_t count);
+    // Forgets the conversation's tokens so that its caches serve a new
+    // sequence, reseeding its sampling as ConversationOptions::seed does.
+    void reset_context(ConversationHandle handle, uint64_t seed);
+    // Positions the conversation has left before the sequence length check
+    // fails: a bound on the tokens any later call can still produce.
+    size_t remaining_positions(ConversationHandle handle);
+    const PipelineOptions& get_options() const { return options_; }
+    // Runs each input through the decoder stack and the final norm, without
+    // the lm_head, and pools its hidden states into the count rows of
+    // output, embedding_size() floats each. The inputs share steps like
+    // execute_many() calls; their keys and values go to caches that live
+    // for the call only, so no conversation is created or kept.
+    void embed(const std::vector<int>* inputs, size_t count, const EmbeddingOptions& options, float* output);
+    size_t embedding_size() const { return static_cast<size_t>(embedding_.hidden_size); }
+
+    // Runs a smaller model of the same vocab on a pipeline of its own, the
+    // draft for execute_speculative(). Conversations created from here on
+    // keep a draft conversation beside their own; earlier ones do not
+    // speculate. The model must outlive the attachment.
+    void attach_draft(Model& draft_model);
+    void detach_draft();
+    bool has_draft() const { return draft_ != nullptr; }
+    // Runs the tokens as execute() would, then lets the draft propose up to
+    // speculation.draft_tokens more, one draft step each, and checks them
+    // with one step of the model that scores every proposal at once. Each
+    // proposal is kept with probability min(1, p / q) over the model's and
+    // the draft's sampling distributions; the first rejected one is replaced
+    // by a draw from what p has left over q, and when all are kept the model
+    // samples one more. The tokens come out distributed as execute() would
+    // sample them, and both conversations are rolled back to the last one.
+    // Without a draft conversation, or with penalties, allowed_tokens,
+    // logits or a top_k past the fused lm_head's asked for, it runs as
+    // execute() into output.plain and returns that one token.
+    void execute_speculative(ConversationHandle handle, const int* input_token_ids, size_t count,
+                             const OutputOptions& options, const SpeculationOptions& speculation,
+                             SpeculativeOutput& output);
+    SpeculationStats get_speculation_stats();
+    void reset_speculation_stats();
+
+    LatencyStats get_latency_stats(RequestPriority priority = RequestPriority::INTERACTIVE);
+    void reset_latency_stats();
+    void log_latency_stats();
 
 private:
+    // Binds every layer's weights; leaves the decoder disabled when the model
+    // lacks any of them.
+    void prepare_decoder(Model& model);
+    // Sets up the execution plan's layers and their scheduler when they run
+    // from the embedding to the lm_head; leaves them unset otherwise.
+    void prepare_plan(Model& model);
+    // Fused lm_head + top-k over the state's final hidden row, then sampling.
+    void run_output_stage(const CpuKernelContext& ctx, ConversationState& state, const OutputOptions& options,
+                          StepOutput& output);
+
+    struct StepRequest {
+        ConversationState* state;
+        const int* tokens;
+        int64_t count;
+        const OutputOptions* options;
+        std::chrono::steady_clock::time_point queued_at;
+        // time_point::max() without a deadline, so that EDF order puts it last.
+        std::chrono::steady_clock::time_point deadline;
+        int64_t consumed = 0; // Tokens already run by earlier steps
+        StepOutput* output;   // The caller's
+        std::exception_ptr error;
+        bool done = false;
+        // Set for an embed() input: the step pools its hidden states into
+        // this row instead of running the output stage.
+        float* embedding = nullptr;
+        const EmbeddingOptions* embedding_options = nullptr;
+        // Set for a speculative check: the last verify_rows positions each
+        // get candidates, into output[0, verify_rows), and none is sampled.
+        int64_t verify_rows = 0;
+    };
+    // The tokens of one request that a step runs.
+    struct StepChunk {
+        StepRequest* request;
+        int64_t count;
+    };
+    // The most recent latencies of one kind, in milliseconds.
+    struct LatencyWindow {
+        std::vector<float> samples;
+        size_t next = 0;
+        uint64_t total = 0;
+        void record(float ms);
+        void clear();
+    };
+    // The queue, step thread and latency record of one priority class.
+    struct StepLane {
+        RequestPriority priority = RequestPriority::INTERACTIVE;
+        CpuKernelContext kernel_context; // On the lane's cluster pool
+        uint64_t affinity_mask = 0;
+        int nice = 0;
+        std::thread thread;
+        std::condition_variable work_cv;
+        std::vector<StepRequest*> pending; // In arrival order
+        bool running = false;              // A step is in flight
+        // Owned by the lane thread and reused, so a step allocates nothing
+        // once they have grown to the lane's batch sizes.
+        std::vector<StepChunk> step;
+        std::vector<StepRequest*> ready;
+        std::vector<const ConversationState*> queued;
+        std::vector<int32_t> tokens;
+        std::vector<float> rows;
+        std::vector<kernels::DecoderSequence> sequences;
+        std::vector<float> shared_rows;
+        std::vector<StepRequest*> shared;
+        std::vector<StepOutput*> shared_outputs;
+        std::vector<TokenMask> shared_masks;
+        std::vector<std::vector<TokenCandidate>> candidates;
+        std::vector<float> pooled;
+        LatencyWindow itl;
+        LatencyWindow ttft;
+        uint64_t deadline_misses = 0;
+    };
+
+    StepLane& lane_for(RequestPriority priority) { return lanes_[static_cast<size_t>(priority)]; }
+    void start_lanes();
+    void stop_lanes();
+    void lane_loop(StepLane& lane);
+    // Per-layer FP16 key and value caches of the given length.
+    void allocate_kv_cache(ConversationState& state, int64_t positions);
+    // Null for an unknown handle. The reference keeps the state alive should
+    // the conversation be destroyed meanwhile.
+    std::shared_ptr<ConversationState> find_context(ConversationHandle handle);
+    // Throws when options do not fit the model.
+    void validate_output(const OutputOptions& options) const;
+    // Counts the tokens into the state's history and clears output; the
+    // state's mutex must be held.
+    void begin_call(ConversationState& state, const int* tokens, size_t count, StepOutput& output);
+    // Takes back what begin_call() and the steps that ran did for a failed
+    // call, consumed of whose tokens were processed, so that the history
+    // holds only tokens the model has seen.
+    static void undo_call(ConversationState& state, const int* tokens, size_t count, int64_t consumed);
+    // execute() once the state's mutex is held.
+    void execute_locked(ConversationState& state, const int* tokens, size_t count, const OutputOptions& options,
+                        StepOutput& output);
+    // A call for a model the decoder cannot run.
+    struct PlanCall {
+        ConversationState* state;
+        const int* tokens;
+        size_t count;
+        const OutputOptions* options;
+        StepOutput* output;
+        std::exception_ptr error; // Set in place of throwing
+    };
+    // Embeds each call's tokens, runs the execution plan for every call as
+    // one graph, a chain per call, and then each call's output stage; the
+    // states' mutexes must be held. A failing layer fails every call of the
+    // graph. Without a plan, only the embedding and output stage run.
+    void execute_without_decoder(PlanCall* calls, size_t count);
+    // A request for the lanes to run the tokens; throws when they do not fit
+    // the conversation.
+    StepRequest make_request(ConversationState& state, const int* tokens, size_t count,
+                             const OutputOptions& options, StepOutput& output) const;
+    // Queues the requests on their conversations' lanes and returns once the
+    // steps that run them have finished.
+    void run_requests(StepRequest* const* requests, size_t count);
+    // Picks the lane's next step into lane.step; batch_mtx_ must be held.
+    void take_step(StepLane& lane);
+    // Runs one step; failures land in each scheduled request's error rather
+    // than propagating.
+    void run_step(StepLane& lane, const std::vector<StepChunk>& step);
+    // Pools the chunk's final hidden rows into its request's embedding.
+    void pool_embedding(StepLane& lane, const StepChunk& chunk, const float* rows);
+    // Blocks a background step before its next layer while interactive work
+    // is queued or running.
+    void yield_to_interactive(const std::vector<StepChunk>& step);
+    // Retires the requests of step that finished or failed; batch_mtx_ must
+    // be held.
+    void finish_step(StepLane& lane, const std::vector<StepChunk>& step);
+    // Takes the last count of tokens back out of the state's positions and
+    // history; the state's mutex must be held.
+    static void rewind(ConversationState& state, const int* tokens, size_t count);
+    // Ends the state's speculation after a failure has left its draft
+    // conversation out of step; the state's mutex must be held.
+    void drop_speculation(ConversationState& state);
+    void log_speculation_stats();
+
     DeviceManager& device_manager_;
     TensorManager& tensor_manager_;
+    ClusterPools& thread_pools_;
+    PipelineOptions options_;
+    bool int8_prefill_ = false; // prefill_activations_ resolved for the host
     Model* active_model_ = nullptr;
     bool is_prepared_ = false;
+    CpuKernelContext kernel_context_;
+    const Tensor* embedding_weight_ = nullptr;
+    kernels::VocabTableView embedding_;
+    float embedding_scale_ = 1.0f;
+    const Tensor* lm_head_weight_ = nullptr;
+    kernels::VocabTableView lm_head_;
+    kernels::RopeTable global_rope_;
+    kernels::RopeTable local_rope_;
+    std::vector<kernels::DecoderLayerParams> layer_params_;
+    std::vector<kernels::DecoderLayerWeights> layer_weights_;
+    std::vector<float> final_norm_;
+    std::unique_ptr<PlanGraphBuilder> plan_; // Set only without the decoder
+    std::unique_ptr<ExecutionScheduler> scheduler_;
+    int64_t max_positions_ = 0;
     std::mutex context_mtx_;
     uint64_t next_context_id_ = 1;
-    std::unordered_map<uint64_t, std::unique_ptr<ConversationState>> conversation_contexts_;
+    std::unordered_map<uint64_t, std::shared_ptr<ConversationState>> conversation_contexts_;
+
+    // Guards the lanes' queues, flags and latency records.
+    std::mutex batch_mtx_;
+    // Signals finished steps, to callers and to yielding background steps.
+    std::condition_variable batch_cv_;
+    std::array<StepLane, 2> lanes_; // Indexed by RequestPriority
+    bool stopping_ = false;
+
+    std::unique_ptr<InferencePipeline> draft_;
+    std::mutex speculation_mtx_; // Guards speculation_stats_
+    SpeculationStats speculation_stats_;
 };
 
 }
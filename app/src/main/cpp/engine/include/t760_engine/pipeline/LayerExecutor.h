@@ -3,8 +3,11 @@
 
 #include "t760_engine/tensor/Tensor.h"
 #include "t760_engine/core/Types.h"
+#include "t760_engine/kernels/KernelRegistry.h"
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 namespace t760 {
 
@@ -15,10 +18,24 @@ public:
     virtual void execute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) = 0;
 };
 
-// Concrete implementation for CPU execution using NEON/Eigen.
+// Concrete implementation for CPU execution. Kernels are looked up in a
+// registry built from the probed CPU features; the resolved entry is cached per
+// layer (keyed by its weight tensor) so dispatch is a single map lookup.
+// Multithreaded kernels run on pool, the engine's big-cluster pool, which must
+// outlive the executor; nullptr runs them single-threaded.
 class CpuLayerExecutor : public ILayerExecutor {
 public:
+    CpuLayerExecutor(const CpuCapabilities& caps, ThreadPool* pool);
+
     void execute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) override;
+
+private:
+    const KernelEntry& resolve_for_layer(const std::vector<Tensor*>& inputs);
+
+    KernelRegistry registry_;
+    CpuKernelContext kernel_context_;
+    std::mutex cache_mutex_;
+    std::unordered_map<const Tensor*, const KernelEntry*> layer_kernels_;
 };
 
 // Concrete implementation for GPU execution using Vulkan compute shaders.
@@ -3,18 +3,168 @@
 
 #include "t760_engine/tensor/Tensor.h"
 #include "t760_engine/core/Types.h"
+#include "t760_engine/pipeline/Sampler.h"
+#include <exception>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <random>
 #include <unordered_map>
 
 namespace t760 {
 
+struct SpeculativeState;
+
 // Represents the state of a single, ongoing conversation.
 // The key here is the KV cache, which will be a pair of tensors (Key, Value) for each layer.
 struct ConversationState {
     ConversationHandle handle;
+    ConversationOptions options;
     std::vector<std::pair<std::unique_ptr<Tensor>, std::unique_ptr<Tensor>>> kv_cache;
     size_t processed_token_count = 0;
+    // [tokens, hidden] residual stream of the current step; the embedding
+    // gather writes it and the decoder layers update it in place.
+    std::vector<float> activations;
+    // Without the fused decoder: the FP32 [tokens, width] input and output of
+    // each layer of the model's execution plan (see PlanGraphBuilder), kept
+    // while calls keep the same token count.
+    std::vector<std::unique_ptr<Tensor>> plan_activations;
+    // Final normalized hidden state of the last processed position; the
+    // output stage projects it onto the vocabulary.
+    std::vector<float> final_hidden;
+    std::mt19937 rng;
+    // Every token fed so far, for the sampling penalties.
+    TokenHistory history;
+    // Set when the pipeline had a draft model as the conversation began.
+    std::unique_ptr<SpeculativeState> speculation;
+    // Held by the execute() call using the conversation, so calls on one
+    // conversation run one at a time.
+    std::mutex mutex;
+};
+
+// Controls the output stage that follows the last decoder layer.
+struct OutputOptions {
+    SamplingParams sampling;
+    bool return_logits = false; // Also materialize the full [1, vocab] FP32 row
+    // Caller-owned destination of the FP32 row, in place of
+    // StepOutput::logits; implies return_logits. Must hold vocab_size floats.
+    float* logits_out = nullptr;
+    size_t logits_out_size = 0;
+    // Tokens the output stage may pick (see lm_head_top_k); unset allows
+    // every token. Constrained decoding passes a GrammarCursor's mask here.
+    TokenMask allowed_tokens;
+
+    bool wants_logits() const { return return_logits || logits_out != nullptr; }
+};
+
+// InferencePipeline settings taken from EngineConfig.
+struct PipelineOptions {
+    PrefillActivations prefill_activations = PrefillActivations::AUTO;
+    // Most concurrent decode steps run as one batch (see InferencePipeline).
+    uint32_t max_decode_batch = constants::MAX_CONCURRENT_CONVERSATIONS;
+    // Prompt tokens one conversation adds to a step, and decode plus prompt
+    // tokens per step (see EngineConfig).
+    uint32_t prefill_chunk_tokens = constants::DEFAULT_PREFILL_CHUNK_TOKENS;
+    uint32_t step_token_budget = constants::DEFAULT_STEP_TOKEN_BUDGET;
+};
+
+// Latencies of one priority class's recent execute() calls as their callers
+// saw them, from the call to its result. Single-token calls are decode steps,
+// so theirs is the inter-token latency (ITL); longer calls are prompts and
+// report the time to their first token (TTFT). Percentiles cover the most
+// recent calls only.
+struct LatencyStats {
+    uint64_t decode_steps = 0; // Since the model was prepared or the last reset
+    double itl_p50_ms = 0.0;
+    double itl_p99_ms = 0.0;
+    double itl_max_ms = 0.0;
+    uint64_t prompts = 0;
+    double ttft_p50_ms = 0.0;
+    double ttft_p99_ms = 0.0;
+    uint64_t deadline_misses = 0; // Calls that returned after their deadline
+};
+
+// Next-token result for the last position of one execute() call. Passing the
+// same StepOutput to successive calls reuses its candidate storage and logits
+// tensor, so a warm decode step allocates nothing.
+struct StepOutput {
+    int32_t next_token = -1;                // -1 when no output stage ran
+    std::vector<TokenCandidate> candidates; // Top-k by logit, best first
+    // Only with OutputOptions::return_logits; a reused output keeps it, stale,
+    // through calls that do not ask for it.
+    std::unique_ptr<Tensor> logits;
+};
+
+// A conversation's draft model side (see InferencePipeline::attach_draft).
+struct SpeculativeState {
+    ConversationHandle draft; // In the draft pipeline
+    // Tokens the conversation ran that the draft has not, fed ahead of its
+    // next proposal.
+    std::vector<int32_t> pending;
+    // Reused by every speculative step.
+    std::vector<int32_t> feed;         // The draft's first input, then the check's
+    std::vector<int32_t> drafted;      // Proposed tokens
+    std::vector<StepOutput> proposals; // The draft's output at each proposal
+    std::vector<StepOutput> verdicts;  // The conversation's, per proposal plus one
+    std::vector<float> hidden;         // Normalized final rows being verified
+    std::vector<float> draft_probs;
+    std::vector<float> target_probs;
+};
+
+// Settings of one InferencePipeline::execute_speculative() call.
+struct SpeculationOptions {
+    uint32_t draft_tokens = constants::DEFAULT_DRAFT_TOKENS; // Proposed per step
+    uint32_t max_tokens = 0; // Most tokens to return; 0 for no cap
+    // Output ends after the first of these.
+    const std::vector<int32_t>* stop_tokens = nullptr;
+};
+
+// The tokens one speculative step produced: the accepted proposals, then the
+// conversation's own next token. The last one has not been fed; the next
+// call's input should start with it.
+struct SpeculativeOutput {
+    std::vector<int32_t> tokens;
+    uint32_t drafted = 0;
+    uint32_t accepted = 0;
+    // The output of a call that ran as a plain step, logits included.
+    StepOutput plain;
+};
+
+// Totals of the speculative steps with a one-token input, the decode loop's,
+// since the draft was attached or the last reset. A prompt's first step is
+// left out so that its prefill does not weigh on the rate.
+struct SpeculationStats {
+    uint64_t steps = 0;
+    uint64_t drafted = 0;  // Tokens the draft proposed
+    uint64_t accepted = 0; // Proposals the model kept
+    uint64_t emitted = 0;  // Tokens the steps returned
+    double seconds = 0.0;  // Spent in the steps, draft included
+
+    double acceptance_rate() const { return drafted > 0 ? static_cast<double>(accepted) / drafted : 0.0; }
+    double tokens_per_second() const { return seconds > 0.0 ? emitted / seconds : 0.0; }
+};
+
+// One conversation's part of an InferencePipeline::execute_many() call.
+struct StepCall {
+    ConversationHandle handle;
+    const int* tokens = nullptr;
+    size_t count = 0;
+    OutputOptions options;
+    StepOutput* output = nullptr;
+    std::exception_ptr error; // Set in place of throwing
+};
+
+// How InferencePipeline::embed() reduces a sequence's final hidden states to
+// one vector.
+enum class EmbeddingPooling : uint8_t {
+    LAST_TOKEN, // The last position's, which under causal attention has seen every token
+    MEAN        // The average over every position
+};
+
+struct EmbeddingOptions {
+    EmbeddingPooling pooling = EmbeddingPooling::MEAN;
+    bool normalize = true; // Scale the pooled vector to unit L2 norm
+    RequestPriority priority = RequestPriority::INTERACTIVE;
 };
 
 }
@@ -0,0 +1,108 @@
+#ifndef T760_SAMPLER_H
+#define T760_SAMPLER_H
+
+#include "t760_engine/core/Types.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace t760 {
+
+namespace kernels { struct HalfKernelSet; struct SamplingKernelSet; }
+
+// Next-token selection settings; defaults follow generation_config.json.
+struct SamplingParams {
+    bool do_sample = true;     // false picks the highest logit
+    uint32_t top_k = constants::DEFAULT_SAMPLING_TOP_K; // Also the fused lm_head's candidate count; 0 uses the default
+    float top_p = constants::DEFAULT_SAMPLING_TOP_P;
+    float temperature = 1.0f;  // <= 0 behaves like do_sample = false
+    // Penalties on tokens already in the conversation, prompt included. A
+    // repeated token's logit is divided by repetition_penalty when positive
+    // and multiplied by it when negative (1 disables), then lowered by
+    // frequency_penalty per occurrence (0 disables).
+    float repetition_penalty = 1.0f;
+    float frequency_penalty = 0.0f;
+
+    bool has_penalties() const { return repetition_penalty != 1.0f || frequency_penalty != 0.0f; }
+};
+
+// Occurrences of each token in one conversation, in a flat open-addressing
+// table: counting a step's tokens allocates only when the table grows.
+class TokenHistory {
+public:
+    struct Entry {
+        int32_t token;
+        uint32_t count;
+    };
+
+    // Room for this many distinct tokens before the table grows.
+    void reserve(size_t distinct);
+    void add(const int* tokens, size_t count);
+    // Takes back occurrences added earlier, as when rejected draft tokens are
+    // rolled back; a token left with none is dropped.
+    void remove(const int* tokens, size_t count);
+    uint32_t count(int32_t token) const;
+    size_t distinct() const { return entries_.size(); }
+    // One entry per distinct token, in first-seen order.
+    const std::vector<Entry>& entries() const { return entries_; }
+    void clear();
+
+private:
+    void rehash(size_t slot_count);
+
+    std::vector<Entry> entries_;
+    std::vector<int32_t> slots_; // Index into entries_, or -1; a power of two in size
+};
+
+// A uniform draw in [0, 1) from 24 bits of rng. Unlike
+// std::uniform_real_distribution it is the same on every standard library,
+// so a seeded conversation samples the same tokens everywhere.
+float uniform_unit(std::mt19937& rng);
+
+// The top_k an unpenalized selection must return for apply_penalties to be
+// exact: penalties only lower logits, so the best top_k after them are among
+// the best top_k + (distinct penalized tokens) before them.
+uint32_t candidates_for_penalties(const SamplingParams& params, const TokenHistory& history);
+
+// Applies the penalties to candidates sorted best first, re-sorts them and
+// keeps the first top_k.
+void apply_penalties(std::vector<TokenCandidate>& candidates, const SamplingParams& params,
+                     const TokenHistory& history, uint32_t top_k);
+
+// Picks a token from candidates sorted best first, as produced by the fused
+// lm_head: temperature softmax over the first top_k, then the smallest prefix
+// whose probability mass reaches top_p. Returns -1 when candidates is empty.
+int32_t sample_from_candidates(const std::vector<TokenCandidate>& candidates, const SamplingParams& params,
+                               std::mt19937& rng);
+
+// The distribution sample_from_candidates draws from: probs[i] is the
+// probability of candidates[i], zero past the top_k and top_p cuts.
+void candidate_probabilities(const std::vector<TokenCandidate>& candidates, const SamplingParams& params,
+                             std::vector<float>& probs);
+
+// Speculative sampling's test of a token drawn from the draft model's
+// distribution q against the target model's p (both as from
+// candidate_probabilities): keeps it with probability min(1, p / q), else
+// sets replacement to a draw from max(0, p - q), renormalized. Tokens come
+// out distributed as if sampled from p alone.
+bool verify_draft_token(int32_t draft_token, const std::vector<TokenCandidate>& target,
+                        const std::vector<float>& target_probs, const std::vector<TokenCandidate>& draft,
+                        const std::vector<float>& draft_probs, std::mt19937& rng, int32_t& replacement);
+
+// Samples from a whole row of logits[vocab_size] with params and the
+// history's penalties (history may be null). Small candidate sets are chosen
+// by a vector scan into a heap; large ones (top_k near the vocab size) by
+// quickselect, with a vectorized softmax and only as much of the set sorted
+// as top_p needs. candidates receives the penalized top_k, best first, when
+// that set is small enough to be worth returning, else is cleared.
+int32_t sample_from_logits(const kernels::SamplingKernelSet& ks, const float* logits, int64_t vocab_size,
+                           const SamplingParams& params, const TokenHistory* history, std::mt19937& rng,
+                           std::vector<TokenCandidate>& candidates);
+int32_t sample_from_logits_f16(const kernels::SamplingKernelSet& ks, const kernels::HalfKernelSet& half,
+                               const uint16_t* logits, int64_t vocab_size, const SamplingParams& params,
+                               const TokenHistory* history, std::mt19937& rng,
+                               std::vector<TokenCandidate>& candidates);
+
+}
+
+#endif // T760_SAMPLER_H
@@ -21,6 +21,10 @@ public:
     virtual IMemoryAllocator* get_cpu_allocator() const = 0;
 };
 
+// The backend of the platform this library was built for: Android in the
+// app, a CPU-only host backend in desktop builds, tests and benches.
+std::unique_ptr<IPlatformBackend> create_platform_backend();
+
 }
 
 #endif // T760_IPLATFORM_BACKEND_H
\ No newline at end of file
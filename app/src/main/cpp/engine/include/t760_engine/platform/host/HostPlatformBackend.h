@@ -0,0 +1,30 @@
+#ifndef T760_HOST_PLATFORM_BACKEND_H
+#define T760_HOST_PLATFORM_BACKEND_H
+
+#include "t760_engine/platform/IPlatformBackend.h"
+#include "t760_engine/memory/CpuAllocator.h"
+
+namespace t760 {
+
+// Desktop backend: CPU memory only, with no GPU or NPU context, so every
+// layer runs on the CPU executor.
+class HostPlatformBackend : public IPlatformBackend {
+public:
+    HostPlatformBackend();
+    ~HostPlatformBackend() override;
+
+    void initialize(const DeviceManager& device_manager) override;
+    void shutdown() override;
+
+    IGpuContext* get_gpu_context() const override;
+    INpuContext* get_npu_context() const override;
+    IMemoryAllocator* get_cpu_allocator() const override;
+
+private:
+    bool is_initialized_ = false;
+    std::unique_ptr<CpuAllocator> cpu_allocator_;
+};
+
+}
+
+#endif // T760_HOST_PLATFORM_BACKEND_H
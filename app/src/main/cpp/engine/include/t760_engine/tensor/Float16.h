@@ -0,0 +1,96 @@
+#ifndef T760_FLOAT16_H
+#define T760_FLOAT16_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace t760 {
+
+// Portable IEEE 754 binary16 and bfloat16 conversions for tensors stored as
+// raw uint16_t.
+// Hot loops should prefer the hardware conversions (F16C, NEON fcvt); these
+// are the fallback and the reference they are checked against.
+
+inline float fp16_to_fp32(uint16_t h) {
+    const uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1F;
+    uint32_t mantissa = h & 0x3FF;
+    uint32_t bits;
+    if (exponent == 0x1F) {
+        bits = sign | 0x7F800000u | (mantissa << 13); // Inf / NaN
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        bits = sign; // Signed zero
+    } else {
+        // Subnormal: renormalize into an FP32 normal.
+        exponent = 113;
+        while ((mantissa & 0x400) == 0) {
+            mantissa <<= 1;
+            --exponent;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+    }
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// Round-to-nearest-even, saturating to Inf on overflow.
+inline uint16_t fp32_to_fp16(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    const uint32_t abs_bits = bits & 0x7FFFFFFF;
+    if (abs_bits >= 0x7F800000u) {
+        return sign | 0x7C00 | (abs_bits > 0x7F800000u ? 0x200 : 0); // Inf / NaN
+    }
+    if (abs_bits >= 0x477FF000u) {
+        return sign | 0x7C00; // Rounds past the largest finite half
+    }
+    if (abs_bits < 0x38800000u) {
+        // Result is subnormal or zero: shift the implicit-one mantissa down.
+        if (abs_bits < 0x33000000u) {
+            return sign;
+        }
+        const uint32_t exponent = abs_bits >> 23;
+        const uint32_t mantissa = (abs_bits & 0x7FFFFF) | 0x800000;
+        const uint32_t shift = 126 - exponent;
+        uint32_t half = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1))) {
+            ++half;
+        }
+        return sign | static_cast<uint16_t>(half);
+    }
+    uint32_t half = ((abs_bits - 0x38000000u) >> 13);
+    const uint32_t remainder = abs_bits & 0x1FFF;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+        ++half;
+    }
+    return sign | static_cast<uint16_t>(half);
+}
+
+// bfloat16 is the upper half of an FP32; widening is exact.
+inline float bf16_to_fp32(uint16_t h) {
+    const uint32_t bits = static_cast<uint32_t>(h) << 16;
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// Round-to-nearest-even; NaN stays a (quiet) NaN.
+inline uint16_t fp32_to_bf16(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    if ((bits & 0x7FFFFFFF) > 0x7F800000u) {
+        return static_cast<uint16_t>((bits >> 16) | 0x40);
+    }
+    bits += 0x7FFF + ((bits >> 16) & 1);
+    return static_cast<uint16_t>(bits >> 16);
+}
+
+}
+
+#endif // T760_FLOAT16_H
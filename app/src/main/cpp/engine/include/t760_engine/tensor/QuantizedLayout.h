@@ -0,0 +1,46 @@
+#ifndef T760_QUANTIZED_LAYOUT_H
+#define T760_QUANTIZED_LAYOUT_H
+
+#include "t760_engine/core/Types.h"
+#include "t760_engine/tensor/TensorTypes.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace t760 {
+
+class Tensor;
+
+// Group-quantized weights are stored as a [rows, cols] matrix (out_features x
+// in_features, i.e. the PyTorch Linear layout) of symmetric quants, immediately
+// followed in the same buffer by rows * (cols / QUANT_GROUP_SIZE) FP32 scales,
+// also row-major. A weight is recovered as quant * scale.
+//
+// QINT8: one byte per quant, in [-127, 127].
+// QINT4: two quants per byte, stored as nibble = quant + 8 for quants in
+// [-8, 7]. Within a group of 64, byte j holds element j in its low nibble and
+// element j + 32 in its high nibble, so a single 32-byte load unpacks into two
+// contiguous 32-element halves with one mask and one shift.
+struct QuantizedMatrixView {
+    const void* quants = nullptr;
+    const float* scales = nullptr;
+    int64_t rows = 0;
+    int64_t cols = 0;
+    DataType data_type = DataType::QINT8;
+
+    int64_t groups_per_row() const { return cols / constants::QUANT_GROUP_SIZE; }
+};
+
+bool is_group_quantized(DataType dtype);
+
+// Bytes taken by the quants alone, i.e. the offset of the scale table.
+size_t quantized_quants_size_in_bytes(DataType dtype, int64_t rows, int64_t cols);
+
+// Total bytes (quants + scales) for a group-quantized tensor. The last dimension
+// is the quantized one and must be a multiple of QUANT_GROUP_SIZE.
+size_t quantized_tensor_size_in_bytes(DataType dtype, const TensorShape& shape);
+
+QuantizedMatrixView make_quantized_view(const Tensor& tensor);
+
+}
+
+#endif // T760_QUANTIZED_LAYOUT_H
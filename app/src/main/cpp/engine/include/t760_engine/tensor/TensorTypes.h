@@ -2,6 +2,7 @@
 #define T760_TENSOR_TYPES_H
 
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 
 namespace t760 {
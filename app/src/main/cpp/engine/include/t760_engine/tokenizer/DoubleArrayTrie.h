@@ -0,0 +1,55 @@
+#ifndef T760_DOUBLE_ARRAY_TRIE_H
+#define T760_DOUBLE_ARRAY_TRIE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace t760 {
+
+// One node of a double-array trie. The child of node s on byte c is
+// t = base[s] + c + 1 when check[t] == s; a key ending at s has a child on
+// label 0 whose base holds -(value + 1). Free slots have check == -1.
+struct DoubleArrayUnit {
+    int32_t base;
+    int32_t check;
+};
+
+// Read-only byte-string -> id map over units it does not own, such as a
+// memory-mapped file section. Each step of a lookup is two array reads.
+class DoubleArrayTrie {
+public:
+    DoubleArrayTrie() = default;
+    DoubleArrayTrie(const DoubleArrayUnit* units, size_t size) : units_(units), size_(size) {}
+
+    // Value of key, or -1.
+    int32_t find(const char* key, size_t length) const;
+    // Value of the longest key that starts text[0, length), with its length
+    // in matched; -1 (and matched 0) when no key does.
+    int32_t longest_prefix(const char* text, size_t length, size_t& matched) const;
+    // Whether some key starts with byte.
+    bool starts_key(uint8_t byte) const { return size_ > 0 && child(0, byte + 1u) >= 0; }
+    // Whether every value a lookup can return is in [0, limit), for units
+    // read from a file.
+    bool values_below(uint32_t limit) const;
+
+    // Units for keys, which must be sorted bytewise, unique and non-empty;
+    // values must be non-negative.
+    static std::vector<DoubleArrayUnit> build(const std::vector<std::pair<std::string, int32_t>>& keys);
+
+private:
+    // Child of node on label, or -1.
+    int32_t child(int32_t node, uint32_t label) const {
+        const int64_t t = static_cast<int64_t>(units_[node].base) + label;
+        return t >= 0 && static_cast<size_t>(t) < size_ && units_[t].check == node ? static_cast<int32_t>(t) : -1;
+    }
+
+    const DoubleArrayUnit* units_ = nullptr;
+    size_t size_ = 0;
+};
+
+}
+
+#endif // T760_DOUBLE_ARRAY_TRIE_H
@@ -0,0 +1,97 @@
+#ifndef T760_TOKENIZER_H
+#define T760_TOKENIZER_H
+
+#include "t760_engine/tokenizer/DoubleArrayTrie.h"
+#include "t760_engine/tokenizer/TokenizerFormat.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace t760 {
+
+// SentencePiece-style BPE (Gemma, Llama 2) over a memory-mapped .t760tok
+// file (see TokenizerFormat.h). Nothing is parsed or copied at load: one
+// pass checks that every offset and id in the tables is in range, so a
+// corrupt file fails there rather than in a lookup, and the pages stay
+// shared with the page cache.
+//
+// encode() follows the tokenizer.json pipeline: added tokens are cut out
+// of the raw text first (leftmost, longest match), each remaining segment
+// is normalized (spaces to U+2581, optional prefix), split into characters
+// (byte tokens for those outside the vocab) and merged by rank. Working
+// memory is per-thread and reused, so a call allocates nothing once warm
+// beyond growing the caller's output.
+//
+// Immutable after construction; any number of threads may encode and
+// decode at once.
+class Tokenizer {
+public:
+    // Maps the file; throws std::runtime_error when it cannot be opened or
+    // is not a valid tokenizer file.
+    explicit Tokenizer(const std::string& path);
+    ~Tokenizer();
+
+    Tokenizer(const Tokenizer&) = delete;
+    Tokenizer& operator=(const Tokenizer&) = delete;
+
+    // Appends the ids of text (UTF-8) to out, after bos_id() if add_bos.
+    void encode(std::string_view text, bool add_bos, std::vector<int>& out) const;
+    // Appends the UTF-8 text of ids to out, leaving CONTROL tokens out when
+    // skip_special. Byte tokens are emitted as raw bytes, so a prefix of a
+    // longer sequence may end inside a character.
+    void decode(const int* ids, size_t count, bool skip_special, std::string& out) const;
+    // Appends the bytes id stands for inside a text, where decode() would
+    // not drop a leading space: nothing for a CONTROL token.
+    void append_token_text(int32_t id, std::string& out) const;
+
+    // Id of a piece as stored in the vocab (U+2581 for spaces), or -1.
+    int32_t token_to_id(std::string_view piece) const;
+    std::string_view id_to_piece(int32_t id) const;
+    TokenType token_type(int32_t id) const;
+
+    uint32_t vocab_size() const { return header_->vocab_size; }
+    int32_t bos_id() const { return header_->bos_id; }
+    int32_t eos_id() const { return header_->eos_id; }
+    int32_t unk_id() const { return header_->unk_id; }
+    int32_t pad_id() const { return header_->pad_id; }
+
+private:
+    void validate(size_t file_size) const;
+    // Normalizes one segment free of added tokens and encodes it a word at a
+    // time when the vocab allows (TOKENIZER_WORD_BOUNDARIES).
+    void encode_segment(const char* text, size_t length, std::vector<int>& out) const;
+    // BPE over normalized text.
+    void encode_word(const char* text, size_t length, std::vector<int>& out) const;
+    // Rank and result of merging left then right, or false.
+    bool find_merge(int32_t left, int32_t right, uint32_t& rank, int32_t& merged) const;
+
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+    const TokenizerFileHeader* header_ = nullptr;
+    const uint32_t* piece_offsets_ = nullptr;
+    const char* strings_ = nullptr;
+    const TokenType* token_types_ = nullptr;
+    const MergeEntry* merges_ = nullptr;
+    uint32_t merge_mask_ = 0;
+    DoubleArrayTrie trie_;
+    DoubleArrayTrie added_trie_;
+    bool added_first_byte_[256] = {}; // Bytes an added token can start with
+};
+
+// Encode and decode throughput over a sample text, in MB of UTF-8 per second.
+struct TokenizerThroughput {
+    double encode_mb_per_s = 0.0;
+    double decode_mb_per_s = 0.0;
+    size_t bytes = 0;  // Sample size
+    size_t tokens = 0; // Tokens in the sample
+};
+
+// Times iterations passes of encode, then of decode, over sample.
+TokenizerThroughput measure_tokenizer_throughput(const Tokenizer& tokenizer, std::string_view sample,
+                                                 uint32_t iterations);
+
+}
+
+#endif // T760_TOKENIZER_H
@@ -0,0 +1,81 @@
+#ifndef T760_TOKENIZER_FORMAT_H
+#define T760_TOKENIZER_FORMAT_H
+
+#include <cstdint>
+
+namespace t760 {
+
+// Binary tokenizer file (.t760tok), written offline by
+// tools/convert_tokenizer.cpp from a Hugging Face tokenizer.json and mapped
+// read-only by Tokenizer. All sections start on 8-byte boundaries so the
+// runtime uses the arrays in place:
+//   piece_offsets  uint32[vocab_size + 1], piece i is strings[offsets[i], offsets[i + 1])
+//   strings        flat UTF-8 string table
+//   token_types    TokenType[vocab_size]
+//   merges         MergeEntry[merge_buckets], open addressing on (left, right)
+//   trie           DoubleArrayUnit[trie_size], every piece -> id
+//   added_trie     DoubleArrayUnit[added_trie_size], added tokens matched in raw text
+constexpr uint32_t TOKENIZER_FILE_MAGIC = 0x4B4F5437; // "7TOK"
+constexpr uint16_t TOKENIZER_FILE_VERSION = 1;
+
+// Normalization and fallback behavior, from the tokenizer.json pipeline.
+enum TokenizerFlags : uint16_t {
+    TOKENIZER_SPACE_TO_METASPACE = 1 << 0, // ' ' becomes U+2581 before BPE, and back on decode
+    TOKENIZER_PREPEND_METASPACE = 1 << 1,  // U+2581 starts every text segment; decode strips the first space
+    TOKENIZER_BYTE_FALLBACK = 1 << 2,      // Characters missing from the vocab become <0xXX> tokens
+    // No piece has U+2581 right after another character, so no merge spans
+    // the start of a word (a U+2581 run) and words encode independently.
+    TOKENIZER_WORD_BOUNDARIES = 1 << 3,
+};
+
+enum class TokenType : uint8_t {
+    NORMAL,       // A BPE piece
+    CONTROL,      // Special added token (<bos>, <end_of_turn>, ...); skippable on decode
+    BYTE,         // <0xXX> byte-fallback token
+    USER_DEFINED  // Added token that is not special
+};
+
+#pragma pack(push, 1)
+struct TokenizerFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags; // TokenizerFlags
+    uint32_t vocab_size;
+    int32_t bos_id; // -1 when the vocab has none
+    int32_t eos_id;
+    int32_t unk_id;
+    int32_t pad_id;
+    uint32_t merge_buckets; // Power of two
+    uint32_t trie_size;
+    uint32_t added_trie_size;
+    uint64_t strings_size;
+    uint64_t piece_offsets_offset;
+    uint64_t strings_offset;
+    uint64_t token_types_offset;
+    uint64_t merges_offset;
+    uint64_t trie_offset;
+    uint64_t added_trie_offset;
+    int32_t byte_tokens[256]; // Id of <0xXX>, or -1
+};
+
+// Merging the adjacent pieces left and right gives merged; lower ranks merge
+// first. Empty buckets have left == MERGE_EMPTY.
+struct MergeEntry {
+    uint32_t left;
+    uint32_t right;
+    uint32_t rank;
+    uint32_t merged;
+};
+#pragma pack(pop)
+
+constexpr uint32_t MERGE_EMPTY = 0xFFFFFFFFu;
+
+// First bucket probed for (left, right); probing continues linearly.
+inline uint32_t merge_bucket(uint32_t left, uint32_t right, uint32_t mask) {
+    uint64_t h = (static_cast<uint64_t>(left) << 32 | right) * 0x9E3779B97F4A7C15ull;
+    return static_cast<uint32_t>(h >> 32) & mask;
+}
+
+}
+
+#endif // T760_TOKENIZER_FORMAT_H
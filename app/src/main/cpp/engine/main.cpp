@@ -45,10 +45,10 @@ int main(int argc, char* argv[]) {
             std::vector<int> input_tokens = { 1, 50256 }; // Dummy tokens
             std::cout << "  - Generating response for " << input_tokens.size() << " tokens..." << std::endl;
             
-            // Execute the pipeline. The returned tensor is a placeholder for now.
-            t760::Tensor result = engine.generate(handle, input_tokens);
+            // Execute the pipeline; the output stage samples the next token.
+            t760::StepOutput result = engine.generate(handle, input_tokens);
             
-            std::cout << "  - Inference complete." << std::endl;
+            std::cout << "  - Inference complete. Next token: " << result.next_token << std::endl;
 
             engine.end_conversation(handle);
             std::cout << "  - Ended conversation." << std::endl;
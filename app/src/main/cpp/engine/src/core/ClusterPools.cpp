@@ -0,0 +1,28 @@
+#include "t760_engine/core/ClusterPools.h"
+#include <algorithm>
+#include <iostream>
+
+namespace t760 {
+
+const char* to_string(CoreCluster cluster) {
+    switch (cluster) {
+        case CoreCluster::BIG: return "big";
+        case CoreCluster::LITTLE: return "little";
+    }
+    return "unknown";
+}
+
+ClusterPools::ClusterPools(const ThreadingConfig& config, const CpuCapabilities& caps) {
+    const uint32_t big_cores = caps.performance_cores > 0 ? caps.performance_cores : std::max<uint32_t>(1, caps.total_cores);
+    const uint32_t big_threads = std::min(config.big_threads, big_cores);
+    const uint32_t little_threads = std::min(config.little_threads, caps.efficiency_cores);
+    big_ = std::make_unique<ThreadPool>(big_threads, config.big_affinity_mask, 0, config.spin_us);
+    little_ = std::make_unique<ThreadPool>(little_threads, config.little_affinity_mask, config.little_nice,
+                                           config.spin_us);
+    std::cout << "Thread pools: " << big_->get_num_threads() << " big (mask 0x" << std::hex
+              << config.big_affinity_mask << "), " << std::dec << little_->get_num_threads() << " little (mask 0x"
+              << std::hex << config.little_affinity_mask << std::dec << ", nice " << config.little_nice << ")."
+              << std::endl;
+}
+
+}
@@ -1,24 +1,94 @@
 #include "t760_engine/core/Engine.h"
+#include "t760_engine/core/ClusterPools.h"
 #include "t760_engine/device/DeviceManager.h"
 #include "t760_engine/tensor/TensorManager.h"
 #include "t760_engine/model/ModelLoader.h"
 #include "t760_engine/pipeline/InferencePipeline.h"
 #include "t760_engine/tensor/Tensor.h"
-#include "t760_engine/platform/android/AndroidPlatformBackend.h"
+#include "t760_engine/platform/IPlatformBackend.h"
+#include <algorithm>
+#include <chrono>
+#include <optional>
 #include <stdexcept>
 #include <iostream>
 
 namespace t760 {
 
+namespace {
+
+// A conversation of one generate_batch call and the prompt it runs.
+struct BatchSlot {
+    ConversationHandle handle;
+    size_t prompt = 0;
+    bool active = false;    // Running a prompt
+    bool prefilled = false; // Past the prompt's step; token is the next input
+    int32_t token = -1;
+    StepOutput output;
+    std::optional<GrammarCursor> grammar; // The prompt's, when it has one
+};
+
+uint64_t prompt_seed(const BatchOptions& options, size_t prompt) {
+    return options.seed == 0 ? 0 : options.seed + prompt;
+}
+
+std::string error_message(const std::exception_ptr& error) {
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::exception& e) {
+        return e.what();
+    } catch (...) {
+        return "Unknown error.";
+    }
+}
+
+}
+
+class Engine::CallScope {
+public:
+    explicit CallScope(const Engine& engine) : engine_(engine) {
+        std::unique_lock<std::mutex> lock(engine_.lifecycle_mutex_);
+        engine_.lifecycle_cv_.wait(lock, [&] { return !engine_.transition_; });
+        ++engine_.active_calls_;
+    }
+    ~CallScope() {
+        std::lock_guard<std::mutex> lock(engine_.lifecycle_mutex_);
+        if (--engine_.active_calls_ == 0) {
+            engine_.lifecycle_cv_.notify_all();
+        }
+    }
+
+private:
+    const Engine& engine_;
+};
+
+class Engine::TransitionScope {
+public:
+    explicit TransitionScope(Engine& engine) : engine_(engine) {
+        std::unique_lock<std::mutex> lock(engine_.lifecycle_mutex_);
+        engine_.lifecycle_cv_.wait(lock, [&] { return !engine_.transition_; });
+        // Claimed before draining, so calls arriving from here on wait.
+        engine_.transition_ = true;
+        engine_.lifecycle_cv_.wait(lock, [&] { return engine_.active_calls_ == 0; });
+    }
+    ~TransitionScope() {
+        std::lock_guard<std::mutex> lock(engine_.lifecycle_mutex_);
+        engine_.transition_ = false;
+        engine_.lifecycle_cv_.notify_all();
+    }
+
+private:
+    Engine& engine_;
+};
+
 Engine::Engine() = default;
 
 Engine::~Engine() {
-    if (state_ != EngineState::SHUTDOWN && state_ != EngineState::UNINITIALIZED) {
-        shutdown();
-    }
+    shutdown();
+    stop_generations(); // Any started while shutdown() ran
 }
 
 void Engine::initialize(const EngineConfig& config) {
+    TransitionScope transition(*this);
     if (state_ != EngineState::UNINITIALIZED) {
         throw std::runtime_error("Engine is already initialized or in an invalid state.");
     }
@@ -26,36 +96,57 @@ void Engine::initialize(const EngineConfig& config) {
     try {
         device_manager_ = std::make_unique<DeviceManager>();
         device_manager_->initialize(config.devices);
-        platform_backend_ = std::make_unique<AndroidPlatformBackend>();
+        const Device* cpu_device = device_manager_->get_device(DeviceType::CPU);
+        const auto* cpu_caps = cpu_device ? cpu_device->get_capabilities<CpuCapabilities>() : nullptr;
+        thread_pools_ = std::make_unique<ClusterPools>(config.threading, cpu_caps ? *cpu_caps : CpuCapabilities{});
+        platform_backend_ = create_platform_backend();
         platform_backend_->initialize(*device_manager_);
         tensor_manager_ = std::make_unique<TensorManager>(*platform_backend_);
-        model_loader_ = std::make_unique<ModelLoader>(*tensor_manager_);
-        inference_pipeline_ = std::make_unique<InferencePipeline>(*device_manager_, *tensor_manager_);
+        const WeightPrecisionPolicy precision =
+            make_weight_precision_policy(config.weight_precision, cpu_caps ? *cpu_caps : CpuCapabilities{});
+        model_loader_ = std::make_unique<ModelLoader>(*tensor_manager_, precision);
+        draft_loader_ = std::make_unique<ModelLoader>(*tensor_manager_, precision);
+        PipelineOptions pipeline_options;
+        pipeline_options.prefill_activations = config.prefill_activations;
+        pipeline_options.max_decode_batch = config.max_concurrent_conversations;
+        pipeline_options.prefill_chunk_tokens = config.prefill_chunk_tokens;
+        pipeline_options.step_token_budget = config.step_token_budget;
+        inference_pipeline_ = std::make_unique<InferencePipeline>(*device_manager_, *tensor_manager_, *thread_pools_,
+                                                                  pipeline_options);
         state_ = EngineState::INITIALIZED;
     } catch (const std::exception& e) {
         state_ = EngineState::ERROR_STATE;
-        shutdown();
+        shutdown_locked();
         throw;
     }
 }
 
 void Engine::shutdown() {
+    stop_generations();
+    TransitionScope transition(*this);
+    shutdown_locked();
+}
+
+void Engine::shutdown_locked() {
     if (state_ == EngineState::UNINITIALIZED || state_ == EngineState::SHUTDOWN) {
         return;
     }
-    unload_model();
+    unload_model_locked();
     inference_pipeline_.reset();
+    draft_loader_.reset();
     model_loader_.reset();
     tensor_manager_.reset();
     if (platform_backend_) {
         platform_backend_->shutdown();
         platform_backend_.reset();
     }
+    thread_pools_.reset();
     device_manager_.reset();
     state_ = EngineState::SHUTDOWN;
 }
 
 bool Engine::load_model(const std::string& model_path) {
+    TransitionScope transition(*this);
     if (state_ != EngineState::INITIALIZED) {
         throw std::runtime_error("Engine must be in INITIALIZED state to load a model.");
     }
@@ -68,43 +159,495 @@ bool Engine::load_model(const std::string& model_path) {
 }
 
 void Engine::unload_model() {
-    if (state_ == EngineState::MODEL_LOADED || state_ == EngineState::INFERENCE_ACTIVE) {
-        inference_pipeline_->release();
+    stop_generations();
+    TransitionScope transition(*this);
+    unload_model_locked();
+}
+
+void Engine::unload_model_locked() {
+    if (state_ == EngineState::MODEL_LOADED) {
+        inference_pipeline_->release(); // Detaches the draft too
+        draft_loader_->unload_model();
         model_loader_->unload_model();
         state_ = EngineState::INITIALIZED;
     }
 }
 
-ConversationHandle Engine::start_new_conversation() {
-    if (state_ != EngineState::MODEL_LOADED && state_ != EngineState::INFERENCE_ACTIVE) {
+bool Engine::load_draft_model(const std::string& model_path) {
+    TransitionScope transition(*this);
+    if (state_ != EngineState::MODEL_LOADED) {
+        throw std::runtime_error("A model must be loaded before its draft model.");
+    }
+    unload_draft_model_locked();
+    if (!draft_loader_->load_model(model_path)) {
+        return false;
+    }
+    try {
+        inference_pipeline_->attach_draft(*draft_loader_->get_model());
+    } catch (...) {
+        draft_loader_->unload_model();
+        throw;
+    }
+    return true;
+}
+
+void Engine::unload_draft_model() {
+    TransitionScope transition(*this);
+    unload_draft_model_locked();
+}
+
+void Engine::unload_draft_model_locked() {
+    if (state_ == EngineState::MODEL_LOADED) {
+        inference_pipeline_->detach_draft();
+        draft_loader_->unload_model();
+    }
+}
+
+ConversationHandle Engine::start_new_conversation(const ConversationOptions& options) {
+    CallScope call(*this);
+    if (state_ != EngineState::MODEL_LOADED) {
         throw std::runtime_error("A model must be loaded to start a conversation.");
     }
-    return inference_pipeline_->create_new_context();
+    return inference_pipeline_->create_new_context(options);
 }
 
 void Engine::end_conversation(ConversationHandle handle) {
-    if (state_ == EngineState::MODEL_LOADED || state_ == EngineState::INFERENCE_ACTIVE) {
+    CallScope call(*this);
+    if (state_ == EngineState::MODEL_LOADED) {
         inference_pipeline_->destroy_context(handle);
     }
 }
 
-std::unique_ptr<Tensor> Engine::generate(ConversationHandle handle, const std::vector<int>& input_token_ids) {
-    if (state_ != EngineState::MODEL_LOADED && state_ != EngineState::INFERENCE_ACTIVE) {
+size_t Engine::remaining_context(ConversationHandle handle) {
+    CallScope call(*this);
+    if (state_ != EngineState::MODEL_LOADED) {
+        throw std::runtime_error("Engine must be in MODEL_LOADED state for inference.");
+    }
+    return inference_pipeline_->remaining_positions(handle);
+}
+
+StepOutput Engine::generate(ConversationHandle handle, const std::vector<int>& input_token_ids,
+                            const OutputOptions& options) {
+    CallScope call(*this);
+    if (state_ != EngineState::MODEL_LOADED) {
+        throw std::runtime_error("Engine must be in MODEL_LOADED state for inference.");
+    }
+    return inference_pipeline_->execute(handle, input_token_ids, options);
+}
+
+void Engine::generate(ConversationHandle handle, const int* input_token_ids, size_t count, StepOutput& output,
+                      const OutputOptions& options) {
+    CallScope call(*this);
+    if (state_ != EngineState::MODEL_LOADED) {
         throw std::runtime_error("Engine must be in MODEL_LOADED state for inference.");
     }
-    EngineState previous_state = state_;
-    state_ = EngineState::INFERENCE_ACTIVE;
-    auto result = inference_pipeline_->execute(handle, input_token_ids);
-    state_ = previous_state;
+    inference_pipeline_->execute(handle, input_token_ids, count, options, output);
+}
+
+void Engine::generate_speculative(ConversationHandle handle, const int* input_token_ids, size_t count,
+                                  const OutputOptions& options, const SpeculationOptions& speculation,
+                                  SpeculativeOutput& output) {
+    CallScope call(*this);
+    if (state_ != EngineState::MODEL_LOADED) {
+        throw std::runtime_error("Engine must be in MODEL_LOADED state for inference.");
+    }
+    inference_pipeline_->execute_speculative(handle, input_token_ids, count, options, speculation, output);
+}
+
+std::shared_ptr<GenerationTask> Engine::generate_async(ConversationHandle handle, std::vector<int> prompt,
+                                                       const GenerationParams& params, TokenCallback on_token,
+                                                       GenerationDoneCallback on_done) {
+    {
+        CallScope call(*this);
+        if (state_ != EngineState::MODEL_LOADED) {
+            throw std::runtime_error("Engine must be in MODEL_LOADED state for inference.");
+        }
+    }
+    if (prompt.empty()) {
+        throw std::runtime_error("generate_async needs at least one prompt token.");
+    }
+    auto task = std::make_shared<GenerationTask>();
+    std::lock_guard<std::mutex> lock(generations_mutex_);
+    // Reap the threads of generations that have ended.
+    for (auto it = generations_.begin(); it != generations_.end();) {
+        if (it->task->get_status() != GenerationStatus::RUNNING) {
+            it->thread.join();
+            it = generations_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    std::thread thread([this, task, handle, prompt = std::move(prompt), params, on_token = std::move(on_token),
+                        on_done = std::move(on_done)] {
+        run_generation(*task, handle, prompt, params, on_token);
+        if (on_done) {
+            on_done(task->get_status());
+        }
+    });
+    generations_.push_back(Generation{task, std::move(thread)});
+    return task;
+}
+
+void Engine::run_generation(GenerationTask& task, ConversationHandle handle, const std::vector<int>& prompt,
+                            const GenerationParams& params, const TokenCallback& on_token) {
+    OutputOptions options;
+    options.sampling = params.sampling;
+    const auto& stops = params.stop_tokens;
+    std::optional<GrammarCursor> grammar;
+    uint32_t emitted = 0;
+    // Checks and hands on the next sampled token; false once generation has
+    // ended.
+    const auto deliver = [&](int32_t token) {
+        if (token < 0) {
+            task.finish(GenerationStatus::FAILED,
+                        grammar ? "No token continues the grammar." : "The model produced no token.");
+            return false;
+        }
+        if (std::find(stops.begin(), stops.end(), token) != stops.end()) {
+            task.finish(GenerationStatus::STOPPED);
+            return false;
+        }
+        if (emitted == params.max_new_tokens) {
+            task.finish(GenerationStatus::LENGTH);
+            return false;
+        }
+        if (task.is_cancelled()) {
+            task.finish(GenerationStatus::CANCELLED);
+            return false;
+        }
+        if (grammar && !grammar->advance(token)) {
+            task.finish(GenerationStatus::FAILED, "The model left the grammar.");
+            return false;
+        }
+        if (on_token) {
+            on_token(token);
+        }
+        task.token_count_ = ++emitted;
+        if (grammar) {
+            if (grammar->is_finished()) {
+                task.finish(GenerationStatus::STOPPED);
+                return false;
+            }
+            options.allowed_tokens = grammar->allowed();
+        }
+        return true;
+    };
+    try {
+        if (params.grammar) {
+            grammar.emplace(params.grammar, stops);
+            options.allowed_tokens = grammar->allowed();
+        }
+        // Each step is a generate() call, so transitions and other
+        // conversations interleave with it at token boundaries.
+        if (!grammar && !params.sampling.has_penalties() && params.draft_tokens > 0) {
+            // Without a draft conversation each step runs as a plain one.
+            SpeculationOptions speculation;
+            speculation.draft_tokens = params.draft_tokens;
+            speculation.stop_tokens = &stops;
+            SpeculativeOutput output;
+            int32_t token = -1;
+            const int* input = prompt.data();
+            size_t count = prompt.size();
+            while (true) {
+                // One past the limit, so that a stop token there still ends
+                // the generation as STOPPED.
+                speculation.max_tokens = params.max_new_tokens - emitted + 1;
+                generate_speculative(handle, input, count, options, speculation, output);
+                if (output.tokens.empty()) {
+                    deliver(-1);
+                    return;
+                }
+                for (int32_t next : output.tokens) {
+                    if (!deliver(next)) {
+                        return;
+                    }
+                }
+                token = output.tokens.back();
+                input = &token;
+                count = 1;
+            }
+        }
+        StepOutput output;
+        generate(handle, prompt.data(), prompt.size(), output, options);
+        while (deliver(output.next_token)) {
+            const int32_t token = output.next_token;
+            generate(handle, &token, 1, output, options);
+        }
+    } catch (const std::exception& e) {
+        task.finish(task.is_cancelled() ? GenerationStatus::CANCELLED : GenerationStatus::FAILED, e.what());
+    }
+}
+
+std::vector<BatchCompletion> Engine::generate_batch(const std::vector<BatchPrompt>& prompts,
+                                                    const BatchOptions& options) {
+    std::vector<BatchCompletion> completions(prompts.size());
+    std::vector<BatchSlot> slots;
+    std::vector<StepCall> calls;
+    std::vector<BatchSlot*> called;
+    size_t next_prompt = 0;
+    try {
+        // Each round of steps is a call of its own, so transitions
+        // interleave with the batch at token boundaries, as with
+        // generate_async.
+        while (true) {
+            CallScope call(*this);
+            if (state_ != EngineState::MODEL_LOADED) {
+                throw std::runtime_error("Engine must be in MODEL_LOADED state for inference.");
+            }
+            if (slots.empty()) {
+                const uint32_t max_active = options.max_active > 0
+                                                ? options.max_active
+                                                : inference_pipeline_->get_options().max_decode_batch;
+                ConversationOptions conversation;
+                conversation.priority = options.priority;
+                slots.resize(std::min<size_t>(prompts.size(), max_active));
+                for (BatchSlot& slot : slots) {
+                    slot.handle = inference_pipeline_->create_new_context(conversation);
+                }
+            }
+            calls.clear();
+            called.clear();
+            for (BatchSlot& slot : slots) {
+                // A free slot takes the next prompt on the caches it has.
+                while (!slot.active && next_prompt < prompts.size()) {
+                    const size_t i = next_prompt++;
+                    if (prompts[i].tokens.empty()) {
+                        completions[i].status = GenerationStatus::FAILED;
+                        completions[i].error = "generate_batch needs at least one prompt token.";
+                        continue;
+                    }
+                    inference_pipeline_->reset_context(slot.handle, prompt_seed(options, i));
+                    slot.prompt = i;
+                    slot.active = true;
+                    slot.prefilled = false;
+                    slot.grammar.reset();
+                    if (prompts[i].params.grammar) {
+                        slot.grammar.emplace(prompts[i].params.grammar, prompts[i].params.stop_tokens);
+                    }
+                }
+                if (!slot.active) {
+                    continue;
+                }
+                const BatchPrompt& prompt = prompts[slot.prompt];
+                StepCall step;
+                step.handle = slot.handle;
+                step.tokens = slot.prefilled ? &slot.token : prompt.tokens.data();
+                step.count = slot.prefilled ? 1 : prompt.tokens.size();
+                step.options.sampling = prompt.params.sampling;
+                if (slot.grammar) {
+                    step.options.allowed_tokens = slot.grammar->allowed();
+                }
+                step.output = &slot.output;
+                calls.push_back(step);
+                called.push_back(&slot);
+            }
+            if (calls.empty()) {
+                break;
+            }
+            inference_pipeline_->execute_many(calls.data(), calls.size());
+
+            for (size_t c = 0; c < calls.size(); ++c) {
+                BatchSlot& slot = *called[c];
+                BatchCompletion& completion = completions[slot.prompt];
+                const GenerationParams& params = prompts[slot.prompt].params;
+                const auto& stops = params.stop_tokens;
+                const int32_t token = slot.output.next_token;
+                slot.active = false;
+                if (calls[c].error) {
+                    completion.status = GenerationStatus::FAILED;
+                    completion.error = error_message(calls[c].error);
+                } else if (token < 0) {
+                    completion.status = GenerationStatus::FAILED;
+                    completion.error = slot.grammar ? "No token continues the grammar." : "The model produced no token.";
+                } else if (std::find(stops.begin(), stops.end(), token) != stops.end()) {
+                    completion.status = GenerationStatus::STOPPED;
+                } else if (completion.tokens.size() == params.max_new_tokens) {
+                    completion.status = GenerationStatus::LENGTH;
+                } else if (slot.grammar && !slot.grammar->advance(token)) {
+                    completion.status = GenerationStatus::FAILED;
+                    completion.error = "The model left the grammar.";
+                } else {
+                    completion.tokens.push_back(token);
+                    if (slot.grammar && slot.grammar->is_finished()) {
+                        completion.status = GenerationStatus::STOPPED;
+                        continue;
+                    }
+                    slot.token = token;
+                    slot.active = true;
+                    slot.prefilled = true;
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        for (BatchCompletion& completion : completions) {
+            if (completion.status == GenerationStatus::RUNNING) {
+                completion.status = GenerationStatus::FAILED;
+                completion.error = e.what();
+            }
+        }
+    }
+    for (const BatchSlot& slot : slots) {
+        end_conversation(slot.handle);
+    }
+    return completions;
+}
+
+BatchThroughput Engine::benchmark_batch(const std::vector<BatchPrompt>& prompts, const BatchOptions& options) {
+    using Clock = std::chrono::steady_clock;
+    BatchThroughput result;
+    result.prompts = prompts.size();
+    for (const BatchPrompt& prompt : prompts) {
+        result.prompt_tokens += prompt.tokens.size();
+    }
+
+    size_t sequential_tokens = 0;
+    auto start = Clock::now();
+    for (size_t i = 0; i < prompts.size(); ++i) {
+        ConversationOptions conversation;
+        conversation.priority = options.priority;
+        conversation.seed = prompt_seed(options, i);
+        const ConversationHandle handle = start_new_conversation(conversation);
+        // generate_batch does not speculate, so neither does its baseline.
+        GenerationParams params = prompts[i].params;
+        params.draft_tokens = 0;
+        GenerationTask task;
+        run_generation(task, handle, prompts[i].tokens, params, TokenCallback{});
+        sequential_tokens += task.get_token_count();
+        end_conversation(handle);
+    }
+    const double sequential_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (const BatchCompletion& completion : generate_batch(prompts, options)) {
+        result.generated_tokens += completion.tokens.size();
+    }
+    const double batched_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+    result.sequential_tokens_per_s = sequential_s > 0.0 ? sequential_tokens / sequential_s : 0.0;
+    result.batched_tokens_per_s = batched_s > 0.0 ? result.generated_tokens / batched_s : 0.0;
     return result;
 }
 
+std::vector<float> Engine::embed(const std::vector<int>& token_ids, const EmbeddingOptions& options) {
+    CallScope call(*this);
+    if (state_ != EngineState::MODEL_LOADED) {
+        throw std::runtime_error("Engine must be in MODEL_LOADED state for inference.");
+    }
+    std::vector<float> embedding(inference_pipeline_->embedding_size());
+    inference_pipeline_->embed(&token_ids, 1, options, embedding.data());
+    return embedding;
+}
+
+std::vector<std::vector<float>> Engine::embed_batch(const std::vector<std::vector<int>>& inputs,
+                                                    const EmbeddingOptions& options) {
+    CallScope call(*this);
+    if (state_ != EngineState::MODEL_LOADED) {
+        throw std::runtime_error("Engine must be in MODEL_LOADED state for inference.");
+    }
+    const size_t size = inference_pipeline_->embedding_size();
+    std::vector<float> rows(inputs.size() * size);
+    inference_pipeline_->embed(inputs.data(), inputs.size(), options, rows.data());
+    std::vector<std::vector<float>> embeddings(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        embeddings[i].assign(rows.begin() + i * size, rows.begin() + (i + 1) * size);
+    }
+    return embeddings;
+}
+
+size_t Engine::embedding_size() const {
+    CallScope call(*this);
+    if (state_ != EngineState::MODEL_LOADED) {
+        return 0;
+    }
+    return inference_pipeline_->embedding_size();
+}
+
+void Engine::stop_generations() {
+    std::vector<Generation> generations;
+    {
+        std::lock_guard<std::mutex> lock(generations_mutex_);
+        generations.swap(generations_);
+    }
+    for (Generation& generation : generations) {
+        generation.task->cancel();
+    }
+    for (Generation& generation : generations) {
+        generation.thread.join();
+    }
+}
+
+LatencyStats Engine::get_latency_stats(RequestPriority priority) const {
+    CallScope call(*this);
+    if (!inference_pipeline_) {
+        return LatencyStats{};
+    }
+    return inference_pipeline_->get_latency_stats(priority);
+}
+
+SpeculationStats Engine::get_speculation_stats() const {
+    CallScope call(*this);
+    if (!inference_pipeline_) {
+        return SpeculationStats{};
+    }
+    return inference_pipeline_->get_speculation_stats();
+}
+
+bool Engine::load_tokenizer(const std::string& path) {
+    try {
+        auto tokenizer = std::make_shared<const Tokenizer>(path);
+        std::cout << "Tokenizer loaded: " << tokenizer->vocab_size() << " tokens from " << path << std::endl;
+        std::lock_guard<std::mutex> lock(tokenizer_mutex_);
+        tokenizer_ = std::move(tokenizer);
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load tokenizer: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+std::shared_ptr<const Tokenizer> Engine::tokenizer() const {
+    std::lock_guard<std::mutex> lock(tokenizer_mutex_);
+    if (!tokenizer_) {
+        throw std::runtime_error("No tokenizer is loaded.");
+    }
+    return tokenizer_;
+}
+
+std::vector<int> Engine::encode(std::string_view text, bool add_bos) const {
+    std::vector<int> ids;
+    tokenizer()->encode(text, add_bos, ids);
+    return ids;
+}
+
+std::string Engine::decode(const std::vector<int>& token_ids, bool skip_special) const {
+    std::string text;
+    tokenizer()->decode(token_ids.data(), token_ids.size(), skip_special, text);
+    return text;
+}
+
+void Engine::decode(const int* token_ids, size_t count, bool skip_special, std::string& out) const {
+    tokenizer()->decode(token_ids, count, skip_special, out);
+}
+
+int32_t Engine::token_id(std::string_view piece) const {
+    return tokenizer()->token_to_id(piece);
+}
+
+TokenizerThroughput Engine::benchmark_tokenizer(std::string_view sample, uint32_t iterations) const {
+    return measure_tokenizer_throughput(*tokenizer(), sample, iterations);
+}
+
+std::shared_ptr<const TokenGrammar> Engine::compile_grammar(std::string_view source, GrammarSyntax syntax) const {
+    return std::make_shared<const TokenGrammar>(std::make_shared<const Grammar>(source, syntax), tokenizer());
+}
+
 EngineState Engine::get_state() const {
-    return state_;
+    const EngineState state = state_;
+    return state == EngineState::MODEL_LOADED && active_calls_ > 0 ? EngineState::INFERENCE_ACTIVE : state;
 }
 
 bool Engine::is_model_loaded() const {
-    return state_ == EngineState::MODEL_LOADED || state_ == EngineState::INFERENCE_ACTIVE;
+    return state_ == EngineState::MODEL_LOADED;
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "t760_engine/core/Generation.h"
+#include <algorithm>
+
+namespace t760 {
+
+GenerationStatus GenerationTask::wait() const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [&] { return status_ != GenerationStatus::RUNNING; });
+    return status_;
+}
+
+GenerationStatus GenerationTask::get_status() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return status_;
+}
+
+std::string GenerationTask::get_error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+void GenerationTask::finish(GenerationStatus status, std::string error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    status_ = status;
+    error_ = std::move(error);
+    done_cv_.notify_all();
+}
+
+TokenStream::TokenStream(size_t capacity) {
+    size_t size = 1;
+    while (size < std::max<size_t>(capacity, 1)) {
+        size <<= 1;
+    }
+    ring_ = std::make_unique<int32_t[]>(size);
+    mask_ = size - 1;
+}
+
+bool TokenStream::push(int32_t token) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) > mask_) {
+        return false;
+    }
+    ring_[head & mask_] = token;
+    head_.store(head + 1, std::memory_order_seq_cst);
+    // Pairs with the reader publishing reader_waiting_ before it re-checks
+    // head_, so one of the two always sees the other.
+    if (reader_waiting_.load(std::memory_order_seq_cst)) {
+        wake_reader();
+    }
+    return true;
+}
+
+void TokenStream::close() {
+    closed_.store(true, std::memory_order_seq_cst);
+    wake_reader();
+}
+
+void TokenStream::wake_reader() {
+    // Taking the mutex orders the notify after the reader's predicate check.
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    cv_.notify_one();
+}
+
+int64_t TokenStream::read(int32_t* out, size_t max_tokens, std::chrono::milliseconds timeout) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+    if (head == tail) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        reader_waiting_.store(true, std::memory_order_seq_cst);
+        cv_.wait_for(lock, timeout, [&] {
+            head = head_.load(std::memory_order_seq_cst);
+            return head != tail || closed_.load(std::memory_order_seq_cst);
+        });
+        reader_waiting_.store(false, std::memory_order_relaxed);
+        if (head == tail) {
+            // close() follows the last push, so an empty closed stream is drained.
+            return closed_.load(std::memory_order_acquire) && head_.load(std::memory_order_acquire) == tail ? -1 : 0;
+        }
+    }
+    const size_t count = std::min(head - tail, max_tokens);
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = ring_[(tail + i) & mask_];
+    }
+    tail_.store(tail + count, std::memory_order_release);
+    return static_cast<int64_t>(count);
+}
+
+}
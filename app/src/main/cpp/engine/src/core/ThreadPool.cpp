@@ -0,0 +1,448 @@
+#include "t760_engine/core/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace t760 {
+
+namespace {
+// Set on pool workers and on a caller while it runs tasks, so nested
+// parallel_for calls degrade to a plain loop instead of deadlocking.
+thread_local bool in_parallel_region = false;
+
+inline uint64_t pack_range(uint64_t begin, uint64_t end) { return (begin << 32) | end; }
+inline uint32_t range_begin(uint64_t bounds) { return static_cast<uint32_t>(bounds >> 32); }
+inline uint32_t range_end(uint64_t bounds) { return static_cast<uint32_t>(bounds); }
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Polls ready() for up to spin_us; returns its last result.
+template <typename Ready>
+bool spin_until(uint32_t spin_us, const Ready& ready) {
+    if (spin_us == 0) {
+        return ready();
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(spin_us);
+    for (uint32_t i = 1;; ++i) {
+        if (ready()) {
+            return true;
+        }
+        cpu_relax();
+        if ((i & 63) == 0 && std::chrono::steady_clock::now() >= deadline) {
+            return ready();
+        }
+    }
+}
+
+// CPUs of mask this process may run on, or every online CPU when the mask
+// names none of them (the workers then stay unpinned).
+uint32_t usable_cpus(uint64_t affinity_mask) {
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        uint32_t count = 0;
+        for (uint32_t cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; ++cpu) {
+            if ((affinity_mask & (uint64_t{1} << cpu)) && CPU_ISSET(cpu, &allowed)) {
+                ++count;
+            }
+        }
+        if (count > 0) {
+            return count;
+        }
+    }
+#else
+    (void)affinity_mask;
+#endif
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// One unit of a ready graph node: tasks [begin, end).
+struct GraphItem {
+    TaskGraph::NodeId node;
+    size_t begin;
+    size_t end;
+};
+
+// Per-thread ready list: the owner works LIFO from the back, thieves take
+// the oldest items from the front.
+struct alignas(64) GraphQueue {
+    std::mutex mutex;
+    std::deque<GraphItem> items;
+};
+}
+
+bool pin_current_thread(uint64_t affinity_mask) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (uint32_t cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; ++cpu) {
+        if (affinity_mask & (uint64_t{1} << cpu)) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (CPU_COUNT(&set) == 0) {
+        return false;
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)affinity_mask;
+    return false;
+#endif
+}
+
+bool set_current_thread_nice(int nice) {
+#if defined(__linux__)
+    // Linux applies PRIO_PROCESS with a thread id to that thread alone.
+    return setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice) == 0;
+#else
+    (void)nice;
+    return false;
+#endif
+}
+
+TaskGraph::NodeId TaskGraph::add(std::function<void(size_t)> fn, size_t num_tasks, std::initializer_list<NodeId> after) {
+    const NodeId id = nodes_.size();
+    nodes_.emplace_back();
+    nodes_.back().fn = std::move(fn);
+    nodes_.back().num_tasks = num_tasks;
+    for (NodeId before : after) {
+        add_dependency(id, before);
+    }
+    return id;
+}
+
+void TaskGraph::add_dependency(NodeId node, NodeId before) {
+    if (node >= nodes_.size() || before >= node) {
+        throw std::runtime_error("TaskGraph nodes may only depend on nodes added before them.");
+    }
+    nodes_[before].successors.push_back(node);
+    ++nodes_[node].num_predecessors;
+}
+
+ThreadPool::ThreadPool(uint32_t num_threads, uint64_t affinity_mask, int nice, uint32_t spin_us)
+    : num_threads_(std::max<uint32_t>(1, num_threads)),
+      affinity_mask_(affinity_mask),
+      nice_(nice),
+      spin_us_(usable_cpus(affinity_mask) >= num_threads_ ? spin_us : 0),
+      ranges_(new TaskRange[num_threads_]) {
+    workers_.reserve(num_threads_ - 1);
+    for (uint32_t slot = 1; slot < num_threads_; ++slot) {
+        workers_.emplace_back([this, slot] { worker_loop(slot); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_.store(true, std::memory_order_relaxed);
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+    work_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::record_error() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_) {
+        error_ = std::current_exception();
+    }
+    failed_.store(true, std::memory_order_relaxed);
+    // Empty every share so the remaining tasks are skipped.
+    for (uint32_t slot = 0; slot < num_threads_; ++slot) {
+        ranges_[slot].bounds.store(0, std::memory_order_relaxed);
+    }
+}
+
+void ThreadPool::worker_loop(uint32_t slot) {
+    // Pinning is best effort: a mask naming offline cores (e.g. on a host
+    // build) simply leaves the thread to the scheduler.
+    pin_current_thread(affinity_mask_);
+    if (nice_ != 0) {
+        set_current_thread_nice(nice_);
+    }
+    in_parallel_region = true;
+
+    uint64_t seen_generation = 0;
+    while (true) {
+        const bool woke = spin_until(spin_us_, [&] {
+            return generation_.load(std::memory_order_acquire) != seen_generation;
+        });
+        if (!woke) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [&] { return generation_.load(std::memory_order_acquire) != seen_generation; });
+        }
+        seen_generation = generation_.load(std::memory_order_acquire);
+        if (stopping_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        (*work_)(slot);
+        if (active_workers_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_cv_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::dispatch(FunctionRef<void(uint32_t)> work) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        work_ = &work;
+        active_workers_.store(static_cast<uint32_t>(workers_.size()), std::memory_order_relaxed);
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+    work_cv_.notify_all();
+
+    in_parallel_region = true;
+    work(0);
+    in_parallel_region = false;
+
+    auto done = [&] { return active_workers_.load(std::memory_order_acquire) == 0; };
+    if (!spin_until(spin_us_, done)) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, done);
+    }
+    work_ = nullptr;
+}
+
+bool ThreadPool::pop_or_steal(uint32_t slot, size_t& task) {
+    if (failed_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    TaskRange& own = ranges_[slot];
+    uint64_t bounds = own.bounds.load(std::memory_order_acquire);
+    while (range_begin(bounds) < range_end(bounds)) {
+        if (own.bounds.compare_exchange_weak(bounds, pack_range(range_begin(bounds) + 1, range_end(bounds)),
+                                             std::memory_order_acq_rel)) {
+            task = range_begin(bounds);
+            return true;
+        }
+    }
+    // Own share drained: take the back half of the largest remaining one.
+    while (!failed_.load(std::memory_order_relaxed)) {
+        uint32_t victim = num_threads_;
+        uint32_t largest = 0;
+        for (uint32_t other = 0; other < num_threads_; ++other) {
+            const uint64_t b = ranges_[other].bounds.load(std::memory_order_relaxed);
+            const uint32_t remaining = range_end(b) > range_begin(b) ? range_end(b) - range_begin(b) : 0;
+            if (other != slot && remaining > largest) {
+                largest = remaining;
+                victim = other;
+            }
+        }
+        if (victim == num_threads_) {
+            return false;
+        }
+        uint64_t b = ranges_[victim].bounds.load(std::memory_order_acquire);
+        const uint32_t begin = range_begin(b);
+        const uint32_t end = range_end(b);
+        if (begin >= end) {
+            continue;
+        }
+        const uint32_t mid = end - (end - begin + 1) / 2;
+        if (ranges_[victim].bounds.compare_exchange_strong(b, pack_range(begin, mid), std::memory_order_acq_rel)) {
+            task = mid;
+            own.bounds.store(pack_range(mid + 1, end), std::memory_order_release);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::parallel_for(size_t num_tasks, FunctionRef<void(size_t)> fn) {
+    if (num_tasks == 0) {
+        return;
+    }
+    if (workers_.empty() || num_tasks == 1 || in_parallel_region) {
+        for (size_t task = 0; task < num_tasks; ++task) {
+            fn(task);
+        }
+        return;
+    }
+    if (num_tasks > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("ThreadPool::parallel_for supports at most 2^32 - 1 tasks.");
+    }
+
+    std::lock_guard<std::mutex> submit_lock(submit_mutex_);
+    for (uint32_t slot = 0; slot < num_threads_; ++slot) {
+        ranges_[slot].bounds.store(pack_range(num_tasks * slot / num_threads_, num_tasks * (slot + 1) / num_threads_),
+                                   std::memory_order_relaxed);
+    }
+    failed_.store(false, std::memory_order_relaxed);
+    const auto work = [&](uint32_t slot) {
+        size_t task;
+        while (pop_or_steal(slot, task)) {
+            try {
+                fn(task);
+            } catch (...) {
+                record_error();
+            }
+        }
+    };
+    dispatch(work);
+
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::run(const TaskGraph& graph) {
+    const size_t num_nodes = graph.nodes_.size();
+    if (num_nodes == 0) {
+        return;
+    }
+    // Every dependency points at an earlier node, so id order is topological.
+    if (workers_.empty() || in_parallel_region) {
+        for (const auto& node : graph.nodes_) {
+            for (size_t task = 0; task < node.num_tasks; ++task) {
+                node.fn(task);
+            }
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> submit_lock(submit_mutex_);
+    std::unique_ptr<std::atomic<uint32_t>[]> waiting(new std::atomic<uint32_t>[num_nodes]);
+    std::unique_ptr<std::atomic<size_t>[]> unfinished(new std::atomic<size_t>[num_nodes]);
+    for (size_t i = 0; i < num_nodes; ++i) {
+        waiting[i].store(graph.nodes_[i].num_predecessors, std::memory_order_relaxed);
+        unfinished[i].store(graph.nodes_[i].num_tasks, std::memory_order_relaxed);
+    }
+    std::atomic<size_t> nodes_left{num_nodes};
+    std::unique_ptr<GraphQueue[]> queues(new GraphQueue[num_threads_]);
+    // Items per node: twice the thread count, so a stolen item is a useful
+    // amount of work but the node still balances.
+    const size_t items_per_node = 2 * static_cast<size_t>(num_threads_);
+
+    // Threads with nothing to take spin for spin_us_, then park until work
+    // is pushed or the graph is done; both bump ready_epoch. A pusher takes
+    // park_mutex only when someone is parked (seq_cst on both counters).
+    std::atomic<uint64_t> ready_epoch{0};
+    std::atomic<uint32_t> parked{0};
+    std::mutex park_mutex;
+    std::condition_variable park_cv;
+    auto wake_parked = [&] {
+        ready_epoch.fetch_add(1);
+        if (parked.load() > 0) {
+            { std::lock_guard<std::mutex> lock(park_mutex); }
+            park_cv.notify_all();
+        }
+    };
+
+    std::function<void(uint32_t, TaskGraph::NodeId)> make_ready;
+    auto finish_node = [&](uint32_t slot, TaskGraph::NodeId id) {
+        for (TaskGraph::NodeId next : graph.nodes_[id].successors) {
+            if (waiting[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                make_ready(slot, next);
+            }
+        }
+        if (nodes_left.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            wake_parked();
+        }
+    };
+    make_ready = [&](uint32_t slot, TaskGraph::NodeId id) {
+        const size_t tasks = graph.nodes_[id].num_tasks;
+        if (tasks == 0) {
+            finish_node(slot, id);
+            return;
+        }
+        const size_t step = (tasks + items_per_node - 1) / items_per_node;
+        {
+            std::lock_guard<std::mutex> lock(queues[slot].mutex);
+            for (size_t begin = 0; begin < tasks; begin += step) {
+                queues[slot].items.push_back(GraphItem{id, begin, std::min(tasks, begin + step)});
+            }
+        }
+        wake_parked();
+    };
+    auto take = [&](uint32_t slot, GraphItem& item) {
+        {
+            std::lock_guard<std::mutex> lock(queues[slot].mutex);
+            if (!queues[slot].items.empty()) {
+                item = queues[slot].items.back();
+                queues[slot].items.pop_back();
+                return true;
+            }
+        }
+        for (uint32_t i = 1; i < num_threads_; ++i) {
+            GraphQueue& victim = queues[(slot + i) % num_threads_];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.items.empty()) {
+                item = victim.items.front();
+                victim.items.pop_front();
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Roots are spread round-robin so independent chains start in parallel.
+    uint32_t next_slot = 0;
+    for (size_t i = 0; i < num_nodes; ++i) {
+        if (graph.nodes_[i].num_predecessors == 0) {
+            make_ready(next_slot, i);
+            next_slot = (next_slot + 1) % num_threads_;
+        }
+    }
+    failed_.store(false, std::memory_order_relaxed);
+    const auto work = [&](uint32_t slot) {
+        while (nodes_left.load(std::memory_order_acquire) > 0) {
+            // Read before take(), so work pushed after a failed take changes it.
+            const uint64_t epoch = ready_epoch.load();
+            GraphItem item;
+            if (!take(slot, item)) {
+                // A node still running may release more work.
+                const auto changed = [&] {
+                    return ready_epoch.load() != epoch || nodes_left.load(std::memory_order_acquire) == 0;
+                };
+                if (!spin_until(spin_us_, changed)) {
+                    std::unique_lock<std::mutex> lock(park_mutex);
+                    parked.fetch_add(1);
+                    park_cv.wait(lock, changed);
+                    parked.fetch_sub(1);
+                }
+                continue;
+            }
+            const TaskGraph::Node& node = graph.nodes_[item.node];
+            for (size_t task = item.begin; task < item.end && !failed_.load(std::memory_order_relaxed); ++task) {
+                try {
+                    node.fn(task);
+                } catch (...) {
+                    record_error();
+                }
+            }
+            const size_t count = item.end - item.begin;
+            if (unfinished[item.node].fetch_sub(count, std::memory_order_acq_rel) == count) {
+                finish_node(slot, item.node);
+            }
+        }
+    };
+    dispatch(work);
+
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+}
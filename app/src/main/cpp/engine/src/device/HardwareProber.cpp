@@ -1,16 +1,167 @@
 #include "t760_engine/device/HardwareProber.h"
 #include "t760_engine/core/Constants.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_ASIMD
+#define HWCAP_ASIMD (1 << 1)
+#endif
+#ifndef HWCAP_FPHP
+#define HWCAP_FPHP (1 << 9)
+#endif
+#ifndef HWCAP_ASIMDHP
+#define HWCAP_ASIMDHP (1 << 10)
+#endif
+#ifndef HWCAP_ASIMDDP
+#define HWCAP_ASIMDDP (1 << 20)
+#endif
+#ifndef HWCAP2_I8MM
+#define HWCAP2_I8MM (1 << 13)
+#endif
+#ifndef HWCAP2_BF16
+#define HWCAP2_BF16 (1 << 14)
+#endif
+#endif
+
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__GNUC__)
+#include <cpuid.h>
+#endif
 
 namespace t760 {
 
+namespace {
+
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__GNUC__)
+// XCR0: which register states the OS saves on context switch.
+uint64_t read_xcr0() {
+    uint32_t lo = 0, hi = 0;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+#endif
+
+void probe_cpu_features(CpuCapabilities& cpu) {
+#if defined(__aarch64__) && defined(__linux__)
+    const unsigned long hwcap = getauxval(AT_HWCAP);
+    const unsigned long hwcap2 = getauxval(AT_HWCAP2);
+    cpu.has_neon_support = (hwcap & HWCAP_ASIMD) != 0;
+    cpu.has_fp16_arithmetic = (hwcap & HWCAP_FPHP) && (hwcap & HWCAP_ASIMDHP);
+    cpu.has_dotprod = (hwcap & HWCAP_ASIMDDP) != 0;
+    cpu.has_i8mm = (hwcap2 & HWCAP2_I8MM) != 0;
+    cpu.has_bf16 = (hwcap2 & HWCAP2_BF16) != 0;
+#elif defined(__aarch64__)
+    cpu.has_neon_support = true; // Advanced SIMD is mandatory on AArch64.
+#elif (defined(__x86_64__) || defined(_M_X64)) && defined(__GNUC__)
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return;
+    }
+    cpu.has_sse41 = (ecx & bit_SSE4_1) != 0;
+    const bool has_osxsave = (ecx & bit_OSXSAVE) != 0;
+    const bool has_avx = (ecx & bit_AVX) != 0;
+    const uint64_t xcr0 = has_osxsave ? read_xcr0() : 0;
+    const bool os_ymm = (xcr0 & 0x6) == 0x6;
+    const bool os_zmm = (xcr0 & 0xE6) == 0xE6;
+    cpu.has_fma = os_ymm && has_avx && (ecx & bit_FMA);
+    cpu.has_f16c = os_ymm && has_avx && (ecx & bit_F16C);
+
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        cpu.has_avx2 = os_ymm && has_avx && (ebx & bit_AVX2);
+        cpu.has_avx512 = os_zmm && (ebx & bit_AVX512F) && (ebx & bit_AVX512BW) && (ebx & bit_AVX512VL);
+        cpu.has_avx512_vnni = cpu.has_avx512 && (ecx & bit_AVX512VNNI);
+    }
+    if (__get_cpuid_count(7, 1, &eax, &ebx, &ecx, &edx)) {
+        cpu.has_avx_vnni = cpu.has_avx2 && (eax & (1u << 4));
+        cpu.has_avx512_bf16 = cpu.has_avx512 && (eax & (1u << 5));
+    }
+#endif
+}
+
+// Reads a cache size such as "64K" from sysfs. Returns 0 when unavailable.
+uint32_t read_sysfs_cache_kb(const std::string& index_dir, uint32_t level) {
+    std::ifstream level_file(index_dir + "/level");
+    std::ifstream type_file(index_dir + "/type");
+    std::ifstream size_file(index_dir + "/size");
+    uint32_t cache_level = 0;
+    std::string type;
+    std::string size;
+    if (!(level_file >> cache_level) || !(type_file >> type) || !(size_file >> size)) {
+        return 0;
+    }
+    if (cache_level != level || type == "Instruction") {
+        return 0;
+    }
+    try {
+        const uint32_t value = static_cast<uint32_t>(std::stoul(size));
+        return size.back() == 'M' ? value * 1024 : value;
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+// Probes the last online CPU, which is a Cortex-A76 on the T760 (cores 4-7).
+// Keeps the compile-time defaults when sysfs does not expose the topology.
+void probe_cpu_caches(CpuCapabilities& cpu) {
+    const std::string cpu_dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu.total_cores - 1) + "/cache/index";
+    for (uint32_t index = 0; index < 8; ++index) {
+        const std::string index_dir = cpu_dir + std::to_string(index);
+        if (const uint32_t l1 = read_sysfs_cache_kb(index_dir, 1)) {
+            cpu.l1_cache_kb = l1;
+        }
+        if (const uint32_t l2 = read_sysfs_cache_kb(index_dir, 2)) {
+            cpu.l2_cache_kb = l2;
+        }
+    }
+}
+
+std::string describe_cpu_features(const CpuCapabilities& cpu) {
+    std::ostringstream out;
+    auto flag = [&out](bool present, const char* name) {
+        if (present) out << ' ' << name;
+    };
+    flag(cpu.has_neon_support, "neon");
+    flag(cpu.has_fp16_arithmetic, "fp16");
+    flag(cpu.has_dotprod, "dotprod");
+    flag(cpu.has_i8mm, "i8mm");
+    flag(cpu.has_bf16, "bf16");
+    flag(cpu.has_sse41, "sse4.1");
+    flag(cpu.has_avx2, "avx2");
+    flag(cpu.has_fma, "fma");
+    flag(cpu.has_f16c, "f16c");
+    flag(cpu.has_avx512, "avx512");
+    flag(cpu.has_avx512_vnni, "avx512-vnni");
+    flag(cpu.has_avx512_bf16, "avx512-bf16");
+    flag(cpu.has_avx_vnni, "avx-vnni");
+    return out.str();
+}
+
+}
+
 SystemHardwareCapabilities HardwareProber::probe() {
     SystemHardwareCapabilities caps;
 
+#if defined(__aarch64__)
     caps.cpu.architecture_name = "ARMv8.2-A (Cortex-A76 + Cortex-A55)";
-    caps.cpu.total_cores = constants::T760_CPU_TOTAL_CORES;
+#elif defined(__x86_64__) || defined(_M_X64)
+    caps.cpu.architecture_name = "x86-64";
+#else
+    caps.cpu.architecture_name = "Unknown";
+#endif
+    const uint32_t online_cores = std::thread::hardware_concurrency();
+    caps.cpu.total_cores = online_cores > 0 ? online_cores : constants::T760_CPU_TOTAL_CORES;
     caps.cpu.performance_cores = constants::T760_CPU_A76_CORES;
     caps.cpu.efficiency_cores = constants::T760_CPU_A55_CORES;
-    caps.cpu.has_neon_support = true;
+    probe_cpu_features(caps.cpu);
+    probe_cpu_caches(caps.cpu);
+    std::cout << "CPU: " << caps.cpu.architecture_name << ", " << caps.cpu.total_cores
+              << " cores, features:" << describe_cpu_features(caps.cpu) << std::endl;
+    std::cout << "CPU caches: L1d " << caps.cpu.l1_cache_kb << " KB, L2 " << caps.cpu.l2_cache_kb << " KB" << std::endl;
 
     caps.gpu.device_name = "Mali-G57 MC4";
     caps.gpu.compute_units = constants::T760_GPU_COMPUTE_UNITS;
@@ -27,4 +178,4 @@ SystemHardwareCapabilities HardwareProber::probe() {
     return caps;
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,726 @@
+#include "t760_engine/grammar/Grammar.h"
+#include <algorithm>
+#include <bitset>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace t760 {
+
+namespace {
+
+using ByteSet = std::bitset<256>;
+
+// Largest bound of a counted repetition; each repeat copies its operand.
+constexpr uint32_t MAX_REPEAT = 1000;
+constexpr uint32_t UNBOUNDED = UINT32_MAX;
+
+struct RegexNode {
+    enum class Kind : uint8_t { EMPTY, BYTES, CONCAT, ALTERNATE, REPEAT };
+    Kind kind = Kind::EMPTY;
+    ByteSet bytes;               // BYTES: any one of these
+    std::vector<size_t> children; // CONCAT, ALTERNATE; REPEAT's operand
+    uint32_t min = 0;            // REPEAT
+    uint32_t max = 0;            // REPEAT; UNBOUNDED for no limit
+};
+
+ByteSet byte_range(unsigned lo, unsigned hi) {
+    ByteSet set;
+    for (unsigned b = lo; b <= hi; ++b) {
+        set.set(b);
+    }
+    return set;
+}
+
+ByteSet class_escape(char c) {
+    switch (c) {
+        case 'd': return byte_range('0', '9');
+        case 'w': return byte_range('0', '9') | byte_range('A', 'Z') | byte_range('a', 'z') | byte_range('_', '_');
+        case 's': return byte_range(' ', ' ') | byte_range('\t', '\r');
+        default: return {};
+    }
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void append_utf8(uint32_t cp, std::string& out) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+// Recursive descent over the pattern into a pool of RegexNodes.
+class RegexParser {
+public:
+    explicit RegexParser(std::string_view pattern) : pattern_(pattern) {}
+
+    // The root node; nodes() holds the pool.
+    size_t parse() {
+        const size_t root = parse_alternation();
+        if (pos_ != pattern_.size()) {
+            fail("unbalanced ')'");
+        }
+        return root;
+    }
+
+    const std::vector<RegexNode>& nodes() const { return nodes_; }
+
+private:
+    // A character of a class or a literal, as its UTF-8 bytes, or a class
+    // escape such as \d, as its ASCII set (bytes empty).
+    struct ClassChar {
+        std::string bytes;
+        ByteSet set;
+        bool negated_set = false; // \D and the like: every character outside set
+    };
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("Regex error at offset " + std::to_string(pos_) + ": " + what + ".");
+    }
+
+    bool at_end() const { return pos_ >= pattern_.size(); }
+    char peek() const { return pattern_[pos_]; }
+
+    size_t add(RegexNode node) {
+        nodes_.push_back(std::move(node));
+        return nodes_.size() - 1;
+    }
+
+    size_t add_bytes(const ByteSet& set) {
+        RegexNode node;
+        node.kind = RegexNode::Kind::BYTES;
+        node.bytes = set;
+        return add(std::move(node));
+    }
+
+    size_t add_sequence(const std::string& bytes) {
+        RegexNode node;
+        node.kind = RegexNode::Kind::CONCAT;
+        for (char b : bytes) {
+            node.children.push_back(add_bytes(byte_range(static_cast<uint8_t>(b), static_cast<uint8_t>(b))));
+        }
+        return add(std::move(node));
+    }
+
+    // Any UTF-8 character of two to four bytes.
+    size_t add_any_multibyte() {
+        const ByteSet tail = byte_range(0x80, 0xBF);
+        RegexNode any;
+        any.kind = RegexNode::Kind::ALTERNATE;
+        const std::pair<unsigned, unsigned> leads[] = {{0xC2, 0xDF}, {0xE0, 0xEF}, {0xF0, 0xF4}};
+        for (size_t extra = 1; extra <= 3; ++extra) {
+            RegexNode seq;
+            seq.kind = RegexNode::Kind::CONCAT;
+            seq.children.push_back(add_bytes(byte_range(leads[extra - 1].first, leads[extra - 1].second)));
+            for (size_t i = 0; i < extra; ++i) {
+                seq.children.push_back(add_bytes(tail));
+            }
+            any.children.push_back(add(std::move(seq)));
+        }
+        return add(std::move(any));
+    }
+
+    size_t parse_alternation() {
+        RegexNode alternate;
+        alternate.kind = RegexNode::Kind::ALTERNATE;
+        alternate.children.push_back(parse_concat());
+        while (!at_end() && peek() == '|') {
+            ++pos_;
+            alternate.children.push_back(parse_concat());
+        }
+        return alternate.children.size() == 1 ? alternate.children[0] : add(std::move(alternate));
+    }
+
+    size_t parse_concat() {
+        RegexNode concat;
+        concat.kind = RegexNode::Kind::CONCAT;
+        while (!at_end() && peek() != '|' && peek() != ')') {
+            concat.children.push_back(parse_repeat());
+        }
+        return concat.children.size() == 1 ? concat.children[0] : add(std::move(concat));
+    }
+
+    uint32_t parse_count() {
+        const size_t start = pos_;
+        uint64_t value = 0;
+        while (!at_end() && peek() >= '0' && peek() <= '9') {
+            value = value * 10 + static_cast<uint64_t>(peek() - '0');
+            if (value > MAX_REPEAT) {
+                fail("repetition bound above " + std::to_string(MAX_REPEAT));
+            }
+            ++pos_;
+        }
+        if (pos_ == start) {
+            fail("expected a repetition count");
+        }
+        return static_cast<uint32_t>(value);
+    }
+
+    size_t parse_repeat() {
+        size_t node = parse_atom();
+        while (!at_end()) {
+            uint32_t min = 0;
+            uint32_t max = 0;
+            const char c = peek();
+            if (c == '*') {
+                min = 0, max = UNBOUNDED;
+                ++pos_;
+            } else if (c == '+') {
+                min = 1, max = UNBOUNDED;
+                ++pos_;
+            } else if (c == '?') {
+                min = 0, max = 1;
+                ++pos_;
+            } else if (c == '{') {
+                ++pos_;
+                min = parse_count();
+                max = min;
+                if (!at_end() && peek() == ',') {
+                    ++pos_;
+                    max = !at_end() && peek() == '}' ? UNBOUNDED : parse_count();
+                }
+                if (at_end() || peek() != '}') {
+                    fail("expected '}'");
+                }
+                ++pos_;
+                if (max < min) {
+                    fail("repetition bounds out of order");
+                }
+            } else {
+                break;
+            }
+            if (!at_end() && peek() == '?') {
+                ++pos_; // Lazy and greedy match the same language
+            }
+            RegexNode repeat;
+            repeat.kind = RegexNode::Kind::REPEAT;
+            repeat.children.push_back(node);
+            repeat.min = min;
+            repeat.max = max;
+            node = add(std::move(repeat));
+        }
+        return node;
+    }
+
+    // The bytes of the UTF-8 character at pos_.
+    std::string take_char() {
+        const auto lead = static_cast<uint8_t>(peek());
+        const size_t length = lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+        if (pos_ + length > pattern_.size()) {
+            fail("truncated UTF-8 character");
+        }
+        std::string bytes(pattern_.substr(pos_, length));
+        pos_ += length;
+        return bytes;
+    }
+
+    // An escape after its backslash.
+    ClassChar parse_escape() {
+        if (at_end()) {
+            fail("trailing backslash");
+        }
+        const char c = pattern_[pos_++];
+        ClassChar result;
+        switch (c) {
+            case 'd': case 'w': case 's':
+                result.set = class_escape(c);
+                return result;
+            case 'D': case 'W': case 'S':
+                result.set = class_escape(static_cast<char>(c - 'A' + 'a'));
+                result.negated_set = true;
+                return result;
+            case 'n': result.bytes = "\n"; return result;
+            case 't': result.bytes = "\t"; return result;
+            case 'r': result.bytes = "\r"; return result;
+            case 'f': result.bytes = "\f"; return result;
+            case 'v': result.bytes = "\v"; return result;
+            case '0': result.bytes = std::string(1, '\0'); return result;
+            case 'x': case 'u': {
+                const size_t digits = c == 'x' ? 2 : 4;
+                uint32_t cp = 0;
+                for (size_t i = 0; i < digits; ++i) {
+                    const int v = at_end() ? -1 : hex_value(pattern_[pos_++]);
+                    if (v < 0) {
+                        fail(std::string("bad \\") + c + " escape");
+                    }
+                    cp = cp << 4 | static_cast<uint32_t>(v);
+                }
+                append_utf8(cp, result.bytes);
+                return result;
+            }
+            default:
+                if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+                    fail(std::string("unsupported escape \\") + c);
+                }
+                result.bytes = std::string(1, c);
+                return result;
+        }
+    }
+
+    // Node for a set of ASCII bytes and multi-byte characters, or for every
+    // character outside them when negated.
+    size_t add_class(ByteSet ascii, const std::vector<std::string>& multibyte, bool negated) {
+        RegexNode alternate;
+        alternate.kind = RegexNode::Kind::ALTERNATE;
+        if (negated) {
+            if (!multibyte.empty()) {
+                fail("negated classes may only hold ASCII characters");
+            }
+            ascii = ~ascii & byte_range(0x00, 0x7F);
+            alternate.children.push_back(add_any_multibyte());
+        } else {
+            for (const std::string& bytes : multibyte) {
+                alternate.children.push_back(add_sequence(bytes));
+            }
+        }
+        if (ascii.any()) {
+            alternate.children.push_back(add_bytes(ascii));
+        }
+        if (alternate.children.empty()) {
+            fail("empty class");
+        }
+        return alternate.children.size() == 1 ? alternate.children[0] : add(std::move(alternate));
+    }
+
+    size_t parse_class() {
+        bool negated = false;
+        if (!at_end() && peek() == '^') {
+            negated = true;
+            ++pos_;
+        }
+        ByteSet ascii;
+        std::vector<std::string> multibyte;
+        bool first = true;
+        while (true) {
+            if (at_end()) {
+                fail("unterminated class");
+            }
+            if (peek() == ']' && !first) {
+                ++pos_;
+                break;
+            }
+            first = false;
+            ClassChar lo;
+            if (peek() == '\\') {
+                ++pos_;
+                lo = parse_escape();
+            } else {
+                lo.bytes = take_char();
+            }
+            if (lo.bytes.empty()) {
+                ascii |= lo.negated_set ? ~lo.set & byte_range(0x00, 0x7F) : lo.set;
+                continue;
+            }
+            if (pos_ + 1 < pattern_.size() && peek() == '-' && pattern_[pos_ + 1] != ']') {
+                ++pos_;
+                ClassChar hi;
+                if (peek() == '\\') {
+                    ++pos_;
+                    hi = parse_escape();
+                } else {
+                    hi.bytes = take_char();
+                }
+                if (lo.bytes.size() != 1 || hi.bytes.size() != 1 || static_cast<uint8_t>(lo.bytes[0]) >= 0x80 ||
+                    static_cast<uint8_t>(hi.bytes[0]) >= 0x80) {
+                    fail("class ranges must be ASCII");
+                }
+                const auto a = static_cast<uint8_t>(lo.bytes[0]);
+                const auto b = static_cast<uint8_t>(hi.bytes[0]);
+                if (b < a) {
+                    fail("class range out of order");
+                }
+                ascii |= byte_range(a, b);
+                continue;
+            }
+            if (lo.bytes.size() == 1 && static_cast<uint8_t>(lo.bytes[0]) < 0x80) {
+                ascii.set(static_cast<uint8_t>(lo.bytes[0]));
+            } else {
+                multibyte.push_back(lo.bytes);
+            }
+        }
+        return add_class(ascii, multibyte, negated);
+    }
+
+    size_t parse_atom() {
+        const char c = peek();
+        switch (c) {
+            case '(': {
+                ++pos_;
+                if (pattern_.substr(pos_, 2) == "?:") {
+                    pos_ += 2;
+                } else if (!at_end() && peek() == '?') {
+                    fail("unsupported group");
+                }
+                const size_t inner = parse_alternation();
+                if (at_end() || peek() != ')') {
+                    fail("expected ')'");
+                }
+                ++pos_;
+                return inner;
+            }
+            case '[':
+                ++pos_;
+                return parse_class();
+            case '.':
+                ++pos_;
+                return add_class(byte_range('\n', '\n'), {}, true);
+            case '^':
+            case '$':
+                ++pos_;
+                return add(RegexNode{});
+            case '*':
+            case '+':
+            case '?':
+            case '{':
+                fail(std::string("nothing to repeat before '") + c + "'");
+            case '\\': {
+                ++pos_;
+                const ClassChar escaped = parse_escape();
+                if (escaped.bytes.empty()) {
+                    return add_class(escaped.set, {}, escaped.negated_set);
+                }
+                return add_sequence(escaped.bytes);
+            }
+            default:
+                return add_sequence(take_char());
+        }
+    }
+
+    std::string_view pattern_;
+    size_t pos_ = 0;
+    std::vector<RegexNode> nodes_;
+};
+
+// Thompson NFA: a state either consumes a byte of its set into next, or
+// moves on epsilon edges.
+struct NfaState {
+    ByteSet bytes;
+    int32_t next = -1;
+    std::vector<int32_t> epsilon;
+};
+
+class NfaBuilder {
+public:
+    explicit NfaBuilder(const std::vector<RegexNode>& nodes) : nodes_(nodes) {}
+
+    // Start and accepting state of the fragment for node.
+    std::pair<int32_t, int32_t> build(size_t node) {
+        const RegexNode& n = nodes_[node];
+        switch (n.kind) {
+            case RegexNode::Kind::EMPTY: {
+                const int32_t s = add();
+                return {s, s};
+            }
+            case RegexNode::Kind::BYTES: {
+                const int32_t s = add();
+                const int32_t e = add();
+                states_[s].bytes = n.bytes;
+                states_[s].next = e;
+                return {s, e};
+            }
+            case RegexNode::Kind::CONCAT: {
+                const int32_t s = add();
+                int32_t end = s;
+                for (size_t child : n.children) {
+                    const auto fragment = build(child);
+                    states_[end].epsilon.push_back(fragment.first);
+                    end = fragment.second;
+                }
+                return {s, end};
+            }
+            case RegexNode::Kind::ALTERNATE: {
+                const int32_t s = add();
+                const int32_t e = add();
+                for (size_t child : n.children) {
+                    const auto fragment = build(child);
+                    states_[s].epsilon.push_back(fragment.first);
+                    states_[fragment.second].epsilon.push_back(e);
+                }
+                return {s, e};
+            }
+            case RegexNode::Kind::REPEAT: {
+                const int32_t s = add();
+                int32_t end = s;
+                for (uint32_t i = 0; i < n.min; ++i) {
+                    const auto fragment = build(n.children[0]);
+                    states_[end].epsilon.push_back(fragment.first);
+                    end = fragment.second;
+                }
+                if (n.max == UNBOUNDED) {
+                    const int32_t loop = add();
+                    states_[end].epsilon.push_back(loop);
+                    const auto fragment = build(n.children[0]);
+                    states_[loop].epsilon.push_back(fragment.first);
+                    states_[fragment.second].epsilon.push_back(loop);
+                    return {s, loop};
+                }
+                for (uint32_t i = n.min; i < n.max; ++i) {
+                    const auto fragment = build(n.children[0]);
+                    const int32_t next = add();
+                    states_[end].epsilon.push_back(fragment.first);
+                    states_[end].epsilon.push_back(next);
+                    states_[fragment.second].epsilon.push_back(next);
+                    end = next;
+                }
+                return {s, end};
+            }
+        }
+        return {add(), add()};
+    }
+
+    std::vector<NfaState>& states() { return states_; }
+
+private:
+    int32_t add() {
+        if (states_.size() >= Grammar::MAX_STATES * 16) {
+            throw std::runtime_error("Grammar is too large.");
+        }
+        states_.emplace_back();
+        return static_cast<int32_t>(states_.size() - 1);
+    }
+
+    const std::vector<RegexNode>& nodes_;
+    std::vector<NfaState> states_;
+};
+
+void epsilon_closure(const std::vector<NfaState>& nfa, std::vector<int32_t>& set, std::vector<uint8_t>& seen) {
+    std::vector<int32_t> stack(set.begin(), set.end());
+    for (int32_t s : set) {
+        seen[static_cast<size_t>(s)] = 1;
+    }
+    while (!stack.empty()) {
+        const int32_t s = stack.back();
+        stack.pop_back();
+        for (int32_t t : nfa[static_cast<size_t>(s)].epsilon) {
+            if (!seen[static_cast<size_t>(t)]) {
+                seen[static_cast<size_t>(t)] = 1;
+                set.push_back(t);
+                stack.push_back(t);
+            }
+        }
+    }
+    for (int32_t s : set) {
+        seen[static_cast<size_t>(s)] = 0;
+    }
+    std::sort(set.begin(), set.end());
+}
+
+// Bytes no NFA edge tells apart share a class, so the subset construction
+// and minimization step once per class rather than per byte.
+std::vector<uint8_t> byte_classes(const std::vector<NfaState>& nfa, uint32_t& class_count) {
+    std::vector<uint32_t> classes(256, 0);
+    class_count = 1;
+    std::vector<ByteSet> seen;
+    for (const NfaState& state : nfa) {
+        if (state.next < 0 || std::find(seen.begin(), seen.end(), state.bytes) != seen.end()) {
+            continue;
+        }
+        seen.push_back(state.bytes);
+        std::map<std::pair<uint32_t, bool>, uint32_t> split;
+        for (size_t b = 0; b < 256; ++b) {
+            const auto key = std::make_pair(classes[b], static_cast<bool>(state.bytes[b]));
+            const auto it = split.emplace(key, static_cast<uint32_t>(split.size())).first;
+            classes[b] = it->second;
+        }
+        class_count = static_cast<uint32_t>(split.size());
+    }
+    return std::vector<uint8_t>(classes.begin(), classes.end());
+}
+
+} // namespace
+
+Grammar::Grammar(std::string_view source, GrammarSyntax syntax) {
+    std::string pattern;
+    if (syntax == GrammarSyntax::JSON_SCHEMA) {
+        pattern = json_schema_to_regex(source);
+        source = pattern;
+    }
+    RegexParser parser(source);
+    const size_t root = parser.parse();
+    NfaBuilder builder(parser.nodes());
+    const auto [nfa_start, nfa_accept] = builder.build(root);
+    const std::vector<NfaState>& nfa = builder.states();
+
+    uint32_t class_count = 0;
+    const std::vector<uint8_t> classes = byte_classes(nfa, class_count);
+    std::vector<uint8_t> representative(class_count);
+    for (size_t b = 256; b-- > 0;) {
+        representative[classes[b]] = static_cast<uint8_t>(b);
+    }
+
+    // Subset construction over byte classes.
+    std::vector<uint8_t> seen(nfa.size(), 0);
+    std::map<std::vector<int32_t>, int32_t> ids;
+    std::vector<std::vector<int32_t>> sets;
+    std::vector<int32_t> moves; // [dfa state, class]
+    std::vector<int32_t> start{nfa_start};
+    epsilon_closure(nfa, start, seen);
+    ids.emplace(start, 0);
+    sets.push_back(std::move(start));
+    for (size_t d = 0; d < sets.size(); ++d) {
+        for (uint32_t c = 0; c < class_count; ++c) {
+            const uint8_t byte = representative[c];
+            std::vector<int32_t> target;
+            for (int32_t s : sets[d]) {
+                const NfaState& state = nfa[static_cast<size_t>(s)];
+                if (state.next >= 0 && state.bytes[byte]) {
+                    target.push_back(state.next);
+                }
+            }
+            if (target.empty()) {
+                moves.push_back(-1);
+                continue;
+            }
+            std::sort(target.begin(), target.end());
+            target.erase(std::unique(target.begin(), target.end()), target.end());
+            epsilon_closure(nfa, target, seen);
+            auto it = ids.find(target);
+            if (it == ids.end()) {
+                if (sets.size() >= MAX_STATES) {
+                    throw std::runtime_error("Grammar needs more than " + std::to_string(MAX_STATES) + " states.");
+                }
+                it = ids.emplace(target, static_cast<int32_t>(sets.size())).first;
+                sets.push_back(target);
+            }
+            moves.push_back(it->second);
+        }
+    }
+    const size_t dfa_count = sets.size();
+    std::vector<uint8_t> accepting(dfa_count);
+    for (size_t d = 0; d < dfa_count; ++d) {
+        accepting[d] = std::binary_search(sets[d].begin(), sets[d].end(), nfa_accept) ? 1 : 0;
+    }
+
+    // Live states reach an accepting one; transitions into the rest are
+    // dropped, so every remaining state has a completion.
+    std::vector<std::vector<int32_t>> reverse(dfa_count);
+    for (size_t d = 0; d < dfa_count; ++d) {
+        for (uint32_t c = 0; c < class_count; ++c) {
+            const int32_t t = moves[d * class_count + c];
+            if (t >= 0) {
+                reverse[static_cast<size_t>(t)].push_back(static_cast<int32_t>(d));
+            }
+        }
+    }
+    std::vector<uint8_t> live(accepting);
+    std::vector<int32_t> stack;
+    for (size_t d = 0; d < dfa_count; ++d) {
+        if (live[d]) {
+            stack.push_back(static_cast<int32_t>(d));
+        }
+    }
+    while (!stack.empty()) {
+        const int32_t d = stack.back();
+        stack.pop_back();
+        for (int32_t p : reverse[static_cast<size_t>(d)]) {
+            if (!live[static_cast<size_t>(p)]) {
+                live[static_cast<size_t>(p)] = 1;
+                stack.push_back(p);
+            }
+        }
+    }
+    if (!live[0]) {
+        throw std::runtime_error("Grammar matches nothing.");
+    }
+    for (int32_t& t : moves) {
+        if (t >= 0 && !live[static_cast<size_t>(t)]) {
+            t = -1;
+        }
+    }
+
+    // Moore refinement: states stay together while they agree on accepting
+    // and on the block each byte class leads to.
+    std::vector<int32_t> block(dfa_count, -1);
+    size_t block_count = 0;
+    {
+        int32_t blocks_of[2] = {-1, -1};
+        for (size_t d = 0; d < dfa_count; ++d) {
+            if (!live[d]) {
+                continue;
+            }
+            int32_t& b = blocks_of[accepting[d]];
+            if (b < 0) {
+                b = static_cast<int32_t>(block_count++);
+            }
+            block[d] = b;
+        }
+    }
+    while (true) {
+        std::map<std::vector<int32_t>, int32_t> signatures;
+        std::vector<int32_t> next_block(dfa_count, -1);
+        std::vector<int32_t> signature(class_count + 1);
+        for (size_t d = 0; d < dfa_count; ++d) {
+            if (!live[d]) {
+                continue;
+            }
+            signature[0] = block[d];
+            for (uint32_t c = 0; c < class_count; ++c) {
+                const int32_t t = moves[d * class_count + c];
+                signature[c + 1] = t >= 0 ? block[static_cast<size_t>(t)] : -1;
+            }
+            next_block[d] = signatures.emplace(signature, static_cast<int32_t>(signatures.size())).first->second;
+        }
+        const bool stable = signatures.size() == block_count;
+        block.swap(next_block);
+        block_count = signatures.size();
+        if (stable) {
+            break;
+        }
+    }
+
+    // Number the blocks from the start state's, in discovery order.
+    std::vector<int32_t> number(block_count, -1);
+    std::vector<int32_t> order{0};
+    number[static_cast<size_t>(block[0])] = 0;
+    std::vector<int32_t> member(block_count, -1);
+    for (size_t d = 0; d < dfa_count; ++d) {
+        if (live[d] && member[static_cast<size_t>(block[d])] < 0) {
+            member[static_cast<size_t>(block[d])] = static_cast<int32_t>(d);
+        }
+    }
+    member[static_cast<size_t>(block[0])] = 0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        const auto d = static_cast<size_t>(order[i]);
+        for (uint32_t c = 0; c < class_count; ++c) {
+            const int32_t t = moves[d * class_count + c];
+            if (t < 0) {
+                continue;
+            }
+            const auto b = static_cast<size_t>(block[static_cast<size_t>(t)]);
+            if (number[b] < 0) {
+                number[b] = static_cast<int32_t>(order.size());
+                order.push_back(member[b]);
+            }
+        }
+    }
+
+    transitions_.assign(order.size() * 256, -1);
+    accepting_.resize(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        const auto d = static_cast<size_t>(order[i]);
+        accepting_[i] = accepting[d];
+        for (size_t b = 0; b < 256; ++b) {
+            const int32_t t = moves[d * class_count + classes[b]];
+            transitions_[i * 256 + b] = t >= 0 ? number[static_cast<size_t>(block[static_cast<size_t>(t)])] : -1;
+        }
+    }
+}
+
+}
@@ -0,0 +1,426 @@
+#include "t760_engine/grammar/Grammar.h"
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+
+namespace t760 {
+
+namespace {
+
+// Nesting past this is rejected rather than expanded into the regex.
+constexpr size_t MAX_SCHEMA_DEPTH = 16;
+
+// A JSON character of a string: anything but '"', '\' and control
+// characters, or an escape.
+constexpr const char* JSON_STRING_CHAR = R"(([^"\\\x00-\x1F]|\\(["\\/bfnrt]|u[0-9a-fA-F]{4})))";
+constexpr const char* JSON_INTEGER = R"(-?(0|[1-9][0-9]*))";
+constexpr const char* JSON_NUMBER = R"(-?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+\-]?[0-9]+)?)";
+// What the output may put after ':' and ','.
+constexpr const char* JSON_SPACE = "[ ]?";
+
+struct JsonValue {
+    enum class Type : uint8_t { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+    Type type = Type::NUL;
+    bool boolean = false;
+    std::string text; // STRING: the decoded value; NUMBER: as written
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members; // In document order
+
+    const JsonValue* find(std::string_view key) const {
+        for (const auto& member : members) {
+            if (member.first == key) {
+                return &member.second;
+            }
+        }
+        return nullptr;
+    }
+};
+
+class JsonReader {
+public:
+    explicit JsonReader(std::string_view text) : text_(text) {}
+
+    JsonValue read() {
+        JsonValue value = read_value(0);
+        skip_space();
+        if (pos_ != text_.size()) {
+            fail("trailing characters");
+        }
+        return value;
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("JSON schema error at offset " + std::to_string(pos_) + ": " + what + ".");
+    }
+
+    void skip_space() {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' ||
+                                       text_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+
+    bool consume(char c) {
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) {
+            fail(std::string("expected '") + c + "'");
+        }
+    }
+
+    bool consume_word(std::string_view word) {
+        if (text_.substr(pos_, word.size()) == word) {
+            pos_ += word.size();
+            return true;
+        }
+        return false;
+    }
+
+    std::string read_string() {
+        expect('"');
+        std::string out;
+        while (true) {
+            if (pos_ >= text_.size()) {
+                fail("unterminated string");
+            }
+            const char c = text_[pos_++];
+            if (c == '"') {
+                return out;
+            }
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (pos_ >= text_.size()) {
+                fail("unterminated escape");
+            }
+            const char e = text_[pos_++];
+            switch (e) {
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'u': {
+                    uint32_t cp = 0;
+                    for (int i = 0; i < 4; ++i) {
+                        const char h = pos_ < text_.size() ? text_[pos_++] : '\0';
+                        const int digit = h >= '0' && h <= '9'   ? h - '0'
+                                          : h >= 'a' && h <= 'f' ? h - 'a' + 10
+                                          : h >= 'A' && h <= 'F' ? h - 'A' + 10
+                                                                 : -1;
+                        if (digit < 0) {
+                            fail("bad \\u escape");
+                        }
+                        cp = cp << 4 | static_cast<uint32_t>(digit);
+                    }
+                    // Surrogates are not paired up: schemas spell such
+                    // characters directly in practice.
+                    if (cp < 0x80) {
+                        out.push_back(static_cast<char>(cp));
+                    } else if (cp < 0x800) {
+                        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    } else {
+                        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    }
+                    break;
+                }
+                default: out.push_back(e); break;
+            }
+        }
+    }
+
+    JsonValue read_value(size_t depth) {
+        if (depth > MAX_SCHEMA_DEPTH * 4) {
+            fail("nested too deeply");
+        }
+        skip_space();
+        if (pos_ >= text_.size()) {
+            fail("unexpected end");
+        }
+        JsonValue value;
+        const char c = text_[pos_];
+        if (c == '{') {
+            ++pos_;
+            value.type = JsonValue::Type::OBJECT;
+            if (consume('}')) {
+                return value;
+            }
+            do {
+                skip_space();
+                std::string key = read_string();
+                expect(':');
+                value.members.emplace_back(std::move(key), read_value(depth + 1));
+            } while (consume(','));
+            expect('}');
+        } else if (c == '[') {
+            ++pos_;
+            value.type = JsonValue::Type::ARRAY;
+            if (consume(']')) {
+                return value;
+            }
+            do {
+                value.items.push_back(read_value(depth + 1));
+            } while (consume(','));
+            expect(']');
+        } else if (c == '"') {
+            value.type = JsonValue::Type::STRING;
+            value.text = read_string();
+        } else if (consume_word("true")) {
+            value.type = JsonValue::Type::BOOLEAN;
+            value.boolean = true;
+        } else if (consume_word("false")) {
+            value.type = JsonValue::Type::BOOLEAN;
+        } else if (consume_word("null")) {
+            value.type = JsonValue::Type::NUL;
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            const size_t start = pos_;
+            while (pos_ < text_.size() && std::string_view("+-.eE0123456789").find(text_[pos_]) != std::string_view::npos) {
+                ++pos_;
+            }
+            value.type = JsonValue::Type::NUMBER;
+            value.text = std::string(text_.substr(start, pos_ - start));
+        } else {
+            fail("unexpected character");
+        }
+        return value;
+    }
+
+    std::string_view text_;
+    size_t pos_ = 0;
+};
+
+void append_regex_literal(std::string_view text, std::string& out) {
+    for (char c : text) {
+        if (std::string_view("\\^$.|?*+()[]{}-/").find(c) != std::string_view::npos) {
+            out.push_back('\\');
+        }
+        out.push_back(c);
+    }
+}
+
+// value in compact JSON.
+void write_json(const JsonValue& value, std::string& out) {
+    switch (value.type) {
+        case JsonValue::Type::NUL: out += "null"; return;
+        case JsonValue::Type::BOOLEAN: out += value.boolean ? "true" : "false"; return;
+        case JsonValue::Type::NUMBER: out += value.text; return;
+        case JsonValue::Type::STRING:
+            out.push_back('"');
+            for (char c : value.text) {
+                const auto byte = static_cast<uint8_t>(c);
+                if (c == '"' || c == '\\') {
+                    out.push_back('\\');
+                    out.push_back(c);
+                } else if (byte < 0x20) {
+                    static const char* HEX = "0123456789abcdef";
+                    out += "\\u00";
+                    out.push_back(HEX[byte >> 4]);
+                    out.push_back(HEX[byte & 0xF]);
+                } else {
+                    out.push_back(c);
+                }
+            }
+            out.push_back('"');
+            return;
+        case JsonValue::Type::ARRAY:
+            out.push_back('[');
+            for (size_t i = 0; i < value.items.size(); ++i) {
+                out += i > 0 ? "," : "";
+                write_json(value.items[i], out);
+            }
+            out.push_back(']');
+            return;
+        case JsonValue::Type::OBJECT:
+            out.push_back('{');
+            for (size_t i = 0; i < value.members.size(); ++i) {
+                out += i > 0 ? "," : "";
+                JsonValue key;
+                key.type = JsonValue::Type::STRING;
+                key.text = value.members[i].first;
+                write_json(key, out);
+                out.push_back(':');
+                write_json(value.members[i].second, out);
+            }
+            out.push_back('}');
+            return;
+    }
+}
+
+std::string literal_regex(const JsonValue& value) {
+    std::string json;
+    write_json(value, json);
+    std::string out;
+    append_regex_literal(json, out);
+    return out;
+}
+
+size_t count_of(const JsonValue& schema, std::string_view key, size_t fallback) {
+    const JsonValue* value = schema.find(key);
+    if (!value) {
+        return fallback;
+    }
+    if (value->type != JsonValue::Type::NUMBER || value->text.find_first_of("-.eE") != std::string::npos) {
+        throw std::runtime_error("JSON schema: \"" + std::string(key) + "\" must be a non-negative integer.");
+    }
+    return static_cast<size_t>(std::strtoull(value->text.c_str(), nullptr, 10));
+}
+
+// "{lo,hi}" with hi absent when unbounded; lo and hi bounded like the regex.
+std::string repeat_bounds(size_t lo, size_t hi) {
+    const size_t limit = 1000;
+    if (lo > limit || (hi != SIZE_MAX && hi > limit)) {
+        throw std::runtime_error("JSON schema: length bounds above 1000 are not supported.");
+    }
+    return "{" + std::to_string(lo) + "," + (hi == SIZE_MAX ? "" : std::to_string(hi)) + "}";
+}
+
+std::string schema_regex(const JsonValue& schema, size_t depth);
+
+std::string alternatives(const std::vector<JsonValue>& schemas, size_t depth) {
+    std::string out = "(";
+    for (size_t i = 0; i < schemas.size(); ++i) {
+        out += i > 0 ? "|" : "";
+        out += schema_regex(schemas[i], depth + 1);
+    }
+    return out + ")";
+}
+
+std::string string_regex(const JsonValue& schema) {
+    if (const JsonValue* pattern = schema.find("pattern")) {
+        if (pattern->type != JsonValue::Type::STRING) {
+            throw std::runtime_error("JSON schema: \"pattern\" must be a string.");
+        }
+        return "\"(" + pattern->text + ")\"";
+    }
+    const size_t min = count_of(schema, "minLength", 0);
+    const size_t max = count_of(schema, "maxLength", SIZE_MAX);
+    if (min == 0 && max == SIZE_MAX) {
+        return std::string("\"") + JSON_STRING_CHAR + "*\"";
+    }
+    return std::string("\"") + JSON_STRING_CHAR + repeat_bounds(min, max) + "\"";
+}
+
+std::string array_regex(const JsonValue& schema, size_t depth) {
+    const JsonValue* items = schema.find("items");
+    if (!items) {
+        throw std::runtime_error("JSON schema: arrays need \"items\".");
+    }
+    const std::string item = schema_regex(*items, depth + 1);
+    const size_t min = count_of(schema, "minItems", 0);
+    const size_t max = count_of(schema, "maxItems", SIZE_MAX);
+    if (max < min) {
+        throw std::runtime_error("JSON schema: maxItems is below minItems.");
+    }
+    if (max == 0) {
+        return R"(\[\])";
+    }
+    const std::string more = std::string("(,") + JSON_SPACE + item + ")";
+    const std::string rest =
+        more + repeat_bounds(min > 0 ? min - 1 : 0, max == SIZE_MAX ? SIZE_MAX : max - 1);
+    const std::string list = item + rest;
+    return R"(\[)" + (min == 0 ? "(" + list + ")?" : list) + R"(\])";
+}
+
+std::string object_regex(const JsonValue& schema, size_t depth) {
+    const JsonValue* properties = schema.find("properties");
+    if (!properties || properties->type != JsonValue::Type::OBJECT) {
+        throw std::runtime_error("JSON schema: objects need \"properties\".");
+    }
+    std::vector<std::string> required;
+    if (const JsonValue* list = schema.find("required")) {
+        for (const JsonValue& name : list->items) {
+            required.push_back(name.text);
+        }
+    }
+    const size_t count = properties->members.size();
+    std::vector<std::string> members(count);
+    std::vector<bool> is_required(count);
+    for (size_t i = 0; i < count; ++i) {
+        const auto& [name, property] = properties->members[i];
+        JsonValue key;
+        key.type = JsonValue::Type::STRING;
+        key.text = name;
+        members[i] = literal_regex(key) + ":" + JSON_SPACE + schema_regex(property, depth + 1);
+        is_required[i] = std::find(required.begin(), required.end(), name) != required.end();
+    }
+    // after[i]: the members from i on, once one has been written, each
+    // after a comma. first[i]: the same when none has been written yet, so
+    // the first one written has no comma.
+    std::vector<std::string> after(count + 1);
+    std::vector<std::string> first(count + 1);
+    for (size_t i = count; i-- > 0;) {
+        const std::string with_comma = std::string(",") + JSON_SPACE + members[i];
+        after[i] = is_required[i] ? with_comma + after[i + 1] : "(" + with_comma + ")?" + after[i + 1];
+        first[i] = is_required[i] ? members[i] + after[i + 1]
+                                  : "(" + members[i] + after[i + 1] + (first[i + 1].empty() ? ")?" : "|" + first[i + 1] + ")");
+    }
+    return R"(\{)" + first[0] + R"(\})";
+}
+
+std::string schema_regex(const JsonValue& schema, size_t depth) {
+    if (depth > MAX_SCHEMA_DEPTH) {
+        throw std::runtime_error("JSON schema nests more than " + std::to_string(MAX_SCHEMA_DEPTH) + " levels.");
+    }
+    if (schema.type != JsonValue::Type::OBJECT) {
+        throw std::runtime_error("JSON schema: a schema must be an object.");
+    }
+    if (const JsonValue* value = schema.find("const")) {
+        return literal_regex(*value);
+    }
+    if (const JsonValue* values = schema.find("enum")) {
+        std::string out = "(";
+        for (size_t i = 0; i < values->items.size(); ++i) {
+            out += (i > 0 ? "|" : "") + literal_regex(values->items[i]);
+        }
+        return out + ")";
+    }
+    for (const char* key : {"anyOf", "oneOf"}) {
+        if (const JsonValue* options = schema.find(key)) {
+            return alternatives(options->items, depth);
+        }
+    }
+    const JsonValue* type = schema.find("type");
+    if (type && type->type == JsonValue::Type::ARRAY) {
+        std::vector<JsonValue> variants;
+        for (const JsonValue& name : type->items) {
+            JsonValue variant = schema;
+            *std::find_if(variant.members.begin(), variant.members.end(),
+                          [](const auto& member) { return member.first == "type"; }) = {"type", name};
+            variants.push_back(std::move(variant));
+        }
+        return alternatives(variants, depth);
+    }
+    const std::string name = type ? type->text : (schema.find("properties") ? "object" : "");
+    if (name == "string") return string_regex(schema);
+    if (name == "integer") return JSON_INTEGER;
+    if (name == "number") return JSON_NUMBER;
+    if (name == "boolean") return "(true|false)";
+    if (name == "null") return "null";
+    if (name == "array") return array_regex(schema, depth);
+    if (name == "object") return object_regex(schema, depth);
+    throw std::runtime_error(name.empty() ? "JSON schema: a schema needs a \"type\"."
+                                          : "JSON schema: unsupported type \"" + name + "\".");
+}
+
+} // namespace
+
+std::string json_schema_to_regex(std::string_view schema) {
+    const JsonValue root = JsonReader(schema).read();
+    // Leading and trailing space as a model tends to write it.
+    return std::string(JSON_SPACE) + schema_regex(root, 0) + "[ \\n]?";
+}
+
+}
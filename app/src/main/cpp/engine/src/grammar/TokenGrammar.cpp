@@ -0,0 +1,169 @@
+#include "t760_engine/grammar/TokenGrammar.h"
+#include "t760_engine/tokenizer/Tokenizer.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace t760 {
+
+TokenGrammar::TokenGrammar(std::shared_ptr<const Grammar> grammar, std::shared_ptr<const Tokenizer> tokenizer)
+    : grammar_(std::move(grammar)), tokenizer_(std::move(tokenizer)) {
+    if (!grammar_ || !tokenizer_) {
+        throw std::runtime_error("TokenGrammar needs a grammar and a tokenizer.");
+    }
+    vocab_size_ = tokenizer_->vocab_size();
+    offsets_.reserve(vocab_size_ + 1);
+    offsets_.push_back(0);
+    for (size_t t = 0; t < vocab_size_; ++t) {
+        tokenizer_->append_token_text(static_cast<int32_t>(t), text_);
+        offsets_.push_back(static_cast<uint32_t>(text_.size()));
+    }
+    const auto text_of = [&](int32_t t) {
+        return std::string_view(text_).substr(offsets_[t], offsets_[t + 1] - offsets_[t]);
+    };
+    for (size_t t = 0; t < vocab_size_; ++t) {
+        if (offsets_[t + 1] > offsets_[t]) {
+            sorted_.push_back(static_cast<int32_t>(t));
+        }
+    }
+    std::sort(sorted_.begin(), sorted_.end(), [&](int32_t a, int32_t b) { return text_of(a) < text_of(b); });
+    shared_.resize(sorted_.size());
+    for (size_t i = 1; i < sorted_.size(); ++i) {
+        const std::string_view a = text_of(sorted_[i - 1]);
+        const std::string_view b = text_of(sorted_[i]);
+        const size_t limit = std::min(a.size(), b.size());
+        uint32_t common = 0;
+        while (common < limit && a[common] == b[common]) {
+            ++common;
+        }
+        shared_[i] = common;
+    }
+    masks_.resize(grammar_->state_count());
+    built_.assign(grammar_->state_count(), 0);
+    continues_.assign(grammar_->state_count(), 0);
+}
+
+int32_t TokenGrammar::next_state(int32_t state, int32_t token) const {
+    if (token < 0 || static_cast<size_t>(token) >= vocab_size_ || offsets_[token + 1] == offsets_[token]) {
+        return -1;
+    }
+    for (uint32_t i = offsets_[token]; i < offsets_[token + 1] && state >= 0; ++i) {
+        state = grammar_->next_state(state, static_cast<uint8_t>(text_[i]));
+    }
+    return state;
+}
+
+TokenMask TokenGrammar::allowed(int32_t state) const {
+    return TokenMask{mask_for(state).data(), static_cast<int64_t>(vocab_size_)};
+}
+
+bool TokenGrammar::can_continue(int32_t state) const {
+    mask_for(state);
+    std::lock_guard<std::mutex> lock(mutex_);
+    return continues_[static_cast<size_t>(state)] != 0;
+}
+
+void TokenGrammar::precompute() const {
+    for (size_t s = 0; s < grammar_->state_count(); ++s) {
+        mask_for(static_cast<int32_t>(s));
+    }
+}
+
+const std::vector<uint64_t>& TokenGrammar::mask_for(int32_t state) const {
+    if (state < 0 || static_cast<size_t>(state) >= grammar_->state_count()) {
+        throw std::runtime_error("Grammar state " + std::to_string(state) + " is out of range.");
+    }
+    const auto s = static_cast<size_t>(state);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (built_[s]) {
+            return masks_[s];
+        }
+    }
+    // Built outside the lock; a racing build of the same state is discarded.
+    std::vector<uint64_t> mask = build_mask(state);
+    const bool any = std::any_of(mask.begin(), mask.end(), [](uint64_t word) { return word != 0; });
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!built_[s]) {
+        masks_[s] = std::move(mask);
+        continues_[s] = any ? 1 : 0;
+        built_[s] = 1;
+    }
+    return masks_[s];
+}
+
+std::vector<uint64_t> TokenGrammar::build_mask(int32_t state) const {
+    std::vector<uint64_t> mask((vocab_size_ + 63) / 64, 0);
+    // path[d] is the state after the first d bytes of the previous token;
+    // walked is how many of them were consumed, dead whether the last one
+    // left the language.
+    std::vector<int32_t> path(1, state);
+    size_t walked = 0;
+    bool dead = false;
+    for (size_t i = 0; i < sorted_.size(); ++i) {
+        const int32_t token = sorted_[i];
+        const size_t common = shared_[i];
+        if (dead && common > walked) {
+            continue; // Shares the prefix that left the language
+        }
+        const uint32_t begin = offsets_[token];
+        const uint32_t length = offsets_[token + 1] - begin;
+        if (path.size() < length + 1) {
+            path.resize(length + 1);
+        }
+        size_t d = std::min(common, walked);
+        dead = false;
+        for (; d < length; ++d) {
+            const int32_t next = grammar_->next_state(path[d], static_cast<uint8_t>(text_[begin + d]));
+            if (next < 0) {
+                dead = true;
+                break;
+            }
+            path[d + 1] = next;
+        }
+        walked = d;
+        if (!dead) {
+            mask[static_cast<size_t>(token) >> 6] |= uint64_t{1} << (token & 63);
+        }
+    }
+    return mask;
+}
+
+GrammarCursor::GrammarCursor(std::shared_ptr<const TokenGrammar> grammar, std::vector<int32_t> stop_tokens)
+    : grammar_(std::move(grammar)), stop_tokens_(std::move(stop_tokens)), state_(grammar_->start_state()) {}
+
+TokenMask GrammarCursor::allowed() {
+    const TokenMask mask = grammar_->allowed(state_);
+    if (!grammar_->is_accepting(state_) || stop_tokens_.empty()) {
+        return mask;
+    }
+    if (with_stops_state_ != state_) {
+        with_stops_.assign(mask.words, mask.words + (mask.size + 63) / 64);
+        for (int32_t token : stop_tokens_) {
+            if (token >= 0 && token < mask.size) {
+                with_stops_[static_cast<size_t>(token) >> 6] |= uint64_t{1} << (token & 63);
+            }
+        }
+        with_stops_state_ = state_;
+    }
+    return TokenMask{with_stops_.data(), mask.size};
+}
+
+bool GrammarCursor::advance(int32_t token) {
+    if (std::find(stop_tokens_.begin(), stop_tokens_.end(), token) != stop_tokens_.end()) {
+        return grammar_->is_accepting(state_);
+    }
+    const int32_t next = grammar_->next_state(state_, token);
+    if (next < 0) {
+        return false;
+    }
+    state_ = next;
+    return true;
+}
+
+bool GrammarCursor::is_finished() const {
+    return grammar_->is_accepting(state_) && !grammar_->can_continue(state_);
+}
+
+}
@@ -0,0 +1,463 @@
+#include "t760_engine/kernels/Attention.h"
+#include "t760_engine/kernels/Gemm.h"
+#include "t760_engine/core/ThreadPool.h"
+#include "t760_engine/tensor/Float16.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace t760::kernels {
+
+namespace {
+
+constexpr float NEG_INF = -std::numeric_limits<float>::infinity();
+
+// Queries per prefill task; multiplied by the GQA group size to get rows.
+constexpr int64_t PREFILL_QUERY_BLOCK = 16;
+// Keys per decode task; long contexts are split so every core gets a share.
+constexpr int64_t DECODE_KV_CHUNK = 256;
+// Widest nr of any GEMM kernel set.
+constexpr int64_t MAX_PANEL_WIDTH = 24;
+
+inline int64_t ceil_div(int64_t a, int64_t b) { return (a + b - 1) / b; }
+inline int64_t round_up(int64_t a, int64_t b) { return ceil_div(a, b) * b; }
+
+// Keys per block: the packed K and V panels of a block take a quarter of L2,
+// like the packed b block of the GEMM, and are reused by every row.
+int64_t kv_block_size(const CpuKernelContext& ctx, int64_t head_dim) {
+    const int64_t bytes_per_key = 2 * head_dim * static_cast<int64_t>(sizeof(float));
+    const int64_t keys = static_cast<int64_t>(ctx.l2_cache_kb) * 1024 / 4 / bytes_per_key;
+    return std::clamp<int64_t>(keys / 16 * 16, 16, 256);
+}
+
+// Per-thread panels for one task. Scores and the P * V product run on the
+// dense GEMM micro-kernels, so every buffer is padded to whole mr x nr tiles.
+struct AttentionScratch {
+    std::vector<float> queries; // [rows / mr][head_dim][mr], pre-scaled
+    std::vector<float> keys;    // [block / nr][head_dim][nr]
+    std::vector<float> values;  // [head_dim / nr][block][nr]
+    std::vector<float> scores;  // [rows, block]
+    std::vector<float> probs;   // [rows / mr][block][mr]
+    std::vector<float> acc;     // [rows, head_dim]
+    std::vector<float> max;     // [rows]
+    std::vector<float> sum;     // [rows]
+    std::vector<float> key_rows; // [nr, head_dim], widened FP16 keys
+    std::vector<float> row_buf;  // [head_dim], widened FP16 value
+};
+
+AttentionScratch& scratch() {
+    thread_local AttentionScratch s;
+    return s;
+}
+
+// One task's view of the attention problem: `rows` query rows (queries times
+// GQA group) against one KV head.
+class AttentionTile {
+public:
+    AttentionTile(const AttentionParams& params, const CpuKernelContext& ctx, const KvCacheView& kv, int64_t rows)
+        : params_(params), kv_(kv), ks_(ctx.gemm ? *ctx.gemm : *get_gemm_kernel_set(IsaLevel::SCALAR)),
+          hd_(params.head_dim), rows_(rows), block_(kv_block_size(ctx, params.head_dim)),
+          padded_rows_(round_up(rows, ks_.mr)), padded_hd_(round_up(params.head_dim, ks_.nr)),
+          padded_block_(round_up(block_, ks_.nr)), s_(scratch()) {
+        s_.queries.assign(static_cast<size_t>(padded_rows_ * hd_), 0.0f);
+        s_.keys.resize(static_cast<size_t>(padded_block_ * hd_));
+        s_.values.resize(static_cast<size_t>(padded_hd_ * padded_block_));
+        s_.scores.resize(static_cast<size_t>(padded_rows_ * padded_block_));
+        s_.probs.resize(static_cast<size_t>(padded_rows_ * padded_block_));
+        s_.acc.assign(static_cast<size_t>(padded_rows_ * padded_hd_), 0.0f);
+        s_.max.assign(static_cast<size_t>(rows), NEG_INF);
+        s_.sum.assign(static_cast<size_t>(rows), 0.0f);
+        s_.key_rows.resize(static_cast<size_t>(ks_.nr * hd_));
+        s_.row_buf.resize(static_cast<size_t>(hd_));
+    }
+
+    int64_t block() const { return block_; }
+
+    // Packs query row r at position pos, rotated and pre-multiplied by the
+    // softmax scale.
+    void set_query(int64_t r, const float* q, int64_t pos) {
+        float* panel = s_.queries.data() + (r / ks_.mr) * hd_ * ks_.mr + r % ks_.mr;
+        const float scale = params_.scale;
+        if (!params_.rope) {
+            for (int64_t d = 0; d < hd_; ++d) {
+                panel[d * ks_.mr] = q[d] * scale;
+            }
+            return;
+        }
+        const int64_t half = hd_ / 2;
+        const float* c = params_.rope->cos_row(pos);
+        const float* s = params_.rope->sin_row(pos);
+        for (int64_t i = 0; i < half; ++i) {
+            panel[i * ks_.mr] = (q[i] * c[i] - q[i + half] * s[i]) * scale;
+            panel[(i + half) * ks_.mr] = (q[i + half] * c[i] + q[i] * s[i]) * scale;
+        }
+    }
+
+    // Folds keys [start, start + count) of kv_head into every row; row r sits
+    // at absolute position row_pos(r).
+    template <typename RowPos>
+    void attend(int64_t kv_head, int64_t start, int64_t count, RowPos row_pos) {
+        load(kv_head, start, count);
+        const int64_t mr = ks_.mr;
+        const int64_t nr = ks_.nr;
+        const int64_t cols = round_up(count, nr);
+        const int64_t ld = padded_block_;
+
+        for (int64_t i = 0; i < padded_rows_; i += mr) {
+            for (int64_t j = 0; j < cols; j += nr) {
+                ks_.micro_f32(hd_, s_.queries.data() + i * hd_, s_.keys.data() + j * hd_,
+                              s_.scores.data() + i * ld + j, ld, false);
+            }
+        }
+
+        for (int64_t r = 0; r < rows_; ++r) {
+            float* scores = s_.scores.data() + r * ld;
+            float* probs = s_.probs.data() + (r / mr) * count * mr + r % mr;
+            const int64_t pos = row_pos(r);
+            float block_max = NEG_INF;
+            for (int64_t j = 0; j < count; ++j) {
+                if (!attention_visible(pos, start + j, params_.sliding_window)) {
+                    scores[j] = NEG_INF;
+                }
+                block_max = std::max(block_max, scores[j]);
+            }
+            if (block_max == NEG_INF) {
+                for (int64_t j = 0; j < count; ++j) {
+                    probs[j * mr] = 0.0f; // Every key in this block is masked for this row.
+                }
+                continue;
+            }
+            const float new_max = std::max(s_.max[r], block_max);
+            const float correction = std::exp(s_.max[r] - new_max); // exp(-inf) = 0 on the first block
+            float block_sum = 0.0f;
+            for (int64_t j = 0; j < count; ++j) {
+                const float p = std::exp(scores[j] - new_max); // Masked scores give exp(-inf) = 0
+                probs[j * mr] = p;
+                block_sum += p;
+            }
+            s_.max[r] = new_max;
+            s_.sum[r] = s_.sum[r] * correction + block_sum;
+            if (correction != 1.0f) {
+                float* acc = s_.acc.data() + r * padded_hd_;
+                for (int64_t d = 0; d < hd_; ++d) {
+                    acc[d] *= correction;
+                }
+            }
+        }
+        for (int64_t r = rows_; r < padded_rows_; ++r) {
+            float* probs = s_.probs.data() + (r / mr) * count * mr + r % mr;
+            for (int64_t j = 0; j < count; ++j) {
+                probs[j * mr] = 0.0f;
+            }
+        }
+
+        for (int64_t i = 0; i < padded_rows_; i += mr) {
+            for (int64_t d = 0; d < padded_hd_; d += nr) {
+                ks_.micro_f32(count, s_.probs.data() + i * count, s_.values.data() + d * count,
+                              s_.acc.data() + i * padded_hd_ + d, padded_hd_, true);
+            }
+        }
+    }
+
+    float row_max(int64_t r) const { return s_.max[r]; }
+    float row_sum(int64_t r) const { return s_.sum[r]; }
+    // Unnormalized output of row r.
+    const float* row_acc(int64_t r) const { return s_.acc.data() + r * padded_hd_; }
+
+private:
+    // Packs keys into nr-wide panels over head_dim and values into nr-wide
+    // panels over the keys, zero-padding both to whole panels. Keys are
+    // gathered nr rows at a time so the transpose writes whole panel rows.
+    void load(int64_t kv_head, int64_t start, int64_t count) {
+        const int64_t nr = ks_.nr;
+        for (int64_t j0 = 0; j0 < count; j0 += nr) {
+            const int64_t width = std::min(nr, count - j0);
+            const float* keys[MAX_PANEL_WIDTH];
+            for (int64_t jj = 0; jj < width; ++jj) {
+                const int64_t offset = ((start + j0 + jj) * params_.num_kv_heads + kv_head) * hd_;
+                keys[jj] = row(kv_.keys, offset, s_.key_rows.data() + jj * hd_);
+                pack_value(j0 + jj, count, row(kv_.values, offset, s_.row_buf.data()));
+            }
+            float* panel = s_.keys.data() + j0 * hd_;
+            for (int64_t d = 0; d < hd_; ++d) {
+                for (int64_t jj = 0; jj < width; ++jj) {
+                    panel[d * nr + jj] = keys[jj][d];
+                }
+                for (int64_t jj = width; jj < nr; ++jj) {
+                    panel[d * nr + jj] = 0.0f;
+                }
+            }
+        }
+    }
+
+    void pack_value(int64_t j, int64_t count, const float* value) {
+        const int64_t nr = ks_.nr;
+        for (int64_t d = 0; d < padded_hd_; d += nr) {
+            float* dst = s_.values.data() + d * count + j * nr;
+            const int64_t width = std::min(nr, hd_ - d);
+            std::memcpy(dst, value + d, static_cast<size_t>(width) * sizeof(float));
+            std::fill(dst + width, dst + nr, 0.0f);
+        }
+    }
+
+    const float* row(const void* base, int64_t offset, float* buffer) {
+        if (kv_.data_type == DataType::FP16) {
+            ks_.f16_to_f32(static_cast<const uint16_t*>(base) + offset, buffer, hd_);
+            return buffer;
+        }
+        return static_cast<const float*>(base) + offset;
+    }
+    const AttentionParams& params_;
+    const KvCacheView& kv_;
+    const GemmKernelSet& ks_;
+    const int64_t hd_;
+    const int64_t rows_;
+    const int64_t block_;
+    const int64_t padded_rows_;
+    const int64_t padded_hd_;
+    const int64_t padded_block_;
+    AttentionScratch& s_;
+};
+
+// Keys visible to any of the queries at positions [first, last].
+inline int64_t first_visible_key(int64_t first_query_pos, int64_t sliding_window) {
+    return sliding_window > 0 ? std::max<int64_t>(0, first_query_pos - sliding_window + 1) : 0;
+}
+
+void run_tasks(const CpuKernelContext& ctx, size_t tasks, FunctionRef<void(size_t)> fn) {
+    if (ctx.pool) {
+        ctx.pool->parallel_for(tasks, fn);
+    } else {
+        for (size_t t = 0; t < tasks; ++t) {
+            fn(t);
+        }
+    }
+}
+
+// Many queries: one task per (KV head, query block). All heads of the GQA
+// group share each loaded KV block.
+void attention_prefill(const AttentionParams& params, const CpuKernelContext& ctx, const float* q,
+                       int64_t num_queries, int64_t first_pos, const KvCacheView& kv, float* out) {
+    const int64_t hd = params.head_dim;
+    const int64_t group = params.num_heads / params.num_kv_heads;
+    const int64_t query_blocks = ceil_div(num_queries, PREFILL_QUERY_BLOCK);
+
+    run_tasks(ctx, static_cast<size_t>(params.num_kv_heads * query_blocks), [&](size_t task) {
+        const int64_t kv_head = static_cast<int64_t>(task) / query_blocks;
+        const int64_t q0 = (static_cast<int64_t>(task) % query_blocks) * PREFILL_QUERY_BLOCK;
+        const int64_t queries = std::min(PREFILL_QUERY_BLOCK, num_queries - q0);
+        const int64_t rows = queries * group;
+        auto row_offset = [&](int64_t r) {
+            return ((q0 + r / group) * params.num_heads + kv_head * group + r % group) * hd;
+        };
+
+        AttentionTile tile(params, ctx, kv, rows);
+        for (int64_t r = 0; r < rows; ++r) {
+            tile.set_query(r, q + row_offset(r), first_pos + q0 + r / group);
+        }
+        const int64_t last_pos = first_pos + q0 + queries - 1;
+        for (int64_t start = first_visible_key(first_pos + q0, params.sliding_window); start <= last_pos;
+             start += tile.block()) {
+            const int64_t count = std::min(tile.block(), last_pos + 1 - start);
+            tile.attend(kv_head, start, count, [&](int64_t r) { return first_pos + q0 + r / group; });
+        }
+
+        for (int64_t r = 0; r < rows; ++r) {
+            float* dst = out + row_offset(r);
+            const float* acc = tile.row_acc(r);
+            const float inv_sum = tile.row_sum(r) > 0.0f ? 1.0f / tile.row_sum(r) : 0.0f;
+            for (int64_t d = 0; d < hd; ++d) {
+                dst[d] = acc[d] * inv_sum;
+            }
+        }
+    });
+}
+
+// One query: the visible keys are split into chunks processed in parallel,
+// each producing a partial (max, sum, output) per head that is merged after.
+void attention_decode(const AttentionParams& params, const CpuKernelContext& ctx, const float* q,
+                      int64_t query_pos, const KvCacheView& kv, float* out) {
+    const int64_t hd = params.head_dim;
+    const int64_t heads = params.num_heads;
+    const int64_t group = heads / params.num_kv_heads;
+    const int64_t lo = first_visible_key(query_pos, params.sliding_window);
+    const int64_t chunks = ceil_div(query_pos + 1 - lo, DECODE_KV_CHUNK);
+
+    // The partials belong to the calling thread, which blocks while the
+    // workers fill them (as in lm_head_top_k), so decode does not allocate.
+    thread_local std::vector<float> part_max_storage;
+    thread_local std::vector<float> part_sum_storage;
+    thread_local std::vector<float> part_acc_storage;
+    std::vector<float>& part_max = part_max_storage;
+    std::vector<float>& part_sum = part_sum_storage;
+    std::vector<float>& part_acc = part_acc_storage;
+    part_max.assign(static_cast<size_t>(chunks * heads), NEG_INF);
+    part_sum.assign(static_cast<size_t>(chunks * heads), 0.0f);
+    part_acc.assign(static_cast<size_t>(chunks * heads * hd), 0.0f);
+
+    run_tasks(ctx, static_cast<size_t>(params.num_kv_heads * chunks), [&](size_t task) {
+        const int64_t kv_head = static_cast<int64_t>(task) / chunks;
+        const int64_t chunk = static_cast<int64_t>(task) % chunks;
+        const int64_t chunk_start = lo + chunk * DECODE_KV_CHUNK;
+        const int64_t chunk_end = std::min(query_pos + 1, chunk_start + DECODE_KV_CHUNK);
+
+        AttentionTile tile(params, ctx, kv, group);
+        for (int64_t g = 0; g < group; ++g) {
+            tile.set_query(g, q + (kv_head * group + g) * hd, query_pos);
+        }
+        for (int64_t start = chunk_start; start < chunk_end; start += tile.block()) {
+            const int64_t count = std::min(tile.block(), chunk_end - start);
+            tile.attend(kv_head, start, count, [query_pos](int64_t) { return query_pos; });
+        }
+        for (int64_t g = 0; g < group; ++g) {
+            const size_t slot = static_cast<size_t>(chunk * heads + kv_head * group + g);
+            part_max[slot] = tile.row_max(g);
+            part_sum[slot] = tile.row_sum(g);
+            std::copy(tile.row_acc(g), tile.row_acc(g) + hd, part_acc.begin() + static_cast<ptrdiff_t>(slot * hd));
+        }
+    });
+
+    for (int64_t head = 0; head < heads; ++head) {
+        float global_max = NEG_INF;
+        for (int64_t c = 0; c < chunks; ++c) {
+            global_max = std::max(global_max, part_max[c * heads + head]);
+        }
+        float total = 0.0f;
+        float* dst = out + head * hd;
+        std::fill(dst, dst + hd, 0.0f);
+        for (int64_t c = 0; c < chunks; ++c) {
+            const size_t slot = static_cast<size_t>(c * heads + head);
+            if (part_max[slot] == NEG_INF) {
+                continue;
+            }
+            const float weight = std::exp(part_max[slot] - global_max);
+            total += part_sum[slot] * weight;
+            for (int64_t d = 0; d < hd; ++d) {
+                dst[d] += part_acc[slot * hd + d] * weight;
+            }
+        }
+        const float inv_total = total > 0.0f ? 1.0f / total : 0.0f;
+        for (int64_t d = 0; d < hd; ++d) {
+            dst[d] *= inv_total;
+        }
+    }
+}
+
+void validate(const AttentionParams& params, int64_t num_queries, int64_t first_pos, const KvCacheView& kv) {
+    if (params.num_heads <= 0 || params.num_kv_heads <= 0 || params.num_heads % params.num_kv_heads != 0) {
+        throw std::runtime_error("Attention query heads must be a positive multiple of the KV heads.");
+    }
+    if (first_pos < 0 || first_pos + num_queries > kv.length) {
+        throw std::runtime_error("Attention queries extend past the populated KV cache.");
+    }
+    if (kv.data_type != DataType::FP32 && kv.data_type != DataType::FP16) {
+        throw std::runtime_error("Attention KV cache must be FP32 or FP16.");
+    }
+    if (params.rope && (params.rope->head_dim() != params.head_dim ||
+                        first_pos + num_queries > params.rope->max_positions())) {
+        throw std::runtime_error("Attention RoPE table does not cover the query positions.");
+    }
+}
+
+} // namespace
+
+void flash_attention(const AttentionParams& params, const CpuKernelContext& ctx, const float* q,
+                     int64_t num_queries, int64_t first_pos, const KvCacheView& kv, float* out) {
+    if (num_queries <= 0) {
+        return;
+    }
+    validate(params, num_queries, first_pos, kv);
+    if (num_queries == 1) {
+        attention_decode(params, ctx, q, first_pos, kv, out);
+    } else {
+        attention_prefill(params, ctx, q, num_queries, first_pos, kv, out);
+    }
+}
+
+void kv_cache_append(const AttentionParams& params, const CpuKernelContext& ctx, const float* k, const float* v,
+                     int64_t count, int64_t first_pos, const KvCacheBuffer& cache) {
+    if (first_pos < 0 || first_pos + count > cache.capacity) {
+        throw std::runtime_error("KV cache append exceeds the cache capacity.");
+    }
+    validate(params, count, first_pos, cache.view(first_pos + count));
+    const int64_t row = params.num_kv_heads * params.head_dim;
+    thread_local std::vector<float> rotated;
+    rotated.resize(static_cast<size_t>(row));
+
+    auto store = [&](void* base, int64_t pos, const float* src) {
+        if (cache.data_type == DataType::FP16) {
+            uint16_t* dst = static_cast<uint16_t*>(base) + pos * row;
+            if (ctx.gemm && ctx.gemm->f32_to_f16) {
+                ctx.gemm->f32_to_f16(src, dst, row);
+            } else {
+                for (int64_t i = 0; i < row; ++i) {
+                    dst[i] = fp32_to_fp16(src[i]);
+                }
+            }
+        } else {
+            std::memcpy(static_cast<float*>(base) + pos * row, src, static_cast<size_t>(row) * sizeof(float));
+        }
+    };
+    for (int64_t i = 0; i < count; ++i) {
+        const float* key = k + i * row;
+        if (params.rope) {
+            std::copy(key, key + row, rotated.begin());
+            params.rope->apply(rotated.data(), params.num_kv_heads, first_pos + i);
+            key = rotated.data();
+        }
+        store(cache.keys, first_pos + i, key);
+        store(cache.values, first_pos + i, v + i * row);
+    }
+}
+
+void attention_reference(const AttentionParams& params, const float* q, int64_t num_queries,
+                         int64_t first_pos, const KvCacheView& kv, float* out) {
+    validate(params, num_queries, first_pos, kv);
+    const int64_t hd = params.head_dim;
+    const int64_t group = params.num_heads / params.num_kv_heads;
+    auto load = [&](const void* base, int64_t pos, int64_t kv_head, int64_t d) {
+        const int64_t index = (pos * params.num_kv_heads + kv_head) * hd + d;
+        return kv.data_type == DataType::FP16 ? fp16_to_fp32(static_cast<const uint16_t*>(base)[index])
+                                              : static_cast<const float*>(base)[index];
+    };
+
+    std::vector<float> scores(static_cast<size_t>(kv.length));
+    std::vector<float> qh(static_cast<size_t>(hd));
+    for (int64_t i = 0; i < num_queries; ++i) {
+        const int64_t pos = first_pos + i;
+        for (int64_t head = 0; head < params.num_heads; ++head) {
+            const int64_t kv_head = head / group;
+            std::copy_n(q + (i * params.num_heads + head) * hd, hd, qh.begin());
+            if (params.rope) {
+                params.rope->apply(qh.data(), 1, pos);
+            }
+            float max_score = NEG_INF;
+            for (int64_t j = 0; j <= pos; ++j) {
+                float dot = 0.0f;
+                for (int64_t d = 0; d < hd; ++d) {
+                    dot += qh[d] * load(kv.keys, j, kv_head, d);
+                }
+                scores[j] = attention_visible(pos, j, params.sliding_window) ? dot * params.scale : NEG_INF;
+                max_score = std::max(max_score, scores[j]);
+            }
+            float total = 0.0f;
+            for (int64_t j = 0; j <= pos; ++j) {
+                scores[j] = scores[j] == NEG_INF ? 0.0f : std::exp(scores[j] - max_score);
+                total += scores[j];
+            }
+            float* dst = out + (i * params.num_heads + head) * hd;
+            for (int64_t d = 0; d < hd; ++d) {
+                float value = 0.0f;
+                for (int64_t j = 0; j <= pos; ++j) {
+                    value += scores[j] * load(kv.values, j, kv_head, d);
+                }
+                dst[d] = value / total;
+            }
+        }
+    }
+}
+
+} // namespace t760::kernels
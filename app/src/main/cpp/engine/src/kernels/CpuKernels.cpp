@@ -0,0 +1,128 @@
+#include "t760_engine/kernels/KernelRegistry.h"
+#include "t760_engine/kernels/Gemm.h"
+#include "t760_engine/kernels/HalfMatmul.h"
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include "t760_engine/kernels/Sampling.h"
+#include "t760_engine/tensor/QuantizedLayout.h"
+#include <stdexcept>
+
+#include <Eigen/Dense>
+
+namespace t760 {
+
+namespace {
+
+// inputs: a [M, K] FP32, b [K, N] FP32. outputs: c [M, N] FP32. Used on
+// hosts without a SIMD tier the packed GEMM supports.
+void matmul_fp32_eigen(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs, const CpuKernelContext&) {
+    const Tensor* a = inputs[0];
+    const Tensor* b = inputs[1];
+    Tensor* c = outputs[0];
+    const auto& shape_a = a->get_shape();
+    const auto& shape_b = b->get_shape();
+    const int M = shape_a.dims[0];
+    const int K = shape_a.dims[1];
+    const int N = shape_b.dims[1];
+    Eigen::Map<const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> a_map(static_cast<const float*>(a->get_data()), M, K);
+    Eigen::Map<const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> b_map(static_cast<const float*>(b->get_data()), K, N);
+    Eigen::Map<Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> c_map(static_cast<float*>(c->get_data()), M, N);
+    c_map.noalias() = a_map * b_map;
+}
+
+// inputs: a [M, K] FP32, b [K, N] FP32 or FP16. outputs: c [M, N] FP32.
+template <IsaLevel Isa>
+void matmul_dense_packed(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs, const CpuKernelContext& ctx) {
+    static const kernels::GemmKernelSet* kernel_set = kernels::get_gemm_kernel_set(Isa);
+    const auto& shape_a = inputs[0]->get_shape();
+    const auto& shape_b = inputs[1]->get_shape();
+    const int64_t M = shape_a.dims[0];
+    const int64_t K = shape_a.dims[1];
+    const int64_t N = shape_b.dims[1];
+    if (shape_b.dims[0] != K) {
+        throw std::runtime_error("MatMul inner dimensions do not match.");
+    }
+    const float* a_data = static_cast<const float*>(inputs[0]->get_data());
+    float* c_data = static_cast<float*>(outputs[0]->get_data());
+    if (inputs[1]->get_data_type() == DataType::FP16) {
+        kernels::gemm_f16(*kernel_set, ctx, M, N, K, a_data, static_cast<const uint16_t*>(inputs[1]->get_data()), c_data);
+    } else {
+        kernels::gemm_f32(*kernel_set, ctx, M, N, K, a_data, static_cast<const float*>(inputs[1]->get_data()), c_data);
+    }
+}
+
+// Weight-only matmul: a is FP32 [M, K], w is group-quantized QINT8/QINT4 [N, K].
+// The ISA tier is a template parameter so each instantiation is a distinct
+// CpuKernelFn that the registry can hand out.
+template <IsaLevel Isa>
+void matmul_quantized(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs, const CpuKernelContext&) {
+    static const kernels::QuantizedKernelSet* kernel_set = kernels::get_quantized_kernel_set(Isa);
+    const QuantizedMatrixView weights = make_quantized_view(*inputs[1]);
+    const auto& shape_a = inputs[0]->get_shape();
+    const int64_t M = shape_a.dims[0];
+    const int64_t K = shape_a.dims[1];
+    if (K != weights.cols) {
+        throw std::runtime_error("Quantized MatMul inner dimensions do not match.");
+    }
+    const float* a_data = static_cast<const float*>(inputs[0]->get_data());
+    float* c_data = static_cast<float*>(outputs[0]->get_data());
+    if (M == 1) {
+        kernels::gemv_quantized(*kernel_set, a_data, weights, c_data);
+    } else {
+        kernels::gemm_quantized(*kernel_set, a_data, M, weights, c_data);
+    }
+}
+
+template <IsaLevel Isa>
+void register_quantized_matmul(KernelRegistry& registry, const char* name) {
+    if (!kernels::get_quantized_kernel_set(Isa)) {
+        return;
+    }
+    for (DataType dtype : {DataType::QINT8, DataType::QINT4}) {
+        registry.register_kernel(KernelOp::MATMUL, dtype, TensorLayout::DENSE, Isa, name, matmul_quantized<Isa>);
+    }
+}
+
+template <IsaLevel Isa>
+void register_dense_matmul(KernelRegistry& registry, const char* name) {
+    const kernels::GemmKernelSet* kernel_set = kernels::get_gemm_kernel_set(Isa);
+    if (!kernel_set) {
+        return;
+    }
+    // SCALAR keeps Eigen for FP32; the packed driver only pays off with SIMD.
+    if (Isa != IsaLevel::SCALAR && kernel_set->micro_f16 == nullptr) {
+        registry.register_kernel(KernelOp::MATMUL, DataType::FP32, TensorLayout::DENSE, Isa, name, matmul_dense_packed<Isa>);
+    }
+    registry.register_kernel(KernelOp::MATMUL, DataType::FP16, TensorLayout::DENSE, Isa, name, matmul_dense_packed<Isa>);
+}
+
+} // namespace
+
+void register_builtin_cpu_kernels(KernelRegistry& registry) {
+    registry.register_kernel(KernelOp::MATMUL, DataType::FP32, TensorLayout::DENSE, IsaLevel::SCALAR,
+                             "matmul_fp32_eigen", matmul_fp32_eigen);
+    register_dense_matmul<IsaLevel::SCALAR>(registry, "matmul_dense_scalar");
+    register_dense_matmul<IsaLevel::NEON>(registry, "matmul_dense_neon");
+    register_dense_matmul<IsaLevel::NEON_FP16>(registry, "matmul_dense_neon_fp16");
+    register_dense_matmul<IsaLevel::SSE41>(registry, "matmul_dense_sse41");
+    register_dense_matmul<IsaLevel::AVX2>(registry, "matmul_dense_avx2");
+
+    register_quantized_matmul<IsaLevel::SCALAR>(registry, "matmul_quantized_scalar");
+    register_quantized_matmul<IsaLevel::NEON>(registry, "matmul_quantized_neon");
+    register_quantized_matmul<IsaLevel::NEON_DOTPROD>(registry, "matmul_quantized_neon_dotprod");
+    register_quantized_matmul<IsaLevel::SSE41>(registry, "matmul_quantized_sse41");
+    register_quantized_matmul<IsaLevel::AVX2>(registry, "matmul_quantized_avx2");
+}
+
+CpuKernelContext make_cpu_kernel_context(const CpuCapabilities& caps, ThreadPool* pool) {
+    CpuKernelContext ctx;
+    ctx.pool = pool;
+    ctx.l1_cache_kb = caps.l1_cache_kb;
+    ctx.l2_cache_kb = caps.l2_cache_kb;
+    ctx.gemm = &kernels::select_gemm_kernel_set(caps);
+    ctx.quantized = &kernels::select_quantized_kernel_set(caps);
+    ctx.half = &kernels::select_half_kernel_set(caps);
+    ctx.sampling = &kernels::select_sampling_kernel_set(caps);
+    return ctx;
+}
+
+}
@@ -0,0 +1,604 @@
+#include "t760_engine/kernels/DecoderLayer.h"
+#include "t760_engine/core/ThreadPool.h"
+#include "t760_engine/kernels/Gemm.h"
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include "t760_engine/tensor/Float16.h"
+#include "t760_engine/tensor/Tensor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+
+namespace t760::kernels {
+
+namespace {
+
+constexpr int64_t GROUP = constants::QUANT_GROUP_SIZE;
+// Output rows per projection task. One quantization group wide, so a GeGLU
+// chunk is exactly one group of the down projection's input.
+constexpr int64_t ROWS_PER_TASK = GROUP;
+constexpr int64_t MAX_PROJECTIONS = 3;
+// Rows per gemm_panel call (see QuantizedMatmul.h).
+constexpr int64_t PANEL_ROWS = 4;
+
+inline int64_t ceil_div(int64_t a, int64_t b) { return (a + b - 1) / b; }
+
+void run_tasks(const CpuKernelContext& ctx, size_t tasks, FunctionRef<void(size_t)> fn) {
+    if (ctx.pool) {
+        ctx.pool->parallel_for(tasks, fn);
+    } else {
+        for (size_t t = 0; t < tasks; ++t) {
+            fn(t);
+        }
+    }
+}
+
+// Buffers of one layer call. They belong to the calling thread, which blocks
+// while the pool fills them; workers only see the pointers each dispatch
+// captures.
+struct LayerScratch {
+    std::vector<float> normed; // [count, hidden] FP32 projection input
+    std::vector<int8_t> xq;    // Quantized rows, [count, max width]
+    std::vector<float> xs;     // Their group scales
+    std::vector<float> q;      // [count, heads * head_dim]
+    std::vector<float> k;      // [count, kv_heads * head_dim]
+    std::vector<float> v;
+    std::vector<float> attn;   // [count, heads * head_dim]
+    std::vector<float> proj;   // [count, hidden]
+    std::vector<float> mlp;    // [count, intermediate]
+    std::vector<int8_t> mlp_q; // Quantized decode mlp row for the down projection
+    std::vector<float> mlp_s;
+};
+
+LayerScratch& scratch() {
+    thread_local LayerScratch s;
+    return s;
+}
+
+inline float inv_rms(const float* x, int64_t n, float eps) {
+    float sum = 0.0f;
+    for (int64_t i = 0; i < n; ++i) {
+        sum += x[i] * x[i];
+    }
+    return 1.0f / std::sqrt(sum / static_cast<float>(n) + eps);
+}
+
+// rms_norm then quantize_row_q8 of one row, without storing the normalized
+// row: each group is normalized into a stack buffer and quantized from there.
+void rms_norm_quantize(const float* x, int64_t n, const float* gain, float eps, int8_t* xq, float* xs) {
+    const float scale = inv_rms(x, n, eps);
+    float group[GROUP];
+    for (int64_t g = 0; g < n / GROUP; ++g) {
+        for (int64_t j = 0; j < GROUP; ++j) {
+            group[j] = x[g * GROUP + j] * scale * gain[g * GROUP + j];
+        }
+        quantize_row_q8(group, GROUP, xq + g * GROUP, xs + g);
+    }
+}
+
+// x[i, :] += rms_norm(y[i, :]) * gain: Gemma's post-norms feed the residual
+// add directly.
+void add_rms_norm(float* x, const float* y, int64_t count, int64_t n, const float* gain, float eps) {
+    for (int64_t i = 0; i < count; ++i) {
+        const float* yi = y + i * n;
+        float* xi = x + i * n;
+        const float scale = inv_rms(yi, n, eps);
+        for (int64_t j = 0; j < n; ++j) {
+            xi[j] += yi[j] * scale * gain[j];
+        }
+    }
+}
+
+void residual_add(const DecoderLayerParams& params, float* x, const float* y, int64_t count, const float* gain) {
+    const int64_t n = params.hidden_size;
+    if (!params.fixed) {
+        add_rms_norm(x, y, count, n, gain, params.rms_norm_eps);
+        return;
+    }
+    for (int64_t i = 0; i < count; ++i) {
+        params.fixed->add_rms_norm(x + i * n, y + i * n, gain, params.rms_norm_eps);
+    }
+}
+
+// Rows shared by every projection of one dispatch. A decode row headed for
+// quantized weights is quantized once into (xq, xs), as are W8A8 prefill
+// rows; the FP32 rows in `a` are only required by FP32 / half weights and by
+// FP32 prefill.
+struct ProjectionInput {
+    const float* a = nullptr; // [count, in_features]
+    const int8_t* xq = nullptr;
+    const float* xs = nullptr;
+    int64_t count = 0;
+    const ShapeKernelSet* fixed = nullptr;
+};
+
+struct Projection {
+    const LinearWeight* weight;
+    float* out; // [count, out_features]
+};
+
+// Builds the input of projections reading x ([count, n]), normalized by gain
+// when it is non-null. per_token marks rows that are each a sequence's decode
+// step: quantized rows for quantized weights, like a single decode row,
+// without the prefill accuracy guard.
+ProjectionInput make_input(const DecoderLayerParams& params, const float* x, int64_t count, int64_t n,
+                           const float* gain, std::initializer_list<const LinearWeight*> readers, bool per_token,
+                           LayerScratch& s) {
+    bool any_quantized = false;
+    bool any_dense = false;
+    for (const LinearWeight* w : readers) {
+        (is_group_quantized(w->data_type) ? any_quantized : any_dense) = true;
+    }
+    const float eps = params.rms_norm_eps;
+    const ShapeKernelSet* fixed = params.fixed;
+    ProjectionInput in;
+    in.count = count;
+    in.fixed = fixed;
+    const bool quantize = any_quantized && (per_token || params.int8_prefill);
+    const bool need_rows = count > 1 || any_dense;
+    if (quantize) {
+        s.xq.resize(static_cast<size_t>(count * n));
+        s.xs.resize(static_cast<size_t>(count * n / GROUP));
+        in.xq = s.xq.data();
+        in.xs = s.xs.data();
+    }
+    if (gain && !need_rows) {
+        if (fixed && n == fixed->shape.hidden_size) {
+            fixed->rms_norm_quantize(x, gain, eps, s.xq.data(), s.xs.data());
+        } else {
+            rms_norm_quantize(x, n, gain, eps, s.xq.data(), s.xs.data());
+        }
+        return in;
+    }
+    in.a = x;
+    if (gain) {
+        s.normed.resize(static_cast<size_t>(count * n));
+        rms_norm(x, count, n, gain, eps, s.normed.data());
+        in.a = s.normed.data();
+    }
+    if (quantize && count > 1) {
+        // The accuracy guard: heavy-tailed inputs keep FP32 activations.
+        const float error = quantize_rows_q8(in.a, count, n, s.xq.data(), s.xs.data());
+        if (!per_token && error > params.int8_prefill_max_error) {
+            in.xq = nullptr;
+            in.xs = nullptr;
+        }
+    } else if (quantize) {
+        if (fixed && !gain && n == fixed->shape.num_heads * fixed->shape.head_dim) {
+            fixed->quantize_attention(in.a, s.xq.data(), s.xs.data());
+        } else {
+            quantize_row_q8(in.a, n, s.xq.data(), s.xs.data());
+        }
+    }
+    return in;
+}
+
+// FP32 rows go straight to the panel kernel; only a partial last panel is
+// copied so that it can be zero-padded.
+void fp32_rows(const CpuKernelContext& ctx, const ProjectionInput& in, const LinearWeight& w, int64_t r0,
+               int64_t r1, float* out, int64_t ldo) {
+    const int64_t k = w.in_features;
+    thread_local std::vector<float> panel;
+    for (int64_t row = r0; row < r1; row += PANEL_ROWS) {
+        const int64_t nr = std::min(PANEL_ROWS, r1 - row);
+        const float* rows = w.dense + row * k;
+        if (nr < PANEL_ROWS) {
+            panel.assign(static_cast<size_t>(PANEL_ROWS * k), 0.0f);
+            std::copy_n(rows, nr * k, panel.begin());
+            rows = panel.data();
+        }
+        ctx.quantized->gemm_panel(in.a, in.count, k, rows, out + (row - r0), ldo, nr);
+    }
+}
+
+// Output rows [r0, r1) of a projection, written from out[0] with leading
+// dimension ldo.
+void project_rows(const CpuKernelContext& ctx, const ProjectionInput& in, const LinearWeight& w, int64_t r0,
+                  int64_t r1, float* out, int64_t ldo) {
+    if (!is_group_quantized(w.data_type)) {
+        if (w.data_type == DataType::FP32) {
+            fp32_rows(ctx, in, w, r0, r1, out, ldo);
+        } else {
+            gemm_half_rows(*ctx.half, in.a, in.count, w.half, r0, r1, out, ldo);
+        }
+    } else if (in.xq && in.count > 1) {
+        gemm_quantized_rows_int8(*ctx.quantized, in.xq, in.xs, in.count, w.quantized, r0, r1, out, ldo);
+    } else if (in.xq) {
+        const FixedGemvFn fixed_gemv = in.fixed ? in.fixed->gemv_for(w.in_features) : nullptr;
+        if (fixed_gemv) {
+            fixed_gemv(*ctx.quantized, in.xq, in.xs, w.quantized, r0, r1, out);
+        } else {
+            gemv_quantized_rows(*ctx.quantized, in.xq, in.xs, w.quantized, r0, r1, out);
+        }
+    } else {
+        gemm_quantized_rows(*ctx.quantized, in.a, in.count, w.quantized, r0, r1, out, ldo);
+    }
+}
+
+// Runs every projection over the same input, with the rows of all of them
+// chunked into one pool dispatch.
+void project(const CpuKernelContext& ctx, const ProjectionInput& in, std::initializer_list<Projection> projections) {
+    const Projection* list = projections.begin();
+    const int64_t n = static_cast<int64_t>(projections.size());
+    int64_t first_task[MAX_PROJECTIONS + 1];
+    int64_t total = 0;
+    for (int64_t i = 0; i < n; ++i) {
+        first_task[i] = total;
+        total += ceil_div(list[i].weight->out_features, ROWS_PER_TASK);
+    }
+    first_task[n] = total;
+
+    run_tasks(ctx, static_cast<size_t>(total), [&](size_t task) {
+        const int64_t t = static_cast<int64_t>(task);
+        int64_t i = 0;
+        while (t >= first_task[i + 1]) {
+            ++i;
+        }
+        const LinearWeight& w = *list[i].weight;
+        const int64_t r0 = (t - first_task[i]) * ROWS_PER_TASK;
+        const int64_t r1 = std::min(w.out_features, r0 + ROWS_PER_TASK);
+        project_rows(ctx, in, w, r0, r1, list[i].out + r0, w.out_features);
+    });
+}
+
+// out = gelu_tanh(gate(in)) * up(in), [count, intermediate]. Each task
+// produces both for one chunk of rows and applies the activation while they
+// are in L1. When down_q is given (decode into a quantized down projection)
+// each chunk is also quantized as one group of its input.
+void gated_mlp(const CpuKernelContext& ctx, const ProjectionInput& in, const LinearWeight& gate,
+               const LinearWeight& up, float* out, int8_t* down_q, float* down_s) {
+    const int64_t inter = gate.out_features;
+    const int64_t count = in.count;
+    run_tasks(ctx, static_cast<size_t>(ceil_div(inter, ROWS_PER_TASK)), [&](size_t task) {
+        const int64_t r0 = static_cast<int64_t>(task) * ROWS_PER_TASK;
+        const int64_t width = std::min(ROWS_PER_TASK, inter - r0);
+        // Worker-local: each task fills and consumes its own tiles.
+        thread_local std::vector<float> gate_tile;
+        thread_local std::vector<float> up_tile;
+        gate_tile.resize(static_cast<size_t>(count * ROWS_PER_TASK));
+        up_tile.resize(static_cast<size_t>(count * ROWS_PER_TASK));
+        project_rows(ctx, in, gate, r0, r0 + width, gate_tile.data(), ROWS_PER_TASK);
+        project_rows(ctx, in, up, r0, r0 + width, up_tile.data(), ROWS_PER_TASK);
+        for (int64_t i = 0; i < count; ++i) {
+            gelu_tanh_multiply(gate_tile.data() + i * ROWS_PER_TASK, up_tile.data() + i * ROWS_PER_TASK, width,
+                               out + i * inter + r0);
+        }
+        if (down_q) {
+            quantize_row_q8(out + r0, width, down_q + r0, down_s + r0 / GROUP);
+        }
+    });
+}
+
+void validate_linear(const LinearWeight& w, int64_t in, int64_t out, const char* name) {
+    if (w.in_features != in || w.out_features != out) {
+        throw std::runtime_error(std::string("Decoder layer ") + name + " is [" + std::to_string(w.in_features) +
+                                 " -> " + std::to_string(w.out_features) + "], expected [" + std::to_string(in) +
+                                 " -> " + std::to_string(out) + "].");
+    }
+    const void* data = is_group_quantized(w.data_type)   ? w.quantized.quants
+                       : w.data_type == DataType::FP32 ? static_cast<const void*>(w.dense)
+                                                       : w.half.data;
+    if (data == nullptr) {
+        throw std::runtime_error(std::string("Decoder layer ") + name + " has no data.");
+    }
+}
+
+void validate_norm(const std::vector<float>& gain, int64_t n, const char* name) {
+    if (static_cast<int64_t>(gain.size()) != n) {
+        throw std::runtime_error(std::string("Decoder layer ") + name + " has the wrong size.");
+    }
+}
+
+// Polynomial e^x, branch-free so that loops over it vectorize. Relative error
+// below 2e-7 over the clamped range.
+inline float exp_approx(float x) {
+    x = std::min(88.0f, std::max(-87.0f, x));
+    const float n = std::floor(x * 1.44269504f + 0.5f);
+    const float r = x - n * 0.693145752f - n * 1.42860677e-6f;
+    float p = 1.0f / 720.0f;
+    p = p * r + 1.0f / 120.0f;
+    p = p * r + 1.0f / 24.0f;
+    p = p * r + 1.0f / 6.0f;
+    p = p * r + 0.5f;
+    p = p * r + 1.0f;
+    p = p * r + 1.0f;
+    const int32_t bits = (static_cast<int32_t>(n) + 127) << 23;
+    float two_n;
+    std::memcpy(&two_n, &bits, sizeof(two_n));
+    return p * two_n;
+}
+
+void linear_reference(const LinearWeight& w, const float* a, int64_t count, float* out) {
+    if (is_group_quantized(w.data_type)) {
+        if (count == 1) {
+            gemv_quantized_reference(a, w.quantized, out);
+        } else {
+            gemm_quantized_reference(a, count, w.quantized, out);
+        }
+        return;
+    }
+    if (w.data_type != DataType::FP32) {
+        gemm_half_reference(a, count, w.half, out);
+        return;
+    }
+    const int64_t k = w.in_features;
+    for (int64_t i = 0; i < count; ++i) {
+        for (int64_t n = 0; n < w.out_features; ++n) {
+            float sum = 0.0f;
+            for (int64_t p = 0; p < k; ++p) {
+                sum += a[i * k + p] * w.dense[n * k + p];
+            }
+            out[i * w.out_features + n] = sum;
+        }
+    }
+}
+
+void rms_norm_reference(const float* x, int64_t count, int64_t n, const float* gain, float eps, float* out) {
+    for (int64_t i = 0; i < count; ++i) {
+        double sum = 0.0;
+        for (int64_t j = 0; j < n; ++j) {
+            sum += static_cast<double>(x[i * n + j]) * x[i * n + j];
+        }
+        const double scale = 1.0 / std::sqrt(sum / static_cast<double>(n) + eps);
+        for (int64_t j = 0; j < n; ++j) {
+            out[i * n + j] = static_cast<float>(x[i * n + j] * scale * gain[j]);
+        }
+    }
+}
+
+} // namespace
+
+LinearWeight make_linear_weight(const Tensor& weight) {
+    const auto& shape = weight.get_shape();
+    if (shape.rank() != 2) {
+        throw std::runtime_error("Projection weight must be 2-D: " + weight.get_name());
+    }
+    LinearWeight w;
+    w.data_type = weight.get_data_type();
+    if (is_group_quantized(w.data_type)) {
+        w.quantized = make_quantized_view(weight);
+        w.in_features = w.quantized.cols;
+        w.out_features = w.quantized.rows;
+    } else if (w.data_type == DataType::FP16 || w.data_type == DataType::BF16) {
+        w.half = make_half_matrix_view(weight);
+        w.in_features = w.half.cols;
+        w.out_features = w.half.rows;
+    } else if (w.data_type == DataType::FP32) {
+        w.dense = static_cast<const float*>(weight.get_data());
+        w.in_features = shape.dims[1];
+        w.out_features = shape.dims[0];
+    } else {
+        throw std::runtime_error("Projection weight must be FP32, FP16, BF16, QINT8 or QINT4: " + weight.get_name());
+    }
+    return w;
+}
+
+std::vector<float> make_norm_gain(const Tensor& weight) {
+    const int64_t n = weight.get_shape().num_elements();
+    std::vector<float> gain(static_cast<size_t>(n));
+    const void* data = weight.get_data();
+    for (int64_t i = 0; i < n; ++i) {
+        float w;
+        switch (weight.get_data_type()) {
+            case DataType::FP32: w = static_cast<const float*>(data)[i]; break;
+            case DataType::FP16: w = fp16_to_fp32(static_cast<const uint16_t*>(data)[i]); break;
+            case DataType::BF16: w = bf16_to_fp32(static_cast<const uint16_t*>(data)[i]); break;
+            default: throw std::runtime_error("Norm weight must be FP32, FP16 or BF16: " + weight.get_name());
+        }
+        gain[static_cast<size_t>(i)] = 1.0f + w;
+    }
+    return gain;
+}
+
+void validate_decoder_layer(const DecoderLayerParams& params, const DecoderLayerWeights& weights) {
+    const AttentionParams& ap = params.attention;
+    const int64_t hidden = params.hidden_size;
+    const int64_t q_width = ap.num_heads * ap.head_dim;
+    const int64_t kv_width = ap.num_kv_heads * ap.head_dim;
+    const int64_t inter = params.intermediate_size;
+    if (hidden <= 0 || hidden % GROUP != 0 || inter <= 0 || inter % GROUP != 0 || q_width % GROUP != 0) {
+        throw std::runtime_error("Decoder layer widths must be positive multiples of the quantization group size.");
+    }
+    validate_norm(weights.input_norm, hidden, "input_layernorm");
+    validate_norm(weights.post_attention_norm, hidden, "post_attention_layernorm");
+    validate_norm(weights.pre_feedforward_norm, hidden, "pre_feedforward_layernorm");
+    validate_norm(weights.post_feedforward_norm, hidden, "post_feedforward_layernorm");
+    validate_norm(weights.q_norm, ap.head_dim, "q_norm");
+    validate_norm(weights.k_norm, ap.head_dim, "k_norm");
+    validate_linear(weights.q_proj, hidden, q_width, "q_proj");
+    validate_linear(weights.k_proj, hidden, kv_width, "k_proj");
+    validate_linear(weights.v_proj, hidden, kv_width, "v_proj");
+    validate_linear(weights.o_proj, q_width, hidden, "o_proj");
+    validate_linear(weights.gate_proj, hidden, inter, "gate_proj");
+    validate_linear(weights.up_proj, hidden, inter, "up_proj");
+    validate_linear(weights.down_proj, inter, hidden, "down_proj");
+    const DecoderShape shape{hidden, ap.head_dim, ap.num_heads, ap.num_kv_heads, inter};
+    if (params.fixed && !(params.fixed->shape == shape)) {
+        throw std::runtime_error("Decoder layer fixed-shape kernels were built for a different shape.");
+    }
+}
+
+void decoder_layer_forward(const DecoderLayerParams& params, const DecoderLayerWeights& weights,
+                           const CpuKernelContext& ctx, float* x, int64_t count, int64_t first_pos,
+                           const KvCacheBuffer& cache) {
+    const DecoderSequence sequence{count, first_pos, cache};
+    decoder_layer_forward_batch(params, weights, ctx, x, &sequence, 1);
+}
+
+void decoder_layer_forward_batch(const DecoderLayerParams& params, const DecoderLayerWeights& weights,
+                                 const CpuKernelContext& ctx, float* x, const DecoderSequence* sequences,
+                                 size_t num_sequences) {
+    validate_decoder_layer(params, weights);
+    int64_t count = 0;
+    bool per_token = true;
+    for (size_t i = 0; i < num_sequences; ++i) {
+        if (sequences[i].count < 0) {
+            throw std::runtime_error("Decoder sequence has a negative row count.");
+        }
+        count += sequences[i].count;
+        per_token = per_token && sequences[i].count == 1;
+    }
+    if (count <= 0) {
+        return;
+    }
+    CpuKernelContext local = ctx;
+    if (!local.gemm) {
+        local.gemm = get_gemm_kernel_set(IsaLevel::SCALAR);
+    }
+    if (!local.quantized) {
+        local.quantized = get_quantized_kernel_set(IsaLevel::SCALAR);
+    }
+    if (!local.half) {
+        local.half = get_half_kernel_set(IsaLevel::SCALAR);
+    }
+    const AttentionParams& ap = params.attention;
+    const int64_t hidden = params.hidden_size;
+    const int64_t inter = params.intermediate_size;
+    const int64_t hd = ap.head_dim;
+    const int64_t q_width = ap.num_heads * hd;
+    const int64_t kv_width = ap.num_kv_heads * hd;
+    const float eps = params.rms_norm_eps;
+
+    LayerScratch& s = scratch();
+    s.q.resize(static_cast<size_t>(count * q_width));
+    s.k.resize(static_cast<size_t>(count * kv_width));
+    s.v.resize(static_cast<size_t>(count * kv_width));
+    s.attn.resize(static_cast<size_t>(count * q_width));
+    s.proj.resize(static_cast<size_t>(count * hidden));
+    s.mlp.resize(static_cast<size_t>(count * inter));
+
+    // Attention block.
+    ProjectionInput in = make_input(params, x, count, hidden, weights.input_norm.data(),
+                                    {&weights.q_proj, &weights.k_proj, &weights.v_proj}, per_token, s);
+    project(local, in, {{&weights.q_proj, s.q.data()}, {&weights.k_proj, s.k.data()}, {&weights.v_proj, s.v.data()}});
+    if (params.fixed) {
+        params.fixed->head_rms_norm(s.q.data(), count * ap.num_heads, weights.q_norm.data(), eps);
+        params.fixed->head_rms_norm(s.k.data(), count * ap.num_kv_heads, weights.k_norm.data(), eps);
+    } else {
+        rms_norm(s.q.data(), count * ap.num_heads, hd, weights.q_norm.data(), eps, s.q.data());
+        rms_norm(s.k.data(), count * ap.num_kv_heads, hd, weights.k_norm.data(), eps, s.k.data());
+    }
+    // Attention is the only stage that reads a sequence's own cache.
+    int64_t row = 0;
+    for (size_t i = 0; i < num_sequences; ++i) {
+        const DecoderSequence& seq = sequences[i];
+        if (seq.count == 0) {
+            continue;
+        }
+        kv_cache_append(ap, local, s.k.data() + row * kv_width, s.v.data() + row * kv_width, seq.count,
+                        seq.first_pos, seq.cache);
+        flash_attention(ap, local, s.q.data() + row * q_width, seq.count, seq.first_pos,
+                        seq.cache.view(seq.first_pos + seq.count), s.attn.data() + row * q_width);
+        row += seq.count;
+    }
+
+    in = make_input(params, s.attn.data(), count, q_width, nullptr, {&weights.o_proj}, per_token, s);
+    project(local, in, {{&weights.o_proj, s.proj.data()}});
+    residual_add(params, x, s.proj.data(), count, weights.post_attention_norm.data());
+
+    // MLP block.
+    in = make_input(params, x, count, hidden, weights.pre_feedforward_norm.data(),
+                    {&weights.gate_proj, &weights.up_proj}, per_token, s);
+    int8_t* down_q = nullptr;
+    float* down_s = nullptr;
+    if (count == 1 && is_group_quantized(weights.down_proj.data_type)) {
+        s.mlp_q.resize(static_cast<size_t>(inter));
+        s.mlp_s.resize(static_cast<size_t>(inter / GROUP));
+        down_q = s.mlp_q.data();
+        down_s = s.mlp_s.data();
+    }
+    gated_mlp(local, in, weights.gate_proj, weights.up_proj, s.mlp.data(), down_q, down_s);
+    ProjectionInput down_in;
+    if (down_q) {
+        down_in.a = s.mlp.data();
+        down_in.xq = down_q;
+        down_in.xs = down_s;
+        down_in.count = count;
+        down_in.fixed = params.fixed;
+    } else {
+        // Prefill rows are only complete once every chunk has run.
+        down_in = make_input(params, s.mlp.data(), count, inter, nullptr, {&weights.down_proj}, per_token, s);
+    }
+    project(local, down_in, {{&weights.down_proj, s.proj.data()}});
+    residual_add(params, x, s.proj.data(), count, weights.post_feedforward_norm.data());
+}
+
+void decoder_layer_reference(const DecoderLayerParams& params, const DecoderLayerWeights& weights, float* x,
+                             int64_t count, int64_t first_pos, const KvCacheBuffer& cache) {
+    validate_decoder_layer(params, weights);
+    const AttentionParams& ap = params.attention;
+    const int64_t hidden = params.hidden_size;
+    const int64_t inter = params.intermediate_size;
+    const int64_t hd = ap.head_dim;
+    const int64_t q_width = ap.num_heads * hd;
+    const int64_t kv_width = ap.num_kv_heads * hd;
+    const float eps = params.rms_norm_eps;
+    auto buffer = [&](int64_t width) { return std::vector<float>(static_cast<size_t>(count * width)); };
+    std::vector<float> normed = buffer(hidden);
+    std::vector<float> q = buffer(q_width);
+    std::vector<float> k = buffer(kv_width);
+    std::vector<float> v = buffer(kv_width);
+    std::vector<float> attn = buffer(q_width);
+    std::vector<float> proj = buffer(hidden);
+    std::vector<float> gate = buffer(inter);
+    std::vector<float> up = buffer(inter);
+
+    rms_norm_reference(x, count, hidden, weights.input_norm.data(), eps, normed.data());
+    linear_reference(weights.q_proj, normed.data(), count, q.data());
+    linear_reference(weights.k_proj, normed.data(), count, k.data());
+    linear_reference(weights.v_proj, normed.data(), count, v.data());
+    rms_norm_reference(q.data(), count * ap.num_heads, hd, weights.q_norm.data(), eps, q.data());
+    rms_norm_reference(k.data(), count * ap.num_kv_heads, hd, weights.k_norm.data(), eps, k.data());
+    AttentionParams unrotated = ap;
+    unrotated.rope = nullptr;
+    if (ap.rope) {
+        for (int64_t i = 0; i < count; ++i) {
+            rope_reference(q.data() + i * q_width, ap.num_heads, hd, first_pos + i, ap.rope->base());
+            rope_reference(k.data() + i * kv_width, ap.num_kv_heads, hd, first_pos + i, ap.rope->base());
+        }
+    }
+    kv_cache_append(unrotated, CpuKernelContext{}, k.data(), v.data(), count, first_pos, cache);
+    attention_reference(unrotated, q.data(), count, first_pos, cache.view(first_pos + count), attn.data());
+    linear_reference(weights.o_proj, attn.data(), count, proj.data());
+    rms_norm_reference(proj.data(), count, hidden, weights.post_attention_norm.data(), eps, proj.data());
+    for (size_t i = 0; i < proj.size(); ++i) {
+        x[i] += proj[i];
+    }
+
+    rms_norm_reference(x, count, hidden, weights.pre_feedforward_norm.data(), eps, normed.data());
+    linear_reference(weights.gate_proj, normed.data(), count, gate.data());
+    linear_reference(weights.up_proj, normed.data(), count, up.data());
+    constexpr double SQRT_2_OVER_PI = 0.7978845608028654;
+    for (size_t i = 0; i < gate.size(); ++i) {
+        const double g = gate[i];
+        gate[i] = static_cast<float>(0.5 * g * (1.0 + std::tanh(SQRT_2_OVER_PI * (g + 0.044715 * g * g * g))) * up[i]);
+    }
+    linear_reference(weights.down_proj, gate.data(), count, proj.data());
+    rms_norm_reference(proj.data(), count, hidden, weights.post_feedforward_norm.data(), eps, proj.data());
+    for (size_t i = 0; i < proj.size(); ++i) {
+        x[i] += proj[i];
+    }
+}
+
+void rms_norm(const float* x, int64_t count, int64_t n, const float* gain, float eps, float* out) {
+    for (int64_t i = 0; i < count; ++i) {
+        const float scale = inv_rms(x + i * n, n, eps);
+        for (int64_t j = 0; j < n; ++j) {
+            out[i * n + j] = x[i * n + j] * scale * gain[j];
+        }
+    }
+}
+
+void gelu_tanh_multiply(const float* gate, const float* up, int64_t n, float* out) {
+    // 0.5 * g * (1 + tanh(u)) == g / (1 + exp(-2u)), u = sqrt(2/pi) * (g + 0.044715 g^3).
+    constexpr float TWO_SQRT_2_OVER_PI = 1.5957691216f;
+    for (int64_t i = 0; i < n; ++i) {
+        const float g = gate[i];
+        const float u = TWO_SQRT_2_OVER_PI * (g + 0.044715f * g * g * g);
+        out[i] = g / (1.0f + exp_approx(-u)) * up[i];
+    }
+}
+
+} // namespace t760::kernels
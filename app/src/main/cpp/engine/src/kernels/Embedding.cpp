@@ -0,0 +1,184 @@
+#include "t760_engine/kernels/Embedding.h"
+#include "t760_engine/core/ThreadPool.h"
+#include "t760_engine/kernels/HalfMatmul.h"
+#include "t760_engine/tensor/Float16.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace t760::kernels {
+
+namespace {
+
+constexpr int64_t GROUP = constants::QUANT_GROUP_SIZE;
+constexpr int64_t HALF_GROUP = GROUP / 2;
+constexpr int64_t LINE = constants::T760_CACHE_LINE_SIZE_BYTES;
+// Rows requested ahead of the one being expanded. A Q8 Gemma row is ~680
+// bytes, so four rows keep roughly 40 lines in flight.
+constexpr int64_t PREFETCH_DISTANCE = 4;
+// Rows per task when a prefill batch is split over the pool.
+constexpr int64_t ROWS_PER_TASK = 32;
+
+inline int32_t low_nibble(uint8_t b) { return static_cast<int32_t>(b & 0x0F) - 8; }
+inline int32_t high_nibble(uint8_t b) { return static_cast<int32_t>(b >> 4) - 8; }
+
+inline void prefetch_range(const void* p, int64_t bytes) {
+#if defined(__GNUC__) || defined(__clang__)
+    const auto* c = static_cast<const char*>(p);
+    for (int64_t offset = 0; offset < bytes; offset += LINE) {
+        __builtin_prefetch(c + offset, 0, 0);
+    }
+#else
+    (void)p;
+    (void)bytes;
+#endif
+}
+
+void prefetch_row(const VocabTableView& table, int32_t token) {
+    const int64_t k = table.hidden_size;
+    switch (table.data_type) {
+        case DataType::FP32:
+            prefetch_range(static_cast<const float*>(table.dense) + token * k, k * 4);
+            break;
+        case DataType::FP16:
+        case DataType::BF16:
+            prefetch_range(static_cast<const uint16_t*>(table.dense) + token * k, k * 2);
+            break;
+        default: {
+            const int64_t row_bytes = static_cast<int64_t>(quantized_quants_size_in_bytes(table.data_type, 1, k));
+            prefetch_range(static_cast<const uint8_t*>(table.quantized.quants) + token * row_bytes, row_bytes);
+            const int64_t groups = table.quantized.groups_per_row();
+            prefetch_range(table.quantized.scales + token * groups, groups * 4);
+            break;
+        }
+    }
+}
+
+void expand_row(const VocabTableView& table, const CpuKernelContext& ctx, int32_t token, float scale, float* out) {
+    const int64_t k = table.hidden_size;
+    switch (table.data_type) {
+        case DataType::FP32: {
+            const float* row = static_cast<const float*>(table.dense) + token * k;
+            for (int64_t p = 0; p < k; ++p) {
+                out[p] = row[p] * scale;
+            }
+            break;
+        }
+        case DataType::FP16:
+        case DataType::BF16: {
+            const isa::ConvertHalfToF32Fn widen =
+                table.data_type == DataType::BF16 ? ctx.half->bf16_to_f32 : ctx.half->f16_to_f32;
+            widen(static_cast<const uint16_t*>(table.dense) + token * k, out, k);
+            if (scale != 1.0f) {
+                for (int64_t p = 0; p < k; ++p) {
+                    out[p] *= scale;
+                }
+            }
+            break;
+        }
+        case DataType::QINT8: {
+            const auto* q = static_cast<const int8_t*>(table.quantized.quants) + token * k;
+            const float* s = table.quantized.scales + token * (k / GROUP);
+            for (int64_t g = 0; g < k / GROUP; ++g) {
+                const float group_scale = s[g] * scale;
+                for (int64_t p = 0; p < GROUP; ++p) {
+                    out[g * GROUP + p] = static_cast<float>(q[g * GROUP + p]) * group_scale;
+                }
+            }
+            break;
+        }
+        case DataType::QINT4: {
+            const auto* q = static_cast<const uint8_t*>(table.quantized.quants) + token * (k / 2);
+            const float* s = table.quantized.scales + token * (k / GROUP);
+            for (int64_t g = 0; g < k / GROUP; ++g) {
+                const float group_scale = s[g] * scale;
+                const uint8_t* packed = q + g * HALF_GROUP;
+                float* dst = out + g * GROUP;
+                for (int64_t p = 0; p < HALF_GROUP; ++p) {
+                    dst[p] = static_cast<float>(low_nibble(packed[p])) * group_scale;
+                    dst[p + HALF_GROUP] = static_cast<float>(high_nibble(packed[p])) * group_scale;
+                }
+            }
+            break;
+        }
+        default:
+            throw std::runtime_error("Unsupported embedding table data type.");
+    }
+}
+
+void gather_rows(const VocabTableView& table, const CpuKernelContext& ctx, const int32_t* token_ids, int64_t begin,
+                 int64_t end, float scale, float* out) {
+    for (int64_t i = begin; i < std::min(end, begin + PREFETCH_DISTANCE); ++i) {
+        prefetch_row(table, token_ids[i]);
+    }
+    for (int64_t i = begin; i < end; ++i) {
+        if (i + PREFETCH_DISTANCE < end) {
+            prefetch_row(table, token_ids[i + PREFETCH_DISTANCE]);
+        }
+        expand_row(table, ctx, token_ids[i], scale, out + i * table.hidden_size);
+    }
+}
+
+void validate_tokens(const VocabTableView& table, const int32_t* token_ids, int64_t count) {
+    for (int64_t i = 0; i < count; ++i) {
+        if (token_ids[i] < 0 || token_ids[i] >= table.vocab_size) {
+            throw std::runtime_error("Token id out of vocabulary range: " + std::to_string(token_ids[i]));
+        }
+    }
+}
+
+} // namespace
+
+void embedding_lookup(const VocabTableView& table, const CpuKernelContext& ctx, const int32_t* token_ids,
+                      int64_t count, float scale, float* out) {
+    validate_vocab_table(table);
+    validate_tokens(table, token_ids, count);
+    CpuKernelContext local = ctx;
+    if (!local.half) {
+        local.half = get_half_kernel_set(IsaLevel::SCALAR);
+    }
+
+    if (!local.pool || count <= ROWS_PER_TASK) {
+        gather_rows(table, local, token_ids, 0, count, scale, out);
+        return;
+    }
+    const int64_t tasks = (count + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+    local.pool->parallel_for(static_cast<size_t>(tasks), [&](size_t task) {
+        const int64_t begin = static_cast<int64_t>(task) * ROWS_PER_TASK;
+        gather_rows(table, local, token_ids, begin, std::min(count, begin + ROWS_PER_TASK), scale, out);
+    });
+}
+
+void embedding_lookup_reference(const VocabTableView& table, const int32_t* token_ids, int64_t count, float scale,
+                                float* out) {
+    validate_vocab_table(table);
+    validate_tokens(table, token_ids, count);
+    const int64_t k = table.hidden_size;
+    for (int64_t i = 0; i < count; ++i) {
+        const int64_t row = token_ids[i];
+        for (int64_t p = 0; p < k; ++p) {
+            float value;
+            const int64_t g = p / GROUP;
+            switch (table.data_type) {
+                case DataType::FP32: value = static_cast<const float*>(table.dense)[row * k + p]; break;
+                case DataType::FP16: value = fp16_to_fp32(static_cast<const uint16_t*>(table.dense)[row * k + p]); break;
+                case DataType::BF16: value = bf16_to_fp32(static_cast<const uint16_t*>(table.dense)[row * k + p]); break;
+                case DataType::QINT8:
+                    value = static_cast<float>(static_cast<const int8_t*>(table.quantized.quants)[row * k + p]) *
+                            table.quantized.scales[row * (k / GROUP) + g];
+                    break;
+                default: {
+                    const int64_t within = p % GROUP;
+                    const uint8_t b = static_cast<const uint8_t*>(table.quantized.quants)[row * (k / 2) + g * HALF_GROUP +
+                                                                                          within % HALF_GROUP];
+                    const int32_t quant = within < HALF_GROUP ? low_nibble(b) : high_nibble(b);
+                    value = static_cast<float>(quant) * table.quantized.scales[row * (k / GROUP) + g];
+                    break;
+                }
+            }
+            out[i * k + p] = value * scale;
+        }
+    }
+}
+
+} // namespace t760::kernels
@@ -0,0 +1,287 @@
+#include "t760_engine/kernels/Gemm.h"
+#include "t760_engine/core/ThreadPool.h"
+#include "t760_engine/tensor/Float16.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace t760::kernels {
+
+namespace {
+
+// FP16 accumulators lose precision quickly; cap how many products are summed
+// in half precision before the tile is widened into FP32.
+constexpr int64_t MAX_F16_ACCUMULATION_DEPTH = 128;
+constexpr int64_t MAX_TILE_ELEMENTS = 8 * 24;
+
+inline int64_t ceil_div(int64_t a, int64_t b) { return (a + b - 1) / b; }
+inline int64_t round_up(int64_t a, int64_t b) { return ceil_div(a, b) * b; }
+
+void gemm_micro_f32_scalar(int64_t kc, const float* a_panel, const float* b_panel, float* c, int64_t ldc, bool accumulate) {
+    constexpr int64_t MR = 4, NR = 4;
+    float tile[MR][NR] = {};
+    for (int64_t p = 0; p < kc; ++p) {
+        const float* ap = a_panel + p * MR;
+        const float* bp = b_panel + p * NR;
+        for (int64_t i = 0; i < MR; ++i) {
+            for (int64_t j = 0; j < NR; ++j) {
+                tile[i][j] += ap[i] * bp[j];
+            }
+        }
+    }
+    for (int64_t i = 0; i < MR; ++i) {
+        for (int64_t j = 0; j < NR; ++j) {
+            c[i * ldc + j] = accumulate ? c[i * ldc + j] + tile[i][j] : tile[i][j];
+        }
+    }
+}
+
+void convert_f16_to_f32_scalar(const uint16_t* src, float* dst, int64_t n) {
+    for (int64_t i = 0; i < n; ++i) {
+        dst[i] = fp16_to_fp32(src[i]);
+    }
+}
+
+const GemmKernelSet SCALAR_GEMM{4, 4, gemm_micro_f32_scalar, convert_f16_to_f32_scalar, 0, 0, nullptr, nullptr};
+
+#if defined(__aarch64__)
+const GemmKernelSet NEON_GEMM{8, 12, isa::gemm_micro_f32_neon, isa::convert_f16_to_f32_neon, 0, 0, nullptr, nullptr};
+const GemmKernelSet NEON_FP16_GEMM{8, 12, isa::gemm_micro_f32_neon, isa::convert_f16_to_f32_neon,
+                                   8, 24, isa::gemm_micro_f16_neon_fp16, isa::convert_f32_to_f16_neon};
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+const GemmKernelSet SSE41_GEMM{4, 8, isa::gemm_micro_f32_sse41, convert_f16_to_f32_scalar, 0, 0, nullptr, nullptr};
+const GemmKernelSet AVX2_GEMM{6, 16, isa::gemm_micro_f32_avx2, isa::convert_f16_to_f32_f16c, 0, 0, nullptr, nullptr};
+#endif
+
+template <typename T>
+std::vector<T>& scratch_buffer(int slot) {
+    thread_local std::vector<T> buffers[3];
+    return buffers[slot];
+}
+
+// Shared blocked driver. pack_a(i0, rows, p0, depth, dst) fills mr-tall
+// micro-panels and pack_b(p0, depth, j0, cols, dst) nr-wide ones, both
+// zero-padded to whole panels.
+template <typename PanelT, typename MicroFn, typename PackA, typename PackB>
+void gemm_blocked(int64_t mr, int64_t nr, MicroFn micro, const GemmBlocking& blocking, ThreadPool* pool,
+                  int64_t m, int64_t n, int64_t k, PackA pack_a, PackB pack_b, float* c) {
+    if (m <= 0 || n <= 0) {
+        return;
+    }
+    if (k <= 0) {
+        std::fill(c, c + m * n, 0.0f);
+        return;
+    }
+
+    const int64_t kc = std::min(blocking.kc, k);
+    const int64_t mc = std::min(blocking.mc, round_up(m, mr));
+    int64_t nc = std::min(blocking.nc, round_up(n, nr));
+    const int64_t threads = pool ? pool->get_num_threads() : 1;
+    const int64_t m_blocks = ceil_div(m, mc);
+    if (m_blocks * ceil_div(n, nc) < threads) {
+        // Short and narrow problems: split N finer so every thread has work.
+        nc = std::max(nr, round_up(ceil_div(n, ceil_div(threads, m_blocks)), nr));
+    }
+    const int64_t n_blocks = ceil_div(n, nc);
+
+    auto run_block = [&](size_t task) {
+        const int64_t i0 = (static_cast<int64_t>(task) % m_blocks) * mc;
+        const int64_t j0 = (static_cast<int64_t>(task) / m_blocks) * nc;
+        const int64_t rows = std::min(mc, m - i0);
+        const int64_t cols = std::min(nc, n - j0);
+
+        std::vector<PanelT>& a_pack = scratch_buffer<PanelT>(0);
+        std::vector<PanelT>& b_pack = scratch_buffer<PanelT>(1);
+        a_pack.resize(static_cast<size_t>(round_up(rows, mr) * kc));
+        b_pack.resize(static_cast<size_t>(round_up(cols, nr) * kc));
+        float tile[MAX_TILE_ELEMENTS];
+
+        for (int64_t p0 = 0; p0 < k; p0 += kc) {
+            const int64_t depth = std::min(kc, k - p0);
+            const bool accumulate = p0 > 0;
+            pack_b(p0, depth, j0, cols, b_pack.data());
+            pack_a(i0, rows, p0, depth, a_pack.data());
+
+            for (int64_t jr = 0; jr < cols; jr += nr) {
+                const PanelT* b_panel = b_pack.data() + (jr / nr) * depth * nr;
+                const int64_t w = std::min(nr, cols - jr);
+                for (int64_t ir = 0; ir < rows; ir += mr) {
+                    const PanelT* a_panel = a_pack.data() + (ir / mr) * depth * mr;
+                    const int64_t h = std::min(mr, rows - ir);
+                    float* c_tile = c + (i0 + ir) * n + j0 + jr;
+                    if (h == mr && w == nr) {
+                        micro(depth, a_panel, b_panel, c_tile, n, accumulate);
+                        continue;
+                    }
+                    micro(depth, a_panel, b_panel, tile, nr, false);
+                    for (int64_t i = 0; i < h; ++i) {
+                        for (int64_t j = 0; j < w; ++j) {
+                            c_tile[i * n + j] = accumulate ? c_tile[i * n + j] + tile[i * nr + j] : tile[i * nr + j];
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    const size_t tasks = static_cast<size_t>(m_blocks * n_blocks);
+    if (pool) {
+        pool->parallel_for(tasks, run_block);
+    } else {
+        for (size_t task = 0; task < tasks; ++task) {
+            run_block(task);
+        }
+    }
+}
+
+// Packs rows [i0, i0 + rows) x cols [p0, p0 + depth) of a row-major FP32
+// matrix into mr-tall panels of FP32.
+void pack_a_f32(const float* a, int64_t lda, int64_t mr, int64_t i0, int64_t rows, int64_t p0, int64_t depth, float* dst) {
+    for (int64_t ir = 0; ir < rows; ir += mr) {
+        const int64_t h = std::min(mr, rows - ir);
+        float* panel = dst + (ir / mr) * depth * mr;
+        for (int64_t p = 0; p < depth; ++p) {
+            for (int64_t r = 0; r < h; ++r) {
+                panel[p * mr + r] = a[(i0 + ir + r) * lda + p0 + p];
+            }
+            for (int64_t r = h; r < mr; ++r) {
+                panel[p * mr + r] = 0.0f;
+            }
+        }
+    }
+}
+
+} // namespace
+
+const GemmKernelSet* get_gemm_kernel_set(IsaLevel isa) {
+    switch (isa) {
+        case IsaLevel::SCALAR: return &SCALAR_GEMM;
+#if defined(__aarch64__)
+        case IsaLevel::NEON: return &NEON_GEMM;
+        case IsaLevel::NEON_FP16: return &NEON_FP16_GEMM;
+#endif
+#if defined(__x86_64__) || defined(_M_X64)
+        case IsaLevel::SSE41: return &SSE41_GEMM;
+        case IsaLevel::AVX2: return &AVX2_GEMM;
+#endif
+        default: return nullptr;
+    }
+}
+
+const GemmKernelSet& select_gemm_kernel_set(const CpuCapabilities& caps) {
+    for (IsaLevel isa : {IsaLevel::AVX2, IsaLevel::SSE41, IsaLevel::NEON_FP16, IsaLevel::NEON}) {
+        const GemmKernelSet* ks = get_gemm_kernel_set(isa);
+        if (ks && is_isa_supported(isa, caps)) {
+            return *ks;
+        }
+    }
+    return SCALAR_GEMM;
+}
+
+GemmBlocking make_gemm_blocking(uint32_t l1_cache_kb, uint32_t l2_cache_kb, int64_t mr, int64_t nr,
+                                int64_t element_bytes) {
+    const int64_t l1 = static_cast<int64_t>(l1_cache_kb) * 1024;
+    const int64_t l2 = static_cast<int64_t>(l2_cache_kb) * 1024;
+
+    GemmBlocking blocking;
+    blocking.kc = std::clamp<int64_t>((l1 / 2) / ((mr + nr) * element_bytes) / 8 * 8, 32, 1024);
+    blocking.mc = std::max(mr, (l2 / 4) / (blocking.kc * element_bytes) / mr * mr);
+    blocking.nc = std::max(nr, (l2 / 2) / (blocking.kc * element_bytes) / nr * nr);
+    return blocking;
+}
+
+void gemm_f32(const GemmKernelSet& ks, const CpuKernelContext& ctx,
+              int64_t m, int64_t n, int64_t k, const float* a, const float* b, float* c) {
+    const int64_t mr = ks.mr;
+    const int64_t nr = ks.nr;
+    const GemmBlocking blocking = make_gemm_blocking(ctx.l1_cache_kb, ctx.l2_cache_kb, mr, nr, sizeof(float));
+    auto pack_a = [=](int64_t i0, int64_t rows, int64_t p0, int64_t depth, float* dst) {
+        pack_a_f32(a, k, mr, i0, rows, p0, depth, dst);
+    };
+    auto pack_b = [=](int64_t p0, int64_t depth, int64_t j0, int64_t cols, float* dst) {
+        for (int64_t jr = 0; jr < cols; jr += nr) {
+            const int64_t w = std::min(nr, cols - jr);
+            float* panel = dst + (jr / nr) * depth * nr;
+            for (int64_t p = 0; p < depth; ++p) {
+                std::memcpy(panel + p * nr, b + (p0 + p) * n + j0 + jr, static_cast<size_t>(w) * sizeof(float));
+                std::fill(panel + p * nr + w, panel + (p + 1) * nr, 0.0f);
+            }
+        }
+    };
+    gemm_blocked<float>(mr, nr, ks.micro_f32, blocking, ctx.pool, m, n, k, pack_a, pack_b, c);
+}
+
+void gemm_f16(const GemmKernelSet& ks, const CpuKernelContext& ctx,
+              int64_t m, int64_t n, int64_t k, const float* a, const uint16_t* b, float* c) {
+    if (!ks.micro_f16) {
+        const int64_t mr = ks.mr;
+        const int64_t nr = ks.nr;
+        const GemmBlocking blocking = make_gemm_blocking(ctx.l1_cache_kb, ctx.l2_cache_kb, mr, nr, sizeof(float));
+        const auto widen = ks.f16_to_f32;
+        auto pack_a = [=](int64_t i0, int64_t rows, int64_t p0, int64_t depth, float* dst) {
+            pack_a_f32(a, k, mr, i0, rows, p0, depth, dst);
+        };
+        auto pack_b = [=](int64_t p0, int64_t depth, int64_t j0, int64_t cols, float* dst) {
+            for (int64_t jr = 0; jr < cols; jr += nr) {
+                const int64_t w = std::min(nr, cols - jr);
+                float* panel = dst + (jr / nr) * depth * nr;
+                for (int64_t p = 0; p < depth; ++p) {
+                    widen(b + (p0 + p) * n + j0 + jr, panel + p * nr, w);
+                    std::fill(panel + p * nr + w, panel + (p + 1) * nr, 0.0f);
+                }
+            }
+        };
+        gemm_blocked<float>(mr, nr, ks.micro_f32, blocking, ctx.pool, m, n, k, pack_a, pack_b, c);
+        return;
+    }
+
+    const int64_t mr = ks.mr_f16;
+    const int64_t nr = ks.nr_f16;
+    const auto narrow = ks.f32_to_f16;
+    GemmBlocking blocking = make_gemm_blocking(ctx.l1_cache_kb, ctx.l2_cache_kb, mr, nr, sizeof(uint16_t));
+    blocking.kc = std::min(blocking.kc, MAX_F16_ACCUMULATION_DEPTH);
+
+    auto pack_a = [=](int64_t i0, int64_t rows, int64_t p0, int64_t depth, uint16_t* dst) {
+        std::vector<uint16_t>& row = scratch_buffer<uint16_t>(2);
+        row.resize(static_cast<size_t>(depth));
+        for (int64_t ir = 0; ir < rows; ir += mr) {
+            const int64_t h = std::min(mr, rows - ir);
+            uint16_t* panel = dst + (ir / mr) * depth * mr;
+            for (int64_t r = 0; r < mr; ++r) {
+                if (r < h) {
+                    narrow(a + (i0 + ir + r) * k + p0, row.data(), depth);
+                }
+                for (int64_t p = 0; p < depth; ++p) {
+                    panel[p * mr + r] = r < h ? row[p] : 0;
+                }
+            }
+        }
+    };
+    auto pack_b = [=](int64_t p0, int64_t depth, int64_t j0, int64_t cols, uint16_t* dst) {
+        for (int64_t jr = 0; jr < cols; jr += nr) {
+            const int64_t w = std::min(nr, cols - jr);
+            uint16_t* panel = dst + (jr / nr) * depth * nr;
+            for (int64_t p = 0; p < depth; ++p) {
+                std::memcpy(panel + p * nr, b + (p0 + p) * n + j0 + jr, static_cast<size_t>(w) * sizeof(uint16_t));
+                std::fill(panel + p * nr + w, panel + (p + 1) * nr, uint16_t{0});
+            }
+        }
+    };
+    gemm_blocked<uint16_t>(mr, nr, ks.micro_f16, blocking, ctx.pool, m, n, k, pack_a, pack_b, c);
+}
+
+void gemm_f32_reference(int64_t m, int64_t n, int64_t k, const float* a, const float* b, float* c) {
+    for (int64_t i = 0; i < m; ++i) {
+        for (int64_t j = 0; j < n; ++j) {
+            float sum = 0.0f;
+            for (int64_t p = 0; p < k; ++p) {
+                sum += a[i * k + p] * b[p * n + j];
+            }
+            c[i * n + j] = sum;
+        }
+    }
+}
+
+} // namespace t760::kernels
@@ -0,0 +1,191 @@
+#include "t760_engine/kernels/HalfMatmul.h"
+#include "t760_engine/kernels/Gemm.h"
+#include "t760_engine/tensor/Float16.h"
+#include "t760_engine/tensor/Tensor.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace t760::kernels {
+
+namespace {
+
+// Rows per gemm_panel call (see QuantizedMatmul.h).
+constexpr int64_t GEMM_PANEL_ROWS = 4;
+// Up to this many activation rows (e.g. a batch of decode steps) run the GEMV
+// per row over blocks of weight rows small enough to stay in L1 between rows,
+// which beats widening panels and matches a lone decode step exactly.
+constexpr int64_t GEMV_MAX_ACTIVATION_ROWS = 8;
+constexpr int64_t GEMV_BLOCK_BYTES = 32 * 1024;
+
+void convert_f16_to_f32_scalar(const uint16_t* src, float* dst, int64_t n) {
+    for (int64_t i = 0; i < n; ++i) {
+        dst[i] = fp16_to_fp32(src[i]);
+    }
+}
+
+void convert_bf16_to_f32_scalar(const uint16_t* src, float* dst, int64_t n) {
+    for (int64_t i = 0; i < n; ++i) {
+        dst[i] = bf16_to_fp32(src[i]);
+    }
+}
+
+template <float (*Widen)(uint16_t)>
+void gemv_scalar(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y) {
+    for (int64_t r = 0; r < rows; ++r) {
+        const uint16_t* wr = w + r * k;
+        float sum = 0.0f;
+        for (int64_t p = 0; p < k; ++p) {
+            sum += Widen(wr[p]) * x[p];
+        }
+        y[r] = sum;
+    }
+}
+
+void gemm_panel_f32_scalar(const float* a, int64_t m, int64_t k, const float* panel, float* c, int64_t ldc, int64_t nr) {
+    for (int64_t i = 0; i < m; ++i) {
+        for (int64_t j = 0; j < nr; ++j) {
+            float sum = 0.0f;
+            for (int64_t p = 0; p < k; ++p) {
+                sum += a[i * k + p] * panel[j * k + p];
+            }
+            c[i * ldc + j] = sum;
+        }
+    }
+}
+
+const HalfKernelSet SCALAR_KERNELS{gemv_scalar<fp16_to_fp32>, gemv_scalar<bf16_to_fp32>, convert_f16_to_f32_scalar,
+                                   convert_bf16_to_f32_scalar, gemm_panel_f32_scalar};
+
+#if defined(__aarch64__)
+const HalfKernelSet NEON_KERNELS{isa::gemv_f16_neon, isa::gemv_bf16_neon, isa::convert_f16_to_f32_neon,
+                                 isa::convert_bf16_to_f32_neon, isa::gemm_panel_f32_neon};
+const HalfKernelSet NEON_BF16_KERNELS{isa::gemv_f16_neon, isa::gemv_bf16_neon_bf16, isa::convert_f16_to_f32_neon,
+                                      isa::convert_bf16_to_f32_neon, isa::gemm_panel_f32_neon};
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+const HalfKernelSet AVX2_KERNELS{isa::gemv_f16_avx2, isa::gemv_bf16_avx2, isa::convert_f16_to_f32_f16c,
+                                 isa::convert_bf16_to_f32_avx2, isa::gemm_panel_f32_avx2};
+const HalfKernelSet AVX512_BF16_KERNELS{isa::gemv_f16_avx512, isa::gemv_bf16_avx512_bf16,
+                                        isa::convert_f16_to_f32_f16c, isa::convert_bf16_to_f32_avx2,
+                                        isa::gemm_panel_f32_avx2};
+#endif
+
+void validate_rows(const HalfMatrixView& w, int64_t row_begin, int64_t row_end) {
+    if (w.data_type != DataType::FP16 && w.data_type != DataType::BF16) {
+        throw std::runtime_error("Half kernel received a weight that is not FP16 or BF16.");
+    }
+    if (row_begin < 0 || row_begin > row_end || row_end > w.rows) {
+        throw std::runtime_error("Half weight row range is out of bounds.");
+    }
+}
+
+} // namespace
+
+HalfMatrixView make_half_matrix_view(const Tensor& weight) {
+    const auto& shape = weight.get_shape();
+    const DataType type = weight.get_data_type();
+    if (shape.rank() != 2 || (type != DataType::FP16 && type != DataType::BF16)) {
+        throw std::runtime_error("Half weight must be a 2-D FP16 or BF16 tensor: " + weight.get_name());
+    }
+    HalfMatrixView view;
+    view.data_type = type;
+    view.rows = shape.dims[0];
+    view.cols = shape.dims[1];
+    view.data = static_cast<const uint16_t*>(weight.get_data());
+    return view;
+}
+
+const HalfKernelSet* get_half_kernel_set(IsaLevel isa) {
+    switch (isa) {
+        case IsaLevel::SCALAR: return &SCALAR_KERNELS;
+#if defined(__aarch64__)
+        case IsaLevel::NEON: return &NEON_KERNELS;
+        case IsaLevel::NEON_BF16: return &NEON_BF16_KERNELS;
+#endif
+#if defined(__x86_64__) || defined(_M_X64)
+        case IsaLevel::AVX2: return &AVX2_KERNELS;
+        case IsaLevel::AVX512_BF16: return &AVX512_BF16_KERNELS;
+#endif
+        default: return nullptr;
+    }
+}
+
+const HalfKernelSet& select_half_kernel_set(const CpuCapabilities& caps) {
+    for (IsaLevel isa : {IsaLevel::AVX512_BF16, IsaLevel::AVX2, IsaLevel::NEON_BF16, IsaLevel::NEON}) {
+        const HalfKernelSet* ks = get_half_kernel_set(isa);
+        if (ks && is_isa_supported(isa, caps)) {
+            return *ks;
+        }
+    }
+    return SCALAR_KERNELS;
+}
+
+void gemv_half(const HalfKernelSet& ks, const float* x, const HalfMatrixView& w, float* y) {
+    gemv_half_rows(ks, x, w, 0, w.rows, y);
+}
+
+void gemm_half(const HalfKernelSet& ks, const float* a, int64_t m, const HalfMatrixView& w, float* c) {
+    gemm_half_rows(ks, a, m, w, 0, w.rows, c, w.rows);
+}
+
+void gemv_half_rows(const HalfKernelSet& ks, const float* x, const HalfMatrixView& w, int64_t row_begin,
+                    int64_t row_end, float* y) {
+    validate_rows(w, row_begin, row_end);
+    const isa::GemvHalfFn gemv = w.data_type == DataType::BF16 ? ks.gemv_bf16 : ks.gemv_f16;
+    gemv(w.data + row_begin * w.cols, row_end - row_begin, w.cols, x, y);
+}
+
+void gemm_half_rows(const HalfKernelSet& ks, const float* a, int64_t m, const HalfMatrixView& w, int64_t row_begin,
+                    int64_t row_end, float* c, int64_t ldc) {
+    if (m == 1) {
+        gemv_half_rows(ks, a, w, row_begin, row_end, c);
+        return;
+    }
+    validate_rows(w, row_begin, row_end);
+    if (m <= GEMV_MAX_ACTIVATION_ROWS) {
+        const isa::GemvHalfFn gemv = w.data_type == DataType::BF16 ? ks.gemv_bf16 : ks.gemv_f16;
+        const int64_t block = std::max<int64_t>(4, GEMV_BLOCK_BYTES / (w.cols * 2) & ~int64_t{3});
+        for (int64_t row = row_begin; row < row_end; row += block) {
+            const int64_t nr = std::min(block, row_end - row);
+            for (int64_t i = 0; i < m; ++i) {
+                gemv(w.data + row * w.cols, nr, w.cols, a + i * w.cols, c + i * ldc + (row - row_begin));
+            }
+        }
+        return;
+    }
+    if (w.cols % constants::QUANT_GROUP_SIZE != 0) {
+        throw std::runtime_error("Half weight columns must be a multiple of the quantization group size.");
+    }
+    const int64_t k = w.cols;
+    const isa::ConvertHalfToF32Fn widen = w.data_type == DataType::BF16 ? ks.bf16_to_f32 : ks.f16_to_f32;
+
+    thread_local std::vector<float> panel;
+    panel.resize(static_cast<size_t>(GEMM_PANEL_ROWS * k));
+
+    for (int64_t row = row_begin; row < row_end; row += GEMM_PANEL_ROWS) {
+        const int64_t nr = std::min(GEMM_PANEL_ROWS, row_end - row);
+        widen(w.data + row * k, panel.data(), nr * k);
+        std::fill(panel.begin() + nr * k, panel.end(), 0.0f);
+        ks.gemm_panel(a, m, k, panel.data(), c + (row - row_begin), ldc, nr);
+    }
+}
+
+void gemm_half_reference(const float* a, int64_t m, const HalfMatrixView& w, float* c) {
+    validate_rows(w, 0, w.rows);
+    const int64_t k = w.cols;
+    for (int64_t n = 0; n < w.rows; ++n) {
+        const uint16_t* wr = w.data + n * k;
+        for (int64_t i = 0; i < m; ++i) {
+            float sum = 0.0f;
+            for (int64_t p = 0; p < k; ++p) {
+                const float weight = w.data_type == DataType::BF16 ? bf16_to_fp32(wr[p]) : fp16_to_fp32(wr[p]);
+                sum += a[i * k + p] * weight;
+            }
+            c[i * w.rows + n] = sum;
+        }
+    }
+}
+
+} // namespace t760::kernels
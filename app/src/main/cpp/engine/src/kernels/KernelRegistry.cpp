@@ -0,0 +1,66 @@
+#include "t760_engine/kernels/KernelRegistry.h"
+
+namespace t760 {
+
+const char* to_string(KernelOp op) {
+    switch (op) {
+        case KernelOp::MATMUL: return "MATMUL";
+    }
+    return "UNKNOWN";
+}
+
+const char* to_string(IsaLevel isa) {
+    switch (isa) {
+        case IsaLevel::SCALAR: return "scalar";
+        case IsaLevel::NEON: return "neon";
+        case IsaLevel::NEON_FP16: return "neon-fp16";
+        case IsaLevel::NEON_DOTPROD: return "neon-dotprod";
+        case IsaLevel::NEON_I8MM: return "neon-i8mm";
+        case IsaLevel::NEON_BF16: return "neon-bf16";
+        case IsaLevel::SSE41: return "sse4.1";
+        case IsaLevel::AVX2: return "avx2";
+        case IsaLevel::AVX512: return "avx512";
+        case IsaLevel::AVX512_VNNI: return "avx512-vnni";
+        case IsaLevel::AVX512_BF16: return "avx512-bf16";
+    }
+    return "unknown";
+}
+
+bool is_isa_supported(IsaLevel isa, const CpuCapabilities& caps) {
+    switch (isa) {
+        case IsaLevel::SCALAR: return true;
+        case IsaLevel::NEON: return caps.has_neon_support;
+        case IsaLevel::NEON_FP16: return caps.has_neon_support && caps.has_fp16_arithmetic;
+        case IsaLevel::NEON_DOTPROD: return caps.has_neon_support && caps.has_dotprod;
+        case IsaLevel::NEON_I8MM: return caps.has_neon_support && caps.has_i8mm;
+        case IsaLevel::NEON_BF16: return caps.has_neon_support && caps.has_bf16;
+        case IsaLevel::SSE41: return caps.has_sse41;
+        case IsaLevel::AVX2: return caps.has_avx2 && caps.has_fma && caps.has_f16c;
+        case IsaLevel::AVX512: return caps.has_avx512;
+        case IsaLevel::AVX512_VNNI: return caps.has_avx512_vnni;
+        case IsaLevel::AVX512_BF16:
+            return caps.has_avx2 && caps.has_fma && caps.has_f16c && caps.has_avx512 && caps.has_avx512_bf16;
+    }
+    return false;
+}
+
+KernelRegistry::KernelRegistry(const CpuCapabilities& caps) : caps_(caps) {}
+
+void KernelRegistry::register_kernel(KernelOp op, DataType dtype, TensorLayout layout, IsaLevel isa,
+                                     const char* name, CpuKernelFn fn) {
+    if (!fn || !is_isa_supported(isa, caps_)) {
+        return;
+    }
+    const KernelKey key{op, dtype, layout};
+    auto it = best_.find(key);
+    if (it == best_.end() || static_cast<uint8_t>(isa) > static_cast<uint8_t>(it->second.isa)) {
+        best_[key] = KernelEntry{key, isa, name, fn};
+    }
+}
+
+const KernelEntry* KernelRegistry::resolve(KernelOp op, DataType dtype, TensorLayout layout) const {
+    auto it = best_.find(KernelKey{op, dtype, layout});
+    return it != best_.end() ? &it->second : nullptr;
+}
+
+}
@@ -0,0 +1,286 @@
+#include "t760_engine/kernels/LmHead.h"
+#include "t760_engine/core/ThreadPool.h"
+#include "t760_engine/kernels/HalfMatmul.h"
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include "t760_engine/kernels/Sampling.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace t760::kernels {
+
+namespace {
+
+// Vocab rows per task: 2048 logits stay in L1, and Gemma's 262144-entry vocab
+// gives 128 tasks to balance over the pool.
+constexpr int64_t VOCAB_TILE = 2048;
+// Rows per gemm_panel call (see QuantizedMatmul.h).
+constexpr int64_t PANEL_ROWS = 4;
+
+inline int64_t ceil_div(int64_t a, int64_t b) { return (a + b - 1) / b; }
+
+// logits[0, rows) for vocab rows [row, row + rows).
+void tile_logits(const VocabTableView& w, const CpuKernelContext& ctx, const float* hidden, int64_t row, int64_t rows,
+                 float* logits) {
+    const int64_t k = w.hidden_size;
+    if (is_group_quantized(w.data_type)) {
+        // A sub-view of the tile's rows; quants and scales are both row-major.
+        QuantizedMatrixView tile = w.quantized;
+        tile.quants = static_cast<const uint8_t*>(w.quantized.quants) +
+                      quantized_quants_size_in_bytes(w.data_type, row, k);
+        tile.scales = w.quantized.scales + row * w.quantized.groups_per_row();
+        tile.rows = rows;
+        gemv_quantized(*ctx.quantized, hidden, tile, logits);
+        return;
+    }
+    if (w.data_type != DataType::FP32) {
+        const HalfMatrixView table{w.data_type, w.vocab_size, k, static_cast<const uint16_t*>(w.dense)};
+        gemv_half_rows(*ctx.half, hidden, table, row, row + rows, logits);
+        return;
+    }
+
+    thread_local std::vector<float> panel;
+    panel.resize(static_cast<size_t>(PANEL_ROWS * k));
+    for (int64_t r = 0; r < rows; r += PANEL_ROWS) {
+        const int64_t nr = std::min(PANEL_ROWS, rows - r);
+        const float* rows_f32;
+        if (nr == PANEL_ROWS) {
+            rows_f32 = static_cast<const float*>(w.dense) + (row + r) * k;
+        } else {
+            std::memcpy(panel.data(), static_cast<const float*>(w.dense) + (row + r) * k,
+                        static_cast<size_t>(nr * k) * sizeof(float));
+            rows_f32 = panel.data();
+        }
+        if (nr < PANEL_ROWS) {
+            std::fill(panel.begin() + nr * k, panel.end(), 0.0f);
+        }
+        ctx.quantized->gemm_panel(hidden, 1, k, rows_f32, logits + r, PANEL_ROWS, nr);
+    }
+}
+
+// logits[i * ldl + r] for hidden rows i < m and vocab rows [row, row + rows).
+// Quantized tables read the rows pre-quantized by quantize_rows_q8 (hq, hs),
+// which keeps each row bit-identical to tile_logits.
+void tile_logits_rows(const VocabTableView& w, const CpuKernelContext& ctx, const float* hidden, const int8_t* hq,
+                      const float* hs, int64_t m, int64_t row, int64_t rows, float* logits, int64_t ldl) {
+    const int64_t k = w.hidden_size;
+    if (is_group_quantized(w.data_type)) {
+        gemm_quantized_rows_int8(*ctx.quantized, hq, hs, m, w.quantized, row, row + rows, logits, ldl);
+        return;
+    }
+    if (w.data_type != DataType::FP32) {
+        const HalfMatrixView table{w.data_type, w.vocab_size, k, static_cast<const uint16_t*>(w.dense)};
+        gemm_half_rows(*ctx.half, hidden, m, table, row, row + rows, logits, ldl);
+        return;
+    }
+
+    thread_local std::vector<float> panel;
+    panel.resize(static_cast<size_t>(PANEL_ROWS * k));
+    for (int64_t r = 0; r < rows; r += PANEL_ROWS) {
+        const int64_t nr = std::min(PANEL_ROWS, rows - r);
+        const float* rows_f32 = static_cast<const float*>(w.dense) + (row + r) * k;
+        if (nr < PANEL_ROWS) {
+            std::memcpy(panel.data(), rows_f32, static_cast<size_t>(nr * k) * sizeof(float));
+            std::fill(panel.begin() + nr * k, panel.end(), 0.0f);
+            rows_f32 = panel.data();
+        }
+        ctx.quantized->gemm_panel(hidden, m, k, rows_f32, logits + r, ldl, nr);
+    }
+}
+
+// Number of leading candidates, sorted best first, that a mask did not
+// lower to -inf.
+int64_t unmasked_prefix(const TokenCandidate* candidates, int64_t count) {
+    while (count > 0 && candidates[count - 1].logit == -std::numeric_limits<float>::infinity()) {
+        --count;
+    }
+    return count;
+}
+
+void run_tasks(const CpuKernelContext& ctx, size_t tasks, FunctionRef<void(size_t)> fn) {
+    if (ctx.pool) {
+        ctx.pool->parallel_for(tasks, fn);
+    } else {
+        for (size_t t = 0; t < tasks; ++t) {
+            fn(t);
+        }
+    }
+}
+
+} // namespace
+
+void lm_head_top_k(const VocabTableView& w, const CpuKernelContext& ctx, const float* hidden, int64_t top_k,
+                   std::vector<TokenCandidate>& candidates, float* logits, const TokenMask& mask) {
+    validate_vocab_table(w);
+    top_k = std::clamp<int64_t>(top_k, 1, w.vocab_size);
+    CpuKernelContext local = ctx;
+    if (!local.half) {
+        local.half = get_half_kernel_set(IsaLevel::SCALAR);
+    }
+    if (!local.quantized) {
+        local.quantized = get_quantized_kernel_set(IsaLevel::SCALAR);
+    }
+    if (!local.sampling) {
+        local.sampling = get_sampling_kernel_set(IsaLevel::SCALAR);
+    }
+
+    // Partial lists belong to the calling thread, which blocks in
+    // parallel_for while the workers fill them, so the decode loop does not
+    // allocate. Workers reach them through these references: naming the
+    // thread_locals inside the task would resolve to the worker's own copies.
+    const int64_t tasks = ceil_div(w.vocab_size, VOCAB_TILE);
+    thread_local std::vector<TokenCandidate> partial_storage;
+    thread_local std::vector<int64_t> partial_size_storage;
+    std::vector<TokenCandidate>& partial = partial_storage;
+    std::vector<int64_t>& partial_size = partial_size_storage;
+    partial.resize(static_cast<size_t>(tasks * top_k));
+    partial_size.assign(static_cast<size_t>(tasks), 0);
+
+    run_tasks(local, static_cast<size_t>(tasks), [&](size_t task) {
+        const int64_t row = static_cast<int64_t>(task) * VOCAB_TILE;
+        const int64_t rows = std::min(VOCAB_TILE, w.vocab_size - row);
+        if (!mask_allows_any(mask, row, rows)) {
+            if (logits) {
+                std::fill(logits + row, logits + row + rows, -std::numeric_limits<float>::infinity());
+            }
+            return; // partial_size[task] stays 0
+        }
+        thread_local std::vector<float> tile;
+        float* tile_out = logits;
+        if (tile_out) {
+            tile_out += row;
+        } else {
+            tile.resize(static_cast<size_t>(VOCAB_TILE));
+            tile_out = tile.data();
+        }
+        tile_logits(w, local, hidden, row, rows, tile_out);
+        mask_logits(*local.sampling, tile_out, rows, row, mask);
+
+        TopKHeap heap(partial.data() + task * top_k, top_k);
+        top_k_scan(*local.sampling, tile_out, rows, row, heap);
+        partial_size[task] = heap.size();
+    });
+
+    // Compact the per-task lists and keep the global best top_k.
+    int64_t total = 0;
+    for (int64_t t = 0; t < tasks; ++t) {
+        std::copy_n(partial.begin() + t * top_k, partial_size[t], partial.begin() + total);
+        total += partial_size[t];
+    }
+    const int64_t keep = std::min(top_k, total);
+    std::partial_sort(partial.begin(), partial.begin() + keep, partial.begin() + total, ranks_before);
+    candidates.assign(partial.begin(), partial.begin() + unmasked_prefix(partial.data(), keep));
+}
+
+void lm_head_top_k_batch(const VocabTableView& w, const CpuKernelContext& ctx, const float* hidden, int64_t m,
+                         int64_t top_k, std::vector<TokenCandidate>* candidates, const TokenMask* masks) {
+    if (m == 1) {
+        lm_head_top_k(w, ctx, hidden, top_k, candidates[0], nullptr, masks ? masks[0] : TokenMask{});
+        return;
+    }
+    validate_vocab_table(w);
+    if (m <= 0) {
+        return;
+    }
+    top_k = std::clamp<int64_t>(top_k, 1, w.vocab_size);
+    CpuKernelContext local = ctx;
+    if (!local.half) {
+        local.half = get_half_kernel_set(IsaLevel::SCALAR);
+    }
+    if (!local.quantized) {
+        local.quantized = get_quantized_kernel_set(IsaLevel::SCALAR);
+    }
+    if (!local.sampling) {
+        local.sampling = get_sampling_kernel_set(IsaLevel::SCALAR);
+    }
+
+    // As in lm_head_top_k, everything the workers write is owned by the
+    // calling thread and reached through references.
+    const int64_t k = w.hidden_size;
+    const int64_t tasks = ceil_div(w.vocab_size, VOCAB_TILE);
+    thread_local std::vector<TokenCandidate> partial_storage;
+    thread_local std::vector<int64_t> partial_size_storage;
+    thread_local std::vector<int8_t> hq_storage;
+    thread_local std::vector<float> hs_storage;
+    std::vector<TokenCandidate>& partial = partial_storage;
+    std::vector<int64_t>& partial_size = partial_size_storage;
+    partial.resize(static_cast<size_t>(tasks * m * top_k));
+    partial_size.assign(static_cast<size_t>(tasks * m), 0);
+    const int8_t* hq = nullptr;
+    const float* hs = nullptr;
+    if (is_group_quantized(w.data_type)) {
+        hq_storage.resize(static_cast<size_t>(m * k));
+        hs_storage.resize(static_cast<size_t>(m * k / constants::QUANT_GROUP_SIZE));
+        quantize_rows_q8(hidden, m, k, hq_storage.data(), hs_storage.data());
+        hq = hq_storage.data();
+        hs = hs_storage.data();
+    }
+
+    run_tasks(local, static_cast<size_t>(tasks), [&](size_t task) {
+        const int64_t row = static_cast<int64_t>(task) * VOCAB_TILE;
+        const int64_t rows = std::min(VOCAB_TILE, w.vocab_size - row);
+        const auto allows_tile = [&](int64_t i) { return !masks || mask_allows_any(masks[i], row, rows); };
+        bool any = false;
+        for (int64_t i = 0; i < m && !any; ++i) {
+            any = allows_tile(i);
+        }
+        if (!any) {
+            return;
+        }
+        thread_local std::vector<float> tile;
+        tile.resize(static_cast<size_t>(m * VOCAB_TILE));
+        tile_logits_rows(w, local, hidden, hq, hs, m, row, rows, tile.data(), VOCAB_TILE);
+        for (int64_t i = 0; i < m; ++i) {
+            if (!allows_tile(i)) {
+                continue;
+            }
+            float* row_logits = tile.data() + i * VOCAB_TILE;
+            if (masks) {
+                mask_logits(*local.sampling, row_logits, rows, row, masks[i]);
+            }
+            const size_t slot = task * static_cast<size_t>(m) + static_cast<size_t>(i);
+            TopKHeap heap(partial.data() + slot * top_k, top_k);
+            top_k_scan(*local.sampling, row_logits, rows, row, heap);
+            partial_size[slot] = heap.size();
+        }
+    });
+
+    thread_local std::vector<TokenCandidate> merged_storage;
+    std::vector<TokenCandidate>& merged = merged_storage;
+    for (int64_t i = 0; i < m; ++i) {
+        merged.clear();
+        for (int64_t t = 0; t < tasks; ++t) {
+            const size_t slot = static_cast<size_t>(t * m + i);
+            merged.insert(merged.end(), partial.begin() + slot * top_k,
+                          partial.begin() + slot * top_k + partial_size[slot]);
+        }
+        const int64_t keep = std::min<int64_t>(top_k, static_cast<int64_t>(merged.size()));
+        std::partial_sort(merged.begin(), merged.begin() + keep, merged.end(), ranks_before);
+        candidates[i].assign(merged.begin(), merged.begin() + unmasked_prefix(merged.data(), keep));
+    }
+}
+
+void lm_head_reference(const VocabTableView& w, const float* hidden, float* logits) {
+    validate_vocab_table(w);
+    const int64_t k = w.hidden_size;
+    if (is_group_quantized(w.data_type)) {
+        gemv_quantized_reference(hidden, w.quantized, logits);
+        return;
+    }
+    if (w.data_type != DataType::FP32) {
+        const HalfMatrixView table{w.data_type, w.vocab_size, k, static_cast<const uint16_t*>(w.dense)};
+        gemm_half_reference(hidden, 1, table, logits);
+        return;
+    }
+    for (int64_t v = 0; v < w.vocab_size; ++v) {
+        float sum = 0.0f;
+        for (int64_t p = 0; p < k; ++p) {
+            const float weight = static_cast<const float*>(w.dense)[v * k + p];
+            sum += hidden[p] * weight;
+        }
+        logits[v] = sum;
+    }
+}
+
+} // namespace t760::kernels
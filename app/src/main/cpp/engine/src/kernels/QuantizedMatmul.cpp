@@ -0,0 +1,360 @@
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include "t760_engine/core/Constants.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace t760::kernels {
+
+namespace {
+
+constexpr int64_t GROUP = constants::QUANT_GROUP_SIZE;
+constexpr int64_t HALF_GROUP = GROUP / 2;
+
+// Rows handled per GEMV chunk; keeps the int32 group sums resident in L1.
+constexpr int64_t GEMV_ROW_CHUNK = 64;
+constexpr int64_t GEMM_PANEL_ROWS = 4;
+// W8A8 GEMM blocking: weight rows x activation rows per isums call, so the
+// int32 sums of one block stay in L1 at K = 2048.
+constexpr int64_t GEMM_INT8_ROWS = 32;
+constexpr int64_t GEMM_INT8_ACT_ROWS = 8;
+
+inline int32_t low_nibble(uint8_t byte) { return static_cast<int32_t>(byte & 0x0F) - 8; }
+inline int32_t high_nibble(uint8_t byte) { return static_cast<int32_t>(byte >> 4) - 8; }
+
+void gemv_q8_isums_scalar(const int8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums) {
+    const int64_t groups = k / GROUP;
+    for (int64_t r = 0; r < rows; ++r) {
+        const int8_t* wr = w + r * k;
+        for (int64_t g = 0; g < groups; ++g) {
+            int32_t sum = 0;
+            for (int64_t j = 0; j < GROUP; ++j) {
+                sum += static_cast<int32_t>(wr[g * GROUP + j]) * static_cast<int32_t>(xq[g * GROUP + j]);
+            }
+            isums[r * groups + g] = sum;
+        }
+    }
+}
+
+void gemv_q4_isums_scalar(const uint8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums) {
+    const int64_t groups = k / GROUP;
+    for (int64_t r = 0; r < rows; ++r) {
+        const uint8_t* wr = w + r * (k / 2);
+        for (int64_t g = 0; g < groups; ++g) {
+            const uint8_t* packed = wr + g * HALF_GROUP;
+            const int8_t* xg = xq + g * GROUP;
+            int32_t sum = 0;
+            for (int64_t j = 0; j < HALF_GROUP; ++j) {
+                sum += low_nibble(packed[j]) * static_cast<int32_t>(xg[j]);
+                sum += high_nibble(packed[j]) * static_cast<int32_t>(xg[j + HALF_GROUP]);
+            }
+            isums[r * groups + g] = sum;
+        }
+    }
+}
+
+void gemm_panel_f32_scalar(const float* a, int64_t m, int64_t k, const float* panel, float* c, int64_t ldc, int64_t nr) {
+    for (int64_t i = 0; i < m; ++i) {
+        for (int64_t j = 0; j < nr; ++j) {
+            float sum = 0.0f;
+            for (int64_t p = 0; p < k; ++p) {
+                sum += a[i * k + p] * panel[j * k + p];
+            }
+            c[i * ldc + j] = sum;
+        }
+    }
+}
+
+// gemm_*_isums for tiers whose GEMV already keeps the weight rows of a chunk
+// in L1: one GEMV per activation row.
+template <typename QuantT, void (*Gemv)(const QuantT*, int64_t, int64_t, const int8_t*, int32_t*)>
+void gemm_isums_by_row(const QuantT* w, int64_t rows, int64_t k, const int8_t* xq, int64_t m, int32_t* isums) {
+    const int64_t stride = rows * (k / GROUP);
+    for (int64_t i = 0; i < m; ++i) {
+        Gemv(w, rows, k, xq + i * k, isums + i * stride);
+    }
+}
+
+const QuantizedKernelSet SCALAR_KERNELS{gemv_q8_isums_scalar, gemv_q4_isums_scalar,
+                                        gemm_isums_by_row<int8_t, gemv_q8_isums_scalar>,
+                                        gemm_isums_by_row<uint8_t, gemv_q4_isums_scalar>, gemm_panel_f32_scalar};
+
+#if defined(__aarch64__)
+const QuantizedKernelSet NEON_KERNELS{isa::gemv_q8_isums_neon, isa::gemv_q4_isums_neon,
+                                      gemm_isums_by_row<int8_t, isa::gemv_q8_isums_neon>,
+                                      gemm_isums_by_row<uint8_t, isa::gemv_q4_isums_neon>, isa::gemm_panel_f32_neon};
+const QuantizedKernelSet NEON_DOTPROD_KERNELS{isa::gemv_q8_isums_dotprod, isa::gemv_q4_isums_dotprod,
+                                              isa::gemm_q8_isums_dotprod, isa::gemm_q4_isums_dotprod,
+                                              isa::gemm_panel_f32_neon};
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+const QuantizedKernelSet SSE41_KERNELS{isa::gemv_q8_isums_sse41, isa::gemv_q4_isums_sse41,
+                                       gemm_isums_by_row<int8_t, isa::gemv_q8_isums_sse41>,
+                                       gemm_isums_by_row<uint8_t, isa::gemv_q4_isums_sse41>, isa::gemm_panel_f32_sse41};
+const QuantizedKernelSet AVX2_KERNELS{isa::gemv_q8_isums_avx2, isa::gemv_q4_isums_avx2, isa::gemm_q8_isums_avx2,
+                                      isa::gemm_q4_isums_avx2, isa::gemm_panel_f32_avx2};
+#endif
+
+void validate(const QuantizedMatrixView& w) {
+    if (!is_group_quantized(w.data_type)) {
+        throw std::runtime_error("Quantized kernel received a weight that is not group-quantized.");
+    }
+    if (w.cols % GROUP != 0) {
+        throw std::runtime_error("Quantized weight columns must be a multiple of the quantization group size.");
+    }
+}
+
+// Applies the per-group scales to the integer sums of one output row. Every
+// variant funnels through here so the floating point order is identical.
+inline float combine_groups(const int32_t* isums, const float* w_scales, const float* x_scales, int64_t groups) {
+    float acc = 0.0f;
+    for (int64_t g = 0; g < groups; ++g) {
+        acc += static_cast<float>(isums[g]) * (w_scales[g] * x_scales[g]);
+    }
+    return acc;
+}
+
+// Shared GEMV driver over rows [row_begin, row_end). IsumsFn computes the
+// integer group sums for a run of rows whose packed storage is row_bytes apart.
+template <typename QuantT, typename IsumsFn>
+void gemv_rows_with(IsumsFn isums_fn, int64_t row_bytes, const int8_t* xq, const float* xs,
+                    const QuantizedMatrixView& w, int64_t row_begin, int64_t row_end, float* y) {
+    const int64_t k = w.cols;
+    const int64_t groups = w.groups_per_row();
+    const auto* quants = static_cast<const QuantT*>(w.quants);
+
+    thread_local std::vector<int32_t> isums;
+    isums.resize(static_cast<size_t>(GEMV_ROW_CHUNK * groups));
+
+    for (int64_t row = row_begin; row < row_end; row += GEMV_ROW_CHUNK) {
+        const int64_t rows = std::min(GEMV_ROW_CHUNK, row_end - row);
+        isums_fn(quants + row * row_bytes, rows, k, xq, isums.data());
+        for (int64_t r = 0; r < rows; ++r) {
+            y[row - row_begin + r] = combine_groups(isums.data() + r * groups, w.scales + (row + r) * groups, xs, groups);
+        }
+    }
+}
+
+// W8A8 GEMM driver: blocks of GEMM_INT8_ROWS weight rows against blocks of
+// GEMM_INT8_ACT_ROWS activation rows, combined per output exactly as the GEMV.
+template <typename QuantT, typename IsumsFn>
+void gemm_int8_rows_with(IsumsFn isums_fn, int64_t row_bytes, const int8_t* aq, const float* as, int64_t m,
+                         const QuantizedMatrixView& w, int64_t row_begin, int64_t row_end, float* c, int64_t ldc) {
+    const int64_t k = w.cols;
+    const int64_t groups = w.groups_per_row();
+    const auto* quants = static_cast<const QuantT*>(w.quants);
+
+    thread_local std::vector<int32_t> isums;
+    isums.resize(static_cast<size_t>(GEMM_INT8_ROWS * GEMM_INT8_ACT_ROWS * groups));
+
+    for (int64_t row = row_begin; row < row_end; row += GEMM_INT8_ROWS) {
+        const int64_t rows = std::min(GEMM_INT8_ROWS, row_end - row);
+        for (int64_t i = 0; i < m; i += GEMM_INT8_ACT_ROWS) {
+            const int64_t mi = std::min(GEMM_INT8_ACT_ROWS, m - i);
+            isums_fn(quants + row * row_bytes, rows, k, aq + i * k, mi, isums.data());
+            for (int64_t ii = 0; ii < mi; ++ii) {
+                float* out = c + (i + ii) * ldc + (row - row_begin);
+                const float* x_scales = as + (i + ii) * groups;
+                for (int64_t r = 0; r < rows; ++r) {
+                    out[r] = combine_groups(isums.data() + (ii * rows + r) * groups, w.scales + (row + r) * groups,
+                                            x_scales, groups);
+                }
+            }
+        }
+    }
+}
+
+// Expands nr weight rows starting at `row` into FP32, zero-filling the panel
+// up to GEMM_PANEL_ROWS rows.
+void dequantize_panel(const QuantizedMatrixView& w, int64_t row, int64_t nr, float* panel) {
+    const int64_t k = w.cols;
+    const int64_t groups = w.groups_per_row();
+    for (int64_t j = 0; j < nr; ++j) {
+        const float* s = w.scales + (row + j) * groups;
+        float* dst = panel + j * k;
+        if (w.data_type == DataType::QINT4) {
+            const uint8_t* q = static_cast<const uint8_t*>(w.quants) + (row + j) * (k / 2);
+            for (int64_t g = 0; g < groups; ++g) {
+                const float scale = s[g];
+                const uint8_t* packed = q + g * HALF_GROUP;
+                float* out = dst + g * GROUP;
+                for (int64_t p = 0; p < HALF_GROUP; ++p) {
+                    out[p] = static_cast<float>(low_nibble(packed[p])) * scale;
+                    out[p + HALF_GROUP] = static_cast<float>(high_nibble(packed[p])) * scale;
+                }
+            }
+        } else {
+            const int8_t* q = static_cast<const int8_t*>(w.quants) + (row + j) * k;
+            for (int64_t g = 0; g < groups; ++g) {
+                const float scale = s[g];
+                for (int64_t p = 0; p < GROUP; ++p) {
+                    dst[g * GROUP + p] = static_cast<float>(q[g * GROUP + p]) * scale;
+                }
+            }
+        }
+    }
+    std::fill(panel + nr * k, panel + GEMM_PANEL_ROWS * k, 0.0f);
+}
+
+void gemm_rows_with(isa::GemmPanelF32Fn panel_fn, const float* a, int64_t m, const QuantizedMatrixView& w,
+                    int64_t row_begin, int64_t row_end, float* c, int64_t ldc) {
+    const int64_t k = w.cols;
+
+    thread_local std::vector<float> panel;
+    panel.resize(static_cast<size_t>(GEMM_PANEL_ROWS * k));
+
+    for (int64_t row = row_begin; row < row_end; row += GEMM_PANEL_ROWS) {
+        const int64_t nr = std::min(GEMM_PANEL_ROWS, row_end - row);
+        dequantize_panel(w, row, nr, panel.data());
+        panel_fn(a, m, k, panel.data(), c + (row - row_begin), ldc, nr);
+    }
+}
+
+void validate_rows(const QuantizedMatrixView& w, int64_t row_begin, int64_t row_end) {
+    validate(w);
+    if (row_begin < 0 || row_begin > row_end || row_end > w.rows) {
+        throw std::runtime_error("Quantized row range is out of bounds.");
+    }
+}
+
+void gemm_reference(const float* a, int64_t m, const QuantizedMatrixView& w, float* c) {
+    const int64_t k = w.cols;
+    const int64_t groups = w.groups_per_row();
+    std::vector<float> row_values(static_cast<size_t>(GEMM_PANEL_ROWS * k));
+    for (int64_t n = 0; n < w.rows; ++n) {
+        dequantize_panel(w, n, 1, row_values.data());
+        for (int64_t i = 0; i < m; ++i) {
+            float acc = 0.0f;
+            for (int64_t g = 0; g < groups; ++g) {
+                float group_sum = 0.0f;
+                for (int64_t p = 0; p < GROUP; ++p) {
+                    group_sum += a[i * k + g * GROUP + p] * row_values[g * GROUP + p];
+                }
+                acc += group_sum;
+            }
+            c[i * w.rows + n] = acc;
+        }
+    }
+}
+
+} // namespace
+
+void quantize_row_q8(const float* x, int64_t k, int8_t* quants, float* scales) {
+    const int64_t groups = k / GROUP;
+    for (int64_t g = 0; g < groups; ++g) {
+        const float* src = x + g * GROUP;
+        float amax = 0.0f;
+        for (int64_t j = 0; j < GROUP; ++j) {
+            amax = std::max(amax, std::fabs(src[j]));
+        }
+        const float scale = amax / 127.0f;
+        const float inv_scale = scale > 0.0f ? 1.0f / scale : 0.0f;
+        for (int64_t j = 0; j < GROUP; ++j) {
+            const float q = std::nearbyint(src[j] * inv_scale);
+            quants[g * GROUP + j] = static_cast<int8_t>(std::min(127.0f, std::max(-127.0f, q)));
+        }
+        scales[g] = scale;
+    }
+}
+
+float quantize_rows_q8(const float* a, int64_t m, int64_t k, int8_t* quants, float* scales) {
+    const int64_t groups = k / GROUP;
+    float worst = 0.0f;
+    for (int64_t i = 0; i < m; ++i) {
+        const float* x = a + i * k;
+        int8_t* q = quants + i * k;
+        float* s = scales + i * groups;
+        quantize_row_q8(x, k, q, s);
+        float error = 0.0f;
+        float energy = 0.0f;
+        for (int64_t j = 0; j < k; ++j) {
+            const float d = x[j] - static_cast<float>(q[j]) * s[j / GROUP];
+            error += d * d;
+            energy += x[j] * x[j];
+        }
+        if (energy > 0.0f) {
+            worst = std::max(worst, std::sqrt(error / energy));
+        }
+    }
+    return worst;
+}
+
+const QuantizedKernelSet* get_quantized_kernel_set(IsaLevel isa) {
+    switch (isa) {
+        case IsaLevel::SCALAR: return &SCALAR_KERNELS;
+#if defined(__aarch64__)
+        case IsaLevel::NEON: return &NEON_KERNELS;
+        case IsaLevel::NEON_DOTPROD: return &NEON_DOTPROD_KERNELS;
+#endif
+#if defined(__x86_64__) || defined(_M_X64)
+        case IsaLevel::SSE41: return &SSE41_KERNELS;
+        case IsaLevel::AVX2: return &AVX2_KERNELS;
+#endif
+        default: return nullptr;
+    }
+}
+
+const QuantizedKernelSet& select_quantized_kernel_set(const CpuCapabilities& caps) {
+    for (IsaLevel isa : {IsaLevel::AVX2, IsaLevel::SSE41, IsaLevel::NEON_DOTPROD, IsaLevel::NEON}) {
+        const QuantizedKernelSet* ks = get_quantized_kernel_set(isa);
+        if (ks && is_isa_supported(isa, caps)) {
+            return *ks;
+        }
+    }
+    return SCALAR_KERNELS;
+}
+
+void gemv_quantized(const QuantizedKernelSet& ks, const float* x, const QuantizedMatrixView& w, float* y) {
+    validate(w);
+    thread_local std::vector<int8_t> xq;
+    thread_local std::vector<float> xs;
+    xq.resize(static_cast<size_t>(w.cols));
+    xs.resize(static_cast<size_t>(w.groups_per_row()));
+    quantize_row_q8(x, w.cols, xq.data(), xs.data());
+    gemv_quantized_rows(ks, xq.data(), xs.data(), w, 0, w.rows, y);
+}
+
+void gemm_quantized(const QuantizedKernelSet& ks, const float* a, int64_t m, const QuantizedMatrixView& w, float* c) {
+    validate(w);
+    gemm_rows_with(ks.gemm_panel, a, m, w, 0, w.rows, c, w.rows);
+}
+
+void gemv_quantized_rows(const QuantizedKernelSet& ks, const int8_t* xq, const float* xs, const QuantizedMatrixView& w,
+                         int64_t row_begin, int64_t row_end, float* y) {
+    validate_rows(w, row_begin, row_end);
+    if (w.data_type == DataType::QINT4) {
+        gemv_rows_with<uint8_t>(ks.gemv_q4_isums, w.cols / 2, xq, xs, w, row_begin, row_end, y);
+    } else {
+        gemv_rows_with<int8_t>(ks.gemv_q8_isums, w.cols, xq, xs, w, row_begin, row_end, y);
+    }
+}
+
+void gemm_quantized_rows(const QuantizedKernelSet& ks, const float* a, int64_t m, const QuantizedMatrixView& w,
+                         int64_t row_begin, int64_t row_end, float* c, int64_t ldc) {
+    validate_rows(w, row_begin, row_end);
+    gemm_rows_with(ks.gemm_panel, a, m, w, row_begin, row_end, c, ldc);
+}
+
+void gemm_quantized_rows_int8(const QuantizedKernelSet& ks, const int8_t* aq, const float* as, int64_t m,
+                              const QuantizedMatrixView& w, int64_t row_begin, int64_t row_end, float* c,
+                              int64_t ldc) {
+    validate_rows(w, row_begin, row_end);
+    if (w.data_type == DataType::QINT4) {
+        gemm_int8_rows_with<uint8_t>(ks.gemm_q4_isums, w.cols / 2, aq, as, m, w, row_begin, row_end, c, ldc);
+    } else {
+        gemm_int8_rows_with<int8_t>(ks.gemm_q8_isums, w.cols, aq, as, m, w, row_begin, row_end, c, ldc);
+    }
+}
+
+void gemv_quantized_reference(const float* x, const QuantizedMatrixView& w, float* y) {
+    gemv_quantized(SCALAR_KERNELS, x, w, y);
+}
+
+void gemm_quantized_reference(const float* a, int64_t m, const QuantizedMatrixView& w, float* c) {
+    validate(w);
+    gemm_reference(a, m, w, c);
+}
+
+} // namespace t760::kernels
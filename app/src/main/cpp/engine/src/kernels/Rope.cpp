@@ -0,0 +1,60 @@
+#include "t760_engine/kernels/Rope.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace t760::kernels {
+
+RopeTable::RopeTable(int64_t head_dim, int64_t max_positions, float base)
+    : head_dim_(head_dim), max_positions_(max_positions), base_(base) {
+    if (head_dim <= 0 || head_dim % 2 != 0 || max_positions <= 0 || !(base > 0.0f)) {
+        throw std::runtime_error("RoPE needs an even head dimension, positions and a positive base.");
+    }
+    const int64_t half = head_dim / 2;
+    cos_.resize(static_cast<size_t>(max_positions * half));
+    sin_.resize(static_cast<size_t>(max_positions * half));
+    for (int64_t i = 0; i < half; ++i) {
+        const double inv_freq = std::pow(static_cast<double>(base), -2.0 * static_cast<double>(i) / head_dim);
+        for (int64_t pos = 0; pos < max_positions; ++pos) {
+            const double angle = static_cast<double>(pos) * inv_freq;
+            cos_[pos * half + i] = static_cast<float>(std::cos(angle));
+            sin_[pos * half + i] = static_cast<float>(std::sin(angle));
+        }
+    }
+}
+
+void RopeTable::apply(float* x, int64_t heads, int64_t pos) const {
+    if (pos < 0 || pos >= max_positions_) {
+        throw std::runtime_error("RoPE position exceeds the precomputed table.");
+    }
+    const int64_t half = head_dim_ / 2;
+    const float* c = cos_row(pos);
+    const float* s = sin_row(pos);
+    for (int64_t h = 0; h < heads; ++h) {
+        float* lo = x + h * head_dim_;
+        float* hi = lo + half;
+        for (int64_t i = 0; i < half; ++i) {
+            const float a = lo[i];
+            const float b = hi[i];
+            lo[i] = a * c[i] - b * s[i];
+            hi[i] = b * c[i] + a * s[i];
+        }
+    }
+}
+
+void rope_reference(float* x, int64_t heads, int64_t head_dim, int64_t pos, float base) {
+    const int64_t half = head_dim / 2;
+    for (int64_t h = 0; h < heads; ++h) {
+        float* lo = x + h * head_dim;
+        float* hi = lo + half;
+        for (int64_t i = 0; i < half; ++i) {
+            const double angle = static_cast<double>(pos) *
+                                 std::pow(static_cast<double>(base), -2.0 * static_cast<double>(i) / head_dim);
+            const double a = lo[i];
+            const double b = hi[i];
+            lo[i] = static_cast<float>(a * std::cos(angle) - b * std::sin(angle));
+            hi[i] = static_cast<float>(b * std::cos(angle) + a * std::sin(angle));
+        }
+    }
+}
+
+} // namespace t760::kernels
@@ -0,0 +1,155 @@
+#include "t760_engine/kernels/Sampling.h"
+#include "t760_engine/kernels/HalfMatmul.h"
+#include <cmath>
+
+namespace t760::kernels {
+
+namespace {
+
+// FP16 logits widened per block: 16 KB of FP32, well inside L1.
+constexpr int64_t F16_BLOCK = 4096;
+
+float max_f32_scalar(const float* x, int64_t n) {
+    float result = -std::numeric_limits<float>::infinity();
+    for (int64_t i = 0; i < n; ++i) {
+        result = std::max(result, x[i]);
+    }
+    return result;
+}
+
+int64_t find_at_least_f32_scalar(const float* x, int64_t n, float threshold) {
+    for (int64_t i = 0; i < n; ++i) {
+        if (x[i] >= threshold) {
+            return i;
+        }
+    }
+    return n;
+}
+
+float exp_sum_f32_scalar(const float* x, int64_t n, float shift, float scale, float* out) {
+    float sum = 0.0f;
+    for (int64_t i = 0; i < n; ++i) {
+        out[i] = std::exp((x[i] - shift) * scale);
+        sum += out[i];
+    }
+    return sum;
+}
+
+void mask_f32_scalar(float* x, int64_t n, const uint64_t* bits) {
+    for (int64_t i = 0; i < n; ++i) {
+        if (((bits[i >> 6] >> (i & 63)) & 1) == 0) {
+            x[i] = -std::numeric_limits<float>::infinity();
+        }
+    }
+}
+
+const SamplingKernelSet SCALAR_KERNELS{max_f32_scalar, find_at_least_f32_scalar, exp_sum_f32_scalar,
+                                       mask_f32_scalar};
+
+#if defined(__aarch64__)
+const SamplingKernelSet NEON_KERNELS{isa::max_f32_neon, isa::find_at_least_f32_neon, isa::exp_sum_f32_neon,
+                                     isa::mask_f32_neon};
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+const SamplingKernelSet AVX2_KERNELS{isa::max_f32_avx2, isa::find_at_least_f32_avx2, isa::exp_sum_f32_avx2,
+                                     isa::mask_f32_avx2};
+#endif
+
+void finish(std::vector<TokenCandidate>& candidates, const TopKHeap& heap) {
+    candidates.resize(static_cast<size_t>(heap.size()));
+    std::sort(candidates.begin(), candidates.end(), ranks_before);
+}
+
+} // namespace
+
+const SamplingKernelSet* get_sampling_kernel_set(IsaLevel isa) {
+    switch (isa) {
+        case IsaLevel::SCALAR: return &SCALAR_KERNELS;
+#if defined(__aarch64__)
+        case IsaLevel::NEON: return &NEON_KERNELS;
+#endif
+#if defined(__x86_64__) || defined(_M_X64)
+        case IsaLevel::AVX2: return &AVX2_KERNELS;
+#endif
+        default: return nullptr;
+    }
+}
+
+const SamplingKernelSet& select_sampling_kernel_set(const CpuCapabilities& caps) {
+    for (IsaLevel isa : {IsaLevel::AVX2, IsaLevel::NEON}) {
+        const SamplingKernelSet* ks = get_sampling_kernel_set(isa);
+        if (ks && is_isa_supported(isa, caps)) {
+            return *ks;
+        }
+    }
+    return SCALAR_KERNELS;
+}
+
+void top_k_scan(const SamplingKernelSet& ks, const float* logits, int64_t n, int64_t first_token, TopKHeap& heap) {
+    int64_t i = 0;
+    while (i < n) {
+        i += ks.find_at_least(logits + i, n - i, heap.threshold());
+        if (i == n) {
+            break;
+        }
+        heap.push(static_cast<int32_t>(first_token + i), logits[i]);
+        ++i;
+    }
+}
+
+void mask_logits(const SamplingKernelSet& ks, float* logits, int64_t n, int64_t first_token, const TokenMask& mask) {
+    if (!mask.is_set()) {
+        return;
+    }
+    const int64_t covered = std::clamp<int64_t>(mask.size - first_token, 0, n);
+    if (covered > 0) {
+        ks.mask(logits, covered, mask.words + first_token / 64);
+    }
+    std::fill(logits + covered, logits + n, -std::numeric_limits<float>::infinity());
+}
+
+bool mask_allows_any(const TokenMask& mask, int64_t first_token, int64_t n) {
+    if (!mask.is_set()) {
+        return true;
+    }
+    const int64_t end = std::min(first_token + n, mask.size);
+    for (int64_t t = first_token; t < end;) {
+        const int64_t span = std::min<int64_t>(64 - (t & 63), end - t);
+        uint64_t word = mask.words[t >> 6] >> (t & 63);
+        if (span < 64) {
+            word &= (uint64_t{1} << span) - 1;
+        }
+        if (word != 0) {
+            return true;
+        }
+        t += span;
+    }
+    return false;
+}
+
+void top_k_logits(const SamplingKernelSet& ks, const float* logits, int64_t n, int64_t top_k,
+                  std::vector<TokenCandidate>& candidates) {
+    top_k = std::clamp<int64_t>(top_k, 1, std::max<int64_t>(n, 1));
+    candidates.resize(static_cast<size_t>(top_k));
+    TopKHeap heap(candidates.data(), top_k);
+    top_k_scan(ks, logits, n, 0, heap);
+    finish(candidates, heap);
+}
+
+void top_k_logits_f16(const SamplingKernelSet& ks, const HalfKernelSet& half, const uint16_t* logits, int64_t n,
+                      int64_t top_k, std::vector<TokenCandidate>& candidates) {
+    top_k = std::clamp<int64_t>(top_k, 1, std::max<int64_t>(n, 1));
+    candidates.resize(static_cast<size_t>(top_k));
+    TopKHeap heap(candidates.data(), top_k);
+    thread_local std::vector<float> block;
+    block.resize(static_cast<size_t>(F16_BLOCK));
+    for (int64_t i = 0; i < n; i += F16_BLOCK) {
+        const int64_t count = std::min(F16_BLOCK, n - i);
+        half.f16_to_f32(logits + i, block.data(), count);
+        top_k_scan(ks, block.data(), count, i, heap);
+    }
+    finish(candidates, heap);
+}
+
+} // namespace t760::kernels
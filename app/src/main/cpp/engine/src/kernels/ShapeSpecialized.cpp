@@ -0,0 +1,169 @@
+#include "t760_engine/kernels/ShapeSpecialized.h"
+#include "t760_engine/core/Constants.h"
+#include <algorithm>
+#include <cmath>
+
+// Decoder shapes given fixed-size kernels, as
+// X(hidden_size, head_dim, num_heads, num_kv_heads, intermediate_size).
+// A build may predefine its own list; T760_NO_SHAPE_SPECIALIZATION (CMake
+// option T760_SHAPE_SPECIALIZED_KERNELS=OFF) compiles none.
+#ifndef T760_DECODER_SHAPES
+#define T760_DECODER_SHAPES(X) \
+    X(640, 256, 4, 1, 2048) /* Gemma3 270M */
+#endif
+
+namespace t760::kernels {
+
+namespace {
+
+constexpr int64_t GROUP = constants::QUANT_GROUP_SIZE;
+// Matches the generic GEMV driver so results stay bit-exact.
+constexpr int64_t GEMV_ROW_CHUNK = 64;
+// Independent partial sums: wide enough for one NEON or AVX2 register of
+// lanes, so fixed-length reductions vectorize without reassociation.
+constexpr int64_t LANES = 8;
+
+template <int64_t N>
+inline float inv_rms(const float* x, float eps) {
+    static_assert(N % LANES == 0, "Row width must be a multiple of the reduction lanes.");
+    float partial[LANES] = {};
+    for (int64_t i = 0; i < N; i += LANES) {
+        for (int64_t j = 0; j < LANES; ++j) {
+            partial[j] += x[i + j] * x[i + j];
+        }
+    }
+    float sum = 0.0f;
+    for (float p : partial) {
+        sum += p;
+    }
+    return 1.0f / std::sqrt(sum / static_cast<float>(N) + eps);
+}
+
+// quantize_row_q8 of one group.
+inline void quantize_group(const float* src, int8_t* quants, float* scale_out) {
+    float partial[LANES] = {};
+    for (int64_t i = 0; i < GROUP; i += LANES) {
+        for (int64_t j = 0; j < LANES; ++j) {
+            partial[j] = std::max(partial[j], std::fabs(src[i + j]));
+        }
+    }
+    float amax = 0.0f;
+    for (float p : partial) {
+        amax = std::max(amax, p);
+    }
+    const float scale = amax / 127.0f;
+    const float inv_scale = scale > 0.0f ? 1.0f / scale : 0.0f;
+    for (int64_t j = 0; j < GROUP; ++j) {
+        const float q = std::nearbyint(src[j] * inv_scale);
+        quants[j] = static_cast<int8_t>(std::min(127.0f, std::max(-127.0f, q)));
+    }
+    *scale_out = scale;
+}
+
+template <int64_t N>
+void rms_norm_quantize_fixed(const float* x, const float* gain, float eps, int8_t* xq, float* xs) {
+    static_assert(N % GROUP == 0, "Quantized rows must be whole groups.");
+    const float scale = inv_rms<N>(x, eps);
+    float group[GROUP];
+    for (int64_t g = 0; g < N / GROUP; ++g) {
+        for (int64_t j = 0; j < GROUP; ++j) {
+            group[j] = x[g * GROUP + j] * scale * gain[g * GROUP + j];
+        }
+        quantize_group(group, xq + g * GROUP, xs + g);
+    }
+}
+
+template <int64_t N>
+void add_rms_norm_fixed(float* x, const float* y, const float* gain, float eps) {
+    const float scale = inv_rms<N>(y, eps);
+    for (int64_t j = 0; j < N; ++j) {
+        x[j] += y[j] * scale * gain[j];
+    }
+}
+
+template <int64_t HeadDim>
+void head_rms_norm_fixed(float* x, int64_t heads, const float* gain, float eps) {
+    for (int64_t h = 0; h < heads; ++h) {
+        float* row = x + h * HeadDim;
+        const float scale = inv_rms<HeadDim>(row, eps);
+        for (int64_t j = 0; j < HeadDim; ++j) {
+            row[j] = row[j] * scale * gain[j];
+        }
+    }
+}
+
+template <int64_t N>
+void quantize_row_fixed(const float* x, int8_t* xq, float* xs) {
+    static_assert(N % GROUP == 0, "Quantized rows must be whole groups.");
+    for (int64_t g = 0; g < N / GROUP; ++g) {
+        quantize_group(x + g * GROUP, xq + g * GROUP, xs + g);
+    }
+}
+
+template <int64_t K>
+void gemv_rows_fixed(const QuantizedKernelSet& ks, const int8_t* xq, const float* xs, const QuantizedMatrixView& w,
+                     int64_t row_begin, int64_t row_end, float* y) {
+    static_assert(K % GROUP == 0, "Quantized rows must be whole groups.");
+    constexpr int64_t GROUPS = K / GROUP;
+    int32_t isums[GEMV_ROW_CHUNK * GROUPS];
+    const bool q4 = w.data_type == DataType::QINT4;
+    for (int64_t row = row_begin; row < row_end; row += GEMV_ROW_CHUNK) {
+        const int64_t rows = std::min(GEMV_ROW_CHUNK, row_end - row);
+        if (q4) {
+            ks.gemv_q4_isums(static_cast<const uint8_t*>(w.quants) + row * (K / 2), rows, K, xq, isums);
+        } else {
+            ks.gemv_q8_isums(static_cast<const int8_t*>(w.quants) + row * K, rows, K, xq, isums);
+        }
+        for (int64_t r = 0; r < rows; ++r) {
+            const int32_t* sums = isums + r * GROUPS;
+            const float* w_scales = w.scales + (row + r) * GROUPS;
+            float acc = 0.0f;
+            for (int64_t g = 0; g < GROUPS; ++g) {
+                acc += static_cast<float>(sums[g]) * (w_scales[g] * xs[g]);
+            }
+            y[row - row_begin + r] = acc;
+        }
+    }
+}
+
+template <int64_t Hidden, int64_t HeadDim, int64_t Heads, int64_t KvHeads, int64_t Intermediate>
+ShapeKernelSet make_shape_kernel_set() {
+    constexpr int64_t ATTENTION_WIDTH = Heads * HeadDim;
+    ShapeKernelSet set;
+    set.shape = DecoderShape{Hidden, HeadDim, Heads, KvHeads, Intermediate};
+    set.rms_norm_quantize = rms_norm_quantize_fixed<Hidden>;
+    set.add_rms_norm = add_rms_norm_fixed<Hidden>;
+    set.head_rms_norm = head_rms_norm_fixed<HeadDim>;
+    set.quantize_attention = quantize_row_fixed<ATTENTION_WIDTH>;
+    set.gemv_hidden = gemv_rows_fixed<Hidden>;
+    set.gemv_attention = gemv_rows_fixed<ATTENTION_WIDTH>;
+    set.gemv_intermediate = gemv_rows_fixed<Intermediate>;
+    return set;
+}
+
+} // namespace
+
+FixedGemvFn ShapeKernelSet::gemv_for(int64_t k) const {
+    if (k == shape.hidden_size) return gemv_hidden;
+    if (k == shape.num_heads * shape.head_dim) return gemv_attention;
+    if (k == shape.intermediate_size) return gemv_intermediate;
+    return nullptr;
+}
+
+const ShapeKernelSet* find_shape_kernel_set(const DecoderShape& shape) {
+#ifndef T760_NO_SHAPE_SPECIALIZATION
+#define T760_MATCH_SHAPE(hidden, head_dim, heads, kv_heads, intermediate)                   \
+    if (shape == DecoderShape{hidden, head_dim, heads, kv_heads, intermediate}) {           \
+        static const ShapeKernelSet set =                                                   \
+            make_shape_kernel_set<hidden, head_dim, heads, kv_heads, intermediate>();       \
+        return &set;                                                                        \
+    }
+    T760_DECODER_SHAPES(T760_MATCH_SHAPE)
+#undef T760_MATCH_SHAPE
+#else
+    (void)shape;
+#endif
+    return nullptr;
+}
+
+} // namespace t760::kernels
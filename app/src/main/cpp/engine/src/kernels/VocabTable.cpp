@@ -0,0 +1,39 @@
+#include "t760_engine/kernels/VocabTable.h"
+#include "t760_engine/tensor/Tensor.h"
+#include <stdexcept>
+
+namespace t760::kernels {
+
+VocabTableView make_vocab_table_view(const Tensor& table) {
+    const auto& shape = table.get_shape();
+    if (shape.rank() != 2) {
+        throw std::runtime_error("Vocab table must be [vocab, hidden]: " + table.get_name());
+    }
+    VocabTableView view;
+    view.data_type = table.get_data_type();
+    view.vocab_size = shape.dims[0];
+    view.hidden_size = shape.dims[1];
+    if (is_group_quantized(view.data_type)) {
+        view.quantized = make_quantized_view(table);
+    } else {
+        view.dense = table.get_data();
+    }
+    validate_vocab_table(view);
+    return view;
+}
+
+void validate_vocab_table(const VocabTableView& table) {
+    if (table.vocab_size <= 0 || table.hidden_size <= 0 || table.hidden_size % constants::QUANT_GROUP_SIZE != 0) {
+        throw std::runtime_error("Vocab table hidden size must be a positive multiple of the quantization group size.");
+    }
+    if (is_group_quantized(table.data_type)) {
+        if (table.quantized.rows != table.vocab_size || table.quantized.cols != table.hidden_size) {
+            throw std::runtime_error("Vocab table quantized view does not match its shape.");
+        }
+    } else if (table.data_type != DataType::FP32 && table.data_type != DataType::FP16 &&
+               table.data_type != DataType::BF16) {
+        throw std::runtime_error("Vocab table must be FP32, FP16, BF16, QINT8 or QINT4.");
+    }
+}
+
+} // namespace t760::kernels
@@ -0,0 +1,70 @@
+#include "t760_engine/kernels/Gemm.h"
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+
+namespace t760::kernels::isa {
+
+// 8x12 tile: 24 accumulator registers, two for the a column and three for the
+// b row, which fits the 32 AdvSIMD registers of A76 and A55. Accumulators are
+// named variables so they stay in registers at -O2.
+void gemm_micro_f32_neon(int64_t kc, const float* a_panel, const float* b_panel, float* c, int64_t ldc, bool accumulate) {
+#define T760_GEMM_ZERO_ROW(r) \
+    float32x4_t c##r##0 = vdupq_n_f32(0.0f), c##r##1 = vdupq_n_f32(0.0f), c##r##2 = vdupq_n_f32(0.0f);
+    T760_GEMM_ZERO_ROW(0) T760_GEMM_ZERO_ROW(1) T760_GEMM_ZERO_ROW(2) T760_GEMM_ZERO_ROW(3)
+    T760_GEMM_ZERO_ROW(4) T760_GEMM_ZERO_ROW(5) T760_GEMM_ZERO_ROW(6) T760_GEMM_ZERO_ROW(7)
+#undef T760_GEMM_ZERO_ROW
+
+    for (int64_t p = 0; p < kc; ++p) {
+        const float32x4_t a_lo = vld1q_f32(a_panel + p * 8);
+        const float32x4_t a_hi = vld1q_f32(a_panel + p * 8 + 4);
+        const float32x4_t b0 = vld1q_f32(b_panel + p * 12);
+        const float32x4_t b1 = vld1q_f32(b_panel + p * 12 + 4);
+        const float32x4_t b2 = vld1q_f32(b_panel + p * 12 + 8);
+
+#define T760_GEMM_FMA_ROW(r, a_vec, lane)             \
+        c##r##0 = vfmaq_laneq_f32(c##r##0, b0, a_vec, lane); \
+        c##r##1 = vfmaq_laneq_f32(c##r##1, b1, a_vec, lane); \
+        c##r##2 = vfmaq_laneq_f32(c##r##2, b2, a_vec, lane);
+        T760_GEMM_FMA_ROW(0, a_lo, 0) T760_GEMM_FMA_ROW(1, a_lo, 1)
+        T760_GEMM_FMA_ROW(2, a_lo, 2) T760_GEMM_FMA_ROW(3, a_lo, 3)
+        T760_GEMM_FMA_ROW(4, a_hi, 0) T760_GEMM_FMA_ROW(5, a_hi, 1)
+        T760_GEMM_FMA_ROW(6, a_hi, 2) T760_GEMM_FMA_ROW(7, a_hi, 3)
+#undef T760_GEMM_FMA_ROW
+    }
+
+    auto store = [accumulate](float* dst, float32x4_t value) {
+        vst1q_f32(dst, accumulate ? vaddq_f32(vld1q_f32(dst), value) : value);
+    };
+#define T760_GEMM_STORE_ROW(r) \
+    store(c + r * ldc, c##r##0); store(c + r * ldc + 4, c##r##1); store(c + r * ldc + 8, c##r##2);
+    T760_GEMM_STORE_ROW(0) T760_GEMM_STORE_ROW(1) T760_GEMM_STORE_ROW(2) T760_GEMM_STORE_ROW(3)
+    T760_GEMM_STORE_ROW(4) T760_GEMM_STORE_ROW(5) T760_GEMM_STORE_ROW(6) T760_GEMM_STORE_ROW(7)
+#undef T760_GEMM_STORE_ROW
+}
+
+void convert_f16_to_f32_neon(const uint16_t* src, float* dst, int64_t n) {
+    int64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const uint16x8_t h = vld1q_u16(src + i);
+        vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vget_low_u16(h))));
+        vst1q_f32(dst + i + 4, vcvt_f32_f16(vreinterpret_f16_u16(vget_high_u16(h))));
+    }
+    for (; i < n; ++i) {
+        dst[i] = vgetq_lane_f32(vcvt_f32_f16(vreinterpret_f16_u16(vdup_n_u16(src[i]))), 0);
+    }
+}
+
+void convert_f32_to_f16_neon(const float* src, uint16_t* dst, int64_t n) {
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1_u16(dst + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+    }
+    for (; i < n; ++i) {
+        dst[i] = vget_lane_u16(vreinterpret_u16_f16(vcvt_f16_f32(vdupq_n_f32(src[i]))), 0);
+    }
+}
+
+} // namespace t760::kernels::isa
+
+#endif
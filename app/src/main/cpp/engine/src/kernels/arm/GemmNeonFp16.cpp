@@ -0,0 +1,52 @@
+#include "t760_engine/kernels/Gemm.h"
+
+// Built with +fp16 (see CMakeLists.txt); only entered when HWCAP reports
+// asimdhp, which both A76 and A55 implement.
+#if defined(__aarch64__) && defined(__ARM_FEATURE_FP16_VECTOR_ARITHMETIC)
+#include <arm_neon.h>
+
+namespace t760::kernels::isa {
+
+// 8x24 tile of half-precision accumulators: eight lanes per register doubles
+// the FMA throughput of the FP32 kernel for the same register budget.
+void gemm_micro_f16_neon_fp16(int64_t kc, const uint16_t* a_panel, const uint16_t* b_panel, float* c, int64_t ldc, bool accumulate) {
+#define T760_GEMM_ZERO_ROW(r) \
+    float16x8_t c##r##0 = vdupq_n_f16(0.0f), c##r##1 = vdupq_n_f16(0.0f), c##r##2 = vdupq_n_f16(0.0f);
+    T760_GEMM_ZERO_ROW(0) T760_GEMM_ZERO_ROW(1) T760_GEMM_ZERO_ROW(2) T760_GEMM_ZERO_ROW(3)
+    T760_GEMM_ZERO_ROW(4) T760_GEMM_ZERO_ROW(5) T760_GEMM_ZERO_ROW(6) T760_GEMM_ZERO_ROW(7)
+#undef T760_GEMM_ZERO_ROW
+
+    const float16_t* a = reinterpret_cast<const float16_t*>(a_panel);
+    const float16_t* b = reinterpret_cast<const float16_t*>(b_panel);
+    for (int64_t p = 0; p < kc; ++p) {
+        const float16x8_t av = vld1q_f16(a + p * 8);
+        const float16x8_t b0 = vld1q_f16(b + p * 24);
+        const float16x8_t b1 = vld1q_f16(b + p * 24 + 8);
+        const float16x8_t b2 = vld1q_f16(b + p * 24 + 16);
+
+#define T760_GEMM_FMA_ROW(r)                              \
+        c##r##0 = vfmaq_laneq_f16(c##r##0, b0, av, r);    \
+        c##r##1 = vfmaq_laneq_f16(c##r##1, b1, av, r);    \
+        c##r##2 = vfmaq_laneq_f16(c##r##2, b2, av, r);
+        T760_GEMM_FMA_ROW(0) T760_GEMM_FMA_ROW(1) T760_GEMM_FMA_ROW(2) T760_GEMM_FMA_ROW(3)
+        T760_GEMM_FMA_ROW(4) T760_GEMM_FMA_ROW(5) T760_GEMM_FMA_ROW(6) T760_GEMM_FMA_ROW(7)
+#undef T760_GEMM_FMA_ROW
+    }
+
+    // Widen each half-precision accumulator into two FP32 quads of c.
+    auto store = [accumulate](float* dst, float16x8_t value) {
+        const float32x4_t lo = vcvt_f32_f16(vget_low_f16(value));
+        const float32x4_t hi = vcvt_high_f32_f16(value);
+        vst1q_f32(dst, accumulate ? vaddq_f32(vld1q_f32(dst), lo) : lo);
+        vst1q_f32(dst + 4, accumulate ? vaddq_f32(vld1q_f32(dst + 4), hi) : hi);
+    };
+#define T760_GEMM_STORE_ROW(r) \
+    store(c + r * ldc, c##r##0); store(c + r * ldc + 8, c##r##1); store(c + r * ldc + 16, c##r##2);
+    T760_GEMM_STORE_ROW(0) T760_GEMM_STORE_ROW(1) T760_GEMM_STORE_ROW(2) T760_GEMM_STORE_ROW(3)
+    T760_GEMM_STORE_ROW(4) T760_GEMM_STORE_ROW(5) T760_GEMM_STORE_ROW(6) T760_GEMM_STORE_ROW(7)
+#undef T760_GEMM_STORE_ROW
+}
+
+} // namespace t760::kernels::isa
+
+#endif
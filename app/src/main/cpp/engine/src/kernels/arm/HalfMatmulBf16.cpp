@@ -0,0 +1,78 @@
+#include "t760_engine/kernels/HalfMatmul.h"
+#include "t760_engine/tensor/Float16.h"
+#include <vector>
+
+// Built with +bf16 (see CMakeLists.txt); only entered when HWCAP2 reports
+// bf16 (Cortex-A78C / X1C and later; the T760's A76 and A55 do not).
+#if defined(__aarch64__) && defined(__ARM_FEATURE_BF16_VECTOR_ARITHMETIC)
+#include <arm_neon.h>
+
+namespace t760::kernels::isa {
+
+namespace {
+// Rows sharing each activation load.
+constexpr int64_t ROW_BLOCK = 4;
+
+inline bfloat16x8_t load_bf16x8(const uint16_t* src) { return vreinterpretq_bf16_u16(vld1q_u16(src)); }
+
+// The activation row rounded to BF16 with bfcvtn / bfcvtn2
+// (round-to-nearest-even), eight lanes at a time.
+const uint16_t* round_to_bf16(const float* x, int64_t k) {
+    thread_local std::vector<uint16_t> row;
+    row.resize(static_cast<size_t>(k));
+    int64_t p = 0;
+    for (; p + 8 <= k; p += 8) {
+        const bfloat16x8_t low = vcvtq_low_bf16_f32(vld1q_f32(x + p));
+        vst1q_u16(row.data() + p, vreinterpretq_u16_bf16(vcvtq_high_bf16_f32(low, vld1q_f32(x + p + 4))));
+    }
+    for (; p < k; ++p) {
+        row[p] = fp32_to_bf16(x[p]);
+    }
+    return row.data();
+}
+}
+
+// bfdot: each FP32 lane accumulates the products of one pair of BF16
+// elements, eight weights per instruction with no widening step. bfmmla
+// would need two activation rows and so only pays off in prefill, which runs
+// the FP32 panel kernel.
+void gemv_bf16_neon_bf16(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y) {
+    const uint16_t* xb = round_to_bf16(x, k);
+    const int64_t k8 = k & ~int64_t{7};
+    auto tail = [&](const uint16_t* wr) {
+        float sum = 0.0f;
+        for (int64_t p = k8; p < k; ++p) {
+            sum += bf16_to_fp32(wr[p]) * bf16_to_fp32(xb[p]);
+        }
+        return sum;
+    };
+    int64_t r = 0;
+    for (; r + ROW_BLOCK <= rows; r += ROW_BLOCK) {
+        const uint16_t* wr[ROW_BLOCK] = {w + r * k, w + (r + 1) * k, w + (r + 2) * k, w + (r + 3) * k};
+        float32x4_t acc[ROW_BLOCK];
+        for (int64_t j = 0; j < ROW_BLOCK; ++j) {
+            acc[j] = vdupq_n_f32(0.0f);
+        }
+        for (int64_t p = 0; p < k8; p += 8) {
+            const bfloat16x8_t xv = load_bf16x8(xb + p);
+            for (int64_t j = 0; j < ROW_BLOCK; ++j) {
+                acc[j] = vbfdotq_f32(acc[j], load_bf16x8(wr[j] + p), xv);
+            }
+        }
+        for (int64_t j = 0; j < ROW_BLOCK; ++j) {
+            y[r + j] = vaddvq_f32(acc[j]) + tail(wr[j]);
+        }
+    }
+    for (; r < rows; ++r) {
+        const uint16_t* wr = w + r * k;
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        for (int64_t p = 0; p < k8; p += 8) {
+            acc = vbfdotq_f32(acc, load_bf16x8(wr + p), load_bf16x8(xb + p));
+        }
+        y[r] = vaddvq_f32(acc) + tail(wr);
+    }
+}
+
+} // namespace t760::kernels::isa
+
+#endif
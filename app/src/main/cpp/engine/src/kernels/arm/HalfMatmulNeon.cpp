@@ -0,0 +1,104 @@
+#include "t760_engine/kernels/HalfMatmul.h"
+#include "t760_engine/tensor/Float16.h"
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+
+namespace t760::kernels::isa {
+
+namespace {
+// Rows sharing each activation load.
+constexpr int64_t ROW_BLOCK = 4;
+
+// fcvtl / fcvtl2: baseline AArch64, no +fp16 needed for the conversion.
+inline void widen_f16(const uint16_t* src, float32x4_t& lo, float32x4_t& hi) {
+    const float16x8_t h = vreinterpretq_f16_u16(vld1q_u16(src));
+    lo = vcvt_f32_f16(vget_low_f16(h));
+    hi = vcvt_high_f32_f16(h);
+}
+
+// BF16 is the upper half of an FP32: a widening shift by 16 (shll / shll2).
+inline void widen_bf16(const uint16_t* src, float32x4_t& lo, float32x4_t& hi) {
+    const uint16x8_t h = vld1q_u16(src);
+    lo = vreinterpretq_f32_u32(vshll_n_u16(vget_low_u16(h), 16));
+    hi = vreinterpretq_f32_u32(vshll_high_n_u16(h, 16));
+}
+
+// Streams ROW_BLOCK rows at a time against one load of x, with two FP32
+// accumulators per row; the k % 8 tail is scalar.
+template <void (*Widen)(const uint16_t*, float32x4_t&, float32x4_t&), float (*WidenOne)(uint16_t)>
+void gemv_with(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y) {
+    const int64_t k8 = k & ~int64_t{7};
+    int64_t r = 0;
+    for (; r + ROW_BLOCK <= rows; r += ROW_BLOCK) {
+        const uint16_t* wr[ROW_BLOCK] = {w + r * k, w + (r + 1) * k, w + (r + 2) * k, w + (r + 3) * k};
+        float32x4_t acc_lo[ROW_BLOCK];
+        float32x4_t acc_hi[ROW_BLOCK];
+        for (int64_t j = 0; j < ROW_BLOCK; ++j) {
+            acc_lo[j] = vdupq_n_f32(0.0f);
+            acc_hi[j] = vdupq_n_f32(0.0f);
+        }
+        for (int64_t p = 0; p < k8; p += 8) {
+            const float32x4_t x_lo = vld1q_f32(x + p);
+            const float32x4_t x_hi = vld1q_f32(x + p + 4);
+            for (int64_t j = 0; j < ROW_BLOCK; ++j) {
+                float32x4_t w_lo;
+                float32x4_t w_hi;
+                Widen(wr[j] + p, w_lo, w_hi);
+                acc_lo[j] = vfmaq_f32(acc_lo[j], w_lo, x_lo);
+                acc_hi[j] = vfmaq_f32(acc_hi[j], w_hi, x_hi);
+            }
+        }
+        for (int64_t j = 0; j < ROW_BLOCK; ++j) {
+            float sum = vaddvq_f32(vaddq_f32(acc_lo[j], acc_hi[j]));
+            for (int64_t p = k8; p < k; ++p) {
+                sum += WidenOne(wr[j][p]) * x[p];
+            }
+            y[r + j] = sum;
+        }
+    }
+    for (; r < rows; ++r) {
+        const uint16_t* wr = w + r * k;
+        float32x4_t acc_lo = vdupq_n_f32(0.0f);
+        float32x4_t acc_hi = vdupq_n_f32(0.0f);
+        for (int64_t p = 0; p < k8; p += 8) {
+            float32x4_t w_lo;
+            float32x4_t w_hi;
+            Widen(wr + p, w_lo, w_hi);
+            acc_lo = vfmaq_f32(acc_lo, w_lo, vld1q_f32(x + p));
+            acc_hi = vfmaq_f32(acc_hi, w_hi, vld1q_f32(x + p + 4));
+        }
+        float sum = vaddvq_f32(vaddq_f32(acc_lo, acc_hi));
+        for (int64_t p = k8; p < k; ++p) {
+            sum += WidenOne(wr[p]) * x[p];
+        }
+        y[r] = sum;
+    }
+}
+}
+
+void gemv_f16_neon(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y) {
+    gemv_with<widen_f16, fp16_to_fp32>(w, rows, k, x, y);
+}
+
+void gemv_bf16_neon(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y) {
+    gemv_with<widen_bf16, bf16_to_fp32>(w, rows, k, x, y);
+}
+
+void convert_bf16_to_f32_neon(const uint16_t* src, float* dst, int64_t n) {
+    int64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t lo;
+        float32x4_t hi;
+        widen_bf16(src + i, lo, hi);
+        vst1q_f32(dst + i, lo);
+        vst1q_f32(dst + i + 4, hi);
+    }
+    for (; i < n; ++i) {
+        dst[i] = bf16_to_fp32(src[i]);
+    }
+}
+
+} // namespace t760::kernels::isa
+
+#endif
@@ -0,0 +1,172 @@
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include "t760_engine/core/Constants.h"
+
+// Built with +dotprod (see CMakeLists.txt); only entered when HWCAP_ASIMDDP is set.
+#if defined(__aarch64__) && defined(__ARM_FEATURE_DOTPROD)
+#include <arm_neon.h>
+
+namespace t760::kernels::isa {
+
+namespace {
+constexpr int64_t GROUP = constants::QUANT_GROUP_SIZE;
+
+inline int32x4_t sdot_group(const int8_t* w, const int8_t* x) {
+    int32x4_t acc = vdupq_n_s32(0);
+    acc = vdotq_s32(acc, vld1q_s8(w), vld1q_s8(x));
+    acc = vdotq_s32(acc, vld1q_s8(w + 16), vld1q_s8(x + 16));
+    acc = vdotq_s32(acc, vld1q_s8(w + 32), vld1q_s8(x + 32));
+    acc = vdotq_s32(acc, vld1q_s8(w + 48), vld1q_s8(x + 48));
+    return acc;
+}
+
+inline int32x4_t sdot_group_q4(const uint8_t* packed, const int8_t* x) {
+    const uint8x16_t mask = vdupq_n_u8(0x0F);
+    const int8x16_t bias = vdupq_n_s8(8);
+    const uint8x16_t b0 = vld1q_u8(packed);
+    const uint8x16_t b1 = vld1q_u8(packed + 16);
+    int32x4_t acc = vdupq_n_s32(0);
+    acc = vdotq_s32(acc, vsubq_s8(vreinterpretq_s8_u8(vandq_u8(b0, mask)), bias), vld1q_s8(x));
+    acc = vdotq_s32(acc, vsubq_s8(vreinterpretq_s8_u8(vandq_u8(b1, mask)), bias), vld1q_s8(x + 16));
+    acc = vdotq_s32(acc, vsubq_s8(vreinterpretq_s8_u8(vshrq_n_u8(b0, 4)), bias), vld1q_s8(x + 32));
+    acc = vdotq_s32(acc, vsubq_s8(vreinterpretq_s8_u8(vshrq_n_u8(b1, 4)), bias), vld1q_s8(x + 48));
+    return acc;
+}
+
+// Activation rows sharing each weight group load in the W8A8 GEMM.
+constexpr int64_t ACT_BLOCK = 4;
+
+inline int32x4_t sdot_unpacked(const int8x16_t w[4], const int8_t* x) {
+    int32x4_t acc = vdupq_n_s32(0);
+    acc = vdotq_s32(acc, w[0], vld1q_s8(x));
+    acc = vdotq_s32(acc, w[1], vld1q_s8(x + 16));
+    acc = vdotq_s32(acc, w[2], vld1q_s8(x + 32));
+    acc = vdotq_s32(acc, w[3], vld1q_s8(x + 48));
+    return acc;
+}
+
+struct Q8Group {
+    const int8_t* w;
+    int64_t k;
+    void operator()(int64_t r, int64_t g, int8x16_t out[4]) const {
+        const int8_t* src = w + r * k + g * GROUP;
+        out[0] = vld1q_s8(src);
+        out[1] = vld1q_s8(src + 16);
+        out[2] = vld1q_s8(src + 32);
+        out[3] = vld1q_s8(src + 48);
+    }
+};
+
+struct Q4Group {
+    const uint8_t* w;
+    int64_t k;
+    void operator()(int64_t r, int64_t g, int8x16_t out[4]) const {
+        const uint8x16_t mask = vdupq_n_u8(0x0F);
+        const int8x16_t bias = vdupq_n_s8(8);
+        const uint8_t* packed = w + r * (k / 2) + g * (GROUP / 2);
+        const uint8x16_t b0 = vld1q_u8(packed);
+        const uint8x16_t b1 = vld1q_u8(packed + 16);
+        out[0] = vsubq_s8(vreinterpretq_s8_u8(vandq_u8(b0, mask)), bias);
+        out[1] = vsubq_s8(vreinterpretq_s8_u8(vandq_u8(b1, mask)), bias);
+        out[2] = vsubq_s8(vreinterpretq_s8_u8(vshrq_n_u8(b0, 4)), bias);
+        out[3] = vsubq_s8(vreinterpretq_s8_u8(vshrq_n_u8(b1, 4)), bias);
+    }
+};
+
+// Each weight group is loaded (and for Q4 unpacked) once per ACT_BLOCK
+// activation rows; two pairwise adds reduce the four accumulators at once.
+template <typename LoadGroup>
+void gemm_isums_with(const LoadGroup& load, int64_t rows, int64_t k, const int8_t* xq, int64_t m, int32_t* isums) {
+    const int64_t groups = k / GROUP;
+    const int64_t stride = rows * groups;
+    int64_t i = 0;
+    for (; i + ACT_BLOCK <= m; i += ACT_BLOCK) {
+        const int8_t* x0 = xq + i * k;
+        const int8_t* x1 = x0 + k;
+        const int8_t* x2 = x1 + k;
+        const int8_t* x3 = x2 + k;
+        for (int64_t r = 0; r < rows; ++r) {
+            int32_t* out = isums + i * stride + r * groups;
+            for (int64_t g = 0; g < groups; ++g) {
+                const int64_t off = g * GROUP;
+                int8x16_t wv[4];
+                load(r, g, wv);
+                const int32x4_t sums = vpaddq_s32(vpaddq_s32(sdot_unpacked(wv, x0 + off), sdot_unpacked(wv, x1 + off)),
+                                                  vpaddq_s32(sdot_unpacked(wv, x2 + off), sdot_unpacked(wv, x3 + off)));
+                out[g] = vgetq_lane_s32(sums, 0);
+                out[stride + g] = vgetq_lane_s32(sums, 1);
+                out[2 * stride + g] = vgetq_lane_s32(sums, 2);
+                out[3 * stride + g] = vgetq_lane_s32(sums, 3);
+            }
+        }
+    }
+    for (; i < m; ++i) {
+        const int8_t* xr = xq + i * k;
+        for (int64_t r = 0; r < rows; ++r) {
+            int32_t* out = isums + i * stride + r * groups;
+            for (int64_t g = 0; g < groups; ++g) {
+                int8x16_t wv[4];
+                load(r, g, wv);
+                out[g] = vaddvq_s32(sdot_unpacked(wv, xr + g * GROUP));
+            }
+        }
+    }
+}
+}
+
+void gemv_q8_isums_dotprod(const int8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums) {
+    const int64_t groups = k / GROUP;
+    int64_t r = 0;
+    // Four rows share every activation load; the A76 retires two sdot per cycle.
+    for (; r + 4 <= rows; r += 4) {
+        const int8_t* w0 = w + r * k;
+        for (int64_t g = 0; g < groups; ++g) {
+            const int64_t off = g * GROUP;
+            const int8_t* xg = xq + off;
+            isums[r * groups + g] = vaddvq_s32(sdot_group(w0 + off, xg));
+            isums[(r + 1) * groups + g] = vaddvq_s32(sdot_group(w0 + k + off, xg));
+            isums[(r + 2) * groups + g] = vaddvq_s32(sdot_group(w0 + 2 * k + off, xg));
+            isums[(r + 3) * groups + g] = vaddvq_s32(sdot_group(w0 + 3 * k + off, xg));
+        }
+    }
+    for (; r < rows; ++r) {
+        const int8_t* wr = w + r * k;
+        for (int64_t g = 0; g < groups; ++g) {
+            isums[r * groups + g] = vaddvq_s32(sdot_group(wr + g * GROUP, xq + g * GROUP));
+        }
+    }
+}
+
+void gemv_q4_isums_dotprod(const uint8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums) {
+    const int64_t groups = k / GROUP;
+    const int64_t row_bytes = k / 2;
+    int64_t r = 0;
+    for (; r + 4 <= rows; r += 4) {
+        const uint8_t* w0 = w + r * row_bytes;
+        for (int64_t g = 0; g < groups; ++g) {
+            const int64_t off = g * (GROUP / 2);
+            const int8_t* xg = xq + g * GROUP;
+            isums[r * groups + g] = vaddvq_s32(sdot_group_q4(w0 + off, xg));
+            isums[(r + 1) * groups + g] = vaddvq_s32(sdot_group_q4(w0 + row_bytes + off, xg));
+            isums[(r + 2) * groups + g] = vaddvq_s32(sdot_group_q4(w0 + 2 * row_bytes + off, xg));
+            isums[(r + 3) * groups + g] = vaddvq_s32(sdot_group_q4(w0 + 3 * row_bytes + off, xg));
+        }
+    }
+    for (; r < rows; ++r) {
+        const uint8_t* wr = w + r * row_bytes;
+        for (int64_t g = 0; g < groups; ++g) {
+            isums[r * groups + g] = vaddvq_s32(sdot_group_q4(wr + g * (GROUP / 2), xq + g * GROUP));
+        }
+    }
+}
+
+void gemm_q8_isums_dotprod(const int8_t* w, int64_t rows, int64_t k, const int8_t* xq, int64_t m, int32_t* isums) {
+    gemm_isums_with(Q8Group{w, k}, rows, k, xq, m, isums);
+}
+
+void gemm_q4_isums_dotprod(const uint8_t* w, int64_t rows, int64_t k, const int8_t* xq, int64_t m, int32_t* isums) {
+    gemm_isums_with(Q4Group{w, k}, rows, k, xq, m, isums);
+}
+
+} // namespace t760::kernels::isa
+
+#endif // __aarch64__ && __ARM_FEATURE_DOTPROD
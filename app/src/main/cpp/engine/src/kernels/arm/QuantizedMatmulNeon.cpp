@@ -0,0 +1,134 @@
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include "t760_engine/core/Constants.h"
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+
+namespace t760::kernels::isa {
+
+namespace {
+constexpr int64_t GROUP = constants::QUANT_GROUP_SIZE;
+
+// Widening multiply-accumulate of one 64-element group, for cores without
+// the dot product extension (Cortex-A55 builds that lack asimddp).
+inline int32x4_t dot_group(int32x4_t acc, const int8_t* w, const int8_t* x) {
+    for (int64_t j = 0; j < GROUP; j += 16) {
+        const int8x16_t wv = vld1q_s8(w + j);
+        const int8x16_t xv = vld1q_s8(x + j);
+        acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(wv), vget_low_s8(xv)));
+        acc = vpadalq_s16(acc, vmull_high_s8(wv, xv));
+    }
+    return acc;
+}
+
+// Expands one packed QINT4 group into four int8x16 vectors covering elements
+// [0,16), [16,32), [32,48) and [48,64).
+inline void unpack_q4_group(const uint8_t* packed, int8x16_t out[4]) {
+    const uint8x16_t mask = vdupq_n_u8(0x0F);
+    const int8x16_t bias = vdupq_n_s8(8);
+    const uint8x16_t b0 = vld1q_u8(packed);
+    const uint8x16_t b1 = vld1q_u8(packed + 16);
+    out[0] = vsubq_s8(vreinterpretq_s8_u8(vandq_u8(b0, mask)), bias);
+    out[1] = vsubq_s8(vreinterpretq_s8_u8(vandq_u8(b1, mask)), bias);
+    out[2] = vsubq_s8(vreinterpretq_s8_u8(vshrq_n_u8(b0, 4)), bias);
+    out[3] = vsubq_s8(vreinterpretq_s8_u8(vshrq_n_u8(b1, 4)), bias);
+}
+
+inline int32_t dot_group_q4(const uint8_t* packed, const int8_t* x) {
+    int8x16_t wv[4];
+    unpack_q4_group(packed, wv);
+    int32x4_t acc = vdupq_n_s32(0);
+    for (int j = 0; j < 4; ++j) {
+        const int8x16_t xv = vld1q_s8(x + 16 * j);
+        acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(wv[j]), vget_low_s8(xv)));
+        acc = vpadalq_s16(acc, vmull_high_s8(wv[j], xv));
+    }
+    return vaddvq_s32(acc);
+}
+}
+
+void gemv_q8_isums_neon(const int8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums) {
+    const int64_t groups = k / GROUP;
+    int64_t r = 0;
+    for (; r + 2 <= rows; r += 2) {
+        const int8_t* w0 = w + r * k;
+        const int8_t* w1 = w0 + k;
+        for (int64_t g = 0; g < groups; ++g) {
+            const int8_t* xg = xq + g * GROUP;
+            const int32x4_t acc0 = dot_group(vdupq_n_s32(0), w0 + g * GROUP, xg);
+            const int32x4_t acc1 = dot_group(vdupq_n_s32(0), w1 + g * GROUP, xg);
+            isums[r * groups + g] = vaddvq_s32(acc0);
+            isums[(r + 1) * groups + g] = vaddvq_s32(acc1);
+        }
+    }
+    for (; r < rows; ++r) {
+        const int8_t* wr = w + r * k;
+        for (int64_t g = 0; g < groups; ++g) {
+            isums[r * groups + g] = vaddvq_s32(dot_group(vdupq_n_s32(0), wr + g * GROUP, xq + g * GROUP));
+        }
+    }
+}
+
+void gemv_q4_isums_neon(const uint8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums) {
+    const int64_t groups = k / GROUP;
+    for (int64_t r = 0; r < rows; ++r) {
+        const uint8_t* wr = w + r * (k / 2);
+        for (int64_t g = 0; g < groups; ++g) {
+            isums[r * groups + g] = dot_group_q4(wr + g * (GROUP / 2), xq + g * GROUP);
+        }
+    }
+}
+
+void gemm_panel_f32_neon(const float* a, int64_t m, int64_t k, const float* panel, float* c, int64_t ldc, int64_t nr) {
+    const float* p0 = panel;
+    const float* p1 = panel + k;
+    const float* p2 = panel + 2 * k;
+    const float* p3 = panel + 3 * k;
+
+    int64_t i = 0;
+    // 4 activation rows x 4 weight rows: 16 accumulators, 8 operand registers.
+    for (; i + 4 <= m; i += 4) {
+        const float* a0 = a + i * k;
+        const float* a1 = a0 + k;
+        const float* a2 = a1 + k;
+        const float* a3 = a2 + k;
+        float32x4_t acc[4][4];
+        for (auto& row : acc) {
+            for (auto& v : row) v = vdupq_n_f32(0.0f);
+        }
+        for (int64_t p = 0; p < k; p += 4) {
+            const float32x4_t av[4] = {vld1q_f32(a0 + p), vld1q_f32(a1 + p), vld1q_f32(a2 + p), vld1q_f32(a3 + p)};
+            const float32x4_t wv[4] = {vld1q_f32(p0 + p), vld1q_f32(p1 + p), vld1q_f32(p2 + p), vld1q_f32(p3 + p)};
+            for (int ii = 0; ii < 4; ++ii) {
+                acc[ii][0] = vfmaq_f32(acc[ii][0], av[ii], wv[0]);
+                acc[ii][1] = vfmaq_f32(acc[ii][1], av[ii], wv[1]);
+                acc[ii][2] = vfmaq_f32(acc[ii][2], av[ii], wv[2]);
+                acc[ii][3] = vfmaq_f32(acc[ii][3], av[ii], wv[3]);
+            }
+        }
+        for (int ii = 0; ii < 4; ++ii) {
+            for (int64_t j = 0; j < nr; ++j) {
+                c[(i + ii) * ldc + j] = vaddvq_f32(acc[ii][j]);
+            }
+        }
+    }
+    for (; i < m; ++i) {
+        const float* ar = a + i * k;
+        float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+        for (int64_t p = 0; p < k; p += 4) {
+            const float32x4_t av = vld1q_f32(ar + p);
+            acc0 = vfmaq_f32(acc0, av, vld1q_f32(p0 + p));
+            acc1 = vfmaq_f32(acc1, av, vld1q_f32(p1 + p));
+            acc2 = vfmaq_f32(acc2, av, vld1q_f32(p2 + p));
+            acc3 = vfmaq_f32(acc3, av, vld1q_f32(p3 + p));
+        }
+        const float sums[4] = {vaddvq_f32(acc0), vaddvq_f32(acc1), vaddvq_f32(acc2), vaddvq_f32(acc3)};
+        for (int64_t j = 0; j < nr; ++j) {
+            c[i * ldc + j] = sums[j];
+        }
+    }
+}
+
+} // namespace t760::kernels::isa
+
+#endif // __aarch64__
@@ -0,0 +1,114 @@
+#include "t760_engine/kernels/Sampling.h"
+#include <cmath>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+
+namespace t760::kernels::isa {
+
+namespace {
+
+// Cephes expf, as in the AVX2 tier: x = n ln2 + r, a degree-6 polynomial for
+// e^r and 2^n built in the exponent field.
+inline float32x4_t exp_f32x4(float32x4_t x) {
+    x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(-87.3365f)), vdupq_n_f32(88.3762f));
+    const float32x4_t n = vrndnq_f32(vmulq_n_f32(x, 1.44269504088896341f));
+    float32x4_t r = vfmsq_f32(x, n, vdupq_n_f32(0.693359375f));
+    r = vfmsq_f32(r, n, vdupq_n_f32(-2.12194440e-4f));
+    float32x4_t p = vdupq_n_f32(1.9875691500e-4f);
+    p = vfmaq_f32(vdupq_n_f32(1.3981999507e-3f), p, r);
+    p = vfmaq_f32(vdupq_n_f32(8.3334519073e-3f), p, r);
+    p = vfmaq_f32(vdupq_n_f32(4.1665795894e-2f), p, r);
+    p = vfmaq_f32(vdupq_n_f32(1.6666665459e-1f), p, r);
+    p = vfmaq_f32(vdupq_n_f32(5.0000001201e-1f), p, r);
+    p = vfmaq_f32(vaddq_f32(r, vdupq_n_f32(1.0f)), p, vmulq_f32(r, r));
+    const int32x4_t bits = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23);
+    return vmulq_f32(p, vreinterpretq_f32_s32(bits));
+}
+
+} // namespace
+
+float max_f32_neon(const float* x, int64_t n) {
+    const float lowest = -std::numeric_limits<float>::infinity();
+    float32x4_t m0 = vdupq_n_f32(lowest);
+    float32x4_t m1 = m0;
+    float32x4_t m2 = m0;
+    float32x4_t m3 = m0;
+    int64_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        m0 = vmaxq_f32(m0, vld1q_f32(x + i));
+        m1 = vmaxq_f32(m1, vld1q_f32(x + i + 4));
+        m2 = vmaxq_f32(m2, vld1q_f32(x + i + 8));
+        m3 = vmaxq_f32(m3, vld1q_f32(x + i + 12));
+    }
+    float result = vmaxvq_f32(vmaxq_f32(vmaxq_f32(m0, m1), vmaxq_f32(m2, m3)));
+    for (; i < n; ++i) {
+        result = std::max(result, x[i]);
+    }
+    return result;
+}
+
+int64_t find_at_least_f32_neon(const float* x, int64_t n, float threshold) {
+    const float32x4_t t = vdupq_n_f32(threshold);
+    int64_t i = 0;
+    // 16 logits per test; the exact lane is only looked for on a hit.
+    for (; i + 16 <= n; i += 16) {
+        const uint32x4_t c0 = vcgeq_f32(vld1q_f32(x + i), t);
+        const uint32x4_t c1 = vcgeq_f32(vld1q_f32(x + i + 4), t);
+        const uint32x4_t c2 = vcgeq_f32(vld1q_f32(x + i + 8), t);
+        const uint32x4_t c3 = vcgeq_f32(vld1q_f32(x + i + 12), t);
+        if (vmaxvq_u32(vorrq_u32(vorrq_u32(c0, c1), vorrq_u32(c2, c3))) != 0) {
+            break;
+        }
+    }
+    for (; i < n; ++i) {
+        if (x[i] >= threshold) {
+            return i;
+        }
+    }
+    return n;
+}
+
+float exp_sum_f32_neon(const float* x, int64_t n, float shift, float scale, float* out) {
+    const float32x4_t s = vdupq_n_f32(shift);
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t e = exp_f32x4(vmulq_n_f32(vsubq_f32(vld1q_f32(x + i), s), scale));
+        vst1q_f32(out + i, e);
+        acc = vaddq_f32(acc, e);
+    }
+    float sum = vaddvq_f32(acc);
+    for (; i < n; ++i) {
+        out[i] = std::exp((x[i] - shift) * scale);
+        sum += out[i];
+    }
+    return sum;
+}
+
+void mask_f32_neon(float* x, int64_t n, const uint64_t* bits) {
+    static const uint32_t LANE_BITS[4] = {1, 2, 4, 8};
+    const uint32x4_t lane_bits = vld1q_u32(LANE_BITS);
+    const float32x4_t lowest = vdupq_n_f32(-std::numeric_limits<float>::infinity());
+    int64_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        const uint64_t word = bits[i >> 6];
+        if (word == ~uint64_t{0}) {
+            continue; // Typical of free text: nothing to lower
+        }
+        for (int b = 0; b < 16; ++b) {
+            const uint32x4_t nibble = vdupq_n_u32(static_cast<uint32_t>((word >> (4 * b)) & 0xF));
+            const uint32x4_t keep = vtstq_u32(nibble, lane_bits);
+            vst1q_f32(x + i + 4 * b, vbslq_f32(keep, vld1q_f32(x + i + 4 * b), lowest));
+        }
+    }
+    for (; i < n; ++i) {
+        if (((bits[i >> 6] >> (i & 63)) & 1) == 0) {
+            x[i] = -std::numeric_limits<float>::infinity();
+        }
+    }
+}
+
+} // namespace t760::kernels::isa
+
+#endif
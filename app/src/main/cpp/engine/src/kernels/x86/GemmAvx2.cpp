@@ -0,0 +1,55 @@
+#include "t760_engine/kernels/Gemm.h"
+
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__AVX2__) && defined(__FMA__) && defined(__F16C__)
+#include <immintrin.h>
+
+namespace t760::kernels::isa {
+
+// 6x16 tile: twelve accumulators, two b registers and one broadcast. The
+// accumulators are named variables so they stay in registers at -O2.
+void gemm_micro_f32_avx2(int64_t kc, const float* a_panel, const float* b_panel, float* c, int64_t ldc, bool accumulate) {
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+    __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+
+    for (int64_t p = 0; p < kc; ++p) {
+        const __m256 b0 = _mm256_loadu_ps(b_panel + p * 16);
+        const __m256 b1 = _mm256_loadu_ps(b_panel + p * 16 + 8);
+        const float* a = a_panel + p * 6;
+        __m256 av;
+        av = _mm256_broadcast_ss(a + 0); c00 = _mm256_fmadd_ps(av, b0, c00); c01 = _mm256_fmadd_ps(av, b1, c01);
+        av = _mm256_broadcast_ss(a + 1); c10 = _mm256_fmadd_ps(av, b0, c10); c11 = _mm256_fmadd_ps(av, b1, c11);
+        av = _mm256_broadcast_ss(a + 2); c20 = _mm256_fmadd_ps(av, b0, c20); c21 = _mm256_fmadd_ps(av, b1, c21);
+        av = _mm256_broadcast_ss(a + 3); c30 = _mm256_fmadd_ps(av, b0, c30); c31 = _mm256_fmadd_ps(av, b1, c31);
+        av = _mm256_broadcast_ss(a + 4); c40 = _mm256_fmadd_ps(av, b0, c40); c41 = _mm256_fmadd_ps(av, b1, c41);
+        av = _mm256_broadcast_ss(a + 5); c50 = _mm256_fmadd_ps(av, b0, c50); c51 = _mm256_fmadd_ps(av, b1, c51);
+    }
+
+    auto store = [accumulate](float* dst, __m256 value) {
+        _mm256_storeu_ps(dst, accumulate ? _mm256_add_ps(_mm256_loadu_ps(dst), value) : value);
+    };
+    store(c + 0 * ldc, c00); store(c + 0 * ldc + 8, c01);
+    store(c + 1 * ldc, c10); store(c + 1 * ldc + 8, c11);
+    store(c + 2 * ldc, c20); store(c + 2 * ldc + 8, c21);
+    store(c + 3 * ldc, c30); store(c + 3 * ldc + 8, c31);
+    store(c + 4 * ldc, c40); store(c + 4 * ldc + 8, c41);
+    store(c + 5 * ldc, c50); store(c + 5 * ldc + 8, c51);
+}
+
+void convert_f16_to_f32_f16c(const uint16_t* src, float* dst, int64_t n) {
+    int64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+    for (; i < n; ++i) {
+        dst[i] = _cvtsh_ss(src[i]);
+    }
+}
+
+} // namespace t760::kernels::isa
+
+#endif
@@ -0,0 +1,37 @@
+#include "t760_engine/kernels/Gemm.h"
+
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__SSE4_1__)
+#include <smmintrin.h>
+
+namespace t760::kernels::isa {
+
+// 4x8 tile: eight accumulators, no FMA on this tier.
+void gemm_micro_f32_sse41(int64_t kc, const float* a_panel, const float* b_panel, float* c, int64_t ldc, bool accumulate) {
+    __m128 c00 = _mm_setzero_ps(), c01 = _mm_setzero_ps();
+    __m128 c10 = _mm_setzero_ps(), c11 = _mm_setzero_ps();
+    __m128 c20 = _mm_setzero_ps(), c21 = _mm_setzero_ps();
+    __m128 c30 = _mm_setzero_ps(), c31 = _mm_setzero_ps();
+
+    for (int64_t p = 0; p < kc; ++p) {
+        const __m128 b0 = _mm_loadu_ps(b_panel + p * 8);
+        const __m128 b1 = _mm_loadu_ps(b_panel + p * 8 + 4);
+        const float* a = a_panel + p * 4;
+        __m128 av;
+        av = _mm_set1_ps(a[0]); c00 = _mm_add_ps(c00, _mm_mul_ps(av, b0)); c01 = _mm_add_ps(c01, _mm_mul_ps(av, b1));
+        av = _mm_set1_ps(a[1]); c10 = _mm_add_ps(c10, _mm_mul_ps(av, b0)); c11 = _mm_add_ps(c11, _mm_mul_ps(av, b1));
+        av = _mm_set1_ps(a[2]); c20 = _mm_add_ps(c20, _mm_mul_ps(av, b0)); c21 = _mm_add_ps(c21, _mm_mul_ps(av, b1));
+        av = _mm_set1_ps(a[3]); c30 = _mm_add_ps(c30, _mm_mul_ps(av, b0)); c31 = _mm_add_ps(c31, _mm_mul_ps(av, b1));
+    }
+
+    auto store = [accumulate](float* dst, __m128 value) {
+        _mm_storeu_ps(dst, accumulate ? _mm_add_ps(_mm_loadu_ps(dst), value) : value);
+    };
+    store(c + 0 * ldc, c00); store(c + 0 * ldc + 4, c01);
+    store(c + 1 * ldc, c10); store(c + 1 * ldc + 4, c11);
+    store(c + 2 * ldc, c20); store(c + 2 * ldc + 4, c21);
+    store(c + 3 * ldc, c30); store(c + 3 * ldc + 4, c31);
+}
+
+} // namespace t760::kernels::isa
+
+#endif
@@ -0,0 +1,103 @@
+#include "t760_engine/kernels/HalfMatmul.h"
+#include "t760_engine/tensor/Float16.h"
+
+// Built with -mavx2 -mfma -mf16c (see CMakeLists.txt); only entered after a cpuid check.
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__AVX2__) && defined(__FMA__) && defined(__F16C__)
+#include <immintrin.h>
+
+namespace t760::kernels::isa {
+
+namespace {
+// Rows sharing each activation load.
+constexpr int64_t ROW_BLOCK = 4;
+
+inline float hsum_ps(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(s);
+}
+
+inline __m256 widen_f16(const uint16_t* src) {
+    return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+}
+
+// BF16 is the upper half of an FP32: zero-extend and shift into place.
+inline __m256 widen_bf16(const uint16_t* src) {
+    const __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(wide, 16));
+}
+
+// Streams ROW_BLOCK rows at a time against one load of x, with one FP32
+// accumulator per row; the k % 8 tail is scalar.
+template <__m256 (*Widen)(const uint16_t*), float (*WidenOne)(uint16_t)>
+void gemv_with(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y) {
+    const int64_t k8 = k & ~int64_t{7};
+    int64_t r = 0;
+    for (; r + ROW_BLOCK <= rows; r += ROW_BLOCK) {
+        const uint16_t* w0 = w + r * k;
+        const uint16_t* w1 = w0 + k;
+        const uint16_t* w2 = w1 + k;
+        const uint16_t* w3 = w2 + k;
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        __m256 acc2 = _mm256_setzero_ps();
+        __m256 acc3 = _mm256_setzero_ps();
+        for (int64_t p = 0; p < k8; p += 8) {
+            const __m256 xv = _mm256_loadu_ps(x + p);
+            acc0 = _mm256_fmadd_ps(Widen(w0 + p), xv, acc0);
+            acc1 = _mm256_fmadd_ps(Widen(w1 + p), xv, acc1);
+            acc2 = _mm256_fmadd_ps(Widen(w2 + p), xv, acc2);
+            acc3 = _mm256_fmadd_ps(Widen(w3 + p), xv, acc3);
+        }
+        float s0 = hsum_ps(acc0);
+        float s1 = hsum_ps(acc1);
+        float s2 = hsum_ps(acc2);
+        float s3 = hsum_ps(acc3);
+        for (int64_t p = k8; p < k; ++p) {
+            s0 += WidenOne(w0[p]) * x[p];
+            s1 += WidenOne(w1[p]) * x[p];
+            s2 += WidenOne(w2[p]) * x[p];
+            s3 += WidenOne(w3[p]) * x[p];
+        }
+        y[r] = s0;
+        y[r + 1] = s1;
+        y[r + 2] = s2;
+        y[r + 3] = s3;
+    }
+    for (; r < rows; ++r) {
+        const uint16_t* wr = w + r * k;
+        __m256 acc = _mm256_setzero_ps();
+        for (int64_t p = 0; p < k8; p += 8) {
+            acc = _mm256_fmadd_ps(Widen(wr + p), _mm256_loadu_ps(x + p), acc);
+        }
+        float sum = hsum_ps(acc);
+        for (int64_t p = k8; p < k; ++p) {
+            sum += WidenOne(wr[p]) * x[p];
+        }
+        y[r] = sum;
+    }
+}
+}
+
+void gemv_f16_avx2(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y) {
+    gemv_with<widen_f16, fp16_to_fp32>(w, rows, k, x, y);
+}
+
+void gemv_bf16_avx2(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y) {
+    gemv_with<widen_bf16, bf16_to_fp32>(w, rows, k, x, y);
+}
+
+void convert_bf16_to_f32_avx2(const uint16_t* src, float* dst, int64_t n) {
+    int64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(dst + i, widen_bf16(src + i));
+    }
+    for (; i < n; ++i) {
+        dst[i] = bf16_to_fp32(src[i]);
+    }
+}
+
+} // namespace t760::kernels::isa
+
+#endif
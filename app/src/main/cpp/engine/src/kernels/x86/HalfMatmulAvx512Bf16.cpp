@@ -0,0 +1,101 @@
+#include "t760_engine/kernels/HalfMatmul.h"
+#include "t760_engine/tensor/Float16.h"
+#include <vector>
+
+// Built with -mavx512f -mavx512bw -mavx512vl -mavx512bf16 -mfma -mf16c (see
+// CMakeLists.txt); only entered after a cpuid check.
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__AVX512F__) && defined(__AVX512BF16__)
+#include <immintrin.h>
+
+namespace t760::kernels::isa {
+
+namespace {
+// Rows sharing each activation load.
+constexpr int64_t ROW_BLOCK = 4;
+
+// Same bits; the BF16 vector type only exists to type vdpbf16ps operands.
+inline __m512bh as_bf16(__m512i v) { return (__m512bh)v; }
+
+inline __m512i load_bf16x32(const uint16_t* src) { return _mm512_loadu_si512(src); }
+
+// The activation row rounded to BF16 with vcvtne2ps2bf16 (round-to-nearest-
+// even; denormals flush to zero), 32 lanes at a time.
+const uint16_t* round_to_bf16(const float* x, int64_t k) {
+    thread_local std::vector<uint16_t> row;
+    row.resize(static_cast<size_t>(k));
+    int64_t p = 0;
+    for (; p + 32 <= k; p += 32) {
+        const __m512bh pair = _mm512_cvtne2ps_pbh(_mm512_loadu_ps(x + p + 16), _mm512_loadu_ps(x + p));
+        _mm512_storeu_si512(row.data() + p, (__m512i)pair);
+    }
+    for (; p < k; ++p) {
+        row[p] = fp32_to_bf16(x[p]);
+    }
+    return row.data();
+}
+}
+
+void gemv_f16_avx512(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y) {
+    const int64_t k16 = k & ~int64_t{15};
+    for (int64_t r = 0; r < rows; ++r) {
+        const uint16_t* wr = w + r * k;
+        __m512 acc = _mm512_setzero_ps();
+        for (int64_t p = 0; p < k16; p += 16) {
+            const __m512 wv = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(wr + p)));
+            acc = _mm512_fmadd_ps(wv, _mm512_loadu_ps(x + p), acc);
+        }
+        float sum = _mm512_reduce_add_ps(acc);
+        for (int64_t p = k16; p < k; ++p) {
+            sum += fp16_to_fp32(wr[p]) * x[p];
+        }
+        y[r] = sum;
+    }
+}
+
+// vdpbf16ps: each FP32 lane accumulates the products of one pair of BF16
+// elements, 32 weights per instruction with no widening step.
+void gemv_bf16_avx512_bf16(const uint16_t* w, int64_t rows, int64_t k, const float* x, float* y) {
+    const uint16_t* xb = round_to_bf16(x, k);
+    const int64_t k32 = k & ~int64_t{31};
+    auto tail = [&](const uint16_t* wr) {
+        float sum = 0.0f;
+        for (int64_t p = k32; p < k; ++p) {
+            sum += bf16_to_fp32(wr[p]) * bf16_to_fp32(xb[p]);
+        }
+        return sum;
+    };
+    int64_t r = 0;
+    for (; r + ROW_BLOCK <= rows; r += ROW_BLOCK) {
+        const uint16_t* w0 = w + r * k;
+        const uint16_t* w1 = w0 + k;
+        const uint16_t* w2 = w1 + k;
+        const uint16_t* w3 = w2 + k;
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+        __m512 acc2 = _mm512_setzero_ps();
+        __m512 acc3 = _mm512_setzero_ps();
+        for (int64_t p = 0; p < k32; p += 32) {
+            const __m512bh xv = as_bf16(load_bf16x32(xb + p));
+            acc0 = _mm512_dpbf16_ps(acc0, as_bf16(load_bf16x32(w0 + p)), xv);
+            acc1 = _mm512_dpbf16_ps(acc1, as_bf16(load_bf16x32(w1 + p)), xv);
+            acc2 = _mm512_dpbf16_ps(acc2, as_bf16(load_bf16x32(w2 + p)), xv);
+            acc3 = _mm512_dpbf16_ps(acc3, as_bf16(load_bf16x32(w3 + p)), xv);
+        }
+        y[r] = _mm512_reduce_add_ps(acc0) + tail(w0);
+        y[r + 1] = _mm512_reduce_add_ps(acc1) + tail(w1);
+        y[r + 2] = _mm512_reduce_add_ps(acc2) + tail(w2);
+        y[r + 3] = _mm512_reduce_add_ps(acc3) + tail(w3);
+    }
+    for (; r < rows; ++r) {
+        const uint16_t* wr = w + r * k;
+        __m512 acc = _mm512_setzero_ps();
+        for (int64_t p = 0; p < k32; p += 32) {
+            acc = _mm512_dpbf16_ps(acc, as_bf16(load_bf16x32(wr + p)), as_bf16(load_bf16x32(xb + p)));
+        }
+        y[r] = _mm512_reduce_add_ps(acc) + tail(wr);
+    }
+}
+
+} // namespace t760::kernels::isa
+
+#endif
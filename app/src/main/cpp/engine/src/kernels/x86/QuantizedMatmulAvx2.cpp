@@ -0,0 +1,232 @@
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include "t760_engine/core/Constants.h"
+
+// Built with -mavx2 -mfma (see CMakeLists.txt); only entered after a cpuid check.
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+
+namespace t760::kernels::isa {
+
+namespace {
+constexpr int64_t GROUP = constants::QUANT_GROUP_SIZE;
+
+inline int32_t hsum_epi32(__m256i v) {
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+inline float hsum_ps(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(s);
+}
+
+inline __m256i dot32(__m256i acc, const int8_t* w, const int8_t* x) {
+    const __m256i wv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w));
+    const __m256i xv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x));
+    const __m256i prod = _mm256_maddubs_epi16(_mm256_sign_epi8(xv, xv), _mm256_sign_epi8(wv, xv));
+    return _mm256_add_epi32(acc, _mm256_madd_epi16(prod, _mm256_set1_epi16(1)));
+}
+
+inline int32_t dot_group(const int8_t* w, const int8_t* x) {
+    __m256i acc = dot32(_mm256_setzero_si256(), w, x);
+    acc = dot32(acc, w + 32, x + 32);
+    return hsum_epi32(acc);
+}
+
+inline __m256i dot32_unpacked(__m256i acc, __m256i wv, const int8_t* x) {
+    const __m256i xv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x));
+    const __m256i prod = _mm256_maddubs_epi16(_mm256_sign_epi8(xv, xv), _mm256_sign_epi8(wv, xv));
+    return _mm256_add_epi32(acc, _mm256_madd_epi16(prod, _mm256_set1_epi16(1)));
+}
+
+// One 32-byte load yields the whole group: low nibbles are elements [0,32),
+// high nibbles [32,64).
+inline int32_t dot_group_q4(const uint8_t* packed, const int8_t* x) {
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    const __m256i bias = _mm256_set1_epi8(8);
+    const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(packed));
+    const __m256i lo = _mm256_sub_epi8(_mm256_and_si256(bytes, mask), bias);
+    const __m256i hi = _mm256_sub_epi8(_mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask), bias);
+    __m256i acc = dot32_unpacked(_mm256_setzero_si256(), lo, x);
+    acc = dot32_unpacked(acc, hi, x + 32);
+    return hsum_epi32(acc);
+}
+
+// Activation rows sharing each weight group load in the W8A8 GEMM.
+constexpr int64_t ACT_BLOCK = 4;
+
+inline __m256i dot_group_unpacked(__m256i lo, __m256i hi, const int8_t* x) {
+    return dot32_unpacked(dot32_unpacked(_mm256_setzero_si256(), lo, x), hi, x + 32);
+}
+
+// The totals of four accumulators, in order: one hadd tree instead of four
+// horizontal sums.
+inline __m128i hsum4_epi32(__m256i a0, __m256i a1, __m256i a2, __m256i a3) {
+    const __m256i s = _mm256_hadd_epi32(_mm256_hadd_epi32(a0, a1), _mm256_hadd_epi32(a2, a3));
+    return _mm_add_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+}
+
+struct Q8Group {
+    const int8_t* w;
+    int64_t k;
+    void operator()(int64_t r, int64_t g, __m256i& lo, __m256i& hi) const {
+        const int8_t* src = w + r * k + g * GROUP;
+        lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+    }
+};
+
+struct Q4Group {
+    const uint8_t* w;
+    int64_t k;
+    void operator()(int64_t r, int64_t g, __m256i& lo, __m256i& hi) const {
+        const __m256i mask = _mm256_set1_epi8(0x0F);
+        const __m256i bias = _mm256_set1_epi8(8);
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + r * (k / 2) + g * (GROUP / 2)));
+        lo = _mm256_sub_epi8(_mm256_and_si256(bytes, mask), bias);
+        hi = _mm256_sub_epi8(_mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask), bias);
+    }
+};
+
+// Each weight group is loaded (and for Q4 unpacked) once per ACT_BLOCK
+// activation rows.
+template <typename LoadGroup>
+void gemm_isums_with(const LoadGroup& load, int64_t rows, int64_t k, const int8_t* xq, int64_t m, int32_t* isums) {
+    const int64_t groups = k / GROUP;
+    const int64_t stride = rows * groups;
+    int64_t i = 0;
+    for (; i + ACT_BLOCK <= m; i += ACT_BLOCK) {
+        const int8_t* x0 = xq + i * k;
+        const int8_t* x1 = x0 + k;
+        const int8_t* x2 = x1 + k;
+        const int8_t* x3 = x2 + k;
+        for (int64_t r = 0; r < rows; ++r) {
+            int32_t* out = isums + i * stride + r * groups;
+            for (int64_t g = 0; g < groups; ++g) {
+                const int64_t off = g * GROUP;
+                __m256i lo, hi;
+                load(r, g, lo, hi);
+                const __m128i sums = hsum4_epi32(dot_group_unpacked(lo, hi, x0 + off), dot_group_unpacked(lo, hi, x1 + off),
+                                                 dot_group_unpacked(lo, hi, x2 + off), dot_group_unpacked(lo, hi, x3 + off));
+                out[g] = _mm_cvtsi128_si32(sums);
+                out[stride + g] = _mm_extract_epi32(sums, 1);
+                out[2 * stride + g] = _mm_extract_epi32(sums, 2);
+                out[3 * stride + g] = _mm_extract_epi32(sums, 3);
+            }
+        }
+    }
+    for (; i < m; ++i) {
+        const int8_t* xr = xq + i * k;
+        for (int64_t r = 0; r < rows; ++r) {
+            int32_t* out = isums + i * stride + r * groups;
+            for (int64_t g = 0; g < groups; ++g) {
+                __m256i lo, hi;
+                load(r, g, lo, hi);
+                out[g] = hsum_epi32(dot_group_unpacked(lo, hi, xr + g * GROUP));
+            }
+        }
+    }
+}
+}
+
+void gemv_q8_isums_avx2(const int8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums) {
+    const int64_t groups = k / GROUP;
+    int64_t r = 0;
+    for (; r + 2 <= rows; r += 2) {
+        const int8_t* w0 = w + r * k;
+        const int8_t* w1 = w0 + k;
+        for (int64_t g = 0; g < groups; ++g) {
+            const int64_t off = g * GROUP;
+            isums[r * groups + g] = dot_group(w0 + off, xq + off);
+            isums[(r + 1) * groups + g] = dot_group(w1 + off, xq + off);
+        }
+    }
+    for (; r < rows; ++r) {
+        const int8_t* wr = w + r * k;
+        for (int64_t g = 0; g < groups; ++g) {
+            isums[r * groups + g] = dot_group(wr + g * GROUP, xq + g * GROUP);
+        }
+    }
+}
+
+void gemv_q4_isums_avx2(const uint8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums) {
+    const int64_t groups = k / GROUP;
+    const int64_t row_bytes = k / 2;
+    int64_t r = 0;
+    for (; r + 2 <= rows; r += 2) {
+        const uint8_t* w0 = w + r * row_bytes;
+        const uint8_t* w1 = w0 + row_bytes;
+        for (int64_t g = 0; g < groups; ++g) {
+            const int64_t off = g * (GROUP / 2);
+            isums[r * groups + g] = dot_group_q4(w0 + off, xq + g * GROUP);
+            isums[(r + 1) * groups + g] = dot_group_q4(w1 + off, xq + g * GROUP);
+        }
+    }
+    for (; r < rows; ++r) {
+        const uint8_t* wr = w + r * row_bytes;
+        for (int64_t g = 0; g < groups; ++g) {
+            isums[r * groups + g] = dot_group_q4(wr + g * (GROUP / 2), xq + g * GROUP);
+        }
+    }
+}
+
+void gemm_q8_isums_avx2(const int8_t* w, int64_t rows, int64_t k, const int8_t* xq, int64_t m, int32_t* isums) {
+    gemm_isums_with(Q8Group{w, k}, rows, k, xq, m, isums);
+}
+
+void gemm_q4_isums_avx2(const uint8_t* w, int64_t rows, int64_t k, const int8_t* xq, int64_t m, int32_t* isums) {
+    gemm_isums_with(Q4Group{w, k}, rows, k, xq, m, isums);
+}
+
+void gemm_panel_f32_avx2(const float* a, int64_t m, int64_t k, const float* panel, float* c, int64_t ldc, int64_t nr) {
+    const float* p0 = panel;
+    const float* p1 = panel + k;
+    const float* p2 = panel + 2 * k;
+    const float* p3 = panel + 3 * k;
+
+    int64_t i = 0;
+    // 2 activation rows x 4 weight rows: 8 accumulators + 6 operands fit in 16 ymm.
+    for (; i + 2 <= m; i += 2) {
+        const float* a0 = a + i * k;
+        const float* a1 = a0 + k;
+        __m256 acc[2][4];
+        for (auto& row : acc) {
+            for (auto& v : row) v = _mm256_setzero_ps();
+        }
+        for (int64_t p = 0; p < k; p += 8) {
+            const __m256 av0 = _mm256_loadu_ps(a0 + p);
+            const __m256 av1 = _mm256_loadu_ps(a1 + p);
+            const __m256 wv[4] = {_mm256_loadu_ps(p0 + p), _mm256_loadu_ps(p1 + p), _mm256_loadu_ps(p2 + p), _mm256_loadu_ps(p3 + p)};
+            for (int j = 0; j < 4; ++j) {
+                acc[0][j] = _mm256_fmadd_ps(av0, wv[j], acc[0][j]);
+                acc[1][j] = _mm256_fmadd_ps(av1, wv[j], acc[1][j]);
+            }
+        }
+        for (int64_t j = 0; j < nr; ++j) {
+            c[i * ldc + j] = hsum_ps(acc[0][j]);
+            c[(i + 1) * ldc + j] = hsum_ps(acc[1][j]);
+        }
+    }
+    for (; i < m; ++i) {
+        const float* ar = a + i * k;
+        __m256 acc[4] = {_mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps()};
+        for (int64_t p = 0; p < k; p += 8) {
+            const __m256 av = _mm256_loadu_ps(ar + p);
+            acc[0] = _mm256_fmadd_ps(av, _mm256_loadu_ps(p0 + p), acc[0]);
+            acc[1] = _mm256_fmadd_ps(av, _mm256_loadu_ps(p1 + p), acc[1]);
+            acc[2] = _mm256_fmadd_ps(av, _mm256_loadu_ps(p2 + p), acc[2]);
+            acc[3] = _mm256_fmadd_ps(av, _mm256_loadu_ps(p3 + p), acc[3]);
+        }
+        for (int64_t j = 0; j < nr; ++j) {
+            c[i * ldc + j] = hsum_ps(acc[j]);
+        }
+    }
+}
+
+} // namespace t760::kernels::isa
+
+#endif // x86_64 && __AVX2__ && __FMA__
@@ -0,0 +1,125 @@
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include "t760_engine/core/Constants.h"
+
+// Built with -msse4.1 (see CMakeLists.txt); only entered after a cpuid check.
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__SSE4_1__)
+#include <immintrin.h>
+
+namespace t760::kernels::isa {
+
+namespace {
+constexpr int64_t GROUP = constants::QUANT_GROUP_SIZE;
+
+inline int32_t hsum_epi32(__m128i v) {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+
+inline float hsum_ps(__m128 v) {
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(v);
+}
+
+// |x| * sign(x) * w with pmaddubsw. Both operands are in [-127, 127], so the
+// paired int16 sums cannot saturate.
+inline int32_t dot_group(const int8_t* w, const int8_t* x) {
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i acc = _mm_setzero_si128();
+    for (int64_t j = 0; j < GROUP; j += 16) {
+        const __m128i wv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + j));
+        const __m128i xv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + j));
+        const __m128i prod = _mm_maddubs_epi16(_mm_sign_epi8(xv, xv), _mm_sign_epi8(wv, xv));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(prod, ones));
+    }
+    return hsum_epi32(acc);
+}
+
+inline __m128i dot16(__m128i acc, __m128i wv, const int8_t* x) {
+    const __m128i xv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x));
+    const __m128i prod = _mm_maddubs_epi16(_mm_sign_epi8(xv, xv), _mm_sign_epi8(wv, xv));
+    return _mm_add_epi32(acc, _mm_madd_epi16(prod, _mm_set1_epi16(1)));
+}
+
+inline int32_t dot_group_q4(const uint8_t* packed, const int8_t* x) {
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i bias = _mm_set1_epi8(8);
+    const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(packed));
+    const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(packed + 16));
+    __m128i acc = _mm_setzero_si128();
+    acc = dot16(acc, _mm_sub_epi8(_mm_and_si128(b0, mask), bias), x);
+    acc = dot16(acc, _mm_sub_epi8(_mm_and_si128(b1, mask), bias), x + 16);
+    acc = dot16(acc, _mm_sub_epi8(_mm_and_si128(_mm_srli_epi16(b0, 4), mask), bias), x + 32);
+    acc = dot16(acc, _mm_sub_epi8(_mm_and_si128(_mm_srli_epi16(b1, 4), mask), bias), x + 48);
+    return hsum_epi32(acc);
+}
+}
+
+void gemv_q8_isums_sse41(const int8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums) {
+    const int64_t groups = k / GROUP;
+    for (int64_t r = 0; r < rows; ++r) {
+        const int8_t* wr = w + r * k;
+        for (int64_t g = 0; g < groups; ++g) {
+            isums[r * groups + g] = dot_group(wr + g * GROUP, xq + g * GROUP);
+        }
+    }
+}
+
+void gemv_q4_isums_sse41(const uint8_t* w, int64_t rows, int64_t k, const int8_t* xq, int32_t* isums) {
+    const int64_t groups = k / GROUP;
+    for (int64_t r = 0; r < rows; ++r) {
+        const uint8_t* wr = w + r * (k / 2);
+        for (int64_t g = 0; g < groups; ++g) {
+            isums[r * groups + g] = dot_group_q4(wr + g * (GROUP / 2), xq + g * GROUP);
+        }
+    }
+}
+
+void gemm_panel_f32_sse41(const float* a, int64_t m, int64_t k, const float* panel, float* c, int64_t ldc, int64_t nr) {
+    const float* p0 = panel;
+    const float* p1 = panel + k;
+    const float* p2 = panel + 2 * k;
+    const float* p3 = panel + 3 * k;
+
+    int64_t i = 0;
+    for (; i + 2 <= m; i += 2) {
+        const float* a0 = a + i * k;
+        const float* a1 = a0 + k;
+        __m128 acc[2][4];
+        for (auto& row : acc) {
+            for (auto& v : row) v = _mm_setzero_ps();
+        }
+        for (int64_t p = 0; p < k; p += 4) {
+            const __m128 av0 = _mm_loadu_ps(a0 + p);
+            const __m128 av1 = _mm_loadu_ps(a1 + p);
+            const __m128 wv[4] = {_mm_loadu_ps(p0 + p), _mm_loadu_ps(p1 + p), _mm_loadu_ps(p2 + p), _mm_loadu_ps(p3 + p)};
+            for (int j = 0; j < 4; ++j) {
+                acc[0][j] = _mm_add_ps(acc[0][j], _mm_mul_ps(av0, wv[j]));
+                acc[1][j] = _mm_add_ps(acc[1][j], _mm_mul_ps(av1, wv[j]));
+            }
+        }
+        for (int64_t j = 0; j < nr; ++j) {
+            c[i * ldc + j] = hsum_ps(acc[0][j]);
+            c[(i + 1) * ldc + j] = hsum_ps(acc[1][j]);
+        }
+    }
+    for (; i < m; ++i) {
+        const float* ar = a + i * k;
+        __m128 acc[4] = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+        for (int64_t p = 0; p < k; p += 4) {
+            const __m128 av = _mm_loadu_ps(ar + p);
+            acc[0] = _mm_add_ps(acc[0], _mm_mul_ps(av, _mm_loadu_ps(p0 + p)));
+            acc[1] = _mm_add_ps(acc[1], _mm_mul_ps(av, _mm_loadu_ps(p1 + p)));
+            acc[2] = _mm_add_ps(acc[2], _mm_mul_ps(av, _mm_loadu_ps(p2 + p)));
+            acc[3] = _mm_add_ps(acc[3], _mm_mul_ps(av, _mm_loadu_ps(p3 + p)));
+        }
+        for (int64_t j = 0; j < nr; ++j) {
+            c[i * ldc + j] = hsum_ps(acc[j]);
+        }
+    }
+}
+
+} // namespace t760::kernels::isa
+
+#endif // x86_64 && __SSE4_1__
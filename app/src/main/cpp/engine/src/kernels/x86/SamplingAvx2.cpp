@@ -0,0 +1,130 @@
+#include "t760_engine/kernels/Sampling.h"
+#include <cmath>
+
+// Built with -mavx2 -mfma -mf16c (see CMakeLists.txt); only entered after a cpuid check.
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+
+namespace t760::kernels::isa {
+
+namespace {
+
+inline float hmax_ps(__m256 v) {
+    __m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+    m = _mm_max_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(m);
+}
+
+inline float hsum_ps(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(s);
+}
+
+// Cephes expf: x = n ln2 + r with |r| <= ln2 / 2, a degree-6 polynomial for
+// e^r, and 2^n built in the exponent field. About 2 ulp over the clamped range.
+inline __m256 exp_ps(__m256 x) {
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-87.3365f)), _mm256_set1_ps(88.3762f));
+    const __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                                     _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), x);
+    r = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4f), r);
+    __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+    p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+    const __m256i bits = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(bits));
+}
+
+} // namespace
+
+float max_f32_avx2(const float* x, int64_t n) {
+    const float lowest = -std::numeric_limits<float>::infinity();
+    __m256 m0 = _mm256_set1_ps(lowest);
+    __m256 m1 = m0;
+    __m256 m2 = m0;
+    __m256 m3 = m0;
+    int64_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        m0 = _mm256_max_ps(m0, _mm256_loadu_ps(x + i));
+        m1 = _mm256_max_ps(m1, _mm256_loadu_ps(x + i + 8));
+        m2 = _mm256_max_ps(m2, _mm256_loadu_ps(x + i + 16));
+        m3 = _mm256_max_ps(m3, _mm256_loadu_ps(x + i + 24));
+    }
+    float result = hmax_ps(_mm256_max_ps(_mm256_max_ps(m0, m1), _mm256_max_ps(m2, m3)));
+    for (; i < n; ++i) {
+        result = std::max(result, x[i]);
+    }
+    return result;
+}
+
+int64_t find_at_least_f32_avx2(const float* x, int64_t n, float threshold) {
+    const __m256 t = _mm256_set1_ps(threshold);
+    int64_t i = 0;
+    // 32 logits per test; the exact lane is only looked for on a hit.
+    for (; i + 32 <= n; i += 32) {
+        const __m256 c0 = _mm256_cmp_ps(_mm256_loadu_ps(x + i), t, _CMP_GE_OQ);
+        const __m256 c1 = _mm256_cmp_ps(_mm256_loadu_ps(x + i + 8), t, _CMP_GE_OQ);
+        const __m256 c2 = _mm256_cmp_ps(_mm256_loadu_ps(x + i + 16), t, _CMP_GE_OQ);
+        const __m256 c3 = _mm256_cmp_ps(_mm256_loadu_ps(x + i + 24), t, _CMP_GE_OQ);
+        if (_mm256_movemask_ps(_mm256_or_ps(_mm256_or_ps(c0, c1), _mm256_or_ps(c2, c3))) != 0) {
+            break;
+        }
+    }
+    for (; i < n; ++i) {
+        if (x[i] >= threshold) {
+            return i;
+        }
+    }
+    return n;
+}
+
+float exp_sum_f32_avx2(const float* x, int64_t n, float shift, float scale, float* out) {
+    const __m256 s = _mm256_set1_ps(shift);
+    const __m256 k = _mm256_set1_ps(scale);
+    __m256 acc = _mm256_setzero_ps();
+    int64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 e = exp_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x + i), s), k));
+        _mm256_storeu_ps(out + i, e);
+        acc = _mm256_add_ps(acc, e);
+    }
+    float sum = hsum_ps(acc);
+    for (; i < n; ++i) {
+        out[i] = std::exp((x[i] - shift) * scale);
+        sum += out[i];
+    }
+    return sum;
+}
+
+void mask_f32_avx2(float* x, int64_t n, const uint64_t* bits) {
+    const __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256 lowest = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+    int64_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        const uint64_t word = bits[i >> 6];
+        if (word == ~uint64_t{0}) {
+            continue; // Typical of free text: nothing to lower
+        }
+        for (int b = 0; b < 8; ++b) {
+            const __m256i byte = _mm256_set1_epi32(static_cast<int>((word >> (8 * b)) & 0xFF));
+            const __m256 keep = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(byte, lane_bits), lane_bits));
+            _mm256_storeu_ps(x + i + 8 * b, _mm256_blendv_ps(lowest, _mm256_loadu_ps(x + i + 8 * b), keep));
+        }
+    }
+    for (; i < n; ++i) {
+        if (((bits[i >> 6] >> (i & 63)) & 1) == 0) {
+            x[i] = -std::numeric_limits<float>::infinity();
+        }
+    }
+}
+
+} // namespace t760::kernels::isa
+
+#endif
@@ -18,8 +18,9 @@ Tensor* Model::get_tensor(const std::string& name) {
     return (it != tensor_map_.end()) ? it->second : nullptr;
 }
 
-void Model::assign_tensors(std::vector<std::unique_ptr<Tensor>> tensors) {
-    if (tensors.size() != config_->tensor_metadata_table.size()) { throw std::runtime_error("Tensor count mismatch."); }
+void Model::assign_tensors(std::vector<std::unique_ptr<Tensor>> tensors,
+                           const std::unordered_map<std::string, std::string>& aliases) {
+    if (tensors.size() + aliases.size() != config_->tensor_metadata_table.size()) { throw std::runtime_error("Tensor count mismatch."); }
     owned_tensors_ = std::move(tensors);
     tensor_map_.clear();
     execution_ordered_tensors_.clear();
@@ -28,6 +29,11 @@ void Model::assign_tensors(std::vector<std::unique_ptr<Tensor>> tensors) {
     for (const auto& tensor_ptr : owned_tensors_) {
         tensor_map_[tensor_ptr->get_name()] = tensor_ptr.get();
     }
+    for (const auto& [alias, target] : aliases) {
+        Tensor* tensor = get_tensor(target);
+        if (!tensor) { throw std::runtime_error("Alias target not found: " + target); }
+        tensor_map_[alias] = tensor;
+    }
     for (const auto& meta : config_->tensor_metadata_table) {
         std::string tensor_name(meta.name);
         Tensor* tensor = get_tensor(tensor_name);
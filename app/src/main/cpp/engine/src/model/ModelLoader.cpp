@@ -2,13 +2,46 @@
 #include "t760_engine/model/T760FormatParser.h"
 #include <fstream>
 #include <stdexcept>
+#include <cstring>
 #include <iostream>
+#include <map>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace t760 {
 
-ModelLoader::ModelLoader(TensorManager& tensor_manager)
-    : tensor_manager_(tensor_manager) {}
+namespace {
+
+// Two table entries describe the same stored tensor when they point at the
+// same bytes with the same type and shape.
+bool same_stored_tensor(const TensorMetadata& a, const TensorMetadata& b) {
+    return a.offset == b.offset && a.stored_size == b.stored_size && a.data_type == b.data_type &&
+           std::memcmp(a.dims, b.dims, sizeof(a.dims)) == 0;
+}
+
+// Bytes per element of the types the precision policy may convert between.
+size_t float_element_size(DataType type) {
+    switch (type) {
+        case DataType::FP32: return 4;
+        case DataType::FP16:
+        case DataType::BF16: return 2;
+        default: return 0;
+    }
+}
+
+const char* data_type_name(DataType type) {
+    switch (type) {
+        case DataType::FP32: return "FP32";
+        case DataType::FP16: return "FP16";
+        default: return "BF16";
+    }
+}
+
+}
+
+ModelLoader::ModelLoader(TensorManager& tensor_manager, const WeightPrecisionPolicy& precision)
+    : tensor_manager_(tensor_manager), precision_(precision) {}
 
 ModelLoader::~ModelLoader() {
     unload_model();
@@ -47,8 +80,33 @@ bool ModelLoader::load_model(const std::string& model_path) {
         std::vector<std::unique_ptr<Tensor>> tensors;
         const auto& metadata_table = loaded_model_->get_config().tensor_metadata_table;
         tensors.reserve(metadata_table.size());
+        // Entries sharing stored data (a tied lm_head written as a second
+        // name for the embedding) are loaded once and aliased.
+        std::map<std::pair<uint64_t, uint64_t>, const TensorMetadata*> loaded_blocks;
+        std::unordered_map<std::string, std::string> aliases;
+        // CPU matrices the precision policy may convert are read here first so
+        // that it can inspect their values; one buffer serves every tensor.
+        std::vector<char> staged;
+        size_t converted = 0;
+        uint64_t stored_bytes = 0;
+        uint64_t loaded_bytes = 0;
+        auto read_block = [&](const TensorMetadata& meta, void* dst) {
+            model_file.seekg(meta.offset);
+            model_file.read(static_cast<char*>(dst), meta.stored_size);
+            if (!model_file) {
+                throw std::runtime_error("Failed to read tensor data for: " + std::string(meta.name));
+            }
+        };
 
         for (const auto& meta : metadata_table) {
+            auto block = loaded_blocks.find({meta.offset, meta.stored_size});
+            if (block != loaded_blocks.end() && same_stored_tensor(*block->second, meta)) {
+                aliases.emplace(std::string(meta.name), std::string(block->second->name));
+                std::cout << "Tensor " << meta.name << " shares storage with " << block->second->name << std::endl;
+                continue;
+            }
+            loaded_blocks.emplace(std::make_pair(meta.offset, meta.stored_size), &meta);
+
             TensorShape shape;
             for (const auto& dim : meta.dims) {
                 if (dim > 0) shape.dims.push_back(dim);
@@ -58,8 +116,18 @@ bool ModelLoader::load_model(const std::string& model_path) {
             DataType data_type = static_cast<DataType>(meta.data_type);
             MemoryUsage mem_usage = MemoryUsage::HOST_VISIBLE_COHERENT;
 
+            DataType load_type = data_type;
+            const size_t element_size = float_element_size(data_type);
+            const bool stage = target_device == DeviceType::CPU && may_convert_weight(precision_, data_type, shape) &&
+                               meta.stored_size == shape.num_elements() * element_size;
+            if (stage) {
+                staged.resize(meta.stored_size);
+                read_block(meta, staged.data());
+                load_type = choose_weight_precision(precision_, data_type, shape, staged.data());
+            }
+
             std::unique_ptr<Tensor> tensor = tensor_manager_.create_tensor(
-                std::string(meta.name), shape, data_type, target_device, TensorLayout::DENSE, mem_usage
+                std::string(meta.name), shape, load_type, target_device, TensorLayout::DENSE, mem_usage
             );
 
             void* buffer_ptr = tensor->get_data();
@@ -67,16 +135,34 @@ bool ModelLoader::load_model(const std::string& model_path) {
                 throw std::runtime_error("Failed to get mapped pointer for tensor: " + std::string(meta.name));
             }
 
-            model_file.seekg(meta.offset);
-            model_file.read(static_cast<char*>(buffer_ptr), meta.stored_size);
-            if (!model_file) {
-                throw std::runtime_error("Failed to read tensor data for: " + std::string(meta.name));
+            if (load_type != data_type) {
+                convert_weights(data_type, staged.data(), load_type, buffer_ptr,
+                                static_cast<int64_t>(shape.num_elements()));
+                std::cout << "Tensor " << meta.name << " converted " << data_type_name(data_type) << " -> "
+                          << data_type_name(load_type) << std::endl;
+                ++converted;
+                stored_bytes += meta.stored_size;
+                loaded_bytes += tensor->get_size_in_bytes();
+            } else if (stage) {
+                std::memcpy(buffer_ptr, staged.data(), meta.stored_size);
+            } else {
+                // Quantized tensors carry their per-group scales inside stored_size,
+                // so the on-disk block must fit the buffer sized for quants + scales.
+                if (meta.stored_size > tensor->get_size_in_bytes()) {
+                    throw std::runtime_error("Stored tensor data exceeds its allocated size: " + std::string(meta.name));
+                }
+                read_block(meta, buffer_ptr);
             }
 
             tensors.push_back(std::move(tensor));
         }
 
-        loaded_model_->assign_tensors(std::move(tensors));
+        if (converted > 0) {
+            std::cout << "Weight precision (" << to_string(precision_.mode) << "): converted " << converted
+                      << " tensors, " << (stored_bytes >> 20) << " MB -> " << (loaded_bytes >> 20) << " MB"
+                      << std::endl;
+        }
+        loaded_model_->assign_tensors(std::move(tensors), aliases);
         std::cout << "Model loaded successfully into memory." << std::endl;
 
     } catch (const std::exception& e) {
@@ -0,0 +1,113 @@
+#include "t760_engine/model/WeightPrecision.h"
+#include "t760_engine/tensor/Float16.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace t760 {
+
+namespace {
+
+// Largest finite binary16 value.
+constexpr float FP16_MAX = 65504.0f;
+
+inline float load_float(DataType type, const void* data, size_t i) {
+    switch (type) {
+        case DataType::FP32: return static_cast<const float*>(data)[i];
+        case DataType::FP16: return fp16_to_fp32(static_cast<const uint16_t*>(data)[i]);
+        case DataType::BF16: return bf16_to_fp32(static_cast<const uint16_t*>(data)[i]);
+        default: throw std::runtime_error("Weight conversion supports FP32, FP16 and BF16 only.");
+    }
+}
+
+bool fits_fp16_range(const float* data, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (!(std::fabs(data[i]) <= FP16_MAX)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// BF16 carries 8 significant bits to FP16's 11, so only the exponent can fail
+// to convert: values past FP16_MAX or below its subnormal precision.
+bool bf16_is_exact_in_fp16(const uint16_t* data, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const float value = bf16_to_fp32(data[i]);
+        if (fp16_to_fp32(fp32_to_fp16(value)) != value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+WeightPrecisionPolicy make_weight_precision_policy(WeightPrecision mode, const CpuCapabilities& caps) {
+    WeightPrecisionPolicy policy;
+    policy.mode = mode;
+    policy.has_bf16_dot = (caps.has_neon_support && caps.has_bf16) || (caps.has_avx512 && caps.has_avx512_bf16);
+    return policy;
+}
+
+bool may_convert_weight(const WeightPrecisionPolicy& policy, DataType stored, const TensorShape& shape) {
+    const bool floating = stored == DataType::FP32 || stored == DataType::FP16 || stored == DataType::BF16;
+    if (!floating || shape.rank() < 2) {
+        return false;
+    }
+    switch (policy.mode) {
+        case WeightPrecision::AS_STORED: return false;
+        case WeightPrecision::FP32: return stored != DataType::FP32;
+        case WeightPrecision::AUTO:
+            return stored == DataType::FP32 || (stored == DataType::BF16 && !policy.has_bf16_dot);
+    }
+    return false;
+}
+
+DataType choose_weight_precision(const WeightPrecisionPolicy& policy, DataType stored, const TensorShape& shape,
+                                 const void* data) {
+    if (!may_convert_weight(policy, stored, shape)) {
+        return stored;
+    }
+    if (policy.mode == WeightPrecision::FP32) {
+        return DataType::FP32;
+    }
+    const size_t count = shape.num_elements();
+    if (stored == DataType::FP32) {
+        return fits_fp16_range(static_cast<const float*>(data), count) ? DataType::FP16 : DataType::BF16;
+    }
+    return bf16_is_exact_in_fp16(static_cast<const uint16_t*>(data), count) ? DataType::FP16 : DataType::BF16;
+}
+
+void convert_weights(DataType from, const void* src, DataType to, void* dst, int64_t count) {
+    const size_t n = static_cast<size_t>(count);
+    switch (to) {
+        case DataType::FP32:
+            for (size_t i = 0; i < n; ++i) {
+                static_cast<float*>(dst)[i] = load_float(from, src, i);
+            }
+            break;
+        case DataType::FP16:
+            for (size_t i = 0; i < n; ++i) {
+                static_cast<uint16_t*>(dst)[i] = fp32_to_fp16(load_float(from, src, i));
+            }
+            break;
+        case DataType::BF16:
+            for (size_t i = 0; i < n; ++i) {
+                static_cast<uint16_t*>(dst)[i] = fp32_to_bf16(load_float(from, src, i));
+            }
+            break;
+        default:
+            throw std::runtime_error("Weight conversion supports FP32, FP16 and BF16 only.");
+    }
+}
+
+const char* to_string(WeightPrecision mode) {
+    switch (mode) {
+        case WeightPrecision::AUTO: return "auto";
+        case WeightPrecision::AS_STORED: return "as-stored";
+        case WeightPrecision::FP32: return "fp32";
+    }
+    return "unknown";
+}
+
+}
@@ -1,14 +1,337 @@
 #include "t760_engine/pipeline/ExecutionScheduler.h"
+#include "t760_engine/tensor/QuantizedLayout.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
 #include <stdexcept>
+#include <string>
+#include <thread>
 
 namespace t760 {
 
-ExecutionScheduler::ExecutionScheduler(const Model& model, const DeviceManager& device_manager)
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* device_name(DeviceType device) {
+    switch (device) {
+        case DeviceType::CPU: return "CPU";
+        case DeviceType::GPU: return "GPU";
+        case DeviceType::NPU: return "NPU";
+        case DeviceType::SHARED: return "SHARED";
+    }
+    return "unknown";
+}
+
+double to_ms(Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); }
+
+} // namespace
+
+// --- ExecutionGraph ---
+
+ExecutionGraph::NodeId ExecutionGraph::add(LayerTask task, std::initializer_list<NodeId> after) {
+    const NodeId id = nodes_.size();
+    for (NodeId before : after) {
+        if (before >= id) {
+            throw std::invalid_argument("ExecutionGraph nodes may only depend on earlier nodes.");
+        }
+    }
+    nodes_.push_back(Node{std::move(task), std::vector<NodeId>(after)});
+    return id;
+}
+
+void ExecutionGraph::add_dependency(NodeId node, NodeId before) {
+    if (node >= nodes_.size() || before >= node) {
+        throw std::invalid_argument("ExecutionGraph nodes may only depend on earlier nodes.");
+    }
+    nodes_[node].predecessors.push_back(before);
+}
+
+ExecutionGraph::NodeId ExecutionGraph::add_chain(std::vector<LayerTask> tasks, std::initializer_list<NodeId> after) {
+    if (tasks.empty()) {
+        throw std::invalid_argument("ExecutionGraph chain must contain at least one layer.");
+    }
+    NodeId last = add(std::move(tasks[0]), after);
+    for (size_t i = 1; i < tasks.size(); ++i) {
+        last = add(std::move(tasks[i]), {last});
+    }
+    return last;
+}
+
+// --- Execution plan ---
+
+DeviceType plan_device(const ModelConfig& config, size_t index) {
+    const ExecutionPlanHeader& plan = config.exec_plan_header;
+    auto in_range = [index](uint32_t start, uint32_t end) { return index >= start && index < end; };
+    if (in_range(plan.npu_tensors_start_idx, plan.npu_tensors_end_idx)) {
+        return DeviceType::NPU;
+    }
+    if (in_range(plan.gpu_tensors_start_idx, plan.gpu_tensors_end_idx)) {
+        return DeviceType::GPU;
+    }
+    if (in_range(plan.cpu_tensors_start_idx, plan.cpu_tensors_end_idx)) {
+        return DeviceType::CPU;
+    }
+    if (index >= config.tensor_metadata_table.size()) {
+        throw std::out_of_range("Layer index is out of range of the model's tensor metadata table.");
+    }
+    return static_cast<DeviceType>(config.tensor_metadata_table[index].processor_id);
+}
+
+PlanGraphBuilder::PlanGraphBuilder(Model& model, const std::vector<const Tensor*>& excluded) {
+    const ModelConfig& config = model.get_config();
+    const auto& table = config.tensor_metadata_table;
+    for (size_t i = 0; i < table.size(); ++i) {
+        const std::string name(table[i].name, strnlen(table[i].name, sizeof(table[i].name)));
+        Tensor* weights = model.get_tensor(name);
+        if (!weights || weights->get_shape().rank() != 2 ||
+            std::find(excluded.begin(), excluded.end(), weights) != excluded.end()) {
+            continue;
+        }
+        // The CPU MatMul kernels take group-quantized weights as [out, in]
+        // and dense ones as [in, out].
+        const auto& dims = weights->get_shape().dims;
+        const bool quantized = is_group_quantized(weights->get_data_type());
+        Layer layer;
+        layer.index = i;
+        layer.weights = weights;
+        layer.device = plan_device(config, i);
+        layer.in_features = quantized ? dims[1] : dims[0];
+        layer.out_features = quantized ? dims[0] : dims[1];
+        if (!layers_.empty() && layers_.back().out_features != layer.in_features) {
+            throw std::runtime_error("Execution plan layer " + name + " takes " + std::to_string(layer.in_features) +
+                                     " features; the layer before it produces " +
+                                     std::to_string(layers_.back().out_features) + ".");
+        }
+        layers_.push_back(layer);
+    }
+}
+
+ExecutionGraph::NodeId PlanGraphBuilder::add_sequence(ExecutionGraph& graph, const std::vector<Tensor*>& activations,
+                                                      std::initializer_list<ExecutionGraph::NodeId> after) const {
+    if (activations.size() != layers_.size() + 1) {
+        throw std::invalid_argument("A sequence through the execution plan needs one activation tensor per layer, "
+                                    "plus its input.");
+    }
+    std::vector<LayerTask> tasks;
+    tasks.reserve(layers_.size());
+    for (size_t i = 0; i < layers_.size(); ++i) {
+        tasks.push_back(LayerTask{layers_[i].index, {activations[i], layers_[i].weights}, {activations[i + 1]}});
+    }
+    return graph.add_chain(std::move(tasks), after);
+}
+
+// --- ExecutionHandle ---
+
+void ExecutionHandle::wait() {
+    if (!state_) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    state_->done_cv.wait(lock, [this] { return state_->remaining == 0; });
+    if (state_->error) {
+        std::rethrow_exception(state_->error);
+    }
+}
+
+bool ExecutionHandle::is_done() const {
+    if (!state_) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->remaining == 0;
+}
+
+// --- Device queues ---
+
+// One submitted graph. A node is released to its device queue once every
+// same-device predecessor has been queued ahead of it and every cross-device
+// predecessor has finished; the latter completion is the fence of that edge.
+// Queues therefore only ever hold runnable work and never block on each other.
+struct ExecutionScheduler::GraphRun : std::enable_shared_from_this<GraphRun> {
+    struct Node {
+        LayerTask task;
+        DeviceQueue* queue = nullptr;
+        uint32_t pending = 0; // Guarded by state->mutex
+        std::vector<size_t> same_device_successors;
+        std::vector<size_t> cross_device_successors;
+    };
+    std::vector<Node> nodes;
+    std::shared_ptr<ExecutionHandle::State> state;
+
+    // Queues the nodes in ready and every same-device successor they unblock.
+    void release(std::vector<size_t> ready);
+    void complete(size_t node, std::exception_ptr error);
+};
+
+struct ExecutionScheduler::QueueItem {
+    std::shared_ptr<GraphRun> run;
+    size_t node = 0;
+    Clock::time_point queued_at;
+};
+
+class ExecutionScheduler::DeviceQueue {
+public:
+    DeviceQueue(DeviceType device, ILayerExecutor& executor)
+        : device_(device), executor_(executor), epoch_(Clock::now()) {
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~DeviceQueue() {
+        stop();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void push(std::shared_ptr<GraphRun> run, size_t node) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            items_.push_back(QueueItem{std::move(run), node, Clock::now()});
+        }
+        cv_.notify_one();
+    }
+
+    // The thread exits once the queue has drained.
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_one();
+    }
+
+    DeviceUtilization utilization() const {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        DeviceUtilization u;
+        u.device = device_;
+        u.layers = layers_;
+        u.busy_ms = to_ms(busy_);
+        u.queue_wait_ms = to_ms(queue_wait_);
+        const double elapsed_ms = to_ms(Clock::now() - epoch_);
+        u.utilization = elapsed_ms > 0.0 ? std::min(1.0, u.busy_ms / elapsed_ms) : 0.0;
+        return u;
+    }
+
+    void reset_utilization() {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        layers_ = 0;
+        busy_ = queue_wait_ = Clock::duration::zero();
+        epoch_ = Clock::now();
+    }
+
+private:
+    void run() {
+        for (;;) {
+            QueueItem item;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stopping_ || !items_.empty(); });
+                if (items_.empty()) {
+                    return;
+                }
+                item = std::move(items_.front());
+                items_.pop_front();
+            }
+            execute(item);
+        }
+    }
+
+    void execute(const QueueItem& item) {
+        GraphRun& run = *item.run;
+        bool skip = false;
+        {
+            std::lock_guard<std::mutex> lock(run.state->mutex);
+            skip = run.state->error != nullptr;
+        }
+        std::exception_ptr error;
+        const auto start = Clock::now();
+        if (!skip) {
+            const LayerTask& task = run.nodes[item.node].task;
+            try {
+                executor_.execute(task.inputs, task.outputs);
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        const auto end = Clock::now();
+        if (!skip) {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            queue_wait_ += start - item.queued_at;
+            busy_ += end - start;
+            ++layers_;
+        }
+        run.complete(item.node, error);
+    }
+
+    DeviceType device_;
+    ILayerExecutor& executor_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<QueueItem> items_;
+    bool stopping_ = false;
+
+    mutable std::mutex stats_mutex_;
+    Clock::time_point epoch_;
+    uint64_t layers_ = 0;
+    Clock::duration busy_ = Clock::duration::zero();
+    Clock::duration queue_wait_ = Clock::duration::zero();
+};
+
+void ExecutionScheduler::GraphRun::release(std::vector<size_t> ready) {
+    while (!ready.empty()) {
+        const size_t node = ready.back();
+        ready.pop_back();
+        // Queue first: a same-device successor must land behind this node.
+        nodes[node].queue->push(shared_from_this(), node);
+        std::lock_guard<std::mutex> lock(state->mutex);
+        for (size_t next : nodes[node].same_device_successors) {
+            if (--nodes[next].pending == 0) {
+                ready.push_back(next);
+            }
+        }
+    }
+}
+
+void ExecutionScheduler::GraphRun::complete(size_t node, std::exception_ptr error) {
+    std::vector<size_t> ready;
+    bool done = false;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (error && !state->error) {
+            state->error = error;
+        }
+        for (size_t next : nodes[node].cross_device_successors) {
+            if (--nodes[next].pending == 0) {
+                ready.push_back(next);
+            }
+        }
+        done = --state->remaining == 0;
+    }
+    if (done) {
+        state->done_cv.notify_all();
+    }
+    release(std::move(ready));
+}
+
+// --- ExecutionScheduler ---
+
+ExecutionScheduler::ExecutionScheduler(const Model& model, const DeviceManager& device_manager, ThreadPool* cpu_pool)
     : model_(model), device_manager_(device_manager) {
 
     if (device_manager_.has_device(DeviceType::CPU)) {
-        executors_[DeviceType::CPU] = std::make_unique<CpuLayerExecutor>();
+        const auto* cpu_caps = device_manager_.get_device(DeviceType::CPU)->get_capabilities<CpuCapabilities>();
+        if (!cpu_caps) {
+            throw std::runtime_error("CPU device is missing its capabilities.");
+        }
+        executors_[DeviceType::CPU] = std::make_unique<CpuLayerExecutor>(*cpu_caps, cpu_pool);
     }
+#ifdef __ANDROID__
+    // The GPU and NPU executors are built only into the Android library.
     if (device_manager_.has_device(DeviceType::GPU)) {
         const auto* gpu_device = device_manager_.get_device(DeviceType::GPU);
         // This is a placeholder for getting the real backend context
@@ -21,25 +344,115 @@ ExecutionScheduler::ExecutionScheduler(const Model& model, const DeviceManager&
         void* nnapi_context = nullptr; // Get from a future AndroidPlatformBackend
         executors_[DeviceType::NPU] = std::make_unique<NpuLayerExecutor>(nnapi_context);
     }
-}
+#endif
 
-ExecutionScheduler::~ExecutionScheduler() = default;
+    for (auto& [device, executor] : executors_) {
+        queues_[device] = std::make_unique<DeviceQueue>(device, *executor);
+    }
+}
 
-void ExecutionScheduler::execute_layer(size_t layer_index, const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
-    const auto& metadata_table = model_.get_config().tensor_metadata_table;
-    if (layer_index >= metadata_table.size()) {
-        throw std::out_of_range("Layer index is out of range of the model's tensor metadata table.");
+ExecutionScheduler::~ExecutionScheduler() {
+    // A finishing node can still release work onto another device's queue,
+    // so every graph must be done before any queue is stopped.
+    std::lock_guard<std::mutex> lock(runs_mutex_);
+    for (const auto& weak : runs_) {
+        if (auto state = weak.lock()) {
+            std::unique_lock<std::mutex> state_lock(state->mutex);
+            state->done_cv.wait(state_lock, [&state] { return state->remaining == 0; });
+        }
     }
+    queues_.clear();
+}
 
-    const auto& tensor_meta = metadata_table[layer_index];
-    DeviceType target_device = static_cast<DeviceType>(tensor_meta.processor_id);
+bool ExecutionScheduler::has_executor(DeviceType device) const {
+    return executors_.count(device) != 0;
+}
 
-    auto it = executors_.find(target_device);
-    if (it == executors_.end()) {
+DeviceType ExecutionScheduler::get_layer_device(size_t layer_index) const {
+    return plan_device(model_.get_config(), layer_index);
+}
+
+ExecutionScheduler::DeviceQueue& ExecutionScheduler::queue_for(DeviceType device) {
+    auto it = queues_.find(device);
+    if (it == queues_.end()) {
         throw std::runtime_error("No executor available for the target device specified in the model plan.");
     }
+    return *it->second;
+}
+
+ExecutionHandle ExecutionScheduler::submit(const ExecutionGraph& graph) {
+    const size_t n = graph.nodes_.size();
+    auto run = std::make_shared<GraphRun>();
+    run->state = std::make_shared<ExecutionHandle::State>();
+    run->state->remaining = n;
+    ExecutionHandle handle;
+    handle.state_ = run->state;
 
-    it->second->execute(inputs, outputs);
+    // Resolve every node before queueing any, so a bad plan entry fails the
+    // call instead of leaving a partial graph behind.
+    run->nodes.resize(n);
+    std::vector<DeviceType> devices(n);
+    for (size_t i = 0; i < n; ++i) {
+        GraphRun::Node& node = run->nodes[i];
+        node.task = graph.nodes_[i].task;
+        devices[i] = get_layer_device(node.task.layer_index);
+        node.queue = &queue_for(devices[i]);
+        for (ExecutionGraph::NodeId before : graph.nodes_[i].predecessors) {
+            auto& successors = devices[before] == devices[i] ? run->nodes[before].same_device_successors
+                                                             : run->nodes[before].cross_device_successors;
+            successors.push_back(i);
+            ++node.pending;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(runs_mutex_);
+        runs_.erase(std::remove_if(runs_.begin(), runs_.end(), [](const auto& weak) { return weak.expired(); }),
+                    runs_.end());
+        runs_.push_back(run->state);
+    }
+
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < n; ++i) {
+        if (run->nodes[i].pending == 0) {
+            ready.push_back(i);
+        }
+    }
+    // Nodes complete while this runs; release() takes the run's lock itself.
+    std::reverse(ready.begin(), ready.end());
+    run->release(std::move(ready));
+    return handle;
 }
 
-}
\ No newline at end of file
+void ExecutionScheduler::execute_layer(size_t layer_index, const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    ExecutionGraph graph;
+    graph.add(LayerTask{layer_index, inputs, outputs});
+    submit(graph).wait();
+}
+
+std::vector<DeviceUtilization> ExecutionScheduler::get_utilization() const {
+    std::vector<DeviceUtilization> stats;
+    for (const auto& [device, queue] : queues_) {
+        stats.push_back(queue->utilization());
+    }
+    std::sort(stats.begin(), stats.end(),
+              [](const DeviceUtilization& a, const DeviceUtilization& b) { return a.device < b.device; });
+    return stats;
+}
+
+void ExecutionScheduler::reset_utilization() {
+    for (auto& [device, queue] : queues_) {
+        queue->reset_utilization();
+    }
+}
+
+void ExecutionScheduler::log_utilization() const {
+    for (const DeviceUtilization& u : get_utilization()) {
+        std::cout << "Device " << device_name(u.device) << ": " << u.layers << " layers, busy " << std::fixed
+                  << std::setprecision(2) << u.busy_ms << " ms (" << std::setprecision(1) << u.utilization * 100.0
+                  << "%), queued " << std::setprecision(2) << u.queue_wait_ms << " ms." << std::defaultfloat
+                  << std::endl;
+    }
+}
+
+}
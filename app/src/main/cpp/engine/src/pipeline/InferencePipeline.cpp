@@ -1,66 +1,1305 @@
 #include "t760_engine/pipeline/InferencePipeline.h"
+#include "t760_engine/core/ClusterPools.h"
 #include "t760_engine/device/DeviceManager.h"
+#include "t760_engine/pipeline/ExecutionScheduler.h"
 #include "t760_engine/tensor/TensorManager.h"
 #include "t760_engine/tensor/Tensor.h"
+#include "t760_engine/tensor/Float16.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <stdexcept>
+#include <string>
 #include <iostream>
+#include <random>
 
 namespace t760 {
 
-InferencePipeline::InferencePipeline(DeviceManager& device_manager, TensorManager& tensor_manager)
-    : device_manager_(device_manager), tensor_manager_(tensor_manager) {}
+namespace {
+
+// Gemma ties the output projection to the token embedding, so a checkpoint
+// without a separate lm_head reuses the embedding table.
+constexpr const char* LM_HEAD_TENSOR = "lm_head.weight";
+constexpr const char* EMBEDDING_TENSOR = "model.embed_tokens.weight";
+constexpr const char* FINAL_NORM_TENSOR = "model.norm.weight";
+
+std::string layer_tensor(size_t layer, const char* suffix) {
+    return "model.layers." + std::to_string(layer) + "." + suffix;
+}
+
+// AUTO takes W8A8 prefill where integer dot products outrun FP32 FMA: sdot
+// retires 16 MACs per instruction on the A76 to fmla's 4.
+bool use_int8_prefill(PrefillActivations mode, const CpuCapabilities& caps) {
+    switch (mode) {
+        case PrefillActivations::FP32: return false;
+        case PrefillActivations::INT8: return true;
+        case PrefillActivations::AUTO:
+            return is_isa_supported(IsaLevel::NEON_DOTPROD, caps) || is_isa_supported(IsaLevel::AVX2, caps);
+    }
+    return false;
+}
+
+// Most candidates the fused lm_head collects for one row. A request whose
+// penalties would need more (see candidates_for_penalties) is sampled from
+// its materialized logit row instead.
+constexpr uint32_t MAX_FUSED_CANDIDATES = 1024;
+
+uint32_t effective_top_k(const SamplingParams& sampling) {
+    return sampling.top_k > 0 ? sampling.top_k : constants::DEFAULT_SAMPLING_TOP_K;
+}
+
+std::mt19937 make_rng(uint64_t seed) {
+    if (seed == 0) {
+        std::random_device device;
+        std::seed_seq seq{device(), device(), device(), device()};
+        return std::mt19937(seq);
+    }
+    std::seed_seq seq{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+    return std::mt19937(seq);
+}
+
+// Distinct tokens a conversation's history holds before its table grows.
+constexpr size_t HISTORY_RESERVE = 1024;
+
+// Mixed into a seeded conversation's seed for its draft conversation, so that
+// proposals and their checks draw from unrelated streams.
+constexpr uint64_t DRAFT_SEED_MIX = 0x9E3779B97F4A7C15ull;
+
+uint64_t draft_seed(uint64_t seed) {
+    return seed == 0 ? 0 : seed ^ DRAFT_SEED_MIX;
+}
+
+// Latency percentiles cover this many of the most recent calls.
+constexpr size_t LATENCY_WINDOW = 1024;
+
+// Nearest-rank percentile of samples, q in (0, 1].
+double percentile(std::vector<float> samples, double q) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    const size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(samples.size())));
+    const auto nth = samples.begin() + static_cast<std::ptrdiff_t>(std::max<size_t>(rank, 1) - 1);
+    std::nth_element(samples.begin(), nth, samples.end());
+    return *nth;
+}
+
+bool has_quantized_projection(const kernels::DecoderLayerWeights& w) {
+    for (const kernels::LinearWeight* linear : {&w.q_proj, &w.k_proj, &w.v_proj, &w.o_proj, &w.gate_proj, &w.up_proj,
+                                                &w.down_proj}) {
+        if (is_group_quantized(linear->data_type)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+InferencePipeline::InferencePipeline(DeviceManager& device_manager, TensorManager& tensor_manager,
+                                     ClusterPools& thread_pools, const PipelineOptions& options)
+    : device_manager_(device_manager), tensor_manager_(tensor_manager), thread_pools_(thread_pools), options_(options) {
+    options_.max_decode_batch = std::max<uint32_t>(1, options_.max_decode_batch);
+    options_.prefill_chunk_tokens = std::max<uint32_t>(1, options_.prefill_chunk_tokens);
+    options_.step_token_budget = std::max(options_.step_token_budget, options_.max_decode_batch + 1);
+}
 
 InferencePipeline::~InferencePipeline() { release(); }
 
 void InferencePipeline::prepare(Model& model) {
     if (is_prepared_) { throw std::runtime_error("InferencePipeline is already prepared."); }
+    const auto* cpu_device = device_manager_.get_device(DeviceType::CPU);
+    const auto* cpu_caps = cpu_device ? cpu_device->get_capabilities<CpuCapabilities>() : nullptr;
+    if (!cpu_caps) {
+        throw std::runtime_error("InferencePipeline requires a CPU device with capabilities.");
+    }
+    kernel_context_ = make_cpu_kernel_context(*cpu_caps, &thread_pools_.get(CoreCluster::BIG));
+    for (RequestPriority priority : {RequestPriority::INTERACTIVE, RequestPriority::BACKGROUND}) {
+        StepLane& lane = lane_for(priority);
+        ThreadPool& pool =
+            thread_pools_.get(priority == RequestPriority::INTERACTIVE ? CoreCluster::BIG : CoreCluster::LITTLE);
+        lane.priority = priority;
+        lane.kernel_context = make_cpu_kernel_context(*cpu_caps, &pool);
+        lane.affinity_mask = pool.get_affinity_mask();
+        lane.nice = pool.get_nice();
+    }
+    int8_prefill_ = use_int8_prefill(options_.prefill_activations, *cpu_caps);
+
+    embedding_weight_ = model.get_tensor(EMBEDDING_TENSOR);
+    if (embedding_weight_) {
+        embedding_ = kernels::make_vocab_table_view(*embedding_weight_);
+        // Gemma scales embeddings by sqrt(hidden_size), computed in the
+        // checkpoint's bfloat16.
+        embedding_scale_ = bf16_to_fp32(fp32_to_bf16(std::sqrt(static_cast<float>(embedding_.hidden_size))));
+    }
+
+    // The loader aliases a tied lm_head to the embedding tensor, so both
+    // stages read one resident copy of the table.
+    lm_head_weight_ = model.get_tensor(LM_HEAD_TENSOR);
+    if (!lm_head_weight_) {
+        lm_head_weight_ = embedding_weight_;
+    }
+    if (lm_head_weight_) {
+        lm_head_ = lm_head_weight_ == embedding_weight_ ? embedding_ : kernels::make_vocab_table_view(*lm_head_weight_);
+        std::cout << "Output stage: " << lm_head_weight_->get_name() << " [" << lm_head_.vocab_size << ", "
+                  << lm_head_.hidden_size << "]" << (lm_head_weight_ == embedding_weight_ ? ", tied to embedding" : "")
+                  << std::endl;
+    } else {
+        std::cout << "Output stage: model has no lm_head or embedding tensor." << std::endl;
+    }
+
+    prepare_decoder(model);
+    if (layer_weights_.empty()) {
+        prepare_plan(model);
+    }
+    reset_latency_stats();
+    if (!layer_weights_.empty()) {
+        start_lanes();
+    }
+
     active_model_ = &model;
     is_prepared_ = true;
 }
 
+void InferencePipeline::prepare_decoder(Model& model) {
+    const ModelHeader& header = model.get_config().model_header;
+    const auto heads = static_cast<int64_t>(header.heads);
+    const auto kv_heads = static_cast<int64_t>(header.kv_heads);
+    const auto head_dim = static_cast<int64_t>(header.head_size);
+    max_positions_ = header.seq_len > 0 ? header.seq_len : constants::MAX_SUPPORTED_SEQ_LEN;
+
+    std::vector<kernels::DecoderLayerWeights> weights(header.layer_count);
+    std::string missing;
+    auto tensor = [&](const std::string& name) -> const Tensor* {
+        const Tensor* t = model.get_tensor(name);
+        if (!t && missing.empty()) {
+            missing = name;
+        }
+        return t;
+    };
+    for (size_t i = 0; i < weights.size() && missing.empty(); ++i) {
+        auto& w = weights[i];
+        auto norm = [&](const char* suffix, std::vector<float>& gain) {
+            if (const Tensor* t = tensor(layer_tensor(i, suffix))) { gain = kernels::make_norm_gain(*t); }
+        };
+        auto linear = [&](const char* suffix, kernels::LinearWeight& linear_weight) {
+            if (const Tensor* t = tensor(layer_tensor(i, suffix))) { linear_weight = kernels::make_linear_weight(*t); }
+        };
+        norm("input_layernorm.weight", w.input_norm);
+        norm("post_attention_layernorm.weight", w.post_attention_norm);
+        norm("pre_feedforward_layernorm.weight", w.pre_feedforward_norm);
+        norm("post_feedforward_layernorm.weight", w.post_feedforward_norm);
+        norm("self_attn.q_norm.weight", w.q_norm);
+        norm("self_attn.k_norm.weight", w.k_norm);
+        linear("self_attn.q_proj.weight", w.q_proj);
+        linear("self_attn.k_proj.weight", w.k_proj);
+        linear("self_attn.v_proj.weight", w.v_proj);
+        linear("self_attn.o_proj.weight", w.o_proj);
+        linear("mlp.gate_proj.weight", w.gate_proj);
+        linear("mlp.up_proj.weight", w.up_proj);
+        linear("mlp.down_proj.weight", w.down_proj);
+    }
+    const Tensor* final_norm = tensor(FINAL_NORM_TENSOR);
+    if (!missing.empty() || !embedding_weight_ || header.layer_count == 0) {
+        std::cout << "Decoder: " << (missing.empty() ? std::string("model has no embedding or layers")
+                                                      : "model has no " + missing)
+                  << ", forward pass disabled." << std::endl;
+        return;
+    }
+
+    // Gemma3 interleaves sliding-window layers, rotated with the local RoPE
+    // base, with a global layer every GEMMA3_SLIDING_WINDOW_PATTERN layers.
+    const float rope_theta = header.rope_freq_base > 0.0f ? header.rope_freq_base : constants::GEMMA3_ROPE_THETA;
+    global_rope_ = kernels::RopeTable(head_dim, max_positions_, rope_theta);
+    local_rope_ = kernels::RopeTable(head_dim, max_positions_, constants::GEMMA3_ROPE_LOCAL_BASE_FREQ);
+    const kernels::ShapeKernelSet* fixed = kernels::find_shape_kernel_set(kernels::DecoderShape{
+        header.hidden_size, head_dim, heads, kv_heads, header.intermediate_size});
+    layer_params_.resize(weights.size());
+    size_t int8_layers = 0;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        const bool global = (i + 1) % constants::GEMMA3_SLIDING_WINDOW_PATTERN == 0;
+        auto& params = layer_params_[i];
+        params.hidden_size = header.hidden_size;
+        params.intermediate_size = header.intermediate_size;
+        params.rms_norm_eps = constants::GEMMA3_RMS_NORM_EPS;
+        params.fixed = fixed;
+        params.attention.num_heads = heads;
+        params.attention.num_kv_heads = kv_heads;
+        params.attention.head_dim = head_dim;
+        params.attention.scale = 1.0f / std::sqrt(constants::GEMMA3_QUERY_PRE_ATTN_SCALAR);
+        params.attention.sliding_window = global ? 0 : constants::GEMMA3_SLIDING_WINDOW;
+        params.attention.rope = global ? &global_rope_ : &local_rope_;
+        params.int8_prefill = int8_prefill_ && has_quantized_projection(weights[i]);
+        int8_layers += params.int8_prefill ? 1 : 0;
+        kernels::validate_decoder_layer(params, weights[i]);
+    }
+    layer_weights_ = std::move(weights);
+    final_norm_ = kernels::make_norm_gain(*final_norm);
+    std::cout << "Decoder: " << layer_weights_.size() << " layers on the fused CPU kernels ("
+              << (fixed ? "shape-specialized" : "generic shapes") << "), " << max_positions_ << " positions, "
+              << "W8A8 prefill on " << int8_layers << " layers; steps of " << options_.step_token_budget
+              << " tokens, prompts in " << options_.prefill_chunk_tokens << "-token chunks." << std::endl;
+}
+
+void InferencePipeline::prepare_plan(Model& model) {
+    std::unique_ptr<PlanGraphBuilder> plan;
+    try {
+        const std::vector<const Tensor*> stages = {embedding_weight_, lm_head_weight_};
+        plan = std::make_unique<PlanGraphBuilder>(model, stages);
+    } catch (const std::exception& e) {
+        std::cout << "Execution plan: " << e.what() << " Not run." << std::endl;
+        return;
+    }
+    if (plan->empty() || !embedding_weight_) {
+        return;
+    }
+    if (plan->in_features() != embedding_.hidden_size ||
+        (lm_head_weight_ && plan->out_features() != lm_head_.hidden_size)) {
+        std::cout << "Execution plan: layers map " << plan->in_features() << " features to "
+                  << plan->out_features() << ", the embedding has " << embedding_.hidden_size << "; not run."
+                  << std::endl;
+        return;
+    }
+    auto scheduler = std::make_unique<ExecutionScheduler>(model, device_manager_, &thread_pools_.get(CoreCluster::BIG));
+    for (const PlanGraphBuilder::Layer& layer : plan->layers()) {
+        if (!scheduler->has_executor(layer.device)) {
+            std::cout << "Execution plan: " << layer.weights->get_name()
+                      << " is planned on a device with no executor; not run." << std::endl;
+            return;
+        }
+    }
+    auto layers_on = [&plan](DeviceType device) {
+        return std::count_if(plan->layers().begin(), plan->layers().end(),
+                             [device](const PlanGraphBuilder::Layer& layer) { return layer.device == device; });
+    };
+    std::cout << "Execution plan: " << plan->layers().size() << " layers (" << layers_on(DeviceType::NPU) << " NPU, "
+              << layers_on(DeviceType::GPU) << " GPU, " << layers_on(DeviceType::CPU)
+              << " CPU) on the device scheduler." << std::endl;
+    scheduler_ = std::move(scheduler);
+    plan_ = std::move(plan);
+}
+
 void InferencePipeline::release() {
+    detach_draft();
+    stop_lanes();
+    log_latency_stats();
+    if (scheduler_) {
+        scheduler_->log_utilization();
+    }
+    scheduler_.reset();
+    plan_.reset();
     std::lock_guard<std::mutex> lock(context_mtx_);
     conversation_contexts_.clear();
+    embedding_weight_ = nullptr;
+    embedding_ = kernels::VocabTableView{};
+    lm_head_weight_ = nullptr;
+    lm_head_ = kernels::VocabTableView{};
+    layer_params_.clear();
+    layer_weights_.clear();
+    final_norm_.clear();
+    global_rope_ = kernels::RopeTable{};
+    local_rope_ = kernels::RopeTable{};
+    kernel_context_ = CpuKernelContext{};
     active_model_ = nullptr;
     is_prepared_ = false;
 }
 
-ConversationHandle InferencePipeline::create_new_context() {
+ConversationHandle InferencePipeline::create_new_context(const ConversationOptions& options) {
     if (!is_prepared_) { throw std::runtime_error("Pipeline must be prepared."); }
+    // The caches are allocated outside context_mtx_ so that other calls can
+    // look up their conversations meanwhile.
+    auto state = std::make_shared<ConversationState>();
+    state->options = options;
+    state->rng = make_rng(options.seed);
+    state->history.reserve(HISTORY_RESERVE);
+    allocate_kv_cache(*state, max_positions_);
+    if (draft_) {
+        ConversationOptions draft_options = options;
+        draft_options.seed = draft_seed(options.seed);
+        state->speculation = std::make_unique<SpeculativeState>();
+        state->speculation->draft = draft_->create_new_context(draft_options);
+    }
     std::lock_guard<std::mutex> lock(context_mtx_);
     auto handle = ConversationHandle{next_context_id_++};
-    auto state = std::make_unique<ConversationState>();
     state->handle = handle;
+    conversation_contexts_[handle.id] = std::move(state);
+    return handle;
+}
+
+void InferencePipeline::allocate_kv_cache(ConversationState& state, int64_t positions) {
     const auto& config = active_model_->get_config();
     const size_t layer_count = config.model_header.layer_count;
-    state->kv_cache.reserve(layer_count);
+    state.kv_cache.reserve(layer_count);
     for (size_t i = 0; i < layer_count; ++i) {
-        TensorShape kv_shape{{1, (int64_t)config.model_header.seq_len, (int64_t)config.model_header.kv_heads, (int64_t)config.model_header.head_size}};
-        DeviceType target_device = device_manager_.has_device(DeviceType::GPU) ? DeviceType::GPU : DeviceType::CPU;
-        auto k_cache = tensor_manager_.create_tensor("k_cache_" + std::to_string(i), kv_shape, DataType::FP16, target_device);
-        auto v_cache = tensor_manager_.create_tensor("v_cache_" + std::to_string(i), kv_shape, DataType::FP16, target_device);
-        state->kv_cache.emplace_back(std::move(k_cache), std::move(v_cache));
+        TensorShape kv_shape{{1, positions, (int64_t)config.model_header.kv_heads, (int64_t)config.model_header.head_size}};
+        // Attention runs on the CPU kernels, which read the cache directly.
+        auto k_cache = tensor_manager_.create_tensor("k_cache_" + std::to_string(i), kv_shape, DataType::FP16, DeviceType::CPU);
+        auto v_cache = tensor_manager_.create_tensor("v_cache_" + std::to_string(i), kv_shape, DataType::FP16, DeviceType::CPU);
+        state.kv_cache.emplace_back(std::move(k_cache), std::move(v_cache));
     }
-    conversation_contexts_[handle.id] = std::move(state);
-    return handle;
 }
 
 void InferencePipeline::destroy_context(ConversationHandle handle) {
-    std::lock_guard<std::mutex> lock(context_mtx_);
-    conversation_contexts_.erase(handle.id);
+    std::shared_ptr<ConversationState> state;
+    {
+        std::lock_guard<std::mutex> lock(context_mtx_);
+        auto it = conversation_contexts_.find(handle.id);
+        if (it == conversation_contexts_.end()) {
+            return;
+        }
+        state = std::move(it->second);
+        conversation_contexts_.erase(it);
+    }
+    // A running call may still hold the state; otherwise its caches are
+    // freed here, outside context_mtx_. The speculation is taken under the
+    // state's lock, as a failing call drops it under that lock.
+    std::unique_ptr<SpeculativeState> speculation;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        speculation = std::move(state->speculation);
+    }
+    if (speculation && draft_) {
+        draft_->destroy_context(speculation->draft);
+    }
+}
+
+StepOutput InferencePipeline::execute(ConversationHandle handle, const std::vector<int>& input_token_ids,
+                                      const OutputOptions& options) {
+    StepOutput output;
+    execute(handle, input_token_ids.data(), input_token_ids.size(), options, output);
+    return output;
+}
+
+void InferencePipeline::execute(ConversationHandle handle, const int* input_token_ids, size_t count,
+                                const OutputOptions& options, StepOutput& output) {
+    if (!is_prepared_) { throw std::runtime_error("Cannot execute: pipeline is not prepared."); }
+    validate_output(options);
+    const std::shared_ptr<ConversationState> current_state = find_context(handle);
+    if (!current_state) { throw std::runtime_error("Invalid conversation handle."); }
+    std::lock_guard<std::mutex> conversation_lock(current_state->mutex);
+    execute_locked(*current_state, input_token_ids, count, options, output);
+}
+
+void InferencePipeline::execute_locked(ConversationState& state, const int* tokens, size_t count,
+                                       const OutputOptions& options, StepOutput& output) {
+    if (embedding_weight_ && !layer_weights_.empty() && count > 0) {
+        // Throws on a sequence too long before the state changes.
+        StepRequest request = make_request(state, tokens, count, options, output);
+        begin_call(state, tokens, count, output);
+        StepRequest* const requests[] = {&request};
+        run_requests(requests, 1);
+        if (request.error) {
+            undo_call(state, tokens, count, request.consumed);
+            std::rethrow_exception(request.error);
+        }
+        return;
+    }
+    begin_call(state, tokens, count, output);
+    PlanCall call{&state, tokens, count, &options, &output, nullptr};
+    execute_without_decoder(&call, 1);
+    if (call.error) {
+        undo_call(state, tokens, count, 0);
+        std::rethrow_exception(call.error);
+    }
+}
+
+void InferencePipeline::execute_many(StepCall* calls, size_t count) {
+    if (!is_prepared_) { throw std::runtime_error("Cannot execute: pipeline is not prepared."); }
+    // Conversations are locked in handle order, so that overlapping calls
+    // cannot deadlock.
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return calls[a].handle.id < calls[b].handle.id; });
+    for (size_t i = 1; i < count; ++i) {
+        if (calls[order[i]].handle == calls[order[i - 1]].handle) {
+            throw std::runtime_error("execute_many needs distinct conversations.");
+        }
+    }
+
+    std::vector<std::shared_ptr<ConversationState>> states;
+    std::vector<std::unique_lock<std::mutex>> locks;
+    std::vector<StepRequest> requests;
+    std::vector<StepRequest*> queued;
+    std::vector<StepCall*> queued_calls;
+    std::vector<PlanCall> plan_calls;
+    std::vector<StepCall*> plan_step_calls;
+    states.reserve(count);
+    locks.reserve(count);
+    requests.reserve(count); // Queued by address
+    for (size_t i : order) {
+        StepCall& call = calls[i];
+        try {
+            validate_output(call.options);
+            std::shared_ptr<ConversationState> state = find_context(call.handle);
+            if (!state) { throw std::runtime_error("Invalid conversation handle."); }
+            // Kept before locking, so that the mutex outlives the lock should
+            // the conversation be destroyed meanwhile.
+            states.push_back(std::move(state));
+            ConversationState& locked = *states.back();
+            locks.emplace_back(locked.mutex);
+            if (embedding_weight_ && !layer_weights_.empty() && call.count > 0) {
+                // Throws on a sequence too long before the state changes.
+                requests.push_back(make_request(locked, call.tokens, call.count, call.options, *call.output));
+                begin_call(locked, call.tokens, call.count, *call.output);
+                queued.push_back(&requests.back());
+                queued_calls.push_back(&call);
+            } else {
+                begin_call(locked, call.tokens, call.count, *call.output);
+                plan_calls.push_back(PlanCall{&locked, call.tokens, call.count, &call.options, call.output, nullptr});
+                plan_step_calls.push_back(&call);
+            }
+        } catch (...) {
+            call.error = std::current_exception();
+        }
+    }
+    // One graph for every conversation, so their plan layers overlap.
+    execute_without_decoder(plan_calls.data(), plan_calls.size());
+    for (size_t i = 0; i < plan_calls.size(); ++i) {
+        const PlanCall& call = plan_calls[i];
+        if (call.error) {
+            undo_call(*call.state, call.tokens, call.count, 0);
+        }
+        plan_step_calls[i]->error = call.error;
+    }
+    run_requests(queued.data(), queued.size());
+    for (size_t i = 0; i < queued.size(); ++i) {
+        const StepRequest& request = *queued[i];
+        if (request.error) {
+            undo_call(*request.state, request.tokens, static_cast<size_t>(request.count), request.consumed);
+        }
+        queued_calls[i]->error = request.error;
+    }
+}
+
+void InferencePipeline::reset_context(ConversationHandle handle, uint64_t seed) {
+    if (!is_prepared_) { throw std::runtime_error("Pipeline must be prepared."); }
+    const std::shared_ptr<ConversationState> state = find_context(handle);
+    if (!state) { throw std::runtime_error("Invalid conversation handle."); }
+    std::lock_guard<std::mutex> conversation_lock(state->mutex);
+    // Positions past processed_token_count are never read, so the caches
+    // need no clearing.
+    state->processed_token_count = 0;
+    state->history.clear();
+    state->final_hidden.clear();
+    state->options.seed = seed;
+    state->rng = make_rng(seed);
+    if (state->speculation && draft_) {
+        draft_->reset_context(state->speculation->draft, draft_seed(seed));
+        state->speculation->pending.clear();
+    }
+}
+
+size_t InferencePipeline::remaining_positions(ConversationHandle handle) {
+    if (!is_prepared_) { throw std::runtime_error("Pipeline must be prepared."); }
+    const std::shared_ptr<ConversationState> state = find_context(handle);
+    if (!state) { throw std::runtime_error("Invalid conversation handle."); }
+    std::lock_guard<std::mutex> conversation_lock(state->mutex);
+    const int64_t remaining = max_positions_ - static_cast<int64_t>(state->processed_token_count);
+    return remaining > 0 ? static_cast<size_t>(remaining) : 0;
+}
+
+void InferencePipeline::attach_draft(Model& draft_model) {
+    if (!is_prepared_) { throw std::runtime_error("Pipeline must be prepared."); }
+    if (draft_) { throw std::runtime_error("A draft model is already attached."); }
+    std::cout << "Draft model:" << std::endl;
+    auto draft = std::make_unique<InferencePipeline>(device_manager_, tensor_manager_, thread_pools_, options_);
+    draft->prepare(draft_model);
+    if (!draft->embedding_weight_ || draft->layer_weights_.empty() || !draft->lm_head_weight_) {
+        throw std::runtime_error("The draft model has no decoder and output stage to run.");
+    }
+    if (draft->lm_head_.vocab_size != lm_head_.vocab_size) {
+        throw std::runtime_error("The draft model's vocab has " + std::to_string(draft->lm_head_.vocab_size) +
+                                 " tokens; the model's has " + std::to_string(lm_head_.vocab_size) + ".");
+    }
+    draft_ = std::move(draft);
+    reset_speculation_stats();
 }
 
-std::unique_ptr<Tensor> InferencePipeline::execute(ConversationHandle handle, const std::vector<int>& input_token_ids) {
+void InferencePipeline::detach_draft() {
+    if (!draft_) {
+        return;
+    }
+    log_speculation_stats();
+    {
+        std::lock_guard<std::mutex> lock(context_mtx_);
+        for (auto& entry : conversation_contexts_) {
+            entry.second->speculation.reset();
+        }
+    }
+    draft_.reset();
+}
+
+void InferencePipeline::execute_speculative(ConversationHandle handle, const int* input_token_ids, size_t count,
+                                            const OutputOptions& options, const SpeculationOptions& speculation,
+                                            SpeculativeOutput& output) {
     if (!is_prepared_) { throw std::runtime_error("Cannot execute: pipeline is not prepared."); }
-    
-    std::unique_lock<std::mutex> lock(context_mtx_);
+    validate_output(options);
+    const auto start = std::chrono::steady_clock::now();
+    const std::shared_ptr<ConversationState> state = find_context(handle);
+    if (!state) { throw std::runtime_error("Invalid conversation handle."); }
+    std::lock_guard<std::mutex> conversation_lock(state->mutex);
+    output.tokens.clear();
+    output.drafted = 0;
+    output.accepted = 0;
+
+    // The draft conversation belongs to this one, so holding this one's lock
+    // keeps every other call off it.
+    SpeculativeState* spec = state->speculation.get();
+    const std::shared_ptr<ConversationState> draft_state =
+        spec && draft_ ? draft_->find_context(spec->draft) : nullptr;
+    int64_t k = speculation.draft_tokens;
+    if (speculation.max_tokens > 0) {
+        k = std::min<int64_t>(k, static_cast<int64_t>(speculation.max_tokens) - 1); // Proposals past it go unused
+    }
+    if (draft_state) {
+        const auto inputs = static_cast<int64_t>(count);
+        k = std::min(k, max_positions_ - static_cast<int64_t>(state->processed_token_count) - inputs);
+        // The draft runs pending and the inputs, then every proposal but the last.
+        k = std::min(k, draft_->max_positions_ - static_cast<int64_t>(draft_state->processed_token_count) -
+                            static_cast<int64_t>(spec->pending.size()) - inputs + 1);
+    }
+    // Proposals and the check both need the candidates of the fused lm_head,
+    // which a top_k past it does not produce (sample_from_logits may return
+    // none), so such a step runs plainly.
+    const SamplingParams& sampling = options.sampling;
+    if (!draft_state || k <= 0 || count == 0 || layer_weights_.empty() || !lm_head_weight_ ||
+        sampling.has_penalties() || options.wants_logits() || options.allowed_tokens.is_set() ||
+        effective_top_k(sampling) > MAX_FUSED_CANDIDATES) {
+        execute_locked(*state, input_token_ids, count, options, output.plain);
+        output.tokens.push_back(output.plain.next_token);
+        return;
+    }
+
+    // The draft proposes one token per step, catching up on pending first.
+    OutputOptions draft_options;
+    draft_options.sampling = sampling;
+    spec->feed.assign(spec->pending.begin(), spec->pending.end());
+    spec->feed.insert(spec->feed.end(), input_token_ids, input_token_ids + count);
+    spec->drafted.clear();
+    spec->drafted.reserve(static_cast<size_t>(k));
+    spec->proposals.resize(static_cast<size_t>(k));
+    size_t draft_fed = 0; // Proposals the draft has run
+    try {
+        for (int64_t j = 0; j < k; ++j) {
+            if (j > 0) {
+                draft_->execute(spec->draft, &spec->drafted[j - 1], 1, draft_options, spec->proposals[j]);
+                ++draft_fed;
+            } else {
+                draft_->execute(spec->draft, spec->feed.data(), spec->feed.size(), draft_options, spec->proposals[0]);
+                spec->pending.clear();
+            }
+            if (spec->proposals[j].next_token < 0) {
+                break;
+            }
+            spec->drafted.push_back(spec->proposals[j].next_token);
+        }
+    } catch (const std::exception& e) {
+        // The draft's positions no longer match; the conversation goes on
+        // without it.
+        std::cerr << "Draft model failed, conversation " << handle.id << " stops speculating: " << e.what()
+                  << std::endl;
+        drop_speculation(*state);
+        execute_locked(*state, input_token_ids, count, options, output.plain);
+        output.tokens.push_back(output.plain.next_token);
+        return;
+    }
+    const size_t drafted = spec->drafted.size();
+
+    // One step scores the inputs' last position and every proposal.
+    spec->feed.assign(input_token_ids, input_token_ids + count);
+    spec->feed.insert(spec->feed.end(), spec->drafted.begin(), spec->drafted.end());
+    spec->verdicts.resize(drafted + 1);
+    for (StepOutput& verdict : spec->verdicts) {
+        verdict.next_token = -1;
+        verdict.candidates.clear();
+    }
+    // The check samples nothing, so the history takes the tokens it keeps
+    // once it has run. Should it fail, the draft has run ahead of the
+    // conversation: both go back to where they were but for the draft,
+    // which is dropped.
+    int64_t checked = 0;
+    try {
+        StepRequest request = make_request(*state, spec->feed.data(), spec->feed.size(), options, spec->verdicts[0]);
+        request.verify_rows = static_cast<int64_t>(drafted + 1);
+        StepRequest* const requests[] = {&request};
+        run_requests(requests, 1);
+        checked = request.consumed;
+        if (request.error) {
+            std::rethrow_exception(request.error);
+        }
+    } catch (...) {
+        state->processed_token_count -= static_cast<size_t>(checked);
+        drop_speculation(*state);
+        throw;
+    }
+
+    size_t accepted = 0;
+    for (; accepted < drafted; ++accepted) {
+        const std::vector<TokenCandidate>& target = spec->verdicts[accepted].candidates;
+        const std::vector<TokenCandidate>& draft = spec->proposals[accepted].candidates;
+        candidate_probabilities(target, sampling, spec->target_probs);
+        candidate_probabilities(draft, sampling, spec->draft_probs);
+        int32_t replacement = -1;
+        if (!verify_draft_token(spec->drafted[accepted], target, spec->target_probs, draft, spec->draft_probs,
+                                state->rng, replacement)) {
+            output.tokens.push_back(replacement);
+            break;
+        }
+        output.tokens.push_back(spec->drafted[accepted]);
+    }
+    if (accepted == drafted) {
+        output.tokens.push_back(sample_from_candidates(spec->verdicts[drafted].candidates, sampling, state->rng));
+    }
+    size_t emitted = output.tokens.size();
+    if (speculation.max_tokens > 0) {
+        emitted = std::min<size_t>(emitted, speculation.max_tokens);
+    }
+    if (speculation.stop_tokens) {
+        const std::vector<int32_t>& stops = *speculation.stop_tokens;
+        for (size_t i = 0; i < emitted; ++i) {
+            if (std::find(stops.begin(), stops.end(), output.tokens[i]) != stops.end()) {
+                emitted = i + 1;
+                break;
+            }
+        }
+    }
+    output.tokens.resize(emitted);
+    output.drafted = static_cast<uint32_t>(drafted);
+    output.accepted = static_cast<uint32_t>(accepted);
+
+    // Both conversations keep the proposals before the last token returned,
+    // which is the next call's input.
+    const size_t kept = emitted - 1;
+    state->processed_token_count -= drafted - kept;
+    state->history.add(spec->feed.data(), count + kept);
+    if (kept <= draft_fed) {
+        std::lock_guard<std::mutex> draft_lock(draft_state->mutex);
+        rewind(*draft_state, spec->drafted.data() + kept, draft_fed - kept);
+    } else {
+        spec->pending.assign(spec->drafted.begin() + static_cast<std::ptrdiff_t>(draft_fed),
+                             spec->drafted.begin() + static_cast<std::ptrdiff_t>(kept));
+    }
+
+    if (count == 1) {
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::lock_guard<std::mutex> lock(speculation_mtx_);
+        ++speculation_stats_.steps;
+        speculation_stats_.drafted += drafted;
+        speculation_stats_.accepted += accepted;
+        speculation_stats_.emitted += emitted;
+        speculation_stats_.seconds += seconds;
+    }
+}
+
+void InferencePipeline::drop_speculation(ConversationState& state) {
+    if (state.speculation && draft_) {
+        draft_->destroy_context(state.speculation->draft);
+    }
+    state.speculation.reset();
+}
+
+void InferencePipeline::rewind(ConversationState& state, const int* tokens, size_t count) {
+    // Positions past processed_token_count are never read, so the caches
+    // need no clearing.
+    state.processed_token_count -= count;
+    state.history.remove(tokens, count);
+}
+
+SpeculationStats InferencePipeline::get_speculation_stats() {
+    std::lock_guard<std::mutex> lock(speculation_mtx_);
+    return speculation_stats_;
+}
+
+void InferencePipeline::reset_speculation_stats() {
+    std::lock_guard<std::mutex> lock(speculation_mtx_);
+    speculation_stats_ = SpeculationStats{};
+}
+
+void InferencePipeline::log_speculation_stats() {
+    const SpeculationStats stats = get_speculation_stats();
+    if (stats.steps == 0) {
+        return;
+    }
+    std::cout << "Speculation: " << stats.steps << " steps, " << stats.accepted << " of " << stats.drafted
+              << " proposals accepted (" << 100.0 * stats.acceptance_rate() << "%), " << stats.emitted
+              << " tokens at " << stats.tokens_per_second() << " tokens/s." << std::endl;
+}
+
+void InferencePipeline::embed(const std::vector<int>* inputs, size_t count, const EmbeddingOptions& options,
+                              float* output) {
+    if (!is_prepared_) { throw std::runtime_error("Cannot embed: pipeline is not prepared."); }
+    if (!embedding_weight_ || layer_weights_.empty()) {
+        throw std::runtime_error("Cannot embed: the model has no decoder to run.");
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (inputs[i].empty()) { throw std::runtime_error("Cannot embed an empty input."); }
+        if (static_cast<int64_t>(inputs[i].size()) > max_positions_) {
+            throw std::runtime_error("Input exceeds the model's maximum sequence length.");
+        }
+    }
+    const size_t hidden = embedding_size();
+    std::fill(output, output + count * hidden, 0.0f);
+    // Each input gets a state of its own with caches sized to it: attention
+    // reads a chunk's keys back from the cache, but nothing outlives the call.
+    std::vector<std::unique_ptr<ConversationState>> states;
+    std::vector<StepRequest> requests;
+    std::vector<StepRequest*> queued;
+    states.reserve(count);
+    requests.reserve(count); // Queued by address
+    const auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        auto state = std::make_unique<ConversationState>();
+        state->options.priority = options.priority;
+        allocate_kv_cache(*state, static_cast<int64_t>(inputs[i].size()));
+        requests.push_back(StepRequest{state.get(), inputs[i].data(), static_cast<int64_t>(inputs[i].size()), nullptr,
+                                       now, std::chrono::steady_clock::time_point::max(), 0, nullptr, nullptr});
+        requests.back().embedding = output + i * hidden;
+        requests.back().embedding_options = &options;
+        queued.push_back(&requests.back());
+        states.push_back(std::move(state));
+    }
+    run_requests(queued.data(), queued.size());
+    for (const StepRequest& request : requests) {
+        if (request.error) {
+            std::rethrow_exception(request.error);
+        }
+    }
+}
+
+std::shared_ptr<ConversationState> InferencePipeline::find_context(ConversationHandle handle) {
+    std::lock_guard<std::mutex> lock(context_mtx_);
     auto it = conversation_contexts_.find(handle.id);
-    if (it == conversation_contexts_.end()) { throw std::runtime_error("Invalid conversation handle."); }
-    ConversationState* current_state = it->second.get();
-    lock.unlock();
+    return it == conversation_contexts_.end() ? nullptr : it->second;
+}
+
+void InferencePipeline::validate_output(const OutputOptions& options) const {
+    if (options.logits_out && options.logits_out_size < static_cast<size_t>(lm_head_.vocab_size)) {
+        throw std::runtime_error("Logits buffer holds " + std::to_string(options.logits_out_size) +
+                                 " floats; the vocab has " + std::to_string(lm_head_.vocab_size) + ".");
+    }
+}
+
+void InferencePipeline::begin_call(ConversationState& state, const int* tokens, size_t count, StepOutput& output) {
+    state.history.add(tokens, count);
+    if (state.speculation) {
+        state.speculation->pending.insert(state.speculation->pending.end(), tokens, tokens + count);
+    }
+    output.next_token = -1;
+    output.candidates.clear();
+}
 
-    TensorShape output_shape{{1, (int64_t)input_token_ids.size()}};
-    return tensor_manager_.create_tensor("output_logits", output_shape, DataType::FP32, DeviceType::CPU);
+void InferencePipeline::undo_call(ConversationState& state, const int* tokens, size_t count, int64_t consumed) {
+    // Positions past processed_token_count are never read, so the chunks
+    // that did run need no clearing.
+    state.processed_token_count -= static_cast<size_t>(consumed);
+    state.history.remove(tokens, count);
+    if (state.speculation) {
+        std::vector<int32_t>& pending = state.speculation->pending;
+        pending.resize(pending.size() - std::min(count, pending.size()));
+    }
+}
+
+void InferencePipeline::execute_without_decoder(PlanCall* calls, size_t count) {
+    ExecutionGraph graph;
+    std::vector<PlanCall*> planned;
+    std::vector<Tensor*> activations;
+    for (size_t i = 0; i < count; ++i) {
+        PlanCall& call = calls[i];
+        if (!embedding_weight_ || call.count == 0) {
+            continue;
+        }
+        ConversationState& state = *call.state;
+        const auto rows = static_cast<int64_t>(call.count);
+        try {
+            if (!plan_) {
+                state.activations.resize(static_cast<size_t>(rows * embedding_.hidden_size));
+                kernels::embedding_lookup(embedding_, kernel_context_, call.tokens, rows, embedding_scale_,
+                                          state.activations.data());
+                continue;
+            }
+            const auto& layers = plan_->layers();
+            if (state.plan_activations.empty() || state.plan_activations[0]->get_shape().dims[0] != rows) {
+                state.plan_activations.clear();
+                for (size_t l = 0; l <= layers.size(); ++l) {
+                    const int64_t width = l == 0 ? layers[0].in_features : layers[l - 1].out_features;
+                    state.plan_activations.push_back(tensor_manager_.create_tensor(
+                        "plan_activations_" + std::to_string(l), TensorShape{{rows, width}}, DataType::FP32,
+                        DeviceType::CPU));
+                }
+            }
+            kernels::embedding_lookup(embedding_, kernel_context_, call.tokens, rows, embedding_scale_,
+                                      static_cast<float*>(state.plan_activations[0]->get_data()));
+            activations.clear();
+            for (const auto& tensor : state.plan_activations) {
+                activations.push_back(tensor.get());
+            }
+            plan_->add_sequence(graph, activations);
+            planned.push_back(&call);
+        } catch (...) {
+            call.error = std::current_exception();
+        }
+    }
+    if (graph.size() > 0) {
+        try {
+            scheduler_->submit(graph).wait();
+        } catch (...) {
+            for (PlanCall* call : planned) {
+                call->error = std::current_exception();
+            }
+        }
+        for (PlanCall* call : planned) {
+            if (!call->error) {
+                // The output stage reads the last position.
+                const Tensor& out = *call->state->plan_activations.back();
+                const auto width = static_cast<size_t>(plan_->out_features());
+                const float* last = static_cast<const float*>(out.get_data()) + (call->count - 1) * width;
+                call->state->final_hidden.assign(last, last + width);
+            }
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        PlanCall& call = calls[i];
+        if (call.error) {
+            continue;
+        }
+        try {
+            run_output_stage(kernel_context_, *call.state, *call.options, *call.output);
+        } catch (...) {
+            call.error = std::current_exception();
+        }
+    }
+}
+
+void InferencePipeline::start_lanes() {
+    std::lock_guard<std::mutex> lock(batch_mtx_);
+    stopping_ = false;
+    for (StepLane& lane : lanes_) {
+        lane.thread = std::thread([this, &lane] { lane_loop(lane); });
+    }
+    const StepLane& interactive = lane_for(RequestPriority::INTERACTIVE);
+    const StepLane& background = lane_for(RequestPriority::BACKGROUND);
+    std::cout << "Scheduler: interactive steps on " << interactive.kernel_context.pool->get_num_threads()
+              << " big threads, background steps on " << background.kernel_context.pool->get_num_threads()
+              << " little threads." << std::endl;
+}
+
+void InferencePipeline::stop_lanes() {
+    {
+        std::lock_guard<std::mutex> lock(batch_mtx_);
+        stopping_ = true;
+        for (StepLane& lane : lanes_) {
+            lane.work_cv.notify_all();
+        }
+        batch_cv_.notify_all();
+    }
+    for (StepLane& lane : lanes_) {
+        if (lane.thread.joinable()) {
+            lane.thread.join();
+        }
+    }
+}
+
+void InferencePipeline::lane_loop(StepLane& lane) {
+    // Runs kernels as slot 0 of the lane's pool, so it sits where the pool's
+    // workers do.
+    pin_current_thread(lane.affinity_mask);
+    if (lane.nice != 0) {
+        set_current_thread_nice(lane.nice);
+    }
+    std::unique_lock<std::mutex> lock(batch_mtx_);
+    while (true) {
+        lane.work_cv.wait(lock, [&] { return stopping_ || !lane.pending.empty(); });
+        if (lane.pending.empty()) {
+            return; // Stopping, and Engine lets no call run across release().
+        }
+        take_step(lane);
+        lane.running = true;
+        lock.unlock();
+        run_step(lane, lane.step);
+        lock.lock();
+        finish_step(lane, lane.step);
+        lane.running = false;
+        batch_cv_.notify_all();
+    }
+}
+
+InferencePipeline::StepRequest InferencePipeline::make_request(ConversationState& state, const int* tokens,
+                                                              size_t count, const OutputOptions& options,
+                                                              StepOutput& output) const {
+    if (static_cast<int64_t>(state.processed_token_count + count) > max_positions_) {
+        throw std::runtime_error("Conversation exceeds the model's maximum sequence length.");
+    }
+    const auto now = std::chrono::steady_clock::now();
+    const auto deadline = state.options.deadline_ms > 0 ? now + std::chrono::milliseconds(state.options.deadline_ms)
+                                                        : std::chrono::steady_clock::time_point::max();
+    return StepRequest{&state, tokens, static_cast<int64_t>(count), &options, now, deadline, 0, &output, nullptr};
+}
+
+void InferencePipeline::run_requests(StepRequest* const* requests, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(batch_mtx_);
+    for (size_t i = 0; i < count; ++i) {
+        StepLane& lane = lane_for(requests[i]->state->options.priority);
+        lane.pending.push_back(requests[i]);
+        lane.work_cv.notify_one();
+    }
+    batch_cv_.wait(lock, [&] {
+        return std::all_of(requests, requests + count, [](const StepRequest* request) { return request->done; });
+    });
+}
+
+void InferencePipeline::take_step(StepLane& lane) {
+    // A conversation's requests run in arrival order: each one needs the
+    // positions of the one before it.
+    std::vector<StepRequest*>& ready = lane.ready;
+    std::vector<const ConversationState*>& queued = lane.queued;
+    ready.clear();
+    queued.clear();
+    for (StepRequest* request : lane.pending) {
+        if (std::find(queued.begin(), queued.end(), request->state) == queued.end()) {
+            queued.push_back(request->state);
+            ready.push_back(request);
+        }
+    }
+    // Earliest deadline first; arrival order among equal deadlines. An
+    // insertion sort, since std::stable_sort allocates a buffer and a lane
+    // holds a request per conversation at most.
+    for (size_t i = 1; i < ready.size(); ++i) {
+        StepRequest* request = ready[i];
+        size_t j = i;
+        for (; j > 0 && request->deadline < ready[j - 1]->deadline; --j) {
+            ready[j] = ready[j - 1];
+        }
+        ready[j] = request;
+    }
+
+    std::vector<StepChunk>& step = lane.step;
+    step.clear();
+    uint32_t decodes = 0;
+    for (StepRequest* request : ready) {
+        if (request->count == 1 && decodes < options_.max_decode_batch) {
+            step.push_back(StepChunk{request, 1});
+            ++decodes;
+        }
+    }
+    // Decode steps go first; prompts share what is left of the budget, which
+    // the constructor keeps above max_decode_batch so they always advance.
+    int64_t budget = static_cast<int64_t>(options_.step_token_budget) - decodes;
+    for (StepRequest* request : ready) {
+        if (budget <= 0) {
+            break;
+        }
+        if (request->count == 1) {
+            continue;
+        }
+        const int64_t chunk = std::min({static_cast<int64_t>(options_.prefill_chunk_tokens),
+                                        request->count - request->consumed, budget});
+        step.push_back(StepChunk{request, chunk});
+        budget -= chunk;
+    }
+}
+
+void InferencePipeline::yield_to_interactive(const std::vector<StepChunk>& step) {
+    const auto now = std::chrono::steady_clock::now();
+    for (const StepChunk& chunk : step) {
+        if (chunk.request->deadline <= now) {
+            return;
+        }
+    }
+    const StepLane& interactive = lane_for(RequestPriority::INTERACTIVE);
+    std::unique_lock<std::mutex> lock(batch_mtx_);
+    batch_cv_.wait(lock, [&] { return stopping_ || (!interactive.running && interactive.pending.empty()); });
+}
+
+void InferencePipeline::run_step(StepLane& lane, const std::vector<StepChunk>& step) {
+    const CpuKernelContext& ctx = lane.kernel_context;
+    const bool background = lane.priority == RequestPriority::BACKGROUND;
+    try {
+        const int64_t hidden = embedding_.hidden_size;
+        std::vector<int32_t>& tokens = lane.tokens;
+        tokens.clear();
+        for (const StepChunk& chunk : step) {
+            const int* first = chunk.request->tokens + chunk.request->consumed;
+            tokens.insert(tokens.end(), first, first + chunk.count);
+        }
+        const auto m = static_cast<int64_t>(tokens.size());
+        lane.rows.resize(static_cast<size_t>(m * hidden));
+        kernels::embedding_lookup(embedding_, ctx, tokens.data(), m, embedding_scale_, lane.rows.data());
+
+        std::vector<kernels::DecoderSequence>& sequences = lane.sequences;
+        sequences.resize(step.size());
+        for (size_t i = 0; i < layer_weights_.size(); ++i) {
+            if (background) {
+                yield_to_interactive(step);
+            }
+            for (size_t c = 0; c < step.size(); ++c) {
+                const ConversationState& state = *step[c].request->state;
+                kernels::DecoderSequence& seq = sequences[c];
+                seq.count = step[c].count;
+                seq.first_pos = static_cast<int64_t>(state.processed_token_count);
+                seq.cache.keys = state.kv_cache[i].first->get_data();
+                seq.cache.values = state.kv_cache[i].second->get_data();
+                seq.cache.data_type = state.kv_cache[i].first->get_data_type();
+                seq.cache.capacity = state.kv_cache[i].first->get_shape().dims[1];
+            }
+            kernels::decoder_layer_forward_batch(layer_params_[i], layer_weights_[i], ctx, lane.rows.data(),
+                                                 sequences.data(), sequences.size());
+        }
+        if (background) {
+            yield_to_interactive(step);
+        }
+
+        std::vector<float>& shared_rows = lane.shared_rows;
+        std::vector<StepRequest*>& shared = lane.shared;
+        std::vector<StepOutput*>& shared_outputs = lane.shared_outputs;
+        std::vector<TokenMask>& shared_masks = lane.shared_masks;
+        shared_rows.clear();
+        shared.clear();
+        shared_outputs.clear();
+        shared_masks.clear();
+        uint32_t top_k = 1;
+        int64_t row = 0;
+        for (const StepChunk& chunk : step) {
+            StepRequest& request = *chunk.request;
+            ConversationState& state = *request.state;
+            state.processed_token_count += static_cast<size_t>(chunk.count);
+            request.consumed += chunk.count;
+            row += chunk.count;
+            if (request.embedding) {
+                pool_embedding(lane, chunk, lane.rows.data() + (row - chunk.count) * hidden);
+                continue;
+            }
+            if (request.verify_rows > 0) {
+                // Keeps the chunk's rows that fall in the checked positions.
+                std::vector<float>& checked = state.speculation->hidden;
+                checked.resize(static_cast<size_t>(request.verify_rows * hidden));
+                const int64_t window = request.count - request.verify_rows;
+                const int64_t chunk_begin = request.consumed - chunk.count;
+                const int64_t begin = std::max(chunk_begin, window);
+                if (begin < request.consumed) {
+                    kernels::rms_norm(lane.rows.data() + (row - chunk.count + begin - chunk_begin) * hidden,
+                                      request.consumed - begin, hidden, final_norm_.data(),
+                                      constants::GEMMA3_RMS_NORM_EPS, checked.data() + (begin - window) * hidden);
+                }
+                if (request.consumed < request.count) {
+                    continue;
+                }
+                for (int64_t r = 0; r < request.verify_rows; ++r) {
+                    shared.push_back(&request);
+                    shared_outputs.push_back(request.output + r);
+                    shared_masks.push_back(request.options->allowed_tokens);
+                }
+                shared_rows.insert(shared_rows.end(), checked.begin(), checked.end());
+                top_k = std::max(top_k, effective_top_k(request.options->sampling));
+                continue;
+            }
+            if (request.consumed < request.count) {
+                continue; // A prompt chunk with more to come: no output yet.
+            }
+            state.final_hidden.resize(static_cast<size_t>(hidden));
+            kernels::rms_norm(lane.rows.data() + (row - 1) * hidden, 1, hidden, final_norm_.data(),
+                              constants::GEMMA3_RMS_NORM_EPS, state.final_hidden.data());
+            const OutputOptions& options = *request.options;
+            const uint32_t k = candidates_for_penalties(options.sampling, state.history);
+            if (!lm_head_weight_ || options.wants_logits() || k > MAX_FUSED_CANDIDATES) {
+                // Full logits need the single-row output stage.
+                run_output_stage(ctx, state, options, *request.output);
+                continue;
+            }
+            shared.push_back(&request);
+            shared_outputs.push_back(request.output);
+            shared_masks.push_back(options.allowed_tokens);
+            shared_rows.insert(shared_rows.end(), state.final_hidden.begin(), state.final_hidden.end());
+            top_k = std::max(top_k, k);
+        }
+        if (shared.empty()) {
+            return;
+        }
+        // One sweep of the vocab table for every row, at the largest top_k
+        // asked for; each request keeps the prefix it asked for and applies
+        // its penalties to that.
+        lane.candidates.resize(shared.size());
+        kernels::lm_head_top_k_batch(lm_head_, ctx, shared_rows.data(), static_cast<int64_t>(shared.size()), top_k,
+                                     lane.candidates.data(), shared_masks.data());
+        for (size_t b = 0; b < shared.size(); ++b) {
+            const SamplingParams& sampling = shared[b]->options->sampling;
+            ConversationState& state = *shared[b]->state;
+            const uint32_t k = candidates_for_penalties(sampling, state.history);
+            std::vector<TokenCandidate>& candidates = lane.candidates[b];
+            StepOutput& output = *shared_outputs[b];
+            output.candidates.assign(candidates.begin(),
+                                     candidates.begin() + std::min<size_t>(k, candidates.size()));
+            if (shared[b]->verify_rows > 0) {
+                continue; // execute_speculative() samples from them
+            }
+            apply_penalties(output.candidates, sampling, state.history, effective_top_k(sampling));
+            output.next_token = sample_from_candidates(output.candidates, sampling, state.rng);
+        }
+    } catch (...) {
+        const std::exception_ptr error = std::current_exception();
+        for (const StepChunk& chunk : step) {
+            chunk.request->error = error;
+        }
+    }
+}
+
+void InferencePipeline::pool_embedding(StepLane& lane, const StepChunk& chunk, const float* rows) {
+    const StepRequest& request = *chunk.request;
+    const EmbeddingOptions& options = *request.embedding_options;
+    const int64_t hidden = embedding_.hidden_size;
+    float* out = request.embedding;
+    const bool complete = request.consumed == request.count;
+    if (options.pooling == EmbeddingPooling::LAST_TOKEN) {
+        if (!complete) {
+            return;
+        }
+        kernels::rms_norm(rows + (chunk.count - 1) * hidden, 1, hidden, final_norm_.data(),
+                          constants::GEMMA3_RMS_NORM_EPS, out);
+    } else {
+        std::vector<float>& pooled = lane.pooled;
+        pooled.resize(static_cast<size_t>(chunk.count * hidden));
+        kernels::rms_norm(rows, chunk.count, hidden, final_norm_.data(), constants::GEMMA3_RMS_NORM_EPS,
+                          pooled.data());
+        for (int64_t r = 0; r < chunk.count; ++r) {
+            const float* normed = pooled.data() + r * hidden;
+            for (int64_t j = 0; j < hidden; ++j) {
+                out[j] += normed[j];
+            }
+        }
+        if (!complete) {
+            return;
+        }
+        const float scale = 1.0f / static_cast<float>(request.count);
+        for (int64_t j = 0; j < hidden; ++j) {
+            out[j] *= scale;
+        }
+    }
+    if (options.normalize) {
+        double sum = 0.0;
+        for (int64_t j = 0; j < hidden; ++j) {
+            sum += static_cast<double>(out[j]) * out[j];
+        }
+        if (sum > 0.0) {
+            const auto scale = static_cast<float>(1.0 / std::sqrt(sum));
+            for (int64_t j = 0; j < hidden; ++j) {
+                out[j] *= scale;
+            }
+        }
+    }
+}
+
+void InferencePipeline::finish_step(StepLane& lane, const std::vector<StepChunk>& step) {
+    const auto now = std::chrono::steady_clock::now();
+    for (const StepChunk& chunk : step) {
+        StepRequest* request = chunk.request;
+        if (!request->error && request->consumed < request->count) {
+            continue;
+        }
+        // A speculative check is a step of several tokens; the speculation
+        // stats cover it.
+        if (!request->error && !request->embedding && request->verify_rows == 0) {
+            const float ms = std::chrono::duration<float, std::milli>(now - request->queued_at).count();
+            (request->count == 1 ? lane.itl : lane.ttft).record(ms);
+            lane.deadline_misses += now > request->deadline ? 1 : 0;
+        }
+        request->done = true;
+        lane.pending.erase(std::find(lane.pending.begin(), lane.pending.end(), request));
+    }
+}
+
+void InferencePipeline::LatencyWindow::record(float ms) {
+    if (samples.size() < LATENCY_WINDOW) {
+        samples.push_back(ms);
+    } else {
+        samples[next] = ms;
+        next = (next + 1) % LATENCY_WINDOW;
+    }
+    ++total;
+}
+
+void InferencePipeline::LatencyWindow::clear() {
+    samples.clear();
+    samples.reserve(LATENCY_WINDOW);
+    next = 0;
+    total = 0;
+}
+
+LatencyStats InferencePipeline::get_latency_stats(RequestPriority priority) {
+    std::lock_guard<std::mutex> lock(batch_mtx_);
+    const StepLane& lane = lane_for(priority);
+    LatencyStats stats;
+    stats.decode_steps = lane.itl.total;
+    stats.itl_p50_ms = percentile(lane.itl.samples, 0.50);
+    stats.itl_p99_ms = percentile(lane.itl.samples, 0.99);
+    stats.itl_max_ms = percentile(lane.itl.samples, 1.0);
+    stats.prompts = lane.ttft.total;
+    stats.ttft_p50_ms = percentile(lane.ttft.samples, 0.50);
+    stats.ttft_p99_ms = percentile(lane.ttft.samples, 0.99);
+    stats.deadline_misses = lane.deadline_misses;
+    return stats;
+}
+
+void InferencePipeline::reset_latency_stats() {
+    std::lock_guard<std::mutex> lock(batch_mtx_);
+    for (StepLane& lane : lanes_) {
+        lane.itl.clear();
+        lane.ttft.clear();
+        lane.deadline_misses = 0;
+    }
+}
+
+void InferencePipeline::log_latency_stats() {
+    for (RequestPriority priority : {RequestPriority::INTERACTIVE, RequestPriority::BACKGROUND}) {
+        const LatencyStats stats = get_latency_stats(priority);
+        if (stats.decode_steps == 0 && stats.prompts == 0) {
+            continue;
+        }
+        const char* name = priority == RequestPriority::INTERACTIVE ? "interactive" : "background";
+        std::cout << "Latency (" << name << "): " << stats.decode_steps << " decode steps, ITL p50 "
+                  << stats.itl_p50_ms << " ms, p99 " << stats.itl_p99_ms << " ms, max " << stats.itl_max_ms << " ms; "
+                  << stats.prompts << " prompts, TTFT p50 " << stats.ttft_p50_ms << " ms, p99 " << stats.ttft_p99_ms
+                  << " ms; " << stats.deadline_misses << " past deadline." << std::endl;
+    }
+}
+
+void InferencePipeline::run_output_stage(const CpuKernelContext& ctx, ConversationState& state,
+                                         const OutputOptions& options, StepOutput& output) {
+    if (!lm_head_weight_ || state.final_hidden.size() != static_cast<size_t>(lm_head_.hidden_size)) {
+        return;
+    }
+    float* logits = nullptr;
+    if (options.logits_out) {
+        logits = options.logits_out; // Sized by execute()
+    } else if (options.return_logits) {
+        // A reused output keeps its tensor.
+        if (!output.logits || output.logits->get_data_type() != DataType::FP32 ||
+            output.logits->get_shape().num_elements() != static_cast<size_t>(lm_head_.vocab_size)) {
+            output.logits = tensor_manager_.create_tensor("output_logits", TensorShape{{1, lm_head_.vocab_size}},
+                                                          DataType::FP32, DeviceType::CPU);
+        }
+        logits = static_cast<float*>(output.logits->get_data());
+    }
+    const uint32_t top_k = candidates_for_penalties(options.sampling, state.history);
+    if (top_k > MAX_FUSED_CANDIDATES) {
+        // Too many penalized tokens to over-fetch: sample the whole row.
+        thread_local std::vector<float> row;
+        if (!logits) {
+            row.resize(static_cast<size_t>(lm_head_.vocab_size));
+            logits = row.data();
+        }
+        kernels::lm_head_top_k(lm_head_, ctx, state.final_hidden.data(), 1, output.candidates, logits,
+                               options.allowed_tokens);
+        output.next_token = sample_from_logits(*ctx.sampling, logits, lm_head_.vocab_size, options.sampling,
+                                               &state.history, state.rng, output.candidates);
+        return;
+    }
+    kernels::lm_head_top_k(lm_head_, ctx, state.final_hidden.data(), top_k, output.candidates, logits,
+                           options.allowed_tokens);
+    apply_penalties(output.candidates, options.sampling, state.history, effective_top_k(options.sampling));
+    output.next_token = sample_from_candidates(output.candidates, options.sampling, state.rng);
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,415 @@
+#include "t760_engine/pipeline/Sampler.h"
+#include "t760_engine/kernels/HalfMatmul.h"
+#include "t760_engine/kernels/Sampling.h"
+#include <algorithm>
+#include <cmath>
+
+namespace t760 {
+
+namespace {
+
+// Above this many candidates a heap loses to quickselect over the row.
+constexpr int64_t HEAP_SELECT_MAX = 2048;
+// Prefix sorted first when top_p needs a large set in order, grown 4x a round.
+constexpr int64_t NUCLEUS_SORT_STEP = 256;
+
+uint32_t effective_top_k(const SamplingParams& params) {
+    return params.top_k > 0 ? params.top_k : constants::DEFAULT_SAMPLING_TOP_K;
+}
+
+bool is_greedy(const SamplingParams& params) {
+    return !params.do_sample || params.temperature <= 0.0f;
+}
+
+size_t token_slot(int32_t token, size_t mask) {
+    return static_cast<size_t>((static_cast<uint32_t>(token) * 0x9E3779B1u) >> 7) & mask;
+}
+
+float penalized(float logit, uint32_t count, const SamplingParams& params) {
+    if (params.repetition_penalty != 1.0f) {
+        logit = logit > 0.0f ? logit / params.repetition_penalty : logit * params.repetition_penalty;
+    }
+    return logit - params.frequency_penalty * static_cast<float>(count);
+}
+
+// Samples from an unsorted candidate set too large for sample_from_candidates,
+// as it would: temperature softmax over the set, then the smallest
+// best-first prefix holding top_p of the mass. Reorders set.
+int32_t sample_large_set(const kernels::SamplingKernelSet& ks, std::vector<TokenCandidate>& set,
+                         const SamplingParams& params, std::mt19937& rng) {
+    const auto count = static_cast<int64_t>(set.size());
+    thread_local std::vector<float> probs;
+    probs.resize(set.size());
+    for (int64_t i = 0; i < count; ++i) {
+        probs[i] = set[i].logit;
+    }
+    const float inv_temperature = 1.0f / params.temperature;
+    const float max_logit = ks.max(probs.data(), count);
+    const float total = ks.exp_sum(probs.data(), count, max_logit, inv_temperature, probs.data());
+
+    if (params.top_p <= 0.0f || params.top_p >= 1.0f) {
+        float pick = uniform_unit(rng) * total;
+        for (int64_t i = 0; i < count; ++i) {
+            pick -= probs[i];
+            if (pick < 0.0f) {
+                return set[i].token_id;
+            }
+        }
+        return set[count - 1].token_id;
+    }
+
+    // Sorts only as much of the set, best first, as the nucleus covers.
+    const float target = params.top_p * total;
+    float mass = 0.0f;
+    int64_t sorted = 0;
+    int64_t keep = 0;
+    for (int64_t step = NUCLEUS_SORT_STEP; keep == 0; step *= 4) {
+        const int64_t end = std::min(count, sorted + step);
+        std::partial_sort(set.begin() + sorted, set.begin() + end, set.end(), kernels::ranks_before);
+        for (int64_t i = sorted; i < end; ++i) {
+            mass += std::exp((set[i].logit - max_logit) * inv_temperature);
+            if (mass >= target || i + 1 == count) {
+                keep = i + 1;
+                break;
+            }
+        }
+        sorted = end;
+    }
+    float pick = uniform_unit(rng) * mass;
+    for (int64_t i = 0; i < keep; ++i) {
+        pick -= std::exp((set[i].logit - max_logit) * inv_temperature);
+        if (pick < 0.0f) {
+            return set[i].token_id;
+        }
+    }
+    return set[keep - 1].token_id;
+}
+
+// Candidates a whole-row selection keeps before penalties so that the best
+// `keep` after them are among them (see candidates_for_penalties).
+int64_t selection_size(const SamplingParams& params, const TokenHistory* history, uint32_t keep,
+                       int64_t vocab_size) {
+    const size_t penalized = history && params.has_penalties() ? history->distinct() : 0;
+    return std::min<int64_t>(keep + static_cast<int64_t>(penalized), vocab_size);
+}
+
+// The rest of sample_from_logits: set is either the heap's selection, sorted,
+// or (beyond HEAP_SELECT_MAX) the whole row in token order.
+int32_t sample_selected(const kernels::SamplingKernelSet& ks, std::vector<TokenCandidate>& set, uint32_t keep,
+                        const SamplingParams& params, const TokenHistory* history, std::mt19937& rng,
+                        std::vector<TokenCandidate>& candidates) {
+    if (static_cast<int64_t>(set.size()) <= HEAP_SELECT_MAX) {
+        // Finish as the fused lm_head path does.
+        if (history) {
+            apply_penalties(set, params, *history, keep);
+        } else if (set.size() > keep) {
+            set.resize(keep);
+        }
+        candidates.swap(set);
+        return sample_from_candidates(candidates, params, rng);
+    }
+    if (history && params.has_penalties()) {
+        for (const auto& [token, n] : history->entries()) {
+            if (token >= 0 && static_cast<size_t>(token) < set.size()) {
+                set[static_cast<size_t>(token)].logit = penalized(set[static_cast<size_t>(token)].logit, n, params);
+            }
+        }
+    }
+    candidates.clear();
+    if (is_greedy(params)) {
+        return std::min_element(set.begin(), set.end(), kernels::ranks_before)->token_id;
+    }
+    if (set.size() > keep) {
+        std::nth_element(set.begin(), set.begin() + keep, set.end(), kernels::ranks_before);
+        set.resize(keep);
+    }
+    return sample_large_set(ks, set, params, rng);
+}
+
+} // namespace
+
+void TokenHistory::reserve(size_t distinct) {
+    entries_.reserve(distinct);
+    size_t slot_count = 16;
+    while (slot_count < 2 * distinct) {
+        slot_count *= 2;
+    }
+    if (slot_count > slots_.size()) {
+        rehash(slot_count);
+    }
+}
+
+void TokenHistory::add(const int* tokens, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        // Kept at most half full, so probes stay short.
+        if (2 * (entries_.size() + 1) > slots_.size()) {
+            rehash(std::max<size_t>(16, 2 * slots_.size()));
+        }
+        const size_t mask = slots_.size() - 1;
+        size_t slot = token_slot(tokens[i], mask);
+        while (slots_[slot] >= 0 && entries_[static_cast<size_t>(slots_[slot])].token != tokens[i]) {
+            slot = (slot + 1) & mask;
+        }
+        if (slots_[slot] < 0) {
+            slots_[slot] = static_cast<int32_t>(entries_.size());
+            entries_.push_back(Entry{tokens[i], 0});
+        }
+        ++entries_[static_cast<size_t>(slots_[slot])].count;
+    }
+}
+
+void TokenHistory::remove(const int* tokens, size_t count) {
+    if (slots_.empty()) {
+        return;
+    }
+    const size_t mask = slots_.size() - 1;
+    bool emptied = false;
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t slot = token_slot(tokens[i], mask); slots_[slot] >= 0; slot = (slot + 1) & mask) {
+            Entry& entry = entries_[static_cast<size_t>(slots_[slot])];
+            if (entry.token == tokens[i]) {
+                emptied |= entry.count > 0 && --entry.count == 0;
+                break;
+            }
+        }
+    }
+    if (emptied) {
+        // Probe chains cannot lose a link in place, so rebuild them.
+        entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [](const Entry& e) { return e.count == 0; }),
+                       entries_.end());
+        rehash(slots_.size());
+    }
+}
+
+uint32_t TokenHistory::count(int32_t token) const {
+    if (slots_.empty()) {
+        return 0;
+    }
+    const size_t mask = slots_.size() - 1;
+    for (size_t slot = token_slot(token, mask); slots_[slot] >= 0; slot = (slot + 1) & mask) {
+        const Entry& entry = entries_[static_cast<size_t>(slots_[slot])];
+        if (entry.token == token) {
+            return entry.count;
+        }
+    }
+    return 0;
+}
+
+void TokenHistory::clear() {
+    entries_.clear();
+    std::fill(slots_.begin(), slots_.end(), -1);
+}
+
+void TokenHistory::rehash(size_t slot_count) {
+    slots_.assign(slot_count, -1);
+    const size_t mask = slot_count - 1;
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        size_t slot = token_slot(entries_[i].token, mask);
+        while (slots_[slot] >= 0) {
+            slot = (slot + 1) & mask;
+        }
+        slots_[slot] = static_cast<int32_t>(i);
+    }
+}
+
+float uniform_unit(std::mt19937& rng) {
+    return static_cast<float>(rng() >> 8) * (1.0f / 16777216.0f);
+}
+
+uint32_t candidates_for_penalties(const SamplingParams& params, const TokenHistory& history) {
+    const uint32_t top_k = effective_top_k(params);
+    return params.has_penalties() ? top_k + static_cast<uint32_t>(history.distinct()) : top_k;
+}
+
+void apply_penalties(std::vector<TokenCandidate>& candidates, const SamplingParams& params,
+                     const TokenHistory& history, uint32_t top_k) {
+    if (params.has_penalties() && history.distinct() > 0) {
+        bool changed = false;
+        for (TokenCandidate& c : candidates) {
+            const uint32_t n = history.count(c.token_id);
+            if (n > 0) {
+                c.logit = penalized(c.logit, n, params);
+                changed = true;
+            }
+        }
+        if (changed) {
+            std::sort(candidates.begin(), candidates.end(), kernels::ranks_before);
+        }
+    }
+    if (candidates.size() > top_k) {
+        candidates.resize(top_k);
+    }
+}
+
+int32_t sample_from_candidates(const std::vector<TokenCandidate>& candidates, const SamplingParams& params,
+                               std::mt19937& rng) {
+    if (candidates.empty()) {
+        return -1;
+    }
+    if (is_greedy(params) || candidates.size() == 1) {
+        return candidates.front().token_id;
+    }
+
+    size_t count = candidates.size();
+    if (params.top_k > 0) {
+        count = std::min<size_t>(count, params.top_k);
+    }
+
+    // Candidates are sorted, so the first one carries the max logit.
+    thread_local std::vector<float> probs;
+    probs.resize(count);
+    const float inv_temperature = 1.0f / params.temperature;
+    const float max_logit = candidates.front().logit;
+    float total = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        probs[i] = std::exp((candidates[i].logit - max_logit) * inv_temperature);
+        total += probs[i];
+    }
+
+    // Nucleus cutoff: always keeps at least the best candidate.
+    if (params.top_p > 0.0f && params.top_p < 1.0f) {
+        const float target = params.top_p * total;
+        float mass = 0.0f;
+        size_t keep = 0;
+        while (keep < count && mass < target) {
+            mass += probs[keep++];
+        }
+        count = std::max<size_t>(keep, 1);
+        total = mass > 0.0f ? mass : probs[0];
+    }
+
+    float pick = uniform_unit(rng) * total;
+    for (size_t i = 0; i < count; ++i) {
+        pick -= probs[i];
+        if (pick < 0.0f) {
+            return candidates[i].token_id;
+        }
+    }
+    return candidates[count - 1].token_id;
+}
+
+void candidate_probabilities(const std::vector<TokenCandidate>& candidates, const SamplingParams& params,
+                             std::vector<float>& probs) {
+    probs.assign(candidates.size(), 0.0f);
+    if (candidates.empty()) {
+        return;
+    }
+    if (is_greedy(params) || candidates.size() == 1) {
+        probs[0] = 1.0f;
+        return;
+    }
+    size_t count = candidates.size();
+    if (params.top_k > 0) {
+        count = std::min<size_t>(count, params.top_k);
+    }
+    // As sample_from_candidates weighs them.
+    const float inv_temperature = 1.0f / params.temperature;
+    const float max_logit = candidates.front().logit;
+    float total = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        probs[i] = std::exp((candidates[i].logit - max_logit) * inv_temperature);
+        total += probs[i];
+    }
+    if (params.top_p > 0.0f && params.top_p < 1.0f) {
+        const float target = params.top_p * total;
+        float mass = 0.0f;
+        size_t keep = 0;
+        while (keep < count && mass < target) {
+            mass += probs[keep++];
+        }
+        keep = std::max<size_t>(keep, 1);
+        std::fill(probs.begin() + static_cast<std::ptrdiff_t>(keep), probs.end(), 0.0f);
+        total = mass > 0.0f ? mass : probs[0];
+    }
+    for (float& p : probs) {
+        p /= total;
+    }
+}
+
+bool verify_draft_token(int32_t draft_token, const std::vector<TokenCandidate>& target,
+                        const std::vector<float>& target_probs, const std::vector<TokenCandidate>& draft,
+                        const std::vector<float>& draft_probs, std::mt19937& rng, int32_t& replacement) {
+    // The draft's probabilities by token, for lookups from the target's set.
+    thread_local std::vector<TokenCandidate> by_token;
+    by_token.resize(draft.size());
+    for (size_t i = 0; i < draft.size(); ++i) {
+        by_token[i] = TokenCandidate{draft[i].token_id, draft_probs[i]};
+    }
+    std::sort(by_token.begin(), by_token.end(),
+              [](const TokenCandidate& a, const TokenCandidate& b) { return a.token_id < b.token_id; });
+    const auto draft_prob = [&](int32_t token) {
+        const auto it = std::lower_bound(by_token.begin(), by_token.end(), token,
+                                         [](const TokenCandidate& c, int32_t t) { return c.token_id < t; });
+        return it != by_token.end() && it->token_id == token ? it->logit : 0.0f;
+    };
+    float p = 0.0f;
+    for (size_t i = 0; i < target.size(); ++i) {
+        if (target[i].token_id == draft_token) {
+            p = target_probs[i];
+            break;
+        }
+    }
+    const float q = draft_prob(draft_token);
+    if (p >= q || uniform_unit(rng) * q < p) {
+        return true;
+    }
+
+    thread_local std::vector<float> residual;
+    residual.resize(target.size());
+    float total = 0.0f;
+    for (size_t i = 0; i < target.size(); ++i) {
+        residual[i] = std::max(0.0f, target_probs[i] - draft_prob(target[i].token_id));
+        total += residual[i];
+    }
+    // p at or under q everywhere, to rounding: p itself is the residual.
+    const std::vector<float>& weights = total > 0.0f ? residual : target_probs;
+    float pick = uniform_unit(rng) * (total > 0.0f ? total : 1.0f);
+    replacement = -1;
+    for (size_t i = 0; i < target.size(); ++i) {
+        if (weights[i] <= 0.0f) {
+            continue;
+        }
+        replacement = target[i].token_id;
+        pick -= weights[i];
+        if (pick < 0.0f) {
+            break;
+        }
+    }
+    return false;
+}
+
+int32_t sample_from_logits(const kernels::SamplingKernelSet& ks, const float* logits, int64_t vocab_size,
+                           const SamplingParams& params, const TokenHistory* history, std::mt19937& rng,
+                           std::vector<TokenCandidate>& candidates) {
+    const auto keep = static_cast<uint32_t>(std::min<int64_t>(effective_top_k(params), vocab_size));
+    const int64_t select = selection_size(params, history, keep, vocab_size);
+    thread_local std::vector<TokenCandidate> set;
+    if (select <= HEAP_SELECT_MAX) {
+        kernels::top_k_logits(ks, logits, vocab_size, select, set);
+    } else {
+        set.resize(static_cast<size_t>(vocab_size));
+        for (int64_t i = 0; i < vocab_size; ++i) {
+            set[i] = TokenCandidate{static_cast<int32_t>(i), logits[i]};
+        }
+    }
+    return sample_selected(ks, set, keep, params, history, rng, candidates);
+}
+
+int32_t sample_from_logits_f16(const kernels::SamplingKernelSet& ks, const kernels::HalfKernelSet& half,
+                               const uint16_t* logits, int64_t vocab_size, const SamplingParams& params,
+                               const TokenHistory* history, std::mt19937& rng,
+                               std::vector<TokenCandidate>& candidates) {
+    const auto keep = static_cast<uint32_t>(std::min<int64_t>(effective_top_k(params), vocab_size));
+    const int64_t select = selection_size(params, history, keep, vocab_size);
+    if (select > HEAP_SELECT_MAX) {
+        thread_local std::vector<float> widened;
+        widened.resize(static_cast<size_t>(vocab_size));
+        half.f16_to_f32(logits, widened.data(), vocab_size);
+        return sample_from_logits(ks, widened.data(), vocab_size, params, history, rng, candidates);
+    }
+    thread_local std::vector<TokenCandidate> set;
+    kernels::top_k_logits_f16(ks, half, logits, vocab_size, select, set);
+    return sample_selected(ks, set, keep, params, history, rng, candidates);
+}
+
+}
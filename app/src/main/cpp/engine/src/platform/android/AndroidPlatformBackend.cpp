@@ -70,4 +70,8 @@ IMemoryAllocator* AndroidPlatformBackend::get_cpu_allocator() const {
     return cpu_allocator_.get();
 }
 
+std::unique_ptr<IPlatformBackend> create_platform_backend() {
+    return std::make_unique<AndroidPlatformBackend>();
+}
+
 }
\ No newline at end of file
@@ -1,15 +1,148 @@
 #include <jni.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 #include "t760_engine/core/Engine.h"
+#include "t760_engine/core/Generation.h"
 #include "t760_engine/core/Types.h"
 #include "t760_engine/tensor/Tensor.h"
 
-static std::unique_ptr<t760::Engine> g_engine = nullptr;
+// g_engine_mutex guards the pointer only. Each call takes its own reference
+// and then runs unlocked, so Java threads driving different conversations
+// generate in parallel; the Engine serializes its own lifecycle against the
+// calls in flight. A call racing nativeShutdown keeps the Engine object alive
+// until it returns.
+static std::shared_ptr<t760::Engine> g_engine = nullptr;
 static std::mutex g_engine_mutex;
 
+static std::shared_ptr<t760::Engine> acquire_engine() {
+    std::lock_guard<std::mutex> lock(g_engine_mutex);
+    return g_engine;
+}
+
+// generate_async tasks by the id handed to Java. Their tokens go through a
+// TokenStream that Java drains in batches with nativeReadTokens.
+struct JniGeneration {
+    std::shared_ptr<t760::GenerationTask> task;
+    std::shared_ptr<t760::TokenStream> stream;
+};
+static std::unordered_map<jlong, JniGeneration> g_generations;
+static jlong g_next_generation_id = 1;
+static std::mutex g_generations_mutex;
+
+static bool find_generation(jlong generation_id, JniGeneration& generation) {
+    std::lock_guard<std::mutex> lock(g_generations_mutex);
+    auto it = g_generations.find(generation_id);
+    if (it == g_generations.end()) return false;
+    generation = it->second;
+    return true;
+}
+
+// compile_grammar results by the id handed to Java; a generation holds its
+// own reference, so releasing one in use is safe.
+static std::unordered_map<jlong, std::shared_ptr<const t760::TokenGrammar>> g_grammars;
+static jlong g_next_grammar_id = 1;
+static std::mutex g_grammars_mutex;
+
+// Grammar 0 is none; false for an id that was never issued or is released.
+static bool find_grammar(jlong grammar_id, std::shared_ptr<const t760::TokenGrammar>& grammar) {
+    if (grammar_id == 0) return true;
+    std::lock_guard<std::mutex> lock(g_grammars_mutex);
+    auto it = g_grammars.find(grammar_id);
+    if (it == g_grammars.end()) return false;
+    grammar = it->second;
+    return true;
+}
+
+// Raises IllegalArgumentException in the calling Java thread; the native
+// returns right after, and its return value is ignored.
+static void throw_illegal_argument(JNIEnv* env, const char* message) {
+    jclass exception_class = env->FindClass("java/lang/IllegalArgumentException");
+    if (exception_class != nullptr) env->ThrowNew(exception_class, message);
+}
+
+static std::vector<int> copy_int_array(JNIEnv* env, jintArray array) {
+    if (array == nullptr) return {};
+    std::vector<int> values(static_cast<size_t>(env->GetArrayLength(array)));
+    env->GetIntArrayRegion(array, 0, static_cast<jsize>(values.size()), reinterpret_cast<jint*>(values.data()));
+    return values;
+}
+
+// Java passes text as UTF-8 bytes (String.getBytes(UTF_8)) rather than
+// jstring, whose modified UTF-8 encodes supplementary characters as
+// surrogate pairs.
+static std::string copy_byte_array(JNIEnv* env, jbyteArray array) {
+    if (array == nullptr) return {};
+    std::string bytes(static_cast<size_t>(env->GetArrayLength(array)), '\0');
+    env->GetByteArrayRegion(array, 0, static_cast<jsize>(bytes.size()), reinterpret_cast<jbyte*>(bytes.data()));
+    return bytes;
+}
+
+// The sampling arguments the generate natives share.
+static t760::GenerationParams make_generation_params(JNIEnv* env, jint max_new_tokens, jfloat temperature,
+                                                     jint top_k, jfloat top_p, jfloat repetition_penalty,
+                                                     jfloat frequency_penalty, jintArray stop_token_ids) {
+    t760::GenerationParams params;
+    params.max_new_tokens = max_new_tokens > 0 ? static_cast<uint32_t>(max_new_tokens) : 0;
+    params.sampling.temperature = temperature;
+    params.sampling.do_sample = temperature > 0.0f;
+    if (top_k > 0) params.sampling.top_k = static_cast<uint32_t>(top_k);
+    if (top_p > 0.0f && top_p <= 1.0f) params.sampling.top_p = top_p;
+    if (repetition_penalty > 0.0f) params.sampling.repetition_penalty = repetition_penalty;
+    params.sampling.frequency_penalty = frequency_penalty;
+    const std::vector<int> stops = copy_int_array(env, stop_token_ids);
+    params.stop_tokens.assign(stops.begin(), stops.end());
+    return params;
+}
+
+// One int[] of prompt tokens per element of prompts, all sampled with params.
+static std::vector<t760::BatchPrompt> copy_batch_prompts(JNIEnv* env, jobjectArray prompts,
+                                                         const t760::GenerationParams& params) {
+    std::vector<t760::BatchPrompt> batch(prompts != nullptr ? static_cast<size_t>(env->GetArrayLength(prompts)) : 0);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        jobject prompt = env->GetObjectArrayElement(prompts, static_cast<jsize>(i));
+        batch[i].tokens = copy_int_array(env, static_cast<jintArray>(prompt));
+        batch[i].params = params;
+        env->DeleteLocalRef(prompt);
+    }
+    return batch;
+}
+
+static t760::RequestPriority to_priority(jint priority) {
+    return priority == 1 ? t760::RequestPriority::BACKGROUND : t760::RequestPriority::INTERACTIVE;
+}
+
+static t760::EmbeddingOptions make_embedding_options(jint pooling, jboolean normalize, jint priority) {
+    t760::EmbeddingOptions options;
+    options.pooling = pooling == 0 ? t760::EmbeddingPooling::LAST_TOKEN : t760::EmbeddingPooling::MEAN;
+    options.normalize = normalize == JNI_TRUE;
+    options.priority = to_priority(priority);
+    return options;
+}
+
+// Address of a direct ByteBuffer (ByteBuffer.allocateDirect) and its capacity
+// in elements of T, read and written in place in native byte order; null
+// when buffer is null or not direct.
+template <typename T>
+static T* direct_buffer(JNIEnv* env, jobject buffer, size_t& capacity) {
+    capacity = 0;
+    if (buffer == nullptr) return nullptr;
+    void* address = env->GetDirectBufferAddress(buffer);
+    const jlong bytes = env->GetDirectBufferCapacity(buffer);
+    if (address == nullptr || bytes < 0) return nullptr;
+    capacity = static_cast<size_t>(bytes) / sizeof(T);
+    return static_cast<T*>(address);
+}
+
+// nativeGenerateDirect results other than a token id.
+constexpr jint GENERATE_NO_TOKEN = -1;
+constexpr jint GENERATE_FAILED = -2;
+
 extern "C" JNIEXPORT jboolean JNICALL
 Java_com_slearn_NativeEngine_nativeInit(
     JNIEnv* env,
@@ -20,14 +153,15 @@ Java_com_slearn_NativeEngine_nativeInit(
         return JNI_TRUE;
     }
     try {
-        g_engine = std::make_unique<t760::Engine>();
+        auto engine = std::make_shared<t760::Engine>();
         t760::EngineConfig config;
         config.devices = {
             {t760::DeviceType::CPU, 0, true},
             {t760::DeviceType::GPU, 0, true},
             {t760::DeviceType::NPU, 0, true}
         };
-        g_engine->initialize(config);
+        engine->initialize(config);
+        g_engine = std::move(engine);
     } catch (const std::exception& e) {
         return JNI_FALSE;
     }
@@ -38,10 +172,14 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_slearn_NativeEngine_nativeShutdown(
     JNIEnv* env,
     jobject /* this */) {
-    std::lock_guard<std::mutex> lock(g_engine_mutex);
-    if (g_engine) {
-        g_engine->shutdown();
-        g_engine.reset();
+    std::shared_ptr<t760::Engine> engine;
+    {
+        std::lock_guard<std::mutex> lock(g_engine_mutex);
+        engine = std::move(g_engine);
+    }
+    if (engine) {
+        // Waits for the calls in flight; any that follow see a shut-down engine.
+        engine->shutdown();
     }
 }
 
@@ -50,31 +188,113 @@ Java_com_slearn_NativeEngine_nativeLoadModel(
     JNIEnv* env,
     jobject /* this */,
     jstring model_path) {
-    std::lock_guard<std::mutex> lock(g_engine_mutex);
-    if (!g_engine) return JNI_FALSE;
+    auto engine = acquire_engine();
+    if (!engine) return JNI_FALSE;
     const char* c_model_path = env->GetStringUTFChars(model_path, nullptr);
     if (c_model_path == nullptr) return JNI_FALSE;
     std::string path_str(c_model_path);
     env->ReleaseStringUTFChars(model_path, c_model_path);
-    return static_cast<jboolean>(g_engine->load_model(path_str));
+    try {
+        return static_cast<jboolean>(engine->load_model(path_str));
+    } catch (const std::exception& e) {
+        return JNI_FALSE;
+    }
 }
 
 extern "C" JNIEXPORT void JNICALL
 Java_com_slearn_NativeEngine_nativeUnloadModel(
     JNIEnv* env,
     jobject /* this */) {
-    std::lock_guard<std::mutex> lock(g_engine_mutex);
-    if (g_engine) g_engine->unload_model();
+    auto engine = acquire_engine();
+    if (!engine) return;
+    try {
+        engine->unload_model();
+    } catch (const std::exception& e) {
+        // An exception must not unwind into the JVM.
+    }
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_slearn_NativeEngine_nativeLoadDraftModel(
+    JNIEnv* env,
+    jobject /* this */,
+    jstring model_path) {
+    auto engine = acquire_engine();
+    if (!engine) return JNI_FALSE;
+    const char* c_model_path = env->GetStringUTFChars(model_path, nullptr);
+    if (c_model_path == nullptr) return JNI_FALSE;
+    std::string path_str(c_model_path);
+    env->ReleaseStringUTFChars(model_path, c_model_path);
+    try {
+        return static_cast<jboolean>(engine->load_draft_model(path_str));
+    } catch (const std::exception& e) {
+        return JNI_FALSE;
+    }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_slearn_NativeEngine_nativeUnloadDraftModel(
+    JNIEnv* env,
+    jobject /* this */) {
+    auto engine = acquire_engine();
+    if (!engine) return;
+    try {
+        engine->unload_draft_model();
+    } catch (const std::exception& e) {
+    }
+}
+
+// {steps, proposed tokens, accepted tokens, acceptance rate, emitted tokens,
+// tokens/s}, or null.
+extern "C" JNIEXPORT jdoubleArray JNICALL
+Java_com_slearn_NativeEngine_nativeGetSpeculationStats(
+    JNIEnv* env,
+    jobject /* this */) {
+    auto engine = acquire_engine();
+    if (!engine) return nullptr;
+    const t760::SpeculationStats stats = engine->get_speculation_stats();
+    const jdouble values[6] = {static_cast<jdouble>(stats.steps), static_cast<jdouble>(stats.drafted),
+                               static_cast<jdouble>(stats.accepted), stats.acceptance_rate(),
+                               static_cast<jdouble>(stats.emitted), stats.tokens_per_second()};
+    jdoubleArray result_array = env->NewDoubleArray(6);
+    if (result_array == nullptr) return nullptr;
+    env->SetDoubleArrayRegion(result_array, 0, 6, values);
+    return result_array;
 }
 
 extern "C" JNIEXPORT jlong JNICALL
 Java_com_slearn_NativeEngine_nativeStartConversation(
     JNIEnv* env,
     jobject /* this */) {
-    std::lock_guard<std::mutex> lock(g_engine_mutex);
-    if (!g_engine || !g_engine->is_model_loaded()) return 0;
-    t760::ConversationHandle handle = g_engine->start_new_conversation();
-    return static_cast<jlong>(handle.id);
+    auto engine = acquire_engine();
+    if (!engine) return 0;
+    try {
+        t760::ConversationHandle handle = engine->start_new_conversation();
+        return static_cast<jlong>(handle.id);
+    } catch (const std::exception& e) {
+        return 0;
+    }
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_slearn_NativeEngine_nativeStartConversationWithOptions(
+    JNIEnv* env,
+    jobject /* this */,
+    jint priority,
+    jint deadline_ms,
+    jlong seed) {
+    auto engine = acquire_engine();
+    if (!engine) return 0;
+    try {
+        t760::ConversationOptions options;
+        options.priority = to_priority(priority);
+        options.deadline_ms = deadline_ms > 0 ? static_cast<uint32_t>(deadline_ms) : 0;
+        options.seed = static_cast<uint64_t>(seed);
+        t760::ConversationHandle handle = engine->start_new_conversation(options);
+        return static_cast<jlong>(handle.id);
+    } catch (const std::exception& e) {
+        return 0;
+    }
 }
 
 extern "C" JNIEXPORT void JNICALL
@@ -82,8 +302,12 @@ Java_com_slearn_NativeEngine_nativeEndConversation(
     JNIEnv* env,
     jobject /* this */,
     jlong handle_id) {
-    std::lock_guard<std::mutex> lock(g_engine_mutex);
-    if (g_engine) g_engine->end_conversation({static_cast<uint64_t>(handle_id)});
+    auto engine = acquire_engine();
+    if (!engine) return;
+    try {
+        engine->end_conversation(t760::ConversationHandle{static_cast<uint64_t>(handle_id)});
+    } catch (const std::exception& e) {
+    }
 }
 
 extern "C" JNIEXPORT jintArray JNICALL
@@ -92,21 +316,487 @@ Java_com_slearn_NativeEngine_nativeGenerate(
     jobject /* this */,
     jlong handle_id,
     jintArray token_ids) {
-    std::lock_guard<std::mutex> lock(g_engine_mutex);
-    if (!g_engine || !g_engine->is_model_loaded()) return nullptr;
+    auto engine = acquire_engine();
+    if (!engine) return nullptr;
 
-    jint* token_elements = env->GetIntArrayElements(token_ids, nullptr);
-    if (token_elements == nullptr) return nullptr;
-    jsize length = env->GetArrayLength(token_ids);
-    std::vector<int> input_tokens(token_elements, token_elements + length);
-    env->ReleaseIntArrayElements(token_ids, token_elements, JNI_ABORT);
+    if (token_ids == nullptr) return nullptr;
+    // Per calling thread and reused, like the output's candidate storage.
+    thread_local std::vector<int> input_tokens;
+    thread_local t760::StepOutput output;
+    input_tokens.resize(static_cast<size_t>(env->GetArrayLength(token_ids)));
+    env->GetIntArrayRegion(token_ids, 0, static_cast<jsize>(input_tokens.size()),
+                           reinterpret_cast<jint*>(input_tokens.data()));
 
     t760::ConversationHandle handle{static_cast<uint64_t>(handle_id)};
-    t760::Tensor result_tensor = g_engine->generate(handle, input_tokens);
+    try {
+        // Throws when the model was unloaded or the conversation ended
+        // meanwhile.
+        engine->generate(handle, input_tokens.data(), input_tokens.size(), output);
+    } catch (const std::exception& e) {
+        return nullptr;
+    }
+
+    // Sampling already ran natively; Java receives the chosen token only, or
+    // an empty array when no token was produced.
+    const jsize count = output.next_token >= 0 ? 1 : 0;
+    jintArray result_array = env->NewIntArray(count);
+    if (result_array == nullptr) return nullptr;
+    if (count > 0) {
+        const jint token = output.next_token;
+        env->SetIntArrayRegion(result_array, 0, 1, &token);
+    }
+    return result_array;
+}
+
+// nativeGenerate over direct buffers: the tokens are read where Java wrote
+// them and the results land in Java's buffers, so a decode step allocates on
+// neither heap once the thread's output has warmed up.
+extern "C" JNIEXPORT jint JNICALL
+Java_com_slearn_NativeEngine_nativeGenerateDirect(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_id,
+    jobject token_buffer,
+    jint token_count,
+    jobject candidate_buffer,
+    jobject logit_buffer) {
+    auto engine = acquire_engine();
+    if (!engine) return GENERATE_FAILED;
+
+    size_t token_capacity = 0;
+    const int* tokens = direct_buffer<int>(env, token_buffer, token_capacity);
+    if (tokens == nullptr || token_count < 0 || static_cast<size_t>(token_count) > token_capacity) {
+        return GENERATE_FAILED;
+    }
+    // TokenCandidate is the (int32 id, float32 logit) pair Java reads.
+    size_t candidate_capacity = 0;
+    auto* candidates = direct_buffer<t760::TokenCandidate>(env, candidate_buffer, candidate_capacity);
+    t760::OutputOptions options;
+    options.logits_out = direct_buffer<float>(env, logit_buffer, options.logits_out_size);
+    if ((candidate_buffer != nullptr && candidates == nullptr) ||
+        (logit_buffer != nullptr && options.logits_out == nullptr)) {
+        return GENERATE_FAILED;
+    }
+
+    thread_local t760::StepOutput output;
+    try {
+        engine->generate(t760::ConversationHandle{static_cast<uint64_t>(handle_id)}, tokens,
+                         static_cast<size_t>(token_count), output, options);
+    } catch (const std::exception& e) {
+        return GENERATE_FAILED;
+    }
+    const size_t filled = std::min(candidate_capacity, output.candidates.size());
+    if (filled > 0) {
+        std::memcpy(candidates, output.candidates.data(), filled * sizeof(t760::TokenCandidate));
+    }
+    std::fill(candidates + filled, candidates + candidate_capacity, t760::TokenCandidate{-1, 0.0f});
+    return output.next_token >= 0 ? static_cast<jint>(output.next_token) : GENERATE_NO_TOKEN;
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_slearn_NativeEngine_nativeGenerateAsync(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle_id,
+    jintArray prompt_token_ids,
+    jint max_new_tokens,
+    jfloat temperature,
+    jint top_k,
+    jfloat top_p,
+    jfloat repetition_penalty,
+    jfloat frequency_penalty,
+    jintArray stop_token_ids,
+    jlong grammar_id) {
+    auto engine = acquire_engine();
+    if (!engine) return 0;
+
+    t760::GenerationParams params = make_generation_params(
+        env, max_new_tokens, temperature, top_k, top_p, repetition_penalty, frequency_penalty, stop_token_ids);
+    if (!find_grammar(grammar_id, params.grammar)) return 0;
+
+    try {
+        const t760::ConversationHandle handle{static_cast<uint64_t>(handle_id)};
+        // Sized for every token the task may deliver, so pushes never fail:
+        // it cannot outrun the conversation's remaining context.
+        const size_t capacity = std::min<size_t>(params.max_new_tokens, engine->remaining_context(handle));
+        auto stream = std::make_shared<t760::TokenStream>(std::max<size_t>(capacity, 1));
+        auto task = engine->generate_async(
+            handle, copy_int_array(env, prompt_token_ids), params,
+            [stream](int32_t token) { stream->push(token); },
+            [stream](t760::GenerationStatus) { stream->close(); });
+        std::lock_guard<std::mutex> lock(g_generations_mutex);
+        const jlong generation_id = g_next_generation_id++;
+        g_generations[generation_id] = JniGeneration{std::move(task), std::move(stream)};
+        return generation_id;
+    } catch (const std::exception& e) {
+        return 0;
+    }
+}
+
+// One int[] of generated tokens per prompt, or null for a prompt that failed.
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_com_slearn_NativeEngine_nativeGenerateBatch(
+    JNIEnv* env,
+    jobject /* this */,
+    jobjectArray prompts,
+    jint max_new_tokens,
+    jfloat temperature,
+    jint top_k,
+    jfloat top_p,
+    jfloat repetition_penalty,
+    jfloat frequency_penalty,
+    jintArray stop_token_ids,
+    jint priority,
+    jlong seed,
+    jlong grammar_id) {
+    auto engine = acquire_engine();
+    if (!engine) return nullptr;
+    t760::GenerationParams params = make_generation_params(
+        env, max_new_tokens, temperature, top_k, top_p, repetition_penalty, frequency_penalty, stop_token_ids);
+    if (!find_grammar(grammar_id, params.grammar)) return nullptr;
+    const std::vector<t760::BatchPrompt> batch = copy_batch_prompts(env, prompts, params);
+    t760::BatchOptions options;
+    options.priority = to_priority(priority);
+    options.seed = static_cast<uint64_t>(seed);
+    std::vector<t760::BatchCompletion> completions;
+    try {
+        completions = engine->generate_batch(batch, options);
+    } catch (const std::exception& e) {
+        return nullptr;
+    }
+
+    jclass int_array_class = env->FindClass("[I");
+    if (int_array_class == nullptr) return nullptr;
+    jobjectArray result_array = env->NewObjectArray(static_cast<jsize>(completions.size()), int_array_class, nullptr);
+    if (result_array == nullptr) return nullptr;
+    for (size_t i = 0; i < completions.size(); ++i) {
+        const t760::BatchCompletion& completion = completions[i];
+        if (completion.status == t760::GenerationStatus::FAILED) continue;
+        jintArray tokens = env->NewIntArray(static_cast<jsize>(completion.tokens.size()));
+        if (tokens == nullptr) return nullptr;
+        env->SetIntArrayRegion(tokens, 0, static_cast<jsize>(completion.tokens.size()),
+                               reinterpret_cast<const jint*>(completion.tokens.data()));
+        env->SetObjectArrayElement(result_array, static_cast<jsize>(i), tokens);
+        env->DeleteLocalRef(tokens);
+    }
+    return result_array;
+}
+
+// {sequential tokens/s, batched tokens/s, prompts, prompt tokens, generated
+// tokens}, or null.
+extern "C" JNIEXPORT jdoubleArray JNICALL
+Java_com_slearn_NativeEngine_nativeBenchmarkBatch(
+    JNIEnv* env,
+    jobject /* this */,
+    jobjectArray prompts,
+    jint max_new_tokens,
+    jint priority) {
+    auto engine = acquire_engine();
+    if (!engine) return nullptr;
+    t760::GenerationParams params;
+    params.max_new_tokens = max_new_tokens > 0 ? static_cast<uint32_t>(max_new_tokens) : 0;
+    t760::BatchOptions options;
+    options.priority = to_priority(priority);
+    t760::BatchThroughput throughput;
+    try {
+        throughput = engine->benchmark_batch(copy_batch_prompts(env, prompts, params), options);
+    } catch (const std::exception& e) {
+        return nullptr;
+    }
+    const jdouble values[5] = {throughput.sequential_tokens_per_s, throughput.batched_tokens_per_s,
+                               static_cast<jdouble>(throughput.prompts), static_cast<jdouble>(throughput.prompt_tokens),
+                               static_cast<jdouble>(throughput.generated_tokens)};
+    jdoubleArray result_array = env->NewDoubleArray(5);
+    if (result_array == nullptr) return nullptr;
+    env->SetDoubleArrayRegion(result_array, 0, 5, values);
+    return result_array;
+}
+
+extern "C" JNIEXPORT jfloatArray JNICALL
+Java_com_slearn_NativeEngine_nativeEmbed(
+    JNIEnv* env,
+    jobject /* this */,
+    jintArray token_ids,
+    jint pooling,
+    jboolean normalize,
+    jint priority) {
+    auto engine = acquire_engine();
+    if (!engine) return nullptr;
+    std::vector<float> embedding;
+    try {
+        embedding = engine->embed(copy_int_array(env, token_ids), make_embedding_options(pooling, normalize, priority));
+    } catch (const std::exception& e) {
+        return nullptr;
+    }
+    jfloatArray result_array = env->NewFloatArray(static_cast<jsize>(embedding.size()));
+    if (result_array == nullptr) return nullptr;
+    env->SetFloatArrayRegion(result_array, 0, static_cast<jsize>(embedding.size()), embedding.data());
+    return result_array;
+}
+
+// One float[] per input, in input order, or null.
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_com_slearn_NativeEngine_nativeEmbedBatch(
+    JNIEnv* env,
+    jobject /* this */,
+    jobjectArray inputs,
+    jint pooling,
+    jboolean normalize,
+    jint priority) {
+    auto engine = acquire_engine();
+    if (!engine) return nullptr;
+    std::vector<std::vector<int>> token_ids(inputs != nullptr ? static_cast<size_t>(env->GetArrayLength(inputs)) : 0);
+    for (size_t i = 0; i < token_ids.size(); ++i) {
+        jobject input = env->GetObjectArrayElement(inputs, static_cast<jsize>(i));
+        token_ids[i] = copy_int_array(env, static_cast<jintArray>(input));
+        env->DeleteLocalRef(input);
+    }
+    std::vector<std::vector<float>> embeddings;
+    try {
+        embeddings = engine->embed_batch(token_ids, make_embedding_options(pooling, normalize, priority));
+    } catch (const std::exception& e) {
+        return nullptr;
+    }
+
+    jclass float_array_class = env->FindClass("[F");
+    if (float_array_class == nullptr) return nullptr;
+    jobjectArray result_array = env->NewObjectArray(static_cast<jsize>(embeddings.size()), float_array_class, nullptr);
+    if (result_array == nullptr) return nullptr;
+    for (size_t i = 0; i < embeddings.size(); ++i) {
+        jfloatArray embedding = env->NewFloatArray(static_cast<jsize>(embeddings[i].size()));
+        if (embedding == nullptr) return nullptr;
+        env->SetFloatArrayRegion(embedding, 0, static_cast<jsize>(embeddings[i].size()), embeddings[i].data());
+        env->SetObjectArrayElement(result_array, static_cast<jsize>(i), embedding);
+        env->DeleteLocalRef(embedding);
+    }
+    return result_array;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_slearn_NativeEngine_nativeReadTokens(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong generation_id,
+    jintArray buffer,
+    jint timeout_ms) {
+    if (buffer == nullptr) {
+        throw_illegal_argument(env, "nativeReadTokens: buffer is null");
+        return -1;
+    }
+    JniGeneration generation;
+    if (!find_generation(generation_id, generation)) return -1;
+    // One copy into the Java array per batch.
+    int32_t batch[256];
+    const size_t capacity = std::min<size_t>(sizeof(batch) / sizeof(batch[0]),
+                                             static_cast<size_t>(env->GetArrayLength(buffer)));
+    const int64_t count = generation.stream->read(batch, capacity, std::chrono::milliseconds(timeout_ms));
+    if (count > 0) {
+        env->SetIntArrayRegion(buffer, 0, static_cast<jsize>(count), reinterpret_cast<const jint*>(batch));
+    }
+    return static_cast<jint>(count);
+}
+
+// nativeReadTokens straight into a direct buffer, from token offset on.
+extern "C" JNIEXPORT jint JNICALL
+Java_com_slearn_NativeEngine_nativeReadTokensDirect(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong generation_id,
+    jobject buffer,
+    jint offset,
+    jint timeout_ms) {
+    JniGeneration generation;
+    if (!find_generation(generation_id, generation)) return -1;
+    size_t capacity = 0;
+    int32_t* tokens = direct_buffer<int32_t>(env, buffer, capacity);
+    if (tokens == nullptr || offset < 0 || static_cast<size_t>(offset) > capacity) return -1;
+    const int64_t count = generation.stream->read(tokens + offset, capacity - static_cast<size_t>(offset),
+                                                  std::chrono::milliseconds(timeout_ms));
+    return static_cast<jint>(count);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_slearn_NativeEngine_nativeCancelGeneration(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong generation_id) {
+    JniGeneration generation;
+    if (find_generation(generation_id, generation)) generation.task->cancel();
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_slearn_NativeEngine_nativeReleaseGeneration(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong generation_id) {
+    JniGeneration generation;
+    {
+        std::lock_guard<std::mutex> lock(g_generations_mutex);
+        auto it = g_generations.find(generation_id);
+        if (it == g_generations.end()) return static_cast<jint>(t760::GenerationStatus::FAILED);
+        generation = std::move(it->second);
+        g_generations.erase(it);
+    }
+    generation.task->cancel();
+    return static_cast<jint>(generation.task->wait());
+}
 
-    std::vector<int> output_tokens = {1, 2, 3}; // Dummy output
-    jintArray result_array = env->NewIntArray(output_tokens.size());
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_slearn_NativeEngine_nativeLoadTokenizer(
+    JNIEnv* env,
+    jobject /* this */,
+    jstring tokenizer_path) {
+    auto engine = acquire_engine();
+    if (!engine) return JNI_FALSE;
+    const char* c_path = env->GetStringUTFChars(tokenizer_path, nullptr);
+    if (c_path == nullptr) return JNI_FALSE;
+    std::string path_str(c_path);
+    env->ReleaseStringUTFChars(tokenizer_path, c_path);
+    return static_cast<jboolean>(engine->load_tokenizer(path_str));
+}
+
+extern "C" JNIEXPORT jintArray JNICALL
+Java_com_slearn_NativeEngine_nativeEncode(
+    JNIEnv* env,
+    jobject /* this */,
+    jbyteArray utf8_text,
+    jboolean add_bos) {
+    auto engine = acquire_engine();
+    if (!engine) return nullptr;
+    std::vector<int> ids;
+    try {
+        ids = engine->encode(copy_byte_array(env, utf8_text), add_bos == JNI_TRUE);
+    } catch (const std::exception& e) {
+        return nullptr;
+    }
+    jintArray result_array = env->NewIntArray(static_cast<jsize>(ids.size()));
+    if (result_array == nullptr) return nullptr;
+    env->SetIntArrayRegion(result_array, 0, static_cast<jsize>(ids.size()), reinterpret_cast<const jint*>(ids.data()));
+    return result_array;
+}
+
+// Returns UTF-8 bytes, which may end inside a character when ids is a prefix
+// of a longer sequence; streaming callers carry the incomplete tail over.
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_slearn_NativeEngine_nativeDecode(
+    JNIEnv* env,
+    jobject /* this */,
+    jintArray token_ids,
+    jboolean skip_special) {
+    auto engine = acquire_engine();
+    if (!engine) return nullptr;
+    std::string text;
+    try {
+        text = engine->decode(copy_int_array(env, token_ids), skip_special == JNI_TRUE);
+    } catch (const std::exception& e) {
+        return nullptr;
+    }
+    jbyteArray result_array = env->NewByteArray(static_cast<jsize>(text.size()));
     if (result_array == nullptr) return nullptr;
-    env->SetIntArrayRegion(result_array, 0, output_tokens.size(), output_tokens.data());
+    env->SetByteArrayRegion(result_array, 0, static_cast<jsize>(text.size()), reinterpret_cast<const jbyte*>(text.data()));
     return result_array;
-}
\ No newline at end of file
+}
+
+// nativeDecode between direct buffers: count int32 ids in, UTF-8 out. Returns
+// the text's length in bytes, written only when it fits (so a caller with too
+// small a buffer can grow it and retry), or -1 on failure.
+extern "C" JNIEXPORT jint JNICALL
+Java_com_slearn_NativeEngine_nativeDecodeDirect(
+    JNIEnv* env,
+    jobject /* this */,
+    jobject token_buffer,
+    jint token_count,
+    jboolean skip_special,
+    jobject utf8_buffer) {
+    auto engine = acquire_engine();
+    if (!engine) return -1;
+    size_t token_capacity = 0;
+    size_t byte_capacity = 0;
+    const int* tokens = direct_buffer<int>(env, token_buffer, token_capacity);
+    auto* bytes = direct_buffer<char>(env, utf8_buffer, byte_capacity);
+    if (tokens == nullptr || bytes == nullptr || token_count < 0 ||
+        static_cast<size_t>(token_count) > token_capacity) {
+        return -1;
+    }
+    thread_local std::string text;
+    text.clear();
+    try {
+        engine->decode(tokens, static_cast<size_t>(token_count), skip_special == JNI_TRUE, text);
+    } catch (const std::exception& e) {
+        return -1;
+    }
+    if (text.size() <= byte_capacity) {
+        std::memcpy(bytes, text.data(), text.size());
+    }
+    return static_cast<jint>(text.size());
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_slearn_NativeEngine_nativeTokenId(
+    JNIEnv* env,
+    jobject /* this */,
+    jbyteArray utf8_piece) {
+    auto engine = acquire_engine();
+    if (!engine) return -1;
+    try {
+        return static_cast<jint>(engine->token_id(copy_byte_array(env, utf8_piece)));
+    } catch (const std::exception& e) {
+        return -1;
+    }
+}
+
+// Grammar id for nativeGenerateAsync and nativeGenerateBatch, or 0 when the
+// source is invalid or no tokenizer is loaded.
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_slearn_NativeEngine_nativeCompileGrammar(
+    JNIEnv* env,
+    jobject /* this */,
+    jbyteArray utf8_source,
+    jint syntax) {
+    auto engine = acquire_engine();
+    if (!engine) return 0;
+    try {
+        auto grammar = engine->compile_grammar(
+            copy_byte_array(env, utf8_source),
+            syntax == 1 ? t760::GrammarSyntax::JSON_SCHEMA : t760::GrammarSyntax::REGEX);
+        std::lock_guard<std::mutex> lock(g_grammars_mutex);
+        const jlong grammar_id = g_next_grammar_id++;
+        g_grammars[grammar_id] = std::move(grammar);
+        return grammar_id;
+    } catch (const std::exception& e) {
+        return 0;
+    }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_slearn_NativeEngine_nativeReleaseGrammar(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong grammar_id) {
+    std::lock_guard<std::mutex> lock(g_grammars_mutex);
+    g_grammars.erase(grammar_id);
+}
+
+// {encode MB/s, decode MB/s, sample bytes, sample tokens}, or null.
+extern "C" JNIEXPORT jdoubleArray JNICALL
+Java_com_slearn_NativeEngine_nativeBenchmarkTokenizer(
+    JNIEnv* env,
+    jobject /* this */,
+    jbyteArray utf8_sample,
+    jint iterations) {
+    auto engine = acquire_engine();
+    if (!engine) return nullptr;
+    t760::TokenizerThroughput throughput;
+    try {
+        throughput = engine->benchmark_tokenizer(copy_byte_array(env, utf8_sample),
+                                                 static_cast<uint32_t>(std::max<jint>(iterations, 1)));
+    } catch (const std::exception& e) {
+        return nullptr;
+    }
+    const jdouble values[4] = {throughput.encode_mb_per_s, throughput.decode_mb_per_s,
+                               static_cast<jdouble>(throughput.bytes), static_cast<jdouble>(throughput.tokens)};
+    jdoubleArray result_array = env->NewDoubleArray(4);
+    if (result_array == nullptr) return nullptr;
+    env->SetDoubleArrayRegion(result_array, 0, 4, values);
+    return result_array;
+}
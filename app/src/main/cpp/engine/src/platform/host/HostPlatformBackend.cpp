@@ -0,0 +1,48 @@
+#include "t760_engine/platform/host/HostPlatformBackend.h"
+#include <stdexcept>
+
+namespace t760 {
+
+HostPlatformBackend::HostPlatformBackend() = default;
+
+HostPlatformBackend::~HostPlatformBackend() {
+    shutdown();
+}
+
+void HostPlatformBackend::initialize(const DeviceManager& device_manager) {
+    if (is_initialized_) {
+        throw std::runtime_error("HostPlatformBackend is already initialized.");
+    }
+    if (device_manager.has_device(DeviceType::CPU)) {
+        cpu_allocator_ = std::make_unique<CpuAllocator>();
+        cpu_allocator_->initialize();
+    }
+    is_initialized_ = true;
+}
+
+void HostPlatformBackend::shutdown() {
+    if (!is_initialized_) {
+        return;
+    }
+    if (cpu_allocator_) cpu_allocator_->shutdown();
+    cpu_allocator_.reset();
+    is_initialized_ = false;
+}
+
+IGpuContext* HostPlatformBackend::get_gpu_context() const {
+    return nullptr;
+}
+
+INpuContext* HostPlatformBackend::get_npu_context() const {
+    return nullptr;
+}
+
+IMemoryAllocator* HostPlatformBackend::get_cpu_allocator() const {
+    return cpu_allocator_.get();
+}
+
+std::unique_ptr<IPlatformBackend> create_platform_backend() {
+    return std::make_unique<HostPlatformBackend>();
+}
+
+}
@@ -0,0 +1,52 @@
+#include "t760_engine/tensor/QuantizedLayout.h"
+#include "t760_engine/tensor/Tensor.h"
+#include <stdexcept>
+
+namespace t760 {
+
+bool is_group_quantized(DataType dtype) {
+    return dtype == DataType::QINT8 || dtype == DataType::QINT4;
+}
+
+size_t quantized_quants_size_in_bytes(DataType dtype, int64_t rows, int64_t cols) {
+    switch (dtype) {
+        case DataType::QINT8: return static_cast<size_t>(rows * cols);
+        case DataType::QINT4: return static_cast<size_t>(rows * cols / 2);
+        default: throw std::runtime_error("Data type is not group-quantized.");
+    }
+}
+
+size_t quantized_tensor_size_in_bytes(DataType dtype, const TensorShape& shape) {
+    if (shape.rank() == 0) {
+        throw std::runtime_error("Group-quantized tensors must have at least one dimension.");
+    }
+    const int64_t cols = shape.dims.back();
+    if (cols % constants::QUANT_GROUP_SIZE != 0) {
+        throw std::runtime_error("Quantized dimension is not a multiple of the quantization group size.");
+    }
+    const int64_t rows = static_cast<int64_t>(shape.num_elements()) / cols;
+    const size_t scale_count = static_cast<size_t>(rows * (cols / constants::QUANT_GROUP_SIZE));
+    return quantized_quants_size_in_bytes(dtype, rows, cols) + scale_count * sizeof(float);
+}
+
+QuantizedMatrixView make_quantized_view(const Tensor& tensor) {
+    const DataType dtype = tensor.get_data_type();
+    if (!is_group_quantized(dtype)) {
+        throw std::runtime_error("Tensor is not group-quantized: " + tensor.get_name());
+    }
+    const auto& shape = tensor.get_shape();
+    if (tensor.get_size_in_bytes() < quantized_tensor_size_in_bytes(dtype, shape)) {
+        throw std::runtime_error("Quantized tensor buffer is too small for its scales: " + tensor.get_name());
+    }
+
+    QuantizedMatrixView view;
+    view.data_type = dtype;
+    view.cols = shape.dims.back();
+    view.rows = static_cast<int64_t>(shape.num_elements()) / view.cols;
+    const auto* base = static_cast<const uint8_t*>(tensor.get_data());
+    view.quants = base;
+    view.scales = reinterpret_cast<const float*>(base + quantized_quants_size_in_bytes(dtype, view.rows, view.cols));
+    return view;
+}
+
+}
@@ -1,4 +1,5 @@
 #include "t760_engine/tensor/TensorManager.h"
+#include "t760_engine/tensor/QuantizedLayout.h"
 #include <stdexcept>
 
 namespace t760 {
@@ -29,8 +30,8 @@ std::unique_ptr<Tensor> TensorManager::create_tensor(const std::string& name, co
     size_t num_elements = shape.num_elements();
     size_t size_in_bytes;
 
-    if (dtype == DataType::QINT4) {
-        size_in_bytes = (num_elements + 1) / 2;
+    if (is_group_quantized(dtype)) {
+        size_in_bytes = quantized_tensor_size_in_bytes(dtype, shape);
     } else {
         size_in_bytes = num_elements * get_size_for_data_type(dtype);
     }
@@ -39,7 +40,7 @@ std::unique_ptr<Tensor> TensorManager::create_tensor(const std::string& name, co
         throw std::runtime_error("Calculated size in bytes is zero for non-empty tensor.");
     }
 
-    IPlatformMemory* allocator = nullptr;
+    IMemoryAllocator* allocator = nullptr;
     switch (device) {
         case DeviceType::CPU:
         case DeviceType::SHARED:
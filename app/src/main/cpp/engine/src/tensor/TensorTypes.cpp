@@ -0,0 +1,13 @@
+#include "t760_engine/tensor/TensorTypes.h"
+
+namespace t760 {
+
+size_t TensorShape::num_elements() const {
+    size_t count = 1;
+    for (int64_t dim : dims) {
+        count *= static_cast<size_t>(dim);
+    }
+    return count;
+}
+
+}
@@ -0,0 +1,171 @@
+#include "t760_engine/tokenizer/DoubleArrayTrie.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace t760 {
+
+namespace {
+
+constexpr int32_t FREE = -1;
+constexpr uint32_t LABELS = 257; // Terminal plus one per byte
+
+class TrieBuilder {
+public:
+    explicit TrieBuilder(const std::vector<std::pair<std::string, int32_t>>& keys) : keys_(keys) {
+        units_.assign(1024, DoubleArrayUnit{0, FREE});
+        units_[0].check = -2; // The root is never free
+    }
+
+    std::vector<DoubleArrayUnit> build() {
+        if (!keys_.empty()) {
+            place_children(0, 0, keys_.size(), 0);
+        }
+        size_t used = units_.size();
+        while (used > 1 && units_[used - 1].check == FREE) {
+            --used;
+        }
+        units_.resize(used);
+        return std::move(units_);
+    }
+
+private:
+    struct Edge {
+        uint32_t label;
+        size_t begin;
+        size_t end;
+    };
+
+    void reserve(size_t size) {
+        if (units_.size() < size) {
+            units_.resize(std::max(size, units_.size() * 2), DoubleArrayUnit{0, FREE});
+        }
+    }
+
+    // Places the children of node for keys[begin, end), which share their
+    // first depth bytes, then their subtrees.
+    void place_children(int32_t node, size_t begin, size_t end, size_t depth) {
+        std::vector<Edge> edges;
+        for (size_t i = begin; i < end;) {
+            const std::string& key = keys_[i].first;
+            const uint32_t label = key.size() == depth ? 0 : static_cast<uint8_t>(key[depth]) + 1u;
+            size_t j = i + 1;
+            while (j < end && label != 0 && keys_[j].first.size() > depth &&
+                   static_cast<uint8_t>(keys_[j].first[depth]) + 1u == label) {
+                ++j;
+            }
+            if (!edges.empty() && edges.back().label >= label) {
+                throw std::runtime_error("Trie keys must be sorted and unique.");
+            }
+            edges.push_back(Edge{label, i, j});
+            i = j;
+        }
+
+        const int32_t base = find_base(edges);
+        units_[node].base = base;
+        for (const Edge& edge : edges) {
+            units_[base + edge.label].check = node;
+        }
+        for (const Edge& edge : edges) {
+            const int32_t slot = base + static_cast<int32_t>(edge.label);
+            if (edge.label == 0) {
+                units_[slot].base = -(keys_[edge.begin].second + 1);
+            } else {
+                place_children(slot, edge.begin, edge.end, depth + 1);
+            }
+        }
+    }
+
+    // Lowest base >= 1 whose slots for every edge are free. Scanning starts
+    // at a watermark below which the array is nearly full.
+    int32_t find_base(const std::vector<Edge>& edges) {
+        const auto first = static_cast<int32_t>(edges.front().label);
+        int32_t pos = std::max(next_check_pos_, first + 1);
+        size_t occupied = 0;
+        for (;; ++pos) {
+            reserve(static_cast<size_t>(pos) + LABELS);
+            if (units_[pos].check != FREE) {
+                ++occupied;
+                continue;
+            }
+            const int32_t base = pos - first;
+            bool fits = true;
+            for (size_t e = 1; e < edges.size() && fits; ++e) {
+                fits = units_[base + edges[e].label].check == FREE;
+            }
+            if (fits) {
+                if (static_cast<double>(occupied) / (pos - next_check_pos_ + 1) >= 0.95) {
+                    next_check_pos_ = pos;
+                }
+                return base;
+            }
+        }
+    }
+
+    const std::vector<std::pair<std::string, int32_t>>& keys_;
+    std::vector<DoubleArrayUnit> units_;
+    int32_t next_check_pos_ = 1;
+};
+
+} // namespace
+
+int32_t DoubleArrayTrie::find(const char* key, size_t length) const {
+    if (size_ == 0) {
+        return -1;
+    }
+    int32_t node = 0;
+    for (size_t i = 0; i < length; ++i) {
+        node = child(node, static_cast<uint8_t>(key[i]) + 1u);
+        if (node < 0) {
+            return -1;
+        }
+    }
+    const int32_t leaf = child(node, 0);
+    return leaf < 0 ? -1 : -units_[leaf].base - 1;
+}
+
+int32_t DoubleArrayTrie::longest_prefix(const char* text, size_t length, size_t& matched) const {
+    matched = 0;
+    int32_t value = -1;
+    if (size_ == 0) {
+        return value;
+    }
+    int32_t node = 0;
+    for (size_t i = 0; i < length; ++i) {
+        node = child(node, static_cast<uint8_t>(text[i]) + 1u);
+        if (node < 0) {
+            break;
+        }
+        const int32_t leaf = child(node, 0);
+        if (leaf >= 0) {
+            value = -units_[leaf].base - 1;
+            matched = i + 1;
+        }
+    }
+    return value;
+}
+
+bool DoubleArrayTrie::values_below(uint32_t limit) const {
+    // A leaf is the label-0 child of its parent; inner nodes have base >= 1.
+    for (size_t t = 0; t < size_; ++t) {
+        const int32_t parent = units_[t].check;
+        if (parent < 0 || static_cast<size_t>(parent) >= size_ || units_[parent].base != static_cast<int64_t>(t)) {
+            continue;
+        }
+        const int64_t value = -static_cast<int64_t>(units_[t].base) - 1;
+        if (value < 0 || value >= limit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<DoubleArrayUnit> DoubleArrayTrie::build(const std::vector<std::pair<std::string, int32_t>>& keys) {
+    for (const auto& [key, value] : keys) {
+        if (key.empty() || value < 0) {
+            throw std::runtime_error("Trie keys must be non-empty with non-negative values.");
+        }
+    }
+    return TrieBuilder(keys).build();
+}
+
+}
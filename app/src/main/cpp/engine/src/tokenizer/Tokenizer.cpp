@@ -0,0 +1,417 @@
+#include "t760_engine/tokenizer/Tokenizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace t760 {
+
+namespace {
+
+constexpr char METASPACE[] = "\xE2\x96\x81"; // U+2581
+constexpr size_t METASPACE_BYTES = 3;
+
+struct Symbol {
+    int32_t id; // -1 once merged into its left neighbor
+    int32_t prev;
+    int32_t next;
+};
+
+// A merge of symbols left and right (adjacent when pushed), valid while
+// both still hold the ids it was found for.
+struct MergeCandidate {
+    uint32_t rank;
+    int32_t left;
+    int32_t right;
+    int32_t left_id;
+    int32_t right_id;
+    int32_t merged;
+};
+
+// Heap order: lowest rank first, then leftmost, as tokenizers' BPE merges.
+bool merges_after(const MergeCandidate& a, const MergeCandidate& b) {
+    return a.rank > b.rank || (a.rank == b.rank && a.left > b.left);
+}
+
+size_t utf8_length(uint8_t lead) {
+    if (lead < 0x80) return 1;
+    if ((lead & 0xE0) == 0xC0) return 2;
+    if ((lead & 0xF0) == 0xE0) return 3;
+    if ((lead & 0xF8) == 0xF0) return 4;
+    return 1; // Stray continuation or invalid byte
+}
+
+uint32_t hex_digit(char c) {
+    return c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+}
+
+bool section_fits(uint64_t offset, uint64_t bytes, size_t file_size) {
+    return offset % 8 == 0 && offset <= file_size && bytes <= file_size - offset;
+}
+
+} // namespace
+
+Tokenizer::Tokenizer(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open tokenizer file: " + path);
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(TokenizerFileHeader))) {
+        ::close(fd);
+        throw std::runtime_error("Tokenizer file is too small to contain a valid header: " + path);
+    }
+    mapping_size_ = static_cast<size_t>(st.st_size);
+    mapping_ = ::mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        throw std::runtime_error("Failed to map tokenizer file: " + path);
+    }
+
+    const auto* base = static_cast<const char*>(mapping_);
+    header_ = reinterpret_cast<const TokenizerFileHeader*>(base);
+    try {
+        validate(mapping_size_);
+    } catch (...) {
+        ::munmap(mapping_, mapping_size_);
+        throw;
+    }
+    piece_offsets_ = reinterpret_cast<const uint32_t*>(base + header_->piece_offsets_offset);
+    strings_ = base + header_->strings_offset;
+    token_types_ = reinterpret_cast<const TokenType*>(base + header_->token_types_offset);
+    merges_ = reinterpret_cast<const MergeEntry*>(base + header_->merges_offset);
+    merge_mask_ = header_->merge_buckets - 1;
+    trie_ = DoubleArrayTrie(reinterpret_cast<const DoubleArrayUnit*>(base + header_->trie_offset),
+                            header_->trie_size);
+    added_trie_ = DoubleArrayTrie(reinterpret_cast<const DoubleArrayUnit*>(base + header_->added_trie_offset),
+                                  header_->added_trie_size);
+    for (uint32_t b = 0; b < 256; ++b) {
+        added_first_byte_[b] = added_trie_.starts_key(static_cast<uint8_t>(b));
+    }
+}
+
+Tokenizer::~Tokenizer() {
+    if (mapping_) {
+        ::munmap(mapping_, mapping_size_);
+    }
+}
+
+void Tokenizer::validate(size_t file_size) const {
+    const TokenizerFileHeader& h = *header_;
+    if (h.magic != TOKENIZER_FILE_MAGIC) {
+        throw std::runtime_error("Invalid tokenizer file magic number.");
+    }
+    if (h.version != TOKENIZER_FILE_VERSION) {
+        throw std::runtime_error("Unsupported tokenizer file version.");
+    }
+    if (h.vocab_size == 0 || h.merge_buckets == 0 || (h.merge_buckets & (h.merge_buckets - 1)) != 0) {
+        throw std::runtime_error("Invalid tokenizer vocab or merge table size.");
+    }
+    const uint64_t vocab = h.vocab_size;
+    if (!section_fits(h.piece_offsets_offset, (vocab + 1) * sizeof(uint32_t), file_size) ||
+        !section_fits(h.strings_offset, h.strings_size, file_size) ||
+        !section_fits(h.token_types_offset, vocab * sizeof(TokenType), file_size) ||
+        !section_fits(h.merges_offset, uint64_t{h.merge_buckets} * sizeof(MergeEntry), file_size) ||
+        !section_fits(h.trie_offset, uint64_t{h.trie_size} * sizeof(DoubleArrayUnit), file_size) ||
+        !section_fits(h.added_trie_offset, uint64_t{h.added_trie_size} * sizeof(DoubleArrayUnit), file_size)) {
+        throw std::runtime_error("Tokenizer file sections exceed the file.");
+    }
+    const auto* base = static_cast<const char*>(mapping_);
+    const auto* offsets = reinterpret_cast<const uint32_t*>(base + h.piece_offsets_offset);
+    if (offsets[vocab] > h.strings_size) {
+        throw std::runtime_error("Tokenizer string table is truncated.");
+    }
+    // id_to_piece takes offsets[id + 1] - offsets[id] as a length.
+    for (uint64_t i = 0; i < vocab; ++i) {
+        if (offsets[i] > offsets[i + 1]) {
+            throw std::runtime_error("Tokenizer piece offsets are not monotonic.");
+        }
+    }
+    // encode_word emits merged ids, and find_merge probes until an empty bucket.
+    const auto* merges = reinterpret_cast<const MergeEntry*>(base + h.merges_offset);
+    bool has_empty = false;
+    for (uint32_t b = 0; b < h.merge_buckets; ++b) {
+        if (merges[b].left == MERGE_EMPTY) {
+            has_empty = true;
+        } else if (merges[b].merged >= vocab) {
+            throw std::runtime_error("Tokenizer merge result is out of range.");
+        }
+    }
+    if (!has_empty) {
+        throw std::runtime_error("Tokenizer merge table has no empty bucket.");
+    }
+    const DoubleArrayTrie trie(reinterpret_cast<const DoubleArrayUnit*>(base + h.trie_offset), h.trie_size);
+    const DoubleArrayTrie added_trie(reinterpret_cast<const DoubleArrayUnit*>(base + h.added_trie_offset),
+                                     h.added_trie_size);
+    if (!trie.values_below(h.vocab_size) || !added_trie.values_below(h.vocab_size)) {
+        throw std::runtime_error("Tokenizer trie holds an out-of-range id.");
+    }
+    for (int32_t id : {h.bos_id, h.eos_id, h.unk_id, h.pad_id}) {
+        if (id >= static_cast<int64_t>(vocab)) {
+            throw std::runtime_error("Tokenizer special token id is out of range.");
+        }
+    }
+    for (int32_t id : h.byte_tokens) {
+        if (id < -1 || id >= static_cast<int64_t>(vocab)) {
+            throw std::runtime_error("Tokenizer byte token id is out of range.");
+        }
+    }
+}
+
+bool Tokenizer::find_merge(int32_t left, int32_t right, uint32_t& rank, int32_t& merged) const {
+    const auto l = static_cast<uint32_t>(left);
+    const auto r = static_cast<uint32_t>(right);
+    for (uint32_t b = merge_bucket(l, r, merge_mask_);; b = (b + 1) & merge_mask_) {
+        const MergeEntry& entry = merges_[b];
+        if (entry.left == MERGE_EMPTY) {
+            return false;
+        }
+        if (entry.left == l && entry.right == r) {
+            rank = entry.rank;
+            merged = static_cast<int32_t>(entry.merged);
+            return true;
+        }
+    }
+}
+
+void Tokenizer::encode(std::string_view text, bool add_bos, std::vector<int>& out) const {
+    if (add_bos && header_->bos_id >= 0) {
+        out.push_back(header_->bos_id);
+    }
+    size_t segment = 0;
+    for (size_t i = 0; i < text.size();) {
+        if (added_first_byte_[static_cast<uint8_t>(text[i])]) {
+            size_t matched = 0;
+            const int32_t id = added_trie_.longest_prefix(text.data() + i, text.size() - i, matched);
+            if (id >= 0) {
+                encode_segment(text.data() + segment, i - segment, out);
+                out.push_back(id);
+                i += matched;
+                segment = i;
+                continue;
+            }
+        }
+        ++i;
+    }
+    encode_segment(text.data() + segment, text.size() - segment, out);
+}
+
+void Tokenizer::encode_segment(const char* text, size_t length, std::vector<int>& out) const {
+    if (length == 0) {
+        return;
+    }
+    thread_local std::string normalized;
+
+    const uint16_t flags = header_->flags;
+    if (flags & (TOKENIZER_SPACE_TO_METASPACE | TOKENIZER_PREPEND_METASPACE)) {
+        normalized.clear();
+        if (flags & TOKENIZER_PREPEND_METASPACE) {
+            normalized.append(METASPACE, METASPACE_BYTES);
+        }
+        const bool replace = flags & TOKENIZER_SPACE_TO_METASPACE;
+        for (size_t i = 0; i < length; ++i) {
+            if (replace && text[i] == ' ') {
+                normalized.append(METASPACE, METASPACE_BYTES);
+            } else {
+                normalized.push_back(text[i]);
+            }
+        }
+        text = normalized.data();
+        length = normalized.size();
+    }
+    if (!(flags & TOKENIZER_WORD_BOUNDARIES)) {
+        encode_word(text, length, out);
+        return;
+    }
+    // Words start at a U+2581 run; merging each on its own keeps the heap
+    // and symbol list small and in cache.
+    size_t word = 0;
+    for (size_t i = 1; i + METASPACE_BYTES <= length; ++i) {
+        const void* lead = std::memchr(text + i, METASPACE[0], length - i);
+        if (lead == nullptr) {
+            break;
+        }
+        i = static_cast<size_t>(static_cast<const char*>(lead) - text);
+        if (i + METASPACE_BYTES <= length && std::memcmp(text + i, METASPACE, METASPACE_BYTES) == 0 &&
+            (i < METASPACE_BYTES || std::memcmp(text + i - METASPACE_BYTES, METASPACE, METASPACE_BYTES) != 0)) {
+            encode_word(text + word, i - word, out);
+            word = i;
+        }
+    }
+    encode_word(text + word, length - word, out);
+}
+
+void Tokenizer::encode_word(const char* text, size_t length, std::vector<int>& out) const {
+    thread_local std::vector<Symbol> symbols;
+    thread_local std::vector<MergeCandidate> heap;
+    const uint16_t flags = header_->flags;
+
+    // One symbol per character, or per byte for characters outside the vocab.
+    symbols.clear();
+    bool after_unknown = false;
+    for (size_t i = 0; i < length;) {
+        const size_t count = std::min(utf8_length(static_cast<uint8_t>(text[i])), length - i);
+        int32_t id = trie_.find(text + i, count);
+        if (id >= 0) {
+            symbols.push_back(Symbol{id, 0, 0});
+            after_unknown = false;
+        } else {
+            bool bytes = (flags & TOKENIZER_BYTE_FALLBACK) != 0;
+            for (size_t b = 0; b < count && bytes; ++b) {
+                bytes = header_->byte_tokens[static_cast<uint8_t>(text[i + b])] >= 0;
+            }
+            if (bytes) {
+                for (size_t b = 0; b < count; ++b) {
+                    symbols.push_back(Symbol{header_->byte_tokens[static_cast<uint8_t>(text[i + b])], 0, 0});
+                }
+                after_unknown = false;
+            } else if (!after_unknown && header_->unk_id >= 0) {
+                // Runs of unknown characters fuse into one <unk>.
+                symbols.push_back(Symbol{header_->unk_id, 0, 0});
+                after_unknown = true;
+            }
+        }
+        i += count;
+    }
+    const auto n = static_cast<int32_t>(symbols.size());
+    for (int32_t i = 0; i < n; ++i) {
+        symbols[i].prev = i - 1;
+        symbols[i].next = i + 1 < n ? i + 1 : -1;
+    }
+
+    heap.clear();
+    const auto offer = [&](int32_t left, int32_t right) {
+        MergeCandidate c{0, left, right, symbols[left].id, symbols[right].id, 0};
+        if (find_merge(c.left_id, c.right_id, c.rank, c.merged)) {
+            heap.push_back(c);
+            std::push_heap(heap.begin(), heap.end(), merges_after);
+        }
+    };
+    for (int32_t i = 0; i + 1 < n; ++i) {
+        offer(i, i + 1);
+    }
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), merges_after);
+        const MergeCandidate c = heap.back();
+        heap.pop_back();
+        Symbol& left = symbols[c.left];
+        if (left.id != c.left_id || left.next != c.right || symbols[c.right].id != c.right_id) {
+            continue; // Stale: one side has merged since
+        }
+        Symbol& right = symbols[c.right];
+        left.id = c.merged;
+        left.next = right.next;
+        if (right.next >= 0) {
+            symbols[right.next].prev = c.left;
+        }
+        right.id = -1;
+        if (left.prev >= 0) {
+            offer(left.prev, c.left);
+        }
+        if (left.next >= 0) {
+            offer(c.left, left.next);
+        }
+    }
+    for (int32_t i = n > 0 ? 0 : -1; i >= 0; i = symbols[i].next) {
+        out.push_back(symbols[i].id);
+    }
+}
+
+void Tokenizer::decode(const int* ids, size_t count, bool skip_special, std::string& out) const {
+    const size_t start = out.size();
+    for (size_t i = 0; i < count; ++i) {
+        const int32_t id = ids[i];
+        if (id < 0 || static_cast<uint32_t>(id) >= header_->vocab_size) {
+            throw std::runtime_error("Token id " + std::to_string(id) + " is outside the tokenizer vocab.");
+        }
+        if (token_types_[id] == TokenType::CONTROL) {
+            if (!skip_special) {
+                out.append(id_to_piece(id));
+            }
+            continue;
+        }
+        append_token_text(id, out);
+    }
+    if ((header_->flags & TOKENIZER_PREPEND_METASPACE) && out.size() > start && out[start] == ' ') {
+        out.erase(start, 1);
+    }
+}
+
+void Tokenizer::append_token_text(int32_t id, std::string& out) const {
+    const TokenType type = token_type(id);
+    if (type == TokenType::CONTROL) {
+        return;
+    }
+    const std::string_view piece = id_to_piece(id);
+    if (type == TokenType::BYTE && piece.size() == 6) { // <0xXX>
+        out.push_back(static_cast<char>(hex_digit(piece[3]) << 4 | hex_digit(piece[4])));
+        return;
+    }
+    if (!(header_->flags & (TOKENIZER_SPACE_TO_METASPACE | TOKENIZER_PREPEND_METASPACE))) {
+        out.append(piece);
+        return;
+    }
+    size_t from = 0;
+    for (size_t at = piece.find(METASPACE); at != std::string_view::npos; at = piece.find(METASPACE, from)) {
+        out.append(piece, from, at - from);
+        out.push_back(' ');
+        from = at + METASPACE_BYTES;
+    }
+    out.append(piece, from, piece.size() - from);
+}
+
+int32_t Tokenizer::token_to_id(std::string_view piece) const {
+    const int32_t id = added_trie_.find(piece.data(), piece.size());
+    return id >= 0 ? id : trie_.find(piece.data(), piece.size());
+}
+
+std::string_view Tokenizer::id_to_piece(int32_t id) const {
+    if (id < 0 || static_cast<uint32_t>(id) >= header_->vocab_size) {
+        return {};
+    }
+    return std::string_view(strings_ + piece_offsets_[id], piece_offsets_[id + 1] - piece_offsets_[id]);
+}
+
+TokenType Tokenizer::token_type(int32_t id) const {
+    return id >= 0 && static_cast<uint32_t>(id) < header_->vocab_size ? token_types_[id] : TokenType::NORMAL;
+}
+
+TokenizerThroughput measure_tokenizer_throughput(const Tokenizer& tokenizer, std::string_view sample,
+                                                 uint32_t iterations) {
+    using Clock = std::chrono::steady_clock;
+    iterations = std::max<uint32_t>(iterations, 1);
+    TokenizerThroughput result;
+    result.bytes = sample.size();
+
+    std::vector<int> ids;
+    tokenizer.encode(sample, false, ids); // Warms the per-thread buffers and the mapped pages
+    result.tokens = ids.size();
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        ids.clear();
+        tokenizer.encode(sample, false, ids);
+    }
+    const double encode_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::string text;
+    tokenizer.decode(ids.data(), ids.size(), false, text);
+    start = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        text.clear();
+        tokenizer.decode(ids.data(), ids.size(), false, text);
+    }
+    const double decode_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const double encoded_mb = static_cast<double>(sample.size()) * iterations / 1e6;
+    const double decoded_mb = static_cast<double>(text.size()) * iterations / 1e6;
+    result.encode_mb_per_s = encode_s > 0.0 ? encoded_mb / encode_s : 0.0;
+    result.decode_mb_per_s = decode_s > 0.0 ? decoded_mb / decode_s : 0.0;
+    return result;
+}
+
+}
@@ -0,0 +1,235 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "t760_engine/model/ModelConfig.h"
+#include "t760_engine/tensor/QuantizedLayout.h"
+#include "t760_engine/tensor/Float16.h"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace t760::test {
+
+namespace {
+
+constexpr uint32_t T760_MAGIC = 0x54373630; // "T760"
+constexpr uint16_t T760_VERSION = 3;
+constexpr uint64_t DATA_ALIGNMENT = 64;
+
+struct SyntheticTensor {
+    std::string name;
+    DataType data_type;
+    std::vector<uint32_t> dims;
+    std::vector<uint8_t> data;
+};
+
+std::vector<uint8_t> float_bytes(const std::vector<float>& values) {
+    std::vector<uint8_t> bytes(values.size() * sizeof(float));
+    std::memcpy(bytes.data(), values.data(), bytes.size());
+    return bytes;
+}
+
+SyntheticTensor make_norm(const std::string& name, uint32_t size, std::mt19937& rng) {
+    std::vector<float> weight(size);
+    fill_normal(weight, rng, 0.1f);
+    return SyntheticTensor{name, DataType::FP32, {size}, float_bytes(weight)};
+}
+
+SyntheticTensor make_matrix(const std::string& name, DataType data_type, uint32_t rows, uint32_t cols,
+                            std::mt19937& rng) {
+    SyntheticTensor tensor{name, data_type, {rows, cols}, {}};
+    if (data_type == DataType::QINT8 || data_type == DataType::QINT4) {
+        tensor.data = make_quantized_matrix(data_type, rows, cols, rng).buffer;
+        return tensor;
+    }
+    std::vector<float> values(static_cast<size_t>(rows) * cols);
+    fill_normal(values, rng, 1.0f / std::sqrt(static_cast<float>(cols)));
+    if (data_type == DataType::FP32) {
+        tensor.data = float_bytes(values);
+    } else if (data_type == DataType::FP16) {
+        tensor.data.resize(values.size() * sizeof(uint16_t));
+        auto* halves = reinterpret_cast<uint16_t*>(tensor.data.data());
+        for (size_t i = 0; i < values.size(); ++i) {
+            halves[i] = fp32_to_fp16(values[i]);
+        }
+    } else {
+        throw std::runtime_error("Synthetic models support QINT8, QINT4, FP16 and FP32 matrices.");
+    }
+    return tensor;
+}
+
+}
+
+void write_synthetic_model(const std::string& path, const SyntheticModelSpec& spec) {
+    std::mt19937 rng(spec.seed);
+    const uint32_t q_width = spec.heads * spec.head_size;
+    const uint32_t kv_width = spec.kv_heads * spec.head_size;
+    std::vector<SyntheticTensor> tensors;
+    tensors.push_back(make_matrix("model.embed_tokens.weight", DataType::FP16, spec.vocab_size, spec.hidden_size, rng));
+    tensors.push_back(make_norm("model.norm.weight", spec.hidden_size, rng));
+    if (spec.lm_head_rows > 0) {
+        tensors.push_back(make_matrix("lm_head.weight", DataType::FP16, spec.lm_head_rows, spec.hidden_size, rng));
+    }
+    for (uint32_t i = 0; i < spec.layers; ++i) {
+        const std::string prefix = "model.layers." + std::to_string(i) + ".";
+        for (const char* norm : {"input_layernorm.weight", "post_attention_layernorm.weight",
+                                 "pre_feedforward_layernorm.weight", "post_feedforward_layernorm.weight"}) {
+            tensors.push_back(make_norm(prefix + norm, spec.hidden_size, rng));
+        }
+        tensors.push_back(make_norm(prefix + "self_attn.q_norm.weight", spec.head_size, rng));
+        tensors.push_back(make_norm(prefix + "self_attn.k_norm.weight", spec.head_size, rng));
+        const DataType type = spec.projection_type;
+        tensors.push_back(make_matrix(prefix + "self_attn.q_proj.weight", type, q_width, spec.hidden_size, rng));
+        tensors.push_back(make_matrix(prefix + "self_attn.k_proj.weight", type, kv_width, spec.hidden_size, rng));
+        tensors.push_back(make_matrix(prefix + "self_attn.v_proj.weight", type, kv_width, spec.hidden_size, rng));
+        tensors.push_back(make_matrix(prefix + "self_attn.o_proj.weight", type, spec.hidden_size, q_width, rng));
+        tensors.push_back(
+            make_matrix(prefix + "mlp.gate_proj.weight", type, spec.intermediate_size, spec.hidden_size, rng));
+        tensors.push_back(
+            make_matrix(prefix + "mlp.up_proj.weight", type, spec.intermediate_size, spec.hidden_size, rng));
+        tensors.push_back(
+            make_matrix(prefix + "mlp.down_proj.weight", type, spec.hidden_size, spec.intermediate_size, rng));
+    }
+    for (uint32_t i = 0; i < spec.plan_layers; ++i) {
+        tensors.push_back(make_matrix("model.plan." + std::to_string(i) + ".weight", spec.projection_type,
+                                      spec.hidden_size, spec.hidden_size, rng));
+    }
+
+    ModelHeader header{};
+    header.magic = T760_MAGIC;
+    header.version = T760_VERSION;
+    header.layer_count = spec.layers;
+    header.vocab_size = spec.vocab_size;
+    header.hidden_size = spec.hidden_size;
+    header.intermediate_size = spec.intermediate_size;
+    header.heads = spec.heads;
+    header.head_size = spec.head_size;
+    header.kv_heads = spec.kv_heads;
+    header.seq_len = spec.seq_len;
+    header.rope_freq_base = constants::GEMMA3_ROPE_THETA;
+    const HardwareConfigHeader hardware{};
+    // Everything runs on the CPU.
+    ExecutionPlanHeader plan{};
+    plan.cpu_tensors_end_idx = static_cast<uint32_t>(tensors.size());
+
+    std::vector<TensorMetadata> table(tensors.size());
+    uint64_t offset = sizeof(header) + sizeof(hardware) + sizeof(plan) + table.size() * sizeof(TensorMetadata);
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        offset = (offset + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+        TensorMetadata& meta = table[i];
+        std::strncpy(meta.name, tensors[i].name.c_str(), sizeof(meta.name) - 1);
+        meta.processor_id = static_cast<uint8_t>(DeviceType::CPU);
+        meta.data_type = static_cast<uint32_t>(tensors[i].data_type);
+        meta.offset = offset;
+        meta.stored_size = tensors[i].data.size();
+        meta.original_size = tensors[i].data.size();
+        for (size_t d = 0; d < tensors[i].dims.size(); ++d) {
+            meta.dims[d] = tensors[i].dims[d];
+        }
+        offset += meta.stored_size;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to create synthetic model: " + path);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(&hardware), sizeof(hardware));
+    file.write(reinterpret_cast<const char*>(&plan), sizeof(plan));
+    file.write(reinterpret_cast<const char*>(table.data()),
+               static_cast<std::streamsize>(table.size() * sizeof(TensorMetadata)));
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        file.seekp(static_cast<std::streamoff>(table[i].offset));
+        file.write(reinterpret_cast<const char*>(tensors[i].data.data()),
+                   static_cast<std::streamsize>(tensors[i].data.size()));
+    }
+    if (!file) {
+        throw std::runtime_error("Failed to write synthetic model: " + path);
+    }
+}
+
+std::unique_ptr<SyntheticLayer> make_synthetic_layer(const SyntheticModelSpec& spec, int64_t sliding_window) {
+    std::mt19937 rng(spec.seed);
+    const auto hidden = static_cast<int64_t>(spec.hidden_size);
+    const auto head_dim = static_cast<int64_t>(spec.head_size);
+    const auto heads = static_cast<int64_t>(spec.heads);
+    const auto kv_heads = static_cast<int64_t>(spec.kv_heads);
+    const auto intermediate = static_cast<int64_t>(spec.intermediate_size);
+
+    auto layer = std::make_unique<SyntheticLayer>();
+    layer->rope = kernels::RopeTable(head_dim, spec.seq_len,
+                                     sliding_window > 0 ? constants::GEMMA3_ROPE_LOCAL_BASE_FREQ
+                                                        : constants::GEMMA3_ROPE_THETA);
+    kernels::DecoderLayerParams& params = layer->params;
+    params.hidden_size = hidden;
+    params.intermediate_size = intermediate;
+    params.rms_norm_eps = constants::GEMMA3_RMS_NORM_EPS;
+    params.fixed =
+        kernels::find_shape_kernel_set(kernels::DecoderShape{hidden, head_dim, heads, kv_heads, intermediate});
+    params.attention.num_heads = heads;
+    params.attention.num_kv_heads = kv_heads;
+    params.attention.head_dim = head_dim;
+    params.attention.scale = 1.0f / std::sqrt(constants::GEMMA3_QUERY_PRE_ATTN_SCALAR);
+    params.attention.sliding_window = sliding_window;
+    params.attention.rope = &layer->rope;
+
+    auto gain = [&](int64_t size) {
+        std::vector<float> weight(static_cast<size_t>(size));
+        fill_normal(weight, rng, 0.1f);
+        for (float& w : weight) {
+            w += 1.0f;
+        }
+        return weight;
+    };
+    auto linear = [&](int64_t rows, int64_t cols) {
+        SyntheticTensor tensor = make_matrix("", spec.projection_type, static_cast<uint32_t>(rows),
+                                             static_cast<uint32_t>(cols), rng);
+        layer->buffers.push_back(std::move(tensor.data));
+        const uint8_t* data = layer->buffers.back().data();
+        kernels::LinearWeight w;
+        w.data_type = spec.projection_type;
+        w.in_features = cols;
+        w.out_features = rows;
+        if (is_group_quantized(w.data_type)) {
+            w.quantized.quants = data;
+            w.quantized.scales =
+                reinterpret_cast<const float*>(data + quantized_quants_size_in_bytes(w.data_type, rows, cols));
+            w.quantized.rows = rows;
+            w.quantized.cols = cols;
+            w.quantized.data_type = w.data_type;
+        } else if (w.data_type == DataType::FP16) {
+            w.half.data_type = DataType::FP16;
+            w.half.rows = rows;
+            w.half.cols = cols;
+            w.half.data = reinterpret_cast<const uint16_t*>(data);
+        } else {
+            w.dense = reinterpret_cast<const float*>(data);
+        }
+        return w;
+    };
+    kernels::DecoderLayerWeights& w = layer->weights;
+    w.input_norm = gain(hidden);
+    w.post_attention_norm = gain(hidden);
+    w.pre_feedforward_norm = gain(hidden);
+    w.post_feedforward_norm = gain(hidden);
+    w.q_norm = gain(head_dim);
+    w.k_norm = gain(head_dim);
+    w.q_proj = linear(heads * head_dim, hidden);
+    w.k_proj = linear(kv_heads * head_dim, hidden);
+    w.v_proj = linear(kv_heads * head_dim, hidden);
+    w.o_proj = linear(hidden, heads * head_dim);
+    w.gate_proj = linear(intermediate, hidden);
+    w.up_proj = linear(intermediate, hidden);
+    w.down_proj = linear(hidden, intermediate);
+    kernels::validate_decoder_layer(params, w);
+    return layer;
+}
+
+std::string temp_path(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+} // namespace t760::test
@@ -0,0 +1,58 @@
+#ifndef T760_SYNTHETIC_MODEL_H
+#define T760_SYNTHETIC_MODEL_H
+
+#include "t760_engine/core/Types.h"
+#include "t760_engine/kernels/DecoderLayer.h"
+#include "t760_engine/kernels/Rope.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace t760::test {
+
+// Shape of a Gemma3-style model of random weights: an FP16 embedding tied to
+// the lm_head, FP32 norms and projections of projection_type (QINT8, QINT4,
+// FP16 or FP32). The defaults load and decode in milliseconds.
+struct SyntheticModelSpec {
+    uint32_t layers = 2;
+    // [hidden_size, hidden_size] matrices of projection_type after the
+    // decoder layers, for the execution plan to run in a model with none.
+    uint32_t plan_layers = 0;
+    uint32_t vocab_size = 1024;
+    // Rows of a separate FP16 lm_head; 0 ties it to the embedding.
+    uint32_t lm_head_rows = 0;
+    uint32_t hidden_size = 128;
+    uint32_t intermediate_size = 256;
+    uint32_t heads = 2;
+    uint32_t head_size = 64;
+    uint32_t kv_heads = 1;
+    uint32_t seq_len = 512;
+    DataType projection_type = DataType::QINT8;
+    uint32_t seed = 1;
+};
+
+// Writes the model as a .t760 file that ModelLoader accepts; throws when the
+// file cannot be written.
+void write_synthetic_model(const std::string& path, const SyntheticModelSpec& spec = {});
+
+// One decoder layer of the spec's shape and random weights, set up as
+// InferencePipeline sets up its layers (shape-specialized kernels when the
+// shape has them). params.attention.rope points into the object, so it is
+// handed out by pointer.
+struct SyntheticLayer {
+    kernels::DecoderLayerParams params;
+    kernels::DecoderLayerWeights weights;
+    kernels::RopeTable rope;
+    std::vector<std::vector<uint8_t>> buffers; // Behind the projections
+};
+
+// A sliding-window layer when sliding_window > 0, else a global one.
+std::unique_ptr<SyntheticLayer> make_synthetic_layer(const SyntheticModelSpec& spec, int64_t sliding_window);
+
+// A path for name in the system's temporary directory.
+std::string temp_path(const std::string& name);
+
+} // namespace t760::test
+
+#endif // T760_SYNTHETIC_MODEL_H
@@ -0,0 +1,118 @@
+#include "support/TestSupport.h"
+#include "t760_engine/device/HardwareProber.h"
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+namespace t760::test {
+
+namespace {
+
+int g_failures = 0;
+
+constexpr IsaLevel ALL_ISA_LEVELS[] = {
+    IsaLevel::SCALAR,       IsaLevel::NEON,        IsaLevel::NEON_FP16, IsaLevel::NEON_DOTPROD,
+    IsaLevel::NEON_I8MM,    IsaLevel::NEON_BF16,   IsaLevel::SSE41,     IsaLevel::AVX2,
+    IsaLevel::AVX512,       IsaLevel::AVX512_VNNI, IsaLevel::AVX512_BF16,
+};
+
+}
+
+bool check(bool ok, const char* what, const char* file, int line) {
+    if (!ok) {
+        ++g_failures;
+        std::cerr << file << ":" << line << ": check failed: " << what << std::endl;
+    }
+    return ok;
+}
+
+int finish() {
+    if (g_failures > 0) {
+        std::cerr << g_failures << " check(s) failed." << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed." << std::endl;
+    return 0;
+}
+
+const CpuCapabilities& host_capabilities() {
+    static const CpuCapabilities caps = HardwareProber::probe().cpu;
+    return caps;
+}
+
+std::vector<IsaLevel> host_isa_levels() {
+    std::vector<IsaLevel> levels;
+    for (IsaLevel isa : ALL_ISA_LEVELS) {
+        if (is_isa_supported(isa, host_capabilities())) {
+            levels.push_back(isa);
+        }
+    }
+    return levels;
+}
+
+CpuKernelContext host_kernel_context(ThreadPool* pool) {
+    return make_cpu_kernel_context(host_capabilities(), pool);
+}
+
+uint32_t host_thread_count() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void fill_normal(std::vector<float>& values, std::mt19937& rng, float stddev) {
+    std::normal_distribution<float> dist(0.0f, stddev);
+    for (float& v : values) {
+        v = dist(rng);
+    }
+}
+
+float max_abs(const std::vector<float>& values) {
+    float m = 0.0f;
+    for (float v : values) {
+        m = std::max(m, std::fabs(v));
+    }
+    return m;
+}
+
+float max_abs_diff(const std::vector<float>& a, const std::vector<float>& b) {
+    float m = a.size() == b.size() ? 0.0f : INFINITY;
+    for (size_t i = 0; i < std::min(a.size(), b.size()); ++i) {
+        m = std::max(m, std::fabs(a[i] - b[i]));
+    }
+    return m;
+}
+
+QuantizedMatrix make_quantized_matrix(DataType data_type, int64_t rows, int64_t cols, std::mt19937& rng) {
+    const size_t quants_size = quantized_quants_size_in_bytes(data_type, rows, cols);
+    const int64_t groups = cols / constants::QUANT_GROUP_SIZE;
+    QuantizedMatrix matrix;
+    matrix.buffer.resize(quantized_tensor_size_in_bytes(data_type, TensorShape{{rows, cols}}));
+    auto* scales = reinterpret_cast<float*>(matrix.buffer.data() + quants_size);
+    const float stddev = 1.0f / std::sqrt(static_cast<float>(cols));
+    if (data_type == DataType::QINT8) {
+        std::vector<float> row(static_cast<size_t>(cols));
+        auto* quants = reinterpret_cast<int8_t*>(matrix.buffer.data());
+        for (int64_t r = 0; r < rows; ++r) {
+            fill_normal(row, rng, stddev);
+            kernels::quantize_row_q8(row.data(), cols, quants + r * cols, scales + r * groups);
+        }
+    } else {
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::uniform_real_distribution<float> scale(0.1f * stddev, 0.4f * stddev);
+        for (size_t i = 0; i < quants_size; ++i) {
+            matrix.buffer[i] = static_cast<uint8_t>(byte(rng));
+        }
+        for (int64_t i = 0; i < rows * groups; ++i) {
+            scales[i] = scale(rng);
+        }
+    }
+    matrix.view.quants = matrix.buffer.data();
+    matrix.view.scales = scales;
+    matrix.view.rows = rows;
+    matrix.view.cols = cols;
+    matrix.view.data_type = data_type;
+    return matrix;
+}
+
+} // namespace t760::test
@@ -0,0 +1,69 @@
+#ifndef T760_TEST_SUPPORT_H
+#define T760_TEST_SUPPORT_H
+
+#include "t760_engine/device/DeviceCapabilities.h"
+#include "t760_engine/kernels/KernelRegistry.h"
+#include "t760_engine/tensor/QuantizedLayout.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace t760::test {
+
+// Records a failed check with its location; the test keeps going so that one
+// run reports every mismatch.
+bool check(bool ok, const char* what, const char* file, int line);
+#define T760_CHECK(cond) ::t760::test::check((cond), #cond, __FILE__, __LINE__)
+
+// Process exit code: 0 when every check passed.
+int finish();
+
+// The capabilities HardwareProber reports for this host.
+const CpuCapabilities& host_capabilities();
+
+// Every ISA tier the host can run, slowest first.
+std::vector<IsaLevel> host_isa_levels();
+
+// make_cpu_kernel_context for the host; pool may be nullptr.
+CpuKernelContext host_kernel_context(ThreadPool* pool);
+
+// One pool thread per online CPU.
+uint32_t host_thread_count();
+
+void fill_normal(std::vector<float>& values, std::mt19937& rng, float stddev = 1.0f);
+
+float max_abs(const std::vector<float>& values);
+float max_abs_diff(const std::vector<float>& a, const std::vector<float>& b);
+
+// A [rows, cols] group-quantized weight that owns its buffer (see
+// QuantizedLayout.h): QINT8 rows are quantized from normal values scaled by
+// 1 / sqrt(cols), QINT4 gets random nibbles and scales of the same order.
+struct QuantizedMatrix {
+    std::vector<uint8_t> buffer;
+    QuantizedMatrixView view;
+};
+
+QuantizedMatrix make_quantized_matrix(DataType data_type, int64_t rows, int64_t cols, std::mt19937& rng);
+
+// Median milliseconds per call of fn over enough repetitions to fill min_ms,
+// after one warm-up call.
+template <typename Fn>
+double time_ms(Fn&& fn, double min_ms = 200.0) {
+    using clock = std::chrono::steady_clock;
+    fn();
+    std::vector<double> samples;
+    const auto start = clock::now();
+    do {
+        const auto t0 = clock::now();
+        fn();
+        samples.push_back(std::chrono::duration<double, std::milli>(clock::now() - t0).count());
+    } while (std::chrono::duration<double, std::milli>(clock::now() - start).count() < min_ms || samples.size() < 3);
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+} // namespace t760::test
+
+#endif // T760_TEST_SUPPORT_H
@@ -0,0 +1,19 @@
+#include "support/TestTokenizer.h"
+#include <cstdlib>
+#include <stdexcept>
+
+namespace t760::test {
+
+std::string test_tokenizer_json() {
+    return std::string(T760_TEST_DATA_DIR) + "/tokenizer.json";
+}
+
+void write_test_tokenizer(const std::string& path) {
+    const std::string command =
+        "\"" + std::string(T760_TOKENIZER_CONVERTER) + "\" \"" + test_tokenizer_json() + "\" \"" + path + "\"";
+    if (std::system(command.c_str()) != 0) {
+        throw std::runtime_error("tokenizer_converter failed on " + test_tokenizer_json());
+    }
+}
+
+} // namespace t760::test
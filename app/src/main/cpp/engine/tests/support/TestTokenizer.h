@@ -0,0 +1,19 @@
+#ifndef T760_TEST_TOKENIZER_H
+#define T760_TEST_TOKENIZER_H
+
+#include <string>
+
+namespace t760::test {
+
+// tests/data/tokenizer.json: a Gemma-style BPE vocab of 415 tokens (spaces
+// to U+2581, byte fallback, <start_of_turn> and <end_of_turn> as special
+// added tokens) learned from a few lines of English and JSON.
+std::string test_tokenizer_json();
+
+// Converts test_tokenizer_json() with the tokenizer_converter tool into a
+// .t760tok at path; throws when the tool fails.
+void write_test_tokenizer(const std::string& path);
+
+} // namespace t760::test
+
+#endif // T760_TEST_TOKENIZER_H
@@ -0,0 +1,121 @@
+#include "support/TestSupport.h"
+#include "t760_engine/core/ThreadPool.h"
+#include "t760_engine/kernels/Attention.h"
+#include "t760_engine/kernels/Gemm.h"
+#include "t760_engine/kernels/Rope.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Runs flash_attention on the dense micro-kernels of every tier the host
+// supports, on the calling thread and on a pool, against attention_reference.
+// Both read the same cache, filled by kv_cache_append, so the comparison
+// covers FP32 and FP16 caches, GQA, the sliding-window mask, RoPE and both
+// the decode (one query) and prefill paths.
+
+using namespace t760;
+using namespace t760::kernels;
+
+namespace {
+
+struct Case {
+    int64_t num_heads;
+    int64_t num_kv_heads;
+    int64_t head_dim;
+    int64_t sliding_window;
+    bool rope;
+};
+
+constexpr Case CASES[] = {
+    {4, 1, 256, 0, true},    // Gemma3 270M global layer
+    {4, 1, 256, 512, true},  // and its sliding-window layers
+    {8, 2, 64, 0, false},
+    {6, 3, 128, 100, true},
+    {2, 2, 32, 7, false},
+};
+
+// {first_pos, num_queries}: decode steps, a first chunk, and a chunk that
+// starts mid-cache and crosses the window.
+constexpr int64_t RUNS[][2] = {{0, 1}, {700, 1}, {0, 37}, {300, 300}, {1000, 64}};
+constexpr int64_t MAX_POSITIONS = 1100;
+
+// The tiers and pool settings flash_attention runs under.
+struct Variant {
+    IsaLevel isa;
+    CpuKernelContext ctx;
+};
+
+void check_case(const std::vector<Variant>& variants, const Case& c, DataType cache_type, std::mt19937& rng) {
+    AttentionParams params;
+    params.num_heads = c.num_heads;
+    params.num_kv_heads = c.num_kv_heads;
+    params.head_dim = c.head_dim;
+    params.scale = 1.0f / std::sqrt(static_cast<float>(c.head_dim));
+    params.sliding_window = c.sliding_window;
+    const RopeTable rope(c.head_dim, MAX_POSITIONS, 10000.0f);
+    params.rope = c.rope ? &rope : nullptr;
+
+    const int64_t kv_width = c.num_kv_heads * c.head_dim;
+    const size_t element = cache_type == DataType::FP16 ? sizeof(uint16_t) : sizeof(float);
+    std::vector<uint8_t> keys(static_cast<size_t>(MAX_POSITIONS * kv_width) * element);
+    std::vector<uint8_t> values(keys.size());
+    const KvCacheBuffer cache{keys.data(), values.data(), cache_type, MAX_POSITIONS};
+
+    for (const auto& run : RUNS) {
+        const int64_t first_pos = run[0];
+        const int64_t num_queries = run[1];
+        const int64_t length = first_pos + num_queries;
+        std::vector<float> k(static_cast<size_t>(length * kv_width));
+        std::vector<float> v(k.size());
+        test::fill_normal(k, rng);
+        test::fill_normal(v, rng);
+        kv_cache_append(params, variants.front().ctx, k.data(), v.data(), length, 0, cache);
+
+        std::vector<float> q(static_cast<size_t>(num_queries * c.num_heads * c.head_dim));
+        test::fill_normal(q, rng);
+        std::vector<float> out_ref(q.size());
+        attention_reference(params, q.data(), num_queries, first_pos, cache.view(length), out_ref.data());
+        const float tolerance = 1e-4f * std::max(1.0f, test::max_abs(out_ref));
+
+        std::vector<float> out(q.size());
+        for (const Variant& variant : variants) {
+            flash_attention(params, variant.ctx, q.data(), num_queries, first_pos, cache.view(length), out.data());
+            const float diff = test::max_abs_diff(out, out_ref);
+            if (!T760_CHECK(diff <= tolerance)) {
+                std::cerr << "  " << to_string(variant.isa) << (variant.ctx.pool ? " pooled" : "")
+                          << " heads=" << c.num_heads << "/" << c.num_kv_heads << " head_dim=" << c.head_dim
+                          << " window=" << c.sliding_window << (c.rope ? " rope" : "")
+                          << (cache_type == DataType::FP16 ? " fp16" : " fp32") << " first_pos=" << first_pos
+                          << " queries=" << num_queries << " max diff " << diff << std::endl;
+            }
+        }
+    }
+}
+
+}
+
+int main() {
+    std::mt19937 rng(33);
+    ThreadPool pool(std::min(4u, test::host_thread_count()), ~0ull);
+    std::vector<Variant> variants;
+    for (IsaLevel isa : test::host_isa_levels()) {
+        const GemmKernelSet* ks = get_gemm_kernel_set(isa);
+        if (!ks) {
+            continue;
+        }
+        std::cout << "Tier " << to_string(isa) << std::endl;
+        for (ThreadPool* p : {static_cast<ThreadPool*>(nullptr), &pool}) {
+            CpuKernelContext ctx = test::host_kernel_context(p);
+            ctx.gemm = ks;
+            variants.push_back(Variant{isa, ctx});
+        }
+    }
+    for (const Case& c : CASES) {
+        for (DataType cache_type : {DataType::FP32, DataType::FP16}) {
+            check_case(variants, c, cache_type, rng);
+        }
+    }
+    return test::finish();
+}
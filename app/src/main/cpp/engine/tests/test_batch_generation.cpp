@@ -0,0 +1,143 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "t760_engine/core/Engine.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+// generate_batch on the fused decoder against the same prompts run one
+// conversation at a time through generate(): prompts of different lengths
+// and limits, stop tokens that end some early, fewer slots than prompts so
+// that finished slots are reset and reused, and an empty prompt that fails
+// alone. Greedy, then sampled: prompt i must sample what a conversation
+// seeded with seed + i does.
+
+using namespace t760;
+
+namespace {
+
+constexpr uint64_t SEED = 5;
+
+struct Expected {
+    std::vector<int32_t> tokens;
+    GenerationStatus status = GenerationStatus::RUNNING;
+};
+
+// generate_async's rules on a generate() loop.
+Expected sequential(Engine& engine, const BatchPrompt& prompt, uint64_t seed) {
+    ConversationOptions conversation;
+    conversation.priority = RequestPriority::BACKGROUND;
+    conversation.seed = seed;
+    const ConversationHandle handle = engine.start_new_conversation(conversation);
+    OutputOptions options;
+    options.sampling = prompt.params.sampling;
+    const std::vector<int32_t>& stops = prompt.params.stop_tokens;
+    Expected expected;
+    StepOutput output;
+    engine.generate(handle, prompt.tokens.data(), prompt.tokens.size(), output, options);
+    while (true) {
+        const int32_t token = output.next_token;
+        if (std::find(stops.begin(), stops.end(), token) != stops.end()) {
+            expected.status = GenerationStatus::STOPPED;
+            break;
+        }
+        if (expected.tokens.size() == prompt.params.max_new_tokens) {
+            expected.status = GenerationStatus::LENGTH;
+            break;
+        }
+        expected.tokens.push_back(token);
+        engine.generate(handle, &token, 1, output, options);
+    }
+    engine.end_conversation(handle);
+    return expected;
+}
+
+std::vector<BatchPrompt> make_prompts(Engine& engine, const SamplingParams& sampling) {
+    const size_t lengths[] = {1, 7, 40, 3, 19, 2, 33, 11};
+    const uint32_t limits[] = {12, 5, 20, 1, 16, 9, 12, 20};
+    std::vector<BatchPrompt> prompts;
+    for (size_t i = 0; i < std::size(lengths); ++i) {
+        BatchPrompt prompt;
+        for (size_t t = 0; t < lengths[i]; ++t) {
+            prompt.tokens.push_back(static_cast<int>((t * 97 + i * 31 + 5) % 1024));
+        }
+        prompt.params.sampling = sampling;
+        prompt.params.max_new_tokens = limits[i];
+        prompts.push_back(prompt);
+    }
+    // Every third prompt stops on the fourth token it would produce.
+    for (size_t i = 0; i < prompts.size(); i += 3) {
+        const Expected unstopped = sequential(engine, prompts[i], SEED + i);
+        if (unstopped.tokens.size() > 4) {
+            prompts[i].params.stop_tokens = {unstopped.tokens[3]};
+        }
+    }
+    return prompts;
+}
+
+void check_batch(Engine& engine, const SamplingParams& sampling, const char* name) {
+    std::vector<BatchPrompt> prompts = make_prompts(engine, sampling);
+    prompts.insert(prompts.begin() + 4, BatchPrompt{}); // Empty: fails on its own
+
+    std::vector<Expected> expected;
+    for (size_t i = 0; i < prompts.size(); ++i) {
+        expected.push_back(prompts[i].tokens.empty() ? Expected{{}, GenerationStatus::FAILED}
+                                                     : sequential(engine, prompts[i], SEED + i));
+    }
+    bool stopped = false;
+    for (const Expected& e : expected) {
+        stopped = stopped || e.status == GenerationStatus::STOPPED;
+    }
+    T760_CHECK(stopped);
+
+    for (uint32_t max_active : {3u, 0u}) {
+        BatchOptions options;
+        options.seed = SEED;
+        options.max_active = max_active;
+        const std::vector<BatchCompletion> completions = engine.generate_batch(prompts, options);
+        if (!T760_CHECK(completions.size() == prompts.size())) {
+            continue;
+        }
+        for (size_t i = 0; i < prompts.size(); ++i) {
+            const bool same =
+                completions[i].status == expected[i].status && completions[i].tokens == expected[i].tokens;
+            if (!T760_CHECK(same)) {
+                std::cerr << "  " << name << ", max_active " << max_active << ": prompt " << i << " got "
+                          << completions[i].tokens.size() << " tokens, expected " << expected[i].tokens.size()
+                          << std::endl;
+            }
+        }
+        T760_CHECK(!completions[4].error.empty());
+    }
+}
+
+}
+
+int main() {
+    test::SyntheticModelSpec spec;
+    spec.lm_head_rows = spec.vocab_size; // Untied, so greedy decoding does not just repeat its input
+    const std::string model_path = test::temp_path("t760_batch_generation.t760");
+    test::write_synthetic_model(model_path, spec);
+
+    EngineConfig config;
+    config.devices = {{DeviceType::CPU, 0, true}};
+    config.threading.big_threads = 2;
+    config.threading.big_affinity_mask = ~0ull;
+    config.threading.little_threads = 2;
+    config.threading.little_affinity_mask = ~0ull;
+    Engine engine;
+    engine.initialize(config);
+    if (T760_CHECK(engine.load_model(model_path))) {
+        SamplingParams greedy;
+        greedy.do_sample = false;
+        check_batch(engine, greedy, "greedy");
+        SamplingParams sampled;
+        sampled.temperature = 0.8f;
+        sampled.top_k = 40;
+        check_batch(engine, sampled, "sampled");
+    }
+    engine.shutdown();
+    std::remove(model_path.c_str());
+    return test::finish();
+}
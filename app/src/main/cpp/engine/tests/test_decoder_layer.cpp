@@ -0,0 +1,226 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "t760_engine/core/ThreadPool.h"
+#include "t760_engine/kernels/DecoderLayer.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+// Runs decoder_layer_forward and decoder_layer_forward_batch on the host's
+// kernels, with and without the shape-specialized set and a pool, against
+// decoder_layer_reference for every projection data type. Each path keeps
+// its own FP16 cache, as InferencePipeline does, over a run of prefill chunks
+// and decode steps that crosses the sliding window.
+//
+// Dense weights agree to rounding, as do quantized prefill chunks on FP32
+// activations. The reference quantizes a lone row before a quantized
+// projection as decode does, but from a differently rounded input, so a
+// decode step may land one int8 rounding step apart. W8A8 prefill
+// (int8_prefill) also quantizes multi-row inputs, which the reference keeps
+// in FP32; from its first chunk on, the layer and its cache compare at the
+// activation quantization error.
+
+using namespace t760;
+using namespace t760::kernels;
+
+namespace {
+
+constexpr int64_t SLIDING_WINDOW = 48;
+constexpr int64_t CHUNKS[] = {37, 1, 1, 20, 1, 1};
+constexpr int64_t BATCH_PROMPTS[] = {5, 17, 2, 30};
+constexpr int64_t BATCH_DECODE_STEPS = 3;
+
+test::SyntheticModelSpec layer_spec(DataType projection_type) {
+    // Gemma3 270M's layer shape, which has fixed-size kernels.
+    test::SyntheticModelSpec spec;
+    spec.hidden_size = 640;
+    spec.intermediate_size = 2048;
+    spec.heads = 4;
+    spec.head_size = 256;
+    spec.kv_heads = 1;
+    spec.seq_len = 128;
+    spec.projection_type = projection_type;
+    spec.seed = 33;
+    return spec;
+}
+
+struct Cache {
+    std::vector<uint16_t> keys;
+    std::vector<uint16_t> values;
+    KvCacheBuffer buffer;
+
+    Cache(int64_t positions, int64_t kv_width)
+        : keys(static_cast<size_t>(positions * kv_width)), values(keys.size()),
+          buffer{keys.data(), values.data(), DataType::FP16, positions} {}
+};
+
+const char* type_name(DataType data_type) {
+    switch (data_type) {
+    case DataType::FP32: return "fp32";
+    case DataType::FP16: return "fp16";
+    case DataType::QINT8: return "q8";
+    case DataType::QINT4: return "q4";
+    default: return "?";
+    }
+}
+
+// Relative to the largest output.
+float tolerance(const DecoderLayerParams& params, DataType projection_type, bool decode) {
+    if (!is_group_quantized(projection_type)) {
+        return 1e-4f;
+    }
+    if (params.int8_prefill) {
+        return 3e-2f;
+    }
+    return decode ? 1e-2f : 1e-4f;
+}
+
+// Inputs and the reference's outputs of each call of a run.
+struct Expected {
+    std::vector<std::vector<float>> inputs;
+    std::vector<std::vector<float>> outputs;
+};
+
+// The kernel settings a layer runs under; the reference ignores all of them.
+struct Variant {
+    DecoderLayerParams params;
+    CpuKernelContext ctx;
+};
+
+void compare(const char* what, const Variant& variant, DataType projection_type, bool decode,
+             const std::vector<float>& x, const std::vector<float>& ref, int64_t step) {
+    const float diff = test::max_abs_diff(x, ref);
+    const float limit = tolerance(variant.params, projection_type, decode) * std::max(1.0f, test::max_abs(ref));
+    if (!T760_CHECK(diff <= limit)) {
+        std::cerr << "  " << what << " " << type_name(projection_type)
+                  << " window=" << variant.params.attention.sliding_window << (variant.params.fixed ? " fixed" : "")
+                  << (variant.params.int8_prefill ? " int8_prefill" : "") << (variant.ctx.pool ? " pooled" : "")
+                  << " step " << step << " max diff " << diff << std::endl;
+    }
+}
+
+std::vector<float> random_rows(int64_t count, int64_t hidden, std::mt19937& rng) {
+    std::vector<float> x(static_cast<size_t>(count * hidden));
+    test::fill_normal(x, rng);
+    return x;
+}
+
+// decoder_layer_forward over CHUNKS.
+Expected reference_forward(const test::SyntheticLayer& layer, std::mt19937& rng) {
+    const DecoderLayerParams& params = layer.params;
+    Cache cache(layer.rope.max_positions(), params.attention.num_kv_heads * params.attention.head_dim);
+    Expected expected;
+    int64_t pos = 0;
+    for (int64_t count : CHUNKS) {
+        expected.inputs.push_back(random_rows(count, params.hidden_size, rng));
+        expected.outputs.push_back(expected.inputs.back());
+        decoder_layer_reference(params, layer.weights, expected.outputs.back().data(), count, pos, cache.buffer);
+        pos += count;
+    }
+    return expected;
+}
+
+void check_forward(const test::SyntheticLayer& layer, const Variant& variant, DataType projection_type,
+                   const Expected& expected) {
+    const DecoderLayerParams& params = variant.params;
+    Cache cache(layer.rope.max_positions(), params.attention.num_kv_heads * params.attention.head_dim);
+    int64_t pos = 0;
+    for (size_t step = 0; step < std::size(CHUNKS); ++step) {
+        std::vector<float> x = expected.inputs[step];
+        decoder_layer_forward(params, layer.weights, variant.ctx, x.data(), CHUNKS[step], pos, cache.buffer);
+        compare("forward", variant, projection_type, CHUNKS[step] == 1, x, expected.outputs[step],
+                static_cast<int64_t>(step));
+        pos += CHUNKS[step];
+    }
+}
+
+// A prefill batch of uneven prompts, then BATCH_DECODE_STEPS decode batches
+// of one row each. No prompt is a single row: inside a mixed batch that row
+// keeps FP32 activations, where the reference would quantize it.
+struct Batch {
+    std::vector<Cache> caches;
+    std::vector<DecoderSequence> sequences;
+
+    explicit Batch(const test::SyntheticLayer& layer) {
+        const AttentionParams& ap = layer.params.attention;
+        caches.reserve(std::size(BATCH_PROMPTS));
+        for (int64_t prompt : BATCH_PROMPTS) {
+            caches.emplace_back(layer.rope.max_positions(), ap.num_kv_heads * ap.head_dim);
+            sequences.push_back(DecoderSequence{prompt, 0, caches.back().buffer});
+        }
+    }
+
+    int64_t rows() const {
+        int64_t total = 0;
+        for (const DecoderSequence& seq : sequences) {
+            total += seq.count;
+        }
+        return total;
+    }
+
+    void advance() {
+        for (DecoderSequence& seq : sequences) {
+            seq.first_pos += seq.count;
+            seq.count = 1;
+        }
+    }
+};
+
+Expected reference_batch(const test::SyntheticLayer& layer, std::mt19937& rng) {
+    const DecoderLayerParams& params = layer.params;
+    Batch batch(layer);
+    Expected expected;
+    for (int64_t step = 0; step <= BATCH_DECODE_STEPS; ++step) {
+        expected.inputs.push_back(random_rows(batch.rows(), params.hidden_size, rng));
+        expected.outputs.push_back(expected.inputs.back());
+        float* row = expected.outputs.back().data();
+        for (const DecoderSequence& seq : batch.sequences) {
+            decoder_layer_reference(params, layer.weights, row, seq.count, seq.first_pos, seq.cache);
+            row += seq.count * params.hidden_size;
+        }
+        batch.advance();
+    }
+    return expected;
+}
+
+void check_batch(const test::SyntheticLayer& layer, const Variant& variant, DataType projection_type,
+                 const Expected& expected) {
+    Batch batch(layer);
+    for (int64_t step = 0; step <= BATCH_DECODE_STEPS; ++step) {
+        std::vector<float> x = expected.inputs[static_cast<size_t>(step)];
+        decoder_layer_forward_batch(variant.params, layer.weights, variant.ctx, x.data(), batch.sequences.data(),
+                                    batch.sequences.size());
+        compare("batch", variant, projection_type, step > 0, x, expected.outputs[static_cast<size_t>(step)], step);
+        batch.advance();
+    }
+}
+
+}
+
+int main() {
+    std::mt19937 rng(33);
+    ThreadPool pool(std::min(4u, test::host_thread_count()), ~0ull);
+    for (DataType projection_type : {DataType::FP32, DataType::FP16, DataType::QINT8, DataType::QINT4}) {
+        const test::SyntheticModelSpec spec = layer_spec(projection_type);
+        for (int64_t window : {int64_t{0}, SLIDING_WINDOW}) {
+            const auto layer = test::make_synthetic_layer(spec, window);
+            T760_CHECK(layer->params.fixed != nullptr);
+            const Expected forward = reference_forward(*layer, rng);
+            const Expected batch = reference_batch(*layer, rng);
+            for (ThreadPool* p : {static_cast<ThreadPool*>(nullptr), &pool}) {
+                for (bool fixed : {false, true}) {
+                    for (bool int8_prefill : {false, true}) {
+                        Variant variant{layer->params, test::host_kernel_context(p)};
+                        variant.params.fixed = fixed ? layer->params.fixed : nullptr;
+                        variant.params.int8_prefill = int8_prefill;
+                        check_forward(*layer, variant, projection_type, forward);
+                        check_batch(*layer, variant, projection_type, batch);
+                    }
+                }
+            }
+        }
+    }
+    return test::finish();
+}
@@ -0,0 +1,174 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "t760_engine/core/ClusterPools.h"
+#include "t760_engine/core/Engine.h"
+#include "t760_engine/device/DeviceManager.h"
+#include "t760_engine/model/ModelLoader.h"
+#include "t760_engine/pipeline/InferencePipeline.h"
+#include "t760_engine/platform/IPlatformBackend.h"
+#include "t760_engine/tensor/TensorManager.h"
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// Engine::embed with MEAN and LAST_TOKEN pooling, normalized or not, on
+// inputs that end on, before and after 32-token chunk boundaries: an engine
+// that prefills in 32-token chunks must pool what one that runs every input
+// in a single step does. MEAN sums each chunk's rows into the output as it
+// goes, so it also relies on InferencePipeline::embed zeroing the output
+// first: repeated calls, batches whose inputs share steps and split
+// differently, and a pipeline handed a dirty buffer must all agree.
+
+using namespace t760;
+
+namespace {
+
+constexpr size_t INPUT_LENGTHS[] = {1, 31, 32, 33, 100, 257};
+constexpr uint32_t CHUNK_TOKENS = 32;
+constexpr uint32_t UNCHUNKED_TOKENS = 2048;
+
+std::vector<int> make_input(size_t length, size_t salt) {
+    std::vector<int> input(length);
+    for (size_t i = 0; i < length; ++i) {
+        input[i] = static_cast<int>((i * 113 + salt * 29 + 3) % 1024);
+    }
+    return input;
+}
+
+std::unique_ptr<Engine> make_engine(const std::string& model_path, uint32_t chunk_tokens) {
+    EngineConfig config;
+    config.devices = {{DeviceType::CPU, 0, true}};
+    config.threading.big_threads = 2;
+    config.threading.big_affinity_mask = ~0ull;
+    config.threading.little_threads = 1;
+    config.threading.little_affinity_mask = ~0ull;
+    config.prefill_chunk_tokens = chunk_tokens;
+    config.step_token_budget = chunk_tokens;
+    auto engine = std::make_unique<Engine>();
+    engine->initialize(config);
+    if (!engine->load_model(model_path)) {
+        return nullptr;
+    }
+    return engine;
+}
+
+bool close_to(const std::vector<float>& actual, const std::vector<float>& expected) {
+    return actual.size() == expected.size() &&
+           test::max_abs_diff(actual, expected) <= 1e-4f * std::max(1.0f, test::max_abs(expected));
+}
+
+const char* pooling_name(EmbeddingPooling pooling) {
+    return pooling == EmbeddingPooling::MEAN ? "MEAN" : "LAST_TOKEN";
+}
+
+void check_pooling(Engine& chunked, Engine& unchunked, const EmbeddingOptions& options) {
+    std::vector<std::vector<int>> inputs;
+    std::vector<std::vector<float>> expected;
+    for (size_t i = 0; i < std::size(INPUT_LENGTHS); ++i) {
+        inputs.push_back(make_input(INPUT_LENGTHS[i], i));
+        expected.push_back(unchunked.embed(inputs.back(), options));
+        T760_CHECK(expected.back().size() == unchunked.embedding_size());
+
+        const std::vector<float> actual = chunked.embed(inputs.back(), options);
+        if (!T760_CHECK(close_to(actual, expected.back()))) {
+            std::cerr << "  " << pooling_name(options.pooling) << (options.normalize ? ", normalized" : "")
+                      << ", " << INPUT_LENGTHS[i] << " tokens: max diff " << test::max_abs_diff(actual, expected.back())
+                      << std::endl;
+        }
+        // Nothing carries over from the previous call.
+        T760_CHECK(chunked.embed(inputs.back(), options) == actual);
+        if (options.normalize) {
+            double norm = 0.0;
+            for (float v : actual) {
+                norm += static_cast<double>(v) * v;
+            }
+            T760_CHECK(std::abs(std::sqrt(norm) - 1.0) < 1e-4);
+        }
+    }
+    const std::vector<std::vector<float>> batch = chunked.embed_batch(inputs, options);
+    T760_CHECK(batch.size() == inputs.size());
+    for (size_t i = 0; i < batch.size() && i < expected.size(); ++i) {
+        if (!T760_CHECK(close_to(batch[i], expected[i]))) {
+            std::cerr << "  " << pooling_name(options.pooling) << " batch, input " << i << ": max diff "
+                      << test::max_abs_diff(batch[i], expected[i]) << std::endl;
+        }
+    }
+}
+
+// InferencePipeline::embed on an output full of garbage, set up as Engine
+// sets it up; Engine itself only ever passes zeroed buffers.
+void check_dirty_output(const std::string& model_path, const std::vector<std::vector<float>>& expected,
+                        const std::vector<std::vector<int>>& inputs) {
+    const CpuCapabilities caps = test::host_capabilities();
+    DeviceManager devices;
+    devices.initialize({{DeviceType::CPU, 0, true}});
+    ThreadingConfig threading;
+    threading.big_threads = 2;
+    threading.big_affinity_mask = ~0ull;
+    threading.little_threads = 1;
+    threading.little_affinity_mask = ~0ull;
+    ClusterPools pools(threading, caps);
+    std::unique_ptr<IPlatformBackend> backend = create_platform_backend();
+    backend->initialize(devices);
+    {
+        TensorManager tensors(*backend);
+        ModelLoader loader(tensors, make_weight_precision_policy(EngineConfig{}.weight_precision, caps));
+        InferencePipeline pipeline(devices, tensors, pools);
+        if (T760_CHECK(loader.load_model(model_path))) {
+            pipeline.prepare(*loader.get_model());
+            const size_t size = pipeline.embedding_size();
+            std::vector<float> rows(inputs.size() * size, 1e6f);
+            pipeline.embed(inputs.data(), inputs.size(), EmbeddingOptions{}, rows.data());
+            for (size_t i = 0; i < inputs.size(); ++i) {
+                const std::vector<float> row(rows.begin() + i * size, rows.begin() + (i + 1) * size);
+                T760_CHECK(close_to(row, expected[i]));
+            }
+            pipeline.release();
+            loader.unload_model();
+        }
+    }
+    backend->shutdown();
+}
+
+}
+
+int main() {
+    test::SyntheticModelSpec spec;
+    spec.seq_len = 512;
+    const std::string model_path = test::temp_path("t760_embedding.t760");
+    test::write_synthetic_model(model_path, spec);
+    {
+        std::unique_ptr<Engine> chunked = make_engine(model_path, CHUNK_TOKENS);
+        std::unique_ptr<Engine> unchunked = make_engine(model_path, UNCHUNKED_TOKENS);
+        if (T760_CHECK(chunked && unchunked)) {
+            for (EmbeddingPooling pooling : {EmbeddingPooling::MEAN, EmbeddingPooling::LAST_TOKEN}) {
+                for (bool normalize : {false, true}) {
+                    EmbeddingOptions options;
+                    options.pooling = pooling;
+                    options.normalize = normalize;
+                    check_pooling(*chunked, *unchunked, options);
+                }
+            }
+            // One token: its mean is its last.
+            EmbeddingOptions mean;
+            EmbeddingOptions last;
+            last.pooling = EmbeddingPooling::LAST_TOKEN;
+            T760_CHECK(close_to(chunked->embed({42}, mean), chunked->embed({42}, last)));
+
+            std::vector<std::vector<int>> inputs;
+            for (size_t i = 0; i < std::size(INPUT_LENGTHS); ++i) {
+                inputs.push_back(make_input(INPUT_LENGTHS[i], i));
+            }
+            check_dirty_output(model_path, unchunked->embed_batch(inputs, mean), inputs);
+        }
+        for (auto* engine : {chunked.get(), unchunked.get()}) {
+            if (engine) {
+                engine->shutdown();
+            }
+        }
+    }
+    std::remove(model_path.c_str());
+    return test::finish();
+}
@@ -0,0 +1,150 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "t760_engine/core/Engine.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Churns the engine from several threads at once: callers start a
+// conversation, prefill, decode, sometimes hand off to generate_async, and
+// end it, while another thread unloads and reloads the model under them.
+// Calls caught by an unload may throw; every sequence that completes must
+// still be the one a quiet engine produces. Configure with
+// -DT760_SANITIZER=thread to run it under ThreadSanitizer.
+
+using namespace t760;
+
+namespace {
+
+constexpr int CALLERS = 4;
+constexpr int RELOADS = 8;
+constexpr uint32_t DECODE_TOKENS = 6;
+
+const std::vector<int> PROMPT = {2, 17, 301, 44, 9, 512, 77, 130, 5, 999, 64, 3};
+
+EngineConfig make_config() {
+    EngineConfig config;
+    config.devices = {{DeviceType::CPU, 0, true}};
+    config.threading.big_threads = 2;
+    config.threading.big_affinity_mask = ~0ull;
+    config.threading.little_threads = 1;
+    config.threading.little_affinity_mask = ~0ull;
+    return config;
+}
+
+OutputOptions greedy() {
+    OutputOptions options;
+    options.sampling.do_sample = false;
+    return options;
+}
+
+// The prompt's greedy continuation through generate(); throws when a call
+// fails.
+std::vector<int32_t> decode(Engine& engine, ConversationHandle handle) {
+    std::vector<int32_t> tokens;
+    StepOutput output;
+    engine.generate(handle, PROMPT.data(), PROMPT.size(), output, greedy());
+    while (tokens.size() < DECODE_TOKENS) {
+        const int32_t token = output.next_token;
+        tokens.push_back(token);
+        engine.generate(handle, &token, 1, output, greedy());
+    }
+    return tokens;
+}
+
+// The same continuation through generate_async; empty when the task did
+// not run to max_new_tokens.
+std::vector<int32_t> decode_async(Engine& engine, ConversationHandle handle) {
+    GenerationParams params;
+    params.sampling.do_sample = false;
+    params.max_new_tokens = DECODE_TOKENS;
+    std::vector<int32_t> tokens;
+    auto task = engine.generate_async(handle, PROMPT, params, [&tokens](int32_t token) { tokens.push_back(token); });
+    if (task->wait() != GenerationStatus::LENGTH) {
+        tokens.clear();
+    }
+    return tokens;
+}
+
+}
+
+int main() {
+    const std::string model_path = test::temp_path("t760_engine_stress.t760");
+    test::write_synthetic_model(model_path);
+
+    Engine engine;
+    engine.initialize(make_config());
+    if (!T760_CHECK(engine.load_model(model_path))) {
+        return test::finish();
+    }
+    ConversationHandle handle = engine.start_new_conversation();
+    const std::vector<int32_t> expected = decode(engine, handle);
+    engine.end_conversation(handle);
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> completed{0};
+    std::atomic<int> interrupted{0};
+    std::atomic<int> mismatched{0};
+    std::vector<std::thread> callers;
+    for (int caller = 0; caller < CALLERS; ++caller) {
+        callers.emplace_back([&, caller] {
+            for (int round = 0; !stop; ++round) {
+                try {
+                    const ConversationHandle h = engine.start_new_conversation();
+                    const bool async = (round + caller) % 3 == 0;
+                    const std::vector<int32_t> tokens = async ? decode_async(engine, h) : decode(engine, h);
+                    engine.end_conversation(h);
+                    if (tokens.empty()) {
+                        ++interrupted;
+                    } else if (tokens == expected) {
+                        ++completed;
+                    } else {
+                        ++mismatched;
+                    }
+                } catch (const std::exception&) {
+                    // The model is being swapped; back off instead of spinning.
+                    ++interrupted;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        });
+    }
+
+    // Each model stays loaded until a sequence has completed on it, however
+    // slow the build (sanitizers), and is then swapped under calls in flight.
+    const auto wait_for_progress = [&] {
+        const int before = completed;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (completed == before && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+    };
+    for (int reload = 0; reload < RELOADS; ++reload) {
+        wait_for_progress();
+        engine.unload_model();
+        T760_CHECK(engine.load_model(model_path));
+    }
+    wait_for_progress();
+    stop = true;
+    for (std::thread& thread : callers) {
+        thread.join();
+    }
+
+    std::cout << completed << " sequences completed, " << interrupted << " interrupted, " << mismatched
+              << " mismatched" << std::endl;
+    T760_CHECK(completed > 0);
+    T760_CHECK(mismatched == 0);
+    T760_CHECK(engine.get_state() == EngineState::MODEL_LOADED);
+    handle = engine.start_new_conversation();
+    T760_CHECK(decode(engine, handle) == expected);
+    engine.end_conversation(handle);
+
+    engine.shutdown();
+    std::remove(model_path.c_str());
+    return test::finish();
+}
@@ -0,0 +1,250 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "t760_engine/core/Engine.h"
+#include "t760_engine/core/ThreadPool.h"
+#include "t760_engine/kernels/Gemm.h"
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include "t760_engine/pipeline/ExecutionScheduler.h"
+#include "t760_engine/tensor/Float16.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// Derives graphs from a model's execution plan with PlanGraphBuilder and
+// runs several sequences through them at once on the CPU executor, against
+// the reference matmuls. Then loads a model the fused decoder cannot run
+// into the engine, whose plan layers must produce tokens, and checks that
+// generate_batch, which submits every conversation's pass as one graph,
+// samples what generate() does one conversation at a time.
+
+using namespace t760;
+using namespace t760::kernels;
+
+namespace {
+
+constexpr int64_t HIDDEN = 64;
+constexpr int64_t ROWS[] = {1, 5, 33}; // One sequence each
+constexpr uint32_t DECODE_TOKENS = 4;
+
+// A table entry of the in-memory model, over data the test owns.
+struct Entry {
+    std::string name;
+    DataType data_type;
+    TensorShape shape;
+    std::vector<uint8_t> data;
+};
+
+std::vector<uint8_t> float_bytes(const std::vector<float>& values) {
+    std::vector<uint8_t> bytes(values.size() * sizeof(float));
+    std::memcpy(bytes.data(), values.data(), bytes.size());
+    return bytes;
+}
+
+// Every entry in the CPU range of the plan.
+std::unique_ptr<Model> make_model(std::vector<Entry>& entries) {
+    auto config = std::make_unique<ModelConfig>();
+    std::vector<std::unique_ptr<Tensor>> tensors;
+    for (Entry& entry : entries) {
+        TensorMetadata meta{};
+        std::strncpy(meta.name, entry.name.c_str(), sizeof(meta.name) - 1);
+        meta.processor_id = static_cast<uint8_t>(DeviceType::CPU);
+        meta.data_type = static_cast<uint32_t>(entry.data_type);
+        config->tensor_metadata_table.push_back(meta);
+        auto buffer = std::make_unique<Buffer>(DeviceType::CPU, nullptr, entry.data.data(), entry.data.size(),
+                                               [](void*, void*, size_t) {});
+        tensors.push_back(std::make_unique<Tensor>(entry.name, entry.shape, entry.data_type, TensorLayout::DENSE,
+                                                   std::move(buffer)));
+    }
+    config->exec_plan_header.cpu_tensors_end_idx = static_cast<uint32_t>(entries.size());
+    auto model = std::make_unique<Model>(std::move(config));
+    model->assign_tensors(std::move(tensors));
+    return model;
+}
+
+void check_plan_device() {
+    ModelConfig config;
+    config.tensor_metadata_table.resize(7);
+    config.tensor_metadata_table[6].processor_id = static_cast<uint8_t>(DeviceType::GPU);
+    config.exec_plan_header = ExecutionPlanHeader{0, 2, 2, 3, 3, 6};
+    const DeviceType expected[] = {DeviceType::NPU, DeviceType::NPU, DeviceType::GPU, DeviceType::CPU,
+                                   DeviceType::CPU, DeviceType::CPU, DeviceType::GPU};
+    for (size_t i = 0; i < config.tensor_metadata_table.size(); ++i) {
+        T760_CHECK(plan_device(config, i) == expected[i]);
+    }
+}
+
+// embed and norm are not plan layers; the rest chain 64 -> 96 -> 80 -> 64:
+// a QINT8 [out, in] matrix, then dense FP32 and FP16 [in, out] ones.
+void check_plan_graph(std::mt19937& rng) {
+    const test::QuantizedMatrix q8 = test::make_quantized_matrix(DataType::QINT8, 96, HIDDEN, rng);
+    std::vector<float> dense(96 * 80);
+    test::fill_normal(dense, rng, 0.1f);
+    std::vector<float> half_values(80 * HIDDEN);
+    test::fill_normal(half_values, rng, 0.1f);
+    std::vector<uint8_t> half(half_values.size() * sizeof(uint16_t));
+    auto* halves = reinterpret_cast<uint16_t*>(half.data());
+    for (size_t i = 0; i < half_values.size(); ++i) {
+        halves[i] = fp32_to_fp16(half_values[i]);
+        half_values[i] = fp16_to_fp32(halves[i]);
+    }
+    std::vector<Entry> entries;
+    entries.push_back(Entry{"embed", DataType::FP16, TensorShape{{100, HIDDEN}}, std::vector<uint8_t>(100 * 128)});
+    entries.push_back(Entry{"norm", DataType::FP32, TensorShape{{HIDDEN}}, std::vector<uint8_t>(HIDDEN * 4)});
+    entries.push_back(Entry{"plan.0", DataType::QINT8, TensorShape{{96, HIDDEN}}, q8.buffer});
+    entries.push_back(Entry{"plan.1", DataType::FP32, TensorShape{{96, 80}}, float_bytes(dense)});
+    entries.push_back(Entry{"plan.2", DataType::FP16, TensorShape{{80, HIDDEN}}, half});
+    auto model = make_model(entries);
+    const std::vector<const Tensor*> excluded = {model->get_tensor("embed")};
+
+    const PlanGraphBuilder plan(*model, excluded);
+    T760_CHECK(plan.layers().size() == 3);
+    T760_CHECK(plan.in_features() == HIDDEN && plan.out_features() == HIDDEN);
+    for (size_t i = 0; i < plan.layers().size(); ++i) {
+        T760_CHECK(plan.layers()[i].index == i + 2);
+        T760_CHECK(plan.layers()[i].device == DeviceType::CPU);
+    }
+    T760_CHECK(plan.layers()[1].in_features == 96 && plan.layers()[1].out_features == 80);
+
+    DeviceManager device_manager;
+    device_manager.initialize({{DeviceType::CPU, 0, true}});
+    ThreadPool pool(std::min(4u, test::host_thread_count()), ~0ull);
+    ExecutionScheduler scheduler(*model, device_manager, &pool);
+    T760_CHECK(scheduler.has_executor(DeviceType::CPU) && !scheduler.has_executor(DeviceType::GPU));
+
+    // One chain per sequence, all in one graph.
+    ExecutionGraph graph;
+    std::vector<std::vector<std::vector<float>>> rows(std::size(ROWS));
+    std::vector<std::vector<std::unique_ptr<Tensor>>> activations(std::size(ROWS));
+    for (size_t s = 0; s < std::size(ROWS); ++s) {
+        const int64_t widths[] = {HIDDEN, 96, 80, HIDDEN};
+        std::vector<Tensor*> chain;
+        for (int64_t width : widths) {
+            rows[s].emplace_back(static_cast<size_t>(ROWS[s] * width));
+            auto buffer = std::make_unique<Buffer>(DeviceType::CPU, nullptr, rows[s].back().data(),
+                                                   rows[s].back().size() * sizeof(float),
+                                                   [](void*, void*, size_t) {});
+            activations[s].push_back(std::make_unique<Tensor>("x", TensorShape{{ROWS[s], width}}, DataType::FP32,
+                                                              TensorLayout::DENSE, std::move(buffer)));
+            chain.push_back(activations[s].back().get());
+        }
+        test::fill_normal(rows[s][0], rng);
+        plan.add_sequence(graph, chain);
+    }
+    T760_CHECK(graph.size() == 3 * std::size(ROWS));
+    scheduler.submit(graph).wait();
+
+    for (size_t s = 0; s < std::size(ROWS); ++s) {
+        const int64_t m = ROWS[s];
+        std::vector<float> h1(static_cast<size_t>(m * 96));
+        std::vector<float> h2(static_cast<size_t>(m * 80));
+        std::vector<float> out(static_cast<size_t>(m * HIDDEN));
+        if (m == 1) {
+            gemv_quantized_reference(rows[s][0].data(), q8.view, h1.data());
+        } else {
+            gemm_quantized_reference(rows[s][0].data(), m, q8.view, h1.data());
+        }
+        gemm_f32_reference(m, 80, 96, h1.data(), dense.data(), h2.data());
+        gemm_f32_reference(m, HIDDEN, 80, h2.data(), half_values.data(), out.data());
+        const float diff = test::max_abs_diff(rows[s][3], out);
+        if (!T760_CHECK(diff <= 1e-4f * std::max(1.0f, test::max_abs(out)))) {
+            std::cerr << "  sequence of " << m << " rows: max diff " << diff << std::endl;
+        }
+    }
+    const std::vector<DeviceUtilization> utilization = scheduler.get_utilization();
+    T760_CHECK(utilization.size() == 1 && utilization[0].layers == graph.size());
+
+    std::vector<Tensor*> short_chain = {activations[0][0].get()};
+    bool threw = false;
+    try {
+        plan.add_sequence(graph, short_chain);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    T760_CHECK(threw);
+
+    // plan.1 now takes 90 features where plan.0 produces 96.
+    entries[3].shape = TensorShape{{90, 80}};
+    auto broken = make_model(entries);
+    threw = false;
+    try {
+        PlanGraphBuilder unchained(*broken);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    T760_CHECK(threw);
+}
+
+// Greedy continuation of prompt through generate().
+std::vector<int32_t> decode(Engine& engine, const std::vector<int>& prompt) {
+    OutputOptions options;
+    options.sampling.do_sample = false;
+    const ConversationHandle handle = engine.start_new_conversation();
+    std::vector<int32_t> tokens;
+    StepOutput output;
+    engine.generate(handle, prompt.data(), prompt.size(), output, options);
+    while (tokens.size() < DECODE_TOKENS && output.next_token >= 0) {
+        const int32_t token = output.next_token;
+        tokens.push_back(token);
+        engine.generate(handle, &token, 1, output, options);
+    }
+    engine.end_conversation(handle);
+    return tokens;
+}
+
+void check_engine(DataType projection_type) {
+    test::SyntheticModelSpec spec;
+    spec.layers = 0;
+    spec.plan_layers = 3;
+    spec.hidden_size = HIDDEN;
+    spec.projection_type = projection_type;
+    const std::string model_path = test::temp_path("t760_execution_plan.t760");
+    test::write_synthetic_model(model_path, spec);
+
+    EngineConfig config;
+    config.devices = {{DeviceType::CPU, 0, true}};
+    config.threading.big_threads = 2;
+    config.threading.big_affinity_mask = ~0ull;
+    config.threading.little_threads = 1;
+    config.threading.little_affinity_mask = ~0ull;
+    Engine engine;
+    engine.initialize(config);
+    if (T760_CHECK(engine.load_model(model_path))) {
+        const std::vector<std::vector<int>> prompts = {{2, 17, 301, 44}, {9}, {512, 77, 130, 5, 999, 64, 3}};
+        std::vector<BatchPrompt> batch;
+        std::vector<std::vector<int32_t>> expected;
+        for (const std::vector<int>& prompt : prompts) {
+            expected.push_back(decode(engine, prompt));
+            T760_CHECK(expected.back().size() == DECODE_TOKENS);
+            BatchPrompt batch_prompt{prompt, {}};
+            batch_prompt.params.sampling.do_sample = false;
+            batch_prompt.params.max_new_tokens = DECODE_TOKENS;
+            batch.push_back(batch_prompt);
+        }
+        BatchOptions options;
+        options.seed = 1;
+        const std::vector<BatchCompletion> completions = engine.generate_batch(batch, options);
+        for (size_t i = 0; i < completions.size(); ++i) {
+            T760_CHECK(completions[i].status == GenerationStatus::LENGTH);
+            T760_CHECK(completions[i].tokens == expected[i]);
+        }
+    }
+    engine.shutdown();
+    std::remove(model_path.c_str());
+}
+
+}
+
+int main() {
+    std::mt19937 rng(38);
+    check_plan_device();
+    check_plan_graph(rng);
+    for (DataType projection_type : {DataType::QINT8, DataType::FP32}) {
+        check_engine(projection_type);
+    }
+    return test::finish();
+}
@@ -0,0 +1,80 @@
+#include "support/TestSupport.h"
+#include "t760_engine/core/ThreadPool.h"
+#include "t760_engine/kernels/Gemm.h"
+#include "t760_engine/tensor/Float16.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Runs the packed FP32 and FP16 GEMM of every tier the host supports, on the
+// calling thread and on a pool, against gemm_f32_reference. Shapes cover
+// partial micro-tiles and more than one cache block in every dimension.
+
+using namespace t760;
+using namespace t760::kernels;
+
+namespace {
+
+struct Shape {
+    int64_t m;
+    int64_t n;
+    int64_t k;
+};
+
+constexpr Shape SHAPES[] = {{1, 7, 33}, {5, 640, 640}, {37, 2048, 640}, {128, 96, 1000}, {300, 130, 70}};
+
+void check_tier(IsaLevel isa, const GemmKernelSet& ks, const CpuKernelContext& ctx, const Shape& shape,
+                std::mt19937& rng) {
+    std::vector<float> a(static_cast<size_t>(shape.m * shape.k));
+    std::vector<float> b(static_cast<size_t>(shape.k * shape.n));
+    test::fill_normal(a, rng);
+    test::fill_normal(b, rng);
+    std::vector<float> c(static_cast<size_t>(shape.m * shape.n));
+    std::vector<float> c_ref(c.size());
+
+    gemm_f32(ks, ctx, shape.m, shape.n, shape.k, a.data(), b.data(), c.data());
+    gemm_f32_reference(shape.m, shape.n, shape.k, a.data(), b.data(), c_ref.data());
+    const float f32_diff = test::max_abs_diff(c, c_ref);
+    if (!T760_CHECK(f32_diff <= 1e-5f * std::max(1.0f, test::max_abs(c_ref)))) {
+        std::cerr << "  gemm_f32 " << to_string(isa) << " M=" << shape.m << " N=" << shape.n << " K=" << shape.k
+                  << (ctx.pool ? " pooled" : "") << " max diff " << f32_diff << std::endl;
+    }
+
+    // The reference sees the weights the FP16 path reads.
+    std::vector<uint16_t> b_half(b.size());
+    for (size_t i = 0; i < b.size(); ++i) {
+        b_half[i] = fp32_to_fp16(b[i]);
+        b[i] = fp16_to_fp32(b_half[i]);
+    }
+    gemm_f16(ks, ctx, shape.m, shape.n, shape.k, a.data(), b_half.data(), c.data());
+    gemm_f32_reference(shape.m, shape.n, shape.k, a.data(), b.data(), c_ref.data());
+    // A native FP16 micro-kernel also rounds its products to half precision.
+    const float f16_tolerance = ks.micro_f16 ? 5e-3f : 1e-5f;
+    const float f16_diff = test::max_abs_diff(c, c_ref);
+    if (!T760_CHECK(f16_diff <= f16_tolerance * std::max(1.0f, test::max_abs(c_ref)))) {
+        std::cerr << "  gemm_f16 " << to_string(isa) << " M=" << shape.m << " N=" << shape.n << " K=" << shape.k
+                  << (ctx.pool ? " pooled" : "") << " max diff " << f16_diff << std::endl;
+    }
+}
+
+}
+
+int main() {
+    std::mt19937 rng(29);
+    ThreadPool pool(std::min(4u, test::host_thread_count()), ~0ull);
+    for (IsaLevel isa : test::host_isa_levels()) {
+        const GemmKernelSet* ks = get_gemm_kernel_set(isa);
+        if (!ks) {
+            continue;
+        }
+        std::cout << "Tier " << to_string(isa) << std::endl;
+        for (ThreadPool* p : {static_cast<ThreadPool*>(nullptr), &pool}) {
+            const CpuKernelContext ctx = test::host_kernel_context(p);
+            for (const Shape& shape : SHAPES) {
+                check_tier(isa, *ks, ctx, shape, rng);
+            }
+        }
+    }
+    return test::finish();
+}
@@ -0,0 +1,214 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "support/TestTokenizer.h"
+#include "t760_engine/grammar/Grammar.h"
+#include "t760_engine/grammar/TokenGrammar.h"
+#include "t760_engine/tokenizer/Tokenizer.h"
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Grammar on regexes and JSON schemas: whole-string acceptance and
+// rejection, and viable prefixes. TokenGrammar over the test tokenizer's
+// vocab: every state's mask must be what walking each token's text through
+// the automaton byte by byte allows, CONTROL tokens never included. Then
+// GrammarCursor: stop tokens join the mask only in accepting states, and a
+// match no token extends is finished.
+
+using namespace t760;
+
+namespace {
+
+constexpr const char* WEATHER_SCHEMA = R"({
+  "type": "object",
+  "properties": {
+    "city": {"type": "string", "maxLength": 12},
+    "days": {"type": "integer"},
+    "unit": {"enum": ["celsius", "fahrenheit"]}
+  },
+  "required": ["city", "days"]
+})";
+
+// -1 when text leaves the language.
+int32_t walk(const Grammar& grammar, const std::string& text) {
+    int32_t state = grammar.start_state();
+    for (size_t i = 0; i < text.size() && state >= 0; ++i) {
+        state = grammar.next_state(state, static_cast<uint8_t>(text[i]));
+    }
+    return state;
+}
+
+bool matches(const Grammar& grammar, const std::string& text) {
+    const int32_t state = walk(grammar, text);
+    return state >= 0 && grammar.is_accepting(state);
+}
+
+void check_cases(const Grammar& grammar, const char* source, const std::vector<std::string>& accepted,
+                 const std::vector<std::string>& rejected) {
+    for (const std::string& text : accepted) {
+        if (!T760_CHECK(matches(grammar, text))) {
+            std::cerr << "  " << source << " rejects " << text << std::endl;
+        }
+    }
+    for (const std::string& text : rejected) {
+        if (!T760_CHECK(!matches(grammar, text))) {
+            std::cerr << "  " << source << " accepts " << text << std::endl;
+        }
+    }
+}
+
+void check_regex(const char* source, const std::vector<std::string>& accepted,
+                 const std::vector<std::string>& rejected) {
+    check_cases(Grammar(source, GrammarSyntax::REGEX), source, accepted, rejected);
+}
+
+bool throws(const char* source, GrammarSyntax syntax) {
+    try {
+        Grammar grammar(source, syntax);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void check_regexes() {
+    check_regex("[a-z]+@[a-z]+\\.(com|org)", {"a@b.com", "fox@woods.org"}, {"@b.com", "a@b.net", "A@b.com", "a@b.co"});
+    check_regex("^\\d{2,3}(-\\d{4})?$", {"12", "123", "123-4567"}, {"1", "1234", "12-345", "ab"});
+    check_regex("\"[^\"\\\\]*\"", {"\"\"", "\"the dog\"", "\"h\xC3\xA9llo\""}, {"\"a\"b\"", "\"a\\\"", "\"a"});
+    check_regex("(?:yes|no)( please)?", {"yes", "no please"}, {"yes please please", "maybe", ""});
+    check_regex("a.c", {"abc", "a c", "a\xC3\xA9" "c", "a\xF0\x9F\x99\x82" "c"}, {"ac", "abbc", "a\xC3" "c"});
+    check_regex("\\w+\\s\\W", {"dog .", "x_1\t!"}, {"dog  .", "dog a"});
+    check_regex("x{3}y{1,}z{0,2}", {"xxxy", "xxxyyyzz"}, {"xxy", "xxxzz", "xxxyzzz"});
+
+    // Viable prefixes reach a state; others do not.
+    const Grammar email("[a-z]+@[a-z]+\\.(com|org)", GrammarSyntax::REGEX);
+    T760_CHECK(walk(email, "dog@wo") >= 0 && !email.is_accepting(walk(email, "dog@wo")));
+    T760_CHECK(walk(email, "dog@@") < 0);
+
+    for (const char* bad : {"(ab", "ab)", "a{3,2}", "[z-a]", "*a", "[abc"}) {
+        if (!T760_CHECK(throws(bad, GrammarSyntax::REGEX))) {
+            std::cerr << "  regex " << bad << " compiled" << std::endl;
+        }
+    }
+}
+
+void check_schemas() {
+    check_cases(Grammar(WEATHER_SCHEMA, GrammarSyntax::JSON_SCHEMA), "weather schema",
+                {R"({"city":"Paris","days":3})", R"({"city": "Paris", "days": -3})",
+                 R"({"city":"Paris","days":3,"unit":"celsius"})", R"({"city":"","days":0})"},
+                {R"({"days":3,"city":"Paris"})", R"({"city":"Paris"})", R"({"city":"Paris","days":3.5})",
+                 R"({"city":"Paris","days":03})", R"({"city":"Paris","days":3,"unit":"kelvin"})",
+                 R"({"city":"Paris","days":3,"wind":1})", R"({"city":"Paris and London","days":3})"});
+    check_cases(Grammar(R"({"type": "array", "items": {"type": ["number", "null"]}, "minItems": 1, "maxItems": 3})",
+                        GrammarSyntax::JSON_SCHEMA),
+                "number array", {"[1]", "[1.5, null, -2e3]", "[0,0]"}, {"[]", "[1,2,3,4]", "[true]", "[1,]"});
+    check_cases(Grammar(R"({"anyOf": [{"type": "boolean"}, {"const": "auto"}]})", GrammarSyntax::JSON_SCHEMA),
+                "anyOf", {"true", "false", "\"auto\""}, {"\"manual\"", "null", "1"});
+
+    for (const char* bad : {R"({"type": "object")", R"({"type": "tuple"})", R"({"not": {"type": "string"}})"}) {
+        if (!T760_CHECK(throws(bad, GrammarSyntax::JSON_SCHEMA))) {
+            std::cerr << "  schema " << bad << " compiled" << std::endl;
+        }
+    }
+}
+
+// Every state's mask against a scan of each token through the automaton.
+void check_masks(const std::shared_ptr<const Tokenizer>& tokenizer, const char* source, GrammarSyntax syntax) {
+    auto grammar = std::make_shared<const Grammar>(source, syntax);
+    const TokenGrammar token_grammar(grammar, tokenizer);
+    T760_CHECK(token_grammar.vocab_size() == tokenizer->vocab_size());
+    size_t mismatches = 0;
+    size_t allowed_total = 0;
+    for (size_t s = 0; s < grammar->state_count(); ++s) {
+        const auto state = static_cast<int32_t>(s);
+        const TokenMask mask = token_grammar.allowed(state);
+        bool any = false;
+        for (uint32_t t = 0; t < tokenizer->vocab_size(); ++t) {
+            const auto token = static_cast<int32_t>(t);
+            std::string text;
+            tokenizer->append_token_text(token, text);
+            int32_t next = text.empty() ? -1 : state;
+            for (size_t i = 0; i < text.size() && next >= 0; ++i) {
+                next = grammar->next_state(next, static_cast<uint8_t>(text[i]));
+            }
+            const bool expected = next >= 0 && tokenizer->token_type(token) != TokenType::CONTROL;
+            mismatches += mask.allows(token) != expected ? 1 : 0;
+            mismatches += token_grammar.next_state(state, token) != next ? 1 : 0;
+            any = any || expected;
+            allowed_total += expected ? 1 : 0;
+        }
+        mismatches += token_grammar.can_continue(state) != any ? 1 : 0;
+    }
+    if (!T760_CHECK(mismatches == 0)) {
+        std::cerr << "  " << source << ": " << mismatches << " mask mismatches" << std::endl;
+    }
+    T760_CHECK(allowed_total > 0);
+}
+
+std::vector<int> encode(const Tokenizer& tokenizer, const std::string& text) {
+    std::vector<int> ids;
+    tokenizer.encode(text, false, ids);
+    return ids;
+}
+
+void check_cursor(const std::shared_ptr<const Tokenizer>& tokenizer) {
+    auto grammar = std::make_shared<const Grammar>("(yes|no)( please)?", GrammarSyntax::REGEX);
+    auto token_grammar = std::make_shared<const TokenGrammar>(grammar, tokenizer);
+    const int32_t eos = tokenizer->eos_id();
+
+    GrammarCursor cursor(token_grammar, {eos});
+    T760_CHECK(!cursor.allowed().allows(eos));
+    T760_CHECK(!cursor.advance(eos)); // Not a match yet
+    const std::vector<int> maybe = encode(*tokenizer, "maybe");
+    T760_CHECK(!cursor.advance(maybe[0]));
+    for (int token : encode(*tokenizer, "yes")) {
+        T760_CHECK(cursor.allowed().allows(token));
+        T760_CHECK(cursor.advance(token));
+    }
+    // "yes" is a match " please" can extend.
+    T760_CHECK(cursor.allowed().allows(eos));
+    T760_CHECK(!cursor.is_finished());
+    T760_CHECK(cursor.advance(eos));
+
+    GrammarCursor polite(token_grammar, {eos});
+    for (int token : encode(*tokenizer, "no please")) {
+        T760_CHECK(polite.advance(token));
+    }
+    T760_CHECK(polite.is_finished());
+    const TokenMask finished = polite.allowed();
+    T760_CHECK(finished.allows(eos));
+    for (int32_t t = 0; t < static_cast<int32_t>(tokenizer->vocab_size()); ++t) {
+        if (t != eos && !T760_CHECK(!finished.allows(t))) {
+            break;
+        }
+    }
+
+    // Without stop tokens an accepting state's mask is the grammar's own.
+    GrammarCursor plain(token_grammar, {});
+    for (int token : encode(*tokenizer, "yes")) {
+        plain.advance(token);
+    }
+    T760_CHECK(!plain.allowed().allows(eos));
+}
+
+}
+
+int main() {
+    check_regexes();
+    check_schemas();
+
+    const std::string path = test::temp_path("t760_grammar.t760tok");
+    test::write_test_tokenizer(path);
+    {
+        auto tokenizer = std::make_shared<const Tokenizer>(path);
+        check_masks(tokenizer, WEATHER_SCHEMA, GrammarSyntax::JSON_SCHEMA);
+        check_masks(tokenizer, "[a-z]+@[a-z]+\\.(com|org)", GrammarSyntax::REGEX);
+        check_masks(tokenizer, "\"[^\"\\\\]*\"", GrammarSyntax::REGEX); // Byte tokens continue characters
+        check_cursor(tokenizer);
+    }
+    std::remove(path.c_str());
+    return test::finish();
+}
@@ -0,0 +1,181 @@
+#include "support/TestSupport.h"
+#include "t760_engine/kernels/HalfMatmul.h"
+#include "t760_engine/tensor/Float16.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Runs the FP16 and BF16 matmul of every tier the host supports against
+// gemm_half_reference: GEMV, GEMM through the per-row GEMV (up to eight
+// rows) and through the panel kernel, and a row range written at an offset
+// with a wider leading dimension. Tiers with a BF16 dot product round the
+// activations to BF16 first, so on BF16 weights their GEMV is compared with
+// the reference on rounded activations. The widening conversions must match
+// the portable ones bit for bit.
+
+using namespace t760;
+using namespace t760::kernels;
+
+namespace {
+
+struct Shape {
+    int64_t n;
+    int64_t k;
+};
+
+// Odd row counts and columns leave remainders after every tier's blocking;
+// the panel kernels need whole quantization groups, so odd K only runs the
+// GEMV paths.
+constexpr Shape SHAPES[] = {{1, 64}, {7, 100}, {37, 640}, {256, 640}, {640, 2048}, {5, 33}};
+constexpr int64_t GEMM_ROWS[] = {1, 2, 5, 8, 9, 17};
+
+bool rounds_activations_to_bf16(IsaLevel isa) {
+    return isa == IsaLevel::AVX512_BF16 || isa == IsaLevel::NEON_BF16;
+}
+
+struct HalfMatrix {
+    std::vector<uint16_t> data;
+    HalfMatrixView view;
+};
+
+// Normal weights scaled by 1 / sqrt(k), so outputs stay near unit size.
+HalfMatrix make_half_matrix(DataType data_type, const Shape& shape, std::mt19937& rng) {
+    std::vector<float> values(static_cast<size_t>(shape.n * shape.k));
+    test::fill_normal(values, rng, 1.0f / std::sqrt(static_cast<float>(shape.k)));
+    HalfMatrix w;
+    w.data.resize(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        w.data[i] = data_type == DataType::BF16 ? fp32_to_bf16(values[i]) : fp32_to_fp16(values[i]);
+    }
+    w.view = HalfMatrixView{data_type, shape.n, shape.k, w.data.data()};
+    return w;
+}
+
+const char* type_name(DataType data_type) {
+    return data_type == DataType::BF16 ? "bf16" : "f16";
+}
+
+void check_close(const std::vector<float>& c, const std::vector<float>& c_ref, const char* what, IsaLevel isa,
+                 DataType data_type, int64_t m, const Shape& shape) {
+    const float diff = test::max_abs_diff(c, c_ref);
+    if (!T760_CHECK(diff <= 1e-5f * std::max(1.0f, test::max_abs(c_ref)))) {
+        std::cerr << "  " << what << " " << type_name(data_type) << " " << to_string(isa) << " M=" << m
+                  << " N=" << shape.n << " K=" << shape.k << " max diff " << diff << std::endl;
+    }
+}
+
+void check_conversions(IsaLevel isa, const HalfKernelSet& ks, std::mt19937& rng) {
+    std::vector<uint16_t> bits(1000);
+    for (uint16_t& b : bits) {
+        b = static_cast<uint16_t>(rng());
+    }
+    std::vector<float> out(bits.size());
+    std::vector<float> expected(bits.size());
+    const auto same_bits = [&] {
+        for (size_t i = 0; i < out.size(); ++i) {
+            // NaN payloads may differ; only NaN-ness has to match.
+            if (std::isnan(expected[i]) ? !std::isnan(out[i]) : out[i] != expected[i]) {
+                return false;
+            }
+        }
+        return true;
+    };
+    ks.f16_to_f32(bits.data(), out.data(), static_cast<int64_t>(bits.size()));
+    std::transform(bits.begin(), bits.end(), expected.begin(), fp16_to_fp32);
+    if (!T760_CHECK(same_bits())) {
+        std::cerr << "  f16_to_f32 " << to_string(isa) << std::endl;
+    }
+    ks.bf16_to_f32(bits.data(), out.data(), static_cast<int64_t>(bits.size()));
+    std::transform(bits.begin(), bits.end(), expected.begin(), bf16_to_fp32);
+    if (!T760_CHECK(same_bits())) {
+        std::cerr << "  bf16_to_f32 " << to_string(isa) << std::endl;
+    }
+}
+
+void check_tier(IsaLevel isa, const HalfKernelSet& ks, DataType data_type, const Shape& shape, std::mt19937& rng) {
+    const HalfMatrix w = make_half_matrix(data_type, shape, rng);
+    // The activations a BF16 dot product sees.
+    const bool rounded = data_type == DataType::BF16 && rounds_activations_to_bf16(isa);
+    const auto as_seen = [&](std::vector<float> a) {
+        if (rounded) {
+            for (float& v : a) {
+                v = bf16_to_fp32(fp32_to_bf16(v));
+            }
+        }
+        return a;
+    };
+
+    std::vector<float> x(static_cast<size_t>(shape.k));
+    test::fill_normal(x, rng);
+    std::vector<float> y(static_cast<size_t>(shape.n));
+    std::vector<float> y_ref(y.size());
+    gemv_half(ks, x.data(), w.view, y.data());
+    gemm_half_reference(as_seen(x).data(), 1, w.view, y_ref.data());
+    check_close(y, y_ref, "gemv", isa, data_type, 1, shape);
+
+    for (int64_t m : GEMM_ROWS) {
+        const bool panel = m > 8;
+        if (panel && shape.k % constants::QUANT_GROUP_SIZE != 0) {
+            continue;
+        }
+        std::vector<float> a(static_cast<size_t>(m * shape.k));
+        test::fill_normal(a, rng);
+        std::vector<float> c(static_cast<size_t>(m * shape.n));
+        std::vector<float> c_ref(c.size());
+        gemm_half(ks, a.data(), m, w.view, c.data());
+        // The panel kernel widens the weights and keeps the activations.
+        gemm_half_reference(panel ? a.data() : as_seen(a).data(), m, w.view, c_ref.data());
+        check_close(c, c_ref, "gemm", isa, data_type, m, shape);
+
+        // Up to eight rows, each output row is the GEMV of that row.
+        if (!panel) {
+            bool same = true;
+            for (int64_t i = 0; i < m; ++i) {
+                gemv_half(ks, a.data() + i * shape.k, w.view, y.data());
+                same = same && std::equal(y.begin(), y.end(), c.begin() + i * shape.n);
+            }
+            T760_CHECK(same);
+        }
+
+        // Rows [begin, end) into a wider output, its other columns untouched.
+        const int64_t begin = shape.n / 3;
+        const int64_t end = shape.n - shape.n / 4;
+        const int64_t ldc = end - begin + 3;
+        std::vector<float> slice(static_cast<size_t>(m * ldc), -7.0f);
+        gemm_half_rows(ks, a.data(), m, w.view, begin, end, slice.data(), ldc);
+        bool matches = true;
+        for (int64_t i = 0; i < m; ++i) {
+            for (int64_t j = 0; j < ldc; ++j) {
+                const float v = slice[static_cast<size_t>(i * ldc + j)];
+                matches = matches && (j < end - begin ? v == c[static_cast<size_t>(i * shape.n + begin + j)]
+                                                      : v == -7.0f);
+            }
+        }
+        if (!T760_CHECK(matches)) {
+            std::cerr << "  gemm rows " << type_name(data_type) << " " << to_string(isa) << " M=" << m
+                      << " N=" << shape.n << " K=" << shape.k << std::endl;
+        }
+    }
+}
+
+}
+
+int main() {
+    std::mt19937 rng(35);
+    for (IsaLevel isa : test::host_isa_levels()) {
+        const HalfKernelSet* ks = get_half_kernel_set(isa);
+        if (!ks) {
+            continue;
+        }
+        std::cout << "Tier " << to_string(isa) << std::endl;
+        check_conversions(isa, *ks, rng);
+        for (DataType data_type : {DataType::FP16, DataType::BF16}) {
+            for (const Shape& shape : SHAPES) {
+                check_tier(isa, *ks, data_type, shape, rng);
+            }
+        }
+    }
+    return test::finish();
+}
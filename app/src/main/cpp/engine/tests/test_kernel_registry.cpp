@@ -0,0 +1,181 @@
+#include "support/TestSupport.h"
+#include "t760_engine/kernels/KernelRegistry.h"
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// KernelRegistry on hand-built CpuCapabilities rather than the host's:
+// resolve() must hand out the highest tier the capabilities support,
+// whatever order the tiers were registered in, and tiers they do not
+// support, including those missing only one required feature, must be
+// dropped at registration so that they never win. Keys resolve
+// independently, and the builtin kernels follow the same rules.
+
+using namespace t760;
+
+namespace {
+
+// A distinct function per tier, so resolve() can be checked by pointer.
+template <IsaLevel Isa>
+void kernel(const std::vector<Tensor*>&, const std::vector<Tensor*>&, const CpuKernelContext&) {}
+
+struct Tier {
+    IsaLevel isa;
+    CpuKernelFn fn;
+};
+
+constexpr Tier X86_TIERS[] = {{IsaLevel::SCALAR, kernel<IsaLevel::SCALAR>},
+                              {IsaLevel::SSE41, kernel<IsaLevel::SSE41>},
+                              {IsaLevel::AVX2, kernel<IsaLevel::AVX2>},
+                              {IsaLevel::AVX512, kernel<IsaLevel::AVX512>},
+                              {IsaLevel::AVX512_VNNI, kernel<IsaLevel::AVX512_VNNI>},
+                              {IsaLevel::AVX512_BF16, kernel<IsaLevel::AVX512_BF16>}};
+constexpr Tier ARM_TIERS[] = {{IsaLevel::SCALAR, kernel<IsaLevel::SCALAR>},
+                              {IsaLevel::NEON, kernel<IsaLevel::NEON>},
+                              {IsaLevel::NEON_FP16, kernel<IsaLevel::NEON_FP16>},
+                              {IsaLevel::NEON_DOTPROD, kernel<IsaLevel::NEON_DOTPROD>},
+                              {IsaLevel::NEON_I8MM, kernel<IsaLevel::NEON_I8MM>},
+                              {IsaLevel::NEON_BF16, kernel<IsaLevel::NEON_BF16>}};
+
+CpuCapabilities x86_avx2() {
+    CpuCapabilities caps;
+    caps.has_sse41 = true;
+    caps.has_avx2 = true;
+    caps.has_fma = true;
+    caps.has_f16c = true;
+    return caps;
+}
+
+CpuCapabilities arm_dotprod() {
+    CpuCapabilities caps;
+    caps.has_neon_support = true;
+    caps.has_fp16_arithmetic = true;
+    caps.has_dotprod = true;
+    return caps;
+}
+
+// Registers tiers for MATMUL FP16 in the given order and returns the tier
+// resolve() picks, or nullptr.
+const KernelEntry* register_and_resolve(KernelRegistry& registry, std::vector<Tier> tiers) {
+    for (const Tier& tier : tiers) {
+        registry.register_kernel(KernelOp::MATMUL, DataType::FP16, TensorLayout::DENSE, tier.isa, to_string(tier.isa),
+                                 tier.fn);
+    }
+    return registry.resolve(KernelOp::MATMUL, DataType::FP16, TensorLayout::DENSE);
+}
+
+// The highest tier of tiers that caps supports must win in any
+// registration order.
+void check_highest(const CpuCapabilities& caps, const std::vector<Tier>& tiers, IsaLevel expected,
+                   const char* what) {
+    const auto tier = std::find_if(tiers.begin(), tiers.end(), [&](const Tier& t) { return t.isa == expected; });
+    std::vector<Tier> order = tiers;
+    for (int round = 0; round < 3; ++round) {
+        if (round == 1) {
+            std::reverse(order.begin(), order.end());
+        } else if (round == 2) {
+            std::rotate(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(order.size() / 2), order.end());
+        }
+        KernelRegistry registry(caps);
+        const KernelEntry* entry = register_and_resolve(registry, order);
+        const bool picked = entry && entry->isa == expected && entry->fn == tier->fn &&
+                            std::strcmp(entry->name, to_string(expected)) == 0;
+        if (!T760_CHECK(picked)) {
+            std::cerr << "  " << what << ", order " << round << ": got "
+                      << (entry ? to_string(entry->isa) : "nothing") << ", expected " << to_string(expected)
+                      << std::endl;
+        }
+    }
+}
+
+void check_resolve() {
+    const std::vector<Tier> x86(std::begin(X86_TIERS), std::end(X86_TIERS));
+    const std::vector<Tier> arm(std::begin(ARM_TIERS), std::end(ARM_TIERS));
+
+    check_highest(CpuCapabilities{}, x86, IsaLevel::SCALAR, "no features");
+    check_highest(CpuCapabilities{}, arm, IsaLevel::SCALAR, "no features");
+    check_highest(x86_avx2(), x86, IsaLevel::AVX2, "avx2");
+    check_highest(arm_dotprod(), arm, IsaLevel::NEON_DOTPROD, "neon dotprod");
+
+    // AVX2 without FMA or F16C, and AVX512-BF16 without the AVX2 chain,
+    // do not count.
+    CpuCapabilities no_fma = x86_avx2();
+    no_fma.has_fma = false;
+    check_highest(no_fma, x86, IsaLevel::SSE41, "avx2 without fma");
+    CpuCapabilities no_f16c = x86_avx2();
+    no_f16c.has_f16c = false;
+    no_f16c.has_avx512 = true;
+    no_f16c.has_avx512_bf16 = true;
+    check_highest(no_f16c, x86, IsaLevel::AVX512, "avx512-bf16 without f16c");
+    CpuCapabilities full = x86_avx2();
+    full.has_avx512 = true;
+    full.has_avx512_vnni = true;
+    full.has_avx512_bf16 = true;
+    check_highest(full, x86, IsaLevel::AVX512_BF16, "every x86 feature");
+
+    // ARM extensions without NEON itself.
+    CpuCapabilities no_neon = arm_dotprod();
+    no_neon.has_neon_support = false;
+    no_neon.has_i8mm = true;
+    check_highest(no_neon, arm, IsaLevel::SCALAR, "extensions without neon");
+
+    // Only unsupported tiers registered: nothing resolves, rather than a
+    // kernel that would fault.
+    KernelRegistry registry(x86_avx2());
+    T760_CHECK(register_and_resolve(registry, {X86_TIERS[3], X86_TIERS[5], ARM_TIERS[1]}) == nullptr);
+    // A null function is dropped too.
+    T760_CHECK(register_and_resolve(registry, {{IsaLevel::AVX2, nullptr}}) == nullptr);
+    // A later, lower tier does not displace the winner.
+    registry.register_kernel(KernelOp::MATMUL, DataType::FP16, TensorLayout::DENSE, IsaLevel::AVX2, "avx2",
+                             kernel<IsaLevel::AVX2>);
+    registry.register_kernel(KernelOp::MATMUL, DataType::FP16, TensorLayout::DENSE, IsaLevel::SCALAR, "scalar",
+                             kernel<IsaLevel::SCALAR>);
+    const KernelEntry* entry = registry.resolve(KernelOp::MATMUL, DataType::FP16, TensorLayout::DENSE);
+    T760_CHECK(entry && entry->isa == IsaLevel::AVX2 && entry->fn == kernel<IsaLevel::AVX2>);
+
+    // Other keys are untouched by it.
+    T760_CHECK(registry.resolve(KernelOp::MATMUL, DataType::FP32, TensorLayout::DENSE) == nullptr);
+    T760_CHECK(registry.resolve(KernelOp::MATMUL, DataType::FP16, TensorLayout::PACKED_NPU) == nullptr);
+    registry.register_kernel(KernelOp::MATMUL, DataType::FP32, TensorLayout::DENSE, IsaLevel::SCALAR, "scalar",
+                             kernel<IsaLevel::SCALAR>);
+    entry = registry.resolve(KernelOp::MATMUL, DataType::FP32, TensorLayout::DENSE);
+    T760_CHECK(entry && entry->isa == IsaLevel::SCALAR && entry->key.data_type == DataType::FP32);
+    entry = registry.resolve(KernelOp::MATMUL, DataType::FP16, TensorLayout::DENSE);
+    T760_CHECK(entry && entry->isa == IsaLevel::AVX2);
+}
+
+// The builtin quantized matmul resolves to the best compiled tier caps
+// supports, and to scalar without features.
+void check_builtin() {
+    KernelRegistry scalar_only(CpuCapabilities{});
+    register_builtin_cpu_kernels(scalar_only);
+    for (DataType dtype : {DataType::FP32, DataType::FP16, DataType::QINT8, DataType::QINT4}) {
+        const KernelEntry* entry = scalar_only.resolve(KernelOp::MATMUL, dtype, TensorLayout::DENSE);
+        T760_CHECK(entry && entry->isa == IsaLevel::SCALAR);
+    }
+
+    for (const CpuCapabilities& caps : {x86_avx2(), arm_dotprod()}) {
+        IsaLevel expected = IsaLevel::SCALAR;
+        for (IsaLevel isa : {IsaLevel::NEON, IsaLevel::NEON_DOTPROD, IsaLevel::SSE41, IsaLevel::AVX2}) {
+            if (kernels::get_quantized_kernel_set(isa) && is_isa_supported(isa, caps)) {
+                expected = isa;
+            }
+        }
+        KernelRegistry registry(caps);
+        register_builtin_cpu_kernels(registry);
+        for (DataType dtype : {DataType::QINT8, DataType::QINT4}) {
+            const KernelEntry* entry = registry.resolve(KernelOp::MATMUL, dtype, TensorLayout::DENSE);
+            T760_CHECK(entry && entry->isa == expected);
+        }
+    }
+}
+
+}
+
+int main() {
+    check_resolve();
+    check_builtin();
+    return test::finish();
+}
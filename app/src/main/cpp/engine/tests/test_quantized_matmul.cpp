@@ -0,0 +1,87 @@
+#include "support/TestSupport.h"
+#include "t760_engine/kernels/QuantizedMatmul.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Runs every quantized kernel tier the host supports over QINT8 and QINT4
+// weights and compares it with the scalar references: GEMV and the W8A8 GEMM
+// rows must match bit for bit, the FP32-activation GEMM to rounding.
+
+using namespace t760;
+using namespace t760::kernels;
+
+namespace {
+
+struct Shape {
+    int64_t n;
+    int64_t k;
+};
+
+// Odd row counts leave a remainder after every tier's row blocking.
+constexpr Shape SHAPES[] = {{1, 64}, {7, 128}, {37, 640}, {256, 640}, {640, 2048}};
+constexpr int64_t GEMM_ROWS[] = {1, 2, 5, 8, 17};
+
+void check_tier(IsaLevel isa, const QuantizedKernelSet& ks, DataType data_type, const Shape& shape,
+                std::mt19937& rng) {
+    const test::QuantizedMatrix w = test::make_quantized_matrix(data_type, shape.n, shape.k, rng);
+
+    std::vector<float> x(static_cast<size_t>(shape.k));
+    test::fill_normal(x, rng);
+    std::vector<float> y(static_cast<size_t>(shape.n));
+    std::vector<float> y_ref(y.size());
+    gemv_quantized(ks, x.data(), w.view, y.data());
+    gemv_quantized_reference(x.data(), w.view, y_ref.data());
+    if (!T760_CHECK(y == y_ref)) {
+        std::cerr << "  gemv " << to_string(isa) << " N=" << shape.n << " K=" << shape.k
+                  << " max diff " << test::max_abs_diff(y, y_ref) << std::endl;
+    }
+
+    for (int64_t m : GEMM_ROWS) {
+        std::vector<float> a(static_cast<size_t>(m * shape.k));
+        test::fill_normal(a, rng);
+        std::vector<float> c(static_cast<size_t>(m * shape.n));
+        std::vector<float> c_ref(c.size());
+        gemm_quantized(ks, a.data(), m, w.view, c.data());
+        gemm_quantized_reference(a.data(), m, w.view, c_ref.data());
+        const float tolerance = 1e-5f * std::max(1.0f, test::max_abs(c_ref));
+        if (!T760_CHECK(test::max_abs_diff(c, c_ref) <= tolerance)) {
+            std::cerr << "  gemm " << to_string(isa) << " M=" << m << " N=" << shape.n << " K=" << shape.k
+                      << " max diff " << test::max_abs_diff(c, c_ref) << std::endl;
+        }
+
+        // Row i of the W8A8 GEMM is the GEMV of row i.
+        const int64_t groups = shape.k / constants::QUANT_GROUP_SIZE;
+        std::vector<int8_t> aq(a.size());
+        std::vector<float> as(static_cast<size_t>(m * groups));
+        quantize_rows_q8(a.data(), m, shape.k, aq.data(), as.data());
+        gemm_quantized_rows_int8(ks, aq.data(), as.data(), m, w.view, 0, shape.n, c.data(), shape.n);
+        for (int64_t i = 0; i < m; ++i) {
+            gemv_quantized_reference(a.data() + i * shape.k, w.view, c_ref.data() + i * shape.n);
+        }
+        if (!T760_CHECK(c == c_ref)) {
+            std::cerr << "  gemm int8 " << to_string(isa) << " M=" << m << " N=" << shape.n << " K=" << shape.k
+                      << " max diff " << test::max_abs_diff(c, c_ref) << std::endl;
+        }
+    }
+}
+
+}
+
+int main() {
+    std::mt19937 rng(26);
+    for (IsaLevel isa : test::host_isa_levels()) {
+        const QuantizedKernelSet* ks = get_quantized_kernel_set(isa);
+        if (!ks) {
+            continue;
+        }
+        std::cout << "Tier " << to_string(isa) << std::endl;
+        for (DataType data_type : {DataType::QINT8, DataType::QINT4}) {
+            for (const Shape& shape : SHAPES) {
+                check_tier(isa, *ks, data_type, shape, rng);
+            }
+        }
+    }
+    return test::finish();
+}
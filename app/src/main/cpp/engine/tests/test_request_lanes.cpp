@@ -0,0 +1,154 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "t760_engine/core/Engine.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Scheduling between and within the priority lanes, through the order in
+// which concurrent generate() calls return. A background prompt halfway
+// through its prefill must pause for an interactive one that arrives, and
+// so return after it; once the background call is past its deadline it no
+// longer pauses and, having less left to do, returns first. Within a lane,
+// prompts queued behind a running one go earliest deadline first: with room
+// for one chunk per step, they return in deadline order whatever order they
+// arrived in. Both lanes run at the same nice value, so only the scheduler
+// orders them.
+
+using namespace t760;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+constexpr size_t LONG_PROMPT_TOKENS = 1536;
+constexpr size_t EDF_PROMPT_TOKENS = 768;
+constexpr uint32_t EDF_DEADLINES_MS[] = {30000, 20000, 10000}; // In arrival order
+constexpr uint32_t CHUNK_TOKENS = 32;
+
+std::vector<int> make_prompt(size_t length, int salt) {
+    std::vector<int> prompt(length);
+    for (size_t i = 0; i < prompt.size(); ++i) {
+        prompt[i] = static_cast<int>((i * 131 + static_cast<size_t>(salt) * 17) % 1024);
+    }
+    return prompt;
+}
+
+// Prefills prompt on a new conversation; returns how long it took.
+clock_type::duration prefill(Engine& engine, const ConversationOptions& conversation, const std::vector<int>& prompt) {
+    const ConversationHandle handle = engine.start_new_conversation(conversation);
+    StepOutput output;
+    const auto t0 = clock_type::now();
+    engine.generate(handle, prompt.data(), prompt.size(), output, OutputOptions{});
+    const auto elapsed = clock_type::now() - t0;
+    engine.end_conversation(handle);
+    return elapsed;
+}
+
+// Completion order of concurrent calls.
+struct Finishes {
+    std::mutex mutex;
+    std::vector<int> order;
+
+    void add(int id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(id);
+    }
+};
+
+// Starts a background prefill, and an interactive one halfway through it.
+// Returns which finished first: 0 background, 1 interactive.
+int race(Engine& engine, uint32_t background_deadline_ms, clock_type::duration background_time) {
+    const std::vector<int> prompt = make_prompt(LONG_PROMPT_TOKENS, 1);
+    Finishes finishes;
+    std::thread background([&] {
+        prefill(engine, ConversationOptions{RequestPriority::BACKGROUND, background_deadline_ms, 0}, prompt);
+        finishes.add(0);
+    });
+    std::this_thread::sleep_for(background_time / 2);
+    prefill(engine, ConversationOptions{}, make_prompt(LONG_PROMPT_TOKENS, 2));
+    finishes.add(1);
+    background.join();
+    return finishes.order.front();
+}
+
+void check_yield(Engine& engine) {
+    // Warm-up, then the background prefill alone.
+    const std::vector<int> prompt = make_prompt(LONG_PROMPT_TOKENS, 1);
+    prefill(engine, ConversationOptions{RequestPriority::BACKGROUND, 0, 0}, prompt);
+    const clock_type::duration background_time =
+        prefill(engine, ConversationOptions{RequestPriority::BACKGROUND, 0, 0}, prompt);
+
+    if (!T760_CHECK(race(engine, 0, background_time) == 1)) {
+        std::cerr << "  the background prefill did not yield to the interactive one" << std::endl;
+    }
+    if (!T760_CHECK(race(engine, 1, background_time) == 0)) {
+        std::cerr << "  the background prefill yielded past its deadline" << std::endl;
+    }
+    T760_CHECK(engine.get_latency_stats(RequestPriority::BACKGROUND).deadline_misses >= 1);
+}
+
+void check_edf(Engine& engine) {
+    // Keeps the lane busy while the others queue; no deadline, so it goes last.
+    std::thread blocker([&] { prefill(engine, ConversationOptions{}, make_prompt(LONG_PROMPT_TOKENS, 3)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    Finishes finishes;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < std::size(EDF_DEADLINES_MS); ++i) {
+        threads.emplace_back([&, i] {
+            const ConversationOptions conversation{RequestPriority::INTERACTIVE, EDF_DEADLINES_MS[i], 0};
+            prefill(engine, conversation, make_prompt(EDF_PROMPT_TOKENS, 4 + static_cast<int>(i)));
+            finishes.add(static_cast<int>(i));
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    blocker.join();
+    if (!T760_CHECK((finishes.order == std::vector<int>{2, 1, 0}))) {
+        std::cerr << "  prompts finished in order";
+        for (int id : finishes.order) {
+            std::cerr << " " << id;
+        }
+        std::cerr << std::endl;
+    }
+    T760_CHECK(engine.get_latency_stats(RequestPriority::INTERACTIVE).deadline_misses == 0);
+}
+
+}
+
+int main() {
+    test::SyntheticModelSpec spec;
+    spec.hidden_size = 256;
+    spec.intermediate_size = 1024;
+    spec.heads = 4;
+    spec.seq_len = 2048;
+    const std::string model_path = test::temp_path("t760_request_lanes.t760");
+    test::write_synthetic_model(model_path, spec);
+
+    EngineConfig config;
+    config.devices = {{DeviceType::CPU, 0, true}};
+    config.threading.big_threads = 2;
+    config.threading.big_affinity_mask = ~0ull;
+    config.threading.little_threads = 1;
+    config.threading.little_affinity_mask = ~0ull;
+    config.threading.little_nice = 0;
+    config.max_concurrent_conversations = 4;
+    config.prefill_chunk_tokens = CHUNK_TOKENS;
+    config.step_token_budget = CHUNK_TOKENS; // One prompt chunk per step
+    Engine engine;
+    engine.initialize(config);
+    if (T760_CHECK(engine.load_model(model_path))) {
+        check_yield(engine);
+        check_edf(engine);
+    }
+    engine.shutdown();
+    std::remove(model_path.c_str());
+    return test::finish();
+}
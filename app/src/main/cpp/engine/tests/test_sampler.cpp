@@ -0,0 +1,308 @@
+#include "support/TestSupport.h"
+#include "t760_engine/kernels/Sampling.h"
+#include "t760_engine/pipeline/Sampler.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+// TokenHistory against a std::map through enough adds and removes to grow
+// and rebuild its table. Then whole-row sampling on every sampling tier the
+// host supports, against a reference that penalizes and sorts the whole
+// row: fetching candidates_for_penalties before penalizing must give the
+// exact penalized top_k even when the history holds the row's best tokens;
+// the heap path (small top_k) must sample what sample_from_candidates does
+// on the reference, token for token; the quickselect path (top_k past the
+// heap's limit) must pick the reference's best when greedy and sample from
+// its distribution otherwise. A seed fixes every path's draws, one rng
+// output per token.
+
+using namespace t760;
+using namespace t760::kernels;
+
+namespace {
+
+constexpr int64_t VOCAB = 8192;
+constexpr uint32_t HEAP_TOP_K = 40;
+constexpr uint32_t QUICKSELECT_TOP_K = 4096; // Past Sampler.cpp's HEAP_SELECT_MAX
+constexpr size_t REPEATED_BEST = 300;
+constexpr int DRAWS = 4000;
+
+// TokenHistory's contents, kept the obvious way.
+struct ReferenceHistory {
+    std::map<int32_t, uint32_t> counts;
+    std::vector<int32_t> order; // First-seen, as entries() keeps it
+
+    void add(int32_t token) {
+        if (counts[token]++ == 0) {
+            order.push_back(token);
+        }
+    }
+    void remove(int32_t token) {
+        const auto it = counts.find(token);
+        if (it != counts.end() && --it->second == 0) {
+            counts.erase(it);
+            order.erase(std::find(order.begin(), order.end(), token));
+        }
+    }
+};
+
+bool same_contents(const TokenHistory& history, const ReferenceHistory& reference) {
+    if (history.distinct() != reference.order.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < reference.order.size(); ++i) {
+        const TokenHistory::Entry& entry = history.entries()[i];
+        if (entry.token != reference.order[i] || entry.count != reference.counts.at(entry.token) ||
+            history.count(entry.token) != entry.count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void check_token_history(std::mt19937& rng) {
+    TokenHistory history;
+    ReferenceHistory reference;
+    T760_CHECK(history.count(5) == 0);
+    history.remove(std::vector<int>{5}.data(), 1); // Nothing to remove from an empty table
+
+    // Token ranges that widen then narrow, so the table grows past a few
+    // thousand entries and removes empty many of them again.
+    bool consistent = true;
+    for (int round = 0; round < 400 && consistent; ++round) {
+        const int range = round < 200 ? 20 * (round + 1) : 20 * (400 - round);
+        std::vector<int> batch(std::uniform_int_distribution<size_t>(1, 64)(rng));
+        for (int& token : batch) {
+            token = std::uniform_int_distribution<int>(-3, range)(rng);
+        }
+        if (round % 3 == 2) {
+            history.remove(batch.data(), batch.size());
+            for (int token : batch) {
+                reference.remove(token);
+            }
+        } else {
+            history.add(batch.data(), batch.size());
+            for (int token : batch) {
+                reference.add(token);
+            }
+        }
+        consistent = same_contents(history, reference);
+        for (int token = -3; consistent && token <= range + 5; ++token) {
+            const auto it = reference.counts.find(token);
+            consistent = history.count(token) == (it == reference.counts.end() ? 0 : it->second);
+        }
+    }
+    T760_CHECK(consistent);
+
+    // Taking every occurrence back leaves it empty, and it fills again.
+    std::vector<int> all;
+    for (const auto& [token, n] : reference.counts) {
+        all.insert(all.end(), n, token);
+    }
+    std::shuffle(all.begin(), all.end(), rng);
+    history.remove(all.data(), all.size());
+    T760_CHECK(history.distinct() == 0 && history.count(all.front()) == 0);
+    history.add(all.data(), all.size());
+    ReferenceHistory refilled;
+    for (int token : all) {
+        refilled.add(token);
+    }
+    T760_CHECK(same_contents(history, refilled));
+
+    history.clear();
+    T760_CHECK(history.distinct() == 0 && history.count(all.front()) == 0);
+    history.reserve(5000);
+    const std::vector<int> tokens = {9, 9, 1 << 30, -7};
+    history.add(tokens.data(), tokens.size());
+    T760_CHECK(history.distinct() == 3 && history.count(9) == 2 && history.count(1 << 30) == 1);
+}
+
+// The row's candidates with the penalties applied, best first.
+std::vector<TokenCandidate> penalized_reference(const std::vector<float>& row, const SamplingParams& params,
+                                                const TokenHistory& history) {
+    std::vector<TokenCandidate> all(row.size());
+    for (size_t i = 0; i < row.size(); ++i) {
+        all[i] = TokenCandidate{static_cast<int32_t>(i), row[i]};
+    }
+    apply_penalties(all, params, history, static_cast<uint32_t>(all.size()));
+    std::sort(all.begin(), all.end(), ranks_before);
+    return all;
+}
+
+bool same_candidates(const std::vector<TokenCandidate>& a, const std::vector<TokenCandidate>& b, size_t count) {
+    if (a.size() < count || b.size() < count) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (a[i].token_id != b[i].token_id || a[i].logit != b[i].logit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void check_penalty_over_fetch(const SamplingKernelSet& ks, const std::vector<float>& row,
+                              const TokenHistory& history, SamplingParams params) {
+    params.top_k = HEAP_TOP_K;
+    const std::vector<TokenCandidate> reference = penalized_reference(row, params, history);
+
+    std::vector<TokenCandidate> candidates;
+    const uint32_t fetch = candidates_for_penalties(params, history);
+    T760_CHECK(fetch == HEAP_TOP_K + history.distinct());
+    top_k_logits(ks, row.data(), VOCAB, fetch, candidates);
+    apply_penalties(candidates, params, history, HEAP_TOP_K);
+    T760_CHECK(candidates.size() == HEAP_TOP_K && same_candidates(candidates, reference, HEAP_TOP_K));
+
+    // The history holds the row's best tokens, so fetching only top_k
+    // would come up short; the over-fetch is what makes the result exact.
+    top_k_logits(ks, row.data(), VOCAB, HEAP_TOP_K, candidates);
+    apply_penalties(candidates, params, history, HEAP_TOP_K);
+    T760_CHECK(!same_candidates(candidates, reference, HEAP_TOP_K));
+
+    SamplingParams unpenalized = params;
+    unpenalized.repetition_penalty = 1.0f;
+    unpenalized.frequency_penalty = 0.0f;
+    T760_CHECK(candidates_for_penalties(unpenalized, history) == HEAP_TOP_K);
+}
+
+// Sampled tokens on the heap path are sample_from_candidates' on the
+// reference's top_k, draw for draw.
+void check_heap_path(const SamplingKernelSet& ks, const std::vector<float>& row, const TokenHistory& history,
+                     SamplingParams params) {
+    params.top_k = HEAP_TOP_K;
+    std::vector<TokenCandidate> reference = penalized_reference(row, params, history);
+    reference.resize(HEAP_TOP_K);
+    std::vector<TokenCandidate> candidates;
+    size_t mismatches = 0;
+    for (uint32_t seed = 0; seed < 500; ++seed) {
+        std::mt19937 rng(seed);
+        std::mt19937 reference_rng(seed);
+        const int32_t token = sample_from_logits(ks, row.data(), VOCAB, params, &history, rng, candidates);
+        mismatches += token != sample_from_candidates(reference, params, reference_rng) ? 1 : 0;
+        mismatches += rng != reference_rng ? 1 : 0;
+    }
+    T760_CHECK(mismatches == 0);
+    T760_CHECK(same_candidates(candidates, reference, HEAP_TOP_K));
+
+    params.do_sample = false;
+    std::mt19937 rng(1);
+    T760_CHECK(sample_from_logits(ks, row.data(), VOCAB, params, &history, rng, candidates) ==
+               reference.front().token_id);
+}
+
+// The quickselect path walks the set in another order than the reference,
+// so its draws differ one by one; their distribution must not.
+void check_quickselect_path(const SamplingKernelSet& ks, const std::vector<float>& row, const TokenHistory& history,
+                            SamplingParams params, const char* name) {
+    params.top_k = QUICKSELECT_TOP_K;
+    std::vector<TokenCandidate> reference = penalized_reference(row, params, history);
+    reference.resize(QUICKSELECT_TOP_K);
+    std::vector<float> probs;
+    candidate_probabilities(reference, params, probs);
+    std::vector<int32_t> rank(static_cast<size_t>(VOCAB), -1); // In the reference, within its top_k
+    for (size_t i = 0; i < reference.size(); ++i) {
+        rank[static_cast<size_t>(reference[i].token_id)] = static_cast<int32_t>(i);
+    }
+
+    std::vector<int> seen(reference.size(), 0);
+    size_t outside = 0; // Past the top_k or top_p cut
+    std::vector<TokenCandidate> candidates;
+    std::mt19937 rng(11);
+    for (int i = 0; i < DRAWS; ++i) {
+        std::mt19937 one_draw = rng;
+        one_draw.discard(1);
+        const int32_t r = rank[static_cast<size_t>(
+            sample_from_logits(ks, row.data(), VOCAB, params, &history, rng, candidates))];
+        if (r < 0 || probs[static_cast<size_t>(r)] == 0.0f) {
+            ++outside;
+        } else {
+            ++seen[static_cast<size_t>(r)];
+        }
+        if (i == 0) {
+            T760_CHECK(candidates.empty() && rng == one_draw);
+        }
+    }
+    // Kolmogorov-Smirnov over the reference's ranks, at a 0.1% false alarm rate.
+    double expected_cdf = 0.0;
+    double sampled_cdf = 0.0;
+    double distance = 0.0;
+    for (size_t i = 0; i < seen.size(); ++i) {
+        expected_cdf += probs[i];
+        sampled_cdf += static_cast<double>(seen[i]) / DRAWS;
+        distance = std::max(distance, std::abs(sampled_cdf - expected_cdf));
+    }
+    if (!T760_CHECK(outside == 0 && distance < 1.95 / std::sqrt(static_cast<double>(DRAWS)))) {
+        std::cerr << "  " << name << ": " << outside << " draws past the cuts, CDF off by " << distance << std::endl;
+    }
+
+    params.do_sample = false;
+    T760_CHECK(sample_from_logits(ks, row.data(), VOCAB, params, &history, rng, candidates) ==
+               reference.front().token_id);
+}
+
+// The same seed gives the same tokens on both paths, and another seed
+// does not.
+void check_seeded(const SamplingKernelSet& ks, const std::vector<float>& row, const TokenHistory& history,
+                  SamplingParams params) {
+    for (uint32_t top_k : {HEAP_TOP_K, QUICKSELECT_TOP_K}) {
+        params.top_k = top_k;
+        std::vector<TokenCandidate> candidates;
+        const auto run = [&](uint32_t seed) {
+            std::mt19937 rng(seed);
+            std::vector<int32_t> tokens;
+            for (int i = 0; i < 100; ++i) {
+                tokens.push_back(sample_from_logits(ks, row.data(), VOCAB, params, &history, rng, candidates));
+            }
+            return tokens;
+        };
+        const std::vector<int32_t> first = run(7);
+        T760_CHECK(run(7) == first);
+        T760_CHECK(run(8) != first);
+    }
+}
+
+}
+
+int main() {
+    std::mt19937 rng(44);
+    check_token_history(rng);
+
+    std::vector<float> row(static_cast<size_t>(VOCAB));
+    test::fill_normal(row, rng, 2.0f);
+    // Repeats of the row's best tokens, so the penalties reorder the top.
+    std::vector<TokenCandidate> sorted(row.size());
+    for (size_t i = 0; i < row.size(); ++i) {
+        sorted[i] = TokenCandidate{static_cast<int32_t>(i), row[i]};
+    }
+    std::partial_sort(sorted.begin(), sorted.begin() + REPEATED_BEST, sorted.end(), ranks_before);
+    std::vector<int> history_tokens;
+    for (size_t i = 0; i < 2 * REPEATED_BEST; ++i) {
+        history_tokens.push_back(sorted[i % REPEATED_BEST].token_id);
+    }
+    TokenHistory history;
+    history.add(history_tokens.data(), history_tokens.size());
+
+    SamplingParams params;
+    params.temperature = 0.7f;
+    params.repetition_penalty = 1.3f;
+    params.frequency_penalty = 0.5f;
+    SamplingParams full_mass = params;
+    full_mass.top_p = 1.0f;
+
+    for (IsaLevel isa : test::host_isa_levels()) {
+        const SamplingKernelSet* ks = get_sampling_kernel_set(isa);
+        if (!ks) {
+            continue;
+        }
+        std::cout << "Tier " << to_string(isa) << std::endl;
+        check_penalty_over_fetch(*ks, row, history, params);
+        check_heap_path(*ks, row, history, params);
+        check_quickselect_path(*ks, row, history, params, "top_p");
+        check_quickselect_path(*ks, row, history, full_mass, "full mass");
+        check_seeded(*ks, row, history, params);
+    }
+    return test::finish();
+}
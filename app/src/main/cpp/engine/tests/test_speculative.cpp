@@ -0,0 +1,325 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "t760_engine/core/Engine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Speculative decoding through Engine::generate_speculative on synthetic
+// models. Over many seeds, the first token of a step, whether an accepted
+// proposal or a replacement, must follow the model's own sampling
+// distribution, computed from its logits; at a top_k past the fused lm_head
+// the step runs plainly. A greedy run with the model as its own draft must
+// keep every proposal, also after stop tokens cut steps short and both
+// conversations roll back: a draft left at the wrong position would stop
+// agreeing. With another draft, proposals get rejected. Either way the
+// tokens, the remaining context and the penalized candidates (the history)
+// must match plain decoding. A check that fails must leave the conversation
+// where it was and drop its draft.
+
+using namespace t760;
+
+namespace {
+
+constexpr uint32_t SEEDS = 400;
+constexpr size_t GREEDY_TOKENS = 24;
+
+const std::vector<int> PROMPT = {2, 17, 301, 44, 9};
+
+EngineConfig make_config() {
+    EngineConfig config;
+    config.devices = {{DeviceType::CPU, 0, true}};
+    config.threading.big_threads = 2;
+    config.threading.big_affinity_mask = ~0ull;
+    config.threading.little_threads = 1;
+    config.threading.little_affinity_mask = ~0ull;
+    return config;
+}
+
+std::string write_model(const std::string& name, const test::SyntheticModelSpec& spec) {
+    const std::string path = test::temp_path(name);
+    test::write_synthetic_model(path, spec);
+    return path;
+}
+
+// The probability sample_from_candidates gives each of the top_k logits.
+std::vector<std::pair<int32_t, double>> distribution(const std::vector<float>& logits, uint32_t top_k,
+                                                     float temperature) {
+    std::vector<std::pair<int32_t, double>> probs;
+    for (size_t i = 0; i < logits.size(); ++i) {
+        probs.emplace_back(static_cast<int32_t>(i), logits[i]);
+    }
+    std::sort(probs.begin(), probs.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    probs.resize(std::min<size_t>(top_k, probs.size()));
+    const double best = probs[0].second;
+    double total = 0.0;
+    for (auto& [token, p] : probs) {
+        p = std::exp((p - best) / temperature);
+        total += p;
+    }
+    for (auto& entry : probs) {
+        entry.second /= total;
+    }
+    return probs;
+}
+
+// The temperature that gives the most likely token about half the mass, so
+// that the draft's proposals are both kept and rejected.
+float pick_temperature(const std::vector<float>& logits, uint32_t top_k) {
+    float low = 1e-3f;
+    float high = 1e3f;
+    for (int i = 0; i < 60; ++i) {
+        const float mid = std::sqrt(low * high);
+        (distribution(logits, top_k, mid)[0].second > 0.5 ? low : high) = mid;
+    }
+    return std::sqrt(low * high);
+}
+
+// First tokens of one speculative step per seed against the model's
+// distribution after the prompt.
+void check_distribution(Engine& engine, uint32_t top_k, bool speculates) {
+    OutputOptions logits_options;
+    logits_options.return_logits = true;
+    const ConversationHandle reference = engine.start_new_conversation();
+    const StepOutput row = engine.generate(reference, PROMPT, logits_options);
+    engine.end_conversation(reference);
+    const auto* data = static_cast<const float*>(row.logits->get_data());
+    const std::vector<float> logits(data, data + row.logits->get_shape().num_elements());
+
+    OutputOptions options;
+    options.sampling.top_k = top_k;
+    options.sampling.top_p = 1.0f;
+    options.sampling.temperature = pick_temperature(logits, top_k);
+    const std::vector<std::pair<int32_t, double>> probs = distribution(logits, top_k, options.sampling.temperature);
+
+    SpeculationOptions speculation;
+    speculation.draft_tokens = 3;
+    std::vector<uint32_t> counts(logits.size());
+    uint64_t drafted = 0;
+    uint64_t accepted = 0;
+    uint32_t rejected = 0;
+    SpeculativeOutput output;
+    for (uint32_t seed = 1; seed <= SEEDS; ++seed) {
+        ConversationOptions conversation;
+        conversation.seed = seed;
+        const ConversationHandle handle = engine.start_new_conversation(conversation);
+        engine.generate_speculative(handle, PROMPT.data(), PROMPT.size(), options, speculation, output);
+        engine.end_conversation(handle);
+        ++counts[static_cast<size_t>(output.tokens[0])];
+        drafted += output.drafted;
+        accepted += output.accepted;
+        rejected += output.accepted < output.drafted ? 1 : 0;
+    }
+    if (speculates) {
+        T760_CHECK(drafted > 0 && accepted > 0 && rejected > 0);
+    } else {
+        T760_CHECK(drafted == 0);
+    }
+    // Every token of some weight within four standard deviations.
+    for (const auto& [token, p] : probs) {
+        if (p < 0.05) {
+            continue;
+        }
+        const double seen = static_cast<double>(counts[static_cast<size_t>(token)]) / SEEDS;
+        if (!T760_CHECK(std::fabs(seen - p) <= 4.0 * std::sqrt(p * (1.0 - p) / SEEDS) + 0.01)) {
+            std::cerr << "  top_k " << top_k << ": token " << token << " drawn " << seen << " of the time, p = " << p
+                      << std::endl;
+        }
+    }
+}
+
+// Greedy tokens after prompt through generate().
+std::vector<int32_t> greedy_decode(Engine& engine, std::vector<int> prompt, size_t tokens) {
+    OutputOptions options;
+    options.sampling.do_sample = false;
+    const ConversationHandle handle = engine.start_new_conversation();
+    std::vector<int32_t> result;
+    StepOutput output;
+    engine.generate(handle, prompt.data(), prompt.size(), output, options);
+    while (result.size() < tokens) {
+        result.push_back(output.next_token);
+        engine.generate(handle, &result.back(), 1, output, options);
+    }
+    engine.end_conversation(handle);
+    return result;
+}
+
+// The candidates of a penalized step on token, which weigh the history.
+std::vector<TokenCandidate> penalized_step(Engine& engine, ConversationHandle handle, int token) {
+    OutputOptions options;
+    options.sampling.do_sample = false;
+    options.sampling.repetition_penalty = 1.5f;
+    options.sampling.frequency_penalty = 0.5f;
+    return engine.generate(handle, std::vector<int>{token}, options).candidates;
+}
+
+bool same_candidates(const std::vector<TokenCandidate>& a, const std::vector<TokenCandidate>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].token_id != b[i].token_id ||
+            std::fabs(a[i].logit - b[i].logit) > 1e-3f * std::max(1.0f, std::fabs(b[i].logit))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Decodes greedily with speculation, stopping on the stop tokens without
+// ending, until GREEDY_TOKENS are out, and compares with plain decoding.
+void check_greedy(Engine& engine, const std::vector<int32_t>& expected, bool same_draft) {
+    OutputOptions options;
+    options.sampling.do_sample = false;
+    SpeculationOptions speculation;
+    speculation.draft_tokens = 4;
+    const std::vector<int32_t> stops = {expected[2], expected[9], expected[15]};
+    speculation.stop_tokens = &stops;
+
+    const ConversationHandle handle = engine.start_new_conversation();
+    const size_t context = engine.remaining_context(handle);
+    std::vector<int32_t> produced;
+    std::vector<int> input = PROMPT;
+    size_t fed = 0;
+    uint32_t cut = 0;
+    uint32_t rejected = 0;
+    SpeculativeOutput output;
+    while (produced.size() < GREEDY_TOKENS) {
+        engine.generate_speculative(handle, input.data(), input.size(), options, speculation, output);
+        fed += input.size();
+        if (!T760_CHECK(!output.tokens.empty())) {
+            break;
+        }
+        if (same_draft) {
+            T760_CHECK(output.accepted == output.drafted);
+        }
+        cut += output.tokens.size() < output.drafted + 1 ? 1 : 0;
+        rejected += output.accepted < output.drafted ? 1 : 0;
+        // Every token but the last has been fed.
+        fed += output.tokens.size() - 1;
+        T760_CHECK(engine.remaining_context(handle) == context - fed);
+        produced.insert(produced.end(), output.tokens.begin(), output.tokens.end());
+        input = {output.tokens.back()};
+    }
+    T760_CHECK(cut > 0);
+    if (!same_draft) {
+        T760_CHECK(rejected > 0);
+    }
+    const std::vector<int32_t> head(produced.begin(), produced.begin() + GREEDY_TOKENS);
+    if (!T760_CHECK(head == std::vector<int32_t>(expected.begin(), expected.begin() + GREEDY_TOKENS))) {
+        std::cerr << "  speculative greedy decoding diverged" << (same_draft ? " (self draft)" : "") << std::endl;
+    }
+
+    // The same tokens fed plainly weigh the same history.
+    std::vector<int> plain_prompt = PROMPT;
+    plain_prompt.insert(plain_prompt.end(), produced.begin(), produced.end() - 1);
+    const ConversationHandle plain = engine.start_new_conversation();
+    engine.generate(plain, plain_prompt, options);
+    T760_CHECK(same_candidates(penalized_step(engine, handle, input[0]), penalized_step(engine, plain, input[0])));
+    engine.end_conversation(plain);
+    engine.end_conversation(handle);
+}
+
+// A draft that embeds a token the model does not: the check fails on it.
+void check_failed_check(Engine& engine) {
+    OutputOptions options;
+    options.sampling.do_sample = false;
+    SpeculationOptions speculation;
+    speculation.draft_tokens = 3;
+    const ConversationHandle handle = engine.start_new_conversation();
+    SpeculativeOutput output;
+    engine.generate_speculative(handle, PROMPT.data(), PROMPT.size(), options, speculation, output);
+    T760_CHECK(output.drafted > 0);
+    const std::vector<int32_t> first = output.tokens;
+    const size_t remaining = engine.remaining_context(handle);
+
+    const int unknown = 1050; // Past the model's embedding, within the draft's
+    bool threw = false;
+    try {
+        engine.generate_speculative(handle, &unknown, 1, options, speculation, output);
+    } catch (const std::exception&) {
+        threw = true;
+    }
+    T760_CHECK(threw);
+    T760_CHECK(engine.remaining_context(handle) == remaining);
+
+    // The conversation goes on plainly from where it was.
+    const int next = first.back();
+    engine.generate_speculative(handle, &next, 1, options, speculation, output);
+    T760_CHECK(output.drafted == 0 && output.tokens.size() == 1);
+    T760_CHECK(engine.remaining_context(handle) == remaining - 1);
+    std::vector<int> prompt = PROMPT;
+    prompt.insert(prompt.end(), first.begin(), first.end());
+    const ConversationHandle plain = engine.start_new_conversation();
+    const StepOutput expected = engine.generate(plain, prompt, options);
+    T760_CHECK(output.tokens[0] == expected.next_token);
+    const int token = output.tokens[0];
+    T760_CHECK(same_candidates(penalized_step(engine, handle, token), penalized_step(engine, plain, token)));
+    engine.end_conversation(plain);
+    engine.end_conversation(handle);
+}
+
+}
+
+int main() {
+    // Untied lm_heads: a tied one mostly repeats the last token, which any
+    // draft guesses.
+    test::SyntheticModelSpec spec;
+    spec.lm_head_rows = spec.vocab_size;
+    spec.projection_type = DataType::FP32;
+    spec.seed = 50;
+    test::SyntheticModelSpec other = spec;
+    other.layers = 1;
+    other.seed = 51;
+    test::SyntheticModelSpec wide_vocab = other;
+    wide_vocab.vocab_size = 1100;
+    wide_vocab.lm_head_rows = spec.vocab_size;
+    test::SyntheticModelSpec large = spec;
+    large.vocab_size = 4096;
+    large.lm_head_rows = large.vocab_size;
+    // The model's first layer alone: close enough to it that its proposals
+    // are both kept and rejected.
+    test::SyntheticModelSpec large_draft = large;
+    large_draft.layers = 1;
+
+    const std::string model_path = write_model("t760_speculative.t760", spec);
+    const std::string draft_path = write_model("t760_speculative_draft.t760", other);
+    const std::string wide_path = write_model("t760_speculative_wide.t760", wide_vocab);
+    const std::string large_path = write_model("t760_speculative_large.t760", large);
+    const std::string large_draft_path = write_model("t760_speculative_large_draft.t760", large_draft);
+
+    {
+        Engine engine;
+        engine.initialize(make_config());
+        if (T760_CHECK(engine.load_model(large_path)) && T760_CHECK(engine.load_draft_model(large_draft_path))) {
+            check_distribution(engine, 64, true);
+            check_distribution(engine, 3000, false); // Past the fused lm_head
+        }
+        engine.shutdown();
+    }
+    {
+        Engine engine;
+        engine.initialize(make_config());
+        if (T760_CHECK(engine.load_model(model_path))) {
+            const std::vector<int32_t> expected = greedy_decode(engine, PROMPT, GREEDY_TOKENS + 8);
+            if (T760_CHECK(engine.load_draft_model(model_path))) {
+                check_greedy(engine, expected, true);
+            }
+            if (T760_CHECK(engine.load_draft_model(draft_path))) {
+                check_greedy(engine, expected, false);
+            }
+            if (T760_CHECK(engine.load_draft_model(wide_path))) {
+                check_failed_check(engine);
+            }
+        }
+        engine.shutdown();
+    }
+    for (const std::string& path : {model_path, draft_path, wide_path, large_path, large_draft_path}) {
+        std::remove(path.c_str());
+    }
+    return test::finish();
+}
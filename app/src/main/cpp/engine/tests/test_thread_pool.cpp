@@ -0,0 +1,197 @@
+#include "support/TestSupport.h"
+#include "t760_engine/core/ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ThreadPool on 1, 2, 4 and 8 threads (oversubscribed on small hosts):
+// parallel_for runs every index exactly once when task costs are uneven
+// enough to force stealing, rethrows a task's exception, and runs nested
+// calls inline; run() starts no TaskGraph node before its predecessors have
+// finished. Last, threads waiting inside run() for a slow node must park
+// rather than spin through it.
+
+using namespace t760;
+
+namespace {
+
+constexpr uint32_t THREAD_COUNTS[] = {1, 2, 4, 8};
+
+// Burns roughly units of work the optimizer cannot drop.
+uint64_t burn(uint64_t units) {
+    volatile uint64_t x = units;
+    for (uint64_t i = 0; i < units * 64; ++i) {
+        x = x * 6364136223846793005ull + 1442695040888963407ull;
+    }
+    return x;
+}
+
+void check_exactly_once(ThreadPool& pool) {
+    for (size_t num_tasks : {size_t{1}, size_t{7}, size_t{1000}, size_t{20000}}) {
+        std::unique_ptr<std::atomic<uint32_t>[]> runs(new std::atomic<uint32_t>[num_tasks]);
+        for (size_t i = 0; i < num_tasks; ++i) {
+            runs[i].store(0);
+        }
+        // The first tenth is 100x the rest, all in thread 0's share.
+        pool.parallel_for(num_tasks, [&](size_t task) {
+            burn(task < num_tasks / 10 ? 100 : 1);
+            runs[task].fetch_add(1);
+        });
+        size_t wrong = 0;
+        for (size_t i = 0; i < num_tasks; ++i) {
+            wrong += runs[i].load() != 1 ? 1 : 0;
+        }
+        if (!T760_CHECK(wrong == 0)) {
+            std::cerr << "  " << pool.get_num_threads() << " threads, " << num_tasks << " tasks: " << wrong
+                      << " indices not run exactly once" << std::endl;
+        }
+    }
+}
+
+void check_exceptions(ThreadPool& pool) {
+    std::atomic<size_t> ran{0};
+    std::string message;
+    try {
+        pool.parallel_for(1000, [&](size_t task) {
+            if (task == 637) {
+                throw std::runtime_error("task 637");
+            }
+            ran.fetch_add(1);
+        });
+    } catch (const std::runtime_error& e) {
+        message = e.what();
+    }
+    T760_CHECK(message == "task 637" && ran.load() < 1000);
+
+    TaskGraph graph;
+    const TaskGraph::NodeId first = graph.add([](size_t) {}, 4);
+    graph.add([](size_t task) {
+        if (task == 2) {
+            throw std::runtime_error("node 1");
+        }
+    }, 8, {first});
+    message.clear();
+    try {
+        pool.run(graph);
+    } catch (const std::runtime_error& e) {
+        message = e.what();
+    }
+    T760_CHECK(message == "node 1");
+
+    // The pool is still usable.
+    ran = 0;
+    pool.parallel_for(100, [&](size_t) { ran.fetch_add(1); });
+    T760_CHECK(ran.load() == 100);
+}
+
+void check_nested(ThreadPool& pool) {
+    constexpr size_t OUTER = 16;
+    constexpr size_t INNER = 50;
+    std::vector<std::atomic<uint32_t>> runs(OUTER * INNER);
+    pool.parallel_for(OUTER, [&](size_t outer) {
+        pool.parallel_for(INNER, [&](size_t inner) {
+            burn(outer % 3 == 0 ? 20 : 1);
+            runs[outer * INNER + inner].fetch_add(1);
+        });
+    });
+    size_t wrong = 0;
+    for (const auto& count : runs) {
+        wrong += count.load() != 1 ? 1 : 0;
+    }
+    T760_CHECK(wrong == 0);
+
+    // A graph run from inside a task runs inline too.
+    std::atomic<size_t> nodes{0};
+    pool.parallel_for(4, [&](size_t) {
+        TaskGraph graph;
+        const TaskGraph::NodeId a = graph.add([&](size_t) { nodes.fetch_add(1); });
+        graph.add([&](size_t) { nodes.fetch_add(1); }, 3, {a});
+        pool.run(graph);
+    });
+    T760_CHECK(nodes.load() == 4 * 4);
+}
+
+// A random DAG: every task checks that each predecessor's tasks have all
+// finished, then counts itself.
+void check_graph(ThreadPool& pool, std::mt19937& rng) {
+    constexpr size_t NODES = 300;
+    std::vector<size_t> num_tasks(NODES);
+    std::vector<std::vector<TaskGraph::NodeId>> predecessors(NODES);
+    std::vector<std::atomic<size_t>> finished(NODES);
+    std::atomic<size_t> violations{0};
+    TaskGraph graph;
+    for (size_t n = 0; n < NODES; ++n) {
+        num_tasks[n] = std::uniform_int_distribution<size_t>(0, 3)(rng) == 0 ? 0 : rng() % 40 + 1;
+        const TaskGraph::NodeId id = graph.add([&, n](size_t) {
+            for (TaskGraph::NodeId before : predecessors[n]) {
+                if (finished[before].load() != num_tasks[before]) {
+                    violations.fetch_add(1);
+                }
+            }
+            burn(n % 2 == 0 ? 1 : 10);
+            finished[n].fetch_add(1);
+        }, num_tasks[n]);
+        const size_t deps = n == 0 ? 0 : rng() % std::min<size_t>(n, 4);
+        for (size_t d = 0; d < deps; ++d) {
+            const TaskGraph::NodeId before = rng() % n;
+            graph.add_dependency(id, before);
+            predecessors[n].push_back(before);
+        }
+    }
+    pool.run(graph);
+    size_t wrong = 0;
+    for (size_t n = 0; n < NODES; ++n) {
+        wrong += finished[n].load() != num_tasks[n] ? 1 : 0;
+    }
+    if (!T760_CHECK(violations.load() == 0 && wrong == 0)) {
+        std::cerr << "  " << pool.get_num_threads() << " threads: " << violations.load() << " early starts, "
+                  << wrong << " nodes with a wrong task count" << std::endl;
+    }
+
+    bool threw = false;
+    try {
+        graph.add_dependency(3, 5);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    T760_CHECK(threw);
+}
+
+// While one thread sleeps through a single-task node, the others have
+// nothing to take; the process must not burn CPU for the whole wait.
+void check_idle_threads_park() {
+    constexpr auto SLEEP = std::chrono::milliseconds(150);
+    ThreadPool pool(4, ~0ull, 0, 50);
+    TaskGraph graph;
+    const TaskGraph::NodeId slow = graph.add([&](size_t) { std::this_thread::sleep_for(SLEEP); });
+    graph.add([](size_t) {}, 8, {slow});
+    pool.run(graph); // Warm up the workers
+    const std::clock_t cpu_start = std::clock();
+    pool.run(graph);
+    const double cpu_ms = 1000.0 * static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    if (!T760_CHECK(cpu_ms < 0.5 * static_cast<double>(SLEEP.count()))) {
+        std::cerr << "  " << cpu_ms << " ms of CPU while waiting " << SLEEP.count() << " ms" << std::endl;
+    }
+}
+
+}
+
+int main() {
+    std::mt19937 rng(37);
+    for (uint32_t threads : THREAD_COUNTS) {
+        ThreadPool pool(threads, ~0ull);
+        check_exactly_once(pool);
+        check_exceptions(pool);
+        check_nested(pool);
+        check_graph(pool, rng);
+    }
+    check_idle_threads_park();
+    return test::finish();
+}
@@ -0,0 +1,240 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "t760_engine/core/Engine.h"
+#include "t760_engine/core/Generation.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// TokenStream between a producer thread and a reader draining it in
+// batches, through a ring small enough to wrap many times; then close(),
+// timeouts and reads after the drain. Then as the JNI bridge uses it:
+// generate_async pushes tokens and closes on done, and the reader must get
+// exactly what a generate() loop samples. Cancelling mid-prefill finishes
+// the prefill, delivers nothing and leaves the conversation where an
+// uncancelled prefill would; cancelling mid-decode stops on a prefix.
+
+using namespace t760;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr int32_t STREAM_TOKENS = 20000;
+constexpr uint32_t NEW_TOKENS = 24;
+constexpr size_t LONG_PROMPT_TOKENS = 1536;
+
+const std::vector<int> PROMPT = {2, 17, 301, 44, 9};
+
+// Reads until the stream reports it is closed and drained.
+std::vector<int32_t> drain(TokenStream& stream, size_t batch) {
+    std::vector<int32_t> tokens;
+    std::vector<int32_t> buffer(batch);
+    while (true) {
+        const int64_t count = stream.read(buffer.data(), buffer.size(), 100ms);
+        if (count < 0) {
+            return tokens;
+        }
+        tokens.insert(tokens.end(), buffer.begin(), buffer.begin() + count);
+    }
+}
+
+void check_stream() {
+    TokenStream stream(5); // Rounded up to 8
+    for (int32_t i = 0; i < 8; ++i) {
+        T760_CHECK(stream.push(i));
+    }
+    T760_CHECK(!stream.push(8));
+    int32_t out[16];
+    T760_CHECK(stream.read(out, 3, 0ms) == 3 && out[0] == 0 && out[2] == 2);
+    T760_CHECK(stream.read(out, 16, 0ms) == 5 && out[4] == 7);
+    const auto t0 = std::chrono::steady_clock::now();
+    T760_CHECK(stream.read(out, 16, 20ms) == 0); // Open and empty: times out
+    T760_CHECK(std::chrono::steady_clock::now() - t0 >= 20ms);
+
+    // A producer that retries when the ring is full; values must arrive in
+    // order across every wrap.
+    std::thread producer([&] {
+        for (int32_t i = 0; i < STREAM_TOKENS; ++i) {
+            while (!stream.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+        stream.close();
+    });
+    const std::vector<int32_t> received = drain(stream, 3);
+    producer.join();
+    bool in_order = received.size() == static_cast<size_t>(STREAM_TOKENS);
+    for (size_t i = 0; in_order && i < received.size(); ++i) {
+        in_order = received[i] == static_cast<int32_t>(i);
+    }
+    T760_CHECK(in_order);
+    T760_CHECK(stream.read(out, 16, 0ms) == -1 && stream.read(out, 16, 10ms) == -1);
+
+    // Tokens pushed before close() are still read, then -1 without waiting.
+    TokenStream closing(4);
+    closing.push(7);
+    closing.push(9);
+    closing.close();
+    T760_CHECK(closing.read(out, 1, 0ms) == 1 && out[0] == 7);
+    T760_CHECK(closing.read(out, 4, 1000ms) == 1 && out[0] == 9);
+    const auto t1 = std::chrono::steady_clock::now();
+    T760_CHECK(closing.read(out, 4, 1000ms) == -1);
+    T760_CHECK(std::chrono::steady_clock::now() - t1 < 500ms);
+
+    // close() wakes a reader parked on an empty stream.
+    TokenStream empty(4);
+    std::thread closer([&] {
+        std::this_thread::sleep_for(20ms);
+        empty.close();
+    });
+    T760_CHECK(empty.read(out, 4, 5000ms) == -1);
+    closer.join();
+}
+
+// generate_async into a stream sized as the JNI bridge sizes it.
+struct StreamedGeneration {
+    std::shared_ptr<TokenStream> stream;
+    std::shared_ptr<GenerationTask> task;
+};
+
+// token_delay slows the producer down, so a reader can cancel before the end.
+StreamedGeneration start(Engine& engine, ConversationHandle handle, std::vector<int> prompt,
+                         std::chrono::milliseconds token_delay = 0ms) {
+    GenerationParams params;
+    params.sampling.do_sample = false;
+    params.max_new_tokens = NEW_TOKENS;
+    StreamedGeneration generation;
+    generation.stream =
+        std::make_shared<TokenStream>(std::min<size_t>(NEW_TOKENS, engine.remaining_context(handle)));
+    auto stream = generation.stream;
+    generation.task = engine.generate_async(
+        handle, std::move(prompt), params,
+        [stream, token_delay](int32_t token) {
+            stream->push(token);
+            std::this_thread::sleep_for(token_delay);
+        },
+        [stream](GenerationStatus) { stream->close(); });
+    return generation;
+}
+
+// Greedy tokens after prompt through generate().
+std::vector<int32_t> reference(Engine& engine, const std::vector<int>& prompt) {
+    OutputOptions options;
+    options.sampling.do_sample = false;
+    const ConversationHandle handle = engine.start_new_conversation();
+    std::vector<int32_t> tokens;
+    StepOutput output;
+    engine.generate(handle, prompt.data(), prompt.size(), output, options);
+    while (tokens.size() < NEW_TOKENS) {
+        const int32_t token = output.next_token;
+        tokens.push_back(token);
+        engine.generate(handle, &token, 1, output, options);
+    }
+    engine.end_conversation(handle);
+    return tokens;
+}
+
+// The greedy token after feeding token to a conversation.
+int32_t next_after(Engine& engine, ConversationHandle handle, int32_t token) {
+    OutputOptions options;
+    options.sampling.do_sample = false;
+    StepOutput output;
+    engine.generate(handle, &token, 1, output, options);
+    return output.next_token;
+}
+
+void check_generation(Engine& engine) {
+    const std::vector<int32_t> expected = reference(engine, PROMPT);
+
+    const ConversationHandle handle = engine.start_new_conversation();
+    StreamedGeneration generation = start(engine, handle, PROMPT);
+    T760_CHECK(drain(*generation.stream, 5) == expected);
+    T760_CHECK(generation.task->wait() == GenerationStatus::LENGTH);
+    T760_CHECK(generation.task->get_token_count() == NEW_TOKENS);
+    int32_t out[4];
+    T760_CHECK(generation.stream->read(out, 4, 0ms) == -1);
+    engine.end_conversation(handle);
+
+    // Cancelled once a few tokens are out: what arrived is a prefix.
+    const ConversationHandle decoding = engine.start_new_conversation();
+    generation = start(engine, decoding, PROMPT, 10ms);
+    std::vector<int32_t> received;
+    while (received.size() < 3) {
+        const int64_t count = generation.stream->read(out, 4, 1000ms);
+        if (count < 0) {
+            break;
+        }
+        received.insert(received.end(), out, out + count);
+    }
+    generation.task->cancel();
+    const std::vector<int32_t> rest = drain(*generation.stream, 4);
+    received.insert(received.end(), rest.begin(), rest.end());
+    T760_CHECK(generation.task->wait() == GenerationStatus::CANCELLED);
+    T760_CHECK(received.size() == generation.task->get_token_count() && received.size() < NEW_TOKENS);
+    T760_CHECK(std::equal(received.begin(), received.end(), expected.begin()));
+    engine.end_conversation(decoding);
+}
+
+void check_cancel_mid_prefill(Engine& engine) {
+    std::vector<int> prompt(LONG_PROMPT_TOKENS);
+    for (size_t i = 0; i < prompt.size(); ++i) {
+        prompt[i] = static_cast<int>((i * 131 + 7) % 1024);
+    }
+    // The uncancelled prefill, and how long it takes.
+    const ConversationHandle plain = engine.start_new_conversation();
+    OutputOptions options;
+    options.sampling.do_sample = false;
+    StepOutput output;
+    const auto t0 = std::chrono::steady_clock::now();
+    engine.generate(plain, prompt.data(), prompt.size(), output, options);
+    const auto prefill_time = std::chrono::steady_clock::now() - t0;
+
+    const ConversationHandle cancelled = engine.start_new_conversation();
+    StreamedGeneration generation = start(engine, cancelled, prompt);
+    std::this_thread::sleep_for(prefill_time / 2);
+    generation.task->cancel();
+    T760_CHECK(drain(*generation.stream, 8).empty());
+    T760_CHECK(generation.task->wait() == GenerationStatus::CANCELLED);
+    T760_CHECK(generation.task->get_token_count() == 0);
+
+    // The prefill ran to the end, so the conversation goes on from there.
+    T760_CHECK(engine.remaining_context(cancelled) == engine.remaining_context(plain));
+    const int32_t token = output.next_token;
+    T760_CHECK(next_after(engine, cancelled, token) == next_after(engine, plain, token));
+    engine.end_conversation(cancelled);
+    engine.end_conversation(plain);
+}
+
+}
+
+int main() {
+    check_stream();
+
+    test::SyntheticModelSpec spec;
+    spec.hidden_size = 256;
+    spec.intermediate_size = 1024;
+    spec.heads = 4;
+    spec.lm_head_rows = spec.vocab_size; // Untied, so greedy decoding does not just repeat its input
+    spec.seq_len = 2048;
+    const std::string model_path = test::temp_path("t760_token_stream.t760");
+    test::write_synthetic_model(model_path, spec);
+
+    EngineConfig config;
+    config.devices = {{DeviceType::CPU, 0, true}};
+    config.threading.big_threads = 2;
+    config.threading.big_affinity_mask = ~0ull;
+    config.threading.little_threads = 1;
+    config.threading.little_affinity_mask = ~0ull;
+    Engine engine;
+    engine.initialize(config);
+    if (T760_CHECK(engine.load_model(model_path))) {
+        check_generation(engine);
+        check_cancel_mid_prefill(engine);
+    }
+    engine.shutdown();
+    std::remove(model_path.c_str());
+    return test::finish();
+}
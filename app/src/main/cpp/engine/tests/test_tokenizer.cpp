@@ -0,0 +1,175 @@
+#include "support/SyntheticModel.h"
+#include "support/TestSupport.h"
+#include "support/TestTokenizer.h"
+#include "t760_engine/tokenizer/Tokenizer.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Converts tests/data/tokenizer.json with tokenizer_converter and checks
+// encode() against the ids the Hugging Face tokenizers library gives the
+// same file (add_special_tokens=False), and decode() back to the text. Then
+// corrupts the converted file one table at a time: the constructor must
+// reject each copy rather than leave a lookup to read out of range.
+
+using namespace t760;
+
+namespace {
+
+struct Reference {
+    std::string text;
+    std::vector<int> ids;
+};
+
+const std::vector<Reference>& references() {
+    static const std::vector<Reference> cases = {
+        {"The quick brown fox", {406, 312, 390, 292, 404, 312, 285, 301, 396, 325, 289, 298, 307}},
+        {" the  dog ", {323, 369, 312}},
+        {"h\xC3\xA9llo w\xC3\xB6rld \xF0\x9F\x99\x82",
+         {291, 199, 173, 295, 295, 298, 316, 199, 186, 301, 295, 287, 312, 244, 163, 157, 134}},
+        {"<start_of_turn>user\nWhat time is it?<end_of_turn>\n",
+         {413, 304, 302, 327, 14, 280, 291, 342, 313, 292, 352, 366, 317, 321, 274, 414, 14}},
+        {R"({"city": "Paris", "days": 3})", {334, 286, 321, 377, 278, 328, 292, 349, 287, 355, 348, 268, 311}},
+        {"", {}},
+        {"xyz<bos>", {307, 308, 309, 2}},
+    };
+    return cases;
+}
+
+void check_reference(const Tokenizer& tokenizer) {
+    T760_CHECK(tokenizer.vocab_size() == 415);
+    T760_CHECK(tokenizer.bos_id() == 2 && tokenizer.eos_id() == 1 && tokenizer.unk_id() == 3);
+    for (const Reference& reference : references()) {
+        std::vector<int> ids;
+        tokenizer.encode(reference.text, false, ids);
+        if (!T760_CHECK(ids == reference.ids)) {
+            std::cerr << "  encode mismatch on \"" << reference.text << "\"" << std::endl;
+        }
+        std::string text;
+        tokenizer.decode(reference.ids.data(), reference.ids.size(), false, text);
+        if (!T760_CHECK(text == reference.text)) {
+            std::cerr << "  decoded \"" << text << "\" for \"" << reference.text << "\"" << std::endl;
+        }
+    }
+
+    std::vector<int> ids = {7};
+    tokenizer.encode("The", true, ids); // Appends
+    T760_CHECK(ids.size() >= 3 && ids[0] == 7 && ids[1] == tokenizer.bos_id());
+
+    const std::vector<int>& turn = references()[3].ids;
+    std::string text;
+    tokenizer.decode(turn.data(), turn.size(), true, text);
+    T760_CHECK(text == "user\nWhat time is it?\n");
+    T760_CHECK(tokenizer.token_type(413) == TokenType::CONTROL && tokenizer.token_type(4) == TokenType::BYTE);
+
+    for (int32_t id = 0; id < static_cast<int32_t>(tokenizer.vocab_size()); ++id) {
+        if (!T760_CHECK(tokenizer.token_to_id(tokenizer.id_to_piece(id)) == id)) {
+            std::cerr << "  piece of " << id << " maps back to another id" << std::endl;
+            break;
+        }
+    }
+    T760_CHECK(tokenizer.id_to_piece(-1).empty() && tokenizer.id_to_piece(415).empty());
+    T760_CHECK(tokenizer.token_to_id("no such piece") == -1);
+
+    const TokenizerThroughput throughput = measure_tokenizer_throughput(tokenizer, references()[0].text, 2);
+    T760_CHECK(throughput.bytes == references()[0].text.size() && throughput.tokens == references()[0].ids.size());
+    T760_CHECK(throughput.encode_mb_per_s > 0.0 && throughput.decode_mb_per_s > 0.0);
+}
+
+std::vector<char> read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Writes a copy of file changed by corrupt and expects the constructor to reject it.
+void check_rejected(const std::vector<char>& file, const char* what,
+                    const std::function<void(std::vector<char>&, const TokenizerFileHeader&)>& corrupt) {
+    std::vector<char> copy = file;
+    TokenizerFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    corrupt(copy, header);
+    const std::string path = test::temp_path("t760_corrupt.t760tok");
+    std::ofstream(path, std::ios::binary).write(copy.data(), static_cast<std::streamsize>(copy.size()));
+    bool threw = false;
+    try {
+        Tokenizer tokenizer(path);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    if (!T760_CHECK(threw)) {
+        std::cerr << "  accepted a file with " << what << std::endl;
+    }
+    std::remove(path.c_str());
+}
+
+template <typename T>
+T* at(std::vector<char>& file, uint64_t offset) {
+    return reinterpret_cast<T*>(file.data() + offset);
+}
+
+void check_validation(const std::string& path) {
+    const std::vector<char> file = read_file(path);
+    check_rejected(file, "piece offsets out of order", [](std::vector<char>& f, const TokenizerFileHeader& h) {
+        uint32_t* offsets = at<uint32_t>(f, h.piece_offsets_offset);
+        offsets[100] = offsets[101] + 1;
+    });
+    check_rejected(file, "a merge past the vocab", [](std::vector<char>& f, const TokenizerFileHeader& h) {
+        MergeEntry* merges = at<MergeEntry>(f, h.merges_offset);
+        for (uint32_t b = 0; b < h.merge_buckets; ++b) {
+            if (merges[b].left != MERGE_EMPTY) {
+                merges[b].merged = h.vocab_size;
+                break;
+            }
+        }
+    });
+    check_rejected(file, "a full merge table", [](std::vector<char>& f, const TokenizerFileHeader& h) {
+        MergeEntry* merges = at<MergeEntry>(f, h.merges_offset);
+        for (uint32_t b = 0; b < h.merge_buckets; ++b) {
+            if (merges[b].left == MERGE_EMPTY) {
+                merges[b] = MergeEntry{h.vocab_size + b, 0, 0, 0};
+            }
+        }
+    });
+    for (const bool added : {false, true}) {
+        check_rejected(file, added ? "an added-token id past the vocab" : "a piece id past the vocab",
+                       [added](std::vector<char>& f, const TokenizerFileHeader& h) {
+            DoubleArrayUnit* units = at<DoubleArrayUnit>(f, added ? h.added_trie_offset : h.trie_offset);
+            const uint32_t size = added ? h.added_trie_size : h.trie_size;
+            // The last leaf: a label-0 child of its parent.
+            for (uint32_t t = size; t-- > 0;) {
+                const int32_t parent = units[t].check;
+                if (parent >= 0 && static_cast<uint32_t>(parent) < size &&
+                    units[parent].base == static_cast<int32_t>(t)) {
+                    units[t].base = -static_cast<int32_t>(h.vocab_size) - 1;
+                    break;
+                }
+            }
+        });
+    }
+    check_rejected(file, "a byte token past the vocab", [](std::vector<char>& f, const TokenizerFileHeader&) {
+        reinterpret_cast<TokenizerFileHeader*>(f.data())->byte_tokens['a'] = 415;
+    });
+
+    // The untouched copy still loads.
+    const std::string copy_path = test::temp_path("t760_copy.t760tok");
+    std::ofstream(copy_path, std::ios::binary).write(file.data(), static_cast<std::streamsize>(file.size()));
+    T760_CHECK(Tokenizer(copy_path).vocab_size() == 415);
+    std::remove(copy_path.c_str());
+}
+
+}
+
+int main() {
+    const std::string path = test::temp_path("t760_tokenizer.t760tok");
+    test::write_test_tokenizer(path);
+    check_reference(Tokenizer(path));
+    check_validation(path);
+    std::remove(path.c_str());
+    return test::finish();
+}
@@ -0,0 +1,559 @@
+#include "t760_engine/tokenizer/DoubleArrayTrie.h"
+#include "t760_engine/tokenizer/TokenizerFormat.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Converts a Hugging Face tokenizer.json (BPE model, as shipped with Gemma
+// and Llama 2) into the binary .t760tok file the engine maps at runtime:
+//
+//   tokenizer_converter tokenizer.json tokenizer.t760tok
+//
+// Supported pipeline: normalizers Replace(" " -> U+2581), Prepend(U+2581)
+// or a Sequence of them, or a Metaspace pre-tokenizer that does not split;
+// byte fallback; added tokens matched in the raw text. Anything else is
+// rejected rather than converted into a tokenizer that encodes differently.
+
+namespace {
+
+using t760::TokenType;
+
+constexpr const char* METASPACE = "\xE2\x96\x81";
+
+// --- Minimal JSON reader: enough of RFC 8259 for tokenizer.json ---
+
+struct Json {
+    enum class Kind { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT } kind = Kind::NUL;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<Json> items;
+    std::vector<std::pair<std::string, Json>> members;
+
+    const Json* find(const std::string& key) const {
+        for (const auto& [name, value] : members) {
+            if (name == key) {
+                return &value;
+            }
+        }
+        return nullptr;
+    }
+    bool is_null() const { return kind == Kind::NUL; }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : text_(text) {}
+
+    Json parse() {
+        Json value = parse_value();
+        skip_space();
+        if (pos_ != text_.size()) {
+            fail("trailing characters");
+        }
+        return value;
+    }
+
+private:
+    [[noreturn]] void fail(const char* what) const {
+        throw std::runtime_error(std::string("JSON ") + what + " at byte " + std::to_string(pos_));
+    }
+
+    void skip_space() {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\n' || text_[pos_] == '\r' ||
+                                       text_[pos_] == '\t')) {
+            ++pos_;
+        }
+    }
+
+    bool consume(const char* literal) {
+        const size_t n = std::strlen(literal);
+        if (text_.compare(pos_, n, literal) == 0) {
+            pos_ += n;
+            return true;
+        }
+        return false;
+    }
+
+    Json parse_value() {
+        skip_space();
+        if (pos_ >= text_.size()) {
+            fail("unexpected end");
+        }
+        Json value;
+        const char c = text_[pos_];
+        if (c == '{') {
+            value.kind = Json::Kind::OBJECT;
+            ++pos_;
+            skip_space();
+            if (pos_ < text_.size() && text_[pos_] == '}') {
+                ++pos_;
+                return value;
+            }
+            for (;;) {
+                skip_space();
+                std::string key = parse_string();
+                skip_space();
+                if (pos_ >= text_.size() || text_[pos_++] != ':') {
+                    fail("expected ':'");
+                }
+                value.members.emplace_back(std::move(key), parse_value());
+                skip_space();
+                if (pos_ < text_.size() && text_[pos_] == ',') {
+                    ++pos_;
+                } else if (pos_ < text_.size() && text_[pos_] == '}') {
+                    ++pos_;
+                    return value;
+                } else {
+                    fail("expected ',' or '}'");
+                }
+            }
+        }
+        if (c == '[') {
+            value.kind = Json::Kind::ARRAY;
+            ++pos_;
+            skip_space();
+            if (pos_ < text_.size() && text_[pos_] == ']') {
+                ++pos_;
+                return value;
+            }
+            for (;;) {
+                value.items.push_back(parse_value());
+                skip_space();
+                if (pos_ < text_.size() && text_[pos_] == ',') {
+                    ++pos_;
+                } else if (pos_ < text_.size() && text_[pos_] == ']') {
+                    ++pos_;
+                    return value;
+                } else {
+                    fail("expected ',' or ']'");
+                }
+            }
+        }
+        if (c == '"') {
+            value.kind = Json::Kind::STRING;
+            value.string = parse_string();
+            return value;
+        }
+        if (consume("true")) {
+            value.kind = Json::Kind::BOOL;
+            value.boolean = true;
+            return value;
+        }
+        if (consume("false")) {
+            value.kind = Json::Kind::BOOL;
+            return value;
+        }
+        if (consume("null")) {
+            return value;
+        }
+        const char* begin = text_.c_str() + pos_;
+        char* end = nullptr;
+        value.kind = Json::Kind::NUMBER;
+        value.number = std::strtod(begin, &end);
+        if (end == begin) {
+            fail("unexpected character");
+        }
+        pos_ += static_cast<size_t>(end - begin);
+        return value;
+    }
+
+    uint32_t parse_hex4() {
+        if (pos_ + 4 > text_.size()) {
+            fail("truncated \\u escape");
+        }
+        uint32_t code = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char h = text_[pos_++];
+            code <<= 4;
+            if (h >= '0' && h <= '9') code |= h - '0';
+            else if (h >= 'a' && h <= 'f') code |= h - 'a' + 10;
+            else if (h >= 'A' && h <= 'F') code |= h - 'A' + 10;
+            else fail("bad \\u escape");
+        }
+        return code;
+    }
+
+    static void append_utf8(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | code >> 6));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | code >> 12));
+            out.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | code >> 18));
+            out.push_back(static_cast<char>(0x80 | (code >> 12 & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+    }
+
+    std::string parse_string() {
+        if (pos_ >= text_.size() || text_[pos_] != '"') {
+            fail("expected string");
+        }
+        ++pos_;
+        std::string out;
+        for (;;) {
+            if (pos_ >= text_.size()) {
+                fail("unterminated string");
+            }
+            const char c = text_[pos_++];
+            if (c == '"') {
+                return out;
+            }
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (pos_ >= text_.size()) {
+                fail("unterminated escape");
+            }
+            switch (text_[pos_++]) {
+                case '"': out.push_back('"'); break;
+                case '\\': out.push_back('\\'); break;
+                case '/': out.push_back('/'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'u': {
+                    uint32_t code = parse_hex4();
+                    if (code >= 0xD800 && code < 0xDC00 && text_.compare(pos_, 2, "\\u") == 0) {
+                        pos_ += 2;
+                        const uint32_t low = parse_hex4();
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    append_utf8(out, code);
+                    break;
+                }
+                default: fail("bad escape");
+            }
+        }
+    }
+
+    const std::string& text_;
+    size_t pos_ = 0;
+};
+
+// --- Conversion ---
+
+const Json& member(const Json& object, const char* key) {
+    const Json* value = object.find(key);
+    if (!value) {
+        throw std::runtime_error(std::string("tokenizer.json has no \"") + key + "\"");
+    }
+    return *value;
+}
+
+bool is_metaspace_string(const Json* value) {
+    return value && value->kind == Json::Kind::STRING && value->string == METASPACE;
+}
+
+// Whether U+2581 follows some other character in piece.
+bool continues_word_with_metaspace(const std::string& piece) {
+    for (size_t at = piece.find(METASPACE, 1); at != std::string::npos; at = piece.find(METASPACE, at + 1)) {
+        if (at < 3 || piece.compare(at - 3, 3, METASPACE) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Folds a normalizer into flags; throws on anything encode() cannot mirror.
+void read_normalizer(const Json& normalizer, uint16_t& flags) {
+    if (normalizer.is_null()) {
+        return;
+    }
+    const std::string& type = member(normalizer, "type").string;
+    if (type == "Sequence") {
+        for (const Json& inner : member(normalizer, "normalizers").items) {
+            read_normalizer(inner, flags);
+        }
+    } else if (type == "Replace") {
+        const Json* pattern = member(normalizer, "pattern").find("String");
+        if (!pattern || pattern->string != " " || !is_metaspace_string(normalizer.find("content"))) {
+            throw std::runtime_error("Only the Replace(\" \" -> U+2581) normalizer is supported.");
+        }
+        flags |= t760::TOKENIZER_SPACE_TO_METASPACE;
+    } else if (type == "Prepend") {
+        if (!is_metaspace_string(normalizer.find("prepend"))) {
+            throw std::runtime_error("Only the Prepend(U+2581) normalizer is supported.");
+        }
+        flags |= t760::TOKENIZER_PREPEND_METASPACE;
+    } else {
+        throw std::runtime_error("Unsupported normalizer: " + type);
+    }
+}
+
+void read_pre_tokenizer(const Json& pre_tokenizer, uint16_t flags_before, uint16_t& flags) {
+    if (pre_tokenizer.is_null()) {
+        return;
+    }
+    const std::string& type = member(pre_tokenizer, "type").string;
+    if (type == "Split" && (flags_before & t760::TOKENIZER_SPACE_TO_METASPACE)) {
+        // Gemma 3 splits on " " after the normalizer has replaced every
+        // space, so the split never applies.
+        const Json* pattern = member(pre_tokenizer, "pattern").find("String");
+        if (pattern && pattern->string == " ") {
+            return;
+        }
+    }
+    if (type == "Metaspace") {
+        const Json* split = pre_tokenizer.find("split");
+        const Json* scheme = pre_tokenizer.find("prepend_scheme");
+        if ((split && split->boolean) || !is_metaspace_string(pre_tokenizer.find("replacement"))) {
+            throw std::runtime_error("Only a Metaspace pre-tokenizer without split is supported.");
+        }
+        flags |= t760::TOKENIZER_SPACE_TO_METASPACE;
+        if (!scheme || scheme->string != "never") {
+            flags |= t760::TOKENIZER_PREPEND_METASPACE;
+        }
+        return;
+    }
+    throw std::runtime_error("Unsupported pre-tokenizer: " + type);
+}
+
+// <0xXX> -> XX, or -1.
+int byte_token_value(const std::string& piece) {
+    if (piece.size() != 6 || piece.compare(0, 3, "<0x") != 0 || piece[5] != '>') {
+        return -1;
+    }
+    int value = 0;
+    for (int i = 3; i < 5; ++i) {
+        const char h = piece[i];
+        value <<= 4;
+        if (h >= '0' && h <= '9') value |= h - '0';
+        else if (h >= 'A' && h <= 'F') value |= h - 'A' + 10;
+        else if (h >= 'a' && h <= 'f') value |= h - 'a' + 10;
+        else return -1;
+    }
+    return value;
+}
+
+void pad_to_8(std::string& out) {
+    out.resize((out.size() + 7) & ~size_t{7}, '\0');
+}
+
+template <typename T>
+uint64_t append_section(std::string& out, const T* data, size_t count) {
+    pad_to_8(out);
+    const uint64_t offset = out.size();
+    out.append(reinterpret_cast<const char*>(data), count * sizeof(T));
+    return offset;
+}
+
+void convert(const std::string& json_path, const std::string& out_path) {
+    std::ifstream in(json_path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Failed to open " + json_path);
+    }
+    const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const Json root = JsonParser(text).parse();
+
+    const Json& model = member(root, "model");
+    if (member(model, "type").string != "BPE") {
+        throw std::runtime_error("Only BPE tokenizer models are supported.");
+    }
+    const Json* byte_fallback = model.find("byte_fallback");
+    const Json* unk_token = model.find("unk_token");
+
+    t760::TokenizerFileHeader header{};
+    header.magic = t760::TOKENIZER_FILE_MAGIC;
+    header.version = t760::TOKENIZER_FILE_VERSION;
+    uint16_t flags = 0;
+    if (const Json* normalizer = root.find("normalizer")) {
+        read_normalizer(*normalizer, flags);
+    }
+    if (const Json* pre_tokenizer = root.find("pre_tokenizer")) {
+        read_pre_tokenizer(*pre_tokenizer, flags, flags);
+    }
+    if (byte_fallback && byte_fallback->boolean) {
+        flags |= t760::TOKENIZER_BYTE_FALLBACK;
+    }
+    header.flags = flags;
+
+    // Pieces by id: the BPE vocab, then added tokens (which may extend it).
+    std::vector<std::string> pieces;
+    std::vector<TokenType> types;
+    std::unordered_map<std::string, int32_t> vocab;
+    const auto place = [&](int32_t id, const std::string& piece, TokenType type) {
+        if (id < 0) {
+            throw std::runtime_error("Negative token id for " + piece);
+        }
+        if (static_cast<size_t>(id) >= pieces.size()) {
+            pieces.resize(static_cast<size_t>(id) + 1);
+            types.resize(static_cast<size_t>(id) + 1, TokenType::NORMAL);
+        }
+        pieces[id] = piece;
+        types[id] = type;
+    };
+    std::vector<std::pair<std::string, int32_t>> trie_keys;
+    for (const auto& [piece, id_value] : member(model, "vocab").members) {
+        const auto id = static_cast<int32_t>(id_value.number);
+        vocab.emplace(piece, id);
+        place(id, piece, TokenType::NORMAL);
+        if (!piece.empty()) {
+            trie_keys.emplace_back(piece, id);
+        }
+    }
+    if ((flags & (t760::TOKENIZER_SPACE_TO_METASPACE | t760::TOKENIZER_PREPEND_METASPACE)) &&
+        vocab.count(METASPACE) && std::none_of(trie_keys.begin(), trie_keys.end(), [](const auto& key) {
+            return continues_word_with_metaspace(key.first);
+        })) {
+        flags |= t760::TOKENIZER_WORD_BOUNDARIES;
+        header.flags = flags;
+    }
+    std::fill(std::begin(header.byte_tokens), std::end(header.byte_tokens), -1);
+    if (flags & t760::TOKENIZER_BYTE_FALLBACK) {
+        for (const auto& [piece, id] : trie_keys) {
+            const int value = byte_token_value(piece);
+            if (value >= 0) {
+                header.byte_tokens[value] = id;
+                types[id] = TokenType::BYTE;
+            }
+        }
+    }
+    std::vector<std::pair<std::string, int32_t>> added_keys;
+    std::map<std::string, int32_t> added_ids;
+    if (const Json* added = root.find("added_tokens")) {
+        for (const Json& token : added->items) {
+            const auto id = static_cast<int32_t>(member(token, "id").number);
+            const std::string& content = member(token, "content").string;
+            const Json* special = token.find("special");
+            place(id, content, special && special->boolean ? TokenType::CONTROL : TokenType::USER_DEFINED);
+            if (!content.empty() && added_ids.emplace(content, id).second) {
+                added_keys.emplace_back(content, id);
+            }
+        }
+    }
+    header.vocab_size = static_cast<uint32_t>(pieces.size());
+
+    const auto lookup = [&](std::initializer_list<const char*> names) {
+        for (const char* name : names) {
+            const auto added = added_ids.find(name);
+            if (added != added_ids.end()) return added->second;
+            const auto it = vocab.find(name);
+            if (it != vocab.end()) return it->second;
+        }
+        return -1;
+    };
+    header.bos_id = lookup({"<bos>", "<s>"});
+    header.eos_id = lookup({"<eos>", "</s>"});
+    header.pad_id = lookup({"<pad>"});
+    header.unk_id = unk_token && unk_token->kind == Json::Kind::STRING ? lookup({unk_token->string.c_str()}) : -1;
+
+    // Merges, by rank, into an open-addressing table at most ~70% full.
+    const Json& merges = member(model, "merges");
+    uint32_t buckets = 1;
+    while (buckets < merges.items.size() * 10 / 7 + 1) {
+        buckets <<= 1;
+    }
+    std::vector<t760::MergeEntry> table(buckets, t760::MergeEntry{t760::MERGE_EMPTY, 0, 0, 0});
+    size_t merge_count = 0;
+    size_t skipped = 0;
+    for (size_t rank = 0; rank < merges.items.size(); ++rank) {
+        const Json& merge = merges.items[rank];
+        std::string left;
+        std::string right;
+        if (merge.kind == Json::Kind::ARRAY && merge.items.size() == 2) {
+            left = merge.items[0].string;
+            right = merge.items[1].string;
+        } else {
+            const size_t space = merge.string.find(' ', 1);
+            if (space == std::string::npos) {
+                throw std::runtime_error("Malformed merge: " + merge.string);
+            }
+            left = merge.string.substr(0, space);
+            right = merge.string.substr(space + 1);
+        }
+        const auto l = vocab.find(left);
+        const auto r = vocab.find(right);
+        const auto m = vocab.find(left + right);
+        if (l == vocab.end() || r == vocab.end() || m == vocab.end()) {
+            ++skipped;
+            continue;
+        }
+        const auto li = static_cast<uint32_t>(l->second);
+        const auto ri = static_cast<uint32_t>(r->second);
+        uint32_t b = t760::merge_bucket(li, ri, buckets - 1);
+        while (table[b].left != t760::MERGE_EMPTY && !(table[b].left == li && table[b].right == ri)) {
+            b = (b + 1) & (buckets - 1);
+        }
+        if (table[b].left == t760::MERGE_EMPTY) { // A repeated pair keeps its first rank
+            table[b] = t760::MergeEntry{li, ri, static_cast<uint32_t>(rank), static_cast<uint32_t>(m->second)};
+            ++merge_count;
+        }
+    }
+    header.merge_buckets = buckets;
+
+    std::sort(trie_keys.begin(), trie_keys.end());
+    std::sort(added_keys.begin(), added_keys.end());
+    const std::vector<t760::DoubleArrayUnit> trie = t760::DoubleArrayTrie::build(trie_keys);
+    const std::vector<t760::DoubleArrayUnit> added_trie = t760::DoubleArrayTrie::build(added_keys);
+    header.trie_size = static_cast<uint32_t>(trie.size());
+    header.added_trie_size = static_cast<uint32_t>(added_trie.size());
+
+    std::vector<uint32_t> offsets;
+    std::string strings;
+    offsets.reserve(pieces.size() + 1);
+    for (const std::string& piece : pieces) {
+        offsets.push_back(static_cast<uint32_t>(strings.size()));
+        strings += piece;
+    }
+    offsets.push_back(static_cast<uint32_t>(strings.size()));
+    header.strings_size = strings.size();
+
+    std::string file(sizeof(header), '\0');
+    header.piece_offsets_offset = append_section(file, offsets.data(), offsets.size());
+    header.strings_offset = append_section(file, strings.data(), strings.size());
+    header.token_types_offset = append_section(file, types.data(), types.size());
+    header.merges_offset = append_section(file, table.data(), table.size());
+    header.trie_offset = append_section(file, trie.data(), trie.size());
+    header.added_trie_offset = append_section(file, added_trie.data(), added_trie.size());
+    pad_to_8(file);
+    std::memcpy(file.data(), &header, sizeof(header));
+
+    std::ofstream out(out_path, std::ios::binary | std::ios::trunc);
+    out.write(file.data(), static_cast<std::streamsize>(file.size()));
+    if (!out) {
+        throw std::runtime_error("Failed to write " + out_path);
+    }
+    std::cout << "Tokenizer: " << header.vocab_size << " tokens (" << added_keys.size() << " added), "
+              << merge_count << " merges";
+    if (skipped > 0) {
+        std::cout << " (" << skipped << " referencing unknown pieces skipped)";
+    }
+    std::cout << ", trie " << trie.size() << " units; bos " << header.bos_id << ", eos " << header.eos_id
+              << ", unk " << header.unk_id << "; flags 0x" << std::hex << header.flags << std::dec << ". Wrote "
+              << file.size() << " bytes to " << out_path << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " tokenizer.json out.t760tok" << std::endl;
+        return 2;
+    }
+    try {
+        convert(argv[1], argv[2]);
+    } catch (const std::exception& e) {
+        std::cerr << "Conversion failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
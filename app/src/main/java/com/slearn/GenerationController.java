@@ -1,138 +1,137 @@
 package com.slearn;
 
-import android.content.Context;
-import org.json.JSONException;
-import org.json.JSONObject;
-import java.io.IOException;
-import java.io.InputStream;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.nio.charset.StandardCharsets;
-import java.util.ArrayList;
-import java.util.HashMap;
-import java.util.List;
-import java.util.Map;
+import java.util.Arrays;
+import java.util.concurrent.atomic.AtomicLong;
 
 /**
- * An advanced Generation Controller that parses the vocabulary from tokenizer.json.
+ * Drives generation for the UI. Tokenization runs in the native engine over the .t760tok file it
+ * loaded (see NativeEngine.nativeLoadTokenizer).
  */
 public class GenerationController {
 
-    private final Map<String, Integer> vocab;
-    private final Map<Integer, String> inverseVocab;
-    private final int eosTokenId; // End-of-Sequence token
+    // Tokens that end a reply: end of sequence, and Gemma's end of turn.
+    private static final String[] STOP_PIECES = {"<eos>", "</s>", "<end_of_turn>"};
 
-    public GenerationController(Context context) throws IOException, JSONException {
-        // This now loads the much more complex tokenizer.json file.
-        JSONObject tokenizerJson = loadJsonFromAssets(context, "tokenizer.json");
-        
-        // The vocabulary is typically nested inside the 'model' -> 'vocab' keys.
-        this.vocab = parseVocabFromJson(tokenizerJson.getJSONObject("model").getJSONObject("vocab"));
-        
-        this.inverseVocab = new HashMap<>();
-        for (Map.Entry<String, Integer> entry : vocab.entrySet()) {
-            inverseVocab.put(entry.getValue(), entry.getKey());
-        }
+    private final int[] stopTokenIds;
+    // Native generation in progress, or 0.
+    private final AtomicLong activeGeneration = new AtomicLong(0);
 
-        // Find the End-of-Sequence token ID. This is crucial for stopping generation.
-        int foundEosId = vocab.getOrDefault("<eos>", -1); // Common for Gemma
-        if (foundEosId == -1) {
-            // Fallback for other models if "<eos>" is not found.
-            foundEosId = vocab.getOrDefault("</s>", -1);
-        }
-        this.eosTokenId = foundEosId;
-    }
+    private static final float TEMPERATURE = 1.0f;
+    private static final float REPETITION_PENALTY = 1.0f;
+    private static final float FREQUENCY_PENALTY = 0.0f;
+    private static final int READ_TIMEOUT_MS = 100;
+    private static final int TEXT_BYTES_PER_TOKEN = 8;
 
-    private JSONObject loadJsonFromAssets(Context context, String fileName) throws IOException, JSONException {
-        InputStream is = context.getAssets().open(fileName);
-        int size = is.available();
-        byte[] buffer = new byte[size];
-        is.read(buffer);
-        is.close();
-        String json = new String(buffer, StandardCharsets.UTF_8);
-        return new JSONObject(json);
-    }
-
-    private Map<String, Integer> parseVocabFromJson(JSONObject vocabJson) throws JSONException {
-        Map<String, Integer> map = new HashMap<>();
-        for (java.util.Iterator<String> it = vocabJson.keys(); it.hasNext(); ) {
-            String key = it.next();
-            map.put(key, vocabJson.getInt(key));
-        }
-        return map;
-    }
+    // Reused by successive generate() calls, growing when a reply needs more: native code reads
+    // tokens into replyTokens and decodes them into replyText in place.
+    private ByteBuffer replyTokens = allocate(0);
+    private ByteBuffer replyText = allocate(0);
+    private byte[] textBytes = new byte[0];
 
     /**
-     * A very basic tokenizer. A real implementation would use the BPE logic
-     * also contained within tokenizer.json, but for now, this demonstrates vocab lookup.
+     * @param engine An engine whose tokenizer is already loaded.
      */
-    public int[] tokenize(String text) {
-        // NOTE: This is still a placeholder for a real BPE tokenizer.
-        // A production app would use a proper Java BPE library that can fully parse tokenizer.json.
-        String[] words = text.toLowerCase().trim().split("\\s+");
-        List<Integer> tokenIds = new ArrayList<>();
-        
-        // Gemma uses a BOS (Beginning-of-Sequence) token.
-        if (vocab.containsKey("<bos>")) {
-            tokenIds.add(vocab.get("<bos>"));
-        }
-
-        for (String word : words) {
-            tokenIds.add(vocab.getOrDefault(word, 2)); // 2 is typically the <unk> token
-        }
-
-        int[] result = new int[tokenIds.size()];
-        for (int i = 0; i < tokenIds.size(); i++) {
-            result[i] = tokenIds.get(i);
+    public GenerationController(NativeEngine engine) {
+        int[] ids = new int[STOP_PIECES.length];
+        int count = 0;
+        for (String piece : STOP_PIECES) {
+            int id = engine.nativeTokenId(piece.getBytes(StandardCharsets.UTF_8));
+            if (id >= 0) {
+                ids[count++] = id;
+            }
         }
-        return result;
+        this.stopTokenIds = Arrays.copyOf(ids, count);
     }
 
     /**
-     * Converts a single token ID back to its string representation.
+     * Tokenizes a prompt, starting with the BOS token.
+     * @return The token IDs, or null if the engine has no tokenizer.
      */
-    public String detokenize(int tokenId) {
-        // Special handling for the <bos> token which shouldn't be displayed.
-        if (vocab.containsKey("<bos>") && tokenId == vocab.get("<bos>")) {
-            return "";
-        }
-        return inverseVocab.getOrDefault(tokenId, "");
+    public int[] tokenize(NativeEngine engine, String text) {
+        return engine.nativeEncode(text.getBytes(StandardCharsets.UTF_8), true);
     }
 
     /**
-     * The main generation loop.
+     * Generates up to maxNewTokens tokens and streams them to onTokenGenerated. The decode loop
+     * runs in native code; this thread only drains the tokens it produces, a batch per JNI call,
+     * through direct buffers, so the only garbage per batch is the String handed on. Calls must
+     * not overlap.
      */
     public void generate(NativeEngine engine, long handle, int[] initialTokenIds, int maxNewTokens, java.util.function.Consumer<String> onTokenGenerated) {
-        int[] currentTokens = initialTokenIds;
-
-        // The first call is the "prefill" phase with the full prompt.
-        int[] logits = engine.nativeGenerate(handle, currentTokens);
-        int nextTokenId = argmax(logits);
-
-        // The "decoding" loop, feeding one token back in at a time.
-        for (int i = 0; i < maxNewTokens; i++) {
-            if (nextTokenId == eosTokenId) {
-                break;
+        long generation = engine.nativeGenerateAsync(handle, initialTokenIds, maxNewTokens, TEMPERATURE, 0, 0.0f,
+                                                     REPETITION_PENALTY, FREQUENCY_PENALTY, stopTokenIds, 0);
+        if (generation == 0) {
+            return;
+        }
+        activeGeneration.set(generation);
+        try {
+            if (replyTokens.capacity() < maxNewTokens * Integer.BYTES) {
+                replyTokens = allocate(maxNewTokens * Integer.BYTES);
             }
+            // The reply so far is decoded as a whole after each batch, since a token's text
+            // depends on its neighbours (a character split over byte tokens, the leading
+            // space); only complete UTF-8 characters past what was delivered are passed on.
+            int replyLength = 0;
+            int delivered = 0;
+            int count;
+            while ((count = engine.nativeReadTokensDirect(generation, replyTokens, replyLength, READ_TIMEOUT_MS)) >= 0) {
+                if (count == 0) {
+                    continue;
+                }
+                replyLength += count;
+                int length = engine.nativeDecodeDirect(replyTokens, replyLength, true, replyText);
+                if (length > replyText.capacity()) {
+                    replyText = allocate(Math.max(length, maxNewTokens * TEXT_BYTES_PER_TOKEN));
+                    textBytes = new byte[replyText.capacity()];
+                    length = engine.nativeDecodeDirect(replyTokens, replyLength, true, replyText);
+                }
+                if (length < 0) {
+                    continue;
+                }
+                replyText.clear();
+                replyText.get(textBytes, 0, length);
+                int complete = completeUtf8Length(textBytes, length);
+                if (complete > delivered) {
+                    onTokenGenerated.accept(new String(textBytes, delivered, complete - delivered, StandardCharsets.UTF_8));
+                    delivered = complete;
+                }
+            }
+        } finally {
+            activeGeneration.set(0);
+            engine.nativeReleaseGeneration(generation);
+        }
+    }
 
-            String nextTokenStr = detokenize(nextTokenId);
-            onTokenGenerated.accept(nextTokenStr);
-
-            // Prepare for the next iteration.
-            currentTokens = new int[]{nextTokenId};
-            logits = engine.nativeGenerate(handle, currentTokens);
-            nextTokenId = argmax(logits);
+    /**
+     * Stops a generate() call running on another thread; it returns after the tokens already
+     * produced have been delivered.
+     */
+    public void cancel(NativeEngine engine) {
+        long generation = activeGeneration.get();
+        if (generation != 0) {
+            engine.nativeCancelGeneration(generation);
         }
     }
 
-    private int argmax(int[] logits) {
-        if (logits == null || logits.length == 0) {
-            return eosTokenId; // Default to stopping if there's an error
+    private static ByteBuffer allocate(int bytes) {
+        return ByteBuffer.allocateDirect(bytes).order(ByteOrder.nativeOrder());
+    }
+
+    // Length of text[0, length) without a trailing, incomplete UTF-8 character.
+    private static int completeUtf8Length(byte[] text, int length) {
+        int start = length;
+        // Back up over at most three continuation bytes to the last lead byte.
+        while (start > 0 && length - start < 3 && (text[start - 1] & 0xC0) == 0x80) {
+            start--;
         }
-        int maxIndex = 0;
-        for (int i = 1; i < logits.length; i++) {
-            if (logits[i] > logits[maxIndex]) {
-                maxIndex = i;
-            }
+        if (start == 0) {
+            return length;
         }
-        return maxIndex;
+        int lead = text[start - 1] & 0xFF;
+        int needed = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+        return length - (start - 1) >= needed ? length : start - 1;
     }
 }
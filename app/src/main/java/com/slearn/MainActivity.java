@@ -44,18 +44,23 @@ public class MainActivity extends AppCompatActivity {
         logToScreen("Initializing System...");
         new Thread(() -> {
             try {
-                // 1. Initialize Tokenizer (must be done first)
-                // IMPORTANT: You MUST add 'vocab.json' to your app's 'src/main/assets' folder.
-                generationController = new GenerationController(getApplicationContext());
-                logToScreen("Tokenizer loaded.");
-
-                // 2. Initialize C++ Engine
+                // 1. Initialize C++ Engine
                 boolean isInit = nativeEngine.nativeInit();
                 if (!isInit) {
                     logToScreen("FATAL: Engine initialization FAILED.");
                     return;
                 }
-                logToScreen("Engine Initialized. Loading model...");
+
+                // 2. Load Tokenizer
+                // IMPORTANT: Convert the model's tokenizer.json with tokenizer_converter and push
+                // the result to the app's files directory as 'tokenizer.t760tok'.
+                String tokenizerPath = getFilesDir().getAbsolutePath() + "/tokenizer.t760tok";
+                if (!nativeEngine.nativeLoadTokenizer(tokenizerPath)) {
+                    logToScreen("FATAL: Tokenizer loading FAILED.");
+                    return;
+                }
+                generationController = new GenerationController(nativeEngine);
+                logToScreen("Engine and tokenizer initialized. Loading model...");
 
                 // 3. Load Model
                 String modelPath = getFilesDir().getAbsolutePath() + "/model.t760";
@@ -91,11 +96,19 @@ public class MainActivity extends AppCompatActivity {
             sendButton.setEnabled(false);
 
             new Thread(() -> {
-                // 1. Tokenize the user's prompt using our Java controller.
-                int[] tokenIds = generationController.tokenize(prompt);
+                // 1. Tokenize the user's prompt in the native tokenizer.
+                int[] tokenIds = generationController.tokenize(nativeEngine, prompt);
+                if (tokenIds == null) {
+                    logToScreen("ERROR: Tokenization FAILED.");
+                    runOnUiThread(() -> {
+                        promptEditText.setEnabled(true);
+                        sendButton.setEnabled(true);
+                    });
+                    return;
+                }
 
-                // 2. Start the generation loop, which is managed by the Java controller.
-                // The controller will call the C++ engine repeatedly.
+                // 2. Generate. The decode loop runs in the C++ engine; the controller
+                // streams its tokens back in batches.
                 generationController.generate(
                     nativeEngine,
                     conversationHandle,
@@ -113,10 +126,10 @@ public class MainActivity extends AppCompatActivity {
         });
     }
 
-    // This method is called by the controller for each new token.
+    // This method is called by the controller as the reply text grows.
     private void streamToScreen(final String token) {
         runOnUiThread(() -> {
-            logTextView.append(token.replace(" ", " ")); // Post-process token string if needed
+            logTextView.append(token);
             scrollView.post(() -> scrollView.fullScroll(View.FOCUS_DOWN));
         });
     }
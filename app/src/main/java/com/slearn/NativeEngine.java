@@ -1,7 +1,43 @@
 package com.slearn;
 
+import java.nio.ByteBuffer;
+
+/**
+ * Every method may be called from any thread. Generate calls on different
+ * conversations run in parallel; calls on one conversation run one at a time.
+ */
 public class NativeEngine {
 
+    /** User-facing requests, run on the big cores ahead of background work. */
+    public static final int PRIORITY_INTERACTIVE = 0;
+    /** Summarization, indexing and the like, run on the little cores. */
+    public static final int PRIORITY_BACKGROUND = 1;
+
+    /** Status of a generation started with nativeGenerateAsync. */
+    public static final int GENERATION_RUNNING = 0;
+    /** Sampled a stop token. */
+    public static final int GENERATION_STOPPED = 1;
+    /** Delivered maxNewTokens. */
+    public static final int GENERATION_LENGTH = 2;
+    /** Cancelled, or the model was unloaded. */
+    public static final int GENERATION_CANCELLED = 3;
+    public static final int GENERATION_FAILED = 4;
+
+    /** nativeEmbed pools the last token's hidden state. */
+    public static final int POOLING_LAST_TOKEN = 0;
+    /** nativeEmbed averages the hidden states of every token. */
+    public static final int POOLING_MEAN = 1;
+
+    /** nativeCompileGrammar reads a regular expression the whole output must match. */
+    public static final int GRAMMAR_REGEX = 0;
+    /** nativeCompileGrammar reads a JSON schema the output must be an instance of. */
+    public static final int GRAMMAR_JSON_SCHEMA = 1;
+
+    /** nativeGenerateDirect produced no token. */
+    public static final int GENERATE_NO_TOKEN = -1;
+    /** nativeGenerateDirect failed: bad buffers, an ended conversation or an unloaded model. */
+    public static final int GENERATE_FAILED = -2;
+
     // Load our compiled C++ library (`libt760_engine_native.so`)
     static {
         System.loadLibrary("t760_engine_native");
@@ -33,12 +69,44 @@ public class NativeEngine {
      */
     public native void nativeUnloadModel();
 
+    /**
+     * Loads a smaller model of the same vocab as the draft for speculative decoding: it proposes
+     * a few tokens per step that the main model checks at once. Conversations started afterwards
+     * speculate unless they use a grammar or penalties; the draft is unloaded with the model.
+     * @param modelPath The absolute path to the draft's .t760 model file.
+     * @return true on success, false if no model is loaded or the draft cannot be used with it.
+     */
+    public native boolean nativeLoadDraftModel(String modelPath);
+
+    /**
+     * Unloads the draft model; generation goes back to one token per step.
+     */
+    public native void nativeUnloadDraftModel();
+
+    /**
+     * Reports the draft model's speculative decode steps since it was loaded.
+     * @return {steps, proposed tokens, accepted tokens, acceptance rate, emitted tokens,
+     *         tokens/s}, or null if the engine is not initialized.
+     */
+    public native double[] nativeGetSpeculationStats();
+
     /**
      * Creates a new conversation context in the C++ engine.
      * @return A handle (long) to the new conversation, or 0 if failed.
      */
     public native long nativeStartConversation();
 
+    /**
+     * Creates a new conversation context with a scheduling class.
+     * @param priority PRIORITY_INTERACTIVE or PRIORITY_BACKGROUND.
+     * @param deadlineMs Target latency of each generate call in milliseconds, or 0 for none.
+     *                   Calls with earlier deadlines are scheduled first.
+     * @param seed Seed of the conversation's sampling; the same seed and inputs give the same tokens.
+     *             0 picks a random seed.
+     * @return A handle (long) to the new conversation, or 0 if failed.
+     */
+    public native long nativeStartConversationWithOptions(int priority, int deadlineMs, long seed);
+
     /**
      * Releases the resources for a given conversation context.
      * @param handle The handle of the conversation to end.
@@ -49,7 +117,185 @@ public class NativeEngine {
      * Runs inference for a given conversation with new input tokens.
      * @param handle The handle of the conversation.
      * @param tokenIds An array of new input token IDs.
-     * @return An array of generated output token IDs.
+     * @return The sampled next token ID as a one-element array, an empty array if none was produced,
+     *         or null if the conversation was ended or the model unloaded.
      */
     public native int[] nativeGenerate(long handle, int[] tokenIds);
-}
\ No newline at end of file
+
+    /**
+     * nativeGenerate over direct buffers (ByteBuffer.allocateDirect, in ByteOrder.nativeOrder()),
+     * which native code reads and writes in place. Reusing the buffers keeps a decode step free of
+     * Java and native heap allocation.
+     * @param handle The handle of the conversation.
+     * @param tokenIds The new input token IDs as int32 values from index 0.
+     * @param tokenCount How many of them to run.
+     * @param candidates Receives the top candidates, best first, as (int32 id, float32 logit) pairs;
+     *                   pairs past the last candidate get id -1. May be null.
+     * @param logits Receives the full row of float32 logits; must hold the vocab size. May be null.
+     * @return The sampled next token ID, GENERATE_NO_TOKEN or GENERATE_FAILED.
+     */
+    public native int nativeGenerateDirect(long handle, ByteBuffer tokenIds, int tokenCount,
+                                           ByteBuffer candidates, ByteBuffer logits);
+
+    /**
+     * Starts generation in native code: prefill of the prompt, then sampling and feeding back each
+     * token until a stop token, maxNewTokens or cancellation. No other call may use the conversation
+     * until the generation is released.
+     * @param handle The handle of the conversation.
+     * @param promptTokenIds The new input token IDs.
+     * @param maxNewTokens Most tokens to deliver.
+     * @param temperature Sampling temperature; 0 or less picks the most likely token.
+     * @param topK Candidates to sample from, or 0 for the model default.
+     * @param topP Nucleus mass, or 0 for the model default.
+     * @param repetitionPenalty Divides positive (multiplies negative) logits of tokens already in the
+     *                          conversation; 1 disables.
+     * @param frequencyPenalty Subtracted from a token's logit per earlier occurrence; 0 disables.
+     * @param stopTokenIds Tokens that end generation without being delivered.
+     * @param grammar A nativeCompileGrammar id every delivered token must keep the output a prefix
+     *                of, or 0 for none. Generation stops once the output is complete and nothing
+     *                can extend it.
+     * @return A generation id for the calls below, or 0 if it could not start.
+     */
+    public native long nativeGenerateAsync(long handle, int[] promptTokenIds, int maxNewTokens,
+                                           float temperature, int topK, float topP,
+                                           float repetitionPenalty, float frequencyPenalty, int[] stopTokenIds,
+                                           long grammar);
+
+    /**
+     * Generates a completion for each prompt, as nativeGenerateAsync would on a conversation of its
+     * own, for offline jobs over many prompts. Prompts run several at a time: their prefills share
+     * steps and their decode steps run as one batch, and each finished prompt's conversation is
+     * reused by the next. Blocks until every prompt is done.
+     * @param prompts One array of input token IDs per prompt.
+     * @param maxNewTokens Most tokens to generate per prompt.
+     * @param temperature Sampling temperature; 0 or less picks the most likely token.
+     * @param topK Candidates to sample from, or 0 for the model default.
+     * @param topP Nucleus mass, or 0 for the model default.
+     * @param repetitionPenalty As for nativeGenerateAsync; 1 disables.
+     * @param frequencyPenalty As for nativeGenerateAsync; 0 disables.
+     * @param stopTokenIds Tokens that end a completion without being included.
+     * @param priority PRIORITY_INTERACTIVE or PRIORITY_BACKGROUND.
+     * @param seed Prompt i samples as a conversation seeded with seed + i would; 0 picks random seeds.
+     * @param grammar As for nativeGenerateAsync; 0 for none.
+     * @return The generated token IDs of each prompt, in prompt order, with null for a prompt that
+     *         failed; null if the engine could not run the batch.
+     */
+    public native int[][] nativeGenerateBatch(int[][] prompts, int maxNewTokens, float temperature, int topK,
+                                              float topP, float repetitionPenalty, float frequencyPenalty,
+                                              int[] stopTokenIds, int priority, long seed, long grammar);
+
+    /**
+     * Measures greedy generation over the prompts, one conversation at a time and then through
+     * nativeGenerateBatch.
+     * @return {sequential tokens/s, batched tokens/s, prompts, prompt tokens, generated tokens},
+     *         or null if no model is loaded.
+     */
+    public native double[] nativeBenchmarkBatch(int[][] prompts, int maxNewTokens, int priority);
+
+    /**
+     * Embeds the tokens with the loaded model's decoder stack, without the output projection or
+     * sampling; no conversation is needed and nothing is kept.
+     * @param tokenIds Input token IDs, at most the model's sequence length.
+     * @param pooling POOLING_LAST_TOKEN or POOLING_MEAN.
+     * @param normalize Scale the vector to unit length, for cosine similarity by dot product.
+     * @param priority PRIORITY_INTERACTIVE or PRIORITY_BACKGROUND.
+     * @return The embedding, hidden-size floats, or null on failure.
+     */
+    public native float[] nativeEmbed(int[] tokenIds, int pooling, boolean normalize, int priority);
+
+    /**
+     * nativeEmbed over several inputs, which share the decoder's passes over the weights.
+     * @return One embedding per input, in input order, or null on failure.
+     */
+    public native float[][] nativeEmbedBatch(int[][] inputs, int pooling, boolean normalize, int priority);
+
+    /**
+     * Waits up to timeoutMs for generated tokens and copies those available into buffer.
+     * @return The number of tokens copied (0 on timeout), or -1 once generation has ended and every
+     *         token has been read.
+     * @throws IllegalArgumentException if buffer is null.
+     */
+    public native int nativeReadTokens(long generation, int[] buffer, int timeoutMs);
+
+    /**
+     * nativeReadTokens into a direct buffer of int32 values in native order, from token index
+     * offset up to the buffer's capacity, without copying through a Java array.
+     */
+    public native int nativeReadTokensDirect(long generation, ByteBuffer buffer, int offset, int timeoutMs);
+
+    /**
+     * Stops the generation before its next token. May be called from any thread.
+     */
+    public native void nativeCancelGeneration(long generation);
+
+    /**
+     * Cancels the generation if it is still running, waits for it to end and frees it.
+     * @return One of the GENERATION_* statuses.
+     */
+    public native int nativeReleaseGeneration(long generation);
+
+    /**
+     * Maps a tokenizer converted by tokenizer_converter (tokenizer.json to .t760tok), replacing any
+     * tokenizer loaded before. Independent of the model; needs nativeInit only.
+     * @param tokenizerPath The absolute path to the .t760tok file.
+     * @return true on success, false on failure.
+     */
+    public native boolean nativeLoadTokenizer(String tokenizerPath);
+
+    /**
+     * Tokenizes text.
+     * @param utf8Text The text as UTF-8 bytes.
+     * @param addBos Whether to start with the BOS token.
+     * @return The token IDs, or null if no tokenizer is loaded.
+     */
+    public native int[] nativeEncode(byte[] utf8Text, boolean addBos);
+
+    /**
+     * Converts token IDs back to text.
+     * @param tokenIds The token IDs.
+     * @param skipSpecial Whether to leave out control tokens such as BOS and EOS.
+     * @return The text as UTF-8 bytes, which may end inside a character when tokenIds is a prefix
+     *         of a longer sequence; null if no tokenizer is loaded or an ID is out of range.
+     */
+    public native byte[] nativeDecode(int[] tokenIds, boolean skipSpecial);
+
+    /**
+     * nativeDecode between direct buffers.
+     * @param tokenIds The token IDs as int32 values in native order.
+     * @param tokenCount How many of them to decode.
+     * @param skipSpecial Whether to leave out control tokens such as BOS and EOS.
+     * @param utf8Text Receives the text as UTF-8 bytes from index 0.
+     * @return The text's length in bytes, written only if it fits in utf8Text; -1 if no tokenizer
+     *         is loaded or an ID is out of range.
+     */
+    public native int nativeDecodeDirect(ByteBuffer tokenIds, int tokenCount, boolean skipSpecial,
+                                         ByteBuffer utf8Text);
+
+    /**
+     * Looks up a vocab piece such as "<end_of_turn>".
+     * @param utf8Piece The piece as UTF-8 bytes.
+     * @return Its token ID, or -1.
+     */
+    public native int nativeTokenId(byte[] utf8Piece);
+
+    /**
+     * Measures tokenizer throughput over a sample text.
+     * @param utf8Sample The sample as UTF-8 bytes.
+     * @param iterations Passes over the sample for each of encode and decode.
+     * @return {encode MB/s, decode MB/s, sample bytes, sample tokens}, or null if no tokenizer is loaded.
+     */
+    public native double[] nativeBenchmarkTokenizer(byte[] utf8Sample, int iterations);
+
+    /**
+     * Compiles a grammar over the loaded tokenizer's vocab for constrained generation. Compile
+     * once and reuse: the allowed tokens of each grammar state are worked out on first use and kept.
+     * @param utf8Source The regular expression or JSON schema as UTF-8 bytes.
+     * @param syntax GRAMMAR_REGEX or GRAMMAR_JSON_SCHEMA.
+     * @return A grammar id for nativeGenerateAsync and nativeGenerateBatch, or 0 if the source is
+     *         invalid or unsupported or no tokenizer is loaded.
+     */
+    public native long nativeCompileGrammar(byte[] utf8Source, int syntax);
+
+    /** Frees a grammar; generations already using it are unaffected. */
+    public native void nativeReleaseGrammar(long grammar);
+}